@@ -101,6 +101,20 @@ void BodyNodeCollisionFilter::removeAllBodyNodePairsFromBlackList()
   mBodyNodeBlackList.removeAllPairs();
 }
 
+//==============================================================================
+void BodyNodeCollisionFilter::setBlackListFrom(
+    const BodyNodeCollisionFilter& other,
+    const std::function<const dynamics::BodyNode*(const dynamics::BodyNode*)>&
+        map)
+{
+  mBodyNodeBlackList.removeAllPairs();
+  other.mBodyNodeBlackList.forEachPair(
+      [this, &map](
+          const dynamics::BodyNode* left, const dynamics::BodyNode* right) {
+        mBodyNodeBlackList.addPair(map(left), map(right));
+      });
+}
+
 //==============================================================================
 bool BodyNodeCollisionFilter::ignoresCollision(
     const collision::CollisionObject* object1,
@@ -33,6 +33,8 @@
 #ifndef DART_COLLISION_COLLISIONFILTER_HPP_
 #define DART_COLLISION_COLLISIONFILTER_HPP_
 
+#include <functional>
+
 #include "dart/collision/detail/UnorderedPairs.hpp"
 #include "dart/common/Deprecated.hpp"
 
@@ -102,6 +104,14 @@ public:
   /// Remove all the BodyNode pairs from the blacklist.
   void removeAllBodyNodePairsFromBlackList();
 
+  /// Replace the blacklist with a copy of other's, with each BodyNode swapped
+  /// for map(BodyNode), e.g. its counterpart in a cloned Skeleton. Pairs where
+  /// map returns nullptr for either BodyNode are left out.
+  void setBlackListFrom(
+      const BodyNodeCollisionFilter& other,
+      const std::function<const dynamics::BodyNode*(const dynamics::BodyNode*)>&
+          map);
+
   // Documentation inherited
   bool ignoresCollision(
       const CollisionObject* object1,
@@ -41,6 +41,7 @@
 #include "dart/dynamics/CapsuleShape.hpp"
 #include "dart/dynamics/CylinderShape.hpp"
 #include "dart/dynamics/EllipsoidShape.hpp"
+#include "dart/dynamics/HeightmapShape.hpp"
 #include "dart/dynamics/MeshShape.hpp"
 #include "dart/dynamics/SphereShape.hpp"
 #include "dart/math/Geometry.hpp"
@@ -5061,6 +5062,381 @@ int collideCylinderPlane(
   return 0;
 }
 
+namespace {
+
+/// A heightmap prism contact is kept only if the cosine between its normal and
+/// the triangle's face normal is at least this, which is about 2.5 degrees
+const s_t HEIGHTMAP_FACE_NORMAL_COS = 0.999;
+
+//==============================================================================
+/// Returns a six vertex mesh, private to the calling thread, that we overwrite
+/// with one heightmap prism at a time. This lets heightmap cells go through
+/// the same mesh routines (and get the same gradient annotations) as any
+/// other mesh, without allocating a scene per cell.
+aiScene* getHeightmapPrismScratch()
+{
+  static thread_local std::unique_ptr<aiScene> scene;
+  if (!scene)
+  {
+    scene.reset(new aiScene);
+    scene->mNumMeshes = 1;
+    scene->mMeshes = new aiMesh*[1];
+    scene->mMeshes[0] = new aiMesh;
+    scene->mMeshes[0]->mNumVertices = 6;
+    scene->mMeshes[0]->mVertices = new aiVector3D[6];
+  }
+  return scene.get();
+}
+
+//==============================================================================
+/// Collides one heightmap prism, stored in `prism` relative to
+/// `prismTransform`, against a sphere, box, capsule or mesh. The heightmap is
+/// o1 if heightmapFirst is true, and o2 otherwise.
+int collideHeightmapPrism(
+    CollisionObject* o1,
+    CollisionObject* o2,
+    const aiScene* prism,
+    const Eigen::Isometry3s& prismTransform,
+    const dynamics::Shape* other,
+    const Eigen::Isometry3s& otherTransform,
+    bool heightmapFirst,
+    const CollisionOption& option,
+    CollisionResult& result)
+{
+  const Eigen::Vector3s unitScale = Eigen::Vector3s::Ones();
+  const auto& otherType = other->getType();
+
+  if (dynamics::SphereShape::getStaticType() == otherType
+      || dynamics::EllipsoidShape::getStaticType() == otherType)
+  {
+    const s_t radius
+        = dynamics::SphereShape::getStaticType() == otherType
+              ? static_cast<const dynamics::SphereShape*>(other)->getRadius()
+              : static_cast<const dynamics::EllipsoidShape*>(other)
+                    ->getRadii()[0];
+    if (heightmapFirst)
+      return collideMeshSphere(
+          o1,
+          o2,
+          prism,
+          unitScale,
+          prismTransform,
+          radius,
+          otherTransform,
+          option,
+          result);
+    return collideSphereMesh(
+        o1,
+        o2,
+        radius,
+        otherTransform,
+        prism,
+        unitScale,
+        prismTransform,
+        option,
+        result);
+  }
+  else if (dynamics::BoxShape::getStaticType() == otherType)
+  {
+    const auto* box = static_cast<const dynamics::BoxShape*>(other);
+    if (heightmapFirst)
+      return collideMeshBox(
+          o1,
+          o2,
+          prism,
+          unitScale,
+          prismTransform,
+          box->getSize(),
+          otherTransform,
+          option,
+          result);
+    return collideBoxMesh(
+        o1,
+        o2,
+        box->getSize(),
+        otherTransform,
+        prism,
+        unitScale,
+        prismTransform,
+        option,
+        result);
+  }
+  else if (dynamics::CapsuleShape::getStaticType() == otherType)
+  {
+    const auto* capsule = static_cast<const dynamics::CapsuleShape*>(other);
+    if (heightmapFirst)
+      return collideMeshCapsule(
+          o1,
+          o2,
+          prism,
+          unitScale,
+          prismTransform,
+          capsule->getHeight(),
+          capsule->getRadius(),
+          otherTransform,
+          option,
+          result);
+    return collideCapsuleMesh(
+        o1,
+        o2,
+        capsule->getHeight(),
+        capsule->getRadius(),
+        otherTransform,
+        prism,
+        unitScale,
+        prismTransform,
+        option,
+        result);
+  }
+  else if (dynamics::MeshShape::getStaticType() == otherType)
+  {
+    const auto* mesh = static_cast<const dynamics::MeshShape*>(other);
+    if (heightmapFirst)
+      return collideMeshMesh(
+          o1,
+          o2,
+          prism,
+          unitScale,
+          prismTransform,
+          mesh->getMesh(),
+          mesh->getScale(),
+          otherTransform,
+          option,
+          result);
+    return collideMeshMesh(
+        o1,
+        o2,
+        mesh->getMesh(),
+        mesh->getScale(),
+        otherTransform,
+        prism,
+        unitScale,
+        prismTransform,
+        option,
+        result);
+  }
+
+  return 0;
+}
+
+//==============================================================================
+/// Collides a heightmap against a sphere, box, capsule or mesh.
+///
+/// Heightmap vertex (row, col) sits at x = (col - (width - 1) / 2) * scale.x,
+/// y = ((depth - 1) / 2 - row) * scale.y, z = height * scale.z, in the
+/// heightmap's frame. Only the cells under the other shape's bounding box are
+/// visited. Each of their two triangles is extruded downward, as deep as that
+/// bounding box is tall, into a convex prism, which then gets collided like a
+/// small mesh.
+///
+/// Neighboring prisms share their side walls, so a shape that pokes just past
+/// a cell line looks like it could escape sideways through the neighbor's
+/// wall, or through the edge between the two. Those walls and edges are inside
+/// the terrain, not on its surface, so only contacts whose normal matches the
+/// triangle's own face normal are kept. The triangle the shape actually rests
+/// on supplies the contact instead.
+template <typename S>
+int collideHeightmap(
+    CollisionObject* o1,
+    CollisionObject* o2,
+    const dynamics::HeightmapShape<S>* heightmap,
+    const Eigen::Isometry3s& heightmapTransform,
+    const dynamics::Shape* other,
+    const Eigen::Isometry3s& otherTransform,
+    bool heightmapFirst,
+    const CollisionOption& option,
+    CollisionResult& result)
+{
+  const auto& heights = heightmap->getHeightField();
+  const int width = static_cast<int>(heights.cols());
+  const int depth = static_cast<int>(heights.rows());
+  if (width < 2 || depth < 2)
+    return 0;
+  const Eigen::Vector3s scale = heightmap->getScale().template cast<s_t>();
+
+  // The other shape's bounding box, in the heightmap's frame
+  const Eigen::Isometry3s otherInHeightmap
+      = heightmapTransform.inverse() * otherTransform;
+  const math::BoundingBox& localBox = other->getBoundingBox();
+  const Eigen::Vector3s center
+      = otherInHeightmap * (0.5 * (localBox.getMin() + localBox.getMax()));
+  const Eigen::Vector3s halfExtents
+      = otherInHeightmap.linear().cwiseAbs()
+        * (0.5 * (localBox.getMax() - localBox.getMin()).cwiseAbs());
+  const Eigen::Vector3s boxMin = center - halfExtents;
+  const Eigen::Vector3s boxMax = center + halfExtents;
+
+  if (boxMin.z() > heightmap->getMaxHeight() * scale.z())
+    return 0;
+
+  // The range of cells under the bounding box, clamped to the grid
+  const double halfWidth = 0.5 * (width - 1);
+  const double halfDepth = 0.5 * (depth - 1);
+  auto toIndex = [](double value, int limit) {
+    if (!(value > 0.0))
+      return 0;
+    if (value > limit)
+      return limit;
+    return static_cast<int>(value);
+  };
+  const int colBegin = toIndex(
+      std::floor(static_cast<double>(boxMin.x() / scale.x()) + halfWidth),
+      width - 1);
+  const int colEnd = toIndex(
+      std::ceil(static_cast<double>(boxMax.x() / scale.x()) + halfWidth),
+      width - 1);
+  const int rowBegin = toIndex(
+      std::floor(halfDepth - static_cast<double>(boxMax.y() / scale.y())),
+      depth - 1);
+  const int rowEnd = toIndex(
+      std::ceil(halfDepth - static_cast<double>(boxMin.y() / scale.y())),
+      depth - 1);
+
+  auto vertex = [&](int row, int col) {
+    return Eigen::Vector3s(
+        (col - halfWidth) * scale.x(),
+        (halfDepth - row) * scale.y(),
+        static_cast<s_t>(heights(row, col)) * scale.z());
+  };
+
+  aiScene* prism = getHeightmapPrismScratch();
+  aiVector3D* prismVertices = prism->mMeshes[0]->mVertices;
+  const s_t prismDepth = boxMax.z() - boxMin.z();
+  CollisionResult prismResult;
+
+  int numContacts = 0;
+  for (int row = rowBegin; row < rowEnd; row++)
+  {
+    for (int col = colBegin; col < colEnd; col++)
+    {
+      const Eigen::Vector3s corners[4] = {vertex(row, col),
+                                         vertex(row + 1, col),
+                                         vertex(row, col + 1),
+                                         vertex(row + 1, col + 1)};
+      const int triangles[2][3] = {{0, 1, 2}, {1, 3, 2}};
+
+      for (int t = 0; t < 2; t++)
+      {
+        const Eigen::Vector3s& a = corners[triangles[t][0]];
+        const Eigen::Vector3s& b = corners[triangles[t][1]];
+        const Eigen::Vector3s& c = corners[triangles[t][2]];
+
+        // Skip triangles the other shape is entirely above
+        const s_t top = std::max(a.z(), std::max(b.z(), c.z()));
+        if (boxMin.z() > top)
+          continue;
+
+        if (result.getNumContacts() >= option.maxNumContacts)
+          return numContacts;
+
+        // Center the prism on its own centroid, since MPR starts its search
+        // from the mesh origin and needs it to be inside the prism
+        const s_t bottom
+            = std::min(a.z(), std::min(b.z(), c.z())) - prismDepth;
+        const Eigen::Vector3s centroid
+            = Eigen::Vector3s(
+                  (a.x() + b.x() + c.x()) / 3.0,
+                  (a.y() + b.y() + c.y()) / 3.0,
+                  0.5 * ((a.z() + b.z() + c.z()) / 3.0 + bottom));
+        const Eigen::Vector3s prismPoints[6]
+            = {a - centroid,
+               b - centroid,
+               c - centroid,
+               Eigen::Vector3s(a.x(), a.y(), bottom) - centroid,
+               Eigen::Vector3s(b.x(), b.y(), bottom) - centroid,
+               Eigen::Vector3s(c.x(), c.y(), bottom) - centroid};
+        for (int i = 0; i < 6; i++)
+        {
+          prismVertices[i].x = static_cast<double>(prismPoints[i].x());
+          prismVertices[i].y = static_cast<double>(prismPoints[i].y());
+          prismVertices[i].z = static_cast<double>(prismPoints[i].z());
+        }
+
+        Eigen::Isometry3s prismTransform = heightmapTransform;
+        prismTransform.translation() = heightmapTransform * centroid;
+
+        prismResult.clear();
+        collideHeightmapPrism(
+            o1,
+            o2,
+            prism,
+            prismTransform,
+            other,
+            otherTransform,
+            heightmapFirst,
+            option,
+            prismResult);
+
+        // Normals point from o2 to o1, so they point down into the terrain
+        // when the heightmap is o1
+        Eigen::Vector3s faceNormal
+            = heightmapTransform.linear() * (b - a).cross(c - a).normalized();
+        if (heightmapFirst)
+          faceNormal = -faceNormal;
+        for (const Contact& contact : prismResult.getContacts())
+        {
+          if (contact.normal.dot(faceNormal) < HEIGHTMAP_FACE_NORMAL_COS)
+            continue;
+          if (result.getNumContacts() >= option.maxNumContacts)
+            return numContacts;
+          result.addContact(contact);
+          numContacts++;
+        }
+      }
+    }
+  }
+
+  return numContacts;
+}
+
+//==============================================================================
+/// If the pair contains a heightmap, collides it and returns true. Otherwise
+/// returns false and leaves numContacts alone.
+template <typename S>
+bool collideIfHeightmap(
+    CollisionObject* o1,
+    CollisionObject* o2,
+    const CollisionOption& option,
+    CollisionResult& result,
+    int& numContacts)
+{
+  const auto& shape1 = o1->getShape();
+  const auto& shape2 = o2->getShape();
+  const auto& heightmapType = dynamics::HeightmapShape<S>::getStaticType();
+
+  if (heightmapType == shape1->getType())
+  {
+    numContacts = collideHeightmap(
+        o1,
+        o2,
+        static_cast<const dynamics::HeightmapShape<S>*>(shape1.get()),
+        o1->getTransform(),
+        shape2.get(),
+        o2->getTransform(),
+        true,
+        option,
+        result);
+    return true;
+  }
+  else if (heightmapType == shape2->getType())
+  {
+    numContacts = collideHeightmap(
+        o1,
+        o2,
+        static_cast<const dynamics::HeightmapShape<S>*>(shape2.get()),
+        o2->getTransform(),
+        shape1.get(),
+        o1->getTransform(),
+        false,
+        option,
+        result);
+    return true;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
 //==============================================================================
 int collide(
     CollisionObject* o1,
@@ -5068,6 +5444,13 @@ int collide(
     const CollisionOption& option,
     CollisionResult& result)
 {
+  int heightmapContacts = 0;
+  if (collideIfHeightmap<s_t>(o1, o2, option, result, heightmapContacts)
+      || collideIfHeightmap<float>(o1, o2, option, result, heightmapContacts))
+  {
+    return heightmapContacts;
+  }
+
   // TODO(JS): We could make the contact point computation as optional for
   // the case that we want only binary check.
 
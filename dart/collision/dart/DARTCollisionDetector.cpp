@@ -32,14 +32,20 @@
 
 #include "dart/collision/dart/DARTCollisionDetector.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #include "dart/collision/CollisionFilter.hpp"
 #include "dart/collision/CollisionObject.hpp"
+#include "dart/collision/RaycastOption.hpp"
+#include "dart/collision/RaycastResult.hpp"
 #include "dart/collision/dart/DARTCollide.hpp"
 #include "dart/collision/dart/DARTCollisionGroup.hpp"
 #include "dart/collision/dart/DARTCollisionObject.hpp"
 #include "dart/dynamics/BoxShape.hpp"
 #include "dart/dynamics/CapsuleShape.hpp"
 #include "dart/dynamics/EllipsoidShape.hpp"
+#include "dart/dynamics/HeightmapShape.hpp"
 #include "dart/dynamics/MeshShape.hpp"
 #include "dart/dynamics/ShapeFrame.hpp"
 #include "dart/dynamics/SphereShape.hpp"
@@ -265,6 +271,138 @@ double DARTCollisionDetector::distance(
   return 0.0;
 }
 
+//==============================================================================
+bool DARTCollisionDetector::raycast(
+    CollisionGroup* group,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& to,
+    const RaycastOption& option,
+    RaycastResult* result)
+{
+  if (result)
+    result->clear();
+
+  if (!checkGroupValidity(this, group))
+    return false;
+
+  if (group->getAutomaticUpdate())
+    group->update();
+
+  auto casted = static_cast<DARTCollisionGroup*>(group);
+  RaycastScene scene;
+  scene.prepare(casted->mCollisionObjects, mMeshRaycastCache);
+
+  if (!result)
+  {
+    RayHit hit;
+    return scene.raycast(from, to, hit);
+  }
+
+  if (option.mEnableAllHits)
+  {
+    scene.raycastAll(from, to, result->mRayHits);
+    if (option.mSortByClosest)
+    {
+      std::sort(
+          result->mRayHits.begin(),
+          result->mRayHits.end(),
+          [](const RayHit& a, const RayHit& b) {
+            return a.mFraction < b.mFraction;
+          });
+    }
+  }
+  else
+  {
+    RayHit hit;
+    if (scene.raycast(from, to, hit))
+      result->mRayHits.push_back(hit);
+  }
+
+  result->mHasHit = result->hasHit();
+  return result->mHasHit;
+}
+
+//==============================================================================
+std::size_t DARTCollisionDetector::raycastBatch(
+    CollisionGroup* group,
+    const Eigen::MatrixXs& froms,
+    const Eigen::MatrixXs& tos,
+    std::vector<RayHit>& hits,
+    int numThreads)
+{
+  assert(froms.rows() == 3 && tos.rows() == 3);
+  assert(froms.cols() == tos.cols());
+
+  const std::size_t numRays = static_cast<std::size_t>(froms.cols());
+  if (hits.size() != numRays)
+    hits.resize(numRays);
+
+  if (!checkGroupValidity(this, group))
+    return 0;
+
+  if (group->getAutomaticUpdate())
+    group->update();
+
+  // Everything that touches the skeletons (world transforms, bounding boxes)
+  // happens here, on this thread, so the workers below only read the scene
+  auto casted = static_cast<DARTCollisionGroup*>(group);
+  RaycastScene scene;
+  scene.prepare(casted->mCollisionObjects, mMeshRaycastCache);
+
+  auto castRange = [&scene, &froms, &tos, &hits](
+                       std::size_t begin, std::size_t end) {
+    std::size_t numHits = 0;
+    for (std::size_t i = begin; i < end; i++)
+    {
+      RayHit& hit = hits[i];
+      if (scene.raycast(froms.col(i), tos.col(i), hit))
+      {
+        numHits++;
+      }
+      else
+      {
+        hit.mCollisionObject = nullptr;
+        hit.mNormal.setZero();
+        hit.mPoint = tos.col(i);
+        hit.mFraction = 1.0;
+      }
+    }
+    return numHits;
+  };
+
+  if (numThreads <= 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Not worth spinning up threads for a handful of rays
+  const std::size_t minRaysPerThread = 64;
+  const std::size_t numWorkers = std::max<std::size_t>(
+      1,
+      std::min<std::size_t>(numThreads, numRays / minRaysPerThread));
+  if (numWorkers == 1)
+    return castRange(0, numRays);
+
+  std::vector<std::size_t> numHits(numWorkers, 0);
+  std::vector<std::thread> workers;
+  workers.reserve(numWorkers - 1);
+  const std::size_t raysPerWorker = (numRays + numWorkers - 1) / numWorkers;
+  for (std::size_t w = 1; w < numWorkers; w++)
+  {
+    const std::size_t begin = std::min(numRays, w * raysPerWorker);
+    const std::size_t end = std::min(numRays, begin + raysPerWorker);
+    workers.emplace_back([&castRange, &numHits, w, begin, end]() {
+      numHits[w] = castRange(begin, end);
+    });
+  }
+  numHits[0] = castRange(0, std::min(numRays, raysPerWorker));
+  for (std::thread& worker : workers)
+    worker.join();
+
+  std::size_t totalHits = 0;
+  for (std::size_t count : numHits)
+    totalHits += count;
+  return totalHits;
+}
+
 //==============================================================================
 DARTCollisionDetector::DARTCollisionDetector() : CollisionDetector()
 {
@@ -292,6 +430,10 @@ void warnUnsupportedShapeType(const dynamics::ShapeFrame* shapeFrame)
   if (shapeType == dynamics::CapsuleShape::getStaticType())
     return;
 
+  if (shapeType == dynamics::HeightmapShaped::getStaticType()
+      || shapeType == dynamics::HeightmapShapef::getStaticType())
+    return;
+
   if (shapeType == dynamics::EllipsoidShape::getStaticType())
   {
     const auto& ellipsoid
@@ -305,7 +447,7 @@ void warnUnsupportedShapeType(const dynamics::ShapeFrame* shapeFrame)
         << shapeType << "] that is not supported "
         << "by DARTCollisionDetector. Currently, only BoxShape and "
         << "EllipsoidShape (only when all the radii are equal) and SphereShape "
-           "and MeshShape and CapsuleShape are "
+           "and MeshShape and CapsuleShape and HeightmapShape are "
         << "supported. This shape will always get penetrated by other "
         << "objects.\n";
 }
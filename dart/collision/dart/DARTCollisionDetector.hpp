@@ -35,6 +35,7 @@
 
 #include <vector>
 #include "dart/collision/CollisionDetector.hpp"
+#include "dart/collision/dart/DARTRaycast.hpp"
 
 namespace dart {
 namespace collision {
@@ -87,6 +88,34 @@ public:
       const DistanceOption& option = DistanceOption(false, 0.0, nullptr),
       DistanceResult* result = nullptr) override;
 
+  // Documentation inherited
+  bool raycast(
+      CollisionGroup* group,
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& to,
+      const RaycastOption& option = RaycastOption(),
+      RaycastResult* result = nullptr) override;
+
+  /// Casts many rays against a collision group at once. Ray i runs from
+  /// froms.col(i) to tos.col(i), and only its closest hit is reported, in
+  /// hits[i]. Rays that hit nothing get a null mCollisionObject and a
+  /// mFraction of 1.
+  ///
+  /// The group's shapes are put in a bounding volume hierarchy once per call,
+  /// and the triangles of each mesh get a hierarchy of their own that is
+  /// reused across calls. The rays are then split between numThreads threads
+  /// (0 means one per hardware thread). hits is only resized if it doesn't
+  /// already have one entry per ray, so passing in the same vector on every
+  /// call avoids allocating.
+  ///
+  /// \return The number of rays that hit something.
+  std::size_t raycastBatch(
+      CollisionGroup* group,
+      const Eigen::MatrixXs& froms,
+      const Eigen::MatrixXs& tos,
+      std::vector<RayHit>& hits,
+      int numThreads = 0);
+
 protected:
 
   /// Constructor
@@ -99,6 +128,10 @@ protected:
   // Documentation inherited
   void refreshCollisionObject(CollisionObject* object) override;
 
+  /// Triangle hierarchies for the meshes we've raycast against, shared
+  /// between every MeshShape using the same scene
+  RaycastScene::MeshCache mMeshRaycastCache;
+
 private:
   static Registrar<DARTCollisionDetector> mRegistrar;
 };
@@ -0,0 +1,661 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/collision/dart/DARTRaycast.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <assimp/scene.h>
+
+#include "dart/collision/CollisionObject.hpp"
+#include "dart/dynamics/BoxShape.hpp"
+#include "dart/dynamics/CapsuleShape.hpp"
+#include "dart/dynamics/CylinderShape.hpp"
+#include "dart/dynamics/EllipsoidShape.hpp"
+#include "dart/dynamics/MeshShape.hpp"
+#include "dart/dynamics/SphereShape.hpp"
+
+namespace dart {
+namespace collision {
+
+namespace {
+
+/// The largest number of primitives we put in a leaf
+constexpr int MAX_LEAF_SIZE = 4;
+
+//==============================================================================
+/// Returns the smallest t in [0, maxT] at which the ray enters the sphere of
+/// the given radius around center, or infinity.
+s_t raycastSphere(
+    const Eigen::Vector3s& center,
+    s_t radius,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT)
+{
+  const Eigen::Vector3s offset = from - center;
+  const s_t a = dir.squaredNorm();
+  const s_t b = offset.dot(dir);
+  const s_t c = offset.squaredNorm() - radius * radius;
+  const s_t discriminant = b * b - a * c;
+  if (a <= 0.0 || discriminant < 0.0)
+    return std::numeric_limits<s_t>::infinity();
+  const s_t t = (-b - std::sqrt(discriminant)) / a;
+  if (t < 0.0 || t > maxT)
+    return std::numeric_limits<s_t>::infinity();
+  return t;
+}
+
+//==============================================================================
+/// Returns the smallest t in [0, maxT] at which the ray enters the side of
+/// the Z-aligned cylinder of the given radius and half height, or infinity.
+/// The end caps aren't considered.
+s_t raycastCylinderSide(
+    s_t radius,
+    s_t halfHeight,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT)
+{
+  const s_t a = dir.x() * dir.x() + dir.y() * dir.y();
+  const s_t b = from.x() * dir.x() + from.y() * dir.y();
+  const s_t c = from.x() * from.x() + from.y() * from.y() - radius * radius;
+  const s_t discriminant = b * b - a * c;
+  if (a <= 0.0 || discriminant < 0.0)
+    return std::numeric_limits<s_t>::infinity();
+  const s_t t = (-b - std::sqrt(discriminant)) / a;
+  if (t < 0.0 || t > maxT)
+    return std::numeric_limits<s_t>::infinity();
+  const s_t z = from.z() + t * dir.z();
+  if (z < -halfHeight || z > halfHeight)
+    return std::numeric_limits<s_t>::infinity();
+  return t;
+}
+
+//==============================================================================
+/// Returns the smallest t in [0, maxT] at which the ray enters the flat disc
+/// of the given radius at height z, or infinity.
+s_t raycastDisc(
+    s_t radius,
+    s_t z,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT)
+{
+  if (dir.z() == 0.0)
+    return std::numeric_limits<s_t>::infinity();
+  const s_t t = (z - from.z()) / dir.z();
+  if (t < 0.0 || t > maxT)
+    return std::numeric_limits<s_t>::infinity();
+  const s_t x = from.x() + t * dir.x();
+  const s_t y = from.y() + t * dir.y();
+  if (x * x + y * y > radius * radius)
+    return std::numeric_limits<s_t>::infinity();
+  return t;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+void RaycastBVH::build(
+    const std::vector<Eigen::Vector3s>& mins,
+    const std::vector<Eigen::Vector3s>& maxs)
+{
+  assert(mins.size() == maxs.size());
+
+  mNodes.clear();
+  mPrimitives.resize(mins.size());
+  if (mins.empty())
+    return;
+
+  std::vector<Eigen::Vector3s> centers(mins.size());
+  for (std::size_t i = 0; i < mins.size(); i++)
+  {
+    mPrimitives[i] = static_cast<int>(i);
+    centers[i] = 0.5 * (mins[i] + maxs[i]);
+  }
+
+  // A binary tree with at most MAX_LEAF_SIZE primitives per leaf never needs
+  // more than this many nodes
+  mNodes.reserve(2 * (mins.size() / MAX_LEAF_SIZE + 1));
+  buildNode(0, static_cast<int>(mins.size()), mins, maxs, centers);
+}
+
+//==============================================================================
+bool RaycastBVH::empty() const
+{
+  return mNodes.empty();
+}
+
+//==============================================================================
+void RaycastBVH::buildNode(
+    int begin,
+    int end,
+    const std::vector<Eigen::Vector3s>& mins,
+    const std::vector<Eigen::Vector3s>& maxs,
+    const std::vector<Eigen::Vector3s>& centers)
+{
+  const int index = static_cast<int>(mNodes.size());
+  mNodes.emplace_back();
+
+  Eigen::Vector3s boxMin = mins[mPrimitives[begin]];
+  Eigen::Vector3s boxMax = maxs[mPrimitives[begin]];
+  Eigen::Vector3s centerMin = centers[mPrimitives[begin]];
+  Eigen::Vector3s centerMax = centerMin;
+  for (int i = begin + 1; i < end; i++)
+  {
+    const int primitive = mPrimitives[i];
+    boxMin = boxMin.cwiseMin(mins[primitive]);
+    boxMax = boxMax.cwiseMax(maxs[primitive]);
+    centerMin = centerMin.cwiseMin(centers[primitive]);
+    centerMax = centerMax.cwiseMax(centers[primitive]);
+  }
+  mNodes[index].mMin = boxMin;
+  mNodes[index].mMax = boxMax;
+
+  if (end - begin <= MAX_LEAF_SIZE)
+  {
+    mNodes[index].mIndex = begin;
+    mNodes[index].mCount = end - begin;
+    return;
+  }
+
+  // Split at the median along the axis where the centers are most spread out
+  int axis = 0;
+  (centerMax - centerMin).maxCoeff(&axis);
+  const int middle = begin + (end - begin) / 2;
+  std::nth_element(
+      mPrimitives.begin() + begin,
+      mPrimitives.begin() + middle,
+      mPrimitives.begin() + end,
+      [&centers, axis](int a, int b) {
+        return centers[a](axis) < centers[b](axis);
+      });
+
+  mNodes[index].mCount = 0;
+  buildNode(begin, middle, mins, maxs, centers);
+  mNodes[index].mIndex = static_cast<int>(mNodes.size());
+  buildNode(middle, end, mins, maxs, centers);
+}
+
+//==============================================================================
+s_t RaycastBVH::enter(
+    const Node& node,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& invDir,
+    s_t maxT)
+{
+  s_t tMin = 0.0;
+  s_t tMax = maxT;
+  for (int i = 0; i < 3; i++)
+  {
+    s_t t0 = (node.mMin(i) - from(i)) * invDir(i);
+    s_t t1 = (node.mMax(i) - from(i)) * invDir(i);
+    if (t0 > t1)
+      std::swap(t0, t1);
+    // Written so that NaNs (a ray lying exactly in a slab's plane) don't
+    // cause a miss
+    tMin = t0 > tMin ? t0 : tMin;
+    tMax = t1 < tMax ? t1 : tMax;
+    if (tMin > tMax)
+      return std::numeric_limits<s_t>::infinity();
+  }
+  return tMin;
+}
+
+//==============================================================================
+MeshRaycastBVH::MeshRaycastBVH(const aiScene* scene) : mScene(scene)
+{
+  std::vector<Eigen::Vector3s> mins;
+  std::vector<Eigen::Vector3s> maxs;
+
+  for (unsigned int i = 0; scene && i < scene->mNumMeshes; i++)
+  {
+    const aiMesh* mesh = scene->mMeshes[i];
+    for (unsigned int j = 0; j < mesh->mNumFaces; j++)
+    {
+      const aiFace& face = mesh->mFaces[j];
+      if (face.mNumIndices != 3)
+        continue;
+
+      Eigen::Vector3s triangle[3];
+      for (int k = 0; k < 3; k++)
+      {
+        const aiVector3D& vertex = mesh->mVertices[face.mIndices[k]];
+        triangle[k] = Eigen::Vector3s(vertex.x, vertex.y, vertex.z);
+        mVertices.push_back(triangle[k]);
+      }
+      mins.push_back(triangle[0].cwiseMin(triangle[1]).cwiseMin(triangle[2]));
+      maxs.push_back(triangle[0].cwiseMax(triangle[1]).cwiseMax(triangle[2]));
+    }
+  }
+
+  mTree.build(mins, maxs);
+}
+
+//==============================================================================
+const aiScene* MeshRaycastBVH::getScene() const
+{
+  return mScene;
+}
+
+//==============================================================================
+bool MeshRaycastBVH::raycast(
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT,
+    s_t& t,
+    Eigen::Vector3s& normal) const
+{
+  int hitTriangle = -1;
+  const s_t hitT = mTree.traverse(
+      from,
+      dir,
+      maxT,
+      [this, &from, &dir, &hitTriangle](int triangle, s_t bestT) {
+        // Moller-Trumbore, accepting hits from either side
+        const Eigen::Vector3s& a = mVertices[3 * triangle];
+        const Eigen::Vector3s edge1 = mVertices[3 * triangle + 1] - a;
+        const Eigen::Vector3s edge2 = mVertices[3 * triangle + 2] - a;
+        const Eigen::Vector3s p = dir.cross(edge2);
+        const s_t det = edge1.dot(p);
+        if (std::abs(det) < 1e-14)
+          return bestT;
+        const s_t invDet = 1.0 / det;
+        const Eigen::Vector3s offset = from - a;
+        const s_t u = offset.dot(p) * invDet;
+        if (u < 0.0 || u > 1.0)
+          return bestT;
+        const Eigen::Vector3s q = offset.cross(edge1);
+        const s_t v = dir.dot(q) * invDet;
+        if (v < 0.0 || u + v > 1.0)
+          return bestT;
+        const s_t candidate = edge2.dot(q) * invDet;
+        if (candidate < 0.0 || candidate > bestT)
+          return bestT;
+        hitTriangle = triangle;
+        return candidate;
+      });
+
+  if (hitTriangle < 0)
+    return false;
+
+  const Eigen::Vector3s& a = mVertices[3 * hitTriangle];
+  normal = (mVertices[3 * hitTriangle + 1] - a)
+               .cross(mVertices[3 * hitTriangle + 2] - a);
+  if (normal.dot(dir) > 0.0)
+    normal = -normal;
+  t = hitT;
+  return true;
+}
+
+//==============================================================================
+void RaycastScene::prepare(
+    const std::vector<CollisionObject*>& objects, MeshCache& meshCache)
+{
+  mTargets.clear();
+  mTargets.reserve(objects.size());
+
+  std::vector<Eigen::Vector3s> mins;
+  std::vector<Eigen::Vector3s> maxs;
+  mins.reserve(objects.size());
+  maxs.reserve(objects.size());
+
+  for (CollisionObject* object : objects)
+  {
+    const auto shape = object->getShape();
+    if (!shape)
+      continue;
+    const std::string& shapeType = shape->getType();
+
+    Target target;
+    target.mObject = object;
+    target.mTransform = object->getTransform();
+
+    if (shapeType == dynamics::BoxShape::getStaticType())
+    {
+      const auto* box = static_cast<const dynamics::BoxShape*>(shape.get());
+      target.mType = BOX;
+      target.mSize = 0.5 * box->getSize();
+    }
+    else if (shapeType == dynamics::SphereShape::getStaticType())
+    {
+      const auto* sphere
+          = static_cast<const dynamics::SphereShape*>(shape.get());
+      target.mType = SPHERE;
+      target.mSize = Eigen::Vector3s::Constant(sphere->getRadius());
+    }
+    else if (shapeType == dynamics::EllipsoidShape::getStaticType())
+    {
+      const auto* ellipsoid
+          = static_cast<const dynamics::EllipsoidShape*>(shape.get());
+      target.mType = ELLIPSOID;
+      target.mSize = ellipsoid->getRadii();
+    }
+    else if (shapeType == dynamics::CapsuleShape::getStaticType())
+    {
+      const auto* capsule
+          = static_cast<const dynamics::CapsuleShape*>(shape.get());
+      target.mType = CAPSULE;
+      target.mSize = Eigen::Vector3s(
+          capsule->getRadius(),
+          capsule->getRadius(),
+          0.5 * capsule->getHeight());
+    }
+    else if (shapeType == dynamics::CylinderShape::getStaticType())
+    {
+      const auto* cylinder
+          = static_cast<const dynamics::CylinderShape*>(shape.get());
+      target.mType = CYLINDER;
+      target.mSize = Eigen::Vector3s(
+          cylinder->getRadius(),
+          cylinder->getRadius(),
+          0.5 * cylinder->getHeight());
+    }
+    else if (shapeType == dynamics::MeshShape::getStaticType())
+    {
+      const auto* mesh = static_cast<const dynamics::MeshShape*>(shape.get());
+      if (!mesh->getMesh())
+        continue;
+      target.mType = MESH;
+      target.mSize = mesh->getScale();
+
+      MeshCacheEntry& cached = meshCache[mesh->getMesh()];
+      const auto owner = cached.mShape.lock();
+      if (!cached.mTree || !owner
+          || owner->getVersion() != cached.mShapeVersion)
+      {
+        cached.mTree = std::make_shared<const MeshRaycastBVH>(mesh->getMesh());
+        cached.mShape = shape;
+        cached.mShapeVersion = shape->getVersion();
+      }
+      target.mMesh = cached.mTree;
+    }
+    else
+    {
+      continue;
+    }
+
+    // World space bounds of the shape's local bounding box
+    const math::BoundingBox& box = shape->getBoundingBox();
+    const Eigen::Vector3s localCenter
+        = 0.5 * (box.getMin() + box.getMax());
+    const Eigen::Vector3s localHalfExtents
+        = 0.5 * (box.getMax() - box.getMin()).cwiseAbs();
+    const Eigen::Vector3s center = target.mTransform * localCenter;
+    const Eigen::Vector3s halfExtents
+        = target.mTransform.linear().cwiseAbs() * localHalfExtents;
+    mins.push_back(center - halfExtents);
+    maxs.push_back(center + halfExtents);
+
+    mTargets.push_back(target);
+  }
+
+  // Drop cache entries whose shape (and so maybe the aiScene) has been
+  // released or changed since the tree was built
+  for (auto it = meshCache.begin(); it != meshCache.end();)
+  {
+    const auto owner = it->second.mShape.lock();
+    if (!owner || owner->getVersion() != it->second.mShapeVersion)
+      it = meshCache.erase(it);
+    else
+      ++it;
+  }
+
+  mTree.build(mins, maxs);
+}
+
+//==============================================================================
+bool RaycastScene::raycast(
+    const Eigen::Vector3s& from, const Eigen::Vector3s& to, RayHit& hit) const
+{
+  const Eigen::Vector3s dir = to - from;
+  int hitTarget = -1;
+  Eigen::Vector3s hitNormal;
+  const s_t hitT = mTree.traverse(
+      from,
+      dir,
+      1.0,
+      [this, &from, &dir, &hitTarget, &hitNormal](int index, s_t bestT) {
+        s_t t;
+        Eigen::Vector3s normal;
+        if (raycastTarget(mTargets[index], from, dir, bestT, t, normal))
+        {
+          hitTarget = index;
+          hitNormal = normal;
+          return t;
+        }
+        return bestT;
+      });
+
+  if (hitTarget < 0)
+    return false;
+
+  hit.mCollisionObject = mTargets[hitTarget].mObject;
+  hit.mNormal = hitNormal;
+  hit.mPoint = from + hitT * dir;
+  hit.mFraction = static_cast<double>(hitT);
+  return true;
+}
+
+//==============================================================================
+bool RaycastScene::raycastAll(
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& to,
+    std::vector<RayHit>& hits) const
+{
+  const Eigen::Vector3s dir = to - from;
+  bool hitAny = false;
+  mTree.traverse(
+      from,
+      dir,
+      1.0,
+      [this, &from, &dir, &hits, &hitAny](int index, s_t limit) {
+        s_t t;
+        Eigen::Vector3s normal;
+        if (raycastTarget(mTargets[index], from, dir, limit, t, normal))
+        {
+          RayHit hit;
+          hit.mCollisionObject = mTargets[index].mObject;
+          hit.mNormal = normal;
+          hit.mPoint = from + t * dir;
+          hit.mFraction = static_cast<double>(t);
+          hits.push_back(hit);
+          hitAny = true;
+        }
+        // Keep looking past this hit
+        return limit;
+      });
+  return hitAny;
+}
+
+//==============================================================================
+bool RaycastScene::raycastTarget(
+    const Target& target,
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT,
+    s_t& t,
+    Eigen::Vector3s& normal)
+{
+  // Work in the shape's frame. This leaves t unchanged.
+  const Eigen::Matrix3s& rotation = target.mTransform.linear();
+  const Eigen::Vector3s localFrom
+      = rotation.transpose() * (from - target.mTransform.translation());
+  const Eigen::Vector3s localDir = rotation.transpose() * dir;
+  const Eigen::Vector3s& size = target.mSize;
+  const s_t inf = std::numeric_limits<s_t>::infinity();
+
+  Eigen::Vector3s localNormal;
+  switch (target.mType)
+  {
+    case BOX: {
+      s_t tMin = 0.0;
+      s_t tMax = maxT;
+      int enterAxis = -1;
+      for (int i = 0; i < 3; i++)
+      {
+        if (localDir(i) == 0.0)
+        {
+          if (localFrom(i) < -size(i) || localFrom(i) > size(i))
+            return false;
+          continue;
+        }
+        s_t t0 = (-size(i) - localFrom(i)) / localDir(i);
+        s_t t1 = (size(i) - localFrom(i)) / localDir(i);
+        if (t0 > t1)
+          std::swap(t0, t1);
+        if (t0 > tMin)
+        {
+          tMin = t0;
+          enterAxis = i;
+        }
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+          return false;
+      }
+      // Rays starting inside the box don't hit it
+      if (enterAxis < 0)
+        return false;
+      t = tMin;
+      localNormal.setZero();
+      localNormal(enterAxis) = localDir(enterAxis) > 0.0 ? -1.0 : 1.0;
+      break;
+    }
+    case SPHERE: {
+      t = raycastSphere(
+          Eigen::Vector3s::Zero(), size(0), localFrom, localDir, maxT);
+      if (t == inf)
+        return false;
+      localNormal = localFrom + t * localDir;
+      break;
+    }
+    case ELLIPSOID: {
+      // Squash the ellipsoid into a unit sphere
+      const Eigen::Vector3s scaledFrom = localFrom.cwiseQuotient(size);
+      const Eigen::Vector3s scaledDir = localDir.cwiseQuotient(size);
+      t = raycastSphere(
+          Eigen::Vector3s::Zero(), 1.0, scaledFrom, scaledDir, maxT);
+      if (t == inf)
+        return false;
+      localNormal = (scaledFrom + t * scaledDir).cwiseQuotient(size);
+      break;
+    }
+    case CAPSULE:
+    case CYLINDER: {
+      const s_t radius = size(0);
+      const s_t halfHeight = size(2);
+      t = raycastCylinderSide(radius, halfHeight, localFrom, localDir, maxT);
+      int part = 0;
+      s_t candidate;
+      if (target.mType == CYLINDER)
+      {
+        candidate = raycastDisc(radius, halfHeight, localFrom, localDir, maxT);
+        if (candidate < t)
+        {
+          t = candidate;
+          part = 1;
+        }
+        candidate = raycastDisc(radius, -halfHeight, localFrom, localDir, maxT);
+        if (candidate < t)
+        {
+          t = candidate;
+          part = 2;
+        }
+      }
+      else
+      {
+        candidate = raycastSphere(
+            Eigen::Vector3s::UnitZ() * halfHeight,
+            radius,
+            localFrom,
+            localDir,
+            maxT);
+        if (candidate < t)
+        {
+          t = candidate;
+          part = 3;
+        }
+        candidate = raycastSphere(
+            -Eigen::Vector3s::UnitZ() * halfHeight,
+            radius,
+            localFrom,
+            localDir,
+            maxT);
+        if (candidate < t)
+        {
+          t = candidate;
+          part = 4;
+        }
+      }
+      if (t == inf)
+        return false;
+
+      const Eigen::Vector3s point = localFrom + t * localDir;
+      if (part == 0)
+        localNormal = Eigen::Vector3s(point.x(), point.y(), 0.0);
+      else if (part == 1)
+        localNormal = Eigen::Vector3s::UnitZ();
+      else if (part == 2)
+        localNormal = -Eigen::Vector3s::UnitZ();
+      else if (part == 3)
+        localNormal = point - Eigen::Vector3s::UnitZ() * halfHeight;
+      else
+        localNormal = point + Eigen::Vector3s::UnitZ() * halfHeight;
+      break;
+    }
+    case MESH: {
+      // The tree is in unscaled mesh coordinates, so unscale the ray. Normals
+      // transform by the inverse transpose of the scale.
+      Eigen::Vector3s meshNormal;
+      if (!target.mMesh->raycast(
+              localFrom.cwiseQuotient(size),
+              localDir.cwiseQuotient(size),
+              maxT,
+              t,
+              meshNormal))
+        return false;
+      localNormal = meshNormal.cwiseQuotient(size);
+      break;
+    }
+    default:
+      return false;
+  }
+
+  normal = rotation * localNormal.normalized();
+  return true;
+}
+
+} // namespace collision
+} // namespace dart
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_COLLISION_DART_DARTRAYCAST_HPP_
+#define DART_COLLISION_DART_DARTRAYCAST_HPP_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/collision/RaycastResult.hpp"
+#include "dart/math/MathTypes.hpp"
+
+struct aiScene;
+
+namespace dart {
+
+namespace dynamics {
+class Shape;
+} // namespace dynamics
+
+namespace collision {
+
+class CollisionObject;
+
+/// A bounding volume hierarchy over axis-aligned boxes, built once over a set
+/// of primitives and then queried with rays. Primitives are referred to by
+/// their index in the list of boxes the tree was built from.
+class RaycastBVH
+{
+public:
+  /// Builds the tree over the given boxes. mins[i] and maxs[i] bound the i'th
+  /// primitive.
+  void build(
+      const std::vector<Eigen::Vector3s>& mins,
+      const std::vector<Eigen::Vector3s>& maxs);
+
+  /// Returns true if the tree holds no primitives
+  bool empty() const;
+
+  /// Walks the tree roughly front to back along the ray "from + t * dir",
+  /// calling visit(primitive, maxT) for every primitive whose box the ray
+  /// enters for some t in [0, maxT]. The visitor returns the (possibly
+  /// shrunken) maxT, which is used to prune the rest of the walk. Returns the
+  /// final maxT.
+  template <typename Visitor>
+  s_t traverse(
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& dir,
+      s_t maxT,
+      Visitor&& visit) const;
+
+protected:
+  struct Node
+  {
+    Eigen::Vector3s mMin;
+    Eigen::Vector3s mMax;
+
+    /// For leaves, the first entry in mPrimitives. For interior nodes, the
+    /// index of the right child (the left child always directly follows its
+    /// parent).
+    int mIndex;
+
+    /// The number of primitives in a leaf, or 0 for interior nodes
+    int mCount;
+  };
+
+  /// Recursively builds the subtree over mPrimitives[begin, end)
+  void buildNode(
+      int begin,
+      int end,
+      const std::vector<Eigen::Vector3s>& mins,
+      const std::vector<Eigen::Vector3s>& maxs,
+      const std::vector<Eigen::Vector3s>& centers);
+
+  /// Returns the t at which the ray enters the node's box, or infinity if it
+  /// misses the box within [0, maxT]
+  static s_t enter(
+      const Node& node,
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& invDir,
+      s_t maxT);
+
+  std::vector<Node> mNodes;
+
+  std::vector<int> mPrimitives;
+};
+
+/// The triangles of a mesh, in the mesh's own (unscaled) coordinates, along
+/// with a RaycastBVH over them. These only depend on the aiScene, so they can
+/// be shared between every MeshShape that uses the same scene.
+class MeshRaycastBVH
+{
+public:
+  /// Collects every triangle of every mesh in the scene and builds the tree
+  explicit MeshRaycastBVH(const aiScene* scene);
+
+  /// Returns the scene this was built from
+  const aiScene* getScene() const;
+
+  /// Intersects the ray "from + t * dir", t in [0, maxT], with the triangles.
+  /// On a hit, returns true and fills in t and the (unnormalized) normal of
+  /// the hit triangle, facing back against the ray.
+  bool raycast(
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& dir,
+      s_t maxT,
+      s_t& t,
+      Eigen::Vector3s& normal) const;
+
+protected:
+  const aiScene* mScene;
+
+  /// Three consecutive vertices per triangle
+  std::vector<Eigen::Vector3s> mVertices;
+
+  RaycastBVH mTree;
+};
+
+/// A snapshot of a set of collision objects, prepared for answering many ray
+/// queries. Preparing the scene reads the objects' world transforms and
+/// builds a RaycastBVH over their world-space bounding boxes, so it must
+/// happen on a single thread; after that, raycast() only reads from the
+/// snapshot and can be called from any number of threads at once.
+///
+/// Boxes, spheres, ellipsoids, capsules, cylinders and meshes are supported.
+/// Objects with other shapes are never hit.
+class RaycastScene
+{
+public:
+  /// A cached mesh tree, and the shape it was built for. The aiScene belongs
+  /// to that shape, so the tree is only trusted while the shape is alive and
+  /// hasn't changed since. Otherwise the scene may have been freed, and its
+  /// address reused by a different mesh.
+  struct MeshCacheEntry
+  {
+    std::shared_ptr<const MeshRaycastBVH> mTree;
+    std::weak_ptr<const dynamics::Shape> mShape;
+    std::size_t mShapeVersion;
+  };
+
+  /// Cache of mesh trees shared between scenes, and kept across calls.
+  /// prepare() evicts entries as soon as their shape is released or changed.
+  using MeshCache = std::unordered_map<const aiScene*, MeshCacheEntry>;
+
+  /// Snapshots the given objects. Mesh trees are looked up in (and added to)
+  /// meshCache.
+  void prepare(
+      const std::vector<CollisionObject*>& objects, MeshCache& meshCache);
+
+  /// Finds the closest hit along the segment from "from" to "to". Returns
+  /// false, and leaves hit untouched, if there isn't one.
+  bool raycast(
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& to,
+      RayHit& hit) const;
+
+  /// Appends the closest hit on every object the segment from "from" to "to"
+  /// passes through. Returns true if there was at least one.
+  bool raycastAll(
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& to,
+      std::vector<RayHit>& hits) const;
+
+protected:
+  enum TargetType
+  {
+    BOX,
+    SPHERE,
+    ELLIPSOID,
+    CAPSULE,
+    CYLINDER,
+    MESH
+  };
+
+  struct Target
+  {
+    const CollisionObject* mObject;
+
+    TargetType mType;
+
+    Eigen::Isometry3s mTransform;
+
+    /// Box: half extents. Sphere/ellipsoid: radii. Capsule/cylinder: radius,
+    /// radius, half height. Mesh: scale.
+    Eigen::Vector3s mSize;
+
+    std::shared_ptr<const MeshRaycastBVH> mMesh;
+  };
+
+  /// Intersects the ray with a single target, in world coordinates
+  static bool raycastTarget(
+      const Target& target,
+      const Eigen::Vector3s& from,
+      const Eigen::Vector3s& dir,
+      s_t maxT,
+      s_t& t,
+      Eigen::Vector3s& normal);
+
+  std::vector<Target> mTargets;
+
+  RaycastBVH mTree;
+};
+
+//==============================================================================
+template <typename Visitor>
+s_t RaycastBVH::traverse(
+    const Eigen::Vector3s& from,
+    const Eigen::Vector3s& dir,
+    s_t maxT,
+    Visitor&& visit) const
+{
+  if (mNodes.empty())
+    return maxT;
+
+  const Eigen::Vector3s invDir = dir.cwiseInverse();
+  if (enter(mNodes[0], from, invDir, maxT) > maxT)
+    return maxT;
+
+  // Each entry is a node index along with the t at which the ray enters it.
+  // The tree is balanced by construction, so 64 levels is plenty.
+  int stackNodes[64];
+  s_t stackTs[64];
+  int stackSize = 0;
+  stackNodes[stackSize] = 0;
+  stackTs[stackSize] = 0.0;
+  stackSize++;
+
+  while (stackSize > 0)
+  {
+    stackSize--;
+    const int index = stackNodes[stackSize];
+    if (stackTs[stackSize] > maxT)
+      continue;
+
+    const Node& node = mNodes[index];
+    if (node.mCount > 0)
+    {
+      for (int i = node.mIndex; i < node.mIndex + node.mCount; i++)
+        maxT = visit(mPrimitives[i], maxT);
+      continue;
+    }
+
+    const int left = index + 1;
+    const int right = node.mIndex;
+    const s_t leftT = enter(mNodes[left], from, invDir, maxT);
+    const s_t rightT = enter(mNodes[right], from, invDir, maxT);
+
+    // Push the farther child first, so the nearer one gets visited first and
+    // has a chance to shrink maxT
+    if (leftT <= rightT)
+    {
+      if (rightT <= maxT)
+      {
+        stackNodes[stackSize] = right;
+        stackTs[stackSize] = rightT;
+        stackSize++;
+      }
+      if (leftT <= maxT)
+      {
+        stackNodes[stackSize] = left;
+        stackTs[stackSize] = leftT;
+        stackSize++;
+      }
+    }
+    else
+    {
+      if (leftT <= maxT)
+      {
+        stackNodes[stackSize] = left;
+        stackTs[stackSize] = leftT;
+        stackSize++;
+      }
+      if (rightT <= maxT)
+      {
+        stackNodes[stackSize] = right;
+        stackTs[stackSize] = rightT;
+        stackSize++;
+      }
+    }
+  }
+
+  return maxT;
+}
+
+} // namespace collision
+} // namespace dart
+
+#endif // DART_COLLISION_DART_DARTRAYCAST_HPP_
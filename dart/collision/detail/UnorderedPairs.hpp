@@ -56,6 +56,10 @@ public:
   /// Returns true if this container contains the pair.
   bool contains(const T* left, const T* right) const;
 
+  /// Calls func(left, right) once for every pair in this container.
+  template <typename Func>
+  void forEachPair(Func func) const;
+
 private:
   /// The actual container to store pairs.
   ///
@@ -147,6 +151,18 @@ bool UnorderedPairs<T>::contains(const T* left, const T* right) const
   return false;
 }
 
+//==============================================================================
+template <class T>
+template <typename Func>
+void UnorderedPairs<T>::forEachPair(Func func) const
+{
+  for (const auto& entry : mList)
+  {
+    for (const T* right : entry.second)
+      func(entry.first, right);
+  }
+}
+
 } // namespace detail
 } // namespace collision
 } // namespace dart
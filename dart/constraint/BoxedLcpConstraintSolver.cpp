@@ -391,6 +391,18 @@ void BoxedLcpConstraintSolver::solveConstrainedGroup(
   if (mXResized)
   {
     mX = LCPUtils::guessSolution(aGradientBackup, mB, mHi, mLo, mFIndex);
+
+    // Contacts that persisted from last step remember the impulse they
+    // applied, which is a better guess than anything we can cook up here
+    for (std::size_t i = 0; i < numConstraints; ++i)
+    {
+      const ConstraintBasePtr& constraint = group.getConstraint(i);
+      if (constraint->isContactConstraint())
+      {
+        std::static_pointer_cast<ContactConstraint>(constraint)
+            ->getWarmStartImpulse(mX.data() + mOffset[i]);
+      }
+    }
     mXBackup = mX;
   }
 
@@ -32,6 +32,9 @@
 
 #include "dart/constraint/ConstraintSolver.hpp"
 
+#include <algorithm>
+#include <limits>
+
 #include "dart/collision/CollisionFilter.hpp"
 #include "dart/collision/CollisionGroup.hpp"
 #include "dart/collision/CollisionObject.hpp"
@@ -65,6 +68,9 @@ ConstraintSolver::ConstraintSolver(s_t timeStep)
     mCollisionOption(collision::CollisionOption(
         true, 1000u, std::make_shared<collision::BodyNodeCollisionFilter>())),
     mTimeStep(timeStep),
+    mContactConstraintGeneration(0),
+    mContactConstraintPoolingEnabled(true),
+    mNumConstrainedGroups(0),
     mGradientEnabled(false), // Default to no gradients
     mPenetrationCorrectionEnabled(
         false), // Default to no penetration correction, because it breaks our
@@ -82,6 +88,9 @@ ConstraintSolver::ConstraintSolver()
     mCollisionOption(collision::CollisionOption(
         true, 1000u, std::make_shared<collision::BodyNodeCollisionFilter>())),
     mTimeStep(0.001),
+    mContactConstraintGeneration(0),
+    mContactConstraintPoolingEnabled(true),
+    mNumConstrainedGroups(0),
     mGradientEnabled(false), // Default to no gradients
     mPenetrationCorrectionEnabled(
         false), // Default to no penetration correction, because it breaks our
@@ -143,6 +152,9 @@ void ConstraintSolver::removeSkeleton(const SkeletonPtr& skeleton)
   mSkeletons.erase(
       remove(mSkeletons.begin(), mSkeletons.end(), skeleton), mSkeletons.end());
   mConstrainedGroups.reserve(mSkeletons.size());
+
+  // Pooled constraints hold on to their bodies, so let them go
+  mContactConstraintPool.clear();
 }
 
 //==============================================================================
@@ -158,6 +170,7 @@ void ConstraintSolver::removeAllSkeletons()
 {
   mCollisionGroup->removeAllShapeFrames();
   mSkeletons.clear();
+  mContactConstraintPool.clear();
 }
 
 //==============================================================================
@@ -412,6 +425,18 @@ bool ConstraintSolver::getPenetrationCorrectionEnabled()
   return mPenetrationCorrectionEnabled;
 }
 
+//==============================================================================
+void ConstraintSolver::setContactConstraintPoolingEnabled(bool enable)
+{
+  mContactConstraintPoolingEnabled = enable;
+}
+
+//==============================================================================
+bool ConstraintSolver::getContactConstraintPoolingEnabled()
+{
+  return mContactConstraintPoolingEnabled;
+}
+
 //==============================================================================
 Eigen::VectorXs ConstraintSolver::getCachedLCPSolution()
 {
@@ -520,8 +545,12 @@ void ConstraintSolver::updateConstraints()
 
   mCollisionGroup->collide(mCollisionOption, &mCollisionResult);
 
-  // Destroy previous contact constraints
+  // Release last step's contact constraints. Anything in the pool that isn't
+  // claimed again under this new generation gets dropped at the end.
   mContactConstraints.clear();
+  for (std::size_t i = 0; i < mNumConstrainedGroups; i++)
+    mConstrainedGroups[i].removeAllConstraints();
+  mContactConstraintGeneration++;
 
   // Destroy previous soft contact constraints
   mSoftContactConstraints.clear();
@@ -565,11 +594,82 @@ void ConstraintSolver::updateConstraints()
     }
     else
     {
-      mContactConstraints.push_back(std::make_shared<ContactConstraint>(
-          contact, mTimeStep, mPenetrationCorrectionEnabled));
+      const dynamics::BodyNode* bodyA
+          = shapeFrame1->asShapeNode()->getBodyNodePtr().get();
+      const dynamics::BodyNode* bodyB
+          = shapeFrame2->asShapeNode()->getBodyNodePtr().get();
+      auto key = bodyA < bodyB ? std::make_pair(bodyA, bodyB)
+                               : std::make_pair(bodyB, bodyA);
+      std::vector<ContactConstraintPtr>& pooled = mContactConstraintPool[key];
+
+      // Match this contact to whichever constraint between these bodies, not
+      // yet claimed this step, was closest to it last step
+      std::size_t best = pooled.size();
+      s_t bestDistance = std::numeric_limits<s_t>::infinity();
+      for (std::size_t j = 0; j < pooled.size(); j++)
+      {
+        if (pooled[j]->mPoolGeneration == mContactConstraintGeneration)
+          continue;
+        s_t distance
+            = (pooled[j]->getLastContactPoint() - contact.point).squaredNorm();
+        if (distance < bestDistance)
+        {
+          best = j;
+          bestDistance = distance;
+        }
+      }
+
+      ContactConstraintPtr constraint;
+      if (best == pooled.size())
+      {
+        constraint = std::make_shared<ContactConstraint>(
+            contact, mTimeStep, mPenetrationCorrectionEnabled);
+        pooled.push_back(constraint);
+      }
+      else if (mContactConstraintPoolingEnabled)
+      {
+        constraint = pooled[best];
+        constraint->reset(contact, mTimeStep, mPenetrationCorrectionEnabled);
+      }
+      else
+      {
+        // Without pooling we still match contacts across steps, and carry the
+        // warm start over exactly as reset() would, so that turning pooling
+        // on or off never changes the simulation
+        ContactConstraintPtr previous = pooled[best];
+        constraint = std::make_shared<ContactConstraint>(
+            contact, mTimeStep, mPenetrationCorrectionEnabled);
+        constraint->mHasLastImpulse = previous->mHasLastImpulse
+                                      && previous->mBodyNodeA.get() == bodyA
+                                      && previous->mDim == constraint->mDim;
+        constraint->mLastImpulse = previous->mLastImpulse;
+        pooled[best] = constraint;
+      }
+      constraint->mPoolGeneration = mContactConstraintGeneration;
+      mContactConstraints.push_back(constraint);
     }
   }
 
+  // Anything left unclaimed belongs to a contact that went away
+  for (auto it = mContactConstraintPool.begin();
+       it != mContactConstraintPool.end();)
+  {
+    std::vector<ContactConstraintPtr>& pooled = it->second;
+    pooled.erase(
+        std::remove_if(
+            pooled.begin(),
+            pooled.end(),
+            [this](const ContactConstraintPtr& constraint) {
+              return constraint->mPoolGeneration
+                     != mContactConstraintGeneration;
+            }),
+        pooled.end());
+    if (pooled.empty())
+      it = mContactConstraintPool.erase(it);
+    else
+      ++it;
+  }
+
   // Add the new contact constraints to dynamic constraint list
   for (const auto& contactConstraint : mContactConstraints)
   {
@@ -680,8 +780,14 @@ void ConstraintSolver::updateConstraints()
 //==============================================================================
 void ConstraintSolver::buildConstrainedGroups()
 {
-  // Clear constrained groups
-  mConstrainedGroups.clear();
+  // Empty out last step's groups, keeping them around to reuse their storage
+  for (std::size_t i = 0; i < mNumConstrainedGroups; i++)
+  {
+    mConstrainedGroups[i].removeAllConstraints();
+    mConstrainedGroups[i].mRootSkeleton = nullptr;
+    mConstrainedGroups[i].setGradientConstraintMatrices(nullptr);
+  }
+  mNumConstrainedGroups = 0;
   if (mGradientEnabled)
   {
     for (const auto& skel : mSkeletons)
@@ -708,9 +814,9 @@ void ConstraintSolver::buildConstrainedGroups()
     bool found = false;
     const auto& skel = activeConstraint->getRootSkeleton();
 
-    for (const auto& constrainedGroup : mConstrainedGroups)
+    for (std::size_t i = 0; i < mNumConstrainedGroups; i++)
     {
-      if (constrainedGroup.mRootSkeleton == skel)
+      if (mConstrainedGroups[i].mRootSkeleton == skel)
       {
         found = true;
         break;
@@ -720,10 +826,11 @@ void ConstraintSolver::buildConstrainedGroups()
     if (found)
       continue;
 
-    ConstrainedGroup newConstGroup;
-    newConstGroup.mRootSkeleton = skel;
-    skel->mUnionIndex = mConstrainedGroups.size();
-    mConstrainedGroups.push_back(newConstGroup);
+    if (mNumConstrainedGroups == mConstrainedGroups.size())
+      mConstrainedGroups.push_back(ConstrainedGroup());
+    mConstrainedGroups[mNumConstrainedGroups].mRootSkeleton = skel;
+    skel->mUnionIndex = mNumConstrainedGroups;
+    mNumConstrainedGroups++;
   }
 
   // Add active constraints to constrained groups
@@ -736,10 +843,10 @@ void ConstraintSolver::buildConstrainedGroups()
   // Create the gradient matrices for this gradient mode
   if (mGradientEnabled)
   {
-    for (auto& constrainedGroup : mConstrainedGroups)
+    for (std::size_t i = 0; i < mNumConstrainedGroups; i++)
     {
-      auto m = neural::createGradientMatrices(constrainedGroup, mTimeStep);
-      constrainedGroup.setGradientConstraintMatrices(m);
+      auto m = neural::createGradientMatrices(mConstrainedGroups[i], mTimeStep);
+      mConstrainedGroups[i].setGradientConstraintMatrices(m);
     }
   }
 
@@ -753,8 +860,8 @@ void ConstraintSolver::buildConstrainedGroups()
 //==============================================================================
 void ConstraintSolver::solveConstrainedGroups(simulation::World* world)
 {
-  for (auto& constraintGroup : mConstrainedGroups)
-    solveConstrainedGroup(constraintGroup, world);
+  for (std::size_t i = 0; i < mNumConstrainedGroups; i++)
+    solveConstrainedGroup(mConstrainedGroups[i], world);
 }
 
 //==============================================================================
@@ -33,6 +33,7 @@
 #ifndef DART_CONSTRAINT_CONSTRAINTSOVER_HPP_
 #define DART_CONSTRAINT_CONSTRAINTSOVER_HPP_
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -201,6 +202,14 @@ public:
 
   bool getPenetrationCorrectionEnabled();
 
+  /// True by default. Sets whether contact constraints get reset and reused
+  /// from one step to the next, rather than reallocated. Either way, contacts
+  /// are matched across steps for warm starting, so this only changes how
+  /// much we allocate, not the results.
+  void setContactConstraintPoolingEnabled(bool enable);
+
+  bool getContactConstraintPoolingEnabled();
+
   /// This gets the cached LCP solution, which is useful to be able to get/set
   /// because it can effect the forward solutions of physics problems because of
   /// our optimistic LCP-stabilization-to-acceptance approach.
@@ -274,6 +283,23 @@ protected:
   /// Contact constraints those are automatically created
   std::vector<ContactConstraintPtr> mContactConstraints;
 
+  /// Contact constraints from the previous step, grouped by the pair of bodies
+  /// they act between. These get reset and reused for contacts between the
+  /// same bodies on the next step, rather than reallocated, and they carry
+  /// their last impulse along as a warm start.
+  std::map<
+      std::pair<const dynamics::BodyNode*, const dynamics::BodyNode*>,
+      std::vector<ContactConstraintPtr>>
+      mContactConstraintPool;
+
+  /// Bumped every time we collect contacts. A pooled constraint is claimed for
+  /// this step once its mPoolGeneration matches this.
+  std::size_t mContactConstraintGeneration;
+
+  /// If false, matched contacts still inherit their warm start from the pool,
+  /// but get a freshly constructed constraint
+  bool mContactConstraintPoolingEnabled;
+
   /// Soft contact constraints those are automatically created
   std::vector<SoftContactConstraintPtr> mSoftContactConstraints;
 
@@ -299,6 +325,10 @@ protected:
   /// Constraint group list
   std::vector<ConstrainedGroup> mConstrainedGroups;
 
+  /// The number of entries at the front of mConstrainedGroups that are in use
+  /// this step. The rest are kept around, empty, to be reused.
+  std::size_t mNumConstrainedGroups;
+
   /// The type of gradients we want to use for backprop
   bool mGradientEnabled;
 
@@ -68,24 +68,47 @@ ContactConstraint::ContactConstraint(
     s_t timeStep,
     bool penetrationCorrectionEnabled)
   : ConstraintBase(),
-    mTimeStep(timeStep),
-    mBodyNodeA(const_cast<dynamics::ShapeFrame*>(
-                   contact.collisionObject1->getShapeFrame())
-                   ->asShapeNode()
-                   ->getBodyNodePtr()),
-    mBodyNodeB(const_cast<dynamics::ShapeFrame*>(
-                   contact.collisionObject2->getShapeFrame())
-                   ->asShapeNode()
-                   ->getBodyNodePtr()),
-    mContact(contact),
+    mContact(nullptr),
     mFirstFrictionalDirection(Eigen::Vector3s::UnitZ()),
     mIsFrictionOn(true),
     mAppliedImpulseIndex(dynamics::INVALID_INDEX),
     mPenetrationCorrectionEnabled(penetrationCorrectionEnabled),
     mDidBounce(false),
     mIsBounceOn(false),
-    mActive(false)
+    mActive(false),
+    mHasLastImpulse(false),
+    mLastImpulse(Eigen::Vector3s::Zero()),
+    mPoolGeneration(0)
+{
+  reset(contact, timeStep, penetrationCorrectionEnabled);
+}
+
+//==============================================================================
+void ContactConstraint::reset(
+    collision::Contact& contact,
+    s_t timeStep,
+    bool penetrationCorrectionEnabled)
 {
+  dynamics::BodyNode* previousBodyNodeA = mBodyNodeA.get();
+  const std::size_t previousDim = mDim;
+
+  mTimeStep = timeStep;
+  mBodyNodeA = const_cast<dynamics::ShapeFrame*>(
+                   contact.collisionObject1->getShapeFrame())
+                   ->asShapeNode()
+                   ->getBodyNodePtr();
+  mBodyNodeB = const_cast<dynamics::ShapeFrame*>(
+                   contact.collisionObject2->getShapeFrame())
+                   ->asShapeNode()
+                   ->getBodyNodePtr();
+  mContact = &contact;
+  mFirstFrictionalDirection = Eigen::Vector3s::UnitZ();
+  mAppliedImpulseIndex = dynamics::INVALID_INDEX;
+  mPenetrationCorrectionEnabled = penetrationCorrectionEnabled;
+  mPenetrationCorrectionVelocity = 0.0;
+  mDidBounce = false;
+  mActive = false;
+
   assert(
       contact.normal.squaredNorm() >= DART_CONTACT_CONSTRAINT_EPSILON_SQUARED);
 
@@ -148,7 +171,7 @@ ContactConstraint::ContactConstraint(
     Eigen::Vector3s bodyPointA;
     Eigen::Vector3s bodyPointB;
 
-    collision::Contact& ct = mContact;
+    collision::Contact& ct = *mContact;
 
     // TODO(JS): Assumed that the number of tangent basis is 2.
     const TangentBasisMatrix D = getTangentBasisMatrixODE(ct.normal);
@@ -206,7 +229,7 @@ ContactConstraint::ContactConstraint(
     mSpatialNormalA.resize(6, 1);
     mSpatialNormalB.resize(6, 1);
 
-    collision::Contact& ct = mContact;
+    collision::Contact& ct = *mContact;
 
     // Contact normal in the local coordinates
     const Eigen::Vector3s bodyDirectionA
@@ -226,6 +249,15 @@ ContactConstraint::ContactConstraint(
     mSpatialNormalA.col(0).tail<3>().noalias() = bodyDirectionA;
     mSpatialNormalB.col(0).tail<3>().noalias() = bodyDirectionB;
   }
+
+  // The last impulse only makes a good warm start if it was applied in the
+  // same frame of reference
+  if (mBodyNodeA.get() != previousBodyNodeA || mDim != previousDim)
+  {
+    mHasLastImpulse = false;
+    mLastImpulse.setZero();
+  }
+  mLastContactPoint = contact.point;
 }
 
 //==============================================================================
@@ -380,7 +412,7 @@ void ContactConstraint::getInformation(ConstraintInfo* info)
     // Bouncing
     //------------------------------------------------------------------------
     // A. Penetration correction
-    s_t bouncingVelocity = mContact.penetrationDepth - mErrorAllowance;
+    s_t bouncingVelocity = mContact->penetrationDepth - mErrorAllowance;
     if (bouncingVelocity < 0.0)
     {
       bouncingVelocity = 0.0;
@@ -449,7 +481,7 @@ void ContactConstraint::getInformation(ConstraintInfo* info)
     // Bouncing
     //------------------------------------------------------------------------
     // A. Penetration correction
-    s_t bouncingVelocity = mContact.penetrationDepth - DART_ERROR_ALLOWANCE;
+    s_t bouncingVelocity = mContact->penetrationDepth - DART_ERROR_ALLOWANCE;
     if (bouncingVelocity < 0.0)
     {
       bouncingVelocity = 0.0;
@@ -617,6 +649,12 @@ void ContactConstraint::unexcite()
 //==============================================================================
 void ContactConstraint::applyImpulse(s_t* lambda)
 {
+  // Remember what we applied, so the next step can warm start from it if this
+  // constraint gets reused for the same contact
+  for (std::size_t i = 0; i < mDim; i++)
+    mLastImpulse(i) = lambda[i];
+  mHasLastImpulse = true;
+
   //----------------------------------------------------------------------------
   // Friction case
   //----------------------------------------------------------------------------
@@ -627,7 +665,7 @@ void ContactConstraint::applyImpulse(s_t* lambda)
     assert(!math::isNan(lambda[2]));
 
     // Store contact impulse (force) toward the normal w.r.t. world frame
-    mContact.force = mContact.normal * lambda[0] / mTimeStep;
+    mContact->force = mContact->normal * lambda[0] / mTimeStep;
 
     // Normal impulsive force
     if (mBodyNodeA->isReactive())
@@ -636,8 +674,8 @@ void ContactConstraint::applyImpulse(s_t* lambda)
       mBodyNodeB->addConstraintImpulse(mSpatialNormalB.col(0) * lambda[0]);
 
     // Add contact impulse (force) toward the tangential w.r.t. world frame
-    const Eigen::MatrixXs D = getTangentBasisMatrixODE(mContact.normal);
-    mContact.force += D.col(0) * lambda[1] / mTimeStep;
+    const Eigen::MatrixXs D = getTangentBasisMatrixODE(mContact->normal);
+    mContact->force += D.col(0) * lambda[1] / mTimeStep;
 
     // Tangential direction-1 impulsive force
     if (mBodyNodeA->isReactive())
@@ -646,7 +684,7 @@ void ContactConstraint::applyImpulse(s_t* lambda)
       mBodyNodeB->addConstraintImpulse(mSpatialNormalB.col(1) * lambda[1]);
 
     // Add contact impulse (force) toward the tangential w.r.t. world frame
-    mContact.force += D.col(1) * lambda[2] / mTimeStep;
+    mContact->force += D.col(1) * lambda[2] / mTimeStep;
 
     // Tangential direction-2 impulsive force
     if (mBodyNodeA->isReactive())
@@ -667,7 +705,7 @@ void ContactConstraint::applyImpulse(s_t* lambda)
       mBodyNodeB->addConstraintImpulse(mSpatialNormalB * lambda[0]);
 
     // Store contact impulse (force) toward the normal w.r.t. world frame
-    mContact.force = mContact.normal * lambda[0] / mTimeStep;
+    mContact->force = mContact->normal * lambda[0] / mTimeStep;
   }
 }
 
@@ -715,6 +753,14 @@ void ContactConstraint::updateFirstFrictionalDirection()
 //==============================================================================
 ContactConstraint::TangentBasisMatrix
 ContactConstraint::getTangentBasisMatrixODE(const Eigen::Vector3s& n)
+{
+  return getTangentBasisMatrixODE(mFirstFrictionalDirection, n);
+}
+
+//==============================================================================
+ContactConstraint::TangentBasisMatrix
+ContactConstraint::getTangentBasisMatrixODE(
+    const Eigen::Vector3s& firstFrictionalDirection, const Eigen::Vector3s& n)
 {
   using namespace math::suffixes;
 
@@ -729,7 +775,7 @@ ContactConstraint::getTangentBasisMatrixODE(const Eigen::Vector3s& n)
 
   // Pick an arbitrary vector to take the cross product of (in this case,
   // Z-axis)
-  Eigen::Vector3s tangent = mFirstFrictionalDirection.cross(n);
+  Eigen::Vector3s tangent = firstFrictionalDirection.cross(n);
 
   // TODO(JS): Modify following lines once _updateFirstFrictionalDirection() is
   //           implemented.
@@ -782,6 +828,16 @@ ContactConstraint::getTangentBasisMatrixODE(const Eigen::Vector3s& n)
 ContactConstraint::TangentBasisMatrix
 ContactConstraint::getTangentBasisMatrixODEGradient(
     const Eigen::Vector3s& n, const Eigen::Vector3s& g)
+{
+  return getTangentBasisMatrixODEGradient(mFirstFrictionalDirection, n, g);
+}
+
+//==============================================================================
+ContactConstraint::TangentBasisMatrix
+ContactConstraint::getTangentBasisMatrixODEGradient(
+    const Eigen::Vector3s& firstFrictionalDirection,
+    const Eigen::Vector3s& n,
+    const Eigen::Vector3s& g)
 {
   using namespace math::suffixes;
 
@@ -791,7 +847,7 @@ ContactConstraint::getTangentBasisMatrixODEGradient(
 
   // Pick an arbitrary vector to take the cross product of (in this case,
   // Z-axis)
-  Eigen::Vector3s cross = mFirstFrictionalDirection;
+  Eigen::Vector3s cross = firstFrictionalDirection;
   Eigen::Vector3s tangent = cross.cross(n);
 
   // TODO(JS): Modify following lines once _updateFirstFrictionalDirection() is
@@ -904,7 +960,23 @@ std::vector<dynamics::SkeletonPtr> ContactConstraint::getSkeletons() const
 //==============================================================================
 const collision::Contact& ContactConstraint::getContact() const
 {
-  return mContact;
+  return *mContact;
+}
+
+//==============================================================================
+bool ContactConstraint::getWarmStartImpulse(s_t* lambda) const
+{
+  if (!mHasLastImpulse)
+    return false;
+  for (std::size_t i = 0; i < mDim; i++)
+    lambda[i] = mLastImpulse(i);
+  return true;
+}
+
+//==============================================================================
+const Eigen::Vector3s& ContactConstraint::getLastContactPoint() const
+{
+  return mLastContactPoint;
 }
 
 //==============================================================================
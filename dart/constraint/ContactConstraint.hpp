@@ -96,6 +96,16 @@ public:
   // Returns the contact
   const collision::Contact& getContact() const;
 
+  /// If this constraint applied an impulse on the previous step, and has been
+  /// reused for the same contact since, this copies that impulse into `lambda`
+  /// (which must have room for getDimension() values) and returns true.
+  bool getWarmStartImpulse(s_t* lambda) const;
+
+  /// Returns the world position of the contact this constraint was last reset
+  /// with. Unlike getContact(), this stays valid after the collision result
+  /// that the contact came from is cleared.
+  const Eigen::Vector3s& getLastContactPoint() const;
+
   // Returns body node A
   const dynamics::BodyNode* getBodyNodeA() const;
 
@@ -109,6 +119,18 @@ public:
   friend class ConstraintSolver;
   friend class ConstrainedGroup;
 
+protected:
+  /// This re-initializes the constraint for a new contact, so that
+  /// ConstraintSolver can reuse constraint objects from one step to the next.
+  /// Afterwards the constraint is in the same state as one freshly constructed
+  /// for `contact`, except that if the contact is between the same bodies, in
+  /// the same order, as before, the last applied impulse is kept for warm
+  /// starting.
+  void reset(
+      collision::Contact& contact,
+      s_t timeStep,
+      bool penetrationCorrectionEnabled);
+
 protected:
   //----------------------------------------------------------------------------
   // Constraint virtual functions
@@ -172,11 +194,24 @@ public:
 
   TangentBasisMatrix getTangentBasisMatrixODE(const Eigen::Vector3s& n);
 
+  /// Same as above, but for an explicit first frictional direction, so that
+  /// callers holding on to a copy of a contact don't depend on the live state
+  /// of the constraint it came from.
+  static TangentBasisMatrix getTangentBasisMatrixODE(
+      const Eigen::Vector3s& firstFrictionalDirection,
+      const Eigen::Vector3s& n);
+
   /// This returns the gradient of each element of the Tangent basis matrix, if
   /// `g` is the gradient of `n` with respect to whatever scalar we care about.
   TangentBasisMatrix getTangentBasisMatrixODEGradient(
       const Eigen::Vector3s& n, const Eigen::Vector3s& g);
 
+  /// Same as above, but for an explicit first frictional direction.
+  static TangentBasisMatrix getTangentBasisMatrixODEGradient(
+      const Eigen::Vector3s& firstFrictionalDirection,
+      const Eigen::Vector3s& n,
+      const Eigen::Vector3s& g);
+
 private:
   /// Time step
   s_t mTimeStep;
@@ -188,7 +223,7 @@ private:
   dynamics::BodyNodePtr mBodyNodeB;
 
   /// Contact between mBodyNode1 and mBodyNode2
-  collision::Contact& mContact;
+  collision::Contact* mContact;
 
   /// First frictional direction
   Eigen::Vector3s mFirstFrictionalDirection;
@@ -229,6 +264,19 @@ private:
   ///
   bool mActive;
 
+  /// True if mLastImpulse holds the impulse we applied on the last step
+  bool mHasLastImpulse;
+
+  /// The impulse we applied on the last step, used as a warm start
+  Eigen::Vector3s mLastImpulse;
+
+  /// The world position of the contact we were last reset with
+  Eigen::Vector3s mLastContactPoint;
+
+  /// The ConstraintSolver step that last claimed this constraint out of its
+  /// pool. Only the solver reads or writes this.
+  std::size_t mPoolGeneration;
+
   /// Global constraint error allowance
   static s_t mErrorAllowance;
 
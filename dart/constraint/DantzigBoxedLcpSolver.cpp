@@ -37,6 +37,16 @@
 namespace dart {
 namespace constraint {
 
+//==============================================================================
+DantzigBoxedLcpSolver::DantzigBoxedLcpSolver()
+  : mWorkspace(new dLCPWorkspace())
+{
+  // Do nothing
+}
+
+//==============================================================================
+DantzigBoxedLcpSolver::~DantzigBoxedLcpSolver() = default;
+
 //==============================================================================
 const std::string& DantzigBoxedLcpSolver::getType() const
 {
@@ -83,7 +93,17 @@ bool DantzigBoxedLcpSolver::solve(
       hi_d[i] = static_cast<double>(hi[i]);
     }
     bool ret = dSolveLCP(
-        n, A_d, x_d, b_d, nullptr, 0, lo_d, hi_d, findex, earlyTermination);
+        n,
+        A_d,
+        x_d,
+        b_d,
+        nullptr,
+        0,
+        lo_d,
+        hi_d,
+        findex,
+        earlyTermination,
+        mWorkspace.get());
     for (int i = 0; i < n; i++)
     {
       x[i] = static_cast<s_t>(x_d[i]);
@@ -95,7 +115,18 @@ bool DantzigBoxedLcpSolver::solve(
     delete[] hi_d;
     return ret;
 #else
-    return dSolveLCP(n, A, x, b, nullptr, 0, lo, hi, findex, earlyTermination);
+    return dSolveLCP(
+        n,
+        A,
+        x,
+        b,
+        nullptr,
+        0,
+        lo,
+        hi,
+        findex,
+        earlyTermination,
+        mWorkspace.get());
 #endif
   }
   catch (...)
@@ -33,14 +33,24 @@
 #ifndef DART_CONSTRAINT_DANTZIGBOXEDLCPSOLVER_HPP_
 #define DART_CONSTRAINT_DANTZIGBOXEDLCPSOLVER_HPP_
 
+#include <memory>
+
 #include "dart/constraint/BoxedLcpSolver.hpp"
 
+struct dLCPWorkspace;
+
 namespace dart {
 namespace constraint {
 
 class DantzigBoxedLcpSolver : public BoxedLcpSolver
 {
 public:
+  /// Constructor
+  DantzigBoxedLcpSolver();
+
+  /// Destructor
+  ~DantzigBoxedLcpSolver() override;
+
   // Documentation inherited.
   const std::string& getType() const override;
 
@@ -63,6 +73,11 @@ public:
   // Documentation inherited.
   bool canSolve(int n, const s_t* A) override;
 #endif
+
+protected:
+  /// Scratch memory of the pivoting solver. It only grows, so consecutive
+  /// solves of similarly sized problems don't allocate.
+  std::unique_ptr<dLCPWorkspace> mWorkspace;
 };
 
 } // namespace constraint
@@ -1,6 +1,9 @@
 #include "dart/constraint/LCPUtils.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #define MERGE_THRESHOLD 1e-4
@@ -8,6 +11,43 @@
 namespace dart {
 namespace constraint {
 
+namespace {
+
+/// A cell in the spatial hash used by LCPUtils::groupNearDuplicates()
+struct GridCell
+{
+  int cls;
+  long x;
+  long y;
+
+  bool operator==(const GridCell& other) const
+  {
+    return cls == other.cls && x == other.x && y == other.y;
+  }
+};
+
+struct GridCellHash
+{
+  std::size_t operator()(const GridCell& cell) const
+  {
+    std::size_t hash = std::hash<int>()(cell.cls);
+    hash = hash * 31 + std::hash<long>()(cell.x);
+    hash = hash * 31 + std::hash<long>()(cell.y);
+    return hash;
+  }
+};
+
+/// This rounds down to a cell coordinate. Huge and non-finite values all land
+/// in the outermost cells, which is fine because they never pass the distance
+/// check anyway.
+long quantize(s_t value)
+{
+  double clamped = std::max(-1e15, std::min(1e15, static_cast<double>(value)));
+  return static_cast<long>(std::floor(clamped));
+}
+
+} // namespace
+
 //==============================================================================
 bool LCPUtils::isLCPSolutionValid(
     const Eigen::MatrixXs& mA,
@@ -149,54 +189,9 @@ Eigen::MatrixXs LCPUtils::reduce(
     Eigen::VectorXs& lo,
     Eigen::VectorXi& fIndex)
 {
-  Eigen::MatrixXs reducedA = A;
-  Eigen::VectorXs reducedX = X;
-  Eigen::VectorXs reducedB = b;
-  Eigen::VectorXs reducedHi = hi;
-  Eigen::VectorXs reducedLo = lo;
-  Eigen::VectorXi reducedFIndex = fIndex;
+  Eigen::VectorXi groups = findDuplicateColumns(A, b, hi, lo, fIndex);
   Eigen::MatrixXs mapOut = Eigen::MatrixXs::Identity(A.rows(), A.cols());
-  // Step 1. Merge any duplicate columns, as long as we keep finding ones we can
-  // merge
-  while (true)
-  {
-    int n = reducedA.cols();
-    bool foundDuplicates = false;
-    for (int a = 0; a < n - 1; a++)
-    {
-      for (int b = a + 1; b < n; b++)
-      {
-        if ((reducedA.col(a) - reducedA.col(b)).squaredNorm() < MERGE_THRESHOLD
-            && (abs(reducedB(a) - reducedB(b)) < MERGE_THRESHOLD)
-            && (reducedFIndex(a) == reducedFIndex(b))
-            && (reducedHi(a) == reducedHi(b)) && (reducedLo(a) == reducedLo(b)))
-        {
-          foundDuplicates = true;
-          mergeLCPColumns(
-              a,
-              b,
-              reducedA,
-              reducedX,
-              reducedB,
-              reducedHi,
-              reducedLo,
-              reducedFIndex,
-              mapOut);
-          break;
-        }
-      }
-      if (foundDuplicates)
-        break;
-    }
-    if (!foundDuplicates)
-      break;
-  }
-  A = reducedA;
-  X = reducedX;
-  b = reducedB;
-  hi = reducedHi;
-  lo = reducedLo;
-  fIndex = reducedFIndex;
+  compactLCP(groups, A, X, b, hi, lo, fIndex, mapOut);
   return mapOut;
 }
 
@@ -213,36 +208,19 @@ Eigen::MatrixXs LCPUtils::removeFriction(
     Eigen::VectorXs& lo,
     Eigen::VectorXi& fIndex)
 {
-  Eigen::MatrixXs reducedA = A;
-  Eigen::VectorXs reducedX = X;
-  Eigen::VectorXs reducedB = b;
-  Eigen::VectorXs reducedHi = hi;
-  Eigen::VectorXs reducedLo = lo;
-  Eigen::VectorXi reducedFIndex = fIndex;
-  Eigen::MatrixXs mapOut = Eigen::MatrixXs::Identity(A.rows(), A.cols());
-
-  for (int i = fIndex.size() - 1; i >= 0; i--)
+  Eigen::VectorXi groups = Eigen::VectorXi::Constant(fIndex.size(), -1);
+  int cursor = 0;
+  for (int i = 0; i < fIndex.size(); i++)
   {
-    if (fIndex(i) != -1)
+    if (fIndex(i) == -1)
     {
-      dropLCPColumn(
-          i,
-          reducedA,
-          reducedX,
-          reducedB,
-          reducedHi,
-          reducedLo,
-          reducedFIndex,
-          mapOut);
+      groups(i) = cursor;
+      cursor++;
     }
   }
 
-  A = reducedA;
-  X = reducedX;
-  b = reducedB;
-  hi = reducedHi;
-  lo = reducedLo;
-  fIndex = reducedFIndex;
+  Eigen::MatrixXs mapOut = Eigen::MatrixXs::Identity(A.rows(), A.cols());
+  compactLCP(groups, A, X, b, hi, lo, fIndex, mapOut);
   return mapOut;
 }
 
@@ -262,42 +240,10 @@ bool LCPUtils::solveDeduplicated(
   Eigen::VectorXs reducedHi = hi;
   Eigen::VectorXs reducedLo = lo;
   Eigen::VectorXi reducedFIndex = fIndex;
-  Eigen::MatrixXs mapOut = Eigen::MatrixXs::Identity(A.rows(), A.cols());
-  // Step 1. Merge any duplicate columns, as long as we keep finding ones we can
-  // merge
-  while (true)
-  {
-    int n = reducedA.cols();
-    bool foundDuplicates = false;
-    for (int a = 0; a < n - 1; a++)
-    {
-      for (int b = a + 1; b < n; b++)
-      {
-        if ((reducedA.col(a) - reducedA.col(b)).squaredNorm() < MERGE_THRESHOLD
-            && (abs(reducedB(a) - reducedB(b)) < MERGE_THRESHOLD)
-            && (reducedFIndex(a) == reducedFIndex(b))
-            && (reducedHi(a) == reducedHi(b)) && (reducedLo(a) == reducedLo(b)))
-        {
-          foundDuplicates = true;
-          mergeLCPColumns(
-              a,
-              b,
-              reducedA,
-              reducedX,
-              reducedB,
-              reducedHi,
-              reducedLo,
-              reducedFIndex,
-              mapOut);
-          break;
-        }
-      }
-      if (foundDuplicates)
-        break;
-    }
-    if (!foundDuplicates)
-      break;
-  }
+  // Step 1. Merge any duplicate columns
+  Eigen::MatrixXs mapOut = reduce(
+      reducedA, reducedX, reducedB, reducedHi, reducedLo, reducedFIndex);
+
   Eigen::MatrixXs oldA = reducedA;
   Eigen::VectorXs oldX = reducedX;
   Eigen::VectorXs oldLo = reducedLo;
@@ -354,103 +300,229 @@ void LCPUtils::mergeLCPColumns(
     Eigen::VectorXi& fIndex,
     Eigen::MatrixXs& mapOut)
 {
-  assert(colA < colB);
+  // The group indices below assume colB is the later column, since the
+  // columns after it shift down by one while colA keeps its place
+  assert(0 <= colA && colA < colB && colB < A.cols());
   assert((A.col(colA) - A.col(colB)).squaredNorm() < MERGE_THRESHOLD);
   assert(abs(b(colA) - b(colB)) < MERGE_THRESHOLD);
   assert(fIndex(colA) == fIndex(colB));
   assert(hi(colA) == hi(colB));
   assert(lo(colA) == lo(colB));
 
-  int n = A.cols();
-  Eigen::MatrixXs newACols = Eigen::MatrixXs::Zero(n, n - 1);
-  Eigen::VectorXs newX = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newB = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newHi = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newLo = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXi newFIndex = Eigen::VectorXi::Zero(n - 1);
-  Eigen::MatrixXs newMapOut = Eigen::MatrixXs::Zero(mapOut.rows(), n - 1);
+  Eigen::VectorXi groups = Eigen::VectorXi::Zero(A.cols());
+  for (int i = 0; i < A.cols(); i++)
+  {
+    if (i < colB)
+      groups(i) = i;
+    else if (i == colB)
+      groups(i) = colA;
+    else
+      groups(i) = i - 1;
+  }
+  compactLCP(groups, A, X, b, hi, lo, fIndex, mapOut);
+}
 
-  // Map columns down
-  for (int i = 0; i < n; i++)
+//==============================================================================
+/// This will modify the LCP problem formulation to drop a column
+/// and rewrite and resize all the matrices appropriately.
+/// It'll also update the mapOut matrix, so that it's possible to simply
+/// multiply mapOut*x on the reduced problem to get a valid solution to the
+/// larger problem.
+void LCPUtils::dropLCPColumn(
+    int col,
+    Eigen::MatrixXs& A,
+    Eigen::VectorXs& X,
+    Eigen::VectorXs& b,
+    Eigen::VectorXs& hi,
+    Eigen::VectorXs& lo,
+    Eigen::VectorXi& fIndex,
+    Eigen::MatrixXs& mapOut)
+{
+  Eigen::VectorXi groups = Eigen::VectorXi::Zero(A.cols());
+  for (int i = 0; i < A.cols(); i++)
+  {
+    if (i < col)
+      groups(i) = i;
+    else if (i == col)
+      groups(i) = -1;
+    else
+      groups(i) = i - 1;
+  }
+  compactLCP(groups, A, X, b, hi, lo, fIndex, mapOut);
+}
+
+//==============================================================================
+/// This finds the groups of near-identical columns that reduce() merges. Two
+/// columns can merge if their columns of A are within MERGE_THRESHOLD squared
+/// distance, their b's are within MERGE_THRESHOLD, their bounds are equal, and
+/// (for friction) the normals they're bounded by are in the same group.
+Eigen::VectorXi LCPUtils::findDuplicateColumns(
+    const Eigen::MatrixXs& A,
+    const Eigen::VectorXs& b,
+    const Eigen::VectorXs& hi,
+    const Eigen::VectorXs& lo,
+    const Eigen::VectorXi& fIndex)
+{
+  const int n = A.cols();
+  Eigen::VectorXi groups = Eigen::VectorXi::Constant(n, -1);
+
+  // Friction columns can only merge once we know which normals merged, so we
+  // group the columns without an fIndex first, and the friction columns
+  // second.
+  int numGroups = 0;
+  for (int pass = 0; pass < 2; pass++)
   {
-    if (i == colB)
+    std::vector<int> indices;
+    for (int i = 0; i < n; i++)
     {
-      newMapOut.col(colA) += mapOut.col(i);
+      if ((fIndex(i) == -1) == (pass == 0))
+        indices.push_back(i);
     }
-    else
+    if (indices.empty())
+      continue;
+
+    Eigen::MatrixXs signatures = Eigen::MatrixXs::Zero(n, indices.size());
+    Eigen::VectorXi classes = Eigen::VectorXi::Zero(indices.size());
+    for (int k = 0; k < (int)indices.size(); k++)
     {
-      int newIndex = i;
-      if (i > colB)
+      int i = indices[k];
+      signatures.col(k) = A.col(i);
+      if (pass == 1)
       {
-        newIndex--;
+        // Friction bounded by another friction column (which never happens
+        // for contacts) can only merge with friction bounded by that same
+        // column.
+        int target = fIndex(i);
+        classes(k) = groups(target) != -1 ? groups(target) : n + target;
       }
+    }
 
-      newACols.col(newIndex) = A.col(i);
-      if (i == colA)
-      {
-        newACols.col(newIndex) *= 2.0;
-      }
-      newX(newIndex) = X(i);
-      newB(newIndex) = b(i);
-      newHi(newIndex) = hi(i);
-      newLo(newIndex) = lo(i);
-      if (fIndex(i) < colB)
-      {
-        newFIndex(newIndex) = fIndex(i);
-      }
-      else if (fIndex(i) == colB)
-      {
-        newFIndex(newIndex) = colA;
-      }
-      else if (fIndex(i) > colB)
-      {
-        newFIndex(newIndex) = fIndex(i) - 1;
-      }
-      else
-      {
-        // This code should never run
-        assert(false);
-      }
+    Eigen::VectorXi subgroups = groupNearDuplicates(
+        signatures,
+        MERGE_THRESHOLD,
+        classes,
+        [&](int representative, int candidate) {
+          int r = indices[representative];
+          int c = indices[candidate];
+          return abs(b(r) - b(c)) < MERGE_THRESHOLD && hi(r) == hi(c)
+                 && lo(r) == lo(c);
+        });
+
+    int numSubgroups = 0;
+    for (int k = 0; k < (int)indices.size(); k++)
+    {
+      groups(indices[k]) = numGroups + subgroups(k);
+      numSubgroups = std::max(numSubgroups, subgroups(k) + 1);
+    }
+    numGroups += numSubgroups;
+  }
 
-      newMapOut.col(newIndex) += mapOut.col(i);
+  // Renumber the groups in the order they first appear, so that compactLCP()
+  // keeps the surviving columns in their original order
+  std::vector<int> renumbering(numGroups, -1);
+  int cursor = 0;
+  for (int i = 0; i < n; i++)
+  {
+    if (renumbering[groups(i)] == -1)
+    {
+      renumbering[groups(i)] = cursor;
+      cursor++;
     }
+    groups(i) = renumbering[groups(i)];
   }
 
-  // Map rows down for A
-  Eigen::MatrixXs newA = Eigen::MatrixXs::Zero(n - 1, n - 1);
+  return groups;
+}
+
+//==============================================================================
+/// This groups the columns of `signatures`. Each column joins the group of
+/// the first earlier group representative with the same class, within
+/// `threshold` squared distance, that passes `canMerge` (if it's not null).
+/// Otherwise it becomes the representative of a new group. Groups are
+/// numbered in the order they first appear.
+Eigen::VectorXi LCPUtils::groupNearDuplicates(
+    const Eigen::MatrixXs& signatures,
+    s_t threshold,
+    const Eigen::VectorXi& classes,
+    std::function<bool(int, int)> canMerge)
+{
+  assert(threshold > 0);
+  assert(classes.size() == 0 || classes.size() == signatures.cols());
+  const int n = signatures.cols();
+  const int dim = signatures.rows();
+  Eigen::VectorXi groups = Eigen::VectorXi::Constant(n, -1);
+
+  // We hash each column on two projections onto unit vectors: the mean and
+  // the alternating-sign mean, scaled by sqrt(dim). Two columns within
+  // sqrt(threshold) of each other are within sqrt(threshold) on each
+  // projection, so with cells that size they land in the same cell or in
+  // neighboring ones.
+  const s_t cellSize = sqrt(threshold);
+  const s_t scale = dim > 0 ? 1.0 / sqrt((s_t)dim) : 0.0;
+  Eigen::VectorXs alternating(dim);
+  for (int k = 0; k < dim; k++)
+  {
+    alternating(k) = k % 2 == 0 ? scale : -scale;
+  }
+  Eigen::VectorXs sums = signatures.colwise().sum().transpose() * scale;
+  Eigen::VectorXs alternatingSums = signatures.transpose() * alternating;
+
+  std::unordered_map<GridCell, std::vector<int>, GridCellHash> representatives;
+  std::vector<int> representativeGroups;
+
   for (int i = 0; i < n; i++)
   {
-    if (i == colB)
+    GridCell cell;
+    cell.cls = classes.size() == 0 ? 0 : classes(i);
+    cell.x = quantize(sums(i) / cellSize);
+    cell.y = quantize(alternatingSums(i) / cellSize);
+
+    int bestRepresentative = -1;
+    for (long dx = -1; dx <= 1; dx++)
     {
-      // Do nothing, this is being deleted
+      for (long dy = -1; dy <= 1; dy++)
+      {
+        GridCell neighbor = cell;
+        neighbor.x += dx;
+        neighbor.y += dy;
+        auto bucket = representatives.find(neighbor);
+        if (bucket == representatives.end())
+          continue;
+        for (int r : bucket->second)
+        {
+          // We want the earliest match, so anything later than the best we've
+          // found can be skipped without the expensive check
+          if (bestRepresentative != -1 && r > bestRepresentative)
+            continue;
+          if ((signatures.col(r) - signatures.col(i)).squaredNorm() < threshold
+              && (!canMerge || canMerge(r, i)))
+          {
+            bestRepresentative = r;
+          }
+        }
+      }
+    }
+
+    if (bestRepresentative != -1)
+    {
+      groups(i) = groups(bestRepresentative);
     }
     else
     {
-      int newIndex = i;
-      if (i > colB)
-        newIndex--;
-      newA.row(newIndex) = newACols.row(i);
+      groups(i) = representativeGroups.size();
+      representativeGroups.push_back(i);
+      representatives[cell].push_back(i);
     }
   }
 
-  // Write out results
-  A = newA;
-  X = newX;
-  b = newB;
-  hi = newHi;
-  lo = newLo;
-  fIndex = newFIndex;
-  mapOut = newMapOut;
+  return groups;
 }
 
 //==============================================================================
-/// This will modify the LCP problem formulation to drop a column
-/// and rewrite and resize all the matrices appropriately.
-/// It'll also update the mapOut matrix, so that it's possible to simply
-/// multiply mapOut*x on the reduced problem to get a valid solution to the
-/// larger problem.
-void LCPUtils::dropLCPColumn(
-    int col,
+/// This rewrites an LCP in a single pass, merging every column into the group
+/// given by `groups`, or dropping it if its group is -1.
+void LCPUtils::compactLCP(
+    const Eigen::VectorXi& groups,
     Eigen::MatrixXs& A,
     Eigen::VectorXs& X,
     Eigen::VectorXs& b,
@@ -459,66 +531,56 @@ void LCPUtils::dropLCPColumn(
     Eigen::VectorXi& fIndex,
     Eigen::MatrixXs& mapOut)
 {
-  int n = A.cols();
-  Eigen::MatrixXs newACols = Eigen::MatrixXs::Zero(n, n - 1);
-  Eigen::VectorXs newX = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newB = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newHi = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXs newLo = Eigen::VectorXs::Zero(n - 1);
-  Eigen::VectorXi newFIndex = Eigen::VectorXi::Zero(n - 1);
-  Eigen::MatrixXs newMapOut = Eigen::MatrixXs::Zero(mapOut.rows(), n - 1);
-
-  // Map columns down
+  const int n = A.cols();
+  assert(groups.size() == n);
+  const int newN = n == 0 ? 0 : std::max(groups.maxCoeff() + 1, 0);
+
+  // The first column in each group is the one we keep
+  std::vector<int> representatives(newN, -1);
+  Eigen::VectorXs groupSizes = Eigen::VectorXs::Zero(newN);
+  Eigen::MatrixXs newMapOut = Eigen::MatrixXs::Zero(mapOut.rows(), newN);
   for (int i = 0; i < n; i++)
   {
-    if (i == col)
-    {
-      // Delete column
-    }
-    else
-    {
-      int newIndex = i;
-      if (i > col)
-      {
-        newIndex--;
-      }
-
-      newACols.col(newIndex) = A.col(i);
-      newX(newIndex) = X(i);
-      newB(newIndex) = b(i);
-      newHi(newIndex) = hi(i);
-      newLo(newIndex) = lo(i);
-      if (fIndex(i) < col)
-      {
-        newFIndex(newIndex) = fIndex(i);
-      }
-      else if (fIndex(i) > col)
-      {
-        newFIndex(newIndex) = fIndex(i) - 1;
-      }
-      else if (fIndex(i) == col)
-      {
-        assert(false && "You shouldn't be removing columns that other columns depend on!");
-      }
-
-      newMapOut.col(newIndex) += mapOut.col(i);
-    }
+    int group = groups(i);
+    if (group == -1)
+      continue;
+    if (representatives[group] == -1)
+      representatives[group] = i;
+    groupSizes(group) += 1.0;
+    newMapOut.col(group) += mapOut.col(i);
   }
 
-  // Map rows down for A
-  Eigen::MatrixXs newA = Eigen::MatrixXs::Zero(n - 1, n - 1);
-  for (int i = 0; i < n; i++)
+  // Every column in a group gets the same x, so a merged column of A is the
+  // representative's column times the size of its group
+  Eigen::MatrixXs newA = Eigen::MatrixXs::Zero(newN, newN);
+  Eigen::VectorXs newX = Eigen::VectorXs::Zero(newN);
+  Eigen::VectorXs newB = Eigen::VectorXs::Zero(newN);
+  Eigen::VectorXs newHi = Eigen::VectorXs::Zero(newN);
+  Eigen::VectorXs newLo = Eigen::VectorXs::Zero(newN);
+  Eigen::VectorXi newFIndex = Eigen::VectorXi::Zero(newN);
+  for (int col = 0; col < newN; col++)
   {
-    if (i == col)
+    int i = representatives[col];
+    assert(i != -1 && "Groups must be numbered 0 to (num groups - 1)");
+    for (int row = 0; row < newN; row++)
+    {
+      newA(row, col) = A(representatives[row], i) * groupSizes(col);
+    }
+    newX(col) = X(i);
+    newB(col) = b(i);
+    newHi(col) = hi(i);
+    newLo(col) = lo(i);
+    if (fIndex(i) == -1)
     {
-      // Do nothing, this is being deleted
+      newFIndex(col) = -1;
     }
     else
     {
-      int newIndex = i;
-      if (i > col)
-        newIndex--;
-      newA.row(newIndex) = newACols.row(i);
+      assert(
+          groups(fIndex(i)) != -1
+          && "You shouldn't be removing columns that other columns depend "
+             "on!");
+      newFIndex(col) = groups(fIndex(i));
     }
   }
 
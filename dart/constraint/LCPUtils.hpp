@@ -1,6 +1,7 @@
 #ifndef DART_CONSTRAINT_LCPUTILS_HPP_
 #define DART_CONSTRAINT_LCPUTILS_HPP_
 
+#include <functional>
 #include <memory>
 
 #include <Eigen/Dense>
@@ -74,7 +75,7 @@ public:
   /// also yell and scream (throw asserts) if the columns shouldn't be merged.
   /// It'll also update the mapOut matrix, so that it's possible to simply
   /// multiply mapOut*x on the reduced problem to get a valid solution to the
-  /// larger problem.
+  /// larger problem. colA must come before colB.
   static void mergeLCPColumns(
       int colA,
       int colB,
@@ -101,6 +102,47 @@ public:
       Eigen::VectorXi& fIndex,
       Eigen::MatrixXs& mapOut);
 
+  /// This finds the groups of near-identical columns that reduce() merges,
+  /// in a form that can be passed to compactLCP()
+  static Eigen::VectorXi findDuplicateColumns(
+      const Eigen::MatrixXs& A,
+      const Eigen::VectorXs& b,
+      const Eigen::VectorXs& hi,
+      const Eigen::VectorXs& lo,
+      const Eigen::VectorXi& fIndex);
+
+  /// This groups the columns of `signatures`. Each column joins the group of
+  /// the first earlier group representative with the same class, within
+  /// `threshold` squared distance, that passes `canMerge(representative,
+  /// column)` (if it's not null). Otherwise it becomes the representative of
+  /// a new group. Groups are numbered in the order they first appear. If
+  /// `classes` is empty, every column is in the same class.
+  ///
+  /// Rather than comparing every pair of columns, this buckets the
+  /// representatives in a spatial hash, so each column is only compared
+  /// against the representatives in neighboring cells. That's close to
+  /// linear time, even for the dozens of identical rows a mesh resting on the
+  /// ground produces.
+  static Eigen::VectorXi groupNearDuplicates(
+      const Eigen::MatrixXs& signatures,
+      s_t threshold,
+      const Eigen::VectorXi& classes,
+      std::function<bool(int, int)> canMerge = nullptr);
+
+  /// This rewrites the LCP problem in a single pass, merging each column into
+  /// the group `groups(i)`, or dropping it if `groups(i)` is -1. Groups must
+  /// be numbered from 0, and the first column in each group is the one we
+  /// keep. Like mergeLCPColumns(), it'll also update the mapOut matrix.
+  static void compactLCP(
+      const Eigen::VectorXi& groups,
+      Eigen::MatrixXs& A,
+      Eigen::VectorXs& X,
+      Eigen::VectorXs& b,
+      Eigen::VectorXs& hi,
+      Eigen::VectorXs& lo,
+      Eigen::VectorXi& fIndex,
+      Eigen::MatrixXs& mapOut);
+
   /// Print replication code info
   static void printReplicationCode(
       Eigen::MatrixXs A,
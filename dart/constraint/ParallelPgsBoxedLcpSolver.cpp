@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/constraint/ParallelPgsBoxedLcpSolver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include <Eigen/Dense>
+
+#include "dart/external/odelcpsolver/matrix.h"
+
+#define PARALLEL_PGS_EPSILON 10e-9
+
+namespace dart {
+namespace constraint {
+
+namespace {
+
+//==============================================================================
+/// Reusable barrier for the worker threads of one solve. The sweeps between
+/// two barriers are short, so the waiting threads spin instead of sleeping.
+class SpinBarrier
+{
+public:
+  explicit SpinBarrier(int numThreads)
+    : mNumThreads(numThreads), mCount(0), mGeneration(0)
+  {
+    // Do nothing
+  }
+
+  void wait()
+  {
+    if (mNumThreads <= 1)
+      return;
+
+    const int generation = mGeneration.load(std::memory_order_acquire);
+    if (mCount.fetch_add(1, std::memory_order_acq_rel) + 1 == mNumThreads)
+    {
+      mCount.store(0, std::memory_order_relaxed);
+      mGeneration.fetch_add(1, std::memory_order_release);
+    }
+    else
+    {
+      while (mGeneration.load(std::memory_order_acquire) == generation)
+        std::this_thread::yield();
+    }
+  }
+
+private:
+  const int mNumThreads;
+  std::atomic<int> mCount;
+  std::atomic<int> mGeneration;
+};
+
+//==============================================================================
+/// The [begin, end) share of count items that thread tid works on.
+void getChunk(int count, int tid, int numThreads, int& begin, int& end)
+{
+  begin = static_cast<int>(static_cast<long>(count) * tid / numThreads);
+  end = static_cast<int>(static_cast<long>(count) * (tid + 1) / numThreads);
+}
+
+//==============================================================================
+s_t clampToBounds(s_t value, s_t lo, s_t hi)
+{
+  if (value > hi)
+    return hi;
+  if (value < lo)
+    return lo;
+  return value;
+}
+
+} // namespace
+
+//==============================================================================
+ParallelPgsBoxedLcpSolver::Option::Option(
+    int maxIteration,
+    s_t residualTolerance,
+    int residualCheckInterval,
+    s_t epsilonForDivision,
+    int numThreads,
+    int minRowsPerThread,
+    bool useJacobi,
+    s_t jacobiRelaxation)
+  : mMaxIteration(maxIteration),
+    mResidualTolerance(residualTolerance),
+    mResidualCheckInterval(residualCheckInterval),
+    mEpsilonForDivision(epsilonForDivision),
+    mNumThreads(numThreads),
+    mMinRowsPerThread(minRowsPerThread),
+    mUseJacobi(useJacobi),
+    mJacobiRelaxation(jacobiRelaxation)
+{
+  // Do nothing
+}
+
+//==============================================================================
+const std::string& ParallelPgsBoxedLcpSolver::getType() const
+{
+  return getStaticType();
+}
+
+//==============================================================================
+const std::string& ParallelPgsBoxedLcpSolver::getStaticType()
+{
+  static const std::string type = "ParallelPgsBoxedLcpSolver";
+  return type;
+}
+
+//==============================================================================
+bool ParallelPgsBoxedLcpSolver::solve(
+    int n,
+    s_t* A,
+    s_t* x,
+    s_t* b,
+    int nub,
+    s_t* lo,
+    s_t* hi,
+    int* findex,
+    bool /*earlyTermination*/)
+{
+  mNumColors = 0;
+  mNumIterations = 0;
+
+  if (n <= 0)
+    return true;
+
+  const int nskip = dPAD(n);
+
+  // If all the variables are unbounded then we can just factor and solve.
+  if (nub >= n)
+  {
+    Eigen::Map<
+        const Eigen::Matrix<s_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+        0,
+        Eigen::OuterStride<>>
+        APadded(A, n, n, Eigen::OuterStride<>(nskip));
+    Eigen::Map<Eigen::VectorXs>(x, n)
+        = APadded.ldlt().solve(Eigen::Map<const Eigen::VectorXs>(b, n));
+    return true;
+  }
+
+  buildSparseRows(n, A, findex);
+  if (!mOption.mUseJacobi)
+    colorRows(n, findex);
+
+  const bool useJacobi = mOption.mUseJacobi;
+  const s_t relaxation = mOption.mJacobiRelaxation;
+  const int maxIteration = std::max(1, mOption.mMaxIteration);
+  const int checkInterval = std::max(1, mOption.mResidualCheckInterval);
+  const s_t tolerance = mOption.mResidualTolerance;
+
+  int numThreads = mOption.mNumThreads;
+  if (numThreads <= 0)
+    numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  numThreads = std::min(
+      numThreads, std::max(1, n / std::max(1, mOption.mMinRowsPerThread)));
+
+  mThreadResidual.assign(numThreads, 0.0);
+  if (useJacobi)
+    mZ.resize(n);
+
+  // Rows that can't be divided by are pinned at zero, the rest warm start
+  // from the incoming x
+  for (int i = 0; i < n; ++i)
+  {
+    if (mInvDiag[i] == 0.0)
+      x[i] = 0.0;
+  }
+
+  const auto isFriction = [findex](int i) {
+    return findex && findex[i] >= 0 && findex[i] != i;
+  };
+
+  // The unconstrained minimizer of row i, given all the other x's
+  const auto relaxRow = [this, b, x](int i) -> s_t {
+    s_t sum = b[i];
+    for (int k = mRowStart[i]; k < mRowStart[i + 1]; ++k)
+      sum -= mVals[k] * x[mCols[k]];
+    return sum * mInvDiag[i];
+  };
+
+  // Projects a candidate value of row i onto its bounds, where a friction
+  // row's bounds scale with the value of its normal row
+  const auto projectRow = [&](int i, s_t value, s_t normal) -> s_t {
+    if (i < nub)
+      return value;
+    if (isFriction(i))
+    {
+      const s_t bound = abs(hi[i] * normal);
+      return clampToBounds(value, -bound, bound);
+    }
+    return clampToBounds(value, lo[i], hi[i]);
+  };
+
+  bool converged = false;
+
+  const auto worker = [&](int tid, SpinBarrier& barrier) {
+    int begin;
+    int end;
+    for (int iter = 0; iter < maxIteration; ++iter)
+    {
+      if (useJacobi)
+      {
+        // Every row relaxes from the previous iterate...
+        getChunk(n, tid, numThreads, begin, end);
+        for (int i = begin; i < end; ++i)
+        {
+          mZ[i] = (mInvDiag[i] == 0.0)
+                      ? 0.0
+                      : x[i] + relaxation * (relaxRow(i) - x[i]);
+        }
+        barrier.wait();
+
+        // ...and is then projected, reading the normal from the new iterate
+        for (int i = begin; i < end; ++i)
+        {
+          s_t normal = 0.0;
+          if (isFriction(i))
+          {
+            const int parent = findex[i];
+            normal = isFriction(parent)
+                         ? mZ[parent]
+                         : projectRow(parent, mZ[parent], 0.0);
+          }
+          x[i] = projectRow(i, mZ[i], normal);
+        }
+        barrier.wait();
+      }
+      else
+      {
+        // Rows of one color aren't coupled to each other, so they can be
+        // relaxed in any order and on any thread
+        for (int c = 0; c < mNumColors; ++c)
+        {
+          const int colorBegin = mColorStart[c];
+          getChunk(
+              mColorStart[c + 1] - colorBegin, tid, numThreads, begin, end);
+          for (int k = colorBegin + begin; k < colorBegin + end; ++k)
+          {
+            const int i = mColorRows[k];
+            x[i] = projectRow(
+                i, relaxRow(i), isFriction(i) ? x[findex[i]] : 0.0);
+          }
+          barrier.wait();
+        }
+      }
+
+      if ((iter + 1) % checkInterval != 0 && iter + 1 != maxIteration)
+        continue;
+
+      // Projected residual x - proj(x - w / A_ii), in units of x
+      getChunk(n, tid, numThreads, begin, end);
+      s_t residual = 0.0;
+      for (int i = begin; i < end; ++i)
+      {
+        if (mInvDiag[i] == 0.0)
+          continue;
+        const s_t target = projectRow(
+            i, relaxRow(i), isFriction(i) ? x[findex[i]] : 0.0);
+        residual = std::max(residual, static_cast<s_t>(abs(x[i] - target)));
+      }
+      mThreadResidual[tid] = residual;
+      barrier.wait();
+
+      residual = 0.0;
+      for (int t = 0; t < numThreads; ++t)
+        residual = std::max(residual, mThreadResidual[t]);
+      if (residual <= tolerance)
+      {
+        if (tid == 0)
+        {
+          converged = true;
+          mNumIterations = iter + 1;
+        }
+        return;
+      }
+    }
+    if (tid == 0)
+      mNumIterations = maxIteration;
+  };
+
+  SpinBarrier barrier(numThreads);
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (int t = 1; t < numThreads; ++t)
+    threads.emplace_back(worker, t, std::ref(barrier));
+  worker(0, barrier);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return converged;
+}
+
+#ifndef NDEBUG
+//==============================================================================
+bool ParallelPgsBoxedLcpSolver::canSolve(int n, const s_t* A)
+{
+  const int nskip = dPAD(n);
+
+  // Return false if A has zero-diagonal or A is nonsymmetric matrix
+  for (auto i = 0; i < n; ++i)
+  {
+    if (A[nskip * i + i] < PARALLEL_PGS_EPSILON)
+      return false;
+
+    for (auto j = 0; j < n; ++j)
+    {
+      if (abs(A[nskip * i + j] - A[nskip * j + i]) > PARALLEL_PGS_EPSILON)
+        return false;
+    }
+  }
+
+  return true;
+}
+#endif
+
+//==============================================================================
+void ParallelPgsBoxedLcpSolver::setOption(
+    const ParallelPgsBoxedLcpSolver::Option& option)
+{
+  mOption = option;
+}
+
+//==============================================================================
+const ParallelPgsBoxedLcpSolver::Option& ParallelPgsBoxedLcpSolver::getOption()
+    const
+{
+  return mOption;
+}
+
+//==============================================================================
+int ParallelPgsBoxedLcpSolver::getNumColors() const
+{
+  return mNumColors;
+}
+
+//==============================================================================
+int ParallelPgsBoxedLcpSolver::getNumIterations() const
+{
+  return mNumIterations;
+}
+
+//==============================================================================
+void ParallelPgsBoxedLcpSolver::buildSparseRows(
+    int n, const s_t* A, const int* /*findex*/)
+{
+  const int nskip = dPAD(n);
+
+  mRowStart.resize(n + 1);
+  mCols.clear();
+  mVals.clear();
+  mInvDiag.resize(n);
+
+  for (int i = 0; i < n; ++i)
+  {
+    mRowStart[i] = static_cast<int>(mCols.size());
+    const s_t* row = A + nskip * i;
+    for (int j = 0; j < n; ++j)
+    {
+      if (j == i)
+        continue;
+      // Symmetrize the pattern, so that rows of the same color never even
+      // read each other's x
+      if (row[j] != 0.0 || A[nskip * j + i] != 0.0)
+      {
+        mCols.push_back(j);
+        mVals.push_back(row[j]);
+      }
+    }
+
+    const s_t diag = row[i];
+    mInvDiag[i] = (diag < mOption.mEpsilonForDivision) ? 0.0 : 1.0 / diag;
+  }
+  mRowStart[n] = static_cast<int>(mCols.size());
+}
+
+//==============================================================================
+void ParallelPgsBoxedLcpSolver::colorRows(int n, const int* findex)
+{
+  // Friction rows hang off their normal row, both ways
+  mFrictionStart.assign(n + 1, 0);
+  if (findex)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      if (findex[i] >= 0 && findex[i] != i)
+        mFrictionStart[findex[i] + 1]++;
+    }
+  }
+  for (int i = 0; i < n; ++i)
+    mFrictionStart[i + 1] += mFrictionStart[i];
+  mFrictionRows.resize(mFrictionStart[n]);
+  if (findex)
+  {
+    std::vector<int>& fill = mColorMark;
+    fill.assign(mFrictionStart.begin(), mFrictionStart.end() - 1);
+    for (int i = 0; i < n; ++i)
+    {
+      if (findex[i] >= 0 && findex[i] != i)
+        mFrictionRows[fill[findex[i]]++] = i;
+    }
+  }
+
+  // Greedy coloring in row order. mColorMark[c] == i means that color c is
+  // already taken by a neighbor of row i.
+  mColor.assign(n, -1);
+  mColorMark.assign(n, -1);
+  mNumColors = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    if (mInvDiag[i] == 0.0)
+      continue;
+
+    for (int k = mRowStart[i]; k < mRowStart[i + 1]; ++k)
+    {
+      const int color = mColor[mCols[k]];
+      if (color >= 0)
+        mColorMark[color] = i;
+    }
+    if (findex && findex[i] >= 0 && findex[i] != i && mColor[findex[i]] >= 0)
+      mColorMark[mColor[findex[i]]] = i;
+    for (int k = mFrictionStart[i]; k < mFrictionStart[i + 1]; ++k)
+    {
+      const int color = mColor[mFrictionRows[k]];
+      if (color >= 0)
+        mColorMark[color] = i;
+    }
+
+    int color = 0;
+    while (color < mNumColors && mColorMark[color] == i)
+      ++color;
+    mColor[i] = color;
+    if (color == mNumColors)
+      ++mNumColors;
+  }
+
+  // Sort the rows by color
+  mColorStart.assign(mNumColors + 1, 0);
+  for (int i = 0; i < n; ++i)
+  {
+    if (mColor[i] >= 0)
+      mColorStart[mColor[i] + 1]++;
+  }
+  for (int c = 0; c < mNumColors; ++c)
+    mColorStart[c + 1] += mColorStart[c];
+  mColorRows.resize(mColorStart[mNumColors]);
+  std::vector<int>& fill = mColorMark;
+  fill.assign(mColorStart.begin(), mColorStart.end() - 1);
+  for (int i = 0; i < n; ++i)
+  {
+    if (mColor[i] >= 0)
+      mColorRows[fill[mColor[i]]++] = i;
+  }
+}
+
+} // namespace constraint
+} // namespace dart
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_CONSTRAINT_PARALLELPGSBOXEDLCPSOLVER_HPP_
+#define DART_CONSTRAINT_PARALLELPGSBOXEDLCPSOLVER_HPP_
+
+#include <vector>
+
+#include "dart/constraint/BoxedLcpSolver.hpp"
+
+namespace dart {
+namespace constraint {
+
+/// Projected Gauss-Seidel (PGS) LCP solver that sweeps large, sparse contact
+/// problems on several threads.
+///
+/// Rows of A are greedily colored so that no two rows of the same color are
+/// coupled through A, or through a friction row and its normal. All rows of
+/// one color are then independent and are relaxed concurrently, and colors
+/// are swept one after another, which gives exactly the same iterates as a
+/// sequential Gauss-Seidel sweep in color order, regardless of the number of
+/// threads. Alternatively, a damped Jacobi sweep updates every row at once
+/// from the previous iterate.
+///
+/// The incoming x is used as the initial guess, so warm starting only
+/// requires passing the previous impulses. The solver stops as soon as the
+/// projected residual of the LCP drops below the tolerance.
+class ParallelPgsBoxedLcpSolver : public BoxedLcpSolver
+{
+public:
+  struct Option
+  {
+    /// Maximum number of sweeps over all the rows.
+    int mMaxIteration;
+
+    /// The solver terminates once max_i |x_i - proj(x_i - w_i / A_ii)| is
+    /// below this value.
+    s_t mResidualTolerance;
+
+    /// The residual costs one extra pass over A, so it is only evaluated
+    /// every this many sweeps.
+    int mResidualCheckInterval;
+
+    /// Rows with a diagonal entry smaller than this are fixed at zero.
+    s_t mEpsilonForDivision;
+
+    /// Number of threads to sweep with. Zero uses the hardware concurrency.
+    int mNumThreads;
+
+    /// No thread is started for less than this many rows of work.
+    int mMinRowsPerThread;
+
+    /// Sweep with damped Jacobi instead of colored Gauss-Seidel.
+    bool mUseJacobi;
+
+    /// Relaxation factor of the Jacobi sweep, in (0, 1].
+    s_t mJacobiRelaxation;
+
+    Option(
+        int maxIteration = 100,
+        s_t residualTolerance = 1e-6,
+        int residualCheckInterval = 4,
+        s_t epsilonForDivision = 1e-9,
+        int numThreads = 0,
+        int minRowsPerThread = 64,
+        bool useJacobi = false,
+        s_t jacobiRelaxation = 0.6);
+  };
+
+  // Documentation inherited.
+  const std::string& getType() const override;
+
+  /// Returns type for this class
+  static const std::string& getStaticType();
+
+  // Documentation inherited.
+  bool solve(
+      int n,
+      s_t* A,
+      s_t* x,
+      s_t* b,
+      int nub,
+      s_t* lo,
+      s_t* hi,
+      int* findex,
+      bool earlyTermination) override;
+
+#ifndef NDEBUG
+  // Documentation inherited.
+  bool canSolve(int n, const s_t* A) override;
+#endif
+
+  /// Sets options
+  void setOption(const Option& option);
+
+  /// Returns options.
+  const Option& getOption() const;
+
+  /// Returns the number of colors the rows were split into by the last
+  /// Gauss-Seidel solve.
+  int getNumColors() const;
+
+  /// Returns the number of sweeps the last solve took.
+  int getNumIterations() const;
+
+protected:
+  /// Builds the compressed sparse rows of A and the inverse diagonal.
+  void buildSparseRows(int n, const s_t* A, const int* findex);
+
+  /// Greedily colors the rows, and sorts them by color into mColorRows.
+  void colorRows(int n, const int* findex);
+
+  Option mOption;
+
+  /// Compressed sparse rows of the off-diagonal part of A. The sparsity
+  /// pattern is symmetrized, so a row also lists j if only A(j, i) != 0.
+  std::vector<int> mRowStart;
+  std::vector<int> mCols;
+  std::vector<s_t> mVals;
+
+  /// 1 / A(i, i), or 0 for rows that are fixed at zero.
+  std::vector<s_t> mInvDiag;
+
+  /// Friction rows of each normal row, in the same compressed layout.
+  std::vector<int> mFrictionStart;
+  std::vector<int> mFrictionRows;
+
+  /// Color of each row, and the rows sorted by color.
+  std::vector<int> mColor;
+  std::vector<int> mColorStart;
+  std::vector<int> mColorRows;
+
+  /// Scratch for the coloring and the Jacobi sweep.
+  std::vector<int> mColorMark;
+  std::vector<s_t> mZ;
+
+  /// Per-thread partial residuals.
+  std::vector<s_t> mThreadResidual;
+
+  int mNumColors = 0;
+  int mNumIterations = 0;
+};
+
+} // namespace constraint
+} // namespace dart
+
+#endif // DART_CONSTRAINT_PARALLELPGSBOXEDLCPSOLVER_HPP_
@@ -496,6 +496,8 @@ void BodyNode::setMass(const s_t mass)
   const SkeletonPtr& skel = getSkeleton();
   if (skel)
     skel->updateTotalMass();
+
+  incrementVersion();
 }
 
 //==============================================================================
@@ -511,6 +513,8 @@ void BodyNode::setMomentOfInertia(
   mAspectProperties.mInertia.setMoment(_Ixx, _Iyy, _Izz, _Ixy, _Ixz, _Iyz);
 
   dirtyArticulatedInertia();
+
+  incrementVersion();
 }
 
 //==============================================================================
@@ -582,6 +586,8 @@ void BodyNode::setLocalCOM(const Eigen::Vector3s& _com)
   mAspectProperties.mInertia.setLocalCOM(_com);
 
   dirtyArticulatedInertia();
+
+  incrementVersion();
 }
 
 //==============================================================================
@@ -0,0 +1,161 @@
+#include "dart/dynamics/DynamicsKernel.hpp"
+
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/Joint.hpp"
+#include "dart/math/Geometry.hpp"
+
+namespace dart {
+namespace dynamics {
+
+//==============================================================================
+void DynamicsKernel::build(const std::vector<BodyNode*>& bodyNodes)
+{
+  const std::size_t numBodies = bodyNodes.size();
+  mParents.resize(numBodies);
+  mDofStarts.resize(numBodies);
+  mNumJointDofs.resize(numBodies);
+  mDofParents.clear();
+  mHasSoftBodies = false;
+
+  // The last DOF on the path from the root to each body, or -1 if there are
+  // none
+  std::vector<int> lastDofs(numBodies);
+
+  int cursor = 0;
+  for (std::size_t i = 0; i < numBodies; ++i)
+  {
+    const BodyNode* bodyNode = bodyNodes[i];
+    assert(bodyNode->getIndexInTree() == i);
+    const BodyNode* parent = bodyNode->getParentBodyNode();
+    const Joint* joint = bodyNode->getParentJoint();
+    const int numDofs = static_cast<int>(joint->getNumDofs());
+
+    mParents[i] = parent == nullptr ? -1 : (int)parent->getIndexInTree();
+    if (bodyNode->asSoftBodyNode() != nullptr)
+      mHasSoftBodies = true;
+    mDofStarts[i] = cursor;
+    mNumJointDofs[i] = numDofs;
+    assert(numDofs == 0 || (int)joint->getIndexInTree(0) == cursor);
+
+    const int parentLastDof = mParents[i] == -1 ? -1 : lastDofs[mParents[i]];
+    for (int k = 0; k < numDofs; ++k)
+    {
+      mDofParents.push_back(k == 0 ? parentLastDof : cursor + k - 1);
+    }
+    cursor += numDofs;
+    lastDofs[i] = numDofs > 0 ? cursor - 1 : parentLastDof;
+  }
+
+  mRelativeTransforms.resize(numBodies);
+  mSpatialInertias.resize(numBodies);
+  mGravityModes.resize(numBodies);
+  mRelativeJacobians.resize(6, cursor);
+  mWorldRotations.resize(numBodies);
+  mJointVelocities.resize(cursor);
+  mRelativeJacobianTimeDerivs.resize(6, cursor);
+  mSpatialVelocities.resize(numBodies);
+  mPartialAccelerations.resize(numBodies);
+  mCompositeInertias.resize(numBodies);
+  mBiasAccelerations.resize(numBodies);
+  mBiasForces.resize(numBodies);
+}
+
+//==============================================================================
+void DynamicsKernel::updateInertias(const std::vector<BodyNode*>& bodyNodes)
+{
+  assert(bodyNodes.size() == getNumBodies());
+  for (std::size_t i = 0; i < bodyNodes.size(); ++i)
+  {
+    const BodyNode* bodyNode = bodyNodes[i];
+    mSpatialInertias[i] = bodyNode->getInertia().getSpatialTensor();
+    mGravityModes[i] = bodyNode->getGravityMode();
+  }
+}
+
+//==============================================================================
+void DynamicsKernel::updatePositions(const std::vector<BodyNode*>& bodyNodes)
+{
+  assert(bodyNodes.size() == getNumBodies());
+  for (std::size_t i = 0; i < bodyNodes.size(); ++i)
+  {
+    const Joint* joint = bodyNodes[i]->getParentJoint();
+    mRelativeTransforms[i] = joint->getRelativeTransform();
+    if (mNumJointDofs[i] > 0)
+    {
+      mRelativeJacobians.middleCols(mDofStarts[i], mNumJointDofs[i])
+          = joint->getRelativeJacobian();
+    }
+
+    // The root of a tree hangs off the World frame
+    const int parent = mParents[i];
+    if (parent == -1)
+    {
+      mWorldRotations[i] = mRelativeTransforms[i].linear();
+    }
+    else
+    {
+      mWorldRotations[i].noalias()
+          = mWorldRotations[parent] * mRelativeTransforms[i].linear();
+    }
+  }
+}
+
+//==============================================================================
+void DynamicsKernel::updateVelocities(const std::vector<BodyNode*>& bodyNodes)
+{
+  assert(bodyNodes.size() == getNumBodies());
+  for (std::size_t i = 0; i < bodyNodes.size(); ++i)
+  {
+    const int numDofs = mNumJointDofs[i];
+    const int dofStart = mDofStarts[i];
+    const int parent = mParents[i];
+
+    // V(i) = Ad(T(i)^{-1}) * V(parent) + S(i) * dq(i)
+    if (parent == -1)
+    {
+      mSpatialVelocities[i].setZero();
+    }
+    else
+    {
+      mSpatialVelocities[i] = math::AdInvT(
+          mRelativeTransforms[i], mSpatialVelocities[parent]);
+    }
+
+    if (numDofs == 0)
+    {
+      mPartialAccelerations[i].setZero();
+      continue;
+    }
+
+    const Joint* joint = bodyNodes[i]->getParentJoint();
+    for (int k = 0; k < numDofs; ++k)
+      mJointVelocities[dofStart + k] = joint->getVelocity(k);
+    mRelativeJacobianTimeDerivs.middleCols(dofStart, numDofs)
+        = joint->getRelativeJacobianTimeDeriv();
+
+    const auto dq = mJointVelocities.segment(dofStart, numDofs);
+    const Eigen::Vector6s jointVelocity
+        = mRelativeJacobians.middleCols(dofStart, numDofs) * dq;
+    mSpatialVelocities[i] += jointVelocity;
+
+    // ad(V(i), S(i) * dq(i)) + dS(i) * dq(i)
+    mPartialAccelerations[i]
+        = math::ad(mSpatialVelocities[i], jointVelocity)
+          + mRelativeJacobianTimeDerivs.middleCols(dofStart, numDofs) * dq;
+  }
+}
+
+//==============================================================================
+std::size_t DynamicsKernel::getNumBodies() const
+{
+  return mParents.size();
+}
+
+//==============================================================================
+std::size_t DynamicsKernel::getNumDofs() const
+{
+  return mDofParents.size();
+}
+
+} // namespace dynamics
+} // namespace dart
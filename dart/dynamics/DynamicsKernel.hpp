@@ -0,0 +1,142 @@
+#ifndef DART_DYNAMICS_DYNAMICS_KERNEL_HPP_
+#define DART_DYNAMICS_DYNAMICS_KERNEL_HPP_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/common/Memory.hpp"
+#include "dart/math/MathTypes.hpp"
+
+namespace dart {
+namespace dynamics {
+
+class BodyNode;
+
+/// This is a structure-of-arrays copy of the state of one tree of a Skeleton,
+/// which the Composite Rigid Body mass matrix, its LTDL factorization and the
+/// Coriolis and gravity force recursions sweep over. Bodies are stored in tree
+/// order, so parents always come before their children, and a recursion from
+/// the leaves to the root (or back) is a linear walk over contiguous arrays
+/// rather than a chase through BodyNode pointers.
+///
+/// The topology is built once from the BodyNodes, with build(). After that,
+/// the state is refreshed in three tiers, which the Skeleton owning the kernel
+/// calls only when they're stale:
+/// - updateInertias(), when the Skeleton's version changes;
+/// - updatePositions(), when the positions change;
+/// - updateVelocities(), when the velocities or positions change.
+/// Only the joint-type-specific pieces (relative transforms, Jacobians and
+/// their time derivatives) are read back out of the Joints. The world
+/// rotations, spatial velocities and partial accelerations are computed here.
+///
+/// The articulated-body forward dynamics and getJacobianOfC() still walk the
+/// BodyNodes, because each step of them dispatches to Joint virtuals for the
+/// actuator types, implicit springs and dampers, and the derivatives of the
+/// relative Jacobians.
+struct DynamicsKernel
+{
+  /// This rebuilds the topology from the BodyNodes of a tree, which must be
+  /// in tree order
+  void build(const std::vector<BodyNode*>& bodyNodes);
+
+  /// This copies the spatial inertias and gravity modes out of the BodyNodes
+  /// that build() was called with
+  void updateInertias(const std::vector<BodyNode*>& bodyNodes);
+
+  /// This copies the relative transforms and Jacobians out of the joints, and
+  /// composes the world rotation of every body
+  void updatePositions(const std::vector<BodyNode*>& bodyNodes);
+
+  /// This copies the joint velocities and the time derivatives of the relative
+  /// Jacobians out of the joints, and then computes the spatial velocity and
+  /// partial acceleration of every body. The positions must be up to date.
+  void updateVelocities(const std::vector<BodyNode*>& bodyNodes);
+
+  /// Returns the number of bodies in the tree
+  std::size_t getNumBodies() const;
+
+  /// Returns the number of DOFs in the tree
+  std::size_t getNumDofs() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Topology
+  //////////////////////////////////////////////////////////////////////////////
+
+  /// The index of each body's parent, or -1 for the root of the tree
+  std::vector<int> mParents;
+
+  /// The index in the tree of the first DOF of each body's parent joint
+  std::vector<int> mDofStarts;
+
+  /// The number of DOFs of each body's parent joint
+  std::vector<int> mNumJointDofs;
+
+  /// The parent of each DOF, which is the DOF before it in the same joint, or
+  /// else the last DOF of the nearest ancestor joint with any DOFs. It's -1
+  /// for DOFs at the root.
+  std::vector<int> mDofParents;
+
+  /// True if any body is a SoftBodyNode, whose point masses carry DOFs that
+  /// none of the recursions over this kernel account for
+  bool mHasSoftBodies;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // State
+  //////////////////////////////////////////////////////////////////////////////
+
+  /// The transform of each body from its parent body
+  common::aligned_vector<Eigen::Isometry3s> mRelativeTransforms;
+
+  /// The spatial inertia of each body, in its own frame
+  common::aligned_vector<Eigen::Matrix6s> mSpatialInertias;
+
+  /// Whether gravity acts on each body
+  std::vector<bool> mGravityModes;
+
+  /// The relative Jacobians of every joint, packed side by side, so the
+  /// columns for a body's joint are mDofStarts[i] to
+  /// mDofStarts[i] + mNumJointDofs[i]
+  Eigen::Matrix<s_t, 6, Eigen::Dynamic> mRelativeJacobians;
+
+  /// The rotation of each body from the world frame
+  std::vector<Eigen::Matrix3s> mWorldRotations;
+
+  /// The velocities of every DOF in the tree
+  Eigen::VectorXs mJointVelocities;
+
+  /// The time derivatives of the relative Jacobians, packed the same way as
+  /// mRelativeJacobians
+  Eigen::Matrix<s_t, 6, Eigen::Dynamic> mRelativeJacobianTimeDerivs;
+
+  /// The spatial velocity of each body, in its own frame
+  common::aligned_vector<Eigen::Vector6s> mSpatialVelocities;
+
+  /// The part of each body's spatial acceleration that doesn't depend on the
+  /// joint accelerations
+  common::aligned_vector<Eigen::Vector6s> mPartialAccelerations;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Scratch space
+  //////////////////////////////////////////////////////////////////////////////
+
+  /// The spatial inertia of the subtree rooted at each body, in that body's
+  /// frame
+  common::aligned_vector<Eigen::Matrix6s> mCompositeInertias;
+
+  /// The spatial acceleration of each body when every joint acceleration is
+  /// zero
+  common::aligned_vector<Eigen::Vector6s> mBiasAccelerations;
+
+  /// The force each body's joint has to transmit to the subtree below it, for
+  /// that subtree to have mBiasAccelerations
+  common::aligned_vector<Eigen::Vector6s> mBiasForces;
+
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace dynamics
+} // namespace dart
+
+#endif
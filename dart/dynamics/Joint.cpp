@@ -807,6 +807,13 @@ void Joint::notifyVelocityUpdated()
   {
     mChildBodyNode->dirtyVelocity();
     mChildBodyNode->dirtyJacobianDeriv();
+
+    // The dynamics kernel computes body velocities on its own, so the
+    // BodyNodes' velocity flags can stay dirty, and dirtyVelocity() won't
+    // reach the Skeleton again
+    SkeletonPtr skel = getSkeleton();
+    if (skel)
+      skel->dirtyVelocities(mChildBodyNode->mTreeIndex);
   }
 
   mIsRelativeJacobianTimeDerivDirty = true;
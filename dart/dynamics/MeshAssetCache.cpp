@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/dynamics/MeshAssetCache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <assimp/cimport.h>
+
+#include "dart/common/Console.hpp"
+#include "dart/dynamics/MeshShape.hpp"
+
+namespace dart {
+namespace dynamics {
+
+//==============================================================================
+MeshAssetCache& MeshAssetCache::getInstance()
+{
+  static MeshAssetCache instance;
+  return instance;
+}
+
+//==============================================================================
+MeshAssetCache::MeshAssetCache()
+  : mEnabled(true), mContentHashing(false), mNumImports(0)
+{
+}
+
+//==============================================================================
+const aiScene* MeshAssetCache::acquire(
+    const std::string& uri, const common::ResourceRetrieverPtr& retriever)
+{
+  bool contentHashing;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mEnabled)
+    {
+      mNumImports++;
+      return MeshShape::importMesh(uri, retriever);
+    }
+    contentHashing = mContentHashing;
+  }
+
+  // Prefer the resolved file path as the key, so different URIs that point at
+  // the same file on disk share a scene.
+  std::string key = retriever ? retriever->getFilePath(uri) : "";
+  if (key == "")
+    key = uri;
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mByUri.find(key);
+    if (it != mByUri.end())
+    {
+      findEntry(it->second)->refCount++;
+      return it->second;
+    }
+  }
+
+  std::size_t contentKey = 0;
+  bool hasContentKey = false;
+  if (contentHashing)
+  {
+    hasContentKey = hashContents(uri, retriever, contentKey);
+    if (hasContentKey)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto it = mByContent.find(contentKey);
+      if (it != mByContent.end())
+      {
+        findEntry(it->second)->refCount++;
+        mByUri[key] = it->second;
+        return it->second;
+      }
+    }
+  }
+
+  // We do the expensive import without holding the lock, so unrelated meshes
+  // can load in parallel
+  const aiScene* scene = MeshShape::importMesh(uri, retriever);
+  if (!scene)
+    return nullptr;
+
+  Entry entry;
+  entry.scene = scene;
+  entry.refCount = 1;
+  entry.uri = key;
+  entry.contentKey = contentKey;
+  entry.hasContentKey = hasContentKey;
+  entry.localMin = Eigen::Vector3s::Constant(
+      std::numeric_limits<s_t>::infinity());
+  entry.localMax = Eigen::Vector3s::Constant(
+      -std::numeric_limits<s_t>::infinity());
+  for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+  {
+    const aiMesh* mesh = scene->mMeshes[i];
+    for (unsigned int j = 0; j < mesh->mNumVertices; j++)
+    {
+      const Eigen::Vector3s v(
+          mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+      entry.localMin = entry.localMin.cwiseMin(v);
+      entry.localMax = entry.localMax.cwiseMax(v);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  mNumImports++;
+
+  // Another thread may have imported the same mesh while we weren't holding
+  // the lock. If so, we throw ours away and share theirs.
+  auto it = mByUri.find(key);
+  if (it != mByUri.end())
+  {
+    aiReleaseImport(scene);
+    findEntry(it->second)->refCount++;
+    return it->second;
+  }
+
+  mEntries[scene] = entry;
+  mByUri[key] = scene;
+  if (hasContentKey)
+    mByContent[contentKey] = scene;
+  return scene;
+}
+
+//==============================================================================
+bool MeshAssetCache::release(const aiScene* scene)
+{
+  if (scene == nullptr)
+    return false;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  Entry* entry = findEntry(scene);
+  if (entry == nullptr)
+    return false;
+
+  entry->refCount--;
+  if (entry->refCount > 0)
+    return true;
+
+  // Drop every key that points at this scene, then free it
+  for (auto it = mByUri.begin(); it != mByUri.end();)
+  {
+    if (it->second == scene)
+      it = mByUri.erase(it);
+    else
+      ++it;
+  }
+  if (entry->hasContentKey)
+    mByContent.erase(entry->contentKey);
+  mEntries.erase(scene);
+  aiReleaseImport(scene);
+  return true;
+}
+
+//==============================================================================
+bool MeshAssetCache::contains(const aiScene* scene) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return findEntry(scene) != nullptr;
+}
+
+//==============================================================================
+int MeshAssetCache::getRefCount(const aiScene* scene) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  const Entry* entry = findEntry(scene);
+  return entry == nullptr ? 0 : entry->refCount;
+}
+
+//==============================================================================
+bool MeshAssetCache::getLocalBounds(
+    const aiScene* scene, Eigen::Vector3s& min, Eigen::Vector3s& max) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  const Entry* entry = findEntry(scene);
+  if (entry == nullptr)
+    return false;
+  min = entry->localMin;
+  max = entry->localMax;
+  return true;
+}
+
+//==============================================================================
+void MeshAssetCache::setEnabled(bool enabled)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEnabled = enabled;
+}
+
+//==============================================================================
+bool MeshAssetCache::isEnabled() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mEnabled;
+}
+
+//==============================================================================
+void MeshAssetCache::setContentHashing(bool contentHashing)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mContentHashing = contentHashing;
+}
+
+//==============================================================================
+std::size_t MeshAssetCache::getNumCachedScenes() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mEntries.size();
+}
+
+//==============================================================================
+std::size_t MeshAssetCache::getNumImports() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mNumImports;
+}
+
+//==============================================================================
+bool MeshAssetCache::hashContents(
+    const std::string& uri,
+    const common::ResourceRetrieverPtr& retriever,
+    std::size_t& key)
+{
+  if (!retriever)
+    return false;
+
+  std::string contents;
+  try
+  {
+    contents = retriever->readAll(uri);
+  }
+  catch (const std::exception&)
+  {
+    return false;
+  }
+
+  std::string extension;
+  const std::size_t extensionIndex = uri.find_last_of('.');
+  if (extensionIndex != std::string::npos)
+    extension = uri.substr(extensionIndex);
+  std::transform(
+      std::begin(extension),
+      std::end(extension),
+      std::begin(extension),
+      ::tolower);
+
+  key = std::hash<std::string>()(contents);
+  key ^= std::hash<std::string>()(extension) + 0x9e3779b9 + (key << 6)
+         + (key >> 2);
+  key ^= contents.size() + 0x9e3779b9 + (key << 6) + (key >> 2);
+  return true;
+}
+
+//==============================================================================
+MeshAssetCache::Entry* MeshAssetCache::findEntry(const aiScene* scene)
+{
+  auto it = mEntries.find(scene);
+  return it == mEntries.end() ? nullptr : &it->second;
+}
+
+//==============================================================================
+const MeshAssetCache::Entry* MeshAssetCache::findEntry(
+    const aiScene* scene) const
+{
+  auto it = mEntries.find(scene);
+  return it == mEntries.end() ? nullptr : &it->second;
+}
+
+} // namespace dynamics
+} // namespace dart
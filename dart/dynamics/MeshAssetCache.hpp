@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_DYNAMICS_MESHASSETCACHE_HPP_
+#define DART_DYNAMICS_MESHASSETCACHE_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <Eigen/Dense>
+#include <assimp/scene.h>
+
+#include "dart/common/ResourceRetriever.hpp"
+#include "dart/math/MathTypes.hpp"
+
+namespace dart {
+namespace dynamics {
+
+/// MeshAssetCache is a process-wide, reference-counted cache of imported
+/// aiScenes. MeshShape::loadMesh() goes through it, so loading many copies of
+/// the same model (or many models that share meshes) only runs the assimp
+/// import once per distinct mesh. Scenes are keyed by resolved file path (or
+/// URI, if the retriever can't resolve one), and optionally also by a hash of
+/// the file contents, so identical meshes at different paths are shared too.
+///
+/// Every successful acquire() hands out one reference, which must be returned
+/// with release(). MeshShape does this automatically in its destructor.
+/// Cached scenes are treated as immutable, since they may be shared by any
+/// number of MeshShapes.
+class MeshAssetCache
+{
+public:
+  /// Returns the process-wide cache. This is safe to call from any thread.
+  static MeshAssetCache& getInstance();
+
+  /// Returns a reference to the scene at `uri`, importing it with
+  /// MeshShape::importMesh() if we don't already have it. Returns nullptr if
+  /// the import fails.
+  const aiScene* acquire(
+      const std::string& uri, const common::ResourceRetrieverPtr& retriever);
+
+  /// Returns a reference obtained from acquire(). Once the last reference to a
+  /// scene is returned, the scene is freed. Returns false (and does nothing)
+  /// if `scene` isn't managed by this cache.
+  bool release(const aiScene* scene);
+
+  /// Returns true if `scene` is managed by this cache
+  bool contains(const aiScene* scene) const;
+
+  /// Returns the number of outstanding references to `scene`, or 0 if it isn't
+  /// managed by this cache
+  int getRefCount(const aiScene* scene) const;
+
+  /// This retrieves the unscaled axis-aligned bounds of all the vertices in
+  /// `scene`, which we compute once at import time. Returns false if `scene`
+  /// isn't managed by this cache.
+  bool getLocalBounds(
+      const aiScene* scene, Eigen::Vector3s& min, Eigen::Vector3s& max) const;
+
+  /// If this is false, acquire() always runs a fresh import, and the result is
+  /// not shared. This defaults to true.
+  void setEnabled(bool enabled);
+
+  /// Returns true if the cache is enabled
+  bool isEnabled() const;
+
+  /// If this is true, a URI miss reads the raw file and checks whether we've
+  /// already imported identical contents under a different URI. This defaults
+  /// to false, because formats like OBJ can pull in side files (materials)
+  /// relative to their own path, which the hash doesn't see.
+  void setContentHashing(bool contentHashing);
+
+  /// Returns the number of distinct scenes currently alive in the cache
+  std::size_t getNumCachedScenes() const;
+
+  /// Returns the number of times acquire() has had to run a real import. This
+  /// is mostly useful for tests and profiling.
+  std::size_t getNumImports() const;
+
+protected:
+  MeshAssetCache();
+
+  struct Entry
+  {
+    const aiScene* scene;
+    int refCount;
+    std::string uri;
+    std::size_t contentKey;
+    bool hasContentKey;
+    Eigen::Vector3s localMin;
+    Eigen::Vector3s localMax;
+  };
+
+  /// This hashes the raw bytes at `uri`, along with its extension (since the
+  /// importer treats some extensions specially). Returns false if we couldn't
+  /// read the resource.
+  static bool hashContents(
+      const std::string& uri,
+      const common::ResourceRetrieverPtr& retriever,
+      std::size_t& key);
+
+  /// This finds the entry for a scene, or nullptr if there isn't one. The
+  /// caller must hold mMutex.
+  Entry* findEntry(const aiScene* scene);
+  const Entry* findEntry(const aiScene* scene) const;
+
+  mutable std::mutex mMutex;
+  bool mEnabled;
+  bool mContentHashing;
+  std::size_t mNumImports;
+  std::unordered_map<const aiScene*, Entry> mEntries;
+  std::unordered_map<std::string, const aiScene*> mByUri;
+  std::unordered_map<std::size_t, const aiScene*> mByContent;
+};
+
+} // namespace dynamics
+} // namespace dart
+
+#endif // DART_DYNAMICS_MESHASSETCACHE_HPP_
@@ -48,6 +48,7 @@
 #include "dart/config.hpp"
 #include "dart/dynamics/AssimpInputResourceAdaptor.hpp"
 #include "dart/dynamics/BoxShape.hpp"
+#include "dart/dynamics/MeshAssetCache.hpp"
 
 #if !(ASSIMP_AISCENE_CTOR_DTOR_DEFINED)
 // We define our own constructor and destructor for aiScene, because it seems to
@@ -191,7 +192,7 @@ MeshShape::~MeshShape()
 {
   if (mDontFreeMesh)
     return;
-  aiReleaseImport(mMesh);
+  releaseMesh(mMesh);
 }
 
 //==============================================================================
@@ -364,6 +365,17 @@ void MeshShape::updateBoundingBox() const
     return;
   }
 
+  // Meshes that came through the cache have their bounds precomputed
+  Eigen::Vector3s localMin;
+  Eigen::Vector3s localMax;
+  if (MeshAssetCache::getInstance().getLocalBounds(mMesh, localMin, localMax))
+  {
+    mBoundingBox.setMin(localMin.cwiseProduct(mScale));
+    mBoundingBox.setMax(localMax.cwiseProduct(mScale));
+    mIsBoundingBoxDirty = false;
+    return;
+  }
+
   s_t max_X = -std::numeric_limits<s_t>::infinity();
   s_t max_Y = -std::numeric_limits<s_t>::infinity();
   s_t max_Z = -std::numeric_limits<s_t>::infinity();
@@ -408,6 +420,20 @@ void MeshShape::updateVolume() const
 //==============================================================================
 const aiScene* MeshShape::loadMesh(
     const std::string& _uri, const common::ResourceRetrieverPtr& retriever)
+{
+  return MeshAssetCache::getInstance().acquire(_uri, retriever);
+}
+
+//==============================================================================
+void MeshShape::releaseMesh(const aiScene* mesh)
+{
+  if (!MeshAssetCache::getInstance().release(mesh))
+    aiReleaseImport(mesh);
+}
+
+//==============================================================================
+const aiScene* MeshShape::importMesh(
+    const std::string& _uri, const common::ResourceRetrieverPtr& retriever)
 {
   // Remove points and lines from the import.
   aiPropertyStore* propertyStore = aiCreatePropertyStore();
@@ -452,7 +478,7 @@ const aiScene* MeshShape::loadMesh(
   // necessary because the importer owns the memory that it allocates.
   if (!scene)
   {
-    dtwarn << "[MeshShape::loadMesh] Failed loading mesh '" << _uri
+    dtwarn << "[MeshShape::importMesh] Failed loading mesh '" << _uri
            << "' with ASSIMP error '" << std::string(aiGetErrorString())
            << "'.\n";
 
@@ -483,7 +509,7 @@ const aiScene* MeshShape::loadMesh(
   // import process, because we may have changed mTransformation above.
   scene = aiApplyPostProcessing(scene, aiProcess_PreTransformVertices);
   if (!scene)
-    dtwarn << "[MeshShape::loadMesh] Failed pre-transforming vertices.\n";
+    dtwarn << "[MeshShape::importMesh] Failed pre-transforming vertices.\n";
 
   aiReleasePropertyStore(propertyStore);
 
@@ -159,6 +159,11 @@ public:
 
   void setDisplayList(int index);
 
+  /// Loads a mesh through the process-wide MeshAssetCache, so repeated loads
+  /// of the same mesh share a single imported aiScene. The returned scene must
+  /// be treated as read-only. Ownership of one reference passes to the caller,
+  /// which is normally handed straight to a MeshShape; if not, return it with
+  /// releaseMesh().
   static const aiScene* loadMesh(const std::string& filePath);
 
   static const aiScene* loadMesh(
@@ -167,6 +172,15 @@ public:
   static const aiScene* loadMesh(
       const common::Uri& uri, const common::ResourceRetrieverPtr& retriever);
 
+  /// Runs a fresh assimp import of the mesh, bypassing the MeshAssetCache. The
+  /// caller owns the result exclusively.
+  static const aiScene* importMesh(
+      const std::string& _uri, const common::ResourceRetrieverPtr& retriever);
+
+  /// Frees a scene returned by loadMesh() or importMesh(). Cached scenes are
+  /// only freed once their last reference is released.
+  static void releaseMesh(const aiScene* mesh);
+
   // Documentation inherited.
   Eigen::Matrix3s computeInertia(s_t mass) const override;
 
@@ -1,20 +1,162 @@
 #include "dart/dynamics/SimpleFeatherstone.hpp"
 
+#include "dart/dynamics/BallJoint.hpp"
 #include "dart/dynamics/BodyNode.hpp"
 #include "dart/dynamics/DegreeOfFreedom.hpp"
+#include "dart/dynamics/EulerJoint.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
 #include "dart/dynamics/Joint.hpp"
+#include "dart/dynamics/PlanarJoint.hpp"
+#include "dart/dynamics/PrismaticJoint.hpp"
+#include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/ScrewJoint.hpp"
 #include "dart/dynamics/Skeleton.hpp"
+#include "dart/dynamics/TranslationalJoint.hpp"
+#include "dart/dynamics/UniversalJoint.hpp"
+#include "dart/dynamics/WeldJoint.hpp"
 
 namespace dart {
 namespace dynamics {
 
+namespace {
+
+// Most joints have 1, 2, 3 or 6 DOFs, so we dispatch on the DOF count to run
+// the per-joint steps of the articulated body algorithm on fixed size matrices,
+// which Eigen can unroll and invert in closed form
+template <int N>
+using JointMatrix = Eigen::Matrix<
+    s_t,
+    N,
+    N,
+    0,
+    N == Eigen::Dynamic ? 6 : N,
+    N == Eigen::Dynamic ? 6 : N>;
+template <int N>
+using JointVector
+    = Eigen::Matrix<s_t, N, 1, 0, N == Eigen::Dynamic ? 6 : N, 1>;
+template <int N>
+using JointJacobian
+    = Eigen::Matrix<s_t, 6, N, 0, 6, N == Eigen::Dynamic ? 6 : N>;
+
+// This is the backward pass of the articulated body algorithm for a single
+// joint. It fills in `scratch.psi`, `scratch.totalForce` and
+// `scratch.articulatedInertiaTimesJacobian`, and removes the joint's DOFs from
+// the articulated inertia `PI` and bias force `beta` passed to its parent.
+template <int N>
+void articulatedJointBackward(
+    const JointAndBody& jointAndBody,
+    FeatherstoneScratchSpace& scratch,
+    const s_t* pos,
+    const s_t* vel,
+    const s_t* force,
+    s_t timeStep,
+    bool withBiasForces,
+    Eigen::Matrix6s& PI,
+    Eigen::Vector6s& beta)
+{
+  const int numDofs = jointAndBody.numDofs;
+  Eigen::Map<const JointJacobian<N>> S(scratch.jacobian.data(), 6, numDofs);
+
+  // AIS = Articulated_Inertia_times_axiS
+  const JointJacobian<N> AIS = scratch.articulatedInertia * S;
+
+  // See GenericJoint::updateInvProjArtInertiaImplicitDynamic() for DART
+  // equivalent
+  JointMatrix<N> projectedInertia = S.transpose() * AIS;
+  Eigen::Map<const JointVector<N>> jointForce(
+      force + jointAndBody.dofIndex, numDofs);
+  JointVector<N> totalForce
+      = jointForce
+        - S.transpose()
+              * (scratch.articulatedInertia * scratch.partialAcceleration
+                 + scratch.articulatedBiasForce);
+  if (withBiasForces)
+  {
+    Eigen::Map<const JointVector<N>> stiffness(
+        jointAndBody.springStiffnesses.data(), numDofs);
+    Eigen::Map<const JointVector<N>> rest(
+        jointAndBody.restPositions.data(), numDofs);
+    Eigen::Map<const JointVector<N>> damping(
+        jointAndBody.dampingCoefficients.data(), numDofs);
+    Eigen::Map<const JointVector<N>> q(pos + jointAndBody.dofIndex, numDofs);
+    Eigen::Map<const JointVector<N>> dq(vel + jointAndBody.dofIndex, numDofs);
+
+    projectedInertia.diagonal()
+        += timeStep * damping + timeStep * timeStep * stiffness;
+    // Total force on the joint, see GenericJoint::updateTotalForceDynamic()
+    // for DART equivalent
+    totalForce -= stiffness.cwiseProduct(q - rest + dq * timeStep)
+                  + damping.cwiseProduct(dq);
+  }
+  const JointMatrix<N> psi = projectedInertia.inverse();
+
+  // See GenericJoint::addChildArtInertiaImplicitToDynamic() and
+  // GenericJoint::addChildBiasForceToDynamic() for DART equivalents
+  PI.noalias() -= AIS * psi * AIS.transpose();
+  beta.noalias() += AIS * (psi * totalForce);
+
+  scratch.articulatedInertiaTimesJacobian = AIS;
+  scratch.psi = psi;
+  scratch.totalForce = totalForce;
+}
+
+// This is the forward pass of the articulated body algorithm for a single
+// joint, which writes its accelerations and adds them to
+// `scratch.spatialAcceleration`
+template <int N>
+void articulatedJointForward(
+    const JointAndBody& jointAndBody,
+    FeatherstoneScratchSpace& scratch,
+    const Eigen::Vector6s& parentAcceleration,
+    /* OUT */ s_t* accelerations)
+{
+  const int numDofs = jointAndBody.numDofs;
+  Eigen::Map<const JointJacobian<N>> S(scratch.jacobian.data(), 6, numDofs);
+  Eigen::Map<const JointJacobian<N>> AIS(
+      scratch.articulatedInertiaTimesJacobian.data(), 6, numDofs);
+  Eigen::Map<const JointMatrix<N>> psi(scratch.psi.data(), numDofs, numDofs);
+  Eigen::Map<const JointVector<N>> totalForce(
+      scratch.totalForce.data(), numDofs);
+  Eigen::Map<JointVector<N>> acc(
+      accelerations + jointAndBody.dofIndex, numDofs);
+
+  // See GenericJoint::updateAccelerationDynamic() for DART equivalent
+  acc = psi * (totalForce - AIS.transpose() * parentAcceleration);
+  scratch.spatialAcceleration.noalias() += S * acc;
+}
+
+} // namespace
+
+SimpleFeatherstone::SimpleFeatherstone()
+  : mGravity(Eigen::Vector3s::Zero()),
+    mTimeStep(0.001),
+    mSyncedSkeleton(nullptr),
+    mSyncedVersion(0),
+    mSyncedCanRepresent(false)
+{
+}
+
 // This creates a new JointAndBody object in our vector, and returns it by
 // reference
 JointAndBody& SimpleFeatherstone::emplaceBack()
 {
+  const int dofIndex = getNumDofs();
   mJointsAndBodies.emplace_back();
   mScratchSpace.emplace_back();
-  return mJointsAndBodies.at(mJointsAndBodies.size() - 1);
+
+  JointAndBody& jointAndBody = mJointsAndBodies.back();
+  jointAndBody.type = SCREW_CHAIN;
+  jointAndBody.numDofs = 0;
+  jointAndBody.dofIndex = dofIndex;
+  jointAndBody.transformFromParent = Eigen::Isometry3s::Identity();
+  jointAndBody.transformFromChildren = Eigen::Isometry3s::Identity();
+  jointAndBody.transformToChildren = Eigen::Isometry3s::Identity();
+  jointAndBody.hasConstantJacobian = false;
+  jointAndBody.inertia.setZero();
+  jointAndBody.gravityMode = true;
+  jointAndBody.externalForce.setZero();
+  jointAndBody.parentIndex = -1;
+  return jointAndBody;
 }
 
 int SimpleFeatherstone::len()
@@ -22,119 +164,205 @@ int SimpleFeatherstone::len()
   return mJointsAndBodies.size();
 }
 
+int SimpleFeatherstone::getNumDofs()
+{
+  if (mJointsAndBodies.empty())
+    return 0;
+  return mJointsAndBodies.back().dofIndex + mJointsAndBodies.back().numDofs;
+}
+
 // This computes accelerations
 void SimpleFeatherstone::forwardDynamics(
-    s_t* pos,
-    s_t* vel,
-    s_t* force,
+    const s_t* pos,
+    const s_t* vel,
+    const s_t* force,
     /* OUT */ s_t* accelerations)
 {
+  updateKinematics(pos, vel);
+  articulatedBodyPasses(pos, vel, force, accelerations, true);
+}
+
+// This computes the joint forces needed to get `accelerations`, with the
+// recursive Newton-Euler algorithm
+void SimpleFeatherstone::inverseDynamics(
+    const s_t* pos,
+    const s_t* vel,
+    const s_t* accelerations,
+    /* OUT */ s_t* forces)
+{
+  updateKinematics(pos, vel);
+
   // Forward pass
   for (int i = 0; i < len(); i++)
   {
-    mScratchSpace[i].transformFromParent
-        = mJointsAndBodies[i].transformFromParent
-          * math::expMap(mJointsAndBodies[i].axis * pos[i])
-          * mJointsAndBodies[i].transformFromChildren;
-    if (mJointsAndBodies[i].parentIndex != -1)
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    FeatherstoneScratchSpace& scratch = mScratchSpace[i];
+
+    scratch.spatialAcceleration = scratch.partialAcceleration;
+    if (jointAndBody.parentIndex != -1)
     {
-      mScratchSpace[i].spatialVelocity
-          = math::AdInvT(
-                mScratchSpace[i].transformFromParent,
-                mScratchSpace[mJointsAndBodies[i].parentIndex].spatialVelocity)
-            + mJointsAndBodies[i].axis * vel[i];
+      scratch.spatialAcceleration += math::AdInvT(
+          scratch.transformFromParent,
+          mScratchSpace[jointAndBody.parentIndex].spatialAcceleration);
     }
-    else
+    if (jointAndBody.numDofs > 0)
     {
-      mScratchSpace[i].spatialVelocity = mJointsAndBodies[i].axis * vel[i];
+      scratch.spatialAcceleration
+          += scratch.jacobian
+             * Eigen::Map<const Eigen::VectorXs>(
+                 accelerations + jointAndBody.dofIndex, jointAndBody.numDofs);
+    }
+
+    // See BodyNode::updateTransmittedForceID() for DART equivalent
+    const Eigen::Matrix6s& I = jointAndBody.inertia;
+    scratch.spatialForce = I * scratch.spatialAcceleration
+                           - math::dad(
+                               scratch.spatialVelocity,
+                               I * scratch.spatialVelocity);
+    if (jointAndBody.gravityMode)
+    {
+      scratch.spatialForce.noalias()
+          -= I.rightCols<3>()
+             * (scratch.worldRotation.transpose() * mGravity);
     }
-    mScratchSpace[i].partialAcceleration = math::ad(
-        mScratchSpace[i].spatialVelocity, mJointsAndBodies[i].axis * vel[i]);
-    // Zero out scratch space to prepare for sums in backwards pass
-    mScratchSpace[i].articulatedInertia.setZero();
-    mScratchSpace[i].articulatedBiasForce.setZero();
   }
   // Backward pass
   for (int i = len() - 1; i >= 0; i--)
   {
-    mScratchSpace[i].articulatedInertia += mJointsAndBodies[i].inertia;
-    mScratchSpace[i].articulatedBiasForce -= math::dad(
-        mScratchSpace[i].spatialVelocity,
-        mJointsAndBodies[i].inertia * mScratchSpace[i].spatialVelocity);
-
-    mScratchSpace[i].psi
-        = 1.0
-          / (mJointsAndBodies[i].axis.transpose()
-             * mScratchSpace[i].articulatedInertia * mJointsAndBodies[i].axis)
-                .value();
-
-    mScratchSpace[i].phi
-        = mScratchSpace[i].psi * mScratchSpace[i].articulatedInertia
-          * mJointsAndBodies[i].axis * mJointsAndBodies[i].axis.transpose()
-          * mScratchSpace[i].articulatedInertia;
-
-    // Total force on the joint, see GenericJoint.hpp:2028 for DART equivalent
-    // Inside GenericJoint::addChildBiasForceToDynamic()
-    mScratchSpace[i].totalForce
-        = (force[i]
-           - (mJointsAndBodies[i].axis.transpose()
-              * (mScratchSpace[i].articulatedInertia
-                     * mScratchSpace[i].partialAcceleration
-                 + mScratchSpace[i].articulatedBiasForce))
-                 .value());
-
-    if (mJointsAndBodies[i].parentIndex == -1)
-      continue;
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    const FeatherstoneScratchSpace& scratch = mScratchSpace[i];
 
-    // Sum into our parents
-    // See GenericJoint.hpp:1801 for DART equivalent,
-    // GenericJoint::addChildArtInertiaToDynamic()
-    // AIS = Articulated_Inertia_times_axiS
-    Eigen::Vector6s AIS
-        = mScratchSpace[i].articulatedInertia * mJointsAndBodies[i].axis;
-    Eigen::MatrixXs PI = mScratchSpace[i].articulatedInertia;
-    PI.noalias() -= AIS * mScratchSpace[i].psi * AIS.transpose();
-    mScratchSpace[mJointsAndBodies[i].parentIndex].articulatedInertia
-        += math::transformInertia(
-            mScratchSpace[i].transformFromParent.inverse(), PI);
+    if (jointAndBody.numDofs > 0)
+    {
+      Eigen::Map<Eigen::VectorXs>(
+          forces + jointAndBody.dofIndex, jointAndBody.numDofs)
+          = scratch.jacobian.transpose() * scratch.spatialForce;
+    }
+    if (jointAndBody.parentIndex != -1)
+    {
+      mScratchSpace[jointAndBody.parentIndex].spatialForce += math::dAdInvT(
+          scratch.transformFromParent, scratch.spatialForce);
+    }
+  }
+}
 
-    Eigen::Vector6s beta
-        = mScratchSpace[i].articulatedBiasForce
-          + mScratchSpace[i].articulatedInertia
-                * (mScratchSpace[i].partialAcceleration
-                   + mJointsAndBodies[i].axis * mScratchSpace[i].psi
-                         * mScratchSpace[i].totalForce);
+// This computes the mass matrix, with the composite rigid body algorithm
+void SimpleFeatherstone::massMatrix(const s_t* pos, /* OUT */ s_t* massMatrix)
+{
+  updateKinematics(pos, nullptr);
+
+  const int numDofs = getNumDofs();
+  Eigen::Map<Eigen::MatrixXs> M(massMatrix, numDofs, numDofs);
+  M.setZero();
 
-    mScratchSpace[mJointsAndBodies[i].parentIndex].articulatedBiasForce
-        += math::dAdInvT(mScratchSpace[i].transformFromParent, beta);
+  // Backward pass, to sum up the inertia of each subtree
+  for (int i = 0; i < len(); i++)
+  {
+    mScratchSpace[i].compositeInertia = mJointsAndBodies[i].inertia;
   }
-  // Last forward pass
+  for (int i = len() - 1; i >= 0; i--)
+  {
+    const int parentIndex = mJointsAndBodies[i].parentIndex;
+    if (parentIndex == -1)
+      continue;
+    mScratchSpace[parentIndex].compositeInertia += math::transformInertia(
+        mScratchSpace[i].transformFromParent.inverse(),
+        mScratchSpace[i].compositeInertia);
+  }
+
+  // Each joint's force on its subtree is only felt by the joints above it, so
+  // we walk up to the root to fill in its rows and columns
   for (int i = 0; i < len(); i++)
   {
-    accelerations[i]
-        = mScratchSpace[i].psi
-          * (force[i]
-             - (mJointsAndBodies[i].axis.transpose()
-                * mScratchSpace[i].articulatedInertia
-                * (mJointsAndBodies[i].parentIndex != -1
-                       ? (math::AdInvT(
-                              mScratchSpace[i].transformFromParent,
-                              mScratchSpace[mJointsAndBodies[i].parentIndex]
-                                  .spatialAcceleration)
-                          + mScratchSpace[i].partialAcceleration)
-                       : (mScratchSpace[i].partialAcceleration)))
-                   .value()
-             - (mJointsAndBodies[i].axis.transpose()
-                * mScratchSpace[i].articulatedBiasForce)
-                   .value());
-    mScratchSpace[i].spatialAcceleration
-        = accelerations[i] * mJointsAndBodies[i].axis
-          + mScratchSpace[i].partialAcceleration;
-    if (mJointsAndBodies[i].parentIndex != -1)
-      mScratchSpace[i].spatialAcceleration += math::AdInvT(
-          mScratchSpace[i].transformFromParent,
-          mScratchSpace[mJointsAndBodies[i].parentIndex].spatialAcceleration);
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    if (jointAndBody.numDofs == 0)
+      continue;
+
+    FeatherstoneJacobian F
+        = mScratchSpace[i].compositeInertia * mScratchSpace[i].jacobian;
+    M.block(
+        jointAndBody.dofIndex,
+        jointAndBody.dofIndex,
+        jointAndBody.numDofs,
+        jointAndBody.numDofs)
+        = mScratchSpace[i].jacobian.transpose() * F;
+
+    for (int j = i; mJointsAndBodies[j].parentIndex != -1;
+         j = mJointsAndBodies[j].parentIndex)
+    {
+      for (int col = 0; col < F.cols(); col++)
+      {
+        F.col(col)
+            = math::dAdInvT(mScratchSpace[j].transformFromParent, F.col(col));
+      }
+      const JointAndBody& ancestor
+          = mJointsAndBodies[mJointsAndBodies[j].parentIndex];
+      if (ancestor.numDofs == 0)
+        continue;
+      M.block(
+          ancestor.dofIndex,
+          jointAndBody.dofIndex,
+          ancestor.numDofs,
+          jointAndBody.numDofs)
+          = mScratchSpace[mJointsAndBodies[j].parentIndex]
+                .jacobian.transpose()
+            * F;
+      M.block(
+          jointAndBody.dofIndex,
+          ancestor.dofIndex,
+          jointAndBody.numDofs,
+          ancestor.numDofs)
+          = M.block(
+                 ancestor.dofIndex,
+                 jointAndBody.dofIndex,
+                 ancestor.numDofs,
+                 jointAndBody.numDofs)
+                .transpose();
+    }
+  }
+}
+
+// This computes M^{-1} * x
+void SimpleFeatherstone::inverseMassMatrixTimes(
+    const s_t* pos, const s_t* x, /* OUT */ s_t* result)
+{
+  updateKinematics(pos, nullptr);
+  articulatedBodyPasses(pos, nullptr, x, result, false);
+}
+
+// Returns true if we can reproduce the forward dynamics of `skeleton`
+bool SimpleFeatherstone::canRepresent(
+    const std::shared_ptr<dynamics::Skeleton>& skeleton)
+{
+  if (skeleton->getNumSoftBodyNodes() > 0)
+    return false;
+
+  for (std::size_t i = 0; i < skeleton->getNumBodyNodes(); i++)
+  {
+    const Joint* joint = skeleton->getBodyNode(i)->getParentJoint();
+    // Other actuator types overwrite the accelerations or forces, which
+    // happens inside GenericJoint
+    if (joint->getActuatorType() != Joint::FORCE)
+      return false;
+    // We compare the type names rather than dynamic_cast, which is much
+    // cheaper on every step and also turns away subclasses that may have
+    // changed the kinematics
+    const std::string& type = joint->getType();
+    if (type != RevoluteJoint::getStaticType()
+        && type != PrismaticJoint::getStaticType()
+        && type != ScrewJoint::getStaticType()
+        && type != UniversalJoint::getStaticType()
+        && type != EulerJoint::getStaticType()
+        && type != PlanarJoint::getStaticType()
+        && type != TranslationalJoint::getStaticType()
+        && type != BallJoint::getStaticType()
+        && type != FreeJoint::getStaticType()
+        && type != WeldJoint::getStaticType())
+    {
+      return false;
+    }
   }
+  return true;
 }
 
 // This gets the values from a DART skeleton to populate our Featherstone
@@ -142,29 +370,489 @@ void SimpleFeatherstone::forwardDynamics(
 void SimpleFeatherstone::populateFromSkeleton(
     const std::shared_ptr<dynamics::Skeleton>& skeleton)
 {
-  for (int i = 0; i < skeleton->getNumDofs(); i++)
+  assert(
+      canRepresent(skeleton)
+      && "SimpleFeatherstone doesn't support every joint in this skeleton");
+
+  mSyncedSkeleton = nullptr;
+  mJointsAndBodies.clear();
+  mScratchSpace.clear();
+  mGravity = skeleton->getGravity();
+  mTimeStep = skeleton->getTimeStep();
+
+  for (std::size_t i = 0; i < skeleton->getNumBodyNodes(); i++)
   {
-    JointAndBody& jointAndBody = emplaceBack();
+    const BodyNode* bodyNode = skeleton->getBodyNode(i);
+    const Joint* joint = bodyNode->getParentJoint();
+    const int numDofs = joint->getNumDofs();
 
-    DegreeOfFreedom* dof = skeleton->getDof(i);
+    JointAndBody& jointAndBody = emplaceBack();
+    jointAndBody.numDofs = numDofs;
     assert(
-        dof->getIndexInJoint() == 0
-        && "SimpleFeatherstone only supports a single DOF per joint");
-    jointAndBody.axis = dof->getJoint()->getRelativeJacobian().col(0);
+        numDofs == 0
+        || (int)joint->getIndexInSkeleton(0) == jointAndBody.dofIndex);
+    jointAndBody.axes = FeatherstoneJacobian::Zero(6, numDofs);
+
+    const std::string& type = joint->getType();
+    if (type == BallJoint::getStaticType())
+    {
+      jointAndBody.type = BALL;
+    }
+    else if (type == FreeJoint::getStaticType())
+    {
+      jointAndBody.type = FREE;
+    }
+    else if (type == RevoluteJoint::getStaticType())
+    {
+      jointAndBody.axes.col(0).head<3>()
+          = static_cast<const RevoluteJoint*>(joint)->getAxis();
+    }
+    else if (type == PrismaticJoint::getStaticType())
+    {
+      jointAndBody.axes.col(0).tail<3>()
+          = static_cast<const PrismaticJoint*>(joint)->getAxis();
+    }
+    else if (type == ScrewJoint::getStaticType())
+    {
+      // The screw axis is constant, so we can read it back out of the
+      // Jacobian rather than repeating ScrewJoint's pitch convention
+      jointAndBody.axes.col(0) = math::AdInvT(
+          joint->getTransformFromChildBodyNode(),
+          joint->getRelativeJacobian().col(0));
+    }
+    else if (type == UniversalJoint::getStaticType())
+    {
+      auto universal = static_cast<const UniversalJoint*>(joint);
+      jointAndBody.axes.col(0).head<3>() = universal->getAxis1();
+      jointAndBody.axes.col(1).head<3>() = universal->getAxis2();
+    }
+    else if (type == EulerJoint::getStaticType())
+    {
+      auto euler = static_cast<const EulerJoint*>(joint);
+      // See math::eulerXYZToMatrix() and math::eulerZYXToMatrix()
+      if (euler->getAxisOrder() == EulerJoint::AxisOrder::XYZ)
+      {
+        jointAndBody.axes.block<3, 3>(0, 0) = Eigen::Matrix3s::Identity();
+      }
+      else
+      {
+        jointAndBody.axes.block<3, 3>(0, 0)
+            = Eigen::Matrix3s::Identity().rowwise().reverse();
+      }
+    }
+    else if (type == PlanarJoint::getStaticType())
+    {
+      auto planar = static_cast<const PlanarJoint*>(joint);
+      jointAndBody.axes.col(0).tail<3>() = planar->getTranslationalAxis1();
+      jointAndBody.axes.col(1).tail<3>() = planar->getTranslationalAxis2();
+      jointAndBody.axes.col(2).head<3>() = planar->getRotationalAxis();
+    }
+    else if (type == TranslationalJoint::getStaticType())
+    {
+      jointAndBody.axes.block<3, 3>(3, 0) = Eigen::Matrix3s::Identity();
+    }
+    // Anything left is a WeldJoint, which has no DOFs and is just its fixed
+    // transforms
+
     jointAndBody.transformFromChildren
-        = dof->getJoint()->getTransformFromChildBodyNode();
-    jointAndBody.transformFromParent
-        = dof->getJoint()->getTransformFromParentBodyNode();
-    jointAndBody.inertia
-        = dof->getChildBodyNode()->getInertia().getSpatialTensor();
+        = joint->getTransformFromChildBodyNode();
+    jointAndBody.transformToChildren
+        = jointAndBody.transformFromChildren.inverse();
+    jointAndBody.transformFromParent = joint->getTransformFromParentBodyNode();
+    jointAndBody.inertia = bodyNode->getInertia().getSpatialTensor();
+    jointAndBody.gravityMode = bodyNode->getGravityMode();
+    jointAndBody.externalForce = bodyNode->getExternalForceLocal();
+
+    jointAndBody.springStiffnesses.resize(numDofs);
+    jointAndBody.restPositions.resize(numDofs);
+    jointAndBody.dampingCoefficients.resize(numDofs);
+    for (int k = 0; k < numDofs; k++)
+    {
+      jointAndBody.springStiffnesses(k) = joint->getSpringStiffness(k);
+      jointAndBody.restPositions(k) = joint->getRestPosition(k);
+      jointAndBody.dampingCoefficients(k) = joint->getDampingCoefficient(k);
+    }
+
     jointAndBody.parentIndex = -1;
-    if (dof->getJoint()->getParentBodyNode() != nullptr)
+    if (bodyNode->getParentBodyNode() != nullptr)
+    {
+      jointAndBody.parentIndex
+          = bodyNode->getParentBodyNode()->getIndexInSkeleton();
+    }
+
+    // Like DART, which only updates the relative Jacobian when the joint's
+    // properties change, we compute the Jacobian here once if it doesn't
+    // depend on the positions
+#ifdef DART_USE_IDENTITY_JACOBIAN
+    jointAndBody.hasConstantJacobian
+        = jointAndBody.type != SCREW_CHAIN || numDofs <= 1;
+#else
+    jointAndBody.hasConstantJacobian
+        = jointAndBody.type == SCREW_CHAIN && numDofs <= 1;
+#endif
+    updateConstantJacobian(len() - 1);
+  }
+}
+
+// This repopulates only when the structure of `skeleton` changed, and
+// otherwise copies over its per-step state
+bool SimpleFeatherstone::syncFromSkeleton(
+    const std::shared_ptr<dynamics::Skeleton>& skeleton)
+{
+  const std::size_t numBodyNodes = skeleton->getNumBodyNodes();
+  bool changed = skeleton.get() != mSyncedSkeleton
+                 || skeleton->getVersion() != mSyncedVersion
+                 || numBodyNodes != mSyncedJoints.size();
+  for (std::size_t i = 0; !changed && i < numBodyNodes; i++)
+  {
+    const Joint* joint = skeleton->getBodyNode(i)->getParentJoint();
+    changed = joint != mSyncedJoints[i]
+              || joint->getActuatorType() != mSyncedActuatorTypes[i];
+  }
+
+  if (!changed)
+  {
+    if (mSyncedCanRepresent)
+      refreshFromSkeleton(skeleton);
+    return mSyncedCanRepresent;
+  }
+
+  const bool representable = canRepresent(skeleton);
+  if (representable)
+    populateFromSkeleton(skeleton);
+
+  mSyncedSkeleton = skeleton.get();
+  mSyncedVersion = skeleton->getVersion();
+  mSyncedCanRepresent = representable;
+  mSyncedJoints.resize(numBodyNodes);
+  mSyncedActuatorTypes.resize(numBodyNodes);
+  for (std::size_t i = 0; i < numBodyNodes; i++)
+  {
+    const Joint* joint = skeleton->getBodyNode(i)->getParentJoint();
+    mSyncedJoints[i] = joint;
+    mSyncedActuatorTypes[i] = joint->getActuatorType();
+  }
+  return representable;
+}
+
+// This copies over the state populateFromSkeleton() reads that doesn't bump
+// the Skeleton's version
+void SimpleFeatherstone::refreshFromSkeleton(
+    const std::shared_ptr<dynamics::Skeleton>& skeleton)
+{
+  mGravity = skeleton->getGravity();
+  mTimeStep = skeleton->getTimeStep();
+  for (int i = 0; i < len(); i++)
+  {
+    const BodyNode* bodyNode = skeleton->getBodyNode(i);
+    const Joint* joint = bodyNode->getParentJoint();
+    JointAndBody& jointAndBody = mJointsAndBodies[i];
+
+    jointAndBody.externalForce = bodyNode->getExternalForceLocal();
+    jointAndBody.transformFromParent = joint->getTransformFromParentBodyNode();
+    const Eigen::Isometry3s& fromChild = joint->getTransformFromChildBodyNode();
+    if (fromChild.matrix() != jointAndBody.transformFromChildren.matrix())
+    {
+      jointAndBody.transformFromChildren = fromChild;
+      jointAndBody.transformToChildren = fromChild.inverse();
+      updateConstantJacobian(i);
+    }
+  }
+}
+
+// This fills in the Jacobian of a joint that doesn't depend on its positions
+void SimpleFeatherstone::updateConstantJacobian(int index)
+{
+  const JointAndBody& jointAndBody = mJointsAndBodies[index];
+  if (!jointAndBody.hasConstantJacobian)
+    return;
+
+  FeatherstoneJacobian S = jointAndBody.axes;
+  if (jointAndBody.type != SCREW_CHAIN)
+  {
+    S.setIdentity();
+  }
+  FeatherstoneScratchSpace& scratch = mScratchSpace[index];
+  scratch.jacobian.resize(6, jointAndBody.numDofs);
+  for (int k = 0; k < jointAndBody.numDofs; k++)
+  {
+    scratch.jacobian.col(k)
+        = math::AdT(jointAndBody.transformFromChildren, S.col(k));
+  }
+}
+
+// This computes the transforms, Jacobians, and velocities of every body
+void SimpleFeatherstone::updateKinematics(const s_t* pos, const s_t* vel)
+{
+  for (int i = 0; i < len(); i++)
+  {
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    FeatherstoneScratchSpace& scratch = mScratchSpace[i];
+    const int numDofs = jointAndBody.numDofs;
+    const s_t* q = pos + jointAndBody.dofIndex;
+    const s_t* dq = vel == nullptr ? nullptr : vel + jointAndBody.dofIndex;
+
+    // First we get the transform, Jacobian and Jacobian time derivative (times
+    // the velocity) in the joint frame. See the updateRelativeTransform(),
+    // updateRelativeJacobian() and updateRelativeJacobianTimeDeriv() methods
+    // of each Joint for the DART equivalents.
+    Eigen::Isometry3s jointTransform = Eigen::Isometry3s::Identity();
+    FeatherstoneJacobian S(6, numDofs);
+    Eigen::Vector6s dSdq = Eigen::Vector6s::Zero();
+    switch (jointAndBody.type)
+    {
+      case SCREW_CHAIN: {
+        // Each axis gets moved by all the motions after it in the chain, and
+        // its time derivative is the bracket with their velocity
+        Eigen::Vector6s tailVelocity = Eigen::Vector6s::Zero();
+        for (int k = numDofs - 1; k >= 0; k--)
+        {
+          const Eigen::Vector6s& axis = jointAndBody.axes.col(k);
+          if (k == numDofs - 1)
+          {
+            S.col(k) = axis;
+          }
+          else
+          {
+            S.col(k) = math::AdInvT(jointTransform, axis);
+            if (dq != nullptr)
+            {
+              dSdq -= math::ad(tailVelocity, S.col(k)) * dq[k];
+            }
+          }
+          if (dq != nullptr)
+          {
+            tailVelocity += S.col(k) * dq[k];
+          }
+          // Pure rotations and translations are by far the most common, and
+          // much cheaper than a general screw motion
+          if (axis.tail<3>().isZero(0))
+          {
+            jointTransform.prerotate(math::expMapRot(axis.head<3>() * q[k]));
+          }
+          else if (axis.head<3>().isZero(0))
+          {
+            jointTransform.pretranslate(axis.tail<3>() * q[k]);
+          }
+          else
+          {
+            jointTransform = math::expMap(axis * q[k]) * jointTransform;
+          }
+        }
+        break;
+      }
+      case BALL: {
+        Eigen::Map<const Eigen::Vector3s> rotation(q);
+        jointTransform.linear() = math::expMapRot(rotation);
+        S.bottomRows<3>().setZero();
+#ifdef DART_USE_IDENTITY_JACOBIAN
+        S.topRows<3>().setIdentity();
+#else
+        S.topRows<3>() = math::so3RightJacobian(rotation);
+        if (dq != nullptr)
+        {
+          Eigen::Map<const Eigen::Vector3s> angularVel(dq);
+          dSdq.head<3>()
+              = math::so3RightJacobianTimeDeriv(rotation, angularVel)
+                * angularVel;
+        }
+#endif
+        break;
+      }
+      case FREE: {
+        Eigen::Map<const Eigen::Vector3s> rotation(q);
+        jointTransform.linear() = math::expMapRot(rotation);
+        jointTransform.translation() = Eigen::Map<const Eigen::Vector3s>(q + 3);
+#ifdef DART_USE_IDENTITY_JACOBIAN
+        S.setIdentity();
+#else
+        S.setZero();
+        S.topLeftCorner<3, 3>() = math::so3RightJacobian(rotation);
+        S.bottomRightCorner<3, 3>() = jointTransform.linear().transpose();
+        if (dq != nullptr)
+        {
+          Eigen::Map<const Eigen::Vector3s> angularVel(dq);
+          Eigen::Map<const Eigen::Vector3s> linearVel(dq + 3);
+          dSdq.head<3>()
+              = math::so3RightJacobianTimeDeriv(rotation, angularVel)
+                * angularVel;
+          dSdq.tail<3>() = math::makeSkewSymmetric(
+                               S.topLeftCorner<3, 3>() * -angularVel)
+                           * jointTransform.linear().transpose() * linearVel;
+        }
+#endif
+        break;
+      }
+    }
+
+    // Then we move into the child body frame
+    scratch.transformFromParent = jointAndBody.transformFromParent
+                                  * jointTransform
+                                  * jointAndBody.transformToChildren;
+    if (!jointAndBody.hasConstantJacobian)
+    {
+      scratch.jacobian.resize(6, numDofs);
+      for (int k = 0; k < numDofs; k++)
+      {
+        scratch.jacobian.col(k)
+            = math::AdT(jointAndBody.transformFromChildren, S.col(k));
+      }
+    }
+
+    if (jointAndBody.parentIndex != -1)
+    {
+      const FeatherstoneScratchSpace& parent
+          = mScratchSpace[jointAndBody.parentIndex];
+      scratch.worldRotation
+          = parent.worldRotation * scratch.transformFromParent.linear();
+      scratch.spatialVelocity = math::AdInvT(
+          scratch.transformFromParent, parent.spatialVelocity);
+    }
+    else
+    {
+      scratch.worldRotation = scratch.transformFromParent.linear();
+      scratch.spatialVelocity.setZero();
+    }
+
+    if (dq != nullptr && numDofs > 0)
+    {
+      const Eigen::Vector6s jointVelocity
+          = scratch.jacobian
+            * Eigen::Map<const Eigen::VectorXs>(dq, numDofs);
+      scratch.spatialVelocity += jointVelocity;
+      // See GenericJoint::setPartialAccelerationTo() for DART equivalent
+      scratch.partialAcceleration
+          = math::ad(scratch.spatialVelocity, jointVelocity);
+      if (!jointAndBody.hasConstantJacobian)
+      {
+        scratch.partialAcceleration
+            += math::AdT(jointAndBody.transformFromChildren, dSdq);
+      }
+    }
+    else
+    {
+      scratch.partialAcceleration.setZero();
+    }
+  }
+}
+
+// This runs the backward and forward passes of the articulated body algorithm
+void SimpleFeatherstone::articulatedBodyPasses(
+    const s_t* pos,
+    const s_t* vel,
+    const s_t* force,
+    /* OUT */ s_t* accelerations,
+    bool withBiasForces)
+{
+  for (int i = 0; i < len(); i++)
+  {
+    // Zero out scratch space to prepare for sums in backwards pass
+    mScratchSpace[i].articulatedInertia.setZero();
+    mScratchSpace[i].articulatedBiasForce.setZero();
+  }
+  // Backward pass
+  for (int i = len() - 1; i >= 0; i--)
+  {
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    FeatherstoneScratchSpace& scratch = mScratchSpace[i];
+    const int numDofs = jointAndBody.numDofs;
+    const Eigen::Matrix6s& I = jointAndBody.inertia;
+
+    scratch.articulatedInertia += I;
+    if (withBiasForces)
+    {
+      // See BodyNode::updateBiasForce() for DART equivalent
+      scratch.articulatedBiasForce
+          -= math::dad(scratch.spatialVelocity, I * scratch.spatialVelocity)
+             + jointAndBody.externalForce;
+      if (jointAndBody.gravityMode)
+      {
+        scratch.articulatedBiasForce.noalias()
+            -= I.rightCols<3>()
+               * (scratch.worldRotation.transpose() * mGravity);
+      }
+    }
+
+    // See GenericJoint::addChildArtInertiaImplicitToDynamic() and
+    // GenericJoint::addChildBiasForceToDynamic() for DART equivalents
+    Eigen::Matrix6s PI = scratch.articulatedInertia;
+    Eigen::Vector6s beta
+        = scratch.articulatedBiasForce
+          + scratch.articulatedInertia * scratch.partialAcceleration;
+    if (numDofs > 0)
+    {
+      auto jointBackward = &articulatedJointBackward<Eigen::Dynamic>;
+      switch (numDofs)
+      {
+        case 1:
+          jointBackward = &articulatedJointBackward<1>;
+          break;
+        case 2:
+          jointBackward = &articulatedJointBackward<2>;
+          break;
+        case 3:
+          jointBackward = &articulatedJointBackward<3>;
+          break;
+        case 6:
+          jointBackward = &articulatedJointBackward<6>;
+          break;
+      }
+      jointBackward(
+          jointAndBody,
+          scratch,
+          pos,
+          vel,
+          force,
+          mTimeStep,
+          withBiasForces,
+          PI,
+          beta);
+    }
+
+    if (jointAndBody.parentIndex == -1)
+      continue;
+
+    // Sum into our parents
+    mScratchSpace[jointAndBody.parentIndex].articulatedInertia
+        += math::transformInertia(scratch.transformFromParent.inverse(), PI);
+    mScratchSpace[jointAndBody.parentIndex].articulatedBiasForce
+        += math::dAdInvT(scratch.transformFromParent, beta);
+  }
+  // Last forward pass
+  for (int i = 0; i < len(); i++)
+  {
+    const JointAndBody& jointAndBody = mJointsAndBodies[i];
+    FeatherstoneScratchSpace& scratch = mScratchSpace[i];
+
+    Eigen::Vector6s parentAcceleration = Eigen::Vector6s::Zero();
+    if (jointAndBody.parentIndex != -1)
+    {
+      parentAcceleration = math::AdInvT(
+          scratch.transformFromParent,
+          mScratchSpace[jointAndBody.parentIndex].spatialAcceleration);
+    }
+    scratch.spatialAcceleration
+        = parentAcceleration + scratch.partialAcceleration;
+
+    if (jointAndBody.numDofs > 0)
     {
-      jointAndBody.parentIndex = dof->getJoint()
-                                     ->getParentBodyNode()
-                                     ->getParentJoint()
-                                     ->getDof(0)
-                                     ->getIndexInSkeleton();
+      auto jointForward = &articulatedJointForward<Eigen::Dynamic>;
+      switch (jointAndBody.numDofs)
+      {
+        case 1:
+          jointForward = &articulatedJointForward<1>;
+          break;
+        case 2:
+          jointForward = &articulatedJointForward<2>;
+          break;
+        case 3:
+          jointForward = &articulatedJointForward<3>;
+          break;
+        case 6:
+          jointForward = &articulatedJointForward<6>;
+          break;
+      }
+      jointForward(jointAndBody, scratch, parentAcceleration, accelerations);
     }
   }
 }
@@ -6,24 +6,68 @@
 
 #include <Eigen/Dense>
 
+#include "dart/common/Memory.hpp"
 #include "dart/math/Geometry.hpp"
 
 namespace dart {
 namespace dynamics {
 
+class Joint;
 class Skeleton;
 
+// No joint has more than 6 DOFs, so these have a fixed maximum size and never
+// touch the heap
+typedef Eigen::Matrix<s_t, 6, Eigen::Dynamic, 0, 6, 6> FeatherstoneJacobian;
+typedef Eigen::Matrix<s_t, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>
+    FeatherstoneMatrix;
+typedef Eigen::Matrix<s_t, Eigen::Dynamic, 1, 0, 6, 1> FeatherstoneVector;
+
+enum FeatherstoneJointType
+{
+  // The joint is a sequence of screw motions, one per DOF, so the transform is
+  // expMap(axes.col(0) * pos[0]) * ... * expMap(axes.col(n-1) * pos[n-1]).
+  // This covers revolute, prismatic, screw, universal, euler, planar and
+  // translational joints, and (with no DOFs at all) weld joints.
+  SCREW_CHAIN = 0,
+  // The positions are the exponential coordinates of a rotation
+  BALL = 1,
+  // The first 3 positions are the exponential coordinates of a rotation, and
+  // the last 3 are a translation
+  FREE = 2
+};
+
 struct JointAndBody
 {
-  // This is a normalized transform, represented in log-space. You can recover
-  // the transform by dart::math::expMap(axis * position)
-  Eigen::Vector6s axis;
-  // This is the transform from the parent
+  // This is how positions map to the joint's transform
+  FeatherstoneJointType type;
+  // The number of DOFs of the joint
+  int numDofs;
+  // The index of the joint's first DOF in the pos, vel and force arrays
+  int dofIndex;
+  // For SCREW_CHAIN joints, these are the normalized screw axes of each DOF,
+  // in the joint frame
+  FeatherstoneJacobian axes;
+  // This is the transform from the parent body to the joint frame
   Eigen::Isometry3s transformFromParent;
-  // This is the transform from the children
+  // This is the transform from the child body to the joint frame
   Eigen::Isometry3s transformFromChildren;
+  // This is the inverse of transformFromChildren
+  Eigen::Isometry3s transformToChildren;
+  // If true, the joint's Jacobian doesn't depend on its positions, so
+  // populateFromSkeleton() fills in FeatherstoneScratchSpace::jacobian once
+  // and we never recompute it
+  bool hasConstantJacobian;
   // This is the spatial inertia matrix for the body node
   Eigen::Matrix6s inertia;
+  // True if gravity acts on the body node
+  bool gravityMode;
+  // This is the external force on the body node, in its own frame
+  Eigen::Vector6s externalForce;
+  // These are the joint springs and dampers. Like DART, forwardDynamics()
+  // integrates them implicitly over SimpleFeatherstone::mTimeStep.
+  FeatherstoneVector springStiffnesses;
+  FeatherstoneVector restPositions;
+  FeatherstoneVector dampingCoefficients;
   // -1 indicates this is the root element, otherwise this is the index into
   // SimpleFeatherstone::mJointsAndBodies where the parent lives
   int parentIndex;
@@ -32,23 +76,34 @@ struct JointAndBody
 struct FeatherstoneScratchSpace
 {
   Eigen::Isometry3s transformFromParent;
+  // The rotation of the body relative to the world, to apply gravity with
+  Eigen::Matrix3s worldRotation;
+  // The relative Jacobian of the joint, in the child body frame
+  FeatherstoneJacobian jacobian;
   Eigen::Vector6s spatialVelocity;
   Eigen::Vector6s spatialAcceleration;
+  // The net force transmitted through the joint, for inverse dynamics
+  Eigen::Vector6s spatialForce;
 
   Eigen::Matrix6s articulatedInertia;
   Eigen::Vector6s articulatedBiasForce;
+  // The articulated inertia times the Jacobian
+  FeatherstoneJacobian articulatedInertiaTimesJacobian;
+  // The inertia of the whole subtree rooted at this body, for the mass matrix
+  Eigen::Matrix6s compositeInertia;
 
   // Intermediate values without convenient names. From the symbols on
   // page 12 of http://www.cs.cmu.edu/~junggon/tools/liegroupdynamics.pdf
-  s_t psi;
-  s_t totalForce;
+  FeatherstoneMatrix psi;
+  FeatherstoneVector totalForce;
   Eigen::Vector6s partialAcceleration; // = eta
-  Eigen::Matrix6s phi;
 };
 
 class SimpleFeatherstone
 {
 public:
+  SimpleFeatherstone();
+
   // This creates a new JointAndBody object in our vector, and returns it by
   // reference
   JointAndBody& emplaceBack();
@@ -56,22 +111,95 @@ public:
   // The number of joints in this skeleton
   int len();
 
+  // The total number of DOFs of all the joints in this skeleton, which is the
+  // length of the pos, vel, force and acceleration arrays
+  int getNumDofs();
+
   // This computes accelerations. All the pointer arguments are assumed to point
-  // to arrays of length len()
+  // to arrays of length getNumDofs()
   void forwardDynamics(
-      s_t* pos,
-      s_t* vel,
-      s_t* force,
+      const s_t* pos,
+      const s_t* vel,
+      const s_t* force,
       /* OUT */ s_t* accelerations);
 
+  // This computes the joint forces needed to get `accelerations`. Like
+  // Skeleton::computeInverseDynamics() with its default arguments, this
+  // accounts for gravity, but not for external forces, springs or damping.
+  void inverseDynamics(
+      const s_t* pos,
+      const s_t* vel,
+      const s_t* accelerations,
+      /* OUT */ s_t* forces);
+
+  // This computes the mass matrix with the composite rigid body algorithm.
+  // `massMatrix` is a column-major getNumDofs() x getNumDofs() array.
+  void massMatrix(const s_t* pos, /* OUT */ s_t* massMatrix);
+
+  // This computes M^{-1} * x with the articulated body algorithm, without ever
+  // forming M
+  void inverseMassMatrixTimes(
+      const s_t* pos, const s_t* x, /* OUT */ s_t* result);
+
+  // Returns true if every joint in `skeleton` is of a type we can represent,
+  // and driven by force, so that populateFromSkeleton() and forwardDynamics()
+  // reproduce Skeleton::computeForwardDynamics()
+  static bool canRepresent(const std::shared_ptr<dynamics::Skeleton>& skeleton);
+
   // This gets the values from a DART skeleton to populate our Featherstone
-  // implementation
+  // implementation, replacing whatever was here before
   void populateFromSkeleton(
       const std::shared_ptr<dynamics::Skeleton>& skeleton);
 
+  // This brings us up to date with `skeleton` before a step. We only
+  // repopulate if its joints, or anything that bumps its version (joint axes,
+  // inertias, springs), changed since the last call. Otherwise we just copy
+  // over gravity, the time step, external forces and the joints' fixed
+  // transforms. Returns false, without populating, if we can't represent
+  // `skeleton`.
+  bool syncFromSkeleton(const std::shared_ptr<dynamics::Skeleton>& skeleton);
+
   // protected:
-  std::vector<JointAndBody> mJointsAndBodies;
-  std::vector<FeatherstoneScratchSpace> mScratchSpace;
+  common::aligned_vector<JointAndBody> mJointsAndBodies;
+  common::aligned_vector<FeatherstoneScratchSpace> mScratchSpace;
+  Eigen::Vector3s mGravity;
+  s_t mTimeStep;
+
+protected:
+  // This computes the transforms and Jacobians of every joint at `pos`, and
+  // the spatial velocities and partial accelerations of every body at `vel`.
+  // If `vel` is null, we treat the velocities as zero.
+  void updateKinematics(const s_t* pos, const s_t* vel);
+
+  // This runs the last two passes of the articulated body algorithm, after
+  // updateKinematics(). If `withBiasForces` is false, we leave out velocity
+  // terms, gravity, external forces, springs and damping, which leaves
+  // accelerations = M^{-1} * force.
+  void articulatedBodyPasses(
+      const s_t* pos,
+      const s_t* vel,
+      const s_t* force,
+      /* OUT */ s_t* accelerations,
+      bool withBiasForces);
+
+  // This copies over the values populateFromSkeleton() reads that can change
+  // without bumping the Skeleton's version
+  void refreshFromSkeleton(
+      const std::shared_ptr<dynamics::Skeleton>& skeleton);
+
+  // If joint `index` has a Jacobian that doesn't depend on its positions, this
+  // fills it in, so updateKinematics() never has to
+  void updateConstantJacobian(int index);
+
+  // The Skeleton that syncFromSkeleton() last synced with, or null if we've
+  // been populated some other way since
+  const dynamics::Skeleton* mSyncedSkeleton;
+  // The Skeleton's version, parent joints and actuator types at that sync
+  std::size_t mSyncedVersion;
+  std::vector<const dynamics::Joint*> mSyncedJoints;
+  std::vector<int> mSyncedActuatorTypes;
+  // The result of canRepresent() at that sync
+  bool mSyncedCanRepresent;
 };
 
 } // namespace dynamics
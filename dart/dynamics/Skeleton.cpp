@@ -1842,9 +1842,8 @@ Eigen::MatrixXs Skeleton::getJacobianOfMinv_ID(
   }
   else if (wrt == neural::WithRespectTo::POSITION)
   {
-    const Eigen::MatrixXs& Minv = getInvMassMatrix();
-    const Eigen::MatrixXs& DMddq_Dq = getJacobianOfM(Minv * f, wrt);
-    return -Minv * DMddq_Dq;
+    const Eigen::MatrixXs DMddq_Dq = getJacobianOfM(solveMassMatrix(f), wrt);
+    return -solveMassMatrix(DMddq_Dq);
   }
   else
   {
@@ -1973,12 +1972,11 @@ Eigen::MatrixXs Skeleton::getJacobianOfFD(neural::WithRespectTo* wrt)
 {
   const auto& tau = getControlForces();
   const auto& Cg = getCoriolisAndGravityForces();
-  const auto& Minv = getInvMassMatrix();
 
   const auto& DMinv_Dp = getJacobianOfMinv(tau - Cg, wrt);
   const auto& DC_Dp = getJacobianOfC(wrt);
 
-  return DMinv_Dp - Minv * DC_Dp;
+  return DMinv_Dp - solveMassMatrix(DC_Dp);
 }
 
 //==============================================================================
@@ -1988,17 +1986,16 @@ Eigen::MatrixXs Skeleton::getUnconstrainedVelJacobianWrt(
   Eigen::VectorXs tau = getControlForces();
   Eigen::VectorXs C = getCoriolisAndGravityForces() - getExternalForces();
 
-  Eigen::MatrixXs Minv = getInvMassMatrix();
   Eigen::MatrixXs dC = getJacobianOfC(wrt);
 
   if (wrt == neural::WithRespectTo::POSITION)
   {
     Eigen::MatrixXs dM = getJacobianOfMinv(dt * (tau - C), wrt);
-    return dM - Minv * dt * dC;
+    return dM - dt * solveMassMatrix(dC);
   }
   else
   {
-    return -Minv * dt * dC;
+    return -dt * solveMassMatrix(dC);
   }
 }
 
@@ -2107,6 +2104,27 @@ void Skeleton::DiffC::print()
 }
 #endif
 
+//==============================================================================
+Eigen::MatrixXs Skeleton::getMassMatrixByUnitAccelerations() const
+{
+  Eigen::MatrixXs M = Eigen::MatrixXs::Zero(getNumDofs(), getNumDofs());
+  Eigen::MatrixXs treeM;
+  for (std::size_t tree = 0; tree < mTreeCache.size(); ++tree)
+  {
+    computeMassMatrixByUnitAccelerations(tree, treeM);
+    const std::vector<DegreeOfFreedom*>& treeDofs = mTreeCache[tree].mDofs;
+    for (std::size_t i = 0; i < treeDofs.size(); ++i)
+    {
+      for (std::size_t j = 0; j < treeDofs.size(); ++j)
+      {
+        M(treeDofs[i]->getIndexInSkeleton(), treeDofs[j]->getIndexInSkeleton())
+            = treeM(i, j);
+      }
+    }
+  }
+  return M;
+}
+
 //==============================================================================
 Eigen::MatrixXs Skeleton::finiteDifferenceJacobianOfM(
     const Eigen::VectorXs& x, neural::WithRespectTo* wrt, bool useRidders)
@@ -3925,6 +3943,73 @@ const Eigen::MatrixXs& Skeleton::getInvMassMatrix() const
   return mSkelCache.mInvM;
 }
 
+//==============================================================================
+const Eigen::MatrixXs& Skeleton::getMassMatrixFactor(std::size_t _treeIdx) const
+{
+  // Recomputing M dirties its factorization
+  getMassMatrix(_treeIdx);
+  if (mTreeCache[_treeIdx].mDirty.mMassMatrixFactor)
+    updateMassMatrixFactor(_treeIdx);
+
+  return mTreeCache[_treeIdx].mMassMatrixFactor;
+}
+
+//==============================================================================
+const DynamicsKernel& Skeleton::getDynamicsKernel(std::size_t _treeIdx) const
+{
+  updateDynamicsKernel(_treeIdx);
+  updateDynamicsKernelVelocities(_treeIdx);
+
+  return mTreeCache[_treeIdx].mKernel;
+}
+
+//==============================================================================
+Eigen::MatrixXs Skeleton::solveMassMatrix(const Eigen::MatrixXs& _B) const
+{
+  assert(static_cast<std::size_t>(_B.rows()) == getNumDofs());
+  Eigen::MatrixXs result(_B.rows(), _B.cols());
+  Eigen::MatrixXs treeX;
+  for (std::size_t tree = 0; tree < mTreeCache.size(); ++tree)
+  {
+    const std::vector<DegreeOfFreedom*>& treeDofs = mTreeCache[tree].mDofs;
+    const std::size_t nTreeDofs = treeDofs.size();
+    if (nTreeDofs == 0)
+      continue;
+
+    treeX.resize(nTreeDofs, _B.cols());
+    for (std::size_t i = 0; i < nTreeDofs; ++i)
+      treeX.row(i) = _B.row(treeDofs[i]->getIndexInSkeleton());
+
+    solveMassMatrixFactor(tree, treeX);
+
+    for (std::size_t i = 0; i < nTreeDofs; ++i)
+      result.row(treeDofs[i]->getIndexInSkeleton()) = treeX.row(i);
+  }
+  return result;
+}
+
+//==============================================================================
+Eigen::MatrixXs Skeleton::solveMassMatrixTranspose(
+    const Eigen::MatrixXs& _B) const
+{
+  // M is symmetric, so B * M^{-1} = (M^{-1} * B^T)^T
+  return solveMassMatrix(_B.transpose()).transpose();
+}
+
+//==============================================================================
+Eigen::MatrixXs Skeleton::getInvMassMatrixBlock(
+    std::size_t _rowStart,
+    std::size_t _colStart,
+    std::size_t _rows,
+    std::size_t _cols) const
+{
+  const std::size_t dofs = getNumDofs();
+  assert(_rowStart + _rows <= dofs && _colStart + _cols <= dofs);
+  Eigen::MatrixXs unitForces = Eigen::MatrixXs::Zero(dofs, _cols);
+  unitForces.middleRows(_colStart, _cols).setIdentity();
+  return solveMassMatrix(unitForces).middleRows(_rowStart, _rows);
+}
+
 //==============================================================================
 const Eigen::MatrixXs& Skeleton::getInvAugMassMatrix(std::size_t _treeIdx) const
 {
@@ -4820,6 +4905,7 @@ void Skeleton::updateCacheDimensions(std::size_t _treeIdx)
   updateCacheDimensions(mTreeCache[_treeIdx]);
   updateCacheDimensions(mSkelCache);
 
+  SET_FLAG(_treeIdx, mDynamicsKernelTopology);
   dirtyArticulatedInertia(_treeIdx);
 }
 
@@ -4865,7 +4951,247 @@ void Skeleton::updateMassMatrix(std::size_t _treeIdx) const
     return;
   }
 
+  updateDynamicsKernel(_treeIdx);
+  DynamicsKernel& kernel = cache.mKernel;
+
+  // Point masses carry their own DOFs, which the composite inertias below
+  // don't account for
+  if (kernel.mHasSoftBodies)
+  {
+    computeMassMatrixByUnitAccelerations(_treeIdx, cache.mM);
+    cache.mDirty.mMassMatrix = false;
+    cache.mDirty.mMassMatrixFactor = true;
+    return;
+  }
+
+  // Composite Rigid Body Algorithm: accumulate the spatial inertia of each
+  // subtree in its root body's frame, then project each composite inertia
+  // onto the joints between that body and the root of the tree.
+  const std::size_t numBodies = kernel.getNumBodies();
+  common::aligned_vector<Eigen::Matrix6s>& compositeInertias
+      = kernel.mCompositeInertias;
+
+  for (std::size_t i = 0; i < numBodies; ++i)
+    compositeInertias[i] = kernel.mSpatialInertias[i];
+
+  // Children always come after their parents in the tree, so iterating
+  // backwards finishes each composite inertia before it's passed up
+  for (std::size_t i = numBodies; i-- > 0;)
+  {
+    const int parent = kernel.mParents[i];
+    if (parent != -1)
+    {
+      compositeInertias[parent] += math::transformInertia(
+          kernel.mRelativeTransforms[i].inverse(), compositeInertias[i]);
+    }
+  }
+
   cache.mM.setZero();
+  math::Jacobian F;
+  for (std::size_t i = 0; i < numBodies; ++i)
+  {
+    const int localDof = kernel.mNumJointDofs[i];
+    if (localDof == 0)
+      continue;
+
+    const int iStart = kernel.mDofStarts[i];
+    const auto S = kernel.mRelativeJacobians.middleCols(iStart, localDof);
+    F.noalias() = compositeInertias[i] * S;
+    cache.mM.block(iStart, iStart, localDof, localDof).noalias()
+        = S.transpose() * F;
+
+    // Walk F, the force needed to accelerate this subtree, up towards the
+    // root, projecting it onto each ancestor joint along the way
+    for (int body = i; kernel.mParents[body] != -1;)
+    {
+      const Eigen::Isometry3s& T = kernel.mRelativeTransforms[body];
+      for (int k = 0; k < localDof; ++k)
+        F.col(k) = math::dAdInvT(T, F.col(k));
+
+      body = kernel.mParents[body];
+      const int ancestorDof = kernel.mNumJointDofs[body];
+      if (ancestorDof == 0)
+        continue;
+
+      // Ancestors always come first in the tree, so this is below the
+      // diagonal
+      const int jStart = kernel.mDofStarts[body];
+      cache.mM.block(iStart, jStart, localDof, ancestorDof).noalias()
+          = F.transpose()
+            * kernel.mRelativeJacobians.middleCols(jStart, ancestorDof);
+    }
+  }
+  cache.mM.triangularView<Eigen::StrictlyUpper>() = cache.mM.transpose();
+
+  cache.mDirty.mMassMatrix = false;
+  cache.mDirty.mMassMatrixFactor = true;
+}
+
+//==============================================================================
+void Skeleton::updateMassMatrixFactor(std::size_t _treeIdx) const
+{
+  DataCache& cache = mTreeCache[_treeIdx];
+  const int dof = static_cast<int>(cache.mDofs.size());
+
+  // Featherstone's LTDL factorization, which only ever touches entries whose
+  // column is an ancestor of their row, so it stays as sparse as the tree
+  Eigen::MatrixXs& H = cache.mMassMatrixFactor;
+  H = cache.mM;
+  updateDynamicsKernel(_treeIdx);
+  const std::vector<int>& parents = cache.mKernel.mDofParents;
+  for (int k = dof - 1; k >= 0; --k)
+  {
+    for (int i = parents[k]; i != -1; i = parents[i])
+    {
+      const s_t a = H(k, i) / H(k, k);
+      for (int j = i; j != -1; j = parents[j])
+        H(i, j) -= a * H(k, j);
+      H(k, i) = a;
+    }
+  }
+
+  cache.mDirty.mMassMatrixFactor = false;
+}
+
+//==============================================================================
+void Skeleton::updateDynamicsKernel(std::size_t _treeIdx) const
+{
+  DataCache& cache = mTreeCache[_treeIdx];
+  DirtyFlags& dirty = cache.mDirty;
+  bool inertiasStale = dirty.mDynamicsKernelVersion != getVersion();
+  if (dirty.mDynamicsKernelTopology)
+  {
+    cache.mKernel.build(cache.mBodyNodes);
+    dirty.mDynamicsKernelTopology = false;
+    dirty.mDynamicsKernel = true;
+    dirty.mDynamicsKernelVelocities = true;
+    inertiasStale = true;
+  }
+
+  // Every setter of a BodyNode's inertia or gravity mode bumps our version,
+  // so the inertias don't have to be recopied whenever the positions change
+  if (inertiasStale)
+  {
+    cache.mKernel.updateInertias(cache.mBodyNodes);
+    dirty.mDynamicsKernelVersion = getVersion();
+  }
+
+  if (dirty.mDynamicsKernel)
+  {
+    cache.mKernel.updatePositions(cache.mBodyNodes);
+    dirty.mDynamicsKernel = false;
+  }
+}
+
+//==============================================================================
+void Skeleton::updateDynamicsKernelVelocities(std::size_t _treeIdx) const
+{
+  DataCache& cache = mTreeCache[_treeIdx];
+  if (cache.mDirty.mDynamicsKernelVelocities)
+  {
+    cache.mKernel.updateVelocities(cache.mBodyNodes);
+    cache.mDirty.mDynamicsKernelVelocities = false;
+  }
+}
+
+//==============================================================================
+void Skeleton::computeCoriolisAndGravityForces(
+    std::size_t _treeIdx,
+    const Eigen::Vector3s& _gravity,
+    bool _withCoriolis,
+    Eigen::VectorXs& _Cg) const
+{
+  DynamicsKernel& kernel = mTreeCache[_treeIdx].mKernel;
+  const std::size_t numBodies = kernel.getNumBodies();
+  common::aligned_vector<Eigen::Vector6s>& dV = kernel.mBiasAccelerations;
+  common::aligned_vector<Eigen::Vector6s>& F = kernel.mBiasForces;
+
+  // Forward recursion for the spatial accelerations with every joint
+  // acceleration at zero
+  for (std::size_t i = 0; i < numBodies; ++i)
+  {
+    F[i].setZero();
+    if (!_withCoriolis)
+      continue;
+
+    const int parent = kernel.mParents[i];
+    dV[i] = kernel.mPartialAccelerations[i];
+    if (parent != -1)
+      dV[i] += math::AdInvT(kernel.mRelativeTransforms[i], dV[parent]);
+  }
+
+  // Backward recursion for the forces that produce those accelerations.
+  // Children always come after their parents in the tree, so each F[i] has
+  // collected all of its children's forces by the time we get to it.
+  for (std::size_t i = numBodies; i-- > 0;)
+  {
+    const Eigen::Matrix6s& I = kernel.mSpatialInertias[i];
+    if (kernel.mGravityModes[i])
+    {
+      Eigen::Vector6s gravity;
+      gravity << Eigen::Vector3s::Zero(),
+          kernel.mWorldRotations[i].transpose() * _gravity;
+      F[i].noalias() -= I * gravity;
+    }
+    if (_withCoriolis)
+    {
+      const Eigen::Vector6s& V = kernel.mSpatialVelocities[i];
+      F[i].noalias() += I * dV[i];
+      F[i] -= math::dad(V, I * V);
+    }
+
+    const int localDof = kernel.mNumJointDofs[i];
+    if (localDof > 0)
+    {
+      const int iStart = kernel.mDofStarts[i];
+      _Cg.segment(iStart, localDof).noalias()
+          = kernel.mRelativeJacobians.middleCols(iStart, localDof).transpose()
+            * F[i];
+    }
+
+    const int parent = kernel.mParents[i];
+    if (parent != -1)
+      F[parent] += math::dAdInvT(kernel.mRelativeTransforms[i], F[i]);
+  }
+}
+
+//==============================================================================
+void Skeleton::solveMassMatrixFactor(
+    std::size_t _treeIdx, Eigen::MatrixXs& _X) const
+{
+  const Eigen::MatrixXs& H = getMassMatrixFactor(_treeIdx);
+  const std::vector<int>& parents = mTreeCache[_treeIdx].mKernel.mDofParents;
+  const int dof = static_cast<int>(parents.size());
+  assert(_X.rows() == dof);
+
+  // X <- L^{-T} * X
+  for (int i = dof - 1; i >= 0; --i)
+  {
+    for (int j = parents[i]; j != -1; j = parents[j])
+      _X.row(j) -= H(i, j) * _X.row(i);
+  }
+
+  // X <- D^{-1} * X
+  for (int i = 0; i < dof; ++i)
+    _X.row(i) /= H(i, i);
+
+  // X <- L^{-1} * X
+  for (int i = 0; i < dof; ++i)
+  {
+    for (int j = parents[i]; j != -1; j = parents[j])
+      _X.row(i) -= H(i, j) * _X.row(j);
+  }
+}
+
+//==============================================================================
+void Skeleton::computeMassMatrixByUnitAccelerations(
+    std::size_t _treeIdx, Eigen::MatrixXs& _M) const
+{
+  DataCache& cache = mTreeCache[_treeIdx];
+  std::size_t dof = cache.mDofs.size();
+  _M.setZero(dof, dof);
+  if (dof == 0)
+    return;
 
   // Backup the original internal force
   Eigen::VectorXs originalGenAcceleration = getAccelerations();
@@ -4894,7 +5220,7 @@ void Skeleton::updateMassMatrix(std::size_t _treeIdx) const
          it != cache.mBodyNodes.rend();
          ++it)
     {
-      (*it)->aggregateMassMatrix(cache.mM, j);
+      (*it)->aggregateMassMatrix(_M, j);
       std::size_t localDof = (*it)->mParentJoint->getNumDofs();
       if (localDof > 0)
       {
@@ -4908,12 +5234,10 @@ void Skeleton::updateMassMatrix(std::size_t _treeIdx) const
     // Set the acceleration of this DOF back to 0.0
     cache.mDofs[j]->setAcceleration(0.0);
   }
-  cache.mM.triangularView<Eigen::StrictlyUpper>() = cache.mM.transpose();
+  _M.triangularView<Eigen::StrictlyUpper>() = _M.transpose();
 
   // Restore the original generalized accelerations
   const_cast<Skeleton*>(this)->setAccelerations(originalGenAcceleration);
-
-  cache.mDirty.mMassMatrix = false;
 }
 
 //==============================================================================
@@ -5270,6 +5594,17 @@ void Skeleton::updateCoriolisForces(std::size_t _treeIdx) const
 
   cache.mCvec.setZero();
 
+  updateDynamicsKernel(_treeIdx);
+  if (!cache.mKernel.mHasSoftBodies)
+  {
+    updateDynamicsKernelVelocities(_treeIdx);
+    computeCoriolisAndGravityForces(
+        _treeIdx, Eigen::Vector3s::Zero(), true, cache.mCvec);
+    cache.mDirty.mCoriolisForces = false;
+    return;
+  }
+
+  // Point masses add their own terms, which only the BodyNodes know about
   for (std::vector<BodyNode*>::const_iterator it = cache.mBodyNodes.begin();
        it != cache.mBodyNodes.end();
        ++it)
@@ -5330,6 +5665,16 @@ void Skeleton::updateGravityForces(std::size_t _treeIdx) const
 
   cache.mG.setZero();
 
+  updateDynamicsKernel(_treeIdx);
+  if (!cache.mKernel.mHasSoftBodies)
+  {
+    computeCoriolisAndGravityForces(
+        _treeIdx, mAspectProperties.mGravity, false, cache.mG);
+    cache.mDirty.mGravityForces = false;
+    return;
+  }
+
+  // Point masses add their own terms, which only the BodyNodes know about
   for (std::vector<BodyNode*>::const_reverse_iterator it
        = cache.mBodyNodes.rbegin();
        it != cache.mBodyNodes.rend();
@@ -5383,6 +5728,17 @@ void Skeleton::updateCoriolisAndGravityForces(std::size_t _treeIdx) const
 
   cache.mCg.setZero();
 
+  updateDynamicsKernel(_treeIdx);
+  if (!cache.mKernel.mHasSoftBodies)
+  {
+    updateDynamicsKernelVelocities(_treeIdx);
+    computeCoriolisAndGravityForces(
+        _treeIdx, mAspectProperties.mGravity, true, cache.mCg);
+    cache.mDirty.mCoriolisAndGravityForces = false;
+    return;
+  }
+
+  // Point masses add their own terms, which only the BodyNodes know about
   for (std::vector<BodyNode*>::const_iterator it = cache.mBodyNodes.begin();
        it != cache.mBodyNodes.end();
        ++it)
@@ -5816,6 +6172,8 @@ void Skeleton::notifyArticulatedInertiaUpdate(std::size_t _treeIdx)
 void Skeleton::dirtyArticulatedInertia(std::size_t _treeIdx)
 {
   SET_FLAG(_treeIdx, mArticulatedInertia);
+  SET_FLAG(_treeIdx, mDynamicsKernel);
+  SET_FLAG(_treeIdx, mDynamicsKernelVelocities);
   SET_FLAG(_treeIdx, mMassMatrix);
   SET_FLAG(_treeIdx, mAugMassMatrix);
   SET_FLAG(_treeIdx, mInvMassMatrix);
@@ -5825,6 +6183,14 @@ void Skeleton::dirtyArticulatedInertia(std::size_t _treeIdx)
   SET_FLAG(_treeIdx, mCoriolisAndGravityForces);
 }
 
+//==============================================================================
+void Skeleton::dirtyVelocities(std::size_t _treeIdx)
+{
+  SET_FLAG(_treeIdx, mDynamicsKernelVelocities);
+  SET_FLAG(_treeIdx, mCoriolisForces);
+  SET_FLAG(_treeIdx, mCoriolisAndGravityForces);
+}
+
 //==============================================================================
 void Skeleton::notifySupportUpdate(std::size_t _treeIdx)
 {
@@ -6272,6 +6638,11 @@ math::LinearJacobian Skeleton::getCOMLinearJacobianDeriv(
 Skeleton::DirtyFlags::DirtyFlags()
   : mArticulatedInertia(true),
     mMassMatrix(true),
+    mMassMatrixFactor(true),
+    mDynamicsKernelTopology(true),
+    mDynamicsKernel(true),
+    mDynamicsKernelVelocities(true),
+    mDynamicsKernelVersion(0),
     mAugMassMatrix(true),
     mInvMassMatrix(true),
     mInvAugMassMatrix(true),
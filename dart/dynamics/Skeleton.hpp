@@ -38,6 +38,7 @@
 
 #include "dart/common/NameManager.hpp"
 #include "dart/common/VersionCounter.hpp"
+#include "dart/dynamics/DynamicsKernel.hpp"
 #include "dart/dynamics/EndEffector.hpp"
 #include "dart/dynamics/Joint.hpp"
 #include "dart/dynamics/Marker.hpp"
@@ -674,6 +675,12 @@ public:
   /// @warning SLOW: Only for testing
   Eigen::MatrixXs getJacobianOfFD(neural::WithRespectTo* wrt);
 
+  /// SLOW: Only for testing. This computes the mass matrix with one pass over
+  /// the tree per DOF, setting each acceleration to 1 in turn. This is the
+  /// reference that the Composite Rigid Body Algorithm behind getMassMatrix()
+  /// is checked against.
+  Eigen::MatrixXs getMassMatrixByUnitAccelerations() const;
+
   /// VERY SLOW: Only for testing. This computes the unconstrained Jacobian
   /// giving the difference in M(pos) for finite changes
   Eigen::MatrixXs finiteDifferenceJacobianOfM(
@@ -1143,6 +1150,34 @@ public:
   // Documentation inherited
   const Eigen::MatrixXs& getInvMassMatrix() const override;
 
+  /// Get the factorization M = L^T * D * L of a tree's mass matrix, where L is
+  /// unit lower triangular and only nonzero where the column's DOF is an
+  /// ancestor of the row's DOF. This is packed into one matrix, with D on the
+  /// diagonal and L below it. The upper triangle is left over from M. This is
+  /// cached until the mass matrix changes.
+  const Eigen::MatrixXs& getMassMatrixFactor(std::size_t _treeIdx) const;
+
+  /// Get the structure-of-arrays copy of a tree's state that the mass matrix,
+  /// its factorization and the Coriolis and gravity forces sweep over. This is
+  /// rebuilt when the tree changes shape, and otherwise only the stale parts
+  /// are refreshed. Forward dynamics and getJacobianOfC() don't use it, see
+  /// DynamicsKernel.
+  const DynamicsKernel& getDynamicsKernel(std::size_t _treeIdx) const;
+
+  /// Returns M^{-1} * B using the cached factorization of M. On a tree of
+  /// depth d this costs O(n*d) per column of B, rather than forming M^{-1}.
+  Eigen::MatrixXs solveMassMatrix(const Eigen::MatrixXs& _B) const;
+
+  /// Returns B * M^{-1} using the cached factorization of M
+  Eigen::MatrixXs solveMassMatrixTranspose(const Eigen::MatrixXs& _B) const;
+
+  /// Returns a block of M^{-1}, without forming the columns outside of it
+  Eigen::MatrixXs getInvMassMatrixBlock(
+      std::size_t _rowStart,
+      std::size_t _colStart,
+      std::size_t _rows,
+      std::size_t _cols) const;
+
   /// Get the inverse augmented mass matrix of a tree
   const Eigen::MatrixXs& getInvAugMassMatrix(std::size_t _treeIdx) const;
 
@@ -1208,6 +1243,10 @@ public:
   /// needs to be updated
   void dirtyArticulatedInertia(std::size_t _treeIdx);
 
+  /// Notify that the joint velocities of a tree changed, so the velocities in
+  /// its dynamics kernel and the Coriolis forces need to be updated
+  void dirtyVelocities(std::size_t _treeIdx);
+
   /// Notify that the support polygon of a tree needs to be updated
   DART_DEPRECATED(6.2)
   void notifySupportUpdate(std::size_t _treeIdx);
@@ -1411,9 +1450,38 @@ protected:
   /// Update the articulated inertias of the skeleton
   void updateArticulatedInertia() const;
 
-  /// Update the mass matrix of a tree
+  /// Update the mass matrix of a tree, using the Composite Rigid Body
+  /// Algorithm
   void updateMassMatrix(std::size_t _treeIdx) const;
 
+  /// Factor the mass matrix of a tree, for getMassMatrixFactor()
+  void updateMassMatrixFactor(std::size_t _treeIdx) const;
+
+  /// Rebuild the DynamicsKernel of a tree if its shape changed, and refresh
+  /// its inertias and positions if they're stale
+  void updateDynamicsKernel(std::size_t _treeIdx) const;
+
+  /// Refresh the velocities in the DynamicsKernel of a tree if they're stale.
+  /// The rest of the kernel must be up to date.
+  void updateDynamicsKernelVelocities(std::size_t _treeIdx) const;
+
+  /// Sweep the DynamicsKernel of a tree for the generalized forces needed to
+  /// hold every joint acceleration at zero against _gravity, and against the
+  /// Coriolis forces if _withCoriolis is true. The kernel must be up to date.
+  void computeCoriolisAndGravityForces(
+      std::size_t _treeIdx,
+      const Eigen::Vector3s& _gravity,
+      bool _withCoriolis,
+      Eigen::VectorXs& _Cg) const;
+
+  /// Replace _X, given in the tree's DOF order, with M^{-1} * _X
+  void solveMassMatrixFactor(std::size_t _treeIdx, Eigen::MatrixXs& _X) const;
+
+  /// Compute the mass matrix of a tree into _M with one inverse dynamics pass
+  /// per DOF. This handles soft bodies, which updateMassMatrix() defers to it.
+  void computeMassMatrixByUnitAccelerations(
+      std::size_t _treeIdx, Eigen::MatrixXs& _M) const;
+
   /// Update mass matrix of the skeleton.
   void updateMassMatrix() const;
 
@@ -1505,6 +1573,22 @@ protected:
     /// Dirty flag for the mass matrix.
     bool mMassMatrix;
 
+    /// Dirty flag for the factorization of the mass matrix.
+    bool mMassMatrixFactor;
+
+    /// Dirty flag for the topology of the dynamics kernel.
+    bool mDynamicsKernelTopology;
+
+    /// Dirty flag for the positions in the dynamics kernel.
+    bool mDynamicsKernel;
+
+    /// Dirty flag for the velocities in the dynamics kernel.
+    bool mDynamicsKernelVelocities;
+
+    /// The Skeleton version the inertias in the dynamics kernel were copied
+    /// at
+    std::size_t mDynamicsKernelVersion;
+
     /// Dirty flag for the mass matrix.
     bool mAugMassMatrix;
 
@@ -1559,6 +1643,12 @@ protected:
     /// Mass matrix cache
     Eigen::MatrixXs mM;
 
+    /// L^T * D * L factorization of mM, see getMassMatrixFactor()
+    Eigen::MatrixXs mMassMatrixFactor;
+
+    /// Structure-of-arrays copy of the tree's state, see getDynamicsKernel()
+    DynamicsKernel mKernel;
+
     /// Mass matrix for the skeleton.
     Eigen::MatrixXs mAugM;
 
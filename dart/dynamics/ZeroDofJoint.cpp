@@ -918,20 +918,24 @@ void ZeroDofJoint::updateConstrainedTerms(s_t /*_timeStep*/)
 
 //==============================================================================
 void ZeroDofJoint::addChildBiasForceForInvMassMatrix(
-    Eigen::Vector6s& /*_parentBiasForce*/,
+    Eigen::Vector6s& _parentBiasForce,
     const Eigen::Matrix6s& /*_childArtInertia*/,
-    const Eigen::Vector6s& /*_childBiasForce*/)
+    const Eigen::Vector6s& _childBiasForce)
 {
-  // TODO(JS)
+  // Add child body's bias force to parent body's bias force. Note that mT
+  // should be updated.
+  _parentBiasForce += math::dAdInvT(getRelativeTransform(), _childBiasForce);
 }
 
 //==============================================================================
 void ZeroDofJoint::addChildBiasForceForInvAugMassMatrix(
-    Eigen::Vector6s& /*_parentBiasForce*/,
+    Eigen::Vector6s& _parentBiasForce,
     const Eigen::Matrix6s& /*_childArtInertia*/,
-    const Eigen::Vector6s& /*_childBiasForce*/)
+    const Eigen::Vector6s& _childBiasForce)
 {
-  // TODO(JS)
+  // Add child body's bias force to parent body's bias force. Note that mT
+  // should be updated.
+  _parentBiasForce += math::dAdInvT(getRelativeTransform(), _childBiasForce);
 }
 
 //==============================================================================
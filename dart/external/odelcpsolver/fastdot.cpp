@@ -26,29 +26,22 @@
 
 
 dReal _dDot (const dReal *a, const dReal *b, int n)
-{  
-  dReal p0,q0,m0,p1,q1,m1,sum;
-  sum = 0;
-  n -= 2;
-  while (n >= 0) {
-    p0 = a[0]; q0 = b[0];
-    m0 = p0 * q0;
-    p1 = a[1]; q1 = b[1];
-    m1 = p1 * q1;
-    sum += m0;
-    sum += m1;
-    a += 2;
-    b += 2;
-    n -= 2;
+{
+  // four independent partial sums, so the multiply-adds of consecutive
+  // elements do not serialize on a single accumulator and the compiler is
+  // free to map the main loop onto SIMD lanes.
+  dReal s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+  for ( ; i+4 <= n; i += 4) {
+    s0 += a[i] * b[i];
+    s1 += a[i+1] * b[i+1];
+    s2 += a[i+2] * b[i+2];
+    s3 += a[i+3] * b[i+3];
   }
-  n += 2;
-  while (n > 0) {
-    sum += (*a) * (*b);
-    a++;
-    b++;
-    n--;
+  for ( ; i < n; ++i) {
+    s0 += a[i] * b[i];
   }
-  return sum;
+  return (s0 + s1) + (s2 + s3);
 }
 
 
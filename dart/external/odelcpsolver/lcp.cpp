@@ -774,11 +774,38 @@ void dLCP::unpermute()
 #endif // dLCP_FAST
 
 
+//***************************************************************************
+// scratch memory for the driver routine below
+
+void dLCPWorkspace::reserve (int n)
+{
+  if (n <= capacity) return;
+
+  const int nskip = dPAD(n);
+  L.resize (n*nskip);
+  d.resize (n);
+  w.resize (n);
+  delta_w.resize (n);
+  delta_x.resize (n);
+  Dell.resize (n);
+  ell.resize (n);
+#ifdef ROWPTRS
+  Arows.resize (n);
+#endif
+  p.resize (n);
+  C.resize (n);
+  state.reset (new bool[n]);
+  tmpbuf.resize (dEstimateLDLTRemoveTmpbufSize (n,nskip));
+  capacity = n;
+}
+
+
 //***************************************************************************
 // an optimized Dantzig LCP driver routine for the lo-hi LCP problem.
 
 bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
-                dReal *outer_w/*=nullptr*/, int nub, dReal *lo, dReal *hi, int *findex, bool earlyTermination)
+                dReal *outer_w/*=nullptr*/, int nub, dReal *lo, dReal *hi, int *findex, bool earlyTermination,
+                dLCPWorkspace *workspace/*=nullptr*/)
 {
   dAASSERT (n>0 && A && x && b && lo && hi && nub >= 0 && nub <= n);
 # ifndef dNODEBUG
@@ -788,11 +815,16 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
   }
 # endif
 
+  // all scratch memory comes from the caller's workspace if there is one,
+  // otherwise from a local workspace that is released on return
+  dLCPWorkspace local_workspace;
+  dLCPWorkspace &ws = workspace ? *workspace : local_workspace;
+  ws.reserve (n);
 
   // if all the variables are unbounded then we can just factor, solve,
   // and return
   if (nub >= n) {
-    dReal *d = new dReal[n];
+    dReal *d = ws.d.data();
     dSetZero (d, n);
 
     int nskip = dPAD(n);
@@ -800,28 +832,28 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
     dSolveLDLT (A, d, b, n, nskip);
     memcpy (x, b, n*sizeof(dReal));
 
-    delete[] d;
     return true;
   }
 
   const int nskip = dPAD(n);
-  dReal *L = new dReal[ (n*nskip)];
-  dReal *d = new dReal[ (n)];
-  dReal *w = outer_w ? outer_w : (new dReal[n]);
-  dReal *delta_w = new dReal[ (n)];
-  dReal *delta_x = new dReal[ (n)];
-  dReal *Dell = new dReal[ (n)];
-  dReal *ell = new dReal[ (n)];
+  dReal *L = ws.L.data();
+  dReal *d = ws.d.data();
+  dReal *w = outer_w ? outer_w : ws.w.data();
+  dReal *delta_w = ws.delta_w.data();
+  dReal *delta_x = ws.delta_x.data();
+  dReal *Dell = ws.Dell.data();
+  dReal *ell = ws.ell.data();
 #ifdef ROWPTRS
-  dReal **Arows = new dReal* [n];
+  dReal **Arows = ws.Arows.data();
 #else
   dReal **Arows = nullptr;
 #endif
-  int *p = new int[n];
-  int *C = new int[n];
+  int *p = ws.p.data();
+  int *C = ws.C.data();
+  void *tmpbuf = ws.tmpbuf.data();
 
   // for i in N, state[i] is 0 if x(i)==lo(i) or 1 if x(i)==hi(i)
-  bool *state = new bool[n];
+  bool *state = ws.state.get();
 
   // create LCP object. note that tmp is set to delta_w to save space, this
   // optimization relies on knowledge of how tmp is used, so be careful!
@@ -1007,22 +1039,6 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
         if (s <= REAL(0.0)) {
 
           if (earlyTermination) {
-            if (!outer_w)
-              delete[] w;
-            delete[] L;
-            delete[] d;
-            delete[] delta_w;
-            delete[] delta_x;
-            delete[] Dell;
-            delete[] ell;
-          #ifdef ROWPTRS
-            delete[] Arows;
-          #endif
-            delete[] p;
-            delete[] C;
-
-            delete[] state;
-
             return false;
           }
 
@@ -1050,7 +1066,6 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
         lcp.pN_plusequals_s_times_qN (w, s, delta_w);
         w[i] += s * delta_w[i];
 
-        // void *tmpbuf;
         // switch indexes between sets if necessary
         switch (cmd) {
         case 1:		// done
@@ -1074,12 +1089,12 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
         case 5:		// keep going
           x[si] = lo[si];
           state[si] = false;
-          lcp.transfer_i_from_C_to_N (si, nullptr);
+          lcp.transfer_i_from_C_to_N (si, tmpbuf);
           break;
         case 6:		// keep going
           x[si] = hi[si];
           state[si] = true;
-          lcp.transfer_i_from_C_to_N (si, nullptr);
+          lcp.transfer_i_from_C_to_N (si, tmpbuf);
           break;
         }
 
@@ -1094,22 +1109,6 @@ bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b,
 
   lcp.unpermute();
 
-  if (!outer_w)
-	  delete[] w;
-  delete[] L;
-  delete[] d;
-  delete[] delta_w;
-  delete[] delta_x;
-  delete[] Dell;
-  delete[] ell;
-#ifdef ROWPTRS
-  delete[] Arows;
-#endif
-  delete[] p;
-  delete[] C;
-
-  delete[] state;
-
   return true;
 }
 
@@ -57,8 +57,37 @@ to be implemented. the first `nub' variables are assumed to have findex < 0.
 #include "dart/external/odelcpsolver/odeconfig.h"
 #include "dart/external/odelcpsolver/common.h"
 
+#include <memory>
+#include <vector>
+
+/*
+scratch memory for dSolveLCP(). the buffers only ever grow, so a caller that
+solves a stream of similarly sized problems (e.g. one contact LCP per
+timestep) can keep a workspace around and avoid all per-solve allocations.
+*/
+
+struct dLCPWorkspace {
+  std::vector<dReal> L;		// n*nskip, L*D*L' factorization of set C
+  std::vector<dReal> d;
+  std::vector<dReal> w;		// only used if the caller passes no outer w
+  std::vector<dReal> delta_w;
+  std::vector<dReal> delta_x;
+  std::vector<dReal> Dell;
+  std::vector<dReal> ell;
+  std::vector<dReal *> Arows;
+  std::vector<int> p;
+  std::vector<int> C;
+  std::unique_ptr<bool[]> state;
+  std::vector<char> tmpbuf;	// for dLDLTRemove()
+  int capacity = 0;
+
+  // make sure every buffer can hold a problem of size n
+  void reserve (int n);
+};
+
 bool dSolveLCP (int n, dReal *A, dReal *x, dReal *b, dReal *w,
-  int nub, dReal *lo, dReal *hi, int *findex, bool earlyTermination = false);
+  int nub, dReal *lo, dReal *hi, int *findex, bool earlyTermination = false,
+  dLCPWorkspace *workspace = nullptr);
 
 size_t dEstimateSolveLCPMemoryReq(int n, bool outer_w_avail);
 
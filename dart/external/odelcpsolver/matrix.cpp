@@ -283,25 +283,49 @@ void _dSolveLDLT (const dReal *L, const dReal *d, dReal *b, int n, int nskip)
 }
 
 
-void _dLDLTAddTL (dReal *L, dReal *d, const dReal *a, int n, int nskip, void *tmpbuf/*[2*nskip]*/)
+// apply the (already known) coefficients of column j of the two rank-1
+// updates to element L(p,j) and to the running W values of row p.
+static inline void dLDLTAddTLApply (dReal &ell, dReal &W1p, dReal &W2p,
+                                   dReal k1, dReal k2, dReal gamma1, dReal gamma2)
+{
+  dReal Wp = W1p - k1 * ell;
+  ell += gamma1 * Wp;
+  W1p = Wp;
+  Wp = W2p - k2 * ell;
+  ell -= gamma2 * Wp;
+  W2p = Wp;
+}
+
+
+// number of rows of L that are swept together by _dLDLTAddTL()
+#define dLDLT_ADDTL_BLOCK 4
+
+void _dLDLTAddTL (dReal *L, dReal *d, const dReal *a, int n, int nskip, void *tmpbuf/*[4*nskip]*/)
 {
   dAASSERT (L && d && a && n > 0 && nskip >= n);
 
   if (n < 2) return;
-  dReal *W1 = tmpbuf ? (dReal *)tmpbuf : (dReal*) ALLOCA ((2*nskip)*sizeof(dReal));
-  dReal *W2 = W1 + nskip;
 
-  W1[0] = REAL(0.0);
-  W2[0] = REAL(0.0);
-  for (int j=1; j<n; ++j) {
-    W1[j] = W2[j] = (dReal) (a[j] * M_SQRT1_2);
-  }
+  // the textbook formulation walks L one column at a time, which strides
+  // through memory by nskip on every element. here L is swept row-wise
+  // instead: the coefficients (k1,k2,gamma1,gamma2) of column j only depend
+  // on rows < j, so they are stored as soon as row j is finished and later
+  // rows stream through their contiguous prefix. rows are processed in
+  // blocks of dLDLT_ADDTL_BLOCK so each coefficient load is reused for
+  // several independent rows.
+  dReal *K1 = tmpbuf ? (dReal *)tmpbuf : (dReal*) ALLOCA ((4*nskip)*sizeof(dReal));
+  dReal *K2 = K1 + nskip;
+  dReal *G1 = K2 + nskip;
+  dReal *G2 = G1 + nskip;
+
   dReal W11 = (dReal) ((REAL(0.5)*a[0]+1)*M_SQRT1_2);
   dReal W21 = (dReal) ((REAL(0.5)*a[0]-1)*M_SQRT1_2);
 
   dReal alpha1 = REAL(1.0);
   dReal alpha2 = REAL(1.0);
 
+  // column 0 is dropped from the factorization, only its coefficients matter
+  dReal c1, c2;
   {
     dReal dee = d[0];
     dReal alphanew = alpha1 + (W11*W11)*dee;
@@ -314,46 +338,61 @@ void _dLDLTAddTL (dReal *L, dReal *d, const dReal *a, int n, int nskip, void *tm
     dee /= alphanew;
     //dReal gamma2 = W21 * dee;
     alpha2 = alphanew;
-    dReal k1 = REAL(1.0) - W21*gamma1;
-    dReal k2 = W21*gamma1*W11 - W21;
-    dReal *ll = L + nskip;
-    for (int p=1; p<n; ll+=nskip, ++p) {
-      dReal Wp = W1[p];
-      dReal ell = *ll;
-      W1[p] =    Wp - W11*ell;
-      W2[p] = k1*Wp +  k2*ell;
-    }
+    c1 = REAL(1.0) - W21*gamma1;
+    c2 = W21*gamma1*W11 - W21;
   }
 
-  dReal *ll = L + (nskip + 1);
-  for (int j=1; j<n; ll+=nskip+1, ++j) {
-    dReal k1 = W1[j];
-    dReal k2 = W2[j];
+  for (int p0=1; p0<n; p0+=dLDLT_ADDTL_BLOCK) {
+    const int nb = (n-p0 < dLDLT_ADDTL_BLOCK) ? n-p0 : dLDLT_ADDTL_BLOCK;
+    dReal W1[dLDLT_ADDTL_BLOCK], W2[dLDLT_ADDTL_BLOCK];
 
-    dReal dee = d[j];
-    dReal alphanew = alpha1 + (k1*k1)*dee;
-    dIASSERT(alphanew != dReal(0.0));
-    dee /= alphanew;
-    dReal gamma1 = k1 * dee;
-    dee *= alpha1;
-    alpha1 = alphanew;
-    alphanew = alpha2 - (k2*k2)*dee;
-    dee /= alphanew;
-    dReal gamma2 = k2 * dee;
-    dee *= alpha2;
-    d[j] = dee;
-    alpha2 = alphanew;
+    for (int q=0; q<nb; ++q) {
+      dReal Wp = (dReal) (a[p0+q] * M_SQRT1_2);
+      dReal ell = L[(p0+q)*nskip];
+      W1[q] =    Wp - W11*ell;
+      W2[q] = c1*Wp +  c2*ell;
+    }
+
+    // columns left of the block have known coefficients, and the rows of
+    // the block are independent of each other
+    for (int j=1; j<p0; ++j) {
+      const dReal k1 = K1[j], k2 = K2[j], gamma1 = G1[j], gamma2 = G2[j];
+      dReal *l = L + p0*nskip + j;
+      for (int q=0; q<nb; l+=nskip, ++q) {
+        dLDLTAddTLApply (*l, W1[q], W2[q], k1, k2, gamma1, gamma2);
+      }
+    }
+
+    // finish the triangle inside the block, producing the coefficients of
+    // each column as soon as its row is done
+    for (int q=0; q<nb; ++q) {
+      const int p = p0+q;
+      dReal *lrow = L + p*nskip;
+      for (int j=p0; j<p; ++j) {
+        dLDLTAddTLApply (lrow[j], W1[q], W2[q], K1[j], K2[j], G1[j], G2[j]);
+      }
 
-    dReal *l = ll + nskip;
-    for (int p=j+1; p<n; l+=nskip, ++p) {
-      dReal ell = *l;
-      dReal Wp = W1[p] - k1 * ell;
-      ell += gamma1 * Wp;
-      W1[p] = Wp;
-      Wp = W2[p] - k2 * ell;
-      ell -= gamma2 * Wp;
-      W2[p] = Wp;
-      *l = ell;
+      dReal k1 = W1[q];
+      dReal k2 = W2[q];
+
+      dReal dee = d[p];
+      dReal alphanew = alpha1 + (k1*k1)*dee;
+      dIASSERT(alphanew != dReal(0.0));
+      dee /= alphanew;
+      dReal gamma1 = k1 * dee;
+      dee *= alpha1;
+      alpha1 = alphanew;
+      alphanew = alpha2 - (k2*k2)*dee;
+      dee /= alphanew;
+      dReal gamma2 = k2 * dee;
+      dee *= alpha2;
+      d[p] = dee;
+      alpha2 = alphanew;
+
+      K1[p] = k1;
+      K2[p] = k2;
+      G1[p] = gamma1;
+      G2[p] = gamma2;
     }
   }
 }
@@ -372,7 +411,7 @@ void _dLDLTAddTL (dReal *L, dReal *d, const dReal *a, int n, int nskip, void *tm
 
 
 void _dLDLTRemove (dReal **A, const int *p, dReal *L, dReal *d,
-    int n1, int n2, int r, int nskip, void *tmpbuf/*n2 + 2*nskip*/)
+    int n1, int n2, int r, int nskip, void *tmpbuf/*n2 + 4*nskip*/)
 {
   dAASSERT(A && p && L && d && n1 > 0 && n2 > 0 && r >= 0 && r < n2 &&
 	   n1 >= n2 && nskip >= n1);
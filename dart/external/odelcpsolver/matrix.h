@@ -233,7 +233,7 @@ PURE_INLINE size_t _dEstimateIsPositiveDefiniteTmpbufSize(int n)
 
 PURE_INLINE size_t _dEstimateLDLTAddTLTmpbufSize(int nskip)
 {
-  return nskip * 2 * sizeof(dReal);
+  return nskip * 4 * sizeof(dReal);
 }
 
 PURE_INLINE size_t _dEstimateLDLTRemoveTmpbufSize(int n2, int nskip)
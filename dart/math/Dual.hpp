@@ -0,0 +1,680 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_MATH_DUAL_HPP_
+#define DART_MATH_DUAL_HPP_
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include <Eigen/Core>
+
+namespace dart {
+namespace math {
+
+/// A forward-mode dual number, carrying a value and its derivative along N
+/// independent directions at once. Arithmetic on Dual<N> applies the chain rule
+/// to all N tangents, so running a computation on duals seeded with N
+/// directions gives the result plus N Jacobian-vector products.
+///
+/// Building with DART_USE_DUAL_NUMBERS makes this the s_t scalar type. The
+/// math and dynamics layers work on it, so Skeleton kinematics, mass matrices
+/// and forward dynamics on dual positions and velocities come out with their
+/// tangents. The collision, constraint and simulation modules haven't been
+/// ported to it yet, so World::step() doesn't propagate tangents.
+///
+/// The tangents are a fixed-size Eigen array, so they're updated with SIMD
+/// instructions. They're stored unaligned, so that s_t can still live in
+/// std::vector and in structs without aligned allocators.
+template <int N>
+class Dual
+{
+public:
+  typedef Eigen::Array<double, N, 1, Eigen::DontAlign> Tangent;
+
+  /// A constant, with all-zero tangents
+  Dual() : mValue(0.0), mTangent(Tangent::Zero())
+  {
+    // Do nothing
+  }
+
+  /// A constant, with all-zero tangents. This is implicit so that literals and
+  /// doubles mix freely with s_t, the way they do for double and mpreal.
+  Dual(double value) : mValue(value), mTangent(Tangent::Zero())
+  {
+    // Do nothing
+  }
+
+  Dual(double value, const Tangent& tangent) : mValue(value), mTangent(tangent)
+  {
+    // Do nothing
+  }
+
+  /// Returns a variable with a unit tangent in direction `lane`
+  static Dual variable(double value, int lane)
+  {
+    Dual result(value);
+    result.mTangent(lane) = 1.0;
+    return result;
+  }
+
+  double value() const
+  {
+    return mValue;
+  }
+
+  const Tangent& tangent() const
+  {
+    return mTangent;
+  }
+
+  Tangent& tangent()
+  {
+    return mTangent;
+  }
+
+  double tangent(int lane) const
+  {
+    return mTangent(lane);
+  }
+
+  /// This drops the tangents. It's explicit, so derivatives can't get lost by
+  /// accident.
+  template <
+      typename T,
+      typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  explicit operator T() const
+  {
+    return static_cast<T>(mValue);
+  }
+
+  Dual& operator+=(const Dual& other)
+  {
+    mValue += other.mValue;
+    mTangent += other.mTangent;
+    return *this;
+  }
+
+  Dual& operator-=(const Dual& other)
+  {
+    mValue -= other.mValue;
+    mTangent -= other.mTangent;
+    return *this;
+  }
+
+  Dual& operator*=(const Dual& other)
+  {
+    mTangent = mTangent * other.mValue + other.mTangent * mValue;
+    mValue *= other.mValue;
+    return *this;
+  }
+
+  Dual& operator/=(const Dual& other)
+  {
+    const double inv = 1.0 / other.mValue;
+    mValue *= inv;
+    mTangent = (mTangent - other.mTangent * mValue) * inv;
+    return *this;
+  }
+
+  Dual& operator+=(double other)
+  {
+    mValue += other;
+    return *this;
+  }
+
+  Dual& operator-=(double other)
+  {
+    mValue -= other;
+    return *this;
+  }
+
+  Dual& operator*=(double other)
+  {
+    mValue *= other;
+    mTangent *= other;
+    return *this;
+  }
+
+  Dual& operator/=(double other)
+  {
+    const double inv = 1.0 / other;
+    mValue *= inv;
+    mTangent *= inv;
+    return *this;
+  }
+
+protected:
+  double mValue;
+  Tangent mTangent;
+};
+
+//==============================================================================
+// Arithmetic
+//==============================================================================
+
+template <int N>
+inline Dual<N> operator+(const Dual<N>& a)
+{
+  return a;
+}
+
+template <int N>
+inline Dual<N> operator-(const Dual<N>& a)
+{
+  return Dual<N>(-a.value(), -a.tangent());
+}
+
+#define DART_DUAL_BINARY_OPERATOR(op)                                          \
+  template <int N>                                                             \
+  inline Dual<N> operator op(Dual<N> a, const Dual<N>& b)                      \
+  {                                                                            \
+    return a op## = b;                                                         \
+  }                                                                            \
+  template <int N>                                                             \
+  inline Dual<N> operator op(Dual<N> a, double b)                              \
+  {                                                                            \
+    return a op## = b;                                                         \
+  }                                                                            \
+  template <int N>                                                             \
+  inline Dual<N> operator op(double a, const Dual<N>& b)                       \
+  {                                                                            \
+    return Dual<N>(a) op## = b;                                                \
+  }
+
+DART_DUAL_BINARY_OPERATOR(+)
+DART_DUAL_BINARY_OPERATOR(-)
+DART_DUAL_BINARY_OPERATOR(*)
+DART_DUAL_BINARY_OPERATOR(/)
+
+#undef DART_DUAL_BINARY_OPERATOR
+
+//==============================================================================
+// Comparisons only look at the value, so branches in the dynamics pick the
+// same side they would for doubles
+//==============================================================================
+
+#define DART_DUAL_COMPARISON_OPERATOR(op)                                      \
+  template <int N>                                                             \
+  inline bool operator op(const Dual<N>& a, const Dual<N>& b)                  \
+  {                                                                            \
+    return a.value() op b.value();                                             \
+  }                                                                            \
+  template <int N>                                                             \
+  inline bool operator op(const Dual<N>& a, double b)                          \
+  {                                                                            \
+    return a.value() op b;                                                     \
+  }                                                                            \
+  template <int N>                                                             \
+  inline bool operator op(double a, const Dual<N>& b)                          \
+  {                                                                            \
+    return a op b.value();                                                     \
+  }
+
+DART_DUAL_COMPARISON_OPERATOR(==)
+DART_DUAL_COMPARISON_OPERATOR(!=)
+DART_DUAL_COMPARISON_OPERATOR(<)
+DART_DUAL_COMPARISON_OPERATOR(<=)
+DART_DUAL_COMPARISON_OPERATOR(>)
+DART_DUAL_COMPARISON_OPERATOR(>=)
+
+#undef DART_DUAL_COMPARISON_OPERATOR
+
+//==============================================================================
+// Math functions. These are found by argument dependent lookup, the same way
+// the mpreal overloads are for DART_USE_ARBITRARY_PRECISION.
+//==============================================================================
+
+/// This applies the chain rule for a function with value `value` and
+/// derivative `derivative` at a.value()
+template <int N>
+inline Dual<N> applyChainRule(const Dual<N>& a, double value, double derivative)
+{
+  return Dual<N>(value, a.tangent() * derivative);
+}
+
+/// This is applyChainRule() for functions whose derivative blows up at some
+/// input, like sqrt at 0. There, a zero tangent would become 0 * inf = NaN and
+/// poison everything downstream, so constants stay constants, and an infinite
+/// derivative contributes nothing.
+template <int N>
+inline Dual<N> applySingularChainRule(
+    const Dual<N>& a, double value, double derivative)
+{
+  if (!std::isfinite(derivative) || a.tangent().isZero(0))
+    return Dual<N>(value);
+  return Dual<N>(value, a.tangent() * derivative);
+}
+
+template <int N>
+inline Dual<N> sqrt(const Dual<N>& a)
+{
+  const double value = std::sqrt(a.value());
+  return applySingularChainRule(a, value, 0.5 / value);
+}
+
+template <int N>
+inline Dual<N> cbrt(const Dual<N>& a)
+{
+  const double value = std::cbrt(a.value());
+  return applySingularChainRule(a, value, 1.0 / (3.0 * value * value));
+}
+
+template <int N>
+inline Dual<N> sin(const Dual<N>& a)
+{
+  return applyChainRule(a, std::sin(a.value()), std::cos(a.value()));
+}
+
+template <int N>
+inline Dual<N> cos(const Dual<N>& a)
+{
+  return applyChainRule(a, std::cos(a.value()), -std::sin(a.value()));
+}
+
+template <int N>
+inline Dual<N> tan(const Dual<N>& a)
+{
+  const double value = std::tan(a.value());
+  return applyChainRule(a, value, 1.0 + value * value);
+}
+
+template <int N>
+inline Dual<N> asin(const Dual<N>& a)
+{
+  return applySingularChainRule(
+      a,
+      std::asin(a.value()),
+      1.0 / std::sqrt(1.0 - a.value() * a.value()));
+}
+
+template <int N>
+inline Dual<N> acos(const Dual<N>& a)
+{
+  return applySingularChainRule(
+      a,
+      std::acos(a.value()),
+      -1.0 / std::sqrt(1.0 - a.value() * a.value()));
+}
+
+template <int N>
+inline Dual<N> atan(const Dual<N>& a)
+{
+  return applyChainRule(a, std::atan(a.value()), 1.0 / (1.0 + a.value() * a.value()));
+}
+
+template <int N>
+inline Dual<N> atan2(const Dual<N>& y, const Dual<N>& x)
+{
+  const double denom = x.value() * x.value() + y.value() * y.value();
+  return Dual<N>(
+      std::atan2(y.value(), x.value()),
+      (y.tangent() * x.value() - x.tangent() * y.value()) / denom);
+}
+
+template <int N>
+inline Dual<N> atan2(const Dual<N>& y, double x)
+{
+  return atan2(y, Dual<N>(x));
+}
+
+template <int N>
+inline Dual<N> atan2(double y, const Dual<N>& x)
+{
+  return atan2(Dual<N>(y), x);
+}
+
+template <int N>
+inline Dual<N> sinh(const Dual<N>& a)
+{
+  return applyChainRule(a, std::sinh(a.value()), std::cosh(a.value()));
+}
+
+template <int N>
+inline Dual<N> cosh(const Dual<N>& a)
+{
+  return applyChainRule(a, std::cosh(a.value()), std::sinh(a.value()));
+}
+
+template <int N>
+inline Dual<N> tanh(const Dual<N>& a)
+{
+  const double value = std::tanh(a.value());
+  return applyChainRule(a, value, 1.0 - value * value);
+}
+
+template <int N>
+inline Dual<N> exp(const Dual<N>& a)
+{
+  const double value = std::exp(a.value());
+  return applyChainRule(a, value, value);
+}
+
+template <int N>
+inline Dual<N> log(const Dual<N>& a)
+{
+  return applyChainRule(a, std::log(a.value()), 1.0 / a.value());
+}
+
+template <int N>
+inline Dual<N> log10(const Dual<N>& a)
+{
+  return applyChainRule(a, std::log10(a.value()), 1.0 / (a.value() * std::log(10.0)));
+}
+
+template <int N>
+inline Dual<N> pow(const Dual<N>& a, double b)
+{
+  const double value = std::pow(a.value(), b);
+  return applySingularChainRule(a, value, b * std::pow(a.value(), b - 1.0));
+}
+
+template <int N>
+inline Dual<N> pow(double a, const Dual<N>& b)
+{
+  const double value = std::pow(a, b.value());
+  return applyChainRule(b, value, value * std::log(a));
+}
+
+template <int N>
+inline Dual<N> pow(const Dual<N>& a, const Dual<N>& b)
+{
+  if (b.tangent().isZero(0))
+    return pow(a, b.value());
+  return exp(b * log(a));
+}
+
+template <int N>
+inline Dual<N> abs(const Dual<N>& a)
+{
+  return a.value() < 0 ? -a : a;
+}
+
+template <int N>
+inline Dual<N> fabs(const Dual<N>& a)
+{
+  return abs(a);
+}
+
+/// The following are piecewise constant, so their tangents are zero
+
+template <int N>
+inline Dual<N> floor(const Dual<N>& a)
+{
+  return Dual<N>(std::floor(a.value()));
+}
+
+template <int N>
+inline Dual<N> ceil(const Dual<N>& a)
+{
+  return Dual<N>(std::ceil(a.value()));
+}
+
+template <int N>
+inline Dual<N> round(const Dual<N>& a)
+{
+  return Dual<N>(std::round(a.value()));
+}
+
+template <int N>
+inline Dual<N> fmod(const Dual<N>& a, const Dual<N>& b)
+{
+  const double quotient = std::trunc(a.value() / b.value());
+  return a - b * quotient;
+}
+
+template <int N>
+inline Dual<N> fmod(const Dual<N>& a, double b)
+{
+  return fmod(a, Dual<N>(b));
+}
+
+template <int N>
+inline Dual<N> min(const Dual<N>& a, const Dual<N>& b)
+{
+  return b < a ? b : a;
+}
+
+template <int N>
+inline Dual<N> min(const Dual<N>& a, double b)
+{
+  return min(a, Dual<N>(b));
+}
+
+template <int N>
+inline Dual<N> min(double a, const Dual<N>& b)
+{
+  return min(Dual<N>(a), b);
+}
+
+template <int N>
+inline Dual<N> max(const Dual<N>& a, const Dual<N>& b)
+{
+  return a < b ? b : a;
+}
+
+template <int N>
+inline Dual<N> max(const Dual<N>& a, double b)
+{
+  return max(a, Dual<N>(b));
+}
+
+template <int N>
+inline Dual<N> max(double a, const Dual<N>& b)
+{
+  return max(Dual<N>(a), b);
+}
+
+template <int N>
+inline bool isnan(const Dual<N>& a)
+{
+  return std::isnan(a.value());
+}
+
+template <int N>
+inline bool isinf(const Dual<N>& a)
+{
+  return std::isinf(a.value());
+}
+
+template <int N>
+inline bool isfinite(const Dual<N>& a)
+{
+  return std::isfinite(a.value());
+}
+
+/// This prints just the value, so logs read the same as they do for doubles
+template <int N>
+inline std::ostream& operator<<(std::ostream& stream, const Dual<N>& a)
+{
+  return stream << a.value();
+}
+
+//==============================================================================
+// Seeding and reading back vectors of duals
+//==============================================================================
+
+/// Returns a vector of duals with values `values` and tangents along the
+/// columns of `directions`
+template <int N>
+Eigen::Matrix<Dual<N>, Eigen::Dynamic, 1> seedDuals(
+    const Eigen::VectorXd& values,
+    const Eigen::Matrix<double, Eigen::Dynamic, N>& directions)
+{
+  assert(values.size() == directions.rows());
+  Eigen::Matrix<Dual<N>, Eigen::Dynamic, 1> result(values.size());
+  for (int i = 0; i < values.size(); i++)
+  {
+    result(i) = Dual<N>(values(i), directions.row(i).transpose().array());
+  }
+  return result;
+}
+
+/// Returns the values of a vector of duals, dropping the tangents
+template <int N>
+Eigen::VectorXd dualValues(const Eigen::Matrix<Dual<N>, Eigen::Dynamic, 1>& v)
+{
+  Eigen::VectorXd result(v.size());
+  for (int i = 0; i < v.size(); i++)
+  {
+    result(i) = v(i).value();
+  }
+  return result;
+}
+
+/// Returns the tangents of a vector of duals. Column k is the derivative of `v`
+/// along the k'th seeded direction.
+template <int N>
+Eigen::Matrix<double, Eigen::Dynamic, N> dualTangents(
+    const Eigen::Matrix<Dual<N>, Eigen::Dynamic, 1>& v)
+{
+  Eigen::Matrix<double, Eigen::Dynamic, N> result(v.size(), N);
+  for (int i = 0; i < v.size(); i++)
+  {
+    result.row(i) = v(i).tangent().matrix().transpose();
+  }
+  return result;
+}
+
+} // namespace math
+} // namespace dart
+
+namespace std {
+
+template <int N>
+class numeric_limits<dart::math::Dual<N>> : public numeric_limits<double>
+{
+public:
+  typedef dart::math::Dual<N> T;
+
+  static T min()
+  {
+    return numeric_limits<double>::min();
+  }
+  static T max()
+  {
+    return numeric_limits<double>::max();
+  }
+  static T lowest()
+  {
+    return numeric_limits<double>::lowest();
+  }
+  static T epsilon()
+  {
+    return numeric_limits<double>::epsilon();
+  }
+  static T round_error()
+  {
+    return numeric_limits<double>::round_error();
+  }
+  static T infinity()
+  {
+    return numeric_limits<double>::infinity();
+  }
+  static T quiet_NaN()
+  {
+    return numeric_limits<double>::quiet_NaN();
+  }
+  static T signaling_NaN()
+  {
+    return numeric_limits<double>::signaling_NaN();
+  }
+  static T denorm_min()
+  {
+    return numeric_limits<double>::denorm_min();
+  }
+};
+
+} // namespace std
+
+namespace Eigen {
+
+template <int N>
+struct NumTraits<dart::math::Dual<N>>
+  : GenericNumTraits<dart::math::Dual<N>>
+{
+  typedef dart::math::Dual<N> Real;
+  typedef dart::math::Dual<N> NonInteger;
+  typedef dart::math::Dual<N> Nested;
+  typedef double Literal;
+
+  enum
+  {
+    IsComplex = 0,
+    IsInteger = 0,
+    IsSigned = 1,
+    RequireInitialization = 1,
+    ReadCost = 1 + N,
+    AddCost = 1 + N,
+    MulCost = 1 + 2 * N
+  };
+
+  static inline Real epsilon()
+  {
+    return NumTraits<double>::epsilon();
+  }
+  static inline Real dummy_precision()
+  {
+    return NumTraits<double>::dummy_precision();
+  }
+  static inline Real highest()
+  {
+    return NumTraits<double>::highest();
+  }
+  static inline Real lowest()
+  {
+    return NumTraits<double>::lowest();
+  }
+  static inline int digits10()
+  {
+    return NumTraits<double>::digits10();
+  }
+};
+
+/// Let Eigen mix dual and double operands, e.g. scaling a MatrixXs by a double
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<dart::math::Dual<N>, double, BinaryOp>
+{
+  typedef dart::math::Dual<N> ReturnType;
+};
+
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<double, dart::math::Dual<N>, BinaryOp>
+{
+  typedef dart::math::Dual<N> ReturnType;
+};
+
+} // namespace Eigen
+
+#endif // DART_MATH_DUAL_HPP_
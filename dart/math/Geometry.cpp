@@ -728,7 +728,7 @@ Eigen::Vector6s logMap(const Eigen::Isometry3s& _T)
   //    , beta = t*(1 + cos(t)) / (2*sin(t)), gamma = <w, p>*(1 - beta) / t^2
   //--------------------------------------------------------------------------
   s_t theta = acos(
-      max(std::min(0.5 * (_T(0, 0) + _T(1, 1) + _T(2, 2) - 1.0), 1.0), -1.0));
+      max(std::min<s_t>(0.5 * (_T(0, 0) + _T(1, 1) + _T(2, 2) - 1.0), 1.0), -1.0));
   s_t beta;
   s_t gamma;
   Eigen::Vector6s ret;
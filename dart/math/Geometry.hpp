@@ -588,7 +588,7 @@ bool verifyTransform(const Eigen::Isometry3s& _T);
 
 /// Compute the angle (in the range of -pi to +pi) which ignores any full
 /// rotations
-#ifdef DART_USE_ARBITRARY_PRECISION
+#if defined(DART_USE_ARBITRARY_PRECISION) || defined(DART_USE_DUAL_NUMBERS)
 inline s_t wrapToPi(s_t angle)
 {
   s_t pi = constantsd::pi();
@@ -141,7 +141,7 @@ inline s_t acotanh(s_t _X)
   return log((_X + 1) / (_X - 1)) / 2;
 }
 
-#ifndef DART_USE_ARBITRARY_PRECISION
+#if !defined(DART_USE_ARBITRARY_PRECISION) && !defined(DART_USE_DUAL_NUMBERS)
 inline s_t round(s_t _x)
 {
   return floor(_x + 0.5);
@@ -191,7 +191,7 @@ inline bool isNan(s_t _v)
 #ifdef _WIN32
   return _isnan(_v) != 0;
 #else
-#ifdef DART_USE_ARBITRARY_PRECISION
+#if defined(DART_USE_ARBITRARY_PRECISION) || defined(DART_USE_DUAL_NUMBERS)
   return isnan(_v);
 #else
   return std::isnan(_v);
@@ -217,7 +217,7 @@ inline bool isInf(s_t _v)
 #ifdef _WIN32
   return !_finite(_v);
 #else
-#ifdef DART_USE_ARBITRARY_PRECISION
+#if defined(DART_USE_ARBITRARY_PRECISION) || defined(DART_USE_DUAL_NUMBERS)
   return isinf(_v);
 #else
   return std::isinf(_v);
@@ -344,9 +344,10 @@ namespace suffixes {
 
 #ifndef DART_USE_ARBITRARY_PRECISION
 //==============================================================================
-constexpr s_t operator"" _pi(long double x)
+// Plain doubles, so these stay constexpr in the dual number build too
+constexpr double operator"" _pi(long double x)
 {
-  return x * constants<s_t>::pi();
+  return x * constants<double>::pi();
 }
 
 //==============================================================================
@@ -368,9 +369,9 @@ constexpr double operator"" _rad(unsigned long long int angle)
 }
 
 //==============================================================================
-constexpr s_t operator"" _deg(long double angle)
+constexpr double operator"" _deg(long double angle)
 {
-  return toRadian(angle);
+  return angle * constants<double>::pi() / 180.0;
 }
 
 //==============================================================================
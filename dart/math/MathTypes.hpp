@@ -41,13 +41,19 @@
 #include "dart/common/Deprecated.hpp"
 #include "dart/common/Memory.hpp"
 
-// You can turn on DART_USE_ARBITRARY_PRECISION as a variable in the root
-// CMakeLists.txt file.
+// You can turn on DART_USE_ARBITRARY_PRECISION or DART_USE_DUAL_NUMBERS as a
+// variable in the root CMakeLists.txt file.
 
 #ifdef DART_USE_ARBITRARY_PRECISION
 #include <unsupported/Eigen/MPRealSupport>
 #include "mpreal.h"
 typedef mpfr::mpreal s_t;
+#elif defined(DART_USE_DUAL_NUMBERS)
+#include "dart/math/Dual.hpp"
+#ifndef DART_DUAL_NUMBER_LANES
+#define DART_DUAL_NUMBER_LANES 4
+#endif
+typedef dart::math::Dual<DART_DUAL_NUMBER_LANES> s_t;
 #else
 typedef double s_t;
 using std::abs;
@@ -10,6 +10,7 @@
 #include "dart/math/Geometry.hpp"
 #include "dart/neural/ConstrainedGroupGradientMatrices.hpp"
 #include "dart/neural/DifferentiableContactConstraint.hpp"
+#include "dart/neural/ParallelFiniteDifference.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/neural/WithRespectToMass.hpp"
 #include "dart/simulation/World.hpp"
@@ -104,6 +105,7 @@ BackpropSnapshot::BackpropSnapshot(
   mCachedMassVelDirty = true;
   mCachedVelCDirty = true;
   mCachedPosCDirty = true;
+  mJacobiansPrecomputed = false;
 
   /*
   if (!areResultsStandardized())
@@ -132,6 +134,20 @@ void BackpropSnapshot::backprop(
   }
 #endif
 
+  // If we cached everything we need during the forward pass, there's no need
+  // to reset the World
+  if (mJacobiansPrecomputed && !exploreAlternateStrategies)
+  {
+    backpropCached(thisTimestepLoss, nextTimestepLoss);
+#ifdef LOG_PERFORMANCE_BACKPROP_SNAPSHOT
+    if (thisLog != nullptr)
+    {
+      thisLog->end();
+    }
+#endif
+    return;
+  }
+
   LossGradient groupThisTimestepLoss;
   LossGradient groupNextTimestepLoss;
 
@@ -291,12 +307,11 @@ void BackpropSnapshot::backprop(
       // Explicitly form the matrices
       /////////////////////////////////////////////////////////////////
 
-      Eigen::MatrixXs Minv = skel->getInvMassMatrix();
+      // M is symmetric, so we only need one solve against the factored mass
+      // matrix to push the velocity loss back through M^{-1}
+      Eigen::VectorXs MinvLossVel = skel->solveMassMatrix(
+          nextTimestepLoss.lossWrtVelocity.segment(dofCursorWorld, dofs));
 
-      Eigen::MatrixXs forceVel = mTimeStep * Minv;
-      Eigen::MatrixXs velVel
-          = Eigen::MatrixXs::Identity(skel->getNumDofs(), skel->getNumDofs())
-            - mTimeStep * Minv * skel->getVelCJacobian();
       Eigen::MatrixXs posVel = skel->getUnconstrainedVelJacobianWrt(
           world->getTimeStep(), WithRespectTo::POSITION);
       Eigen::MatrixXs posPos
@@ -305,12 +320,13 @@ void BackpropSnapshot::backprop(
           = mTimeStep
             * Eigen::MatrixXs::Identity(skel->getNumDofs(), skel->getNumDofs());
 
+      // forceVel = dt * Minv
       thisTimestepLoss.lossWrtTorque.segment(dofCursorWorld, dofs)
-          = forceVel.transpose()
-            * nextTimestepLoss.lossWrtVelocity.segment(dofCursorWorld, dofs);
+          = mTimeStep * MinvLossVel;
+      // velVel = I - dt * Minv * dC/dvel
       thisTimestepLoss.lossWrtVelocity.segment(dofCursorWorld, dofs)
-          = velVel.transpose()
-                * nextTimestepLoss.lossWrtVelocity.segment(dofCursorWorld, dofs)
+          = nextTimestepLoss.lossWrtVelocity.segment(dofCursorWorld, dofs)
+            - mTimeStep * skel->getVelCJacobian().transpose() * MinvLossVel
             + velPos.transpose()
                   * nextTimestepLoss.lossWrtPosition.segment(
                       dofCursorWorld, dofs);
@@ -375,6 +391,81 @@ void BackpropSnapshot::backprop(
 #endif
 }
 
+//==============================================================================
+void BackpropSnapshot::precomputeJacobians(
+    WorldPtr world, PerformanceLog* perfLog)
+{
+  if (mJacobiansPrecomputed)
+    return;
+
+  PerformanceLog* thisLog = nullptr;
+#ifdef LOG_PERFORMANCE_BACKPROP_SNAPSHOT
+  if (perfLog != nullptr)
+  {
+    thisLog = perfLog->startRun("BackpropSnapshot.precomputeJacobians");
+  }
+#endif
+
+  RestorableSnapshot snapshot(world);
+  world->setPositions(mPreStepPosition);
+  world->setVelocities(mPreStepVelocity);
+  world->setControlForces(mPreStepTorques);
+  world->setCachedLCPSolution(mPreStepLCPCache);
+
+  getPosPosJacobian(world, thisLog);
+  getPosVelJacobian(world, thisLog);
+  getVelPosJacobian(world, thisLog);
+  getVelVelJacobian(world, thisLog);
+  getControlForceVelJacobian(world, thisLog);
+  getMassVelJacobian(world, thisLog);
+
+  mPositionLowerLimits = world->getPositionLowerLimits();
+  mPositionUpperLimits = world->getPositionUpperLimits();
+  mVelocityLowerLimits = world->getVelocityLowerLimits();
+  mVelocityUpperLimits = world->getVelocityUpperLimits();
+  mControlForceLowerLimits = world->getControlForceLowerLimits();
+  mControlForceUpperLimits = world->getControlForceUpperLimits();
+
+  snapshot.restore();
+  mJacobiansPrecomputed = true;
+
+#ifdef LOG_PERFORMANCE_BACKPROP_SNAPSHOT
+  if (thisLog != nullptr)
+  {
+    thisLog->end();
+  }
+#endif
+}
+
+//==============================================================================
+bool BackpropSnapshot::hasPrecomputedJacobians() const
+{
+  return mJacobiansPrecomputed;
+}
+
+//==============================================================================
+void BackpropSnapshot::backpropCached(
+    LossGradient& thisTimestepLoss, const LossGradient& nextTimestepLoss) const
+{
+  assert(mJacobiansPrecomputed);
+
+  thisTimestepLoss.lossWrtPosition
+      = mCachedPosPos.transpose() * nextTimestepLoss.lossWrtPosition
+        + mCachedPosVel.transpose() * nextTimestepLoss.lossWrtVelocity;
+  thisTimestepLoss.lossWrtVelocity
+      = mCachedVelPos.transpose() * nextTimestepLoss.lossWrtPosition
+        + mCachedVelVel.transpose() * nextTimestepLoss.lossWrtVelocity;
+  thisTimestepLoss.lossWrtTorque
+      = mCachedForceVel.transpose() * nextTimestepLoss.lossWrtVelocity;
+  thisTimestepLoss.lossWrtMass
+      = mCachedMassVel.transpose() * nextTimestepLoss.lossWrtVelocity;
+
+  clipLossGradientsToCachedBounds(
+      thisTimestepLoss.lossWrtPosition,
+      thisTimestepLoss.lossWrtVelocity,
+      thisTimestepLoss.lossWrtTorque);
+}
+
 //==============================================================================
 /// This computes backprop in the high-level RL API's space, use `state` and
 /// `action` as the primitives we're taking gradients wrt to.
@@ -477,14 +568,54 @@ void BackpropSnapshot::clipLossGradientsToBounds(
   }
 }
 
+//==============================================================================
+void BackpropSnapshot::clipLossGradientsToCachedBounds(
+    Eigen::VectorXs& lossWrtPos,
+    Eigen::VectorXs& lossWrtVel,
+    Eigen::VectorXs& lossWrtForce) const
+{
+  for (std::size_t i = 0; i < mNumDOFs; i++)
+  {
+    if ((mPreStepPosition(i) == mPositionLowerLimits(i)) && (lossWrtPos(i) > 0))
+    {
+      lossWrtPos(i) = 0;
+    }
+    if ((mPreStepPosition(i) == mPositionUpperLimits(i)) && (lossWrtPos(i) < 0))
+    {
+      lossWrtPos(i) = 0;
+    }
+
+    if ((mPreStepVelocity(i) == mVelocityLowerLimits(i)) && (lossWrtVel(i) > 0))
+    {
+      lossWrtVel(i) = 0;
+    }
+    if ((mPreStepVelocity(i) == mVelocityUpperLimits(i)) && (lossWrtVel(i) < 0))
+    {
+      lossWrtVel(i) = 0;
+    }
+
+    if ((mPreStepTorques(i) == mControlForceLowerLimits(i))
+        && (lossWrtForce(i) > 0))
+    {
+      lossWrtForce(i) = 0;
+    }
+    if ((mPreStepTorques(i) == mControlForceUpperLimits(i))
+        && (lossWrtForce(i) < 0))
+    {
+      lossWrtForce(i) = 0;
+    }
+  }
+}
+
 //==============================================================================
 const Eigen::MatrixXs& BackpropSnapshot::getControlForceVelJacobian(
     WorldPtr world, PerformanceLog* perfLog)
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedForceVelDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -507,19 +638,19 @@ const Eigen::MatrixXs& BackpropSnapshot::getControlForceVelJacobian(
 #endif
     if (mUseFDOverride)
     {
-      mCachedForceVel = finiteDifferenceForceVelJacobian(world);
+      mCachedForceVel = parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::FORCE, false);
     }
     else
     {
       Eigen::MatrixXs A_c = getClampingConstraintMatrix(world);
-      Eigen::MatrixXs Minv = getInvMassMatrix(world);
 
       // If there are no clamping constraints, then force-vel is just the
       // mTimeStep
       // * Minv
       if (A_c.size() == 0)
       {
-        mCachedForceVel = mTimeStep * Minv;
+        mCachedForceVel = mTimeStep * getInvMassMatrix(world);
       }
       else
       {
@@ -581,8 +712,9 @@ const Eigen::MatrixXs& BackpropSnapshot::getMassVelJacobian(
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedMassVelDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -606,7 +738,8 @@ const Eigen::MatrixXs& BackpropSnapshot::getMassVelJacobian(
 
     if (mUseFDOverride)
     {
-      mCachedMassVel = finiteDifferenceMassVelJacobian(world);
+      mCachedMassVel = parallelFiniteDifferenceJacobian(
+          world, world->getWrtMass().get(), false);
     }
     else
     {
@@ -644,8 +777,9 @@ const Eigen::MatrixXs& BackpropSnapshot::getVelVelJacobian(
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedVelVelDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -669,7 +803,8 @@ const Eigen::MatrixXs& BackpropSnapshot::getVelVelJacobian(
 
     if (mUseFDOverride)
     {
-      mCachedVelVel = finiteDifferenceVelVelJacobian(world);
+      mCachedVelVel = parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::VELOCITY, false);
     }
     else
     {
@@ -756,8 +891,9 @@ const Eigen::MatrixXs& BackpropSnapshot::getPosVelJacobian(
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedPosVelDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -781,7 +917,8 @@ const Eigen::MatrixXs& BackpropSnapshot::getPosVelJacobian(
 
     if (mUseFDOverride)
     {
-      mCachedPosVel = finiteDifferencePosVelJacobian(world);
+      mCachedPosVel = parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::POSITION, false);
     }
     else
     {
@@ -828,14 +965,14 @@ Eigen::VectorXs BackpropSnapshot::getAnalyticalNextV(
   Eigen::MatrixXs E = getUpperBoundMappingMatrix();
   Eigen::MatrixXs A_c_ub_E = A_c + A_ub * E;
 
-  Eigen::MatrixXs Minv = world->getInvMassMatrix();
   Eigen::VectorXs tau = world->getControlForces();
   Eigen::VectorXs C = world->getCoriolisAndGravityAndExternalForces();
   s_t dt = world->getTimeStep();
   Eigen::VectorXs f_c = estimateClampingConstraintImpulses(world, A_c, A_ub, E);
 
-  Eigen::VectorXs preSolveV = mPreStepVelocity + dt * Minv * (tau - C);
-  Eigen::VectorXs f_cDeltaV = Minv * A_c_ub_E * f_c;
+  Eigen::VectorXs preSolveV
+      = mPreStepVelocity + dt * world->solveMassMatrix(tau - C);
+  Eigen::VectorXs f_cDeltaV = world->solveMassMatrix(A_c_ub_E * f_c);
   Eigen::VectorXs postSolveV = preSolveV + f_cDeltaV;
   return postSolveV;
 
@@ -870,12 +1007,11 @@ Eigen::MatrixXs BackpropSnapshot::getScratchAnalytical(
   Eigen::MatrixXs dM
       = getJacobianOfMinv(world, dt * (tau - C) + A_c_ub_E * f_c, wrt);
 
-  Eigen::MatrixXs Minv = world->getInvMassMatrix();
   Eigen::MatrixXs dC = getJacobianOfC(world, wrt);
 
   Eigen::MatrixXs dF_c = getJacobianOfConstraintForce(world, wrt);
 
-  Eigen::MatrixXs Q = A_c.transpose() * Minv * A_c_ub_E;
+  Eigen::MatrixXs Q = A_c.transpose() * world->solveMassMatrix(A_c_ub_E);
 
   Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXs> Qfac
       = Q.completeOrthogonalDecomposition();
@@ -890,7 +1026,7 @@ Eigen::MatrixXs BackpropSnapshot::getScratchAnalytical(
   return dF_c;
   */
 
-  return Minv * (A_c * dF_c - dt * dC);
+  return world->solveMassMatrix(A_c * dF_c - dt * dC);
 }
 
 //==============================================================================
@@ -907,9 +1043,7 @@ Eigen::VectorXs BackpropSnapshot::scratch(simulation::WorldPtr world)
   Eigen::MatrixXs E = getUpperBoundMappingMatrix();
   Eigen::MatrixXs A_c_ub_E = A_c + A_ub * E;
 
-  Eigen::MatrixXs Minv = world->getInvMassMatrix();
-
-  Eigen::MatrixXs Q = A_c.transpose() * Minv * A_c_ub_E;
+  Eigen::MatrixXs Q = A_c.transpose() * world->solveMassMatrix(A_c_ub_E);
 
   Eigen::VectorXs b = Eigen::VectorXs::Zero(A_c.cols());
   // Q = Eigen::MatrixXs::Zero(A_c.cols(), A_c.cols());
@@ -923,7 +1057,8 @@ Eigen::VectorXs BackpropSnapshot::scratch(simulation::WorldPtr world)
   s_t dt = world->getTimeStep();
 
   Eigen::VectorXs nextV
-      = world->getVelocities() + Minv * (dt * (tau - C) + A_c_ub_E * f_c);
+      = world->getVelocities()
+        + world->solveMassMatrix(dt * (tau - C) + A_c_ub_E * f_c);
 
   // return b;
   // return f_c;
@@ -1104,8 +1239,6 @@ Eigen::MatrixXs BackpropSnapshot::getVelJacobianWrt(
   Eigen::MatrixXs dM
       = getJacobianOfMinv(world, dt * (tau - C) + A_c_ub_E * f_c, wrt);
 
-  Eigen::MatrixXs Minv = world->getInvMassMatrix();
-
   Eigen::MatrixXs dF_c = getJacobianOfConstraintForce(world, wrt);
 
   if (wrt == WithRespectTo::FORCE)
@@ -1125,11 +1258,11 @@ Eigen::MatrixXs BackpropSnapshot::getVelJacobianWrt(
               << std::endl;
     */
     // snapshot.restore();
-    return Minv
-           * ((A_c_ub_E * dF_c)
-              + (dt
-                 * Eigen::MatrixXs::Identity(
-                     world->getNumDofs(), world->getNumDofs())));
+    return world->solveMassMatrix(
+        (A_c_ub_E * dF_c)
+        + (dt
+           * Eigen::MatrixXs::Identity(
+               world->getNumDofs(), world->getNumDofs())));
   }
 
   Eigen::MatrixXs dC = getJacobianOfC(world, wrt);
@@ -1138,19 +1271,21 @@ Eigen::MatrixXs BackpropSnapshot::getVelJacobianWrt(
   {
     // snapshot.restore();
     return Eigen::MatrixXs::Identity(world->getNumDofs(), world->getNumDofs())
-           + Minv * (A_c_ub_E * dF_c - dt * dC);
+           + world->solveMassMatrix(A_c_ub_E * dF_c - dt * dC);
   }
   else if (wrt == WithRespectTo::POSITION)
   {
     Eigen::MatrixXs dA_c = getJacobianOfClampingConstraints(world, f_c);
     Eigen::MatrixXs dA_ubE = getJacobianOfUpperBoundConstraints(world, E * f_c);
     // snapshot.restore();
-    return dM + Minv * (A_c_ub_E * dF_c + dA_c + dA_ubE - dt * dC);
+    return dM
+           + world->solveMassMatrix(
+               A_c_ub_E * dF_c + dA_c + dA_ubE - dt * dC);
   }
   else
   {
     // snapshot.restore();
-    return dM + Minv * (A_c_ub_E * dF_c - dt * dC);
+    return dM + world->solveMassMatrix(A_c_ub_E * dF_c - dt * dC);
   }
 
   // std::cout << "dA_c: " << std::endl << dA_c << std::endl;
@@ -1353,8 +1488,9 @@ const Eigen::MatrixXs& BackpropSnapshot::getPosPosJacobian(
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedPosPosDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -1378,7 +1514,8 @@ const Eigen::MatrixXs& BackpropSnapshot::getPosPosJacobian(
 
     if (mUseFDOverride)
     {
-      mCachedPosPos = finiteDifferencePosPosJacobian(world, 1);
+      mCachedPosPos = parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::POSITION, true);
     }
     else
     {
@@ -1428,8 +1565,9 @@ const Eigen::MatrixXs& BackpropSnapshot::getVelPosJacobian(
 {
 #ifndef NDEBUG
   assert(
-      world->getPositions() == mPreStepPosition
-      && world->getVelocities() == mPreStepVelocity);
+      !mCachedVelPosDirty
+      || (world->getPositions() == mPreStepPosition
+          && world->getVelocities() == mPreStepVelocity));
 #endif
 
   PerformanceLog* thisLog = nullptr;
@@ -1453,7 +1591,8 @@ const Eigen::MatrixXs& BackpropSnapshot::getVelPosJacobian(
 
     if (mUseFDOverride)
     {
-      mCachedVelPos = finiteDifferenceVelPosJacobian(world, 1);
+      mCachedVelPos = parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::VELOCITY, true);
     }
     else
     {
@@ -1904,8 +2043,6 @@ void BackpropSnapshot::diagnoseSubJacobianErrors(
     }
   }
 
-  Eigen::MatrixXs Minv = world->getInvMassMatrix();
-
   Eigen::MatrixXs dF_c = getJacobianOfConstraintForce(world, wrt);
   if (f_c.size() > 0)
   {
@@ -4041,6 +4178,57 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceRiddersPosJacobianWrt(
   return J;
 }
 
+//==============================================================================
+/// This computes the Jacobian of the post-step velocity (or position) wrt
+/// `wrt` by finite differences, one column per clone in the world's finite
+/// difference pool.
+Eigen::MatrixXs BackpropSnapshot::parallelFiniteDifferenceJacobian(
+    simulation::WorldPtr world,
+    WithRespectTo* wrt,
+    bool outputPosition,
+    bool useRidders)
+{
+  std::shared_ptr<ParallelFiniteDifference> pool
+      = world->getFiniteDifferencePool();
+  pool->setScheme(
+      useRidders ? ParallelFiniteDifference::RIDDERS
+                 : ParallelFiniteDifference::CENTRAL);
+  pool->setStepSize(useRidders ? 1e-3 : 1e-7);
+
+  // Read the unperturbed input off of a clone, so we don't disturb `world`.
+  // This also gets any lazily built lookups inside `wrt` built before the
+  // workers start sharing it.
+  std::shared_ptr<simulation::World> first = pool->getWorker(0);
+  first->setPositions(mPreStepPosition);
+  first->setVelocities(mPreStepVelocity);
+  first->setControlForces(mPreStepTorques);
+  Eigen::VectorXs original = wrt->get(first.get());
+
+  return pool->jacobian(
+      original,
+      mNumDOFs,
+      [&](int worker,
+          simulation::World* /* world */,
+          const Eigen::VectorXs& input,
+          Eigen::VectorXs& out) {
+        std::shared_ptr<simulation::World> clone = pool->getWorker(worker);
+        clone->setPositions(mPreStepPosition);
+        clone->setVelocities(mPreStepVelocity);
+        clone->setControlForces(mPreStepTorques);
+        clone->setCachedLCPSolution(mPreStepLCPCache);
+        wrt->set(clone.get(), input);
+
+        // Every input is set explicitly above, so this doesn't need to be
+        // idempotent
+        BackpropSnapshotPtr ptr = neural::forwardPass(clone, false);
+        out = outputPosition ? ptr->getPostStepPosition()
+                             : ptr->getPostStepVelocity();
+        return (!areResultsStandardized() || ptr->areResultsStandardized())
+               && ptr->getNumClamping() == getNumClamping()
+               && ptr->getNumUpperBound() == getNumUpperBound();
+      });
+}
+
 /*
 //==============================================================================
 Eigen::MatrixXs BackpropSnapshot::getProjectionIntoClampsMatrix(
@@ -4106,8 +4294,7 @@ Eigen::MatrixXs BackpropSnapshot::getProjectionIntoClampsMatrix(
         = getUpperBoundConstraintMatrixAt(world, world->getPositions());
     Eigen::MatrixXs E
         = getUpperBoundMappingMatrixAt(world, world->getPositions());
-    Eigen::MatrixXs Minv = getInvMassMatrix(world, true);
-    constraintForceToImpliedTorques = Minv * (A_c + (A_ub * E));
+    constraintForceToImpliedTorques = world->solveMassMatrix(A_c + (A_ub * E));
 
     Eigen::MatrixXs forceToVel
         = A_c.eval().transpose() * constraintForceToImpliedTorques;
@@ -4161,17 +4348,7 @@ Eigen::VectorXs BackpropSnapshot::implicitMultiplyByMassMatrix(
 Eigen::VectorXs BackpropSnapshot::implicitMultiplyByInvMassMatrix(
     simulation::WorldPtr world, const Eigen::VectorXs& x)
 {
-  Eigen::VectorXs result = x;
-  std::size_t cursor = 0;
-  for (std::size_t i = 0; i < world->getNumSkeletons(); i++)
-  {
-    SkeletonPtr skel = world->getSkeleton(i);
-    std::size_t dofs = skel->getNumDofs();
-    result.segment(cursor, dofs)
-        = skel->multiplyByImplicitInvMassMatrix(x.segment(cursor, dofs));
-    cursor += dofs;
-  }
-  return result;
+  return world->solveMassMatrix(x);
 }
 
 //==============================================================================
@@ -4328,7 +4505,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceJacobianOfQb(
         = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     Eigen::MatrixXs E = getUpperBoundMappingMatrix();
     Eigen::MatrixXs Q
-        = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+        = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
 
     Eigen::VectorXs bPlus = Q * b;
@@ -4340,7 +4517,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceJacobianOfQb(
     A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
     A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     E = getUpperBoundMappingMatrix();
-    Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+    Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
 
     Eigen::VectorXs bMinus = Q * b;
@@ -4394,7 +4571,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceRiddersJacobianOfQb(
         = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     Eigen::MatrixXs E = getUpperBoundMappingMatrix();
     Eigen::MatrixXs Q
-        = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+        = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
     Eigen::VectorXs QbPlus = Q * b;
     perturbed = original;
@@ -4403,7 +4580,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceRiddersJacobianOfQb(
     A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
     A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     E = getUpperBoundMappingMatrix();
-    Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+    Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
     Eigen::VectorXs QbMinus = Q * b;
 
@@ -4420,7 +4597,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceRiddersJacobianOfQb(
       A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
       A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
       E = getUpperBoundMappingMatrix();
-      Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+      Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
       Q.diagonal() += getConstraintForceMixingDiagonal();
       QbPlus = Q * b;
       perturbed = original;
@@ -4429,7 +4606,7 @@ Eigen::MatrixXs BackpropSnapshot::finiteDifferenceRiddersJacobianOfQb(
       A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
       A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
       E = getUpperBoundMappingMatrix();
-      Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+      Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
       Q.diagonal() += getConstraintForceMixingDiagonal();
       QbMinus = Q * b;
 
@@ -4676,7 +4853,7 @@ BackpropSnapshot::finiteDifferenceJacobianOfLCPConstraintMatrixClampingSubset(
         = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     Eigen::MatrixXs E = getUpperBoundMappingMatrix();
     Eigen::MatrixXs Q
-        = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+        = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
 
     /*
@@ -4693,7 +4870,7 @@ BackpropSnapshot::finiteDifferenceJacobianOfLCPConstraintMatrixClampingSubset(
     A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
     A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     E = getUpperBoundMappingMatrix();
-    Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+    Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
 
     /*
@@ -4755,7 +4932,7 @@ Eigen::MatrixXs BackpropSnapshot::
         = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     Eigen::MatrixXs E = getUpperBoundMappingMatrix();
     Eigen::MatrixXs Q
-        = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+        = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
     // std::cout << "+" << i << ": " << A_c.cols() << " :: " <<
     //   mNumClamping << std::endl;
@@ -4766,7 +4943,7 @@ Eigen::MatrixXs BackpropSnapshot::
     A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
     A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
     E = getUpperBoundMappingMatrix();
-    Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+    Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
     Q.diagonal() += getConstraintForceMixingDiagonal();
     // std::cout << "+" << i << ": " << A_c.cols() << " :: " <<
     //   mNumClamping << std::endl;
@@ -4785,7 +4962,7 @@ Eigen::MatrixXs BackpropSnapshot::
       A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
       A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
       E = getUpperBoundMappingMatrix();
-      Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+      Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
       Q.diagonal() += getConstraintForceMixingDiagonal();
       // std::cout << "+" << i << ": " << A_c.cols() << " :: " << mNumClamping
       // << std::endl;
@@ -4796,7 +4973,7 @@ Eigen::MatrixXs BackpropSnapshot::
       A_c = estimateClampingConstraintMatrixAt(world, world->getPositions());
       A_ub = estimateUpperBoundConstraintMatrixAt(world, world->getPositions());
       E = getUpperBoundMappingMatrix();
-      Q = A_c.transpose() * world->getInvMassMatrix() * (A_c + A_ub * E);
+      Q = A_c.transpose() * world->solveMassMatrix(A_c + A_ub * E);
       Q.diagonal() += getConstraintForceMixingDiagonal();
       // std::cout << "+" << i << ": " << A_c.cols() << " :: " << mNumClamping
       // << std::endl;
@@ -4854,21 +5031,20 @@ Eigen::MatrixXs BackpropSnapshot::getJacobianOfLCPOffsetClampingSubset(
   */
 
   s_t dt = world->getTimeStep();
-  Eigen::MatrixXs Minv = getInvMassMatrix(world);
   Eigen::MatrixXs A_c = getClampingConstraintMatrix(world);
+  // M is symmetric, so A_c^T * Minv = (Minv * A_c)^T
+  Eigen::MatrixXs MinvA_cT = world->solveMassMatrix(A_c).transpose();
   Eigen::MatrixXs dC = getJacobianOfC(world, wrt);
   if (wrt == WithRespectTo::VELOCITY)
   {
     // snapshot.restore();
-    return getBounceDiagonals().asDiagonal() * -A_c.transpose()
-           * (Eigen::MatrixXs::Identity(
-                  world->getNumDofs(), world->getNumDofs())
-              - dt * Minv * dC);
+    return getBounceDiagonals().asDiagonal()
+           * -(A_c.transpose() - dt * MinvA_cT * dC);
   }
   else if (wrt == WithRespectTo::FORCE)
   {
     // snapshot.restore();
-    return getBounceDiagonals().asDiagonal() * -A_c.transpose() * dt * Minv;
+    return getBounceDiagonals().asDiagonal() * -dt * MinvA_cT;
   }
 
   Eigen::VectorXs C = world->getCoriolisAndGravityAndExternalForces();
@@ -4883,13 +5059,14 @@ Eigen::MatrixXs BackpropSnapshot::getJacobianOfLCPOffsetClampingSubset(
 
     // snapshot.restore();
     return getBounceDiagonals().asDiagonal()
-           * -(dA_c_f + A_c.transpose() * dt * (dMinv_f - Minv * dC));
+           * -(dA_c_f
+               + dt * (A_c.transpose() * dMinv_f - MinvA_cT * dC));
   }
   else
   {
     // snapshot.restore();
     return getBounceDiagonals().asDiagonal()
-           * -(A_c.transpose() * dt * (dMinv_f - Minv * dC));
+           * -(dt * (A_c.transpose() * dMinv_f - MinvA_cT * dC));
   }
 }
 
@@ -5378,16 +5555,16 @@ Eigen::MatrixXs BackpropSnapshot::getJacobianOfProjectionIntoClampsMatrix(
     Eigen::MatrixXs rightHandSide = bounce * A_c.transpose();
     Eigen::MatrixXs dRhs
         = bounce * getJacobianOfClampingConstraintsTranspose(world, v);
-    Eigen::MatrixXs Minv = getInvMassMatrix(world);
 
     Eigen::MatrixXs Qinv = XFactor.pseudoInverse();
     Eigen::VectorXs Qinv_v = XFactor.solve(rightHandSide * v);
     Eigen::MatrixXs dQ
         = getJacobianOfClampingConstraintsTranspose(
-              world, Minv * A_c_ub_E * Qinv_v)
+              world, world->solveMassMatrix(A_c_ub_E * Qinv_v))
           + A_c.transpose()
                 * (getJacobianOfMinv(world, A_c_ub_E * Qinv_v, wrt)
-                   + Minv * getJacobianOfClampingConstraints(world, Qinv_v));
+                   + world->solveMassMatrix(
+                       getJacobianOfClampingConstraints(world, Qinv_v)));
 
     return (1 / world->getTimeStep())
            * (XFactor.solve(dRhs) - XFactor.solve(dQ));
@@ -48,6 +48,26 @@ public:
       PerformanceLog* perfLog = nullptr,
       bool exploreAlternateStrategies = false);
 
+  /// This computes every Jacobian that backprop() needs, along with the
+  /// box-bounds that it clips gradients against, by resetting the World to
+  /// its pre-step state once. Call this during the forward pass. Afterwards,
+  /// backprop() is a pure function of the snapshot: it never touches the
+  /// World, so it doesn't pay for recomputing the World's kinematics at every
+  /// timestep of a backward sweep, and snapshots can be backpropagated
+  /// concurrently.
+  void precomputeJacobians(
+      simulation::WorldPtr world, PerformanceLog* perfLog = nullptr);
+
+  /// Returns true if precomputeJacobians() has been called on this snapshot
+  bool hasPrecomputedJacobians() const;
+
+  /// This is backprop() using only the Jacobians that precomputeJacobians()
+  /// cached. It doesn't read or write the World, so it's safe to call on
+  /// different snapshots from different threads at the same time.
+  void backpropCached(
+      LossGradient& thisTimestepLoss,
+      const LossGradient& nextTimestepLoss) const;
+
   /// This computes backprop in the high-level RL API's space, use `state` and
   /// `action` as the primitives we're taking gradients wrt to.
   LossGradientHighLevelAPI backpropState(
@@ -293,6 +313,18 @@ public:
   Eigen::MatrixXs finiteDifferenceRiddersPosJacobianWrt(
       simulation::WorldPtr world, WithRespectTo* wrt);
 
+  /// This computes the Jacobian of the post-step velocity (or position, if
+  /// `outputPosition`) wrt `wrt` by finite differences, starting every
+  /// perturbation from this snapshot's pre-step state. Columns are spread
+  /// across the clones in world->getFiniteDifferencePool(), so this is much
+  /// faster than the serial finiteDifference*Jacobian() methods. This is what
+  /// setUseFDOverride() uses.
+  Eigen::MatrixXs parallelFiniteDifferenceJacobian(
+      simulation::WorldPtr world,
+      WithRespectTo* wrt,
+      bool outputPosition,
+      bool useRidders = true);
+
   /// This returns the P_c matrix. You shouldn't ever need this matrix, it's
   /// just here to enable testing.
   Eigen::MatrixXs getProjectionIntoClampsMatrix(
@@ -859,6 +891,25 @@ private:
   bool mCachedVelCDirty;
   Eigen::MatrixXs mCachedVelC;
 
+  /// This is true once precomputeJacobians() has filled in the Jacobians that
+  /// backprop() uses, and the bounds below
+  bool mJacobiansPrecomputed;
+
+  /// These are the World's box-bounds from BEFORE the timestep, which
+  /// backpropCached() clips gradients against
+  Eigen::VectorXs mPositionLowerLimits;
+  Eigen::VectorXs mPositionUpperLimits;
+  Eigen::VectorXs mVelocityLowerLimits;
+  Eigen::VectorXs mVelocityUpperLimits;
+  Eigen::VectorXs mControlForceLowerLimits;
+  Eigen::VectorXs mControlForceUpperLimits;
+
+  /// This is clipLossGradientsToBounds(), against the cached box-bounds
+  void clipLossGradientsToCachedBounds(
+      Eigen::VectorXs& lossWrtPos,
+      Eigen::VectorXs& lossWrtVel,
+      Eigen::VectorXs& lossWrtForce) const;
+
   Eigen::VectorXs scratch(simulation::WorldPtr world);
 
   enum MatrixToAssemble
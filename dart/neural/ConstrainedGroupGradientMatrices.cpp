@@ -64,8 +64,6 @@ ConstrainedGroupGradientMatrices::ConstrainedGroupGradientMatrices(
 
   mMassedImpulseTests.reserve(mNumConstraintDim);
 
-  // Cache an inverse mass matrix for later use
-  mMinv = Eigen::MatrixXs::Zero(mNumDOFs, mNumDOFs);
   mPreStepTorques = Eigen::VectorXs::Zero(mNumDOFs);
   mPreStepVelocities = Eigen::VectorXs::Zero(mNumDOFs);
   mPreLCPVelocities = Eigen::VectorXs::Zero(mNumDOFs);
@@ -73,7 +71,6 @@ ConstrainedGroupGradientMatrices::ConstrainedGroupGradientMatrices(
   for (auto skel : skeletons)
   {
     int dofs = skel->getNumDofs();
-    mMinv.block(cursor, cursor, dofs, dofs) = skel->getInvMassMatrix();
     mPreStepTorques.segment(cursor, dofs) = skel->getControlForces();
     mPreLCPVelocities.segment(cursor, dofs) = skel->getVelocities();
     mPreStepVelocities.segment(cursor, dofs)
@@ -106,6 +103,8 @@ void ConstrainedGroupGradientMatrices::registerConstraint(
   mPenetrationCorrectionVelocities.push_back(penetrationHack);
   mConstraints.push_back(constraint);
   mConstraintIndices.push_back(0);
+  mConstraintPrototypes.push_back(
+      std::make_shared<DifferentiableContactConstraint>(constraint, 0, 0.0));
   // Pad with 0s, since these values always apply to the first dimension of the
   // constraint even if there are more (ex. friction) dimensions
   for (std::size_t i = 1; i < constraint->getDimension(); i++)
@@ -116,6 +115,8 @@ void ConstrainedGroupGradientMatrices::registerConstraint(
     // later logistics easier
     mConstraints.push_back(constraint);
     mConstraintIndices.push_back(i);
+    mConstraintPrototypes.push_back(
+        std::make_shared<DifferentiableContactConstraint>(constraint, i, 0.0));
   }
 }
 
@@ -127,6 +128,7 @@ void ConstrainedGroupGradientMatrices::mockRegisterConstraint(
   mPenetrationCorrectionVelocities.push_back(penetrationHackVel);
   mConstraints.push_back(nullptr);
   mConstraintIndices.push_back(0);
+  mConstraintPrototypes.push_back(nullptr);
 }
 
 //==============================================================================
@@ -237,7 +239,7 @@ bool ConstrainedGroupGradientMatrices::opportunisticallyStandardizeResults(
   const Eigen::MatrixXs& E = getUpperBoundMappingMatrix();
   Eigen::MatrixXs A_c_ub_E = A_c + A_ub * E;
 
-  Eigen::MatrixXs Q = A_c.transpose() * mMinv * A_c_ub_E;
+  Eigen::MatrixXs Q = A_c.transpose() * solveMassMatrix(world, A_c_ub_E);
   Q.diagonal() += getConstraintForceMixingDiagonal();
   Eigen::VectorXs b = getClampingConstraintRelativeVels();
 
@@ -336,40 +338,21 @@ bool ConstrainedGroupGradientMatrices::opportunisticallyStandardizeResults(
 //==============================================================================
 void ConstrainedGroupGradientMatrices::deduplicateConstraints()
 {
-  // Build the merge groups
+  // Build the merge groups. We hash the impulse tests, rather than comparing
+  // every pair, because a mesh resting on the ground can produce dozens of
+  // nearly identical constraints.
 
   const s_t MERGE_THRESHOLD = 0.01;
 
-  std::vector<int> mergeGroup;
+  Eigen::MatrixXs impulseTests
+      = Eigen::MatrixXs::Zero(mNumDOFs, mNumConstraintDim);
   for (int i = 0; i < mNumConstraintDim; i++)
   {
-    mergeGroup.push_back(-1);
-  }
-
-  int groupCursor = 0;
-
-  for (int i = 0; i < mNumConstraintDim; i++)
-  {
-    // Merge with the first neighbor who is near enough
-    for (int j = 0; j < i; j++)
-    {
-      s_t distance
-          = (mMassedImpulseTests[i] - mMassedImpulseTests[j]).squaredNorm();
-      if (distance < MERGE_THRESHOLD)
-      {
-        mergeGroup[i] = mergeGroup[j];
-        break;
-      }
-    }
-
-    // If we didn't find a group to merge into, then form a new group
-
-    if (mergeGroup[i] == -1)
-    {
-      mergeGroup[i] = groupCursor;
-      groupCursor++;
-    }
+    impulseTests.col(i) = mMassedImpulseTests[i];
   }
+  Eigen::VectorXi mergeGroup = constraint::LCPUtils::groupNearDuplicates(
+      impulseTests, MERGE_THRESHOLD, Eigen::VectorXi::Zero(0));
+  int groupCursor = mNumConstraintDim == 0 ? 0 : mergeGroup.maxCoeff() + 1;
 
   // We have:
   //
@@ -395,62 +378,57 @@ void ConstrainedGroupGradientMatrices::deduplicateConstraints()
 
   Eigen::VectorXi newFIndex = Eigen::VectorXi::Zero(newNumConstraintDim);
 
-  std::vector<Eigen::VectorXs> newMassedImpulseTests;
-  std::vector<s_t> newPenetrationCorrectionVelocities;
-  std::vector<s_t> newRestitutionCoeffs;
-  std::vector<std::shared_ptr<constraint::ConstraintBase>> newConstraints;
-  std::vector<int> newConstraintIndices;
-
-  for (int i = 0; i < newNumConstraintDim; i++)
-  {
-    int groupCount = 0;
-
-    Eigen::VectorXs massedImpulseTest = Eigen::VectorXs::Zero(mNumDOFs);
-    s_t penetrationCorrectionVelocity = 0.0;
-    s_t restitutionCoeff = 0.0;
-    std::shared_ptr<constraint::ConstraintBase> constraint = nullptr;
-    int constraintIndex = 0;
-
-    for (int j = 0; j < mNumConstraintDim; j++)
+  std::vector<Eigen::VectorXs> newMassedImpulseTests(
+      newNumConstraintDim, Eigen::VectorXs::Zero(mNumDOFs));
+  std::vector<s_t> newPenetrationCorrectionVelocities(newNumConstraintDim, 0.0);
+  std::vector<s_t> newRestitutionCoeffs(newNumConstraintDim, 0.0);
+  std::vector<std::shared_ptr<constraint::ConstraintBase>> newConstraints(
+      newNumConstraintDim, nullptr);
+  std::vector<int> newConstraintIndices(newNumConstraintDim, 0);
+  std::vector<std::shared_ptr<DifferentiableContactConstraint>>
+      newConstraintPrototypes(newNumConstraintDim);
+  Eigen::VectorXs groupCounts = Eigen::VectorXs::Zero(newNumConstraintDim);
+
+  // Sum up each group in a single pass. The last constraint in each group
+  // gets to set the group's constraint and fIndex.
+  for (int j = 0; j < mNumConstraintDim; j++)
+  {
+    int i = mergeGroup(j);
+    groupCounts(i) += 1.0;
+    newX(i) += mX(j);
+    newHi(i) += mHi(j);
+    newLo(i) += mLo(j);
+    newB(i) += mB(j);
+    newAColNorms(i) += mAColNorms(j);
+
+    newFIndex(i) = mFIndex(j);
+    if (newFIndex(i) >= 0)
     {
-      if (mergeGroup[j] == i)
-      {
-        groupCount++;
-        newX(i) += mX(j);
-        newHi(i) += mHi(j);
-        newLo(i) += mLo(j);
-        newB(i) += mB(j);
-        newAColNorms(i) += mAColNorms(j);
-
-        newFIndex(i) = mFIndex(j);
-        if (newFIndex(i) >= 0)
-        {
-          newFIndex(i) = mergeGroup[newFIndex(i)];
-        }
+      newFIndex(i) = mergeGroup(newFIndex(i));
+    }
 
-        massedImpulseTest += mMassedImpulseTests[j];
+    newMassedImpulseTests[i] += mMassedImpulseTests[j];
 
-        penetrationCorrectionVelocity += mPenetrationCorrectionVelocities[j];
-        restitutionCoeff += mRestitutionCoeffs[j];
+    newPenetrationCorrectionVelocities[i]
+        += mPenetrationCorrectionVelocities[j];
+    newRestitutionCoeffs[i] += mRestitutionCoeffs[j];
 
-        constraint = mConstraints[j];
-        constraintIndex = mConstraintIndices[j];
-      }
-    }
+    newConstraints[i] = mConstraints[j];
+    newConstraintIndices[i] = mConstraintIndices[j];
+    newConstraintPrototypes[i] = mConstraintPrototypes[j];
+  }
 
-    newB(i) /= groupCount;
-    newHi(i) /= groupCount;
-    newLo(i) /= groupCount;
-    newAColNorms(i) /= groupCount;
-    massedImpulseTest /= groupCount;
-    penetrationCorrectionVelocity /= groupCount;
-    restitutionCoeff /= groupCount;
+  // Then take the averages
 
-    newMassedImpulseTests.push_back(massedImpulseTest);
-    newPenetrationCorrectionVelocities.push_back(penetrationCorrectionVelocity);
-    newRestitutionCoeffs.push_back(restitutionCoeff);
-    newConstraints.push_back(constraint);
-    newConstraintIndices.push_back(constraintIndex);
+  for (int i = 0; i < newNumConstraintDim; i++)
+  {
+    newB(i) /= groupCounts(i);
+    newHi(i) /= groupCounts(i);
+    newLo(i) /= groupCounts(i);
+    newAColNorms(i) /= groupCounts(i);
+    newMassedImpulseTests[i] /= groupCounts(i);
+    newPenetrationCorrectionVelocities[i] /= groupCounts(i);
+    newRestitutionCoeffs[i] /= groupCounts(i);
   }
 
   // Set our new values
@@ -467,6 +445,7 @@ void ConstrainedGroupGradientMatrices::deduplicateConstraints()
   mRestitutionCoeffs = newRestitutionCoeffs;
   mConstraints = newConstraints;
   mConstraintIndices = newConstraintIndices;
+  mConstraintPrototypes = newConstraintPrototypes;
 }
 
 //==============================================================================
@@ -745,8 +724,11 @@ void ConstrainedGroupGradientMatrices::constructMatrices(
   for (size_t j = 0; j < mNumConstraintDim; j++)
   {
     std::shared_ptr<DifferentiableContactConstraint> constraint
-        = std::make_shared<DifferentiableContactConstraint>(
-            mConstraints[j], mConstraintIndices[j], mX(j));
+        = mConstraintPrototypes[j]
+              ? std::make_shared<DifferentiableContactConstraint>(
+                  *mConstraintPrototypes[j], mX(j))
+              : std::make_shared<DifferentiableContactConstraint>(
+                  mConstraints[j], mConstraintIndices[j], mX(j));
     mDifferentiableConstraints.push_back(constraint);
 
     mAllConstraintMatrix.col(j)
@@ -880,7 +862,6 @@ Eigen::MatrixXs ConstrainedGroupGradientMatrices::getControlForceVelJacobian(
 #endif
 
   const Eigen::MatrixXs& A_c = getClampingConstraintMatrix();
-  Eigen::MatrixXs Minv = getInvMassMatrix(world);
 
   Eigen::MatrixXs jac;
 
@@ -889,7 +870,7 @@ Eigen::MatrixXs ConstrainedGroupGradientMatrices::getControlForceVelJacobian(
   // * Minv
   if (A_c.size() == 0)
   {
-    jac = mTimeStep * Minv;
+    jac = mTimeStep * getInvMassMatrix(world);
   }
   else
   {
@@ -1221,15 +1202,13 @@ Eigen::MatrixXs ConstrainedGroupGradientMatrices::getVelJacobianWrt(
   Eigen::MatrixXs dM
       = getJacobianOfMinv(world, dt * (tau - C) + A_c_ub_E * f_c, wrt);
 
-  Eigen::MatrixXs Minv = getInvMassMatrix(world);
-
   Eigen::MatrixXs dF_c = getJacobianOfConstraintForce(world, wrt);
 
   if (wrt == WithRespectTo::FORCE)
   {
-    return Minv
-           * ((A_c_ub_E * dF_c)
-              + (dt * Eigen::MatrixXs::Identity(dofs, wrtDim)));
+    return solveMassMatrix(
+        world.get(),
+        (A_c_ub_E * dF_c) + (dt * Eigen::MatrixXs::Identity(dofs, wrtDim)));
   }
 
   Eigen::MatrixXs dC = getJacobianOfC(world, wrt);
@@ -1237,17 +1216,19 @@ Eigen::MatrixXs ConstrainedGroupGradientMatrices::getVelJacobianWrt(
   if (wrt == WithRespectTo::VELOCITY)
   {
     return Eigen::MatrixXs::Identity(dofs, wrtDim)
-           + Minv * (A_c_ub_E * dF_c - dt * dC);
+           + solveMassMatrix(world.get(), A_c_ub_E * dF_c - dt * dC);
   }
   else if (wrt == WithRespectTo::POSITION)
   {
     Eigen::MatrixXs dA_c = getJacobianOfClampingConstraints(world, f_c);
     Eigen::MatrixXs dA_ubE = getJacobianOfUpperBoundConstraints(world, E * f_c);
-    return dM + Minv * (A_c_ub_E * dF_c + dA_c + dA_ubE - dt * dC);
+    return dM
+           + solveMassMatrix(
+               world.get(), A_c_ub_E * dF_c + dA_c + dA_ubE - dt * dC);
   }
   else
   {
-    return dM + Minv * (A_c_ub_E * dF_c - dt * dC);
+    return dM + solveMassMatrix(world.get(), A_c_ub_E * dF_c - dt * dC);
   }
 }
 
@@ -1266,9 +1247,9 @@ Eigen::MatrixXs ConstrainedGroupGradientMatrices::getJacobianOfConstraintForce(
   const Eigen::MatrixXs& A_ub = getUpperBoundConstraintMatrix();
   const Eigen::MatrixXs& E = getUpperBoundMappingMatrix();
 
-  Eigen::MatrixXs Minv = getInvMassMatrix(world);
   Eigen::MatrixXs A_c_ub_E = A_c + A_ub * E;
-  Eigen::MatrixXs Q = A_c.transpose() * Minv * A_c_ub_E;
+  Eigen::MatrixXs Q
+      = A_c.transpose() * solveMassMatrix(world.get(), A_c_ub_E);
   Q.diagonal() += getConstraintForceMixingDiagonal();
 
   Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXs> Qfac
@@ -1507,17 +1488,18 @@ ConstrainedGroupGradientMatrices::getJacobianOfLCPOffsetClampingSubset(
     simulation::WorldPtr world, WithRespectTo* wrt)
 {
   s_t dt = world->getTimeStep();
-  Eigen::MatrixXs Minv = getInvMassMatrix(world);
   const Eigen::MatrixXs& A_c = getClampingConstraintMatrix();
+  // M is symmetric, so A_c^T * Minv = (Minv * A_c)^T
+  Eigen::MatrixXs MinvA_cT = solveMassMatrix(world.get(), A_c).transpose();
   Eigen::MatrixXs dC = getJacobianOfC(world, wrt);
   if (wrt == WithRespectTo::VELOCITY)
   {
-    return getBounceDiagonals().asDiagonal() * -A_c.transpose()
-           * (Eigen::MatrixXs::Identity(mNumDOFs, mNumDOFs) - dt * Minv * dC);
+    return getBounceDiagonals().asDiagonal()
+           * -(A_c.transpose() - dt * MinvA_cT * dC);
   }
   else if (wrt == WithRespectTo::FORCE)
   {
-    return getBounceDiagonals().asDiagonal() * -A_c.transpose() * dt * Minv;
+    return getBounceDiagonals().asDiagonal() * -dt * MinvA_cT;
   }
 
   Eigen::VectorXs C = getCoriolisAndGravityAndExternalForces(world);
@@ -1531,12 +1513,13 @@ ConstrainedGroupGradientMatrices::getJacobianOfLCPOffsetClampingSubset(
         = getJacobianOfClampingConstraintsTranspose(world, v_f);
 
     return getBounceDiagonals().asDiagonal()
-           * -(dA_c_f + A_c.transpose() * dt * (dMinv_f - Minv * dC));
+           * -(dA_c_f
+               + dt * (A_c.transpose() * dMinv_f - MinvA_cT * dC));
   }
   else
   {
     return getBounceDiagonals().asDiagonal()
-           * -(A_c.transpose() * dt * (dMinv_f - Minv * dC));
+           * -(dt * (A_c.transpose() * dMinv_f - MinvA_cT * dC));
   }
 }
 
@@ -1749,14 +1732,22 @@ Eigen::VectorXs
 ConstrainedGroupGradientMatrices::implicitMultiplyByInvMassMatrix(
     WorldPtr world, const Eigen::VectorXs& x)
 {
-  Eigen::VectorXs result = Eigen::VectorXs::Zero(getNumDOFs());
+  return solveMassMatrix(world.get(), x);
+}
+
+//==============================================================================
+Eigen::MatrixXs ConstrainedGroupGradientMatrices::solveMassMatrix(
+    simulation::World* world, const Eigen::MatrixXs& B)
+{
+  assert(B.rows() == mNumDOFs);
+  Eigen::MatrixXs result(B.rows(), B.cols());
   std::size_t cursor = 0;
   for (std::size_t i = 0; i < mSkeletons.size(); i++)
   {
     SkeletonPtr skel = world->getSkeleton(mSkeletons[i]);
     std::size_t dofs = skel->getNumDofs();
-    result.segment(cursor, dofs)
-        = skel->multiplyByImplicitInvMassMatrix(x.segment(cursor, dofs));
+    result.middleRows(cursor, dofs)
+        = skel->solveMassMatrix(B.middleRows(cursor, dofs));
     cursor += dofs;
   }
   return result;
@@ -1808,7 +1799,8 @@ void ConstrainedGroupGradientMatrices::backprop(
     // is straightforward, M^{-1}*A. Then backprop with the transpose method.
 
     /*
-    Eigen::MatrixXs jac = getMinv() * getAllConstraintMatrix();
+    Eigen::MatrixXs jac
+        = solveMassMatrix(world.get(), getAllConstraintMatrix());
     Eigen::VectorXs lossWrtContactForce
         = jac.transpose() * nextTimestepLoss.lossWrtVelocity;
     */
@@ -2198,13 +2190,6 @@ const Eigen::VectorXs& ConstrainedGroupGradientMatrices::getPreLCPVelocity()
   return mPreLCPVelocities;
 }
 
-//==============================================================================
-/// Returns the M^{-1} matrix from pre-step
-const Eigen::MatrixXs& ConstrainedGroupGradientMatrices::getMinv() const
-{
-  return mMinv;
-}
-
 //==============================================================================
 /// Get the coriolis and gravity forces
 const Eigen::VectorXs
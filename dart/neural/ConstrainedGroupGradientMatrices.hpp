@@ -326,6 +326,11 @@ public:
   Eigen::VectorXs implicitMultiplyByInvMassMatrix(
       simulation::WorldPtr world, const Eigen::VectorXs& x);
 
+  /// This returns Minv*B for the skeletons in this group, solving against
+  /// each skeleton's factored mass matrix instead of forming Minv
+  Eigen::MatrixXs solveMassMatrix(
+      simulation::World* world, const Eigen::MatrixXs& B);
+
   const Eigen::MatrixXs& getAllConstraintMatrix() const;
 
   const Eigen::MatrixXs& getClampingConstraintMatrix() const;
@@ -380,9 +385,6 @@ public:
   /// Returns the velocity pre-LCP
   const Eigen::VectorXs& getPreLCPVelocity() const;
 
-  /// Returns the M^{-1} matrix from pre-step
-  const Eigen::MatrixXs& getMinv() const;
-
   /// Get the coriolis and gravity forces
   const Eigen::VectorXs getCoriolisAndGravityAndExternalForces(
       simulation::WorldPtr world) const;
@@ -516,9 +518,6 @@ public:
   /// to clamping indices.
   Eigen::MatrixXs mClampingAMatrix;
 
-  /// This is the inverse mass matrix computed in the constuctor
-  Eigen::MatrixXs mMinv;
-
   /// These are the torques being applied, computed in the constuctor
   Eigen::VectorXs mPreStepTorques;
 
@@ -561,6 +560,13 @@ public:
   /// constraint i represents
   std::vector<int> mConstraintIndices;
 
+  /// This is a snapshot of mConstraints[i] taken when it was registered.
+  /// constructMatrices() can get called again during backprop, long after the
+  /// solver has reset mConstraints[i] for a later step, so it builds its
+  /// DifferentiableContactConstraints from these instead.
+  std::vector<std::shared_ptr<DifferentiableContactConstraint>>
+      mConstraintPrototypes;
+
   /// These are all the constraints
   std::vector<std::shared_ptr<DifferentiableContactConstraint>>
       mDifferentiableConstraints;
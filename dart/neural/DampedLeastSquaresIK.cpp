@@ -0,0 +1,168 @@
+#include "dart/neural/DampedLeastSquaresIK.hpp"
+
+#include <algorithm>
+
+namespace dart {
+namespace neural {
+
+//==============================================================================
+DampedLeastSquaresIK::DampedLeastSquaresIK(
+    Residual residual, Jacobian jacobian)
+  : mResidual(residual),
+    mJacobian(jacobian),
+    mIterationLimit(100),
+    mTolerance(1e-21),
+    mRelativeTolerance(1e-12),
+    mInitialDamping(1e-3)
+{
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::setIterationLimit(int limit)
+{
+  mIterationLimit = limit;
+}
+
+//==============================================================================
+int DampedLeastSquaresIK::getIterationLimit() const
+{
+  return mIterationLimit;
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::setTolerance(s_t tolerance)
+{
+  mTolerance = tolerance;
+}
+
+//==============================================================================
+s_t DampedLeastSquaresIK::getTolerance() const
+{
+  return mTolerance;
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::setRelativeTolerance(s_t tolerance)
+{
+  mRelativeTolerance = tolerance;
+}
+
+//==============================================================================
+s_t DampedLeastSquaresIK::getRelativeTolerance() const
+{
+  return mRelativeTolerance;
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::setInitialDamping(s_t damping)
+{
+  mInitialDamping = damping;
+}
+
+//==============================================================================
+s_t DampedLeastSquaresIK::getInitialDamping() const
+{
+  return mInitialDamping;
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::setPositionLimits(
+    const Eigen::VectorXs& lowerLimits, const Eigen::VectorXs& upperLimits)
+{
+  assert(lowerLimits.size() == upperLimits.size());
+  mLowerLimits = lowerLimits;
+  mUpperLimits = upperLimits;
+}
+
+//==============================================================================
+Eigen::VectorXs DampedLeastSquaresIK::solve(
+    const Eigen::VectorXs& initialGuess,
+    /* OUT */ s_t* finalError,
+    /* OUT */ int* iterations)
+{
+  Eigen::VectorXs positions = initialGuess;
+  projectToLimits(positions);
+
+  Eigen::VectorXs residual;
+  mResidual(positions, residual);
+  s_t error = residual.squaredNorm();
+
+  Eigen::MatrixXs J;
+  bool jacobianStale = true;
+  s_t damping = mInitialDamping;
+
+  Eigen::VectorXs candidate;
+  Eigen::VectorXs candidateResidual;
+  int i = 0;
+  for (; i < mIterationLimit; i++)
+  {
+    if (error < mTolerance)
+      break;
+
+    if (jacobianStale)
+    {
+      mJacobian(positions, J);
+      jacobianStale = false;
+    }
+
+    // (J^T J + lambda I)^-1 J^T = J^T (J J^T + lambda I)^-1, so we factor
+    // whichever of the two is smaller. IK targets usually have fewer
+    // dimensions than the skeletons they're attached to.
+    Eigen::VectorXs delta;
+    if (J.rows() < J.cols())
+    {
+      Eigen::MatrixXs A = J * J.transpose();
+      A.diagonal().array() += damping;
+      delta = J.transpose() * A.ldlt().solve(residual);
+    }
+    else
+    {
+      Eigen::MatrixXs A = J.transpose() * J;
+      A.diagonal().array() += damping;
+      delta = A.ldlt().solve(J.transpose() * residual);
+    }
+
+    candidate = positions + delta;
+    projectToLimits(candidate);
+    mResidual(candidate, candidateResidual);
+    s_t candidateError = candidateResidual.squaredNorm();
+
+    if (candidateError < error)
+    {
+      const s_t improvement = error - candidateError;
+      positions.swap(candidate);
+      residual.swap(candidateResidual);
+      error = candidateError;
+      jacobianStale = true;
+      damping = std::max(damping * 0.1, (s_t)1e-12);
+      if (improvement < mRelativeTolerance * (error + improvement))
+        break;
+    }
+    else
+    {
+      // We've overshot, so we fall back towards gradient descent with a
+      // shorter step. If even a tiny step doesn't help, we're at a local
+      // minimum.
+      damping *= 10;
+      if (damping > 1e12)
+        break;
+    }
+  }
+
+  if (finalError != nullptr)
+    *finalError = error;
+  if (iterations != nullptr)
+    *iterations = i;
+  return positions;
+}
+
+//==============================================================================
+void DampedLeastSquaresIK::projectToLimits(Eigen::VectorXs& positions) const
+{
+  if (mLowerLimits.size() != positions.size())
+    return;
+  positions = positions.cwiseMax(mLowerLimits).cwiseMin(mUpperLimits);
+}
+
+} // namespace neural
+} // namespace dart
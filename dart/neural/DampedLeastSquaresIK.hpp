@@ -0,0 +1,98 @@
+#ifndef DART_NEURAL_DAMPED_LEAST_SQUARES_IK_HPP_
+#define DART_NEURAL_DAMPED_LEAST_SQUARES_IK_HPP_
+
+#include <functional>
+
+#include <Eigen/Dense>
+
+#include "dart/math/MathTypes.hpp"
+
+namespace dart {
+namespace neural {
+
+/*
+ * This is a Levenberg-Marquardt (damped least-squares) solver for inverse
+ * kinematics. Each iteration solves
+ *
+ *   (J^T J + lambda * I) * delta = J^T * residual
+ *
+ * for a step `delta` in joint space, projects the stepped positions back
+ * inside the joint limits, and keeps the step only if it reduces the squared
+ * residual. The damping `lambda` shrinks after every accepted step, so close
+ * to a solution we take Gauss-Newton steps, and grows after every rejected
+ * one, so near singularities we take short gradient descent steps instead of
+ * blowing up.
+ *
+ * The solver doesn't know what it's solving. Callers pass a Residual and a
+ * Jacobian, which usually set the positions on a World and read the result
+ * back out.
+ */
+class DampedLeastSquaresIK
+{
+public:
+  /// This writes (target - current value) at `positions` into `residual`
+  typedef std::function<void(
+      const Eigen::VectorXs& positions, Eigen::VectorXs& residual)>
+      Residual;
+
+  /// This writes the Jacobian of the current value (not the residual) with
+  /// respect to the positions, at `positions`, into `jac`
+  typedef std::function<void(
+      const Eigen::VectorXs& positions, Eigen::MatrixXs& jac)>
+      Jacobian;
+
+  DampedLeastSquaresIK(Residual residual, Jacobian jacobian);
+
+  /// This sets the most iterations we'll run before giving up. Each iteration
+  /// evaluates the residual once, and the Jacobian at most once.
+  void setIterationLimit(int limit);
+  int getIterationLimit() const;
+
+  /// This sets the squared residual below which we consider the target hit
+  void setTolerance(s_t tolerance);
+  s_t getTolerance() const;
+
+  /// This sets the smallest fractional decrease in the squared residual that
+  /// counts as progress. We stop as soon as an accepted step does worse than
+  /// this, which is how we terminate on targets that can't be hit.
+  void setRelativeTolerance(s_t tolerance);
+  s_t getRelativeTolerance() const;
+
+  /// This sets the damping we start each solve with
+  void setInitialDamping(s_t damping);
+  s_t getInitialDamping() const;
+
+  /// This sets the box that every iterate gets projected into. By default
+  /// the positions are unbounded.
+  void setPositionLimits(
+      const Eigen::VectorXs& lowerLimits, const Eigen::VectorXs& upperLimits);
+
+  /// This runs the solver from `initialGuess`, which is projected into the
+  /// position limits first, and returns the best positions it found. Warm
+  /// starting from a nearby solution (for example, the previous frame of a
+  /// motion) usually converges in a handful of iterations.
+  Eigen::VectorXs solve(
+      const Eigen::VectorXs& initialGuess,
+      /* OUT */ s_t* finalError = nullptr,
+      /* OUT */ int* iterations = nullptr);
+
+protected:
+  /// This clamps `positions` into the position limits, if we have any
+  void projectToLimits(Eigen::VectorXs& positions) const;
+
+  Residual mResidual;
+  Jacobian mJacobian;
+
+  int mIterationLimit;
+  s_t mTolerance;
+  s_t mRelativeTolerance;
+  s_t mInitialDamping;
+
+  Eigen::VectorXs mLowerLimits;
+  Eigen::VectorXs mUpperLimits;
+};
+
+} // namespace neural
+} // namespace dart
+
+#endif
@@ -23,6 +23,9 @@ DifferentiableContactConstraint::DifferentiableContactConstraint(
     int index,
     s_t constraintForce)
   : mConstraint(constraint),
+    mBodyNodeA(nullptr),
+    mBodyNodeB(nullptr),
+    mFirstFrictionalDirection(Eigen::Vector3s::UnitZ()),
     mIndex(index),
     mConstraintForce(constraintForce),
     mWorldConstraintJacCacheDirty(true)
@@ -34,6 +37,9 @@ DifferentiableContactConstraint::DifferentiableContactConstraint(
     // This needs to be explicitly copied, otherwise the memory is overwritten
     mContact = std::make_shared<collision::Contact>(
         mContactConstraint->getContact());
+    mBodyNodeA = mContactConstraint->getBodyNodeA();
+    mBodyNodeB = mContactConstraint->getBodyNodeB();
+    mFirstFrictionalDirection = mContactConstraint->getFrictionDirection1();
   }
   for (auto skel : constraint->getSkeletons())
   {
@@ -42,6 +48,23 @@ DifferentiableContactConstraint::DifferentiableContactConstraint(
   }
 }
 
+//==============================================================================
+DifferentiableContactConstraint::DifferentiableContactConstraint(
+    const DifferentiableContactConstraint& prototype, s_t constraintForce)
+  : mConstraint(prototype.mConstraint),
+    mContactConstraint(prototype.mContactConstraint),
+    mContact(prototype.mContact),
+    mBodyNodeA(prototype.mBodyNodeA),
+    mBodyNodeB(prototype.mBodyNodeB),
+    mFirstFrictionalDirection(prototype.mFirstFrictionalDirection),
+    mSkeletons(prototype.mSkeletons),
+    mSkeletonOriginalPositions(prototype.mSkeletonOriginalPositions),
+    mConstraintForce(constraintForce),
+    mWorldConstraintJacCacheDirty(true),
+    mIndex(prototype.mIndex)
+{
+}
+
 //==============================================================================
 Eigen::Vector3s DifferentiableContactConstraint::getContactWorldPosition()
 {
@@ -75,7 +98,8 @@ Eigen::Vector3s DifferentiableContactConstraint::getContactWorldForceDirection()
   }
   else
   {
-    return mContactConstraint->getTangentBasisMatrixODE(mContact->normal)
+    return constraint::ContactConstraint::getTangentBasisMatrixODE(
+               mFirstFrictionalDirection, mContact->normal)
         .col(mIndex - 1);
   }
 }
@@ -113,8 +137,8 @@ collision::Contact& DifferentiableContactConstraint::getContact()
 DofContactType DifferentiableContactConstraint::getDofContactType(
     dynamics::DegreeOfFreedom* dof)
 {
-  bool isParentA = dof->isParentOfFast(mContactConstraint->getBodyNodeA());
-  bool isParentB = dof->isParentOfFast(mContactConstraint->getBodyNodeB());
+  bool isParentA = dof->isParentOfFast(mBodyNodeA);
+  bool isParentB = dof->isParentOfFast(mBodyNodeB);
   // If we're a parent of both contact points, it's a self-contact down the tree
   if (isParentA && isParentB)
   {
@@ -1083,8 +1107,8 @@ Eigen::Vector3s DifferentiableContactConstraint::getContactForceGradient(
     return normalGradient;
   else
   {
-    return mContactConstraint
-        ->getTangentBasisMatrixODEGradient(contactNormal, normalGradient)
+    return constraint::ContactConstraint::getTangentBasisMatrixODEGradient(
+               mFirstFrictionalDirection, contactNormal, normalGradient)
         .col(mIndex - 1);
   }
 }
@@ -2556,7 +2580,8 @@ DifferentiableContactConstraint::estimatePerturbedContactForceDirection(
     return contactNormal;
   else
   {
-    return mContactConstraint->getTangentBasisMatrixODE(contactNormal)
+    return constraint::ContactConstraint::getTangentBasisMatrixODE(
+               mFirstFrictionalDirection, contactNormal)
         .col(mIndex - 1);
   }
 }
@@ -2899,8 +2924,8 @@ s_t DifferentiableContactConstraint::getControlForceMultiple(
   if (!mConstraint->isContactConstraint())
     return 1.0;
 
-  bool isParentA = dof->isParentOfFast(mContactConstraint->getBodyNodeA());
-  bool isParentB = dof->isParentOfFast(mContactConstraint->getBodyNodeB());
+  bool isParentA = dof->isParentOfFast(mBodyNodeA);
+  bool isParentB = dof->isParentOfFast(mBodyNodeB);
 
   // This means it's a self-collision, and we're up stream, so the net effect is
   // 0
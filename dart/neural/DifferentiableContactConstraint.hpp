@@ -78,6 +78,12 @@ public:
       int index,
       s_t constraintForce);
 
+  /// This copies everything `prototype` captured from its constraint, but with
+  /// a new constraint force. Unlike the constructor above, this doesn't read
+  /// the constraint again, which may since have been reused for a later step.
+  DifferentiableContactConstraint(
+      const DifferentiableContactConstraint& prototype, s_t constraintForce);
+
   Eigen::Vector3s getContactWorldPosition();
 
   /// This returns the normal of the contact, pointing from A to B. This IS NOT
@@ -384,6 +390,11 @@ protected:
   std::shared_ptr<constraint::ConstraintBase> mConstraint;
   std::shared_ptr<constraint::ContactConstraint> mContactConstraint;
   std::shared_ptr<collision::Contact> mContact;
+  /// These are copied off of mContactConstraint when we're constructed, since
+  /// the solver resets and reuses contact constraints from step to step
+  const dynamics::BodyNode* mBodyNodeA;
+  const dynamics::BodyNode* mBodyNodeB;
+  Eigen::Vector3s mFirstFrictionalDirection;
   std::vector<std::string> mSkeletons;
   std::vector<Eigen::VectorXs> mSkeletonOriginalPositions;
   s_t mConstraintForce;
@@ -1,8 +1,13 @@
 #include "dart/neural/IKMapping.hpp"
 
+#include <algorithm>
+#include <future>
+#include <thread>
+
 #include "dart/dynamics/BodyNode.hpp"
 #include "dart/dynamics/Frame.hpp"
 #include "dart/dynamics/Skeleton.hpp"
+#include "dart/neural/DampedLeastSquaresIK.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/neural/WithRespectToMass.hpp"
 #include "dart/simulation/World.hpp"
@@ -14,11 +19,17 @@ namespace neural {
 
 //==============================================================================
 IKMapping::IKMapping(std::shared_ptr<simulation::World> world)
-  : mIKIterationLimit(100)
+  : mIKIterationLimit(100), mIKWarmStart(false)
 {
   mMassDim = world->getMassDims();
 }
 
+//==============================================================================
+std::shared_ptr<Mapping> IKMapping::clone() const
+{
+  return std::make_shared<IKMapping>(*this);
+}
+
 //==============================================================================
 void IKMapping::setIKIterationLimit(int limit)
 {
@@ -38,6 +49,18 @@ int IKMapping::getIKIterationLimit()
   return mIKIterationLimit;
 }
 
+//==============================================================================
+void IKMapping::setIKWarmStart(bool warmStart)
+{
+  mIKWarmStart = warmStart;
+}
+
+//==============================================================================
+bool IKMapping::getIKWarmStart()
+{
+  return mIKWarmStart;
+}
+
 //==============================================================================
 void IKMapping::addSpatialBodyNode(dynamics::BodyNode* node)
 {
@@ -81,82 +104,85 @@ int IKMapping::getMassDim()
 }
 
 //==============================================================================
-// #define DART_NEURAL_LOG_IK_OUTPUT
 void IKMapping::setPositions(
     std::shared_ptr<simulation::World> world,
     const Eigen::Ref<Eigen::VectorXs>& positions)
 {
-  // Reset to 0, so that solutions are always deterministic even if IK is
-  // under/over specified
-  world->setPositions(Eigen::VectorXs::Zero(world->getNumDofs()));
-  // Run simple IK to try to get as close as possible. Completely possible that
-  // the requested positions are infeasible, in which case we'll just do a best
-  // guess.
-  s_t error = std::numeric_limits<s_t>::infinity();
-  s_t lr = 0.05;
-  bool useTranspose = false;
-  for (int i = 0; i < mIKIterationLimit; i++)
+  // Unless we're asked to warm start, we start from 0, so that solutions are
+  // always deterministic even if IK is under/over specified
+  Eigen::VectorXs initialGuess = Eigen::VectorXs::Zero(world->getNumDofs());
+  if (mIKWarmStart && mLastIKSolution.size() == world->getNumDofs())
   {
-    Eigen::VectorXs diff = positions - getPositions(world);
-    s_t newError = diff.squaredNorm();
-    s_t errorChange = newError - error;
-    error = newError;
-#ifdef DART_NEURAL_LOG_IK_OUTPUT
-    std::cout << "IK iteration " << i << " lr: " << lr << " loss: " << error
-              << " change: " << errorChange << std::endl;
-#endif
-    if (error < 1e-21)
-    {
-#ifdef DART_NEURAL_LOG_IK_OUTPUT
-      std::cout << "Terminating IK search after " << i
-                << " iterations with loss: " << error << std::endl;
-#endif
-      break;
-    }
-    if (errorChange > 0)
-    {
-      lr *= 0.5;
-    }
-    else if (errorChange > -1e-22)
-    {
-#ifdef DART_NEURAL_LOG_IK_OUTPUT
-      std::cout << "Terminating IK search after " << i
-                << " iterations with optimal loss: " << error << std::endl;
-#endif
-      break;
-    }
-    else
-    {
-      // Slowly grow LR while we're safely decreasing loss
-      lr *= 1.1;
-    }
-    if (lr < 1e-4)
-    {
-      useTranspose = true;
-    }
+    initialGuess = mLastIKSolution;
+  }
+  mLastIKSolution = solveIK(world, positions, initialGuess);
+}
 
-    Eigen::MatrixXs J = getPosJacobian(world);
-    Eigen::VectorXs delta;
+//==============================================================================
+Eigen::MatrixXs IKMapping::solvePositions(
+    std::shared_ptr<simulation::World> world,
+    const Eigen::MatrixXs& targets,
+    int numWorkers)
+{
+  const int numTargets = targets.cols();
+  Eigen::MatrixXs solutions
+      = Eigen::MatrixXs::Zero(world->getNumDofs(), numTargets);
+  if (numTargets == 0)
+    return solutions;
 
-    if (useTranspose)
-    {
-      delta = J.transpose() * diff;
-    }
-    else
+  if (numWorkers < 1)
+  {
+    numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+  }
+  numWorkers = std::min(numWorkers, numTargets);
+
+  Eigen::VectorXs initialGuess = Eigen::VectorXs::Zero(world->getNumDofs());
+  if (mIKWarmStart && mLastIKSolution.size() == world->getNumDofs())
+  {
+    initialGuess = mLastIKSolution;
+  }
+
+  // Each worker writes to its own columns of `solutions`, so they don't need
+  // to coordinate
+  auto solveRun = [&](std::shared_ptr<simulation::World> worker,
+                      int begin,
+                      int end) {
+    Eigen::VectorXs guess = initialGuess;
+    for (int i = begin; i < end; i++)
     {
-      delta = J.completeOrthogonalDecomposition().solve(diff);
+      solutions.col(i) = solveIK(worker, targets.col(i), guess);
+      if (mIKWarmStart)
+      {
+        guess = solutions.col(i);
+      }
     }
-#ifdef DART_NEURAL_LOG_IK_OUTPUT
-    // std::cout << "IK Diff: " << std::endl << diff << std::endl;
-    // std::cout << "IK J: " << std::endl << J << std::endl;
-    // std::cout << "IK Delta: " << std::endl << delta << std::endl;
-    // std::cout << "J * IK Delta: " << std::endl << J * delta << std::endl;
-#endif
-    world->setPositions(world->getPositions() + (lr * delta));
+  };
+
+  if (numWorkers == 1)
+  {
+    RestorableSnapshot snapshot(world);
+    solveRun(world, 0, numTargets);
+    snapshot.restore();
+    return solutions;
   }
-#ifdef DART_NEURAL_LOG_IK_OUTPUT
-  std::cout << "Finished IK search with loss: " << error << std::endl;
-#endif
+
+  // Before using Eigen in a multi-threaded environment, we need to explicitly
+  // call this (at least prior to Eigen 3.3)
+  Eigen::initParallel();
+
+  std::vector<std::future<void>> futures;
+  for (int worker = 0; worker < numWorkers; worker++)
+  {
+    const int begin = numTargets * worker / numWorkers;
+    const int end = numTargets * (worker + 1) / numWorkers;
+    futures.push_back(std::async(
+        std::launch::async, solveRun, world->clone(), begin, end));
+  }
+  for (int i = 0; i < futures.size(); i++)
+  {
+    futures[i].wait();
+  }
+  return solutions;
 }
 
 //==============================================================================
@@ -164,7 +190,11 @@ void IKMapping::setVelocities(
     std::shared_ptr<simulation::World> world,
     const Eigen::Ref<Eigen::VectorXs>& velocities)
 {
-  world->setVelocities(getVelJacobianInverse(world) * velocities);
+  // This is the same as multiplying by getVelJacobianInverse(), without
+  // forming the whole pseudo-inverse
+  world->setVelocities(
+      getVelJacobian(world).completeOrthogonalDecomposition().solve(
+          velocities));
 }
 
 //==============================================================================
@@ -406,6 +436,39 @@ int IKMapping::getDim()
   return dim;
 }
 
+//==============================================================================
+// #define DART_NEURAL_LOG_IK_OUTPUT
+Eigen::VectorXs IKMapping::solveIK(
+    std::shared_ptr<simulation::World> world,
+    const Eigen::VectorXs& target,
+    const Eigen::VectorXs& initialGuess)
+{
+  // It's completely possible that the requested positions are infeasible, in
+  // which case the solver stops at a best guess
+  DampedLeastSquaresIK solver(
+      [&](const Eigen::VectorXs& positions, Eigen::VectorXs& residual) {
+        world->setPositions(positions);
+        residual = target - getPositions(world);
+      },
+      [&](const Eigen::VectorXs& positions, Eigen::MatrixXs& jac) {
+        world->setPositions(positions);
+        jac = getPosJacobian(world);
+      });
+  solver.setIterationLimit(mIKIterationLimit);
+  solver.setPositionLimits(
+      world->getPositionLowerLimits(), world->getPositionUpperLimits());
+
+  s_t error;
+  int iterations;
+  Eigen::VectorXs solution = solver.solve(initialGuess, &error, &iterations);
+  world->setPositions(solution);
+#ifdef DART_NEURAL_LOG_IK_OUTPUT
+  std::cout << "Finished IK search after " << iterations
+            << " iterations with loss: " << error << std::endl;
+#endif
+  return solution;
+}
+
 //==============================================================================
 /// Computes a Jacobian that transforms changes in joint angle to changes in
 /// IK body positions (expressed in log space).
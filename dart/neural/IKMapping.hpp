@@ -43,11 +43,22 @@ class IKMapping : public Mapping
 public:
   IKMapping(std::shared_ptr<simulation::World> world);
 
+  /// The copy keeps its own warm start, so it can solve concurrently with us
+  std::shared_ptr<Mapping> clone() const override;
+
   /// When we called setPosition(), we need to run an IK solve. This
   /// sets the limit on the number of iterations of our solver to run.
   void setIKIterationLimit(int limit);
   int getIKIterationLimit();
 
+  /// If true, each IK solve in setPositions() starts from the solution of the
+  /// one before, rather than from all zeros. When consecutive targets are
+  /// close together (like frames of a motion) this converges in far fewer
+  /// iterations, but for under-specified targets the solution then depends
+  /// on the history of calls. False by default.
+  void setIKWarmStart(bool warmStart);
+  bool getIKWarmStart();
+
   /// This adds the spatial (6D) coordinates of a body node to the list,
   /// increasing Dim size by 6
   void addSpatialBodyNode(dynamics::BodyNode* node);
@@ -68,6 +79,18 @@ public:
   void setPositions(
       std::shared_ptr<simulation::World> world,
       const Eigen::Ref<Eigen::VectorXs>& positions) override;
+
+  /// This runs an IK solve for each column of `targets`, and returns the
+  /// "real" positions for each as the columns of the result. This doesn't
+  /// change the state of `world`. The targets are split into contiguous runs,
+  /// one per worker, and each worker solves its run on its own clone of
+  /// `world`. With warm starts on, each target in a run starts from the
+  /// solution of the one before. If `numWorkers` is less than 1, we use one
+  /// worker per hardware thread.
+  Eigen::MatrixXs solvePositions(
+      std::shared_ptr<simulation::World> world,
+      const Eigen::MatrixXs& targets,
+      int numWorkers = -1);
   void setVelocities(
       std::shared_ptr<simulation::World> world,
       const Eigen::Ref<Eigen::VectorXs>& velocities) override;
@@ -148,6 +171,14 @@ protected:
   /// This returns the number of dimensions that the IK mapping represents.
   int getDim();
 
+  /// This runs a damped least-squares IK solve from `initialGuess` to get as
+  /// close as we can to `target`, and returns the positions it found. This
+  /// leaves `world` at those positions.
+  Eigen::VectorXs solveIK(
+      std::shared_ptr<simulation::World> world,
+      const Eigen::VectorXs& target,
+      const Eigen::VectorXs& initialGuess);
+
   /// Computes a Jacobian that transforms changes in joint angle to changes in
   /// IK body positions (expressed in log space).
   Eigen::MatrixXs getPosJacobian(std::shared_ptr<simulation::World> world);
@@ -176,6 +207,10 @@ protected:
 
   int mMassDim;
   int mIKIterationLimit;
+  bool mIKWarmStart;
+
+  /// The positions from the last setPositions() call, to warm start from
+  Eigen::VectorXs mLastIKSolution;
 };
 
 } // namespace neural
@@ -15,6 +15,12 @@ IdentityMapping::IdentityMapping(std::shared_ptr<simulation::World> world)
   mMassDim = world->getMassDims();
 }
 
+//==============================================================================
+std::shared_ptr<Mapping> IdentityMapping::clone() const
+{
+  return std::make_shared<IdentityMapping>(*this);
+}
+
 //==============================================================================
 int IdentityMapping::getPosDim()
 {
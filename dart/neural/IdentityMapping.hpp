@@ -17,6 +17,8 @@ class IdentityMapping : public Mapping
 public:
   IdentityMapping(std::shared_ptr<simulation::World> world);
 
+  std::shared_ptr<Mapping> clone() const override;
+
   int getPosDim() override;
   int getVelDim() override;
   int getControlForceDim() override;
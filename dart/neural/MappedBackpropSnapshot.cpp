@@ -285,6 +285,13 @@ void MappedBackpropSnapshot::backprop(
 #endif
 }
 
+//==============================================================================
+void MappedBackpropSnapshot::precomputeJacobians(
+    simulation::WorldPtr world, PerformanceLog* perfLog)
+{
+  mBackpropSnapshot->precomputeJacobians(world, perfLog);
+}
+
 //==============================================================================
 /// Returns a concatenated vector of all the Skeletons' position()'s in the
 /// World, in order in which the Skeletons appear in the World's
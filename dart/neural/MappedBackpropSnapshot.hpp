@@ -142,6 +142,12 @@ public:
       PerformanceLog* perfLog = nullptr,
       bool exploreAlternateStrategies = false);
 
+  /// This caches the Jacobians that backprop() needs during the forward pass,
+  /// so that backprop() doesn't have to reset the World. See
+  /// BackpropSnapshot::precomputeJacobians().
+  void precomputeJacobians(
+      simulation::WorldPtr world, PerformanceLog* perfLog = nullptr);
+
   /// Returns a concatenated vector of all the Skeletons' position()'s in the
   /// World, in order in which the Skeletons appear in the World's
   /// getSkeleton(i) returns them, BEFORE the timestep.
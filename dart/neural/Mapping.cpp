@@ -18,6 +18,12 @@ Mapping::~Mapping()
 {
 }
 
+//==============================================================================
+std::shared_ptr<Mapping> Mapping::clone() const
+{
+  return nullptr;
+}
+
 //==============================================================================
 /// Check if a Jacobian is equal
 void Mapping::equalsOrCrash(
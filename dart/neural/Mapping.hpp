@@ -23,6 +23,11 @@ public:
 
   virtual ~Mapping();
 
+  /// This returns an independent copy of this mapping, so that a cloned
+  /// trajectory::Problem doesn't share any state (like IKMapping's warm start)
+  /// with the original. Returns nullptr if this mapping can't be copied.
+  virtual std::shared_ptr<Mapping> clone() const;
+
   virtual int getPosDim() = 0;
   virtual int getVelDim() = 0;
   virtual int getControlForceDim() = 0;
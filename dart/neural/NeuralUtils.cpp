@@ -24,7 +24,7 @@ std::shared_ptr<ConstrainedGroupGradientMatrices> createGradientMatrices(
 
 //==============================================================================
 std::shared_ptr<BackpropSnapshot> forwardPass(
-    simulation::WorldPtr world, bool idempotent)
+    simulation::WorldPtr world, bool idempotent, bool precomputeJacobians)
 {
   std::shared_ptr<RestorableSnapshot> restorableSnapshot;
   if (idempotent)
@@ -59,6 +59,9 @@ std::shared_ptr<BackpropSnapshot> forwardPass(
           world->getLastPreConstraintVelocity(),
           preStepLCPCache);
 
+  if (precomputeJacobians)
+    snapshot->precomputeJacobians(world);
+
   if (idempotent)
     restorableSnapshot->restore();
 
@@ -71,7 +74,8 @@ std::shared_ptr<BackpropSnapshot> forwardPass(
 std::shared_ptr<MappedBackpropSnapshot> mappedForwardPass(
     std::shared_ptr<simulation::World> world,
     std::unordered_map<std::string, std::shared_ptr<Mapping>> mappings,
-    bool idempotent)
+    bool idempotent,
+    bool precomputeJacobians)
 {
   std::shared_ptr<RestorableSnapshot> restorableSnapshot;
   if (idempotent)
@@ -124,6 +128,9 @@ std::shared_ptr<MappedBackpropSnapshot> mappedForwardPass(
     postStepMappings[lossMap.first] = post;
   }
 
+  if (precomputeJacobians)
+    snapshot->precomputeJacobians(world);
+
   if (idempotent)
     restorableSnapshot->restore();
 
@@ -47,16 +47,21 @@ std::shared_ptr<ConstrainedGroupGradientMatrices> createGradientMatrices(
     constraint::ConstrainedGroup& group, s_t timeStep);
 
 /// Takes a step in the world, and returns a backprop snapshot which can be used
-/// to backpropagate gradients and compute Jacobians
+/// to backpropagate gradients and compute Jacobians. If
+/// `precomputeJacobians` is true, the snapshot caches everything backprop
+/// needs before returning, so backprop never has to reset the world.
 std::shared_ptr<BackpropSnapshot> forwardPass(
-    std::shared_ptr<simulation::World> world, bool idempotent = false);
+    std::shared_ptr<simulation::World> world,
+    bool idempotent = false,
+    bool precomputeJacobians = false);
 
 /// Takes a step in the world, and returns a mapped snapshot which can be used
 /// to backpropagate gradients and compute Jacobians in the mapped space
 std::shared_ptr<MappedBackpropSnapshot> mappedForwardPass(
     std::shared_ptr<simulation::World> world,
     std::unordered_map<std::string, std::shared_ptr<Mapping>> mappings,
-    bool idempotent = false);
+    bool idempotent = false,
+    bool precomputeJacobians = false);
 
 struct KnotJacobian
 {
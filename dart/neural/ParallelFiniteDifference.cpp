@@ -0,0 +1,392 @@
+#include "dart/neural/ParallelFiniteDifference.hpp"
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include "dart/collision/CollisionFilter.hpp"
+#include "dart/constraint/ConstraintSolver.hpp"
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/Joint.hpp"
+#include "dart/dynamics/ShapeNode.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/neural/WithRespectToMass.hpp"
+#include "dart/simulation/World.hpp"
+
+namespace dart {
+namespace neural {
+
+//==============================================================================
+ParallelFiniteDifference::ParallelFiniteDifference(
+    std::shared_ptr<simulation::World> world, int numWorkers)
+  : mScheme(CENTRAL), mStepSize(1e-7), mCustomStepSize(false)
+{
+  if (numWorkers < 1)
+  {
+    numWorkers = std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  // Before using Eigen in a multi-threaded environment, we need to explicitly
+  // call this (at least prior to Eigen 3.3)
+  Eigen::initParallel();
+
+  for (int i = 0; i < numWorkers; i++)
+  {
+    mWorkers.push_back(world->clone());
+  }
+  syncWorkers(world.get());
+}
+
+//==============================================================================
+int ParallelFiniteDifference::getNumWorkers() const
+{
+  return mWorkers.size();
+}
+
+//==============================================================================
+std::shared_ptr<simulation::World> ParallelFiniteDifference::getWorker(
+    int worker)
+{
+  return mWorkers[worker];
+}
+
+//==============================================================================
+bool ParallelFiniteDifference::isCompatibleWith(simulation::World* world) const
+{
+  for (const std::shared_ptr<simulation::World>& worker : mWorkers)
+  {
+    if (worker->getNumSkeletons() != world->getNumSkeletons()
+        || worker->getNumDofs() != world->getNumDofs()
+        || worker->getMassDims() != world->getMassDims())
+    {
+      return false;
+    }
+    for (std::size_t i = 0; i < world->getNumSkeletons(); i++)
+    {
+      const dynamics::Skeleton* workerSkel = worker->getSkeleton(i).get();
+      const dynamics::Skeleton* skel = world->getSkeleton(i).get();
+      if (workerSkel->getName() != skel->getName()
+          || workerSkel->getNumBodyNodes() != skel->getNumBodyNodes()
+          || workerSkel->getNumShapeNodes() != skel->getNumShapeNodes())
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//==============================================================================
+void ParallelFiniteDifference::syncWorkers(simulation::World* world)
+{
+  constraint::ConstraintSolver* solver = world->getConstraintSolver();
+  bool gradientEnabled = solver->getGradientEnabled();
+  const collision::CollisionOption& collisionOption
+      = solver->getCollisionOption();
+  std::shared_ptr<collision::BodyNodeCollisionFilter> filter
+      = std::dynamic_pointer_cast<collision::BodyNodeCollisionFilter>(
+          collisionOption.collisionFilter);
+  Eigen::VectorXs masses = world->getMasses();
+  for (const std::shared_ptr<simulation::World>& worker : mWorkers)
+  {
+    worker->setTimeStep(world->getTimeStep());
+    worker->setGravity(world->getGravity());
+    worker->setPenetrationCorrectionEnabled(
+        world->getPenetrationCorrectionEnabled());
+    worker->setContactClippingDepth(world->getContactClippingDepth());
+    worker->setFallbackConstraintForceMixingConstant(
+        world->getFallbackConstraintForceMixingConstant());
+    worker->setParallelVelocityAndPositionUpdates(
+        world->getParallelVelocityAndPositionUpdates());
+    worker->setUseFastFeatherstone(world->getUseFastFeatherstone());
+    worker->getConstraintSolver()->setGradientEnabled(gradientEnabled);
+
+    for (std::size_t i = 0; i < world->getNumSkeletons(); i++)
+    {
+      syncSkeleton(
+          worker->getSkeleton(i).get(), world->getSkeleton(i).get());
+    }
+
+    // The blacklist holds BodyNodes of the original world, so translate them
+    // to the worker's copies by skeleton name and index
+    collision::CollisionOption& workerOption
+        = worker->getConstraintSolver()->getCollisionOption();
+    workerOption.enableContact = collisionOption.enableContact;
+    workerOption.maxNumContacts = collisionOption.maxNumContacts;
+    std::shared_ptr<collision::BodyNodeCollisionFilter> workerFilter
+        = std::dynamic_pointer_cast<collision::BodyNodeCollisionFilter>(
+            workerOption.collisionFilter);
+    if (filter && workerFilter)
+    {
+      simulation::World* workerWorld = worker.get();
+      workerFilter->setBlackListFrom(
+          *filter,
+          [workerWorld](
+              const dynamics::BodyNode* body) -> const dynamics::BodyNode* {
+            dynamics::SkeletonPtr skel
+                = workerWorld->getSkeleton(body->getSkeleton()->getName());
+            if (!skel)
+              return nullptr;
+            return skel->getBodyNode(body->getIndexInSkeleton());
+          });
+    }
+    if (masses.size() > 0)
+    {
+      worker->setMasses(masses);
+    }
+    worker->setPositions(world->getPositions());
+    worker->setVelocities(world->getVelocities());
+    worker->setControlForces(world->getControlForces());
+    worker->setCachedLCPSolution(world->getCachedLCPSolution());
+  }
+}
+
+//==============================================================================
+void ParallelFiniteDifference::syncSkeleton(
+    dynamics::Skeleton* worker, const dynamics::Skeleton* original)
+{
+  worker->setAspectProperties(original->getSkeletonProperties());
+
+  for (std::size_t i = 0; i < original->getNumJoints(); i++)
+  {
+    const dynamics::Joint* originalJoint = original->getJoint(i);
+    dynamics::Joint* workerJoint = worker->getJoint(i);
+    workerJoint->setCompositeProperties(
+        originalJoint->getCompositeProperties());
+
+    // That copied the original's mimic joint pointer, so point it back at our
+    // own joint of the same name, like Skeleton::cloneSkeleton() does
+    const dynamics::Joint* mimicJoint = originalJoint->getMimicJoint();
+    if (mimicJoint != nullptr)
+    {
+      workerJoint->setMimicJoint(
+          worker->getJoint(mimicJoint->getName()),
+          originalJoint->getMimicMultiplier(),
+          originalJoint->getMimicOffset());
+    }
+  }
+
+  for (std::size_t i = 0; i < original->getNumBodyNodes(); i++)
+  {
+    const dynamics::BodyNode* originalBody = original->getBodyNode(i);
+    dynamics::BodyNode* workerBody = worker->getBodyNode(i);
+    workerBody->setCompositeProperties(originalBody->getCompositeProperties());
+    // This is where the external forces live
+    workerBody->setAspectState(originalBody->getAspectState());
+  }
+
+  for (std::size_t i = 0; i < original->getNumShapeNodes(); i++)
+  {
+    worker->getShapeNode(i)->setCompositeProperties(
+        original->getShapeNode(i)->getCompositeProperties());
+  }
+}
+
+//==============================================================================
+void ParallelFiniteDifference::setScheme(Scheme scheme)
+{
+  mScheme = scheme;
+  if (!mCustomStepSize)
+  {
+    mStepSize = scheme == RIDDERS ? 1e-3 : 1e-7;
+  }
+}
+
+//==============================================================================
+void ParallelFiniteDifference::setStepSize(s_t stepSize)
+{
+  mStepSize = stepSize;
+  mCustomStepSize = true;
+}
+
+//==============================================================================
+Eigen::MatrixXs ParallelFiniteDifference::jacobian(
+    const Eigen::VectorXs& x, int outputDim, const Evaluation& eval)
+{
+  const int cols = x.size();
+  Eigen::MatrixXs J = Eigen::MatrixXs::Zero(outputDim, cols);
+  const int numWorkers = std::min((int)mWorkers.size(), cols);
+
+  if (numWorkers <= 1)
+  {
+    for (int col = 0; col < cols; col++)
+    {
+      computeColumn(0, col, x, outputDim, eval, J);
+    }
+    return J;
+  }
+
+  // Workers pull columns off a shared counter, so a worker that draws a column
+  // that needs lots of step halving doesn't hold up the others
+  std::atomic<int> nextCol(0);
+  std::vector<std::future<void>> futures;
+  for (int worker = 0; worker < numWorkers; worker++)
+  {
+    futures.push_back(std::async(std::launch::async, [&, worker]() {
+      for (int col = nextCol++; col < cols; col = nextCol++)
+      {
+        computeColumn(worker, col, x, outputDim, eval, J);
+      }
+    }));
+  }
+  for (int i = 0; i < futures.size(); i++)
+  {
+    futures[i].wait();
+  }
+  return J;
+}
+
+//==============================================================================
+void ParallelFiniteDifference::computeColumn(
+    int worker,
+    int col,
+    const Eigen::VectorXs& x,
+    int outputDim,
+    const Evaluation& eval,
+    Eigen::MatrixXs& J)
+{
+  if (mScheme == RIDDERS)
+    riddersColumn(worker, col, x, outputDim, eval, J);
+  else
+    centralColumn(worker, col, x, outputDim, eval, J);
+}
+
+//==============================================================================
+void ParallelFiniteDifference::centralColumn(
+    int worker,
+    int col,
+    const Eigen::VectorXs& x,
+    int outputDim,
+    const Evaluation& eval,
+    Eigen::MatrixXs& J)
+{
+  simulation::World* world = mWorkers[worker].get();
+  Eigen::VectorXs perturbed = x;
+  Eigen::VectorXs plus = Eigen::VectorXs::Zero(outputDim);
+  Eigen::VectorXs minus = Eigen::VectorXs::Zero(outputDim);
+
+  s_t epsPlus = mStepSize;
+  while (true)
+  {
+    perturbed(col) = x(col) + epsPlus;
+    if (eval(worker, world, perturbed, plus))
+      break;
+    epsPlus *= 0.5;
+    if (abs(epsPlus) <= 1e-20)
+    {
+      assert(false && "Couldn't find a step that eval() accepts");
+      break;
+    }
+  }
+
+  s_t epsMinus = mStepSize;
+  while (true)
+  {
+    perturbed(col) = x(col) - epsMinus;
+    if (eval(worker, world, perturbed, minus))
+      break;
+    epsMinus *= 0.5;
+    if (abs(epsMinus) <= 1e-20)
+    {
+      assert(false && "Couldn't find a step that eval() accepts");
+      break;
+    }
+  }
+
+  J.col(col) = (plus - minus) / (epsPlus + epsMinus);
+}
+
+//==============================================================================
+void ParallelFiniteDifference::riddersColumn(
+    int worker,
+    int col,
+    const Eigen::VectorXs& x,
+    int outputDim,
+    const Evaluation& eval,
+    Eigen::MatrixXs& J)
+{
+  const s_t con = 1.4, con2 = (con * con);
+  const s_t safeThreshold = 2.0;
+  const int tabSize = 10;
+
+  simulation::World* world = mWorkers[worker].get();
+  Eigen::VectorXs perturbed = x;
+  Eigen::VectorXs plus = Eigen::VectorXs::Zero(outputDim);
+  Eigen::VectorXs minus = Eigen::VectorXs::Zero(outputDim);
+
+  // Neville tableau of finite difference results
+  std::array<std::array<Eigen::VectorXs, tabSize>, tabSize> tab;
+
+  // Find the largest original step size that eval() accepts on both sides
+  s_t stepSize = mStepSize;
+  while (true)
+  {
+    perturbed(col) = x(col) + stepSize;
+    bool plusOk = eval(worker, world, perturbed, plus);
+    perturbed(col) = x(col) - stepSize;
+    bool minusOk = eval(worker, world, perturbed, minus);
+    if (plusOk && minusOk)
+      break;
+    stepSize *= 0.5;
+    if (abs(stepSize) <= 1e-20)
+    {
+      assert(false && "Couldn't find a step that eval() accepts");
+      break;
+    }
+  }
+  tab[0][0] = (plus - minus) / (2 * stepSize);
+  J.col(col) = tab[0][0];
+
+  s_t bestError = std::numeric_limits<s_t>::max();
+
+  // Iterate over smaller and smaller step sizes
+  for (int iTab = 1; iTab < tabSize; iTab++)
+  {
+    stepSize /= con;
+
+    perturbed(col) = x(col) + stepSize;
+    bool plusOk = eval(worker, world, perturbed, plus);
+    perturbed(col) = x(col) - stepSize;
+    bool minusOk = eval(worker, world, perturbed, minus);
+    if (!plusOk || !minusOk)
+    {
+      // A smaller step shouldn't leave the region the bigger one was accepted
+      // in, but if it does then the estimates we have are the best we'll get
+      break;
+    }
+
+    tab[0][iTab] = (plus - minus) / (2 * stepSize);
+
+    s_t fac = con2;
+    // Compute extrapolations of increasing orders, requiring no new
+    // evaluations
+    for (int jTab = 1; jTab <= iTab; jTab++)
+    {
+      tab[jTab][iTab] = (tab[jTab - 1][iTab] * fac - tab[jTab - 1][iTab - 1])
+                        / (fac - 1.0);
+      fac = con2 * fac;
+      s_t currError = std::max(
+          (tab[jTab][iTab] - tab[jTab - 1][iTab]).array().abs().maxCoeff(),
+          (tab[jTab][iTab] - tab[jTab - 1][iTab - 1])
+              .array()
+              .abs()
+              .maxCoeff());
+      if (currError < bestError)
+      {
+        bestError = currError;
+        J.col(col) = tab[jTab][iTab];
+      }
+    }
+
+    // If higher order is worse by a significant factor, quit early.
+    if ((tab[iTab][iTab] - tab[iTab - 1][iTab - 1]).array().abs().maxCoeff()
+        >= safeThreshold * bestError)
+    {
+      break;
+    }
+  }
+}
+
+} // namespace neural
+} // namespace dart
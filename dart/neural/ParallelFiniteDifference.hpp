@@ -0,0 +1,179 @@
+#ifndef DART_NEURAL_PARALLEL_FINITE_DIFFERENCE_HPP_
+#define DART_NEURAL_PARALLEL_FINITE_DIFFERENCE_HPP_
+
+#include <complex>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/math/MathTypes.hpp"
+
+namespace dart {
+
+namespace dynamics {
+class Skeleton;
+}
+
+namespace simulation {
+class World;
+}
+
+namespace neural {
+
+/*
+ * This computes finite difference Jacobians one column per worker, on a pool
+ * of clones of a World. Every column is independent of the others, so with W
+ * workers a Jacobian costs about 1/W of the wall-clock time of perturbing the
+ * original World column by column. The clones are made once, when the pool is
+ * created, and synced to the source World's state and properties before each
+ * Jacobian, which is much cheaper than cloning again.
+ *
+ * The pool doesn't know what's being differentiated. Callers pass an
+ * Evaluation, which sets up a clone from some input vector (usually starting
+ * from a pre-step snapshot), runs it, and reads out the result.
+ */
+class ParallelFiniteDifference
+{
+public:
+  enum Scheme
+  {
+    /// (f(x + h) - f(x - h)) / 2h, with h halved on each side until the
+    /// Evaluation accepts it
+    CENTRAL = 0,
+    /// Central differences at a shrinking sequence of step sizes, extrapolated
+    /// to h = 0 with a Neville tableau
+    RIDDERS = 1
+  };
+
+  /// This evaluates the function at `input` on `world`, writing the result
+  /// into `output`. It returns false if `input` lands somewhere the function
+  /// isn't smooth relative to the unperturbed input (for example, if a contact
+  /// was made or broken), in which case we retry with a smaller step.
+  /// `worker` identifies which clone `world` is, for callers that need their
+  /// own per-worker state.
+  typedef std::function<bool(
+      int worker,
+      simulation::World* world,
+      const Eigen::VectorXs& input,
+      Eigen::VectorXs& output)>
+      Evaluation;
+
+  /// This clones `world` once per worker. If `numWorkers` is less than 1, we
+  /// use one worker per hardware thread.
+  ParallelFiniteDifference(
+      std::shared_ptr<simulation::World> world, int numWorkers = -1);
+
+  /// Returns the number of clones, and so the most columns we'll compute at
+  /// once
+  int getNumWorkers() const;
+
+  /// Returns the clone used by `worker`
+  std::shared_ptr<simulation::World> getWorker(int worker);
+
+  /// Returns true if the clones still have the same structure as `world`, so
+  /// syncing them is enough to make them equivalent. If this is false, the pool
+  /// needs to be rebuilt.
+  bool isCompatibleWith(simulation::World* world) const;
+
+  /// This copies the state, masses, timestep, gravity and solver settings of
+  /// `world` onto every clone, along with everything else a fresh clone would
+  /// pick up: the properties of every Joint, BodyNode and ShapeNode (limits,
+  /// springs, damping, actuator types, inertia, friction, restitution,
+  /// collidability), external forces, and the collision filter's blacklist.
+  void syncWorkers(simulation::World* world);
+
+  /// This sets which scheme jacobian() uses. Defaults to CENTRAL.
+  void setScheme(Scheme scheme);
+
+  /// This sets the (largest) step size used by jacobian(). Defaults to 1e-7 for
+  /// CENTRAL, and 1e-3 for RIDDERS.
+  void setStepSize(s_t stepSize);
+
+  /// This computes the Jacobian of the function that `eval` computes, at `x`.
+  /// The output of `eval` must be `outputDim` long. Columns are spread across
+  /// the workers, and computed in whatever order they finish.
+  Eigen::MatrixXs jacobian(
+      const Eigen::VectorXs& x, int outputDim, const Evaluation& eval);
+
+  /// This computes the Jacobian of `f` at `x` by the complex step method,
+  /// Im(f(x + ih)) / h. There's no subtractive cancellation, so `h` can be tiny
+  /// and the result is accurate to machine precision. This needs `f` to be
+  /// written generically enough to run on complex numbers, which rules out
+  /// stepping a World, so this is for closed form functions.
+  template <typename Function>
+  static Eigen::MatrixXs complexStepJacobian(
+      Function f, const Eigen::VectorXs& x, int outputDim, s_t h = 1e-20);
+
+protected:
+  /// This copies the properties and external forces of `original` onto
+  /// `worker`, which must have the same structure
+  static void syncSkeleton(
+      dynamics::Skeleton* worker, const dynamics::Skeleton* original);
+
+  /// This computes column `col` of the Jacobian on worker `worker`
+  void computeColumn(
+      int worker,
+      int col,
+      const Eigen::VectorXs& x,
+      int outputDim,
+      const Evaluation& eval,
+      Eigen::MatrixXs& J);
+
+  /// This is the central difference scheme, halving the step on either side
+  /// until `eval` accepts it
+  void centralColumn(
+      int worker,
+      int col,
+      const Eigen::VectorXs& x,
+      int outputDim,
+      const Evaluation& eval,
+      Eigen::MatrixXs& J);
+
+  /// This is Ridders' extrapolation, with the same tableau as the serial
+  /// BackpropSnapshot::finiteDifferenceRidders*() methods
+  void riddersColumn(
+      int worker,
+      int col,
+      const Eigen::VectorXs& x,
+      int outputDim,
+      const Evaluation& eval,
+      Eigen::MatrixXs& J);
+
+  std::vector<std::shared_ptr<simulation::World>> mWorkers;
+  Scheme mScheme;
+  s_t mStepSize;
+  bool mCustomStepSize;
+};
+
+//==============================================================================
+template <typename Function>
+Eigen::MatrixXs ParallelFiniteDifference::complexStepJacobian(
+    Function f, const Eigen::VectorXs& x, int outputDim, s_t h)
+{
+  typedef Eigen::Matrix<std::complex<s_t>, Eigen::Dynamic, 1> VectorXcs;
+
+  Eigen::MatrixXs J(outputDim, x.size());
+  std::vector<std::future<void>> futures;
+  for (int col = 0; col < x.size(); col++)
+  {
+    futures.push_back(std::async(std::launch::async, [&, col]() {
+      VectorXcs perturbed = x.cast<std::complex<s_t>>();
+      perturbed(col) += std::complex<s_t>(0, h);
+      VectorXcs result = f(perturbed);
+      J.col(col) = result.imag() / h;
+    }));
+  }
+  for (int i = 0; i < futures.size(); i++)
+  {
+    futures[i].wait();
+  }
+  return J;
+}
+
+} // namespace neural
+} // namespace dart
+
+#endif
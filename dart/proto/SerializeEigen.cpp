@@ -1,52 +1,159 @@
 #include "dart/proto/SerializeEigen.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "dart/common/Console.hpp"
+
 namespace dart {
 namespace proto {
 
-void serializeVector(proto::VectorXs& proto, const Eigen::VectorXs& vec)
+namespace {
+
+bool isLittleEndian()
 {
-  proto.set_size(vec.size());
-  for (int i = 0; i < vec.size(); i++)
+  const uint16_t one = 1;
+  return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+/// This writes `size` scalars into `out` as little-endian `Packed` values
+template <typename Packed>
+void packScalars(std::string& out, const s_t* data, int size)
+{
+  out.resize(size * sizeof(Packed));
+  char* cursor = &out[0];
+  if (std::is_same<Packed, s_t>::value && isLittleEndian())
+  {
+    std::memcpy(cursor, data, size * sizeof(Packed));
+    return;
+  }
+  const bool swap = !isLittleEndian();
+  for (int i = 0; i < size; i++)
   {
-    proto.add_values(static_cast<double>(vec(i)));
+    Packed value = static_cast<Packed>(data[i]);
+    char* bytes = reinterpret_cast<char*>(&value);
+    if (swap)
+      std::reverse(bytes, bytes + sizeof(Packed));
+    std::memcpy(cursor, bytes, sizeof(Packed));
+    cursor += sizeof(Packed);
   }
 }
 
-Eigen::VectorXs deserializeVector(const proto::VectorXs& proto)
+/// This reads `size` little-endian `Packed` values from `in` into `data`
+template <typename Packed>
+bool unpackScalars(const std::string& in, s_t* data, int size)
 {
-  Eigen::VectorXs recovered = Eigen::VectorXs::Zero(proto.size());
-  for (int i = 0; i < proto.size(); i++)
+  if (in.size() != size * sizeof(Packed))
   {
-    recovered(i) = static_cast<s_t>(proto.values(i));
+    dterr << "[dart::proto] Packed Eigen data has " << in.size()
+          << " bytes, but expected " << size * sizeof(Packed) << ".\n";
+    return false;
   }
-  return recovered;
+  const char* cursor = in.data();
+  if (std::is_same<Packed, s_t>::value && isLittleEndian())
+  {
+    std::memcpy(data, cursor, size * sizeof(Packed));
+    return true;
+  }
+  const bool swap = !isLittleEndian();
+  for (int i = 0; i < size; i++)
+  {
+    Packed value;
+    char* bytes = reinterpret_cast<char*>(&value);
+    std::memcpy(bytes, cursor, sizeof(Packed));
+    if (swap)
+      std::reverse(bytes, bytes + sizeof(Packed));
+    data[i] = static_cast<s_t>(value);
+    cursor += sizeof(Packed);
+  }
+  return true;
 }
 
-void serializeMatrix(proto::MatrixXs& proto, const Eigen::MatrixXs& mat)
+/// This fills in the scalars of a VectorXs or MatrixXs message. Eigen stores
+/// matrices column-major, which is the order `values` has always used.
+template <typename Message>
+void serializeScalars(
+    Message& proto, const s_t* data, int size, proto::EigenEncoding encoding)
 {
-  proto.set_rows(mat.rows());
-  proto.set_cols(mat.cols());
-  for (int col = 0; col < mat.cols(); col++)
+  proto.set_encoding(encoding);
+  proto.clear_values();
+  proto.clear_packed();
+  if (encoding == proto::PACKED_FLOAT64)
   {
-    for (int row = 0; row < mat.rows(); row++)
+    packScalars<double>(*proto.mutable_packed(), data, size);
+  }
+  else if (encoding == proto::PACKED_FLOAT32)
+  {
+    packScalars<float>(*proto.mutable_packed(), data, size);
+  }
+  else
+  {
+    proto.mutable_values()->Reserve(size);
+    for (int i = 0; i < size; i++)
     {
-      proto.add_values(static_cast<double>(mat(row, col)));
+      proto.add_values(static_cast<double>(data[i]));
     }
   }
 }
 
-Eigen::MatrixXs deserializeMatrix(const proto::MatrixXs& proto)
+/// This reads the scalars of a VectorXs or MatrixXs message, in any encoding
+template <typename Message>
+void deserializeScalars(const Message& proto, s_t* data, int size)
 {
-  Eigen::MatrixXs recovered = Eigen::MatrixXs::Zero(proto.rows(), proto.cols());
-  int cursor = 0;
-  for (int col = 0; col < proto.cols(); col++)
+  if (proto.encoding() == proto::PACKED_FLOAT64)
   {
-    for (int row = 0; row < proto.rows(); row++)
+    if (!unpackScalars<double>(proto.packed(), data, size))
+      std::fill(data, data + size, s_t(0));
+  }
+  else if (proto.encoding() == proto::PACKED_FLOAT32)
+  {
+    if (!unpackScalars<float>(proto.packed(), data, size))
+      std::fill(data, data + size, s_t(0));
+  }
+  else
+  {
+    for (int i = 0; i < size; i++)
     {
-      recovered(row, col) = static_cast<s_t>(proto.values(cursor));
-      cursor++;
+      data[i] = static_cast<s_t>(proto.values(i));
     }
   }
+}
+
+} // namespace
+
+void serializeVector(
+    proto::VectorXs& proto,
+    const Eigen::VectorXs& vec,
+    proto::EigenEncoding encoding)
+{
+  proto.set_size(vec.size());
+  serializeScalars(proto, vec.data(), vec.size(), encoding);
+}
+
+Eigen::VectorXs deserializeVector(const proto::VectorXs& proto)
+{
+  Eigen::VectorXs recovered(proto.size());
+  deserializeScalars(proto, recovered.data(), proto.size());
+  return recovered;
+}
+
+void serializeMatrix(
+    proto::MatrixXs& proto,
+    const Eigen::MatrixXs& mat,
+    proto::EigenEncoding encoding)
+{
+  proto.set_rows(mat.rows());
+  proto.set_cols(mat.cols());
+  serializeScalars(proto, mat.data(), mat.size(), encoding);
+}
+
+Eigen::MatrixXs deserializeMatrix(const proto::MatrixXs& proto)
+{
+  Eigen::MatrixXs recovered(proto.rows(), proto.cols());
+  deserializeScalars(proto, recovered.data(), proto.rows() * proto.cols());
   return recovered;
 }
 
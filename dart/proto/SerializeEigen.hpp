@@ -9,10 +9,21 @@
 namespace dart {
 namespace proto {
 
-void serializeVector(proto::VectorXs& proto, const Eigen::VectorXs& vec);
+/// The packed encodings copy the scalars into a single bytes field (a straight
+/// memcpy on little-endian hosts), which is much faster to encode and parse
+/// than one `repeated double` entry per scalar. PACKED_FLOAT32 additionally
+/// quantizes to float32. The deserializers read any encoding, including
+/// messages written before packed encodings existed.
+void serializeVector(
+    proto::VectorXs& proto,
+    const Eigen::VectorXs& vec,
+    proto::EigenEncoding encoding = proto::PACKED_FLOAT64);
 Eigen::VectorXs deserializeVector(const proto::VectorXs& proto);
 
-void serializeMatrix(proto::MatrixXs& proto, const Eigen::MatrixXs& mat);
+void serializeMatrix(
+    proto::MatrixXs& proto,
+    const Eigen::MatrixXs& mat,
+    proto::EigenEncoding encoding = proto::PACKED_FLOAT64);
 Eigen::MatrixXs deserializeMatrix(const proto::MatrixXs& proto);
 
 } // namespace proto
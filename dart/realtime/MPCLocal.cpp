@@ -7,6 +7,7 @@
 
 #include "dart/performance/PerformanceLog.hpp"
 #include "dart/proto/SerializeEigen.hpp"
+#include "dart/realtime/MPCSharedMemory.hpp"
 #include "dart/realtime/Millis.hpp"
 #include "dart/realtime/RealTimeControlBuffer.hpp"
 #include "dart/simulation/World.hpp"
@@ -410,6 +411,77 @@ void MPCLocal::serve(int port)
   server->Wait();
 }
 
+/// This serves this planner to an MPCSharedMemoryRemote on the same host,
+/// through the shared memory segment `name`. This call blocks until the
+/// remote closes the channel.
+void MPCLocal::serveSharedMemory(const std::string& name)
+{
+  std::shared_ptr<MPCSharedMemoryChannel> channel
+      = MPCSharedMemoryChannel::create(
+          name,
+          mWorld->getNumDofs(),
+          mWorld->getMassDims(),
+          mSteps,
+          mMillisPerStep);
+  if (!channel)
+    return;
+  std::cout << "Serving MPC on shared memory " << name << std::endl;
+
+  // Listeners only ever get appended, so this is where ours will stay
+  const std::size_t listenerIndex = mReplannedListeners.size();
+  registerReplanningListener(
+      [channel](
+          long startTime,
+          const trajectory::TrajectoryRollout* rollout,
+          long replanDurationMillis) {
+        channel->publishPlan(startTime, replanDurationMillis, rollout);
+      });
+
+  MPCSharedMemoryChannel::Observation observation;
+  long lastRunningRequest = 0;
+  while (!channel->isClosed())
+  {
+    bool idle = true;
+    while (channel->popObservation(observation))
+    {
+      idle = false;
+      if (observation.type == MPCSharedMemoryChannel::GROUND_TRUTH_STATE)
+      {
+        recordGroundTruthState(
+            observation.time,
+            observation.pos,
+            observation.vel,
+            observation.mass);
+      }
+      else
+      {
+        mBuffer.manuallyRecordObservedForce(
+            observation.time, observation.force);
+      }
+    }
+
+    bool running;
+    if (channel->pollRunningRequest(lastRunningRequest, running))
+    {
+      idle = false;
+      if (running)
+        start();
+      else
+        stop();
+    }
+
+    if (idle)
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+
+  stop();
+  // The optimization thread has finished, so nothing is calling the listeners
+  // while we take ours out. Otherwise later replans would keep publishing into
+  // a segment nobody reads, and keep it mapped.
+  mReplannedListeners.erase(mReplannedListeners.begin() + listenerIndex);
+  channel->unlink();
+}
+
 ///////////////////////////////////////////////////////////////////////
 /// Implements the gRPC API
 ///////////////////////////////////////////////////////////////////////
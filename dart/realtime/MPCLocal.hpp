@@ -31,6 +31,7 @@ class MPCLocal final : public MPC
 {
 
   friend class MPCRemote;
+  friend class MPCSharedMemoryRemote;
 
 public:
   MPCLocal(
@@ -137,6 +138,11 @@ public:
   /// indefinitely, until the program is killed with Ctrl+C
   void serve(int port);
 
+  /// This serves this planner to an MPCSharedMemoryRemote on the same host,
+  /// through the shared memory segment `name`. This call blocks until the
+  /// remote closes the channel.
+  void serveSharedMemory(const std::string& name);
+
 protected:
   /// This is the function for the optimization thread to run when we're live
   void optimizationThreadLoop();
@@ -0,0 +1,771 @@
+#include "dart/realtime/MPCSharedMemory.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "dart/common/Console.hpp"
+#include "dart/realtime/MPCLocal.hpp"
+#include "dart/realtime/Millis.hpp"
+#include "dart/simulation/World.hpp"
+#include "dart/trajectory/TrajectoryRollout.hpp"
+
+static_assert(
+    ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "MPCSharedMemoryChannel needs lock-free atomics, since they're shared "
+    "across processes");
+
+namespace dart {
+namespace realtime {
+
+namespace {
+
+const uint32_t SEGMENT_MAGIC = 0x4E4D5043; // "NMPC"
+const uint32_t SEGMENT_VERSION = 2;
+const int NUM_PLAN_SLOTS = 3;
+const std::size_t CACHE_LINE = 64;
+
+std::size_t alignToCacheLine(std::size_t bytes)
+{
+  return (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+/// shm_open() names need a single leading slash
+std::string normalizeName(const std::string& name)
+{
+  if (!name.empty() && name[0] == '/')
+    return name;
+  return "/" + name;
+}
+
+/// The fixed-size prefix of every observation slot, followed by the doubles
+struct ObservationSlotHeader
+{
+  /// For the slot at ring index i, this is i when the slot is free for the
+  /// producer claiming ring position i, i + 1 once that producer has filled it
+  /// in, and i + capacity once the consumer is done with it again
+  std::atomic<uint64_t> sequence;
+  int32_t type;
+  int32_t padding;
+  int64_t time;
+};
+
+/// The fixed-size prefix of every plan slot, followed by the doubles
+struct PlanSlotHeader
+{
+  /// This is odd while the slot is being written, and gets bumped by two
+  /// every time the slot is reused
+  std::atomic<uint64_t> sequence;
+  int64_t startTime;
+  int64_t replanDurationMillis;
+  int32_t numSteps;
+  int32_t padding;
+};
+
+void writeDoubles(double* out, const Eigen::VectorXs& vec, int size)
+{
+  for (int i = 0; i < size; i++)
+  {
+    out[i] = static_cast<double>(vec(i));
+  }
+}
+
+void readDoubles(const double* in, Eigen::VectorXs& vec, int size)
+{
+  if (vec.size() != size)
+    vec.resize(size);
+  for (int i = 0; i < size; i++)
+  {
+    vec(i) = static_cast<s_t>(in[i]);
+  }
+}
+
+} // namespace
+
+/// The segment starts with this header, followed by OBSERVATION_CAPACITY
+/// observation slots and then NUM_PLAN_SLOTS plan slots. The producer and
+/// consumer indices live on separate cache lines so the two sides don't
+/// false-share them.
+struct MPCSharedMemoryChannel::Header
+{
+  std::atomic<uint32_t> ready;
+  uint32_t magic;
+  uint32_t version;
+  int32_t dofs;
+  int32_t massDim;
+  int32_t steps;
+  int32_t millisPerStep;
+  int32_t observationCapacity;
+  uint64_t observationStride;
+  uint64_t planStride;
+  uint64_t observationsOffset;
+  uint64_t plansOffset;
+  uint64_t totalBytes;
+
+  alignas(64) std::atomic<uint64_t> observationHead;
+  alignas(64) std::atomic<uint64_t> observationTail;
+  alignas(64) std::atomic<uint64_t> droppedObservations;
+  std::atomic<uint64_t> runningRequests;
+  std::atomic<uint32_t> runningRequested;
+  std::atomic<uint32_t> closed;
+  std::atomic<int32_t> activePlan;
+  std::atomic<uint64_t> planVersion;
+};
+
+constexpr int MPCSharedMemoryChannel::OBSERVATION_CAPACITY;
+
+std::shared_ptr<MPCSharedMemoryChannel> MPCSharedMemoryChannel::create(
+    const std::string& name,
+    int dofs,
+    int massDim,
+    int steps,
+    int millisPerStep)
+{
+  std::string shmName = normalizeName(name);
+
+  // Ground truth states are the largest observations: pos, vel and mass
+  std::size_t observationStride = alignToCacheLine(
+      sizeof(ObservationSlotHeader) + sizeof(double) * (2 * dofs + massDim));
+  // Plans hold poses, vels and forces, followed by the masses
+  std::size_t planStride = alignToCacheLine(
+      sizeof(PlanSlotHeader)
+      + sizeof(double) * (3 * dofs * steps + massDim));
+  std::size_t observationsOffset = alignToCacheLine(sizeof(Header));
+  std::size_t plansOffset
+      = observationsOffset + OBSERVATION_CAPACITY * observationStride;
+  std::size_t totalBytes = plansOffset + NUM_PLAN_SLOTS * planStride;
+
+  // Clear out anything left behind by a planner that crashed
+  shm_unlink(shmName.c_str());
+  int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+  {
+    dterr << "[MPCSharedMemoryChannel::create] shm_open(\"" << shmName
+          << "\") failed: " << std::strerror(errno) << "\n";
+    return nullptr;
+  }
+  if (ftruncate(fd, totalBytes) != 0)
+  {
+    dterr << "[MPCSharedMemoryChannel::create] ftruncate() failed: "
+          << std::strerror(errno) << "\n";
+    ::close(fd);
+    shm_unlink(shmName.c_str());
+    return nullptr;
+  }
+  void* memory
+      = mmap(nullptr, totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED)
+  {
+    dterr << "[MPCSharedMemoryChannel::create] mmap() failed: "
+          << std::strerror(errno) << "\n";
+    ::close(fd);
+    shm_unlink(shmName.c_str());
+    return nullptr;
+  }
+
+  // ftruncate() zero-fills the segment, so we only need to construct the
+  // atomics and fill in the layout
+  Header* header = new (memory) Header();
+  header->magic = SEGMENT_MAGIC;
+  header->version = SEGMENT_VERSION;
+  header->dofs = dofs;
+  header->massDim = massDim;
+  header->steps = steps;
+  header->millisPerStep = millisPerStep;
+  header->observationCapacity = OBSERVATION_CAPACITY;
+  header->observationStride = observationStride;
+  header->planStride = planStride;
+  header->observationsOffset = observationsOffset;
+  header->plansOffset = plansOffset;
+  header->totalBytes = totalBytes;
+  header->observationHead.store(0);
+  header->observationTail.store(0);
+  header->droppedObservations.store(0);
+  header->runningRequests.store(0);
+  header->runningRequested.store(0);
+  header->closed.store(0);
+  header->activePlan.store(-1);
+  header->planVersion.store(0);
+
+  std::shared_ptr<MPCSharedMemoryChannel> channel(
+      new MPCSharedMemoryChannel(shmName, fd, memory, totalBytes));
+  channel->mOwner = true;
+  for (int i = 0; i < OBSERVATION_CAPACITY; i++)
+  {
+    new (channel->observationSlot(i)) ObservationSlotHeader();
+    reinterpret_cast<ObservationSlotHeader*>(channel->observationSlot(i))
+        ->sequence.store(i);
+  }
+  for (int i = 0; i < NUM_PLAN_SLOTS; i++)
+  {
+    new (channel->planSlot(i)) PlanSlotHeader();
+    reinterpret_cast<PlanSlotHeader*>(channel->planSlot(i))
+        ->sequence.store(0);
+  }
+
+  // Publish the layout to processes that are waiting to attach
+  header->ready.store(1, std::memory_order_release);
+  return channel;
+}
+
+std::shared_ptr<MPCSharedMemoryChannel> MPCSharedMemoryChannel::open(
+    const std::string& name, long timeoutMillis)
+{
+  std::string shmName = normalizeName(name);
+  long deadline = timeSinceEpochMillis() + timeoutMillis;
+
+  // The planner may still be starting up, so poll until the segment exists
+  // and its header has been filled in
+  while (true)
+  {
+    int fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+    if (fd >= 0)
+    {
+      struct stat info;
+      if (fstat(fd, &info) == 0
+          && static_cast<std::size_t>(info.st_size) >= sizeof(Header))
+      {
+        void* memory = mmap(
+            nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory != MAP_FAILED)
+        {
+          Header* header = reinterpret_cast<Header*>(memory);
+          if (header->ready.load(std::memory_order_acquire) == 1)
+          {
+            if (header->magic != SEGMENT_MAGIC
+                || header->version != SEGMENT_VERSION
+                || header->totalBytes != static_cast<uint64_t>(info.st_size))
+            {
+              dterr << "[MPCSharedMemoryChannel::open] \"" << shmName
+                    << "\" is not a compatible MPC shared memory segment.\n";
+              munmap(memory, info.st_size);
+              ::close(fd);
+              return nullptr;
+            }
+            return std::shared_ptr<MPCSharedMemoryChannel>(
+                new MPCSharedMemoryChannel(shmName, fd, memory, info.st_size));
+          }
+          munmap(memory, info.st_size);
+        }
+      }
+      ::close(fd);
+    }
+
+    if (timeSinceEpochMillis() >= deadline)
+    {
+      dterr << "[MPCSharedMemoryChannel::open] Timed out waiting for \""
+            << shmName << "\".\n";
+      return nullptr;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+MPCSharedMemoryChannel::MPCSharedMemoryChannel(
+    const std::string& name, int fd, void* memory, std::size_t bytes)
+  : mName(name), mFd(fd), mMemory(memory), mBytes(bytes), mOwner(false)
+{
+  // Do nothing
+}
+
+MPCSharedMemoryChannel::~MPCSharedMemoryChannel()
+{
+  if (mOwner)
+    unlink();
+  munmap(mMemory, mBytes);
+  ::close(mFd);
+}
+
+MPCSharedMemoryChannel::Header* MPCSharedMemoryChannel::header() const
+{
+  return reinterpret_cast<Header*>(mMemory);
+}
+
+char* MPCSharedMemoryChannel::observationSlot(uint64_t index) const
+{
+  const Header* h = header();
+  return reinterpret_cast<char*>(mMemory) + h->observationsOffset
+         + (index % h->observationCapacity) * h->observationStride;
+}
+
+char* MPCSharedMemoryChannel::planSlot(int index) const
+{
+  const Header* h = header();
+  return reinterpret_cast<char*>(mMemory) + h->plansOffset
+         + index * h->planStride;
+}
+
+int MPCSharedMemoryChannel::getNumDofs() const
+{
+  return header()->dofs;
+}
+
+int MPCSharedMemoryChannel::getMassDim() const
+{
+  return header()->massDim;
+}
+
+int MPCSharedMemoryChannel::getNumSteps() const
+{
+  return header()->steps;
+}
+
+int MPCSharedMemoryChannel::getMillisPerStep() const
+{
+  return header()->millisPerStep;
+}
+
+bool MPCSharedMemoryChannel::pushGroundTruthState(
+    long time,
+    const Eigen::VectorXs& pos,
+    const Eigen::VectorXs& vel,
+    const Eigen::VectorXs& mass)
+{
+  Header* h = header();
+  assert(pos.size() == h->dofs && vel.size() == h->dofs);
+  assert(mass.size() == h->massDim);
+
+  uint64_t position;
+  char* slot = claimObservationSlot(position);
+  if (slot == nullptr)
+    return false;
+
+  ObservationSlotHeader* slotHeader
+      = reinterpret_cast<ObservationSlotHeader*>(slot);
+  slotHeader->type = GROUND_TRUTH_STATE;
+  slotHeader->time = time;
+  double* data
+      = reinterpret_cast<double*>(slot + sizeof(ObservationSlotHeader));
+  writeDoubles(data, pos, h->dofs);
+  writeDoubles(data + h->dofs, vel, h->dofs);
+  writeDoubles(data + 2 * h->dofs, mass, h->massDim);
+
+  slotHeader->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool MPCSharedMemoryChannel::pushObservedForce(
+    long time, const Eigen::VectorXs& force)
+{
+  Header* h = header();
+  assert(force.size() == h->dofs);
+
+  uint64_t position;
+  char* slot = claimObservationSlot(position);
+  if (slot == nullptr)
+    return false;
+
+  ObservationSlotHeader* slotHeader
+      = reinterpret_cast<ObservationSlotHeader*>(slot);
+  slotHeader->type = OBSERVED_FORCE;
+  slotHeader->time = time;
+  double* data
+      = reinterpret_cast<double*>(slot + sizeof(ObservationSlotHeader));
+  writeDoubles(data, force, h->dofs);
+
+  slotHeader->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+char* MPCSharedMemoryChannel::claimObservationSlot(uint64_t& position)
+{
+  Header* h = header();
+
+  // The control thread and the thread recording ground truth both push, so
+  // producers reserve ring positions with a CAS on the head. A slot is only
+  // free for position `head` once the consumer has released the observation
+  // one lap behind it.
+  uint64_t head = h->observationHead.load(std::memory_order_relaxed);
+  while (true)
+  {
+    ObservationSlotHeader* slotHeader
+        = reinterpret_cast<ObservationSlotHeader*>(observationSlot(head));
+    uint64_t sequence = slotHeader->sequence.load(std::memory_order_acquire);
+    int64_t lag = static_cast<int64_t>(sequence - head);
+    if (lag == 0)
+    {
+      if (h->observationHead.compare_exchange_weak(
+              head, head + 1, std::memory_order_relaxed))
+      {
+        position = head;
+        return reinterpret_cast<char*>(slotHeader);
+      }
+      // The failed CAS loaded the current head for us
+    }
+    else if (lag < 0)
+    {
+      // The slot still belongs to the observation from the previous lap, which
+      // the planner hasn't read yet, so the ring is full
+      h->droppedObservations.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    else
+    {
+      // Another producer claimed this position since we read the head
+      head = h->observationHead.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool MPCSharedMemoryChannel::popObservation(Observation& out)
+{
+  Header* h = header();
+  uint64_t tail = h->observationTail.load(std::memory_order_relaxed);
+  char* slot = observationSlot(tail);
+  ObservationSlotHeader* slotHeader
+      = reinterpret_cast<ObservationSlotHeader*>(slot);
+  // Producers can finish filling in their slots out of order, so we wait on
+  // the oldest one rather than on the head
+  if (slotHeader->sequence.load(std::memory_order_acquire) != tail + 1)
+    return false;
+
+  const double* data
+      = reinterpret_cast<const double*>(slot + sizeof(ObservationSlotHeader));
+  out.type = static_cast<ObservationType>(slotHeader->type);
+  out.time = slotHeader->time;
+  if (out.type == GROUND_TRUTH_STATE)
+  {
+    readDoubles(data, out.pos, h->dofs);
+    readDoubles(data + h->dofs, out.vel, h->dofs);
+    readDoubles(data + 2 * h->dofs, out.mass, h->massDim);
+  }
+  else
+  {
+    readDoubles(data, out.force, h->dofs);
+  }
+
+  // Hand the slot to the producer that claims it on the next lap
+  slotHeader->sequence.store(
+      tail + h->observationCapacity, std::memory_order_release);
+  h->observationTail.store(tail + 1, std::memory_order_relaxed);
+  return true;
+}
+
+long MPCSharedMemoryChannel::getNumDroppedObservations() const
+{
+  return static_cast<long>(
+      header()->droppedObservations.load(std::memory_order_relaxed));
+}
+
+void MPCSharedMemoryChannel::publishPlan(
+    long startTime,
+    long replanDurationMillis,
+    const trajectory::TrajectoryRollout* rollout)
+{
+  Header* h = header();
+  const Eigen::Ref<const Eigen::MatrixXs> poses = rollout->getPosesConst();
+  const Eigen::Ref<const Eigen::MatrixXs> vels = rollout->getVelsConst();
+  const Eigen::Ref<const Eigen::MatrixXs> forces
+      = rollout->getControlForcesConst();
+  const Eigen::Ref<const Eigen::VectorXs> masses = rollout->getMassesConst();
+  assert(forces.rows() == h->dofs);
+  if (forces.cols() > h->steps)
+  {
+    dtwarn << "[MPCSharedMemoryChannel::publishPlan] Truncating a plan of "
+           << forces.cols() << " steps to the " << h->steps
+           << " steps this channel was created with.\n";
+  }
+  const int numSteps = std::min<int>(forces.cols(), h->steps);
+  const int numMasses = std::min<int>(masses.size(), h->massDim);
+  const int planSize = h->dofs * h->steps;
+
+  // Write into a slot that readers aren't following. Readers that were lapped
+  // anyway notice the sequence change and retry.
+  int active = h->activePlan.load(std::memory_order_relaxed);
+  int next = (active + 1) % NUM_PLAN_SLOTS;
+  char* slot = planSlot(next);
+  PlanSlotHeader* slotHeader = reinterpret_cast<PlanSlotHeader*>(slot);
+  double* data = reinterpret_cast<double*>(slot + sizeof(PlanSlotHeader));
+
+  uint64_t sequence = slotHeader->sequence.load(std::memory_order_relaxed);
+  slotHeader->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slotHeader->startTime = startTime;
+  slotHeader->replanDurationMillis = replanDurationMillis;
+  slotHeader->numSteps = numSteps;
+  for (int t = 0; t < numSteps; t++)
+  {
+    for (int i = 0; i < h->dofs; i++)
+    {
+      data[t * h->dofs + i] = static_cast<double>(poses(i, t));
+      data[planSize + t * h->dofs + i] = static_cast<double>(vels(i, t));
+      data[2 * planSize + t * h->dofs + i] = static_cast<double>(forces(i, t));
+    }
+  }
+  for (int i = 0; i < numMasses; i++)
+  {
+    data[3 * planSize + i] = static_cast<double>(masses(i));
+  }
+
+  slotHeader->sequence.store(sequence + 2, std::memory_order_release);
+  h->activePlan.store(next, std::memory_order_release);
+  h->planVersion.fetch_add(1, std::memory_order_release);
+}
+
+bool MPCSharedMemoryChannel::readPlan(long& lastVersion, Plan& out)
+{
+  Header* h = header();
+  const int planSize = h->dofs * h->steps;
+
+  while (true)
+  {
+    long version
+        = static_cast<long>(h->planVersion.load(std::memory_order_acquire));
+    if (version == lastVersion)
+      return false;
+    int active = h->activePlan.load(std::memory_order_acquire);
+    if (active < 0)
+      return false;
+
+    const char* slot = planSlot(active);
+    const PlanSlotHeader* slotHeader
+        = reinterpret_cast<const PlanSlotHeader*>(slot);
+    const double* data
+        = reinterpret_cast<const double*>(slot + sizeof(PlanSlotHeader));
+
+    uint64_t before = slotHeader->sequence.load(std::memory_order_acquire);
+    if (before % 2 == 1)
+      continue;
+
+    const int numSteps = slotHeader->numSteps;
+    out.startTime = slotHeader->startTime;
+    out.replanDurationMillis = slotHeader->replanDurationMillis;
+    out.poses.resize(h->dofs, numSteps);
+    out.vels.resize(h->dofs, numSteps);
+    out.forces.resize(h->dofs, numSteps);
+    for (int t = 0; t < numSteps; t++)
+    {
+      for (int i = 0; i < h->dofs; i++)
+      {
+        out.poses(i, t) = static_cast<s_t>(data[t * h->dofs + i]);
+        out.vels(i, t) = static_cast<s_t>(data[planSize + t * h->dofs + i]);
+        out.forces(i, t)
+            = static_cast<s_t>(data[2 * planSize + t * h->dofs + i]);
+      }
+    }
+    readDoubles(data + 3 * planSize, out.masses, h->massDim);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = slotHeader->sequence.load(std::memory_order_relaxed);
+    if (before != after)
+      continue;
+
+    lastVersion = version;
+    return true;
+  }
+}
+
+void MPCSharedMemoryChannel::requestRunning(bool running)
+{
+  Header* h = header();
+  h->runningRequested.store(running ? 1 : 0, std::memory_order_relaxed);
+  h->runningRequests.fetch_add(1, std::memory_order_release);
+}
+
+bool MPCSharedMemoryChannel::pollRunningRequest(
+    long& lastRequest, bool& running)
+{
+  Header* h = header();
+  long requests = static_cast<long>(
+      h->runningRequests.load(std::memory_order_acquire));
+  if (requests == lastRequest)
+    return false;
+  lastRequest = requests;
+  running = h->runningRequested.load(std::memory_order_relaxed) == 1;
+  return true;
+}
+
+void MPCSharedMemoryChannel::close()
+{
+  header()->closed.store(1, std::memory_order_release);
+}
+
+bool MPCSharedMemoryChannel::isClosed() const
+{
+  return header()->closed.load(std::memory_order_acquire) == 1;
+}
+
+void MPCSharedMemoryChannel::unlink()
+{
+  shm_unlink(mName.c_str());
+  mOwner = false;
+}
+
+MPCSharedMemoryRemote::MPCSharedMemoryRemote(
+    const std::string& name, long timeoutMillis)
+  : mRunning(false),
+    mChannel(MPCSharedMemoryChannel::open(name, timeoutMillis)),
+    mBuffer(
+        mChannel ? mChannel->getNumDofs() : 0,
+        mChannel ? mChannel->getNumSteps() : 0,
+        mChannel ? mChannel->getMillisPerStep() : 1)
+{
+  // Do nothing
+}
+
+MPCSharedMemoryRemote::MPCSharedMemoryRemote(MPCLocal& local)
+  : mRunning(false),
+    mChannel(nullptr),
+    mBuffer(local.mWorld->getNumDofs(), local.mSteps, local.mMillisPerStep)
+{
+  static std::atomic<int> numChannels(0);
+  std::string name = "/nimble_mpc_" + std::to_string(getpid()) + "_"
+                     + std::to_string(numChannels++);
+
+  int original_id = getpid();
+  int child_id = fork();
+  // We're in the child process, serve the planner over shared memory
+  if (child_id == 0)
+  {
+    // Start a thread to periodically check if our parent has died, and if so
+    // commit suicide
+    std::thread parent_liveness_poll([original_id]() {
+      while (true)
+      {
+        // Only poll once-per-second
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        int parent_id = getppid();
+        // This means the parent is dead
+        if (parent_id != original_id)
+        {
+          exit(0);
+        }
+      }
+    });
+    parent_liveness_poll.detach();
+    local.serveSharedMemory(name);
+    // When we're done serving, kill this process
+    exit(0);
+  }
+  // We're in the parent process
+  else if (child_id > 0)
+  {
+    std::cout << "(MPC fork process id = " << child_id << ")" << std::endl;
+    mChannel = MPCSharedMemoryChannel::open(name);
+  }
+  else
+  {
+    dterr << "[MPCSharedMemoryRemote] fork() failed, so the planner isn't "
+          << "running: " << std::strerror(errno) << "\n";
+  }
+}
+
+MPCSharedMemoryRemote::~MPCSharedMemoryRemote()
+{
+  stop();
+  if (mChannel)
+    mChannel->close();
+}
+
+/// This gets the force to apply to the world at this instant. If we haven't
+/// computed anything for this instant yet, this just returns 0s.
+Eigen::VectorXs MPCSharedMemoryRemote::getControlForce(long now)
+{
+  Eigen::VectorXs force = mBuffer.getPlannedForce(now);
+  // The planner needs to know what we actually applied, to estimate the state
+  // of the world when it starts planning
+  if (mChannel)
+    mChannel->pushObservedForce(now, force);
+  return force;
+}
+
+/// This returns how many millis we have left until we've run out of plan.
+/// This can be a negative number, if we've run past our plan.
+long MPCSharedMemoryRemote::getRemainingPlanBufferMillis()
+{
+  return mBuffer.getPlanBufferMillisAfter(timeSinceEpochMillis());
+}
+
+/// This records the current state of the world based on some external sensing
+/// and inference. This resets the error in our model just assuming the world
+/// is exactly following our simulation.
+void MPCSharedMemoryRemote::recordGroundTruthState(
+    long time, Eigen::VectorXs pos, Eigen::VectorXs vel, Eigen::VectorXs mass)
+{
+  if (mChannel)
+    mChannel->pushGroundTruthState(time, pos, vel, mass);
+}
+
+/// This starts the planner optimizing, and starts a thread that picks up the
+/// plans it publishes
+void MPCSharedMemoryRemote::start()
+{
+  if (mRunning || !mChannel)
+    return;
+  mRunning = true;
+  mChannel->requestRunning(true);
+  mPlanListenerThread
+      = std::thread(&MPCSharedMemoryRemote::planListenerLoop, this);
+}
+
+/// This stops the planner, and waits for our plan listening thread to finish
+void MPCSharedMemoryRemote::stop()
+{
+  if (!mRunning)
+    return;
+  mRunning = false;
+  mChannel->requestRunning(false);
+  if (mPlanListenerThread.joinable())
+    mPlanListenerThread.join();
+}
+
+/// This registers a listener to get called when we finish replanning
+void MPCSharedMemoryRemote::registerReplanningListener(
+    std::function<void(long, const trajectory::TrajectoryRollout*, long)>
+        replanListener)
+{
+  mReplannedListeners.push_back(replanListener);
+}
+
+long MPCSharedMemoryRemote::getNumDroppedObservations() const
+{
+  return mChannel ? mChannel->getNumDroppedObservations() : 0;
+}
+
+/// This is the function for the plan listening thread to run
+void MPCSharedMemoryRemote::planListenerLoop()
+{
+  long lastVersion = 0;
+  MPCSharedMemoryChannel::Plan plan;
+  while (mRunning)
+  {
+    if (!mChannel->readPlan(lastVersion, plan))
+    {
+      // Plans arrive at most every few millis, so this keeps the pickup
+      // latency well under a control tick without burning a core
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      continue;
+    }
+
+    mBuffer.setControlForcePlan(
+        plan.startTime, timeSinceEpochMillis(), plan.forces);
+
+    if (!mReplannedListeners.empty())
+    {
+      std::unordered_map<std::string, Eigen::MatrixXs> pos;
+      std::unordered_map<std::string, Eigen::MatrixXs> vel;
+      std::unordered_map<std::string, Eigen::MatrixXs> force;
+      std::unordered_map<std::string, Eigen::MatrixXs> metadata;
+      pos["identity"] = plan.poses;
+      vel["identity"] = plan.vels;
+      force["identity"] = plan.forces;
+      trajectory::TrajectoryRolloutReal rollout(
+          pos, vel, force, plan.masses, metadata);
+      for (auto listener : mReplannedListeners)
+      {
+        listener(plan.startTime, &rollout, plan.replanDurationMillis);
+      }
+    }
+  }
+}
+
+} // namespace realtime
+} // namespace dart
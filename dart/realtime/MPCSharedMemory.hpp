@@ -0,0 +1,232 @@
+#ifndef DART_MPC_SHARED_MEMORY
+#define DART_MPC_SHARED_MEMORY
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/math/MathTypes.hpp"
+#include "dart/realtime/MPC.hpp"
+#include "dart/realtime/RealTimeControlBuffer.hpp"
+
+namespace dart {
+
+namespace trajectory {
+class TrajectoryRollout;
+}
+
+namespace realtime {
+
+class MPCLocal;
+
+/// This is a POSIX shared memory segment that lets an MPCLocal planner and an
+/// MPCSharedMemoryRemote driver on the same host talk without serializing
+/// anything. Observations go from the driver to the planner through a
+/// multi-producer single-consumer ring buffer, since the driver records them
+/// from more than one thread. Plans go from the planner to the driver through
+/// seqlocked slots, the same way RealTimeControlBuffer publishes plans between
+/// threads. All scalars are stored as doubles.
+class MPCSharedMemoryChannel
+{
+public:
+  enum ObservationType
+  {
+    GROUND_TRUTH_STATE = 0,
+    OBSERVED_FORCE = 1
+  };
+
+  /// This is one observation, as read by the planner
+  struct Observation
+  {
+    ObservationType type;
+    long time;
+    Eigen::VectorXs pos;
+    Eigen::VectorXs vel;
+    Eigen::VectorXs mass;
+    Eigen::VectorXs force;
+  };
+
+  /// This is one plan, as read by the driver
+  struct Plan
+  {
+    long startTime;
+    long replanDurationMillis;
+    Eigen::MatrixXs poses;
+    Eigen::MatrixXs vels;
+    Eigen::MatrixXs forces;
+    Eigen::VectorXs masses;
+  };
+
+  /// How many observations can be waiting for the planner before new ones are
+  /// dropped
+  static constexpr int OBSERVATION_CAPACITY = 256;
+
+  /// This creates the shared memory segment `name`, replacing any stale one
+  /// with the same name. This is called by the planner. Returns nullptr on
+  /// failure.
+  static std::shared_ptr<MPCSharedMemoryChannel> create(
+      const std::string& name,
+      int dofs,
+      int massDim,
+      int steps,
+      int millisPerStep);
+
+  /// This attaches to a segment created by create(), waiting up to
+  /// `timeoutMillis` for the planner to finish setting it up. This is called
+  /// by the driver. Returns nullptr on failure.
+  static std::shared_ptr<MPCSharedMemoryChannel> open(
+      const std::string& name, long timeoutMillis = 5000);
+
+  ~MPCSharedMemoryChannel();
+
+  int getNumDofs() const;
+  int getMassDim() const;
+  int getNumSteps() const;
+  int getMillisPerStep() const;
+
+  /// Driver side: this queues a ground truth state for the planner. Returns
+  /// false (and counts a drop) if the planner has fallen too far behind.
+  bool pushGroundTruthState(
+      long time,
+      const Eigen::VectorXs& pos,
+      const Eigen::VectorXs& vel,
+      const Eigen::VectorXs& mass);
+
+  /// Driver side: this queues a force that was applied to the real world
+  bool pushObservedForce(long time, const Eigen::VectorXs& force);
+
+  /// Planner side: this pops the oldest queued observation into `out`, reusing
+  /// its storage. Returns false if there are no observations waiting.
+  bool popObservation(Observation& out);
+
+  /// Returns the number of observations dropped because the ring was full
+  long getNumDroppedObservations() const;
+
+  /// Planner side: this publishes a freshly optimized plan. Plans longer than
+  /// the number of steps the channel was created with get truncated.
+  void publishPlan(
+      long startTime,
+      long replanDurationMillis,
+      const trajectory::TrajectoryRollout* rollout);
+
+  /// Driver side: if a plan newer than `lastVersion` has been published, this
+  /// copies it into `out`, updates `lastVersion`, and returns true
+  bool readPlan(long& lastVersion, Plan& out);
+
+  /// Driver side: this asks the planner to start or stop optimizing. If
+  /// several requests arrive before the planner checks, the last one wins.
+  void requestRunning(bool running);
+
+  /// Planner side: if a start or stop request has arrived since
+  /// `lastRequest`, this updates `lastRequest`, sets `running` to the requested
+  /// state, and returns true
+  bool pollRunningRequest(long& lastRequest, bool& running);
+
+  /// This marks the channel as closed, which tells the planner to stop serving
+  void close();
+
+  /// Returns true once either side has called close()
+  bool isClosed() const;
+
+  /// This removes the segment's name, so no new process can attach to it.
+  /// Processes that are already attached keep working.
+  void unlink();
+
+protected:
+  struct Header;
+
+  MPCSharedMemoryChannel(
+      const std::string& name, int fd, void* memory, std::size_t bytes);
+
+  Header* header() const;
+  char* observationSlot(uint64_t index) const;
+
+  /// Driver side: this reserves the next free observation slot, and returns it
+  /// along with its ring `position`. Returns nullptr (and counts a drop) if the
+  /// ring is full.
+  char* claimObservationSlot(uint64_t& position);
+  char* planSlot(int index) const;
+
+  std::string mName;
+  int mFd;
+  void* mMemory;
+  std::size_t mBytes;
+  bool mOwner;
+};
+
+/// This is an MPC that runs its planner (an MPCLocal) in another process on
+/// the same host, talking to it over an MPCSharedMemoryChannel rather than
+/// gRPC. This is meant for high rate driver loops sitting next to a planner
+/// process: recording observations and reading the control force are just
+/// memory copies.
+class MPCSharedMemoryRemote : public MPC
+{
+public:
+  /// This attaches to a planner that's serving on shared memory segment
+  /// `name`, via MPCLocal::serveSharedMemory()
+  MPCSharedMemoryRemote(const std::string& name, long timeoutMillis = 5000);
+
+  /// This forks the process, serves `local` over shared memory from the child
+  /// process, and attaches to it
+  MPCSharedMemoryRemote(MPCLocal& local);
+
+  ~MPCSharedMemoryRemote();
+
+  /// This gets the force to apply to the world at this instant. If we haven't
+  /// computed anything for this instant yet, this just returns 0s.
+  Eigen::VectorXs getControlForce(long now) override;
+
+  /// This returns how many millis we have left until we've run out of plan.
+  /// This can be a negative number, if we've run past our plan.
+  long getRemainingPlanBufferMillis() override;
+
+  /// This records the current state of the world based on some external sensing
+  /// and inference. This resets the error in our model just assuming the world
+  /// is exactly following our simulation.
+  void recordGroundTruthState(
+      long time,
+      Eigen::VectorXs pos,
+      Eigen::VectorXs vel,
+      Eigen::VectorXs mass) override;
+
+  /// This starts the planner optimizing, and starts a thread that picks up the
+  /// plans it publishes
+  void start() override;
+
+  /// This stops the planner, and waits for our plan listening thread to finish
+  void stop() override;
+
+  /// This registers a listener to get called when we finish replanning
+  void registerReplanningListener(
+      std::function<void(long, const trajectory::TrajectoryRollout*, long)>
+          replanListener) override;
+
+  /// Returns the number of observations dropped because the planner fell
+  /// behind on reading them
+  long getNumDroppedObservations() const;
+
+protected:
+  /// This is the function for the plan listening thread to run
+  void planListenerLoop();
+
+  std::atomic<bool> mRunning;
+  std::shared_ptr<MPCSharedMemoryChannel> mChannel;
+  RealTimeControlBuffer mBuffer;
+  std::thread mPlanListenerThread;
+
+  // These are listeners that get called when we finish replanning
+  std::vector<
+      std::function<void(long, const trajectory::TrajectoryRollout*, long)>>
+      mReplannedListeners;
+};
+
+} // namespace realtime
+} // namespace dart
+
+#endif
@@ -11,57 +11,74 @@ RealTimeControlBuffer::RealTimeControlBuffer(
     int forceDim, int steps, int millisPerStep)
   : mForceDim(forceDim),
     mNumSteps(steps),
+    mMaxPlanSteps(steps),
     mMillisPerStep(millisPerStep),
-    mActiveBuffer(UNINITIALIZED),
-    mBufA(Eigen::MatrixXs::Zero(forceDim, steps)),
-    mBufB(Eigen::MatrixXs::Zero(forceDim, steps)),
+    mInterpolation(ZERO_ORDER_HOLD),
+    mPlans(new PlanSlots()),
+    mScratch(Eigen::MatrixXs::Zero(forceDim, steps)),
     mControlLog(ControlLog(forceDim, millisPerStep))
 {
+  for (int i = 0; i < PlanSlots::NUM_SLOTS; i++)
+  {
+    mPlans->slots[i].sequence.store(0);
+    mPlans->slots[i].startTime = 0;
+    mPlans->slots[i].millisPerStep = millisPerStep;
+    mPlans->slots[i].numSteps = 0;
+    mPlans->slots[i].forces = Eigen::MatrixXs::Zero(forceDim, steps);
+  }
+  mPlans->activeSlot.store(-1);
+  mPlans->version.store(0);
 }
 
 /// Gets the force at a given timestep
 Eigen::VectorXs RealTimeControlBuffer::getPlannedForce(long time, bool dontLog)
 {
-  if (mActiveBuffer == UNINITIALIZED)
-  {
-    // Unitialized, default to no force
-    return Eigen::VectorXs::Zero(mForceDim);
-  }
-  int elapsed = time - mLastWroteBufferAt;
-  if (elapsed < 0)
-  {
-    // Asking for some time in the past, default to no force
-    return Eigen::VectorXs::Zero(mForceDim);
-  }
+  Eigen::VectorXs force = Eigen::VectorXs::Zero(mForceDim);
+  getPlannedForce(time, force, dontLog);
+  return force;
+}
 
-  int step = (int)floor((s_t)elapsed / mMillisPerStep);
-  if (step < mNumSteps)
+/// This is the same as getPlannedForce(), but writes into `forceOut` rather
+/// than allocating a new vector, for actuator loops running at high rates.
+void RealTimeControlBuffer::getPlannedForce(
+    long time, Eigen::Ref<Eigen::VectorXs> forceOut, bool dontLog)
+{
+  while (true)
   {
-    if (mActiveBuffer == BUF_A)
+    int active = mPlans->activeSlot.load(std::memory_order_acquire);
+    if (active < 0)
     {
-      if (!dontLog)
-        mControlLog.record(time, mBufA.col(step));
-      return mBufA.col(step);
+      // Unitialized, default to no force
+      forceOut.setZero();
+      return;
     }
-    else if (mActiveBuffer == BUF_B)
+    const PlanSlot& slot = mPlans->slots[active];
+    long sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence % 2 == 1)
     {
-      if (!dontLog)
-        mControlLog.record(time, mBufB.col(step));
-      return mBufB.col(step);
+      // The writer lapped us and is rewriting this slot, so look again
+      continue;
+    }
+    bool covered = samplePlan(slot, time, forceOut);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+    {
+      continue;
+    }
+
+    if (!covered)
+    {
+      // Either we're asking for a time in the past, or MPC isn't keeping up,
+      // so default to no force
+      forceOut.setZero();
+      // Asking about the past doesn't count as applying a force
+      if (time < slot.startTime)
+        return;
     }
-    else
-      assert(false && "Should never reach this point");
-  }
-  else
-  {
-    // std::cout << "WARNING: MPC isn't keeping up!" << std::endl;
-    Eigen::VectorXs oob = Eigen::VectorXs::Zero(mForceDim);
     if (!dontLog)
-      mControlLog.record(time, oob);
-    return oob;
+      mControlLog.record(time, forceOut);
+    return;
   }
-  // The code should never reach here, but it's here to keep the compiler happy
-  throw std::runtime_error{"Execution should never reach this point"};
 }
 
 /// This gets planned forces starting at `start`, and continuing for the
@@ -71,42 +88,33 @@ Eigen::VectorXs RealTimeControlBuffer::getPlannedForce(long time, bool dontLog)
 void RealTimeControlBuffer::getPlannedForcesStartingAt(
     long start, Eigen::Ref<Eigen::MatrixXs> forcesOut)
 {
-  if (mActiveBuffer == UNINITIALIZED)
+  while (true)
   {
-    // Unitialized, default to 0
-    forcesOut.setZero();
-    return;
-  }
-  int elapsed = start - mLastWroteBufferAt;
-  if (elapsed < 0)
-  {
-    // Asking for some time in the past, default to 0
-    forcesOut.setZero();
-    return;
-  }
-  int startStep = (int)floor((s_t)elapsed / mMillisPerStep);
-  if (startStep < mNumSteps)
-  {
-    // Copy the appropriate block of our active buffer to the forcesOut block
-    if (mActiveBuffer == BUF_A)
+    int active = mPlans->activeSlot.load(std::memory_order_acquire);
+    if (active < 0)
     {
-      forcesOut.block(0, 0, mForceDim, mNumSteps - startStep)
-          = mBufA.block(0, startStep, mForceDim, mNumSteps - startStep);
+      // Unitialized, default to 0
+      forcesOut.setZero();
+      return;
     }
-    else if (mActiveBuffer == BUF_B)
+    const PlanSlot& slot = mPlans->slots[active];
+    long sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence % 2 == 1)
     {
-      forcesOut.block(0, 0, mForceDim, mNumSteps - startStep)
-          = mBufB.block(0, startStep, mForceDim, mNumSteps - startStep);
+      continue;
+    }
+    for (int i = 0; i < forcesOut.cols(); i++)
+    {
+      if (!samplePlan(slot, start + i * mMillisPerStep, forcesOut.col(i)))
+      {
+        forcesOut.col(i).setZero();
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+    {
+      return;
     }
-    else
-      assert(false && "Should never reach this point");
-    // Zero out the remainder of the forcesOut block
-    forcesOut.block(0, mNumSteps - startStep, mForceDim, startStep).setZero();
-  }
-  else
-  {
-    // std::cout << "WARNING: MPC isn't keeping up!" << std::endl;
-    forcesOut.setZero();
   }
 }
 
@@ -115,90 +123,70 @@ void RealTimeControlBuffer::getPlannedForcesStartingAt(
 void RealTimeControlBuffer::setControlForcePlan(
     long startAt, long now, Eigen::MatrixXs forces)
 {
-  if (startAt > now)
+  if (startAt <= now)
   {
-    long padMillis = startAt - now;
-    int padSteps = (int)floor((s_t)padMillis / mMillisPerStep);
-    // If we're trying to set the force plan too far out in the future, this
-    // whole exercise is a no-op
-    if (padSteps >= mNumSteps)
-    {
-      return;
-    }
-    // Otherwise, we're going to copy part of the existing plan
-    int currentStep
-        = (int)floor((s_t)(now - mLastWroteBufferAt) / mMillisPerStep);
-    int remainingSteps = mNumSteps - currentStep;
-    mLastWroteBufferAt = now;
-
-    // If we've overflowed our old buffer, this is bad, but recoverable. We'll
-    // just not copy anything from our old plan, since it's all in the past now
-    // anyways.
-    if (remainingSteps < 0)
-    {
-      mBufA = forces;
-      mActiveBuffer = BUF_A;
-      return;
-    }
+    publishPlan(startAt, mMillisPerStep, forces);
+    return;
+  }
 
-    int copySteps = padSteps;
-    int zeroSteps = 0;
-    int useSteps = mNumSteps - padSteps;
-    if (padSteps > remainingSteps)
-    {
-      copySteps = remainingSteps;
-      zeroSteps = padSteps - remainingSteps;
-      useSteps = mNumSteps - padSteps;
-    }
-    assert(copySteps + zeroSteps + useSteps == mNumSteps);
+  long padMillis = startAt - now;
+  int padSteps = (int)floor((s_t)padMillis / mMillisPerStep);
+  // If we're trying to set the force plan too far out in the future, this
+  // whole exercise is a no-op
+  if (padSteps >= mNumSteps)
+  {
+    return;
+  }
 
-    if (mActiveBuffer == UNINITIALIZED)
-    {
-      mBufA.block(0, 0, mForceDim, copySteps).setZero();
-      mBufA.block(0, copySteps, mForceDim, zeroSteps).setZero();
-      mBufA.block(0, copySteps + zeroSteps, mForceDim, useSteps)
-          = forces.block(0, 0, mForceDim, useSteps);
-      mActiveBuffer = BUF_A;
-    }
-    else if (mActiveBuffer == BUF_B)
-    {
-      mBufA.block(0, 0, mForceDim, copySteps)
-          = mBufB.block(0, mNumSteps - copySteps, mForceDim, copySteps);
-      mBufA.block(0, copySteps, mForceDim, zeroSteps).setZero();
-      mBufA.block(0, copySteps + zeroSteps, mForceDim, useSteps)
-          = forces.block(0, 0, mForceDim, useSteps);
-      mActiveBuffer = BUF_A;
-    }
-    else if (mActiveBuffer == BUF_A)
-    {
-      mBufB.block(0, 0, mForceDim, copySteps)
-          = mBufA.block(0, mNumSteps - copySteps, mForceDim, copySteps);
-      mBufB.block(0, copySteps, mForceDim, zeroSteps).setZero();
-      mBufB.block(0, copySteps + zeroSteps, mForceDim, useSteps)
-          = forces.block(0, 0, mForceDim, useSteps);
-      mActiveBuffer = BUF_B;
-    }
+  // Otherwise, we're going to copy part of the existing plan
+  const PlanSlot* current = getActiveSlot();
+  int remainingSteps = 0;
+  if (current != nullptr)
+  {
+    int currentStep = (int)floor(
+        (s_t)(now - current->startTime) / current->millisPerStep);
+    remainingSteps = current->numSteps - currentStep;
   }
-  else
+
+  // If we've overflowed our old buffer, this is bad, but recoverable. We'll
+  // just not copy anything from our old plan, since it's all in the past now
+  // anyways.
+  if (current != nullptr && remainingSteps < 0)
   {
-    mLastWroteBufferAt = startAt;
-    if (mActiveBuffer == UNINITIALIZED || mActiveBuffer == BUF_B)
-    {
-      mBufA = forces;
-      // Crucial for lock-free behavior: copy the buffer BEFORE setting the
-      // active buffer. Not a huge deal if we're a bit off here in the
-      // optimizer, but not ideal.
-      mActiveBuffer = BUF_A;
-    }
-    else
-    {
-      mBufB = forces;
-      // Crucial for lock-free behavior: copy the buffer BEFORE setting the
-      // active buffer. Not a huge deal if we're a bit off here in the
-      // optimizer, but not ideal.
-      mActiveBuffer = BUF_B;
-    }
+    publishPlan(now, mMillisPerStep, forces);
+    return;
   }
+
+  int copySteps = std::min(padSteps, remainingSteps);
+  int zeroSteps = padSteps - copySteps;
+  int useSteps = std::min<int>(mNumSteps - padSteps, forces.cols());
+
+  mScratch.resize(mForceDim, mNumSteps);
+  if (copySteps > 0)
+  {
+    mScratch.block(0, 0, mForceDim, copySteps) = current->forces.block(
+        0, current->numSteps - copySteps, mForceDim, copySteps);
+  }
+  mScratch.block(0, copySteps, mForceDim, zeroSteps).setZero();
+  mScratch.block(0, padSteps, mForceDim, useSteps)
+      = forces.block(0, 0, mForceDim, useSteps);
+  mScratch
+      .block(0, padSteps + useSteps, mForceDim, mNumSteps - padSteps - useSteps)
+      .setZero();
+  publishPlan(now, mMillisPerStep, mScratch);
+}
+
+/// This sets how we read forces between the steps of a plan. This defaults
+/// to ZERO_ORDER_HOLD.
+void RealTimeControlBuffer::setInterpolation(PlanInterpolation interpolation)
+{
+  mInterpolation = interpolation;
+}
+
+/// This returns the number of plans that have been published so far
+long RealTimeControlBuffer::getPlanVersion() const
+{
+  return mPlans->version.load(std::memory_order_acquire);
 }
 
 /// This retrieves the state of the world at a given time, assuming that we've
@@ -252,13 +240,14 @@ void RealTimeControlBuffer::estimateWorldStateAt(
 void RealTimeControlBuffer::setMillisPerStep(int newMillisPerStep)
 {
   mControlLog.setMillisPerStep(newMillisPerStep);
-  if (mActiveBuffer == BUF_A)
-  {
-    rescaleBuffer(mBufA, mMillisPerStep, newMillisPerStep);
-  }
-  else if (mActiveBuffer == BUF_B)
+  const PlanSlot* current = getActiveSlot();
+  if (current != nullptr)
   {
-    rescaleBuffer(mBufB, mMillisPerStep, newMillisPerStep);
+    // Republish the current plan at the new resolution, so the plan horizon
+    // stays consistent with the new step size
+    mScratch = current->forces.block(0, 0, mForceDim, current->numSteps);
+    rescaleBuffer(mScratch, current->millisPerStep, newMillisPerStep);
+    publishPlan(current->startTime, newMillisPerStep, mScratch);
   }
   mMillisPerStep = newMillisPerStep;
 }
@@ -268,32 +257,58 @@ void RealTimeControlBuffer::setMillisPerStep(int newMillisPerStep)
 /// probably has a nonlinear effect on runtime.
 void RealTimeControlBuffer::setNumSteps(int newNumSteps)
 {
-  Eigen::MatrixXs newBuf = Eigen::MatrixXs::Zero(mForceDim, newNumSteps);
-
-  int minLen = newNumSteps;
-  if (mNumSteps < minLen)
-    minLen = mNumSteps;
-
-  if (mActiveBuffer == BUF_A)
+  if (newNumSteps > mMaxPlanSteps)
   {
-    newBuf.block(0, 0, mForceDim, minLen)
-        = mBufA.block(0, 0, mForceDim, minLen);
+    setMaxPlanSteps(newNumSteps);
   }
-  else if (mActiveBuffer == BUF_B)
+  const PlanSlot* current = getActiveSlot();
+  if (current != nullptr)
   {
-    newBuf.block(0, 0, mForceDim, minLen)
-        = mBufB.block(0, 0, mForceDim, minLen);
+    mScratch = Eigen::MatrixXs::Zero(mForceDim, newNumSteps);
+    int minLen = std::min(newNumSteps, current->numSteps);
+    mScratch.block(0, 0, mForceDim, minLen)
+        = current->forces.block(0, 0, mForceDim, minLen);
+    publishPlan(current->startTime, current->millisPerStep, mScratch);
   }
+  mNumSteps = newNumSteps;
+}
 
-  mBufA = newBuf;
-  mBufB = newBuf;
+/// This sets the longest plan we can hold. Plan storage is allocated up
+/// front, so publishing a plan never reallocates memory that a reader could
+/// be copying out of. This must NOT be called while another thread may be
+/// reading forces.
+void RealTimeControlBuffer::setMaxPlanSteps(int maxPlanSteps)
+{
+  for (int i = 0; i < PlanSlots::NUM_SLOTS; i++)
+  {
+    PlanSlot& slot = mPlans->slots[i];
+    Eigen::MatrixXs forces = Eigen::MatrixXs::Zero(mForceDim, maxPlanSteps);
+    slot.numSteps = std::min(slot.numSteps, maxPlanSteps);
+    forces.block(0, 0, mForceDim, slot.numSteps)
+        = slot.forces.block(0, 0, mForceDim, slot.numSteps);
+    slot.forces = forces;
+  }
+  mMaxPlanSteps = maxPlanSteps;
+}
+
+/// This returns the longest plan we can hold
+int RealTimeControlBuffer::getMaxPlanSteps() const
+{
+  return mMaxPlanSteps;
 }
 
 /// This returns the number of millis we have left in the plan after `time`.
 /// This can be a negative number.
 long RealTimeControlBuffer::getPlanBufferMillisAfter(long time)
 {
-  long planEnd = mLastWroteBufferAt + (mNumSteps * mMillisPerStep);
+  const PlanSlot* current = getActiveSlot();
+  if (current == nullptr)
+  {
+    // We don't have any plan yet
+    return 0;
+  }
+  long planEnd
+      = current->startTime + (current->numSteps * current->millisPerStep);
   return planEnd - time;
 }
 
@@ -312,7 +327,7 @@ void RealTimeControlBuffer::rescaleBuffer(
 {
   Eigen::MatrixXs newBuf = Eigen::MatrixXs::Zero(buf.rows(), buf.cols());
 
-  for (int i = mNumSteps - 1; i >= 0; i--)
+  for (int i = buf.cols() - 1; i >= 0; i--)
   {
     if (newMillisPerStep > oldMillisPerStep)
     {
@@ -335,5 +350,79 @@ void RealTimeControlBuffer::rescaleBuffer(
   buf = newBuf;
 }
 
+/// This copies `forces` into the next free slot and makes it the active
+/// plan. This must only be called from a single writer thread.
+void RealTimeControlBuffer::publishPlan(
+    long startTime, int millisPerStep, const Eigen::MatrixXs& forces)
+{
+  int active = mPlans->activeSlot.load(std::memory_order_relaxed);
+  int next = (active + 1) % PlanSlots::NUM_SLOTS;
+  PlanSlot& slot = mPlans->slots[next];
+
+  // Mark the slot as being written, in case a slow reader is still on it
+  long sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // We only ever write into the storage we allocated up front. Resizing it
+  // here could free memory out from under a lapped reader, before it gets the
+  // chance to notice the sequence change.
+  assert(forces.rows() == mForceDim);
+  assert(slot.forces.cols() == mMaxPlanSteps);
+  int numSteps = std::min<int>(forces.cols(), mMaxPlanSteps);
+  slot.startTime = startTime;
+  slot.millisPerStep = millisPerStep;
+  slot.numSteps = numSteps;
+  slot.forces.block(0, 0, mForceDim, numSteps)
+      = forces.block(0, 0, mForceDim, numSteps);
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  // This is the actual swap that readers see
+  mPlans->activeSlot.store(next, std::memory_order_release);
+  mPlans->version.fetch_add(1, std::memory_order_release);
+}
+
+/// This returns the active slot, or nullptr if nothing's been published.
+/// Only the writer thread may read the slot without checking its sequence.
+const RealTimeControlBuffer::PlanSlot* RealTimeControlBuffer::getActiveSlot()
+    const
+{
+  int active = mPlans->activeSlot.load(std::memory_order_acquire);
+  if (active < 0)
+    return nullptr;
+  return &mPlans->slots[active];
+}
+
+/// This reads the force at `time` out of a slot, returning false if the slot
+/// doesn't cover `time`
+bool RealTimeControlBuffer::samplePlan(
+    const PlanSlot& slot,
+    long time,
+    /* OUT */ Eigen::Ref<Eigen::VectorXs> forceOut) const
+{
+  long elapsed = time - slot.startTime;
+  if (elapsed < 0 || slot.millisPerStep <= 0)
+  {
+    return false;
+  }
+  int step = (int)(elapsed / slot.millisPerStep);
+  if (step >= slot.numSteps)
+  {
+    return false;
+  }
+  if (mInterpolation == FIRST_ORDER_HOLD && step + 1 < slot.numSteps)
+  {
+    s_t alpha = (s_t)(elapsed - (long)step * slot.millisPerStep)
+                / slot.millisPerStep;
+    forceOut = (1.0 - alpha) * slot.forces.col(step)
+               + alpha * slot.forces.col(step + 1);
+  }
+  else
+  {
+    forceOut = slot.forces.col(step);
+  }
+  return true;
+}
+
 } // namespace realtime
 } // namespace dart
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef DART_REALTIME_BUFFER
 #define DART_REALTIME_BUFFER
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -17,11 +18,13 @@ class World;
 
 namespace realtime {
 
-enum BufferSwitchEnum
+/// How forces get read out between the steps of a plan
+enum PlanInterpolation
 {
-  UNINITIALIZED,
-  BUF_A,
-  BUF_B
+  /// Hold each step's force until the next step starts
+  ZERO_ORDER_HOLD,
+  /// Blend linearly from each step's force to the next one
+  FIRST_ORDER_HOLD
 };
 
 class RealTimeControlBuffer
@@ -34,6 +37,11 @@ public:
   /// applied to the real world after they're read.
   Eigen::VectorXs getPlannedForce(long time, bool dontLog = false);
 
+  /// This is the same as getPlannedForce(), but writes into `forceOut` rather
+  /// than allocating a new vector, for actuator loops running at high rates.
+  void getPlannedForce(
+      long time, Eigen::Ref<Eigen::VectorXs> forceOut, bool dontLog = false);
+
   /// This gets planned forces starting at `start`, and continuing for the
   /// length of our buffer size `mSteps`. This is useful for initializing MPC
   /// runs. It supports walking off the end of known future, and assumes 0
@@ -46,6 +54,13 @@ public:
   /// current trajectory.
   void setControlForcePlan(long startAt, long now, Eigen::MatrixXs forces);
 
+  /// This sets how we read forces between the steps of a plan. This defaults
+  /// to ZERO_ORDER_HOLD.
+  void setInterpolation(PlanInterpolation interpolation);
+
+  /// This returns the number of plans that have been published so far
+  long getPlanVersion() const;
+
   /// This retrieves the state of the world at a given time, assuming that we've
   /// been applying forces from the buffer since the last state that we fully
   /// observed.
@@ -59,9 +74,22 @@ public:
 
   /// This changes the number of steps. Fewer steps mean we can compute a buffer
   /// faster, but it also means we have less time to compute the buffer. This
-  /// probably has a nonlinear effect on runtime.
+  /// probably has a nonlinear effect on runtime. If `numSteps` is more than
+  /// getMaxPlanSteps(), this calls setMaxPlanSteps(), so it carries the same
+  /// restriction.
   void setNumSteps(int numSteps);
 
+  /// This sets the longest plan we can hold. Plan storage is allocated up
+  /// front, so publishing a plan never reallocates memory that a reader could
+  /// be copying out of, and longer plans get truncated to this length. This
+  /// reallocates every slot, so it must NOT be called while another thread
+  /// may be reading forces. It defaults to the `steps` we were constructed
+  /// with.
+  void setMaxPlanSteps(int maxPlanSteps);
+
+  /// This returns the longest plan we can hold
+  int getMaxPlanSteps() const;
+
   /// This returns the number of millis we have left in the plan after `time`.
   /// This can be a negative number.
   long getPlanBufferMillisAfter(long time);
@@ -71,26 +99,67 @@ public:
   void manuallyRecordObservedForce(long time, Eigen::VectorXs observation);
 
 protected:
+  /// This is one published plan. Each plan keeps the resolution it was
+  /// published at, so changing the step size doesn't disturb a plan that the
+  /// actuator thread may be reading.
+  struct PlanSlot
+  {
+    /// This is odd while the slot is being written, and gets bumped by two
+    /// every time the slot is reused
+    std::atomic<long> sequence;
+    long startTime;
+    int millisPerStep;
+    int numSteps;
+    /// This is allocated to hold mMaxPlanSteps columns, and never resized
+    /// while readers may be running. Only the first `numSteps` are in use.
+    Eigen::MatrixXs forces;
+  };
+
+  /// Plans get published round-robin into these slots, and readers follow
+  /// `activeSlot`. Publishing a plan never touches the slot readers are
+  /// following, so publishing is just an index swap, and a reader that gets
+  /// lapped by the writer notices the sequence change and retries.
+  struct PlanSlots
+  {
+    static constexpr int NUM_SLOTS = 3;
+    PlanSlot slots[NUM_SLOTS];
+    std::atomic<int> activeSlot;
+    std::atomic<long> version;
+  };
+
   int mForceDim;
   int mNumSteps;
+  int mMaxPlanSteps;
   int mMillisPerStep;
+  PlanInterpolation mInterpolation;
 
   /// This is a helper to rescale the timestep size of a buffer while leaving
   /// the data otherwise unchanged.
   void rescaleBuffer(
       Eigen::MatrixXs& buf, int oldMillisPerStep, int newMillisPerStep);
 
-  /// This controls which of our buffers is currently active
-  BufferSwitchEnum mActiveBuffer;
+  /// This copies `forces` into the next free slot and makes it the active
+  /// plan. This must only be called from a single writer thread.
+  void publishPlan(
+      long startTime, int millisPerStep, const Eigen::MatrixXs& forces);
+
+  /// This returns the active slot, or nullptr if nothing's been published.
+  /// Only the writer thread may read the slot without checking its sequence.
+  const PlanSlot* getActiveSlot() const;
 
-  /// This is the A buffer of forces
-  Eigen::MatrixXs mBufA;
+  /// This reads the force at `time` out of a slot, returning false if the slot
+  /// doesn't cover `time`
+  bool samplePlan(
+      const PlanSlot& slot,
+      long time,
+      /* OUT */ Eigen::Ref<Eigen::VectorXs> forceOut) const;
 
-  /// This is the B buffer of forces
-  Eigen::MatrixXs mBufB;
+  /// This holds our plans. It's behind a pointer so that the buffer stays
+  /// movable, even though the atomics inside it aren't.
+  std::unique_ptr<PlanSlots> mPlans;
 
-  /// This is the time when the last buffer was written to
-  long mLastWroteBufferAt;
+  /// This is scratch space for the writer, to avoid reallocating on replans
+  Eigen::MatrixXs mScratch;
 
   /// This keeps a log of all the control outputs we send, so that we can get
   /// the current state on request, even if we last had an observation a while
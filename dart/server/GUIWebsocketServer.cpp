@@ -1,6 +1,7 @@
 #include "dart/server/GUIWebsocketServer.hpp"
 
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -27,13 +28,20 @@
 namespace dart {
 namespace server {
 
+constexpr uint32_t GUIWebsocketServer::BINARY_TRANSFORM_FRAME;
+
 GUIWebsocketServer::GUIWebsocketServer()
   : mPort(-1),
     mServing(false),
     mStartingServer(false),
     mScreenSize(Eigen::Vector2i(680, 420)),
     mAutoflush(true),
-    mMessagesQueued(0)
+    mMessagesQueued(0),
+    mNextObjectId(0),
+    mUseBinaryTransforms(true),
+    mTransformThreshold(0.0),
+    mMinTransformInterval(0.0),
+    mTransformFlushScheduled(false)
 {
   mJson << "[";
 }
@@ -84,106 +92,14 @@ void GUIWebsocketServer::serve(int port)
     // to avoid data races
     const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
 
+    // The hello message below carries every object's current transform, so
+    // the new client starts with nothing pending
+    mClientTransforms[conn] = ClientTransformState();
+
     // Send a hello message to the client
     // mServer->send(conn) seems to break, cause conn appears to get cleaned
     // up in race conditions (it's a weak pointer)
-    std::stringstream json;
-    json << "[";
-    bool isFirst = true;
-    for (auto pair : mBoxes)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateBox(json, pair.second);
-    }
-    for (auto pair : mSpheres)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateSphere(json, pair.second);
-    }
-    for (auto pair : mCapsules)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateCapsule(json, pair.second);
-    }
-    for (auto pair : mLines)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateLine(json, pair.second);
-    }
-    for (auto pair : mTextures)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateTexture(json, pair.second);
-    }
-    for (auto pair : mMeshes)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateMesh(json, pair.second);
-    }
-    for (auto pair : mText)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateText(json, pair.second);
-    }
-    for (auto pair : mButtons)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateButton(json, pair.second);
-    }
-    for (auto pair : mSliders)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreateSlider(json, pair.second);
-    }
-    for (auto pair : mPlots)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeCreatePlot(json, pair.second);
-    }
-    for (auto key : mMouseInteractionEnabled)
-    {
-      if (isFirst)
-        isFirst = false;
-      else
-        json << ",";
-      encodeEnableMouseInteraction(json, key);
-    }
-
-    json << "]";
-
-    // std::cout << json.str() << std::endl;
-
-    std::string jsonStr = json.str();
+    std::string jsonStr = getSceneJson();
     try
     {
       mServer->send(conn, jsonStr);
@@ -205,7 +121,11 @@ void GUIWebsocketServer::serve(int port)
     }
   });
 
-  mServer->disconnect([this](ClientConnection /* conn */) {
+  mServer->disconnect([this](ClientConnection conn) {
+    {
+      const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+      mClientTransforms.erase(conn);
+    }
     std::clog << "Connection closed." << std::endl;
     std::clog << "There are now " << mServer->numConnections()
               << " open connections." << std::endl;
@@ -375,6 +295,12 @@ void GUIWebsocketServer::stopServing()
   mServer->stop();
   assert(mServerThread != nullptr);
   mServerThread->join();
+  {
+    // The timer is bound to the server's event loop, so it has to go first
+    const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+    mTransformFlushTimer = nullptr;
+    mTransformFlushScheduled = false;
+  }
   delete mServer;
   delete mServerThread;
   mServer = nullptr;
@@ -458,20 +384,144 @@ bool GUIWebsocketServer::isKeyDown(const std::string& key) const
   return mKeysDown.find(key) != mKeysDown.end();
 }
 
+/// This returns the JSON commands that recreate every object and UI element
+/// currently in the GUI. This is what gets sent to newly connected clients.
+std::string GUIWebsocketServer::getSceneJson()
+{
+  const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+
+  std::stringstream json;
+  json << "[";
+  bool isFirst = true;
+  for (auto pair : mBoxes)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateBox(json, pair.second);
+  }
+  for (auto pair : mSpheres)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateSphere(json, pair.second);
+  }
+  for (auto pair : mCapsules)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateCapsule(json, pair.second);
+  }
+  for (auto pair : mLines)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateLine(json, pair.second);
+  }
+  for (auto pair : mTextures)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateTexture(json, pair.second);
+  }
+  for (auto pair : mMeshes)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateMesh(json, pair.second);
+  }
+  for (auto pair : mText)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateText(json, pair.second);
+  }
+  for (auto pair : mButtons)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateButton(json, pair.second);
+  }
+  for (auto pair : mSliders)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreateSlider(json, pair.second);
+  }
+  for (auto pair : mPlots)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeCreatePlot(json, pair.second);
+  }
+  for (auto key : mMouseInteractionEnabled)
+  {
+    if (isFirst)
+      isFirst = false;
+    else
+      json << ",";
+    encodeEnableMouseInteraction(json, key);
+  }
+
+  json << "]";
+
+  return json.str();
+}
+
+/// This returns the compact ids of every object with a transform, which key
+/// the binary transform frames, indexed by object key
+std::unordered_map<std::string, uint32_t> GUIWebsocketServer::getObjectIds()
+{
+  const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+
+  std::unordered_map<std::string, uint32_t> ids;
+  for (auto& pair : mTransforms)
+  {
+    ids[pair.first] = pair.second.id;
+  }
+  return ids;
+}
+
 /// This tells us whether or not to automatically flush after each command
 void GUIWebsocketServer::setAutoflush(bool autoflush)
 {
   mAutoflush = autoflush;
 }
 
-/// This sends the current list of commands to the web GUI
+/// This sends the current list of commands to the web GUI, followed by a
+/// binary frame holding any object transforms that changed since the last
+/// frame each client received
 void GUIWebsocketServer::flush()
 {
+  // Always take globalMutex before mJsonMutex, which is the order every
+  // command that queues JSON acquires them in
+  const std::lock_guard<std::recursive_mutex> globalLock(this->globalMutex);
   const std::lock_guard<std::recursive_mutex> lock(mJsonMutex);
 
   mJson << "]";
   std::string json = mJson.str();
-  if (mServing)
+  // Commands go out before transforms, so that clients have created any new
+  // objects before they receive updates for them
+  if (mServing && mMessagesQueued > 0)
   {
     try
     {
@@ -492,6 +542,32 @@ void GUIWebsocketServer::flush()
   */
   mJson = std::stringstream();
   mJson << "[";
+
+  flushTransforms();
+}
+
+/// This toggles whether object position and rotation updates are sent as
+/// packed binary frames keyed by compact object ids (the default), rather than
+/// as individual JSON commands
+void GUIWebsocketServer::setUseBinaryTransforms(bool useBinary)
+{
+  const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+  mUseBinaryTransforms = useBinary;
+}
+
+/// Position and rotation updates that move an object by less than this amount
+/// since the last transform that was sent for it are dropped
+void GUIWebsocketServer::setTransformUpdateThreshold(s_t threshold)
+{
+  const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+  mTransformThreshold = threshold;
+}
+
+/// This caps how many binary transform frames each client receives per second
+void GUIWebsocketServer::setMaxTransformUpdatesPerSecond(s_t updatesPerSecond)
+{
+  const std::lock_guard<std::recursive_mutex> lock(this->globalMutex);
+  mMinTransformInterval = updatesPerSecond > 0 ? 1.0 / updatesPerSecond : 0.0;
 }
 
 /// This is a high-level command that creates/updates all the shapes in a
@@ -818,6 +894,12 @@ GUIWebsocketServer& GUIWebsocketServer::clear()
   mBoxes.clear();
   mSpheres.clear();
   mCapsules.clear();
+  mTransforms.clear();
+  mTransformKeys.clear();
+  for (auto& pair : mClientTransforms)
+  {
+    pair.second.dirty.clear();
+  }
   mLines.clear();
   mMeshes.clear();
   mText.clear();
@@ -850,6 +932,7 @@ GUIWebsocketServer& GUIWebsocketServer::createBox(
   box.color = color;
   box.castShadows = castShadows;
   box.receiveShadows = receiveShadows;
+  registerTransform(key, pos, euler);
 
   queueCommand([this, key](std::stringstream& json) {
     encodeCreateBox(json, mBoxes[key]);
@@ -876,6 +959,7 @@ GUIWebsocketServer& GUIWebsocketServer::createSphere(
   sphere.color = color;
   sphere.castShadows = castShadows;
   sphere.receiveShadows = receiveShadows;
+  registerTransform(key, pos, Eigen::Vector3s::Zero());
 
   queueCommand([this, key](std::stringstream& json) {
     encodeCreateSphere(json, mSpheres[key]);
@@ -906,6 +990,7 @@ GUIWebsocketServer& GUIWebsocketServer::createCapsule(
   capsule.color = color;
   capsule.castShadows = castShadows;
   capsule.receiveShadows = receiveShadows;
+  registerTransform(key, pos, euler);
 
   queueCommand([this, key](std::stringstream& json) {
     encodeCreateCapsule(json, mCapsules[key]);
@@ -967,6 +1052,7 @@ GUIWebsocketServer& GUIWebsocketServer::createMesh(
   mesh.color = color;
   mesh.castShadows = castShadows;
   mesh.receiveShadows = receiveShadows;
+  registerTransform(key, pos, euler);
 
   queueCommand([this, key](std::stringstream& json) {
     encodeCreateMesh(json, mMeshes[key]);
@@ -1227,6 +1313,14 @@ GUIWebsocketServer& GUIWebsocketServer::setObjectPosition(
     mMeshes[key].pos = pos;
   }
 
+  auto transform = mTransforms.find(key);
+  if (mUseBinaryTransforms && transform != mTransforms.end())
+  {
+    transform->second.pos = pos;
+    markTransformDirty(transform->second);
+    return *this;
+  }
+
   queueCommand([&](std::stringstream& json) {
     json << "{ \"type\": \"set_object_pos\", \"key\": \"" << key
          << "\", \"pos\": ";
@@ -1256,6 +1350,14 @@ GUIWebsocketServer& GUIWebsocketServer::setObjectRotation(
     mMeshes[key].euler = euler;
   }
 
+  auto transform = mTransforms.find(key);
+  if (mUseBinaryTransforms && transform != mTransforms.end())
+  {
+    transform->second.euler = euler;
+    markTransformDirty(transform->second);
+    return *this;
+  }
+
   queueCommand([&](std::stringstream& json) {
     json << "{ \"type\": \"set_object_rotation\", \"key\": \"" << key
          << "\", \"euler\": ";
@@ -1329,6 +1431,7 @@ GUIWebsocketServer& GUIWebsocketServer::deleteObject(const std::string& key)
   mLines.erase(key);
   mMeshes.erase(key);
   mCapsules.erase(key);
+  unregisterTransform(key);
 
   queueCommand([&](std::stringstream& json) {
     json << "{ \"type\": \"delete_object\", \"key\": \"" << key << "\" }";
@@ -1836,10 +1939,187 @@ void GUIWebsocketServer::queueCommand(
   }
 }
 
+/// This assigns a compact id to an object with a transform, if it doesn't have
+/// one already, and resets its transform to the one being sent with its create
+/// command
+void GUIWebsocketServer::registerTransform(
+    const std::string& key,
+    const Eigen::Vector3s& pos,
+    const Eigen::Vector3s& euler)
+{
+  auto it = mTransforms.find(key);
+  if (it == mTransforms.end())
+  {
+    ObjectTransform transform;
+    transform.id = mNextObjectId++;
+    it = mTransforms.emplace(key, transform).first;
+    mTransformKeys[transform.id] = key;
+  }
+  ObjectTransform& transform = it->second;
+  transform.pos = pos;
+  transform.euler = euler;
+  transform.sentPos = pos;
+  transform.sentEuler = euler;
+
+  // The create command supersedes any update still waiting to be sent
+  for (auto& pair : mClientTransforms)
+  {
+    pair.second.dirty.erase(transform.id);
+  }
+}
+
+/// This drops the transform state of an object that has been deleted
+void GUIWebsocketServer::unregisterTransform(const std::string& key)
+{
+  auto it = mTransforms.find(key);
+  if (it == mTransforms.end())
+    return;
+  uint32_t id = it->second.id;
+  for (auto& pair : mClientTransforms)
+  {
+    pair.second.dirty.erase(id);
+  }
+  mTransformKeys.erase(id);
+  mTransforms.erase(it);
+}
+
+/// This marks an object's transform as needing to be sent to every client
+void GUIWebsocketServer::markTransformDirty(ObjectTransform& transform)
+{
+  s_t posChange = (transform.pos - transform.sentPos).cwiseAbs().maxCoeff();
+  s_t eulerChange
+      = (transform.euler - transform.sentEuler).cwiseAbs().maxCoeff();
+  if (posChange <= mTransformThreshold && eulerChange <= mTransformThreshold)
+    return;
+
+  transform.sentPos = transform.pos;
+  transform.sentEuler = transform.euler;
+  for (auto& pair : mClientTransforms)
+  {
+    pair.second.dirty.insert(transform.id);
+  }
+
+  if (mAutoflush)
+  {
+    flush();
+  }
+}
+
+/// This sends each client whose rate limit allows it a binary frame with the
+/// transforms it hasn't received yet. If any client is still waiting on its
+/// rate limit, this schedules another flush for when the limit expires.
+void GUIWebsocketServer::flushTransforms()
+{
+  if (!mServing)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  const auto minInterval
+      = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(
+              static_cast<double>(mMinTransformInterval)));
+  bool anyWaiting = false;
+  auto nextAllowed = std::chrono::steady_clock::time_point::max();
+  for (auto& pair : mClientTransforms)
+  {
+    ClientTransformState& client = pair.second;
+    if (client.dirty.empty())
+      continue;
+    if (now - client.lastSent < minInterval)
+    {
+      anyWaiting = true;
+      nextAllowed = std::min(nextAllowed, client.lastSent + minInterval);
+      continue;
+    }
+
+    mServer->sendBinary(pair.first, encodeTransformFrame(client.dirty));
+    client.dirty.clear();
+    client.lastSent = now;
+  }
+
+  if (anyWaiting)
+  {
+    scheduleTransformFlush(nextAllowed - now);
+  }
+}
+
+/// This runs flushTransforms() once `delay` has passed, on the server's event
+/// loop, unless a flush is already scheduled
+void GUIWebsocketServer::scheduleTransformFlush(
+    std::chrono::steady_clock::duration delay)
+{
+  if (mTransformFlushScheduled || mServer == nullptr)
+    return;
+  if (mTransformFlushTimer == nullptr)
+  {
+    mTransformFlushTimer
+        = std::make_unique<asio::steady_timer>(mServer->eventLoop);
+  }
+  mTransformFlushScheduled = true;
+  mTransformFlushTimer->expires_from_now(delay);
+  mTransformFlushTimer->async_wait([this](const asio::error_code& error) {
+    if (error)
+      return;
+    const std::lock_guard<std::recursive_mutex> globalLock(this->globalMutex);
+    const std::lock_guard<std::recursive_mutex> lock(mJsonMutex);
+    mTransformFlushScheduled = false;
+    // If there are commands waiting on a flush(), they might create objects
+    // these transforms refer to, so leave the transforms for that flush()
+    if (mMessagesQueued > 0)
+      return;
+    flushTransforms();
+  });
+}
+
+/// This packs a set of object transforms into a binary frame
+std::string GUIWebsocketServer::encodeTransformFrame(
+    const std::unordered_set<uint32_t>& ids)
+{
+  const uint32_t count = static_cast<uint32_t>(ids.size());
+  std::string frame(sizeof(uint32_t) * (2 + 7 * count), '\0');
+  char* header = &frame[0];
+  char* idOut = header + 2 * sizeof(uint32_t);
+  char* posOut = idOut + count * sizeof(uint32_t);
+  char* eulerOut = posOut + 3 * count * sizeof(float);
+
+  const uint32_t tag = BINARY_TRANSFORM_FRAME;
+  std::memcpy(header, &tag, sizeof(uint32_t));
+  std::memcpy(header + sizeof(uint32_t), &count, sizeof(uint32_t));
+  for (uint32_t id : ids)
+  {
+    const ObjectTransform& transform = mTransforms[mTransformKeys[id]];
+    float pos[3];
+    float euler[3];
+    for (int i = 0; i < 3; i++)
+    {
+      pos[i] = static_cast<float>(transform.pos(i));
+      euler[i] = static_cast<float>(transform.euler(i));
+    }
+    std::memcpy(idOut, &id, sizeof(uint32_t));
+    std::memcpy(posOut, pos, sizeof(pos));
+    std::memcpy(eulerOut, euler, sizeof(euler));
+    idOut += sizeof(uint32_t);
+    posOut += sizeof(pos);
+    eulerOut += sizeof(euler);
+  }
+  return frame;
+}
+
+void GUIWebsocketServer::encodeObjectId(
+    std::stringstream& json, const std::string& key)
+{
+  auto it = mTransforms.find(key);
+  if (it != mTransforms.end())
+  {
+    json << ", \"id\": " << it->second.id;
+  }
+}
+
 void GUIWebsocketServer::encodeCreateBox(std::stringstream& json, Box& box)
 {
-  json << "{ \"type\": \"create_box\", \"key\": \"" << box.key
-       << "\", \"size\": ";
+  json << "{ \"type\": \"create_box\", \"key\": \"" << box.key << "\"";
+  encodeObjectId(json, box.key);
+  json << ", \"size\": ";
   vec3ToJson(json, box.size);
   json << ", \"pos\": ";
   vec3ToJson(json, box.pos);
@@ -1855,8 +2135,9 @@ void GUIWebsocketServer::encodeCreateBox(std::stringstream& json, Box& box)
 void GUIWebsocketServer::encodeCreateSphere(
     std::stringstream& json, Sphere& sphere)
 {
-  json << "{ \"type\": \"create_sphere\", \"key\": \"" << sphere.key
-       << "\", \"radius\": " << sphere.radius;
+  json << "{ \"type\": \"create_sphere\", \"key\": \"" << sphere.key << "\"";
+  encodeObjectId(json, sphere.key);
+  json << ", \"radius\": " << sphere.radius;
   json << ", \"pos\": ";
   vec3ToJson(json, sphere.pos);
   json << ", \"color\": ";
@@ -1871,7 +2152,9 @@ void GUIWebsocketServer::encodeCreateCapsule(
     std::stringstream& json, Capsule& capsule)
 {
   json << "{ \"type\": \"create_capsule\", \"key\": \"" << capsule.key
-       << "\", \"radius\": " << capsule.radius
+       << "\"";
+  encodeObjectId(json, capsule.key);
+  json << ", \"radius\": " << capsule.radius
        << ", \"height\": " << capsule.height;
   json << ", \"pos\": ";
   vec3ToJson(json, capsule.pos);
@@ -1905,8 +2188,9 @@ void GUIWebsocketServer::encodeCreateLine(std::stringstream& json, Line& line)
 
 void GUIWebsocketServer::encodeCreateMesh(std::stringstream& json, Mesh& mesh)
 {
-  json << "{ \"type\": \"create_mesh\", \"key\": \"" << mesh.key;
-  json << "\", \"vertices\": [";
+  json << "{ \"type\": \"create_mesh\", \"key\": \"" << mesh.key << "\"";
+  encodeObjectId(json, mesh.key);
+  json << ", \"vertices\": [";
   bool firstPoint = true;
   for (Eigen::Vector3s& vertex : mesh.vertices)
   {
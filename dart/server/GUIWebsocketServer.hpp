@@ -1,8 +1,11 @@
 #ifndef DART_GUI_SERVER
 #define DART_GUI_SERVER
 
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -14,6 +17,7 @@
 
 #include <Eigen/Dense>
 #include <asio/io_service.hpp>
+#include <asio/steady_timer.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/cimport.h>
 #include <assimp/postprocess.h>
@@ -40,6 +44,9 @@ namespace server {
 class GUIWebsocketServer
 {
 public:
+  /// The tag at the start of every binary frame carrying object transforms
+  static constexpr uint32_t BINARY_TRANSFORM_FRAME = 1;
+
   GUIWebsocketServer();
 
   ~GUIWebsocketServer();
@@ -80,12 +87,39 @@ public:
   /// Returns true if a key is currently being pressed
   bool isKeyDown(const std::string& key) const;
 
+  /// This returns the JSON commands that recreate every object and UI
+  /// element currently in the GUI. This is what gets sent to newly connected
+  /// clients.
+  std::string getSceneJson();
+
+  /// This returns the compact ids of every object with a transform, which key
+  /// the binary transform frames, indexed by object key
+  std::unordered_map<std::string, uint32_t> getObjectIds();
+
   /// This tells us whether or not to automatically flush after each command
   void setAutoflush(bool autoflush);
 
-  /// This sends the current list of commands to the web GUI
+  /// This sends the current list of commands to the web GUI, followed by a
+  /// binary frame holding any object transforms that changed since the last
+  /// frame each client received
   void flush();
 
+  /// This toggles whether object position and rotation updates are sent as
+  /// packed binary frames keyed by compact object ids (the default), rather
+  /// than as individual JSON commands
+  void setUseBinaryTransforms(bool useBinary);
+
+  /// Position and rotation updates that move an object by less than this
+  /// amount (max-norm, in meters or radians) since the last transform that was
+  /// sent for it are dropped. Defaults to 0, which sends any change.
+  void setTransformUpdateThreshold(s_t threshold);
+
+  /// This caps how many binary transform frames each client receives per
+  /// second. Updates for a client that is being throttled are coalesced, so
+  /// it receives only the latest transform of each object once its next frame
+  /// is due. A value <= 0 disables rate limiting (the default).
+  void setMaxTransformUpdatesPerSecond(s_t updatesPerSecond);
+
   /// This is a high-level command that creates/updates all the shapes in a
   /// world by calling the lower-level commands
   GUIWebsocketServer& renderWorld(
@@ -478,8 +512,83 @@ protected:
   };
   std::unordered_map<std::string, Plot> mPlots;
 
+  // Binary transform protocol. Every object that has a transform (boxes,
+  // spheres, capsules and meshes) gets a compact id when it's created, which
+  // is sent to the client as part of its create command. Subsequent position
+  // and rotation updates are tracked here, and flush() packs the ones that
+  // moved past mTransformThreshold into a single binary frame.
+  struct ObjectTransform
+  {
+    uint32_t id;
+    Eigen::Vector3s pos;
+    Eigen::Vector3s euler;
+    // The last transform that was queued for sending, used for thresholding
+    Eigen::Vector3s sentPos;
+    Eigen::Vector3s sentEuler;
+  };
+  std::unordered_map<std::string, ObjectTransform> mTransforms;
+  std::unordered_map<uint32_t, std::string> mTransformKeys;
+  uint32_t mNextObjectId;
+  bool mUseBinaryTransforms;
+  s_t mTransformThreshold;
+  // Minimum time between two binary frames sent to the same client, in seconds
+  s_t mMinTransformInterval;
+
+  // Each client keeps its own set of ids whose transforms it hasn't received
+  // yet, so that rate limited clients coalesce updates rather than drop them
+  struct ClientTransformState
+  {
+    std::unordered_set<uint32_t> dirty;
+    std::chrono::steady_clock::time_point lastSent;
+  };
+  std::map<
+      ClientConnection,
+      ClientTransformState,
+      std::owner_less<ClientConnection>>
+      mClientTransforms;
+
+  // When a client's rate limit holds back pending transforms, this fires on
+  // the server's event loop once the limit allows them through, so the last
+  // updates before the scene goes quiet still reach the client
+  std::unique_ptr<asio::steady_timer> mTransformFlushTimer;
+  bool mTransformFlushScheduled;
+
   void queueCommand(std::function<void(std::stringstream&)> writeCommand);
 
+  /// This assigns a compact id to an object with a transform, if it doesn't
+  /// have one already, and resets its transform to the one being sent with its
+  /// create command
+  void registerTransform(
+      const std::string& key,
+      const Eigen::Vector3s& pos,
+      const Eigen::Vector3s& euler);
+
+  /// This drops the transform state of an object that has been deleted
+  void unregisterTransform(const std::string& key);
+
+  /// This marks an object's transform as needing to be sent to every client
+  void markTransformDirty(ObjectTransform& transform);
+
+  /// This sends each client whose rate limit allows it a binary frame with
+  /// the transforms it hasn't received yet. If any client is still waiting on
+  /// its rate limit, this schedules another flush for when the limit expires.
+  void flushTransforms();
+
+  /// This runs flushTransforms() once `delay` has passed, on the server's
+  /// event loop, unless a flush is already scheduled
+  void scheduleTransformFlush(std::chrono::steady_clock::duration delay);
+
+  /// This packs a set of object transforms into a binary frame. The layout is
+  /// 4-byte aligned so clients can read it with typed array views:
+  ///
+  ///   uint32 BINARY_TRANSFORM_FRAME, uint32 count, uint32 ids[count],
+  ///   float32 pos[3 * count], float32 euler[3 * count]
+  ///
+  /// All values are little-endian.
+  std::string encodeTransformFrame(const std::unordered_set<uint32_t>& ids);
+
+  void encodeObjectId(std::stringstream& json, const std::string& key);
+
   void encodeCreateBox(std::stringstream& json, Box& box);
   void encodeCreateSphere(std::stringstream& json, Sphere& sphere);
   void encodeCreateCapsule(std::stringstream& json, Capsule& capsule);
@@ -0,0 +1,285 @@
+#include "dart/server/SceneRecorder.hpp"
+
+#include <cstring>
+
+#include "dart/common/Console.hpp"
+#include "dart/neural/RestorableSnapshot.hpp"
+#include "dart/simulation/World.hpp"
+#include "dart/trajectory/TrajectoryRollout.hpp"
+
+namespace dart {
+namespace server {
+
+namespace {
+
+const char SCENE_MAGIC[8] = {'N', 'I', 'M', 'S', 'C', 'E', 'N', 'E'};
+
+// magic, version, numObjects, numFrames, frameDuration, sceneJsonBytes
+const std::size_t SCENE_HEADER_BYTES = 8 + 5 * 4;
+
+//==============================================================================
+template <typename T>
+void appendRaw(std::string& out, const T& value)
+{
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//==============================================================================
+template <typename T>
+bool readRaw(std::ifstream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return static_cast<bool>(in);
+}
+
+} // namespace
+
+constexpr uint32_t SceneRecorder::FORMAT_VERSION;
+
+//==============================================================================
+SceneRecorder::SceneRecorder(s_t frameDuration)
+  : mFrameDuration(frameDuration), mNumFrames(0)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void SceneRecorder::recordFrame(const std::shared_ptr<simulation::World>& world)
+{
+  // Contact forces are left out, since the world's last collision result
+  // doesn't correspond to the recorded state
+  mGui.renderWorld(world, "world", false, false);
+
+  if (mNumFrames == 0)
+  {
+    mSceneJson = mGui.getSceneJson();
+    mKeys.clear();
+    for (auto& pair : mGui.getObjectIds())
+    {
+      if (pair.second >= mKeys.size())
+        mKeys.resize(pair.second + 1);
+      mKeys[pair.second] = pair.first;
+    }
+  }
+
+  std::size_t offset = mFrames.size();
+  mFrames.resize(offset + 6 * mKeys.size(), 0.0f);
+  for (std::size_t i = 0; i < mKeys.size(); i++)
+  {
+    if (mKeys[i].empty() || !mGui.hasObject(mKeys[i]))
+      continue;
+    Eigen::Vector3s pos = mGui.getObjectPosition(mKeys[i]);
+    Eigen::Vector3s euler = mGui.getObjectRotation(mKeys[i]);
+    float* row = &mFrames[offset + 6 * i];
+    for (int j = 0; j < 3; j++)
+    {
+      row[j] = static_cast<float>(pos(j));
+      row[3 + j] = static_cast<float>(euler(j));
+    }
+  }
+  mNumFrames++;
+}
+
+//==============================================================================
+void SceneRecorder::recordTrajectory(
+    const std::shared_ptr<simulation::World>& world,
+    const trajectory::TrajectoryRollout* rollout)
+{
+  neural::RestorableSnapshot snapshot(world);
+
+  const Eigen::Ref<const Eigen::MatrixXs> poses
+      = rollout->getPosesConst("identity");
+  for (int t = 0; t < poses.cols(); t++)
+  {
+    world->setPositions(poses.col(t));
+    recordFrame(world);
+  }
+
+  snapshot.restore();
+}
+
+//==============================================================================
+int SceneRecorder::getNumFrames() const
+{
+  return mNumFrames;
+}
+
+//==============================================================================
+int SceneRecorder::getNumObjects() const
+{
+  return static_cast<int>(mKeys.size());
+}
+
+//==============================================================================
+const std::string& SceneRecorder::getSceneJson() const
+{
+  return mSceneJson;
+}
+
+//==============================================================================
+std::string SceneRecorder::serialize() const
+{
+  const uint32_t numObjects = static_cast<uint32_t>(mKeys.size());
+  const uint32_t numFrames = static_cast<uint32_t>(mNumFrames);
+  const float frameDuration = static_cast<float>(mFrameDuration);
+  const uint32_t sceneJsonBytes = static_cast<uint32_t>(mSceneJson.size());
+  const std::size_t padding = (4 - sceneJsonBytes % 4) % 4;
+
+  std::string out;
+  out.reserve(
+      SCENE_HEADER_BYTES + sceneJsonBytes + padding
+      + mFrames.size() * sizeof(float));
+  out.append(SCENE_MAGIC, sizeof(SCENE_MAGIC));
+  appendRaw(out, FORMAT_VERSION);
+  appendRaw(out, numObjects);
+  appendRaw(out, numFrames);
+  appendRaw(out, frameDuration);
+  appendRaw(out, sceneJsonBytes);
+  out.append(mSceneJson);
+  out.append(padding, '\0');
+  out.append(
+      reinterpret_cast<const char*>(mFrames.data()),
+      mFrames.size() * sizeof(float));
+  return out;
+}
+
+//==============================================================================
+bool SceneRecorder::writeToFile(const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    dterr << "[SceneRecorder::writeToFile] Could not open \"" << path
+          << "\" for writing.\n";
+    return false;
+  }
+  std::string data = serialize();
+  file.write(data.data(), data.size());
+  return static_cast<bool>(file);
+}
+
+//==============================================================================
+bool SceneRecorder::exportTrajectory(
+    const std::string& path,
+    const std::shared_ptr<simulation::World>& world,
+    const trajectory::TrajectoryRollout* rollout)
+{
+  SceneRecorder recorder(world->getTimeStep());
+  recorder.recordTrajectory(world, rollout);
+  return recorder.writeToFile(path);
+}
+
+//==============================================================================
+SceneRecording::SceneRecording()
+  : mNumObjects(0), mNumFrames(0), mFrameDuration(0.0), mFramesOffset(0)
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::shared_ptr<SceneRecording> SceneRecording::open(const std::string& path)
+{
+  std::shared_ptr<SceneRecording> recording(new SceneRecording());
+  std::ifstream& file = recording->mFile;
+  file.open(path, std::ios::binary);
+  if (!file)
+  {
+    dterr << "[SceneRecording::open] Could not open \"" << path << "\".\n";
+    return nullptr;
+  }
+
+  char magic[8];
+  uint32_t version;
+  uint32_t numObjects;
+  uint32_t numFrames;
+  float frameDuration;
+  uint32_t sceneJsonBytes;
+  file.read(magic, sizeof(magic));
+  if (!file || std::memcmp(magic, SCENE_MAGIC, sizeof(magic)) != 0
+      || !readRaw(file, version) || !readRaw(file, numObjects)
+      || !readRaw(file, numFrames) || !readRaw(file, frameDuration)
+      || !readRaw(file, sceneJsonBytes))
+  {
+    dterr << "[SceneRecording::open] \"" << path
+          << "\" is not a scene file.\n";
+    return nullptr;
+  }
+  if (version != SceneRecorder::FORMAT_VERSION)
+  {
+    dterr << "[SceneRecording::open] \"" << path << "\" has format version "
+          << version << ", but we can only read version "
+          << SceneRecorder::FORMAT_VERSION << ".\n";
+    return nullptr;
+  }
+
+  recording->mSceneJson.resize(sceneJsonBytes);
+  file.read(&recording->mSceneJson[0], sceneJsonBytes);
+  if (!file)
+  {
+    dterr << "[SceneRecording::open] \"" << path << "\" is truncated.\n";
+    return nullptr;
+  }
+
+  recording->mNumObjects = static_cast<int>(numObjects);
+  recording->mNumFrames = static_cast<int>(numFrames);
+  recording->mFrameDuration = frameDuration;
+  recording->mFramesOffset
+      = SCENE_HEADER_BYTES + sceneJsonBytes + (4 - sceneJsonBytes % 4) % 4;
+  return recording;
+}
+
+//==============================================================================
+int SceneRecording::getNumFrames() const
+{
+  return mNumFrames;
+}
+
+//==============================================================================
+int SceneRecording::getNumObjects() const
+{
+  return mNumObjects;
+}
+
+//==============================================================================
+s_t SceneRecording::getFrameDuration() const
+{
+  return mFrameDuration;
+}
+
+//==============================================================================
+const std::string& SceneRecording::getSceneJson() const
+{
+  return mSceneJson;
+}
+
+//==============================================================================
+Eigen::MatrixXs SceneRecording::readFrame(int frame)
+{
+  assert(frame >= 0 && frame < mNumFrames);
+
+  std::vector<float> raw(6 * mNumObjects);
+  mFile.clear();
+  mFile.seekg(
+      mFramesOffset
+      + static_cast<std::streamoff>(frame) * raw.size() * sizeof(float));
+  mFile.read(reinterpret_cast<char*>(raw.data()), raw.size() * sizeof(float));
+  if (!mFile)
+  {
+    dterr << "[SceneRecording::readFrame] Failed to read frame " << frame
+          << ".\n";
+    return Eigen::MatrixXs::Zero(6, mNumObjects);
+  }
+
+  Eigen::MatrixXs result(6, mNumObjects);
+  for (int i = 0; i < mNumObjects; i++)
+  {
+    for (int j = 0; j < 6; j++)
+    {
+      result(j, i) = static_cast<s_t>(raw[6 * i + j]);
+    }
+  }
+  return result;
+}
+
+} // namespace server
+} // namespace dart
@@ -0,0 +1,131 @@
+#ifndef DART_SCENE_RECORDER
+#define DART_SCENE_RECORDER
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/math/MathTypes.hpp"
+#include "dart/server/GUIWebsocketServer.hpp"
+
+namespace dart {
+
+namespace simulation {
+class World;
+}
+
+namespace trajectory {
+class TrajectoryRollout;
+}
+
+namespace server {
+
+/// This records a sequence of world states into a compact scene file that the
+/// web GUI can load and scrub locally, without replaying the simulation or
+/// holding a socket open. The shapes are written once, as the same JSON
+/// commands GUIWebsocketServer sends to a newly connected client, followed by
+/// fixed-size binary frames of per-object transforms so any frame can be read
+/// by seeking straight to it. The file layout (all little-endian, 4-byte
+/// aligned) is:
+///
+///   char[8] "NIMSCENE", uint32 version, uint32 numObjects, uint32 numFrames,
+///   float32 frameDuration, uint32 sceneJsonBytes,
+///   char sceneJson[sceneJsonBytes] (zero-padded to a multiple of 4),
+///   float32 frames[numFrames][numObjects][6]
+///
+/// Each frame row holds (pos_x, pos_y, pos_z, rot_x, rot_y, rot_z) for the
+/// object whose compact id (the "id" field in its create command) is the row
+/// index.
+class SceneRecorder
+{
+public:
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  /// `frameDuration` is the playback time between frames, in seconds
+  SceneRecorder(s_t frameDuration = 0.01);
+
+  /// This records the current state of the world as the next frame. The
+  /// shapes in the scene are captured on the first call, so objects that only
+  /// appear in later frames are not recorded.
+  void recordFrame(const std::shared_ptr<simulation::World>& world);
+
+  /// This records one frame per timestep of a rollout. The world's state is
+  /// restored afterwards.
+  void recordTrajectory(
+      const std::shared_ptr<simulation::World>& world,
+      const trajectory::TrajectoryRollout* rollout);
+
+  /// Returns the number of frames recorded so far
+  int getNumFrames() const;
+
+  /// Returns the number of objects whose transforms are recorded per frame
+  int getNumObjects() const;
+
+  /// This returns the JSON commands that create the recorded shapes
+  const std::string& getSceneJson() const;
+
+  /// This packs the recording into the scene file format
+  std::string serialize() const;
+
+  /// This writes the recording to a scene file. Returns false if the file
+  /// couldn't be written.
+  bool writeToFile(const std::string& path) const;
+
+  /// This is a convenience method to record a rollout and write it to `path`
+  /// in one go, using the world's timestep as the frame duration
+  static bool exportTrajectory(
+      const std::string& path,
+      const std::shared_ptr<simulation::World>& world,
+      const trajectory::TrajectoryRollout* rollout);
+
+protected:
+  s_t mFrameDuration;
+  // Used to turn the world into the same shapes and transforms as the live GUI
+  GUIWebsocketServer mGui;
+  std::string mSceneJson;
+  // The key of the object recorded in each row of a frame
+  std::vector<std::string> mKeys;
+  std::vector<float> mFrames;
+  int mNumFrames;
+};
+
+/// This reads scene files written by SceneRecorder, seeking directly to
+/// individual frames rather than loading the whole file
+class SceneRecording
+{
+public:
+  /// This opens a scene file, and reads its header. Returns nullptr if the
+  /// file can't be read or isn't a scene file.
+  static std::shared_ptr<SceneRecording> open(const std::string& path);
+
+  int getNumFrames() const;
+
+  int getNumObjects() const;
+
+  s_t getFrameDuration() const;
+
+  const std::string& getSceneJson() const;
+
+  /// This reads a single frame, as a (6 x numObjects) matrix where each column
+  /// is (pos_x, pos_y, pos_z, rot_x, rot_y, rot_z) for one object
+  Eigen::MatrixXs readFrame(int frame);
+
+protected:
+  SceneRecording();
+
+  std::ifstream mFile;
+  int mNumObjects;
+  int mNumFrames;
+  s_t mFrameDuration;
+  std::string mSceneJson;
+  std::streamoff mFramesOffset;
+};
+
+} // namespace server
+} // namespace dart
+
+#endif
@@ -148,6 +148,27 @@ void WebsocketServer::send(ClientConnection conn, const string& message)
   }
 }
 
+// Sends a binary message to a specific client
+void WebsocketServer::sendBinary(ClientConnection conn, const string& data)
+{
+  // Send the message data to the client (will happen on the networking thread's
+  // event loop)
+  try
+  {
+    this->endpoint.send(
+        conn, data.data(), data.size(), websocketpp::frame::opcode::binary);
+  }
+  catch (websocketpp::exception const& e)
+  {
+    dterr << e.what() << std::endl;
+    dterr << "Exception thrown from endpoint.send(). Continuing." << std::endl;
+  }
+  catch (...)
+  {
+    dterr << "Hit unknown error in endpoint.send(). Continuing." << std::endl;
+  }
+}
+
 void WebsocketServer::broadcastJsonObject(
     const string& messageType, const Json::Value& arguments)
 {
@@ -68,6 +68,9 @@ public:
   // Sends a raw text message to a specific client
   void send(ClientConnection conn, const string& message);
 
+  // Sends a binary message to a specific client
+  void sendBinary(ClientConnection conn, const string& data);
+
   // Sends a message to all connected clients
   //(Note: the data transmission will take place on the thread that called
   // WebsocketServer::run())
@@ -38,36 +38,148 @@
 
 #include "dart/simulation/Recording.hpp"
 
+#include <cassert>
+#include <cstring>
 #include <iostream>
 
+#include "dart/common/Console.hpp"
 #include "dart/dynamics/Skeleton.hpp"
 
 namespace dart {
 namespace simulation {
 
+namespace {
+
+// A recording file is a header, followed by chunks, followed by an index
+// footer. The footer is only written by closeStream(), so files from a crashed
+// writer are recovered by scanning the chunks in order. Everything is written
+// in host byte order, with scalars stored as doubles.
+//
+// Header: "NREC", int32 version, int32 flags, int32 numSkeletons,
+//         int32 dofs[numSkeletons], int32 chunkSize
+// Chunk: int32 numDofs, int32 numFrames, int32 numContacts,
+//        uint64 payloadBytes, payload
+// Footer: [int32 startFrame, int32 numFrames, uint64 offset] per chunk,
+//         int32 numChunks, uint64 footerOffset, "NRIX"
+const char RECORDING_MAGIC[4] = {'N', 'R', 'E', 'C'};
+const char RECORDING_INDEX_MAGIC[4] = {'N', 'R', 'I', 'X'};
+const int32_t RECORDING_VERSION = 1;
+const int32_t RECORDING_FLAG_COMPRESSED = 1;
+const std::size_t RECORDING_FOOTER_TAIL
+    = sizeof(int32_t) + sizeof(uint64_t) + 4;
+
+template <typename T>
+void writeRaw(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readRaw(std::istream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return static_cast<bool>(in);
+}
+
+template <typename T>
+void appendRaw(std::vector<char>& out, const T& value)
+{
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// This run-length encodes runs of zero bytes, which is what XOR-ing a smooth
+// trajectory against its previous frame mostly produces. Each token is a tag
+// byte: tags below 128 are followed by (tag + 1) literal bytes, and tags from
+// 128 up stand for (tag - 127) zero bytes.
+void compressZeroRuns(const std::vector<char>& in, std::vector<char>& out)
+{
+  out.clear();
+  std::size_t i = 0;
+  while (i < in.size())
+  {
+    std::size_t run = 0;
+    while (i + run < in.size() && in[i + run] == 0 && run < 128)
+      run++;
+    if (run >= 2 || (run == 1 && i + 1 == in.size()))
+    {
+      out.push_back(static_cast<char>(127 + run));
+      i += run;
+      continue;
+    }
+    std::size_t literalStart = i;
+    std::size_t literal = 0;
+    while (i < in.size() && literal < 128)
+    {
+      // Stop the literal as soon as a zero run worth encoding starts
+      if (in[i] == 0 && i + 1 < in.size() && in[i + 1] == 0)
+        break;
+      i++;
+      literal++;
+    }
+    out.push_back(static_cast<char>(literal - 1));
+    out.insert(
+        out.end(),
+        in.begin() + literalStart,
+        in.begin() + literalStart + literal);
+  }
+}
+
+bool decompressZeroRuns(
+    const std::vector<char>& in, std::vector<char>& out, std::size_t size)
+{
+  out.clear();
+  out.reserve(size);
+  std::size_t i = 0;
+  while (i < in.size())
+  {
+    unsigned char tag = static_cast<unsigned char>(in[i++]);
+    if (tag >= 128)
+    {
+      out.insert(out.end(), tag - 127, 0);
+    }
+    else
+    {
+      std::size_t literal = tag + 1;
+      if (i + literal > in.size())
+        return false;
+      out.insert(out.end(), in.begin() + i, in.begin() + i + literal);
+      i += literal;
+    }
+  }
+  return out.size() == size;
+}
+
+} // namespace
+
 //==============================================================================
 Recording::Recording(const std::vector<dynamics::SkeletonPtr>& _skeletons)
+  : mNumFrames(0), mChunkSize(256), mCompress(false), mCachedChunkIdx(-1)
 {
   for (std::size_t i = 0; i < _skeletons.size(); i++)
     mNumGenCoordsForSkeletons.push_back(_skeletons[i]->getNumDofs());
+  updateDofOffsets();
 }
 
 //==============================================================================
 Recording::Recording(const std::vector<int>& _skelDofs)
+  : mNumFrames(0), mChunkSize(256), mCompress(false), mCachedChunkIdx(-1)
 {
   for (std::size_t i = 0; i < _skelDofs.size(); i++)
     mNumGenCoordsForSkeletons.push_back(_skelDofs[i]);
+  updateDofOffsets();
 }
 
 //==============================================================================
 Recording::~Recording()
 {
+  closeStream();
 }
 
 //==============================================================================
 int Recording::getNumFrames() const
 {
-  return mBakedStates.size();
+  return mNumFrames;
 }
 
 //==============================================================================
@@ -85,57 +197,319 @@ int Recording::getNumDofs(int _skelIdx) const
 //==============================================================================
 int Recording::getNumContacts(int _frameIdx) const
 {
-  int totalDofs = 0;
-  for (std::size_t i = 0; i < mNumGenCoordsForSkeletons.size(); i++)
-    totalDofs += mNumGenCoordsForSkeletons[i];
-  return (mBakedStates[_frameIdx].size() - totalDofs) / 6;
+  int localIdx;
+  std::shared_ptr<const Chunk> chunk = getChunk(_frameIdx, localIdx);
+  return chunk->mContactOffsets[localIdx + 1]
+         - chunk->mContactOffsets[localIdx];
 }
 
 //==============================================================================
 Eigen::VectorXs Recording::getConfig(int _frameIdx, int _skelIdx) const
 {
-  int index = 0;
-  for (int i = 0; i < _skelIdx; i++)
-    index += mNumGenCoordsForSkeletons[i];
-  return mBakedStates[_frameIdx].segment(index, getNumDofs(_skelIdx));
+  int localIdx;
+  std::shared_ptr<const Chunk> chunk = getChunk(_frameIdx, localIdx);
+  return Eigen::Map<const Eigen::VectorXs>(
+      chunk->mPositions.data() + localIdx * chunk->mNumDofs
+          + mDofOffsets[_skelIdx],
+      getNumDofs(_skelIdx));
 }
 
 //==============================================================================
 s_t Recording::getGenCoord(int _frameIdx, int _skelIdx, int _dofIdx) const
 {
-  int index = 0;
-  for (int i = 0; i < _skelIdx; i++)
-    index += mNumGenCoordsForSkeletons[i];
-  return mBakedStates[_frameIdx][index + _dofIdx];
+  int localIdx;
+  std::shared_ptr<const Chunk> chunk = getChunk(_frameIdx, localIdx);
+  return chunk->mPositions
+      [localIdx * chunk->mNumDofs + mDofOffsets[_skelIdx] + _dofIdx];
 }
 
 //==============================================================================
 Eigen::Vector3s Recording::getContactPoint(int _frameIdx, int _contactIdx) const
 {
-  int totalDofs = 0;
-  for (std::size_t i = 0; i < mNumGenCoordsForSkeletons.size(); i++)
-    totalDofs += mNumGenCoordsForSkeletons[i];
-  return mBakedStates[_frameIdx].segment(totalDofs + _contactIdx * 6, 3);
+  int localIdx;
+  std::shared_ptr<const Chunk> chunk = getChunk(_frameIdx, localIdx);
+  return Eigen::Map<const Eigen::Vector3s>(
+      chunk->mContacts.data()
+      + (chunk->mContactOffsets[localIdx] + _contactIdx) * 6);
 }
 
 //==============================================================================
 Eigen::Vector3s Recording::getContactForce(int _frameIdx, int _contactIdx) const
 {
-  int totalDofs = 0;
-  for (std::size_t i = 0; i < mNumGenCoordsForSkeletons.size(); i++)
-    totalDofs += mNumGenCoordsForSkeletons[i];
-  return mBakedStates[_frameIdx].segment(totalDofs + _contactIdx * 6 + 3, 3);
+  int localIdx;
+  std::shared_ptr<const Chunk> chunk = getChunk(_frameIdx, localIdx);
+  return Eigen::Map<const Eigen::Vector3s>(
+      chunk->mContacts.data()
+      + (chunk->mContactOffsets[localIdx] + _contactIdx) * 6 + 3);
+}
+
+//==============================================================================
+bool Recording::isFrameReadable(int _frameIdx) const
+{
+  int localIdx;
+  return !getChunk(_frameIdx, localIdx)->mReadFailed;
 }
 
 //==============================================================================
 void Recording::clear() {
-  mBakedStates.clear();
+  mChunks.clear();
+  mNumFrames = 0;
+  {
+    std::lock_guard<std::mutex> lock(mReaderMutex);
+    mCachedChunkIdx = -1;
+    mCachedChunk = nullptr;
+    if (mStream.is_open())
+      mReader.close();
+  }
+
+  // Start the stream over, so the file matches what we've recorded
+  if (mStream.is_open())
+  {
+    mStream.close();
+    mStream.open(mStreamPath, std::ios::out | std::ios::binary);
+    writeHeader();
+  }
 }
 
 //==============================================================================
 void Recording::addState(const Eigen::VectorXs& _state)
 {
-  mBakedStates.push_back(_state);
+  const int numDofs = mDofOffsets.back();
+  addFrame(
+      _state.head(numDofs), _state.segment(numDofs, _state.size() - numDofs));
+}
+
+//==============================================================================
+void Recording::addFrame(
+    const Eigen::Ref<const Eigen::VectorXs>& _positions,
+    const Eigen::Ref<const Eigen::VectorXs>& _contacts)
+{
+  assert(_positions.size() == mDofOffsets.back());
+  assert(_contacts.size() % 6 == 0);
+
+  Chunk& chunk = getOpenChunk(_positions.size());
+  chunk.mPositions.insert(
+      chunk.mPositions.end(),
+      _positions.data(),
+      _positions.data() + _positions.size());
+  chunk.mContacts.insert(
+      chunk.mContacts.end(),
+      _contacts.data(),
+      _contacts.data() + _contacts.size());
+  chunk.mContactOffsets.push_back(chunk.mContacts.size() / 6);
+  chunk.mNumFrames++;
+  mChunks.back().mNumFrames++;
+  mNumFrames++;
+
+  if (chunk.mNumFrames >= mChunkSize)
+    spillChunks(false);
+}
+
+//==============================================================================
+void Recording::setChunkSize(int _frames)
+{
+  assert(_frames > 0);
+  mChunkSize = _frames;
+}
+
+//==============================================================================
+int Recording::getChunkSize() const
+{
+  return mChunkSize;
+}
+
+//==============================================================================
+bool Recording::streamToFile(const std::string& _path, bool _compress)
+{
+  closeStream();
+
+  // Chunks that came from a file need to be read back before we start writing,
+  // since _path may be that same file
+  std::vector<std::shared_ptr<Chunk>> readBack(mChunks.size());
+  for (std::size_t i = 0; i < mChunks.size(); i++)
+  {
+    if (mChunks[i].mChunk != nullptr)
+      continue;
+    if (!mReader.is_open())
+      mReader.open(mStreamPath, std::ios::in | std::ios::binary);
+    mReader.clear();
+    readBack[i] = readChunk(mReader, mChunks[i].mFileOffset, mCompress);
+    if (readBack[i] == nullptr)
+    {
+      dterr << "[Recording::streamToFile] couldn't read back chunk " << i
+            << " from \"" << mStreamPath << "\"\n";
+      return false;
+    }
+  }
+  for (std::size_t i = 0; i < mChunks.size(); i++)
+  {
+    if (readBack[i] != nullptr)
+      mChunks[i].mChunk = readBack[i];
+  }
+  mReader.close();
+  mCachedChunkIdx = -1;
+  mCachedChunk = nullptr;
+
+  mStream.open(_path, std::ios::out | std::ios::binary);
+  if (!mStream.is_open())
+  {
+    dterr << "[Recording::streamToFile] failed to open \"" << _path
+          << "\" for writing\n";
+    return false;
+  }
+  mStreamPath = _path;
+  mCompress = _compress;
+  writeHeader();
+
+  // Anything we already hold goes to disk now
+  spillChunks(false);
+  return true;
+}
+
+//==============================================================================
+void Recording::closeStream()
+{
+  if (!mStream.is_open())
+    return;
+
+  spillChunks(true);
+
+  uint64_t footerOffset = static_cast<uint64_t>(mStream.tellp());
+  for (const ChunkIndexEntry& entry : mChunks)
+  {
+    writeRaw(mStream, (int32_t)entry.mStartFrame);
+    writeRaw(mStream, (int32_t)entry.mNumFrames);
+    writeRaw(mStream, entry.mFileOffset);
+  }
+  writeRaw(mStream, (int32_t)mChunks.size());
+  writeRaw(mStream, footerOffset);
+  mStream.write(RECORDING_INDEX_MAGIC, 4);
+  mStream.close();
+}
+
+//==============================================================================
+std::shared_ptr<Recording> Recording::openFile(const std::string& _path)
+{
+  std::ifstream in(_path, std::ios::in | std::ios::binary);
+  char magic[4];
+  int32_t version;
+  int32_t flags;
+  int32_t numSkeletons;
+  in.read(magic, 4);
+  if (!in || std::memcmp(magic, RECORDING_MAGIC, 4) != 0
+      || !readRaw(in, version) || version != RECORDING_VERSION
+      || !readRaw(in, flags) || !readRaw(in, numSkeletons)
+      || numSkeletons < 0)
+  {
+    dterr << "[Recording::openFile] \"" << _path
+          << "\" is not a valid recording\n";
+    return nullptr;
+  }
+  std::vector<int> dofs;
+  for (int i = 0; i < numSkeletons; i++)
+  {
+    int32_t skelDofs;
+    if (!readRaw(in, skelDofs))
+      return nullptr;
+    dofs.push_back(skelDofs);
+  }
+  int32_t chunkSize;
+  if (!readRaw(in, chunkSize))
+    return nullptr;
+  const uint64_t firstChunkOffset = static_cast<uint64_t>(in.tellg());
+
+  std::shared_ptr<Recording> recording = std::make_shared<Recording>(dofs);
+  recording->mChunkSize = chunkSize;
+  recording->mCompress = (flags & RECORDING_FLAG_COMPRESSED) != 0;
+  recording->mStreamPath = _path;
+
+  // Try the index footer first
+  in.seekg(0, std::ios::end);
+  const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+  bool haveIndex = false;
+  if (fileSize >= firstChunkOffset + RECORDING_FOOTER_TAIL)
+  {
+    in.seekg(fileSize - RECORDING_FOOTER_TAIL);
+    int32_t numChunks;
+    uint64_t footerOffset;
+    char indexMagic[4];
+    if (readRaw(in, numChunks) && readRaw(in, footerOffset)
+        && in.read(indexMagic, 4)
+        && std::memcmp(indexMagic, RECORDING_INDEX_MAGIC, 4) == 0
+        && footerOffset < fileSize)
+    {
+      in.seekg(footerOffset);
+      haveIndex = true;
+      for (int i = 0; i < numChunks; i++)
+      {
+        int32_t startFrame;
+        int32_t numFrames;
+        uint64_t offset;
+        if (!readRaw(in, startFrame) || !readRaw(in, numFrames)
+            || !readRaw(in, offset))
+        {
+          haveIndex = false;
+          break;
+        }
+        ChunkIndexEntry entry;
+        entry.mStartFrame = startFrame;
+        entry.mNumFrames = numFrames;
+        entry.mFileOffset = offset;
+        recording->mChunks.push_back(entry);
+      }
+    }
+  }
+
+  // Otherwise, recover whatever complete chunks we can by scanning
+  if (!haveIndex)
+  {
+    in.clear();
+    recording->mChunks.clear();
+    uint64_t offset = firstChunkOffset;
+    int startFrame = 0;
+    while (true)
+    {
+      in.seekg(offset);
+      int32_t numDofs;
+      int32_t numFrames;
+      int32_t numContacts;
+      uint64_t payloadBytes;
+      if (!readRaw(in, numDofs) || !readRaw(in, numFrames)
+          || !readRaw(in, numContacts) || !readRaw(in, payloadBytes))
+        break;
+      uint64_t next = offset + 3 * sizeof(int32_t) + sizeof(uint64_t)
+                      + payloadBytes;
+      if (next > fileSize)
+        break;
+      ChunkIndexEntry entry;
+      entry.mStartFrame = startFrame;
+      entry.mNumFrames = numFrames;
+      entry.mFileOffset = offset;
+      recording->mChunks.push_back(entry);
+      startFrame += numFrames;
+      offset = next;
+    }
+  }
+
+  for (const ChunkIndexEntry& entry : recording->mChunks)
+    recording->mNumFrames += entry.mNumFrames;
+  recording->mReader.open(_path, std::ios::in | std::ios::binary);
+  return recording;
+}
+
+//==============================================================================
+int Recording::getNumChunksInMemory() const
+{
+  int count = 0;
+  for (const ChunkIndexEntry& entry : mChunks)
+  {
+    if (entry.mChunk != nullptr)
+      count++;
+  }
+  std::lock_guard<std::mutex> lock(mReaderMutex);
+  if (mCachedChunk != nullptr)
+    count++;
+  return count;
 }
 
 //==============================================================================
@@ -145,6 +519,285 @@ void Recording::updateNumGenCoords(
   mNumGenCoordsForSkeletons.clear();
   for (std::size_t i = 0; i < _skeletons.size(); ++i)
     mNumGenCoordsForSkeletons.push_back(_skeletons[i]->getNumDofs());
+  updateDofOffsets();
+}
+
+//==============================================================================
+std::shared_ptr<const Recording::Chunk> Recording::getChunk(
+    int _frameIdx, int& _localIdx) const
+{
+  assert(_frameIdx >= 0 && _frameIdx < mNumFrames);
+
+  // Chunks are in frame order, so we can binary search on the start frame
+  int lo = 0;
+  int hi = static_cast<int>(mChunks.size()) - 1;
+  while (lo < hi)
+  {
+    int mid = (lo + hi + 1) / 2;
+    if (mChunks[mid].mStartFrame <= _frameIdx)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  const ChunkIndexEntry& entry = mChunks[lo];
+  _localIdx = _frameIdx - entry.mStartFrame;
+  if (entry.mChunk != nullptr)
+    return entry.mChunk;
+
+  // spillChunks() flushes mStream after every write, so everything the index
+  // points at is already readable
+  std::lock_guard<std::mutex> lock(mReaderMutex);
+  if (mCachedChunkIdx != lo)
+  {
+    if (!mReader.is_open())
+      mReader.open(mStreamPath, std::ios::in | std::ios::binary);
+    mReader.clear();
+    mCachedChunk = readChunk(mReader, entry.mFileOffset, mCompress);
+    if (mCachedChunk == nullptr)
+    {
+      // Stand in a blank chunk, so callers can still index into it
+      dterr << "[Recording::getChunk] frames " << entry.mStartFrame
+            << " to " << entry.mStartFrame + entry.mNumFrames - 1
+            << " couldn't be read, so they'll read back as zeros\n";
+      mCachedChunk = std::make_shared<Chunk>();
+      mCachedChunk->mReadFailed = true;
+      mCachedChunk->mNumDofs = mDofOffsets.back();
+      mCachedChunk->mNumFrames = entry.mNumFrames;
+      mCachedChunk->mPositions.resize(
+          mCachedChunk->mNumDofs * entry.mNumFrames, 0.0);
+      mCachedChunk->mContactOffsets.resize(entry.mNumFrames + 1, 0);
+    }
+    mCachedChunkIdx = lo;
+  }
+  return mCachedChunk;
+}
+
+//==============================================================================
+Recording::Chunk& Recording::getOpenChunk(int _numDofs)
+{
+  if (mChunks.empty() || mChunks.back().mChunk == nullptr
+      || mChunks.back().mNumFrames >= mChunkSize
+      || mChunks.back().mChunk->mNumDofs != _numDofs)
+  {
+    // Once we start a new chunk, the previous one is complete
+    spillChunks(true);
+
+    ChunkIndexEntry entry;
+    entry.mStartFrame = mNumFrames;
+    entry.mNumFrames = 0;
+    entry.mFileOffset = 0;
+    entry.mChunk = std::make_shared<Chunk>();
+    entry.mChunk->mNumDofs = _numDofs;
+    entry.mChunk->mNumFrames = 0;
+    entry.mChunk->mPositions.reserve(_numDofs * mChunkSize);
+    entry.mChunk->mContactOffsets.push_back(0);
+    mChunks.push_back(entry);
+  }
+  return *mChunks.back().mChunk;
+}
+
+//==============================================================================
+void Recording::updateDofOffsets()
+{
+  mDofOffsets.resize(mNumGenCoordsForSkeletons.size() + 1);
+  mDofOffsets[0] = 0;
+  for (std::size_t i = 0; i < mNumGenCoordsForSkeletons.size(); i++)
+    mDofOffsets[i + 1] = mDofOffsets[i] + mNumGenCoordsForSkeletons[i];
+}
+
+//==============================================================================
+void Recording::spillChunks(bool _includePartial)
+{
+  if (!mStream.is_open())
+    return;
+  for (ChunkIndexEntry& entry : mChunks)
+  {
+    if (entry.mChunk == nullptr || entry.mNumFrames == 0)
+      continue;
+    if (!_includePartial && entry.mNumFrames < mChunkSize)
+      continue;
+    entry.mFileOffset = static_cast<uint64_t>(mStream.tellp());
+    writeChunk(*entry.mChunk);
+    entry.mChunk = nullptr;
+  }
+  mStream.flush();
+
+  // An empty open chunk has nothing to write, so we just drop it
+  if (_includePartial && !mChunks.empty() && mChunks.back().mNumFrames == 0)
+    mChunks.pop_back();
+}
+
+//==============================================================================
+void Recording::writeChunk(const Chunk& _chunk)
+{
+  const int numContacts = _chunk.mContactOffsets.back();
+
+  std::vector<char> payload;
+  payload.reserve(
+      (_chunk.mPositions.size() + _chunk.mContacts.size()) * sizeof(double)
+      + _chunk.mContactOffsets.size() * sizeof(int32_t));
+  for (int frame = 0; frame < _chunk.mNumFrames; frame++)
+  {
+    for (int dof = 0; dof < _chunk.mNumDofs; dof++)
+    {
+      double value = static_cast<double>(
+          _chunk.mPositions[frame * _chunk.mNumDofs + dof]);
+      if (mCompress && frame > 0)
+      {
+        // XOR against the previous frame, so slowly changing values turn into
+        // mostly zero bytes
+        double prev = static_cast<double>(
+            _chunk.mPositions[(frame - 1) * _chunk.mNumDofs + dof]);
+        uint64_t bits;
+        uint64_t prevBits;
+        std::memcpy(&bits, &value, sizeof(double));
+        std::memcpy(&prevBits, &prev, sizeof(double));
+        appendRaw(payload, bits ^ prevBits);
+      }
+      else
+      {
+        appendRaw(payload, value);
+      }
+    }
+  }
+  for (int offset : _chunk.mContactOffsets)
+    appendRaw(payload, (int32_t)offset);
+  for (s_t value : _chunk.mContacts)
+    appendRaw(payload, static_cast<double>(value));
+
+  const std::vector<char>* toWrite = &payload;
+  std::vector<char> compressed;
+  if (mCompress)
+  {
+    compressZeroRuns(payload, compressed);
+    toWrite = &compressed;
+  }
+
+  writeRaw(mStream, (int32_t)_chunk.mNumDofs);
+  writeRaw(mStream, (int32_t)_chunk.mNumFrames);
+  writeRaw(mStream, (int32_t)numContacts);
+  writeRaw(mStream, (uint64_t)toWrite->size());
+  mStream.write(toWrite->data(), toWrite->size());
+}
+
+//==============================================================================
+std::shared_ptr<Recording::Chunk> Recording::readChunk(
+    std::istream& _in, uint64_t _offset, bool _compressed)
+{
+  _in.seekg(_offset);
+  int32_t numDofs;
+  int32_t numFrames;
+  int32_t numContacts;
+  uint64_t payloadBytes;
+  if (!readRaw(_in, numDofs) || !readRaw(_in, numFrames)
+      || !readRaw(_in, numContacts) || !readRaw(_in, payloadBytes))
+  {
+    dterr << "[Recording::readChunk] failed to read chunk header at "
+          << _offset << "\n";
+    return nullptr;
+  }
+  const uint64_t payloadStart = static_cast<uint64_t>(_in.tellg());
+  _in.seekg(0, std::ios::end);
+  const uint64_t fileSize = static_cast<uint64_t>(_in.tellg());
+  _in.seekg(payloadStart);
+  if (payloadBytes > fileSize - payloadStart)
+  {
+    dterr << "[Recording::readChunk] chunk at " << _offset
+          << " is truncated\n";
+    return nullptr;
+  }
+
+  // A compressed token never expands to more than 128 bytes, so this also
+  // keeps a corrupt header from asking for a huge allocation
+  const std::size_t rawBytes
+      = (static_cast<std::size_t>(numDofs) * numFrames
+         + 6 * static_cast<std::size_t>(numContacts))
+            * sizeof(double)
+        + (static_cast<std::size_t>(numFrames) + 1) * sizeof(int32_t);
+  if (numDofs < 0 || numFrames < 0 || numContacts < 0
+      || (_compressed ? rawBytes > 128 * payloadBytes
+                      : rawBytes != payloadBytes))
+  {
+    dterr << "[Recording::readChunk] chunk at " << _offset
+          << " has a corrupt header\n";
+    return nullptr;
+  }
+
+  std::vector<char> payload(payloadBytes);
+  if (!_in.read(payload.data(), payloadBytes))
+  {
+    dterr << "[Recording::readChunk] chunk at " << _offset
+          << " is truncated\n";
+    return nullptr;
+  }
+  if (_compressed)
+  {
+    std::vector<char> raw;
+    if (!decompressZeroRuns(payload, raw, rawBytes))
+    {
+      dterr << "[Recording::readChunk] chunk at " << _offset
+            << " is corrupt\n";
+      return nullptr;
+    }
+    payload.swap(raw);
+  }
+  std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+  chunk->mNumDofs = numDofs;
+  chunk->mNumFrames = numFrames;
+  const char* cursor = payload.data();
+  chunk->mPositions.resize(numDofs * numFrames);
+  std::vector<uint64_t> prevFrame(numDofs, 0);
+  for (int frame = 0; frame < numFrames; frame++)
+  {
+    for (int dof = 0; dof < numDofs; dof++)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, cursor, sizeof(uint64_t));
+      cursor += sizeof(uint64_t);
+      if (_compressed && frame > 0)
+        bits ^= prevFrame[dof];
+      prevFrame[dof] = bits;
+      double value;
+      std::memcpy(&value, &bits, sizeof(double));
+      chunk->mPositions[frame * numDofs + dof] = value;
+    }
+  }
+  chunk->mContactOffsets.resize(numFrames + 1);
+  for (int i = 0; i <= numFrames; i++)
+  {
+    int32_t offset;
+    std::memcpy(&offset, cursor, sizeof(int32_t));
+    cursor += sizeof(int32_t);
+    if (offset < (i == 0 ? 0 : chunk->mContactOffsets[i - 1])
+        || offset > numContacts)
+    {
+      dterr << "[Recording::readChunk] chunk at " << _offset
+            << " has corrupt contact offsets\n";
+      return nullptr;
+    }
+    chunk->mContactOffsets[i] = offset;
+  }
+  chunk->mContacts.resize(6 * numContacts);
+  for (int i = 0; i < 6 * numContacts; i++)
+  {
+    double value;
+    std::memcpy(&value, cursor, sizeof(double));
+    cursor += sizeof(double);
+    chunk->mContacts[i] = value;
+  }
+  return chunk;
+}
+
+//==============================================================================
+void Recording::writeHeader()
+{
+  mStream.write(RECORDING_MAGIC, 4);
+  writeRaw(mStream, RECORDING_VERSION);
+  writeRaw(mStream, (int32_t)(mCompress ? RECORDING_FLAG_COMPRESSED : 0));
+  writeRaw(mStream, (int32_t)mNumGenCoordsForSkeletons.size());
+  for (int dofs : mNumGenCoordsForSkeletons)
+    writeRaw(mStream, (int32_t)dofs);
+  writeRaw(mStream, (int32_t)mChunkSize);
 }
 
 }  // namespace simulation
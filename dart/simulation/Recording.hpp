@@ -39,6 +39,11 @@
 #ifndef DART_SIMULATION_RECORDING_HPP_
 #define DART_SIMULATION_RECORDING_HPP_
 
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -54,6 +59,13 @@ class Skeleton;
 namespace simulation {
 
 /// \brief class Recording
+///
+/// Frames are stored column-wise in fixed-size chunks: one contiguous block of
+/// positions per chunk, plus a packed block of contact points and forces. A
+/// Recording can optionally stream completed chunks to disk (see
+/// streamToFile()), in which case only the chunk being written and the most
+/// recently read chunk are held in memory. Frames that have been spilled to
+/// disk are still available for random access through the chunk index.
 class Recording
 {
 public:
@@ -95,21 +107,149 @@ public:
   /// _frameIdx
   Eigen::Vector3s getContactForce(int _frameIdx, int _contactIdx) const;
 
+  /// \brief Returns false if frame number _frameIdx was spilled to disk and
+  /// its chunk couldn't be read back. The getters return zeros and no
+  /// contacts for such frames.
+  bool isFrameReadable(int _frameIdx) const;
+
   /// \brief Clear the saved histories
   void clear();  
 
   /// \brief Add state
   void addState(const Eigen::VectorXs& _state);
 
+  /// \brief Add a frame, given the concatenated positions of all skeletons
+  /// and a packed vector of contacts, with 6 entries per contact (point, then
+  /// force). This avoids building a combined state vector for every frame.
+  void addFrame(
+      const Eigen::Ref<const Eigen::VectorXs>& _positions,
+      const Eigen::Ref<const Eigen::VectorXs>& _contacts);
+
+  /// \brief Set the number of frames stored per chunk. This only affects
+  /// chunks started after this call.
+  void setChunkSize(int _frames);
+
+  /// \brief Get the number of frames stored per chunk
+  int getChunkSize() const;
+
+  /// \brief Start writing this Recording to a file. Any frames already
+  /// recorded are written immediately, and from then on each chunk is written
+  /// and dropped from memory as soon as it fills. If _compress is true, chunks
+  /// are delta-encoded against the previous frame and run-length compressed,
+  /// which works well for smooth trajectories. Returns false if the file
+  /// couldn't be opened.
+  bool streamToFile(const std::string& _path, bool _compress = false);
+
+  /// \brief Write out the partially filled chunk and the chunk index, and
+  /// close the file. The recorded frames stay readable from the file.
+  void closeStream();
+
+  /// \brief Open a file written by streamToFile() for random-access replay.
+  /// Returns nullptr if the file couldn't be read. If the file was never
+  /// closed (for example, if the writer crashed), every complete chunk is
+  /// still recovered.
+  static std::shared_ptr<Recording> openFile(const std::string& _path);
+
+  /// \brief Get the number of chunks currently held in memory
+  int getNumChunksInMemory() const;
+
   /// \brief Update list for number of generalized coordinates
   void updateNumGenCoords(const std::vector<dynamics::SkeletonPtr>& _skeletons);
 
 private:
-  /// \brief Baked states
-  std::vector<Eigen::VectorXs> mBakedStates;
+  /// \brief A block of consecutive frames, stored column-wise
+  struct Chunk
+  {
+    /// \brief Total number of dofs in every frame of this chunk
+    int mNumDofs;
+
+    /// \brief Number of frames in this chunk
+    int mNumFrames;
+
+    /// \brief Positions, mNumDofs entries per frame
+    std::vector<s_t> mPositions;
+
+    /// \brief Index of the first contact of each frame in mContacts, plus a
+    /// trailing entry for the end of the last frame
+    std::vector<int> mContactOffsets;
+
+    /// \brief Contact points and forces, 6 entries per contact
+    std::vector<s_t> mContacts;
+
+    /// \brief True if this is a blank stand-in for a chunk that couldn't be
+    /// read back from disk
+    bool mReadFailed = false;
+  };
+
+  /// \brief Where a chunk lives. If mChunk is null, the chunk has been
+  /// written to the stream file at mFileOffset.
+  struct ChunkIndexEntry
+  {
+    int mStartFrame;
+    int mNumFrames;
+    std::uint64_t mFileOffset;
+    std::shared_ptr<Chunk> mChunk;
+  };
+
+  /// \brief Returns the chunk holding _frameIdx, reading it back from disk if
+  /// necessary, and sets _localIdx to the frame's index within the chunk. The
+  /// returned pointer keeps the chunk alive even if another thread replaces
+  /// the cached chunk meanwhile. If the chunk on disk can't be read, this
+  /// logs an error and returns a chunk of the same length with zero positions,
+  /// no contacts and mReadFailed set.
+  std::shared_ptr<const Chunk> getChunk(int _frameIdx, int& _localIdx) const;
+
+  /// \brief Returns the chunk new frames should be written to, starting a new
+  /// one if the current chunk is full
+  Chunk& getOpenChunk(int _numDofs);
+
+  /// \brief Recompute mDofOffsets from mNumGenCoordsForSkeletons
+  void updateDofOffsets();
+
+  /// \brief If we're streaming, write every full chunk we're holding to disk
+  /// and drop it from memory. If _includePartial is true, this also writes the
+  /// chunk currently being filled.
+  void spillChunks(bool _includePartial);
+
+  /// \brief Write the chunk header and payload to the stream file
+  void writeChunk(const Chunk& _chunk);
+
+  /// \brief Read the chunk at _offset from _in. Returns nullptr if the chunk
+  /// is truncated or corrupt.
+  static std::shared_ptr<Chunk> readChunk(
+      std::istream& _in, std::uint64_t _offset, bool _compressed);
+
+  /// \brief Write the file header to the stream file
+  void writeHeader();
+
+  /// \brief Chunk index, in frame order
+  std::vector<ChunkIndexEntry> mChunks;
+
+  /// \brief Total number of frames
+  int mNumFrames;
+
+  /// \brief Number of frames per chunk
+  int mChunkSize;
 
   /// \brief Number of generalized coordinates for skeletons
   std::vector<int> mNumGenCoordsForSkeletons;
+
+  /// \brief Offset of each skeleton's positions within a frame, with a
+  /// trailing entry for the total number of dofs
+  std::vector<int> mDofOffsets;
+
+  /// \brief The file we're streaming chunks to, if any
+  std::string mStreamPath;
+  std::ofstream mStream;
+  bool mCompress;
+
+  /// \brief Reader for chunks that have been spilled to disk, along with the
+  /// most recently read chunk. Reads go through const getters, so these are
+  /// mutable, and guarded by mReaderMutex so concurrent readers are safe.
+  mutable std::mutex mReaderMutex;
+  mutable std::ifstream mReader;
+  mutable int mCachedChunkIdx;
+  mutable std::shared_ptr<Chunk> mCachedChunk;
 };
 
 }  // namespace simulation
@@ -50,10 +50,12 @@
 #include "dart/constraint/ConstrainedGroup.hpp"
 #include "dart/dynamics/BoxShape.hpp"
 #include "dart/dynamics/DegreeOfFreedom.hpp"
+#include "dart/dynamics/SimpleFeatherstone.hpp"
 #include "dart/dynamics/Skeleton.hpp"
 #include "dart/neural/BackpropSnapshot.hpp"
 #include "dart/neural/ConstrainedGroupGradientMatrices.hpp"
 #include "dart/neural/NeuralUtils.hpp"
+#include "dart/neural/ParallelFiniteDifference.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/neural/WithRespectToMass.hpp"
 #include "dart/server/RawJsonUtils.hpp"
@@ -87,7 +89,9 @@ World::World(const std::string& _name)
     mPenetrationCorrectionEnabled(false),
     mWrtMass(std::make_shared<neural::WithRespectToMass>()),
     mUseFDOverride(false),
-    mSlowDebugResultsAgainstFD(false)
+    mSlowDebugResultsAgainstFD(false),
+    mNumFiniteDifferenceWorkers(-1),
+    mUseFastFeatherstone(true)
 {
   mIndices.push_back(0);
 
@@ -120,6 +124,7 @@ WorldPtr World::clone() const
   worldClone->setPenetrationCorrectionEnabled(mPenetrationCorrectionEnabled);
   worldClone->setParallelVelocityAndPositionUpdates(
       mParallelVelocityAndPositionUpdates);
+  worldClone->setUseFastFeatherstone(mUseFastFeatherstone);
 
   // Copy the WithRespectToMass pointer, so we have the same object
   worldClone->mWrtMass = mWrtMass;
@@ -197,13 +202,20 @@ void World::reset()
 //==============================================================================
 void World::integrateVelocities()
 {
+  const bool useFastFeatherstone
+      = mUseFastFeatherstone && syncFastFeatherstone();
+
   // Integrate velocity for unconstrained skeletons
-  for (auto& skel : mSkeletons)
+  for (std::size_t i = 0; i < mSkeletons.size(); i++)
   {
+    const dynamics::SkeletonPtr& skel = mSkeletons[i];
     if (!skel->isMobile())
       continue;
 
-    skel->computeForwardDynamics();
+    if (useFastFeatherstone)
+      computeFastForwardDynamics(i);
+    else
+      skel->computeForwardDynamics();
     skel->integrateVelocities(mTimeStep);
   }
 }
@@ -213,15 +225,7 @@ void World::step(bool _resetCommand)
 {
   Eigen::VectorXs initialVelocity = getVelocities();
 
-  // Integrate velocity for unconstrained skeletons
-  for (auto& skel : mSkeletons)
-  {
-    if (!skel->isMobile())
-      continue;
-
-    skel->computeForwardDynamics();
-    skel->integrateVelocities(mTimeStep);
-  }
+  integrateVelocities();
 
   // Record the unconstrained velocities, cause we need them for backprop
   if (mConstraintSolver->getGradientEnabled())
@@ -306,6 +310,55 @@ bool World::getParallelVelocityAndPositionUpdates()
   return mParallelVelocityAndPositionUpdates;
 }
 
+//==============================================================================
+void World::setUseFastFeatherstone(bool enable)
+{
+  mUseFastFeatherstone = enable;
+}
+
+//==============================================================================
+bool World::getUseFastFeatherstone()
+{
+  return mUseFastFeatherstone;
+}
+
+//==============================================================================
+bool World::syncFastFeatherstone()
+{
+  mFastFeatherstone.resize(mSkeletons.size());
+  bool representable = true;
+  for (std::size_t i = 0; i < mSkeletons.size(); i++)
+  {
+    if (!mSkeletons[i]->isMobile())
+      continue;
+
+    if (!mFastFeatherstone[i])
+      mFastFeatherstone[i] = std::make_shared<dynamics::SimpleFeatherstone>();
+    // Keep syncing after a failure, so every cache stays up to date
+    representable
+        = mFastFeatherstone[i]->syncFromSkeleton(mSkeletons[i]) && representable;
+  }
+  return representable;
+}
+
+//==============================================================================
+void World::computeFastForwardDynamics(std::size_t index)
+{
+  const dynamics::SkeletonPtr& skel = mSkeletons[index];
+
+  // Every joint is driven by force, so this is what
+  // GenericJoint::updateTotalForce() would do on the generic path
+  Eigen::VectorXs forces = skel->getCommands();
+  skel->setControlForces(forces);
+
+  Eigen::VectorXs positions = skel->getPositions();
+  Eigen::VectorXs velocities = skel->getVelocities();
+  Eigen::VectorXs accelerations = Eigen::VectorXs::Zero(skel->getNumDofs());
+  mFastFeatherstone[index]->forwardDynamics(
+      positions.data(), velocities.data(), forces.data(), accelerations.data());
+  skel->setAccelerations(accelerations);
+}
+
 //==============================================================================
 void World::setPenetrationCorrectionEnabled(bool enable)
 {
@@ -579,6 +632,35 @@ bool World::getSlowDebugResultsAgainstFD()
   return mSlowDebugResultsAgainstFD;
 }
 
+//==============================================================================
+std::shared_ptr<neural::ParallelFiniteDifference>
+World::getFiniteDifferencePool()
+{
+  if (mFiniteDifferencePool == nullptr
+      || !mFiniteDifferencePool->isCompatibleWith(this))
+  {
+    mFiniteDifferencePool
+        = std::make_shared<neural::ParallelFiniteDifference>(
+            shared_from_this(), mNumFiniteDifferenceWorkers);
+  }
+  else
+  {
+    mFiniteDifferencePool->syncWorkers(this);
+  }
+  return mFiniteDifferencePool;
+}
+
+//==============================================================================
+void World::setNumFiniteDifferenceWorkers(int numWorkers)
+{
+  if (numWorkers != mNumFiniteDifferenceWorkers)
+  {
+    mNumFiniteDifferenceWorkers = numWorkers;
+    // The pool gets rebuilt with the new size on next use
+    mFiniteDifferencePool = nullptr;
+  }
+}
+
 //==============================================================================
 int World::getSimFrames() const
 {
@@ -822,6 +904,10 @@ void World::removeSkeleton(const dynamics::SkeletonPtr& _skeleton)
   mNameConnectionsForSkeletons.erase(
       mNameConnectionsForSkeletons.begin() + index);
 
+  // Drop its cached topology
+  if (index < mFastFeatherstone.size())
+    mFastFeatherstone.erase(mFastFeatherstone.begin() + index);
+
   // Update recording
   mRecording->updateNumGenCoords(mSkeletons);
 
@@ -1378,6 +1464,22 @@ Eigen::MatrixXs World::getInvMassMatrix()
   return invMassMatrix;
 }
 
+//==============================================================================
+Eigen::MatrixXs World::solveMassMatrix(const Eigen::MatrixXs& B)
+{
+  assert(B.rows() == mDofs);
+  Eigen::MatrixXs result(B.rows(), B.cols());
+  std::size_t cursor = 0;
+  for (std::size_t i = 0; i < mSkeletons.size(); i++)
+  {
+    std::size_t dofs = mSkeletons[i]->getNumDofs();
+    result.middleRows(cursor, dofs)
+        = mSkeletons[i]->solveMassMatrix(B.middleRows(cursor, dofs));
+    cursor += dofs;
+  }
+  return result;
+}
+
 //==============================================================================
 // The state is [pos, vel] concatenated, so this return 2*getNumDofs()
 int World::getStateSize()
@@ -1612,74 +1714,53 @@ Eigen::MatrixXs World::getActionJacobian()
 //==============================================================================
 Eigen::MatrixXs World::finiteDifferenceStateJacobian()
 {
-  WorldPtr sharedThis = shared_from_this();
-  neural::RestorableSnapshot snapshot(sharedThis);
-
   int stateDim = getStateSize();
-  Eigen::VectorXs originalState = getState();
-  Eigen::MatrixXs stateJac = Eigen::MatrixXs::Zero(stateDim, stateDim);
-
-  s_t EPS = 1e-6;
-
-  for (int i = 0; i < stateDim; i++)
-  {
-    Eigen::VectorXs perturbedState = originalState;
-    perturbedState(i) += EPS;
-    setState(perturbedState);
-    step(false);
-    Eigen::VectorXs statePos = getState();
-    snapshot.restore();
-
-    perturbedState = originalState;
-    perturbedState(i) -= EPS;
-    setState(perturbedState);
-    step(false);
-    Eigen::VectorXs stateNeg = getState();
-    snapshot.restore();
-
-    stateJac.col(i) = (statePos - stateNeg) / (2 * EPS);
-  }
-
-  snapshot.restore();
-
-  return stateJac;
+  Eigen::VectorXs lcpCache = getCachedLCPSolution();
+
+  std::shared_ptr<neural::ParallelFiniteDifference> pool
+      = getFiniteDifferencePool();
+  pool->setScheme(neural::ParallelFiniteDifference::CENTRAL);
+  pool->setStepSize(1e-6);
+  return pool->jacobian(
+      getState(),
+      stateDim,
+      [&](int /* worker */,
+          World* world,
+          const Eigen::VectorXs& state,
+          Eigen::VectorXs& out) {
+        world->setCachedLCPSolution(lcpCache);
+        world->setState(state);
+        world->step(false);
+        out = world->getState();
+        return true;
+      });
 }
 
 //==============================================================================
 Eigen::MatrixXs World::finiteDifferenceActionJacobian()
 {
-  WorldPtr sharedThis = shared_from_this();
-  neural::RestorableSnapshot snapshot(sharedThis);
-
-  int dofs = getNumDofs();
-  int actionDim = mActionSpace.size();
-  Eigen::VectorXs originalAction = getAction();
-  Eigen::MatrixXs actionJac = Eigen::MatrixXs::Zero(2 * dofs, actionDim);
-
-  s_t EPS = 1e-6;
-
-  for (int i = 0; i < actionDim; i++)
-  {
-    Eigen::VectorXs perturbedAction = originalAction;
-    perturbedAction(i) += EPS;
-    setAction(perturbedAction);
-    step(false);
-    Eigen::VectorXs statePos = getState();
-    snapshot.restore();
-
-    perturbedAction = originalAction;
-    perturbedAction(i) -= EPS;
-    setAction(perturbedAction);
-    step(false);
-    Eigen::VectorXs stateNeg = getState();
-    snapshot.restore();
-
-    actionJac.col(i) = (statePos - stateNeg) / (2 * EPS);
-  }
-
-  snapshot.restore();
-
-  return actionJac;
+  int stateDim = getStateSize();
+  Eigen::VectorXs originalState = getState();
+  Eigen::VectorXs lcpCache = getCachedLCPSolution();
+
+  std::shared_ptr<neural::ParallelFiniteDifference> pool
+      = getFiniteDifferencePool();
+  pool->setScheme(neural::ParallelFiniteDifference::CENTRAL);
+  pool->setStepSize(1e-6);
+  return pool->jacobian(
+      getAction(),
+      stateDim,
+      [&](int /* worker */,
+          World* world,
+          const Eigen::VectorXs& action,
+          Eigen::VectorXs& out) {
+        world->setCachedLCPSolution(lcpCache);
+        world->setState(originalState);
+        world->setAction(action);
+        world->step(false);
+        out = world->getState();
+        return true;
+      });
 }
 
 //==============================================================================
@@ -1745,21 +1826,21 @@ void World::bake()
   const auto nContacts = static_cast<int>(collisionResult.getNumContacts());
   const auto nSkeletons = getNumSkeletons();
 
-  Eigen::VectorXs state(getIndex(nSkeletons) + 6 * nContacts);
+  Eigen::VectorXs positions(getIndex(nSkeletons));
   for (auto i = 0u; i < getNumSkeletons(); ++i)
   {
-    state.segment(getIndex(i), getSkeleton(i)->getNumDofs())
+    positions.segment(getIndex(i), getSkeleton(i)->getNumDofs())
         = getSkeleton(i)->getPositions();
   }
 
+  Eigen::VectorXs contacts(6 * nContacts);
   for (auto i = 0; i < nContacts; ++i)
   {
-    auto begin = getIndex(nSkeletons) + i * 6;
-    state.segment(begin, 3) = collisionResult.getContact(i).point;
-    state.segment(begin + 3, 3) = collisionResult.getContact(i).force;
+    contacts.segment(i * 6, 3) = collisionResult.getContact(i).point;
+    contacts.segment(i * 6 + 3, 3) = collisionResult.getContact(i).force;
   }
 
-  mRecording->addState(state);
+  mRecording->addFrame(positions, contacts);
 }
 
 //==============================================================================
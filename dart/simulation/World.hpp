@@ -66,6 +66,7 @@ class Integrator;
 namespace dynamics {
 class Skeleton;
 class DegreeOfFreedom;
+class SimpleFeatherstone;
 } // namespace dynamics
 
 namespace constraint {
@@ -79,6 +80,7 @@ class CollisionResult;
 namespace neural {
 class WithRespectToMass;
 class BackpropSnapshot;
+class ParallelFiniteDifference;
 } // namespace neural
 
 namespace simulation {
@@ -345,6 +347,10 @@ public:
   /// block-diagonal concatenation of each skeleton's inverse mass matrix.
   Eigen::MatrixXs getInvMassMatrix();
 
+  /// This returns M^{-1} * B for the whole world, solving against each
+  /// skeleton's factored mass matrix instead of forming getInvMassMatrix()
+  Eigen::MatrixXs solveMassMatrix(const Eigen::MatrixXs& B);
+
   //--------------------------------------------------------------------------
   // High Level ("Reinforcement Learning style") API
   //
@@ -501,6 +507,17 @@ public:
 
   bool getParallelVelocityAndPositionUpdates();
 
+  /// True by default. Sets whether step() should compute the unconstrained
+  /// accelerations with dynamics::SimpleFeatherstone whenever it can represent
+  /// every Skeleton in the World, falling back to
+  /// Skeleton::computeForwardDynamics() otherwise. Each Skeleton's topology is
+  /// cached, and only repopulated when it changes. The fast path doesn't leave
+  /// the transmitted body forces behind in the BodyNodes, so
+  /// Joint::getBodyConstraintWrench() is stale after a fast step.
+  void setUseFastFeatherstone(bool enable);
+
+  bool getUseFastFeatherstone();
+
   /// True by default. Sets whether or not to apply artifical "penetration
   /// correction" forces to objects that inter-penetrate.
   void setPenetrationCorrectionEnabled(bool enable);
@@ -572,6 +589,15 @@ public:
 
   bool getSlowDebugResultsAgainstFD();
 
+  /// This returns a pool of clones of this world, synced to its current state,
+  /// for computing finite difference Jacobians in parallel. The clones are made
+  /// on first use, and remade if skeletons get added or removed.
+  std::shared_ptr<neural::ParallelFiniteDifference> getFiniteDifferencePool();
+
+  /// This sets how many clones the finite difference pool holds. Anything less
+  /// than 1 means one per hardware thread, which is the default.
+  void setNumFiniteDifferenceWorkers(int numWorkers);
+
 protected:
   /// If this is true, we use finite-differencing to compute all of the
   /// requested Jacobians. This override can be useful to verify if there's a
@@ -584,6 +610,29 @@ protected:
   /// instructions.
   bool mSlowDebugResultsAgainstFD;
 
+  /// This is the pool of clones used for parallel finite differencing, created
+  /// lazily by getFiniteDifferencePool()
+  std::shared_ptr<neural::ParallelFiniteDifference> mFiniteDifferencePool;
+
+  /// How many clones mFiniteDifferencePool gets, or less than 1 for one per
+  /// hardware thread
+  int mNumFiniteDifferenceWorkers;
+
+  /// This brings mFastFeatherstone up to date with mSkeletons, and returns
+  /// true if it can represent every mobile Skeleton
+  bool syncFastFeatherstone();
+
+  /// This computes the unconstrained accelerations of the Skeleton at `index`
+  /// with its entry in mFastFeatherstone, which must be synced
+  void computeFastForwardDynamics(std::size_t index);
+
+  /// True if integrateVelocities() should try mFastFeatherstone first
+  bool mUseFastFeatherstone;
+
+  /// One cache per entry in mSkeletons, which keeps each topology around from
+  /// step to step
+  std::vector<std::shared_ptr<dynamics::SimpleFeatherstone>> mFastFeatherstone;
+
   /// Register when a Skeleton's name is changed
   void handleSkeletonNameChange(
       const dynamics::ConstMetaSkeletonPtr& _skeleton);
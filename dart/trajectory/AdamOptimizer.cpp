@@ -0,0 +1,176 @@
+#include "dart/trajectory/AdamOptimizer.hpp"
+
+#include <iostream>
+#include <limits>
+
+#include "dart/simulation/World.hpp"
+
+namespace dart {
+namespace trajectory {
+
+//==============================================================================
+AdamOptimizer::AdamOptimizer()
+  : mIterationLimit(100),
+    mTolerance(1e-6),
+    mLearningRate(1e-2),
+    mBeta1(0.9),
+    mBeta2(0.999),
+    mEpsilon(1e-8),
+    mRecoverBest(true),
+    mPrintFrequency(0),
+    mRecordIterations(false)
+{
+}
+
+//==============================================================================
+std::shared_ptr<Solution> AdamOptimizer::optimize(
+    Problem* shot, std::shared_ptr<Solution> reuseRecord)
+{
+  std::shared_ptr<Solution> record
+      = reuseRecord ? reuseRecord : std::make_shared<Solution>();
+  std::shared_ptr<simulation::World> world = shot->mWorld;
+
+  // Allocate everything up front, so the loop below doesn't touch the heap
+  int n = shot->getFlatProblemDim(world);
+  Eigen::VectorXs x = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs grad = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs projectedGrad = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs m = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs v = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs upper = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs lower = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs bestX = Eigen::VectorXs::Zero(n);
+  shot->getUpperBounds(world, upper);
+  shot->getLowerBounds(world, lower);
+
+  shot->flatten(world, x);
+  x = x.cwiseMax(lower).cwiseMin(upper);
+  shot->unflatten(world, x);
+  bestX = x;
+  s_t bestLoss = std::numeric_limits<s_t>::infinity();
+
+  s_t beta1Power = 1.0;
+  s_t beta2Power = 1.0;
+  bool converged = false;
+  for (int i = 0; i < mIterationLimit; i++)
+  {
+    s_t loss = shot->getLoss(world);
+    // This reuses the rollout we just computed for the loss
+    shot->backpropGradient(world, grad);
+
+    if (loss < bestLoss)
+    {
+      bestLoss = loss;
+      bestX = x;
+    }
+    if (mRecordIterations)
+    {
+      record->registerIteration(i, shot->getRolloutCache(world), loss, 0.0);
+    }
+    if (mPrintFrequency > 0 && i % mPrintFrequency == 0)
+    {
+      std::cout << "Adam iter " << i << ": " << loss << std::endl;
+    }
+    bool keepGoing = true;
+    for (auto& callback : mIntermediateCallbacks)
+    {
+      if (!callback(shot, i, loss, 0.0))
+      {
+        keepGoing = false;
+      }
+    }
+    if (!keepGoing)
+    {
+      break;
+    }
+
+    // Components pinned against a bound, that the gradient would push further
+    // out, don't count towards convergence
+    for (int j = 0; j < n; j++)
+    {
+      bool pinned = (x(j) <= lower(j) && grad(j) > 0)
+                    || (x(j) >= upper(j) && grad(j) < 0);
+      projectedGrad(j) = pinned ? 0.0 : grad(j);
+    }
+    if (projectedGrad.lpNorm<Eigen::Infinity>() < mTolerance)
+    {
+      converged = true;
+      break;
+    }
+
+    beta1Power *= mBeta1;
+    beta2Power *= mBeta2;
+    m = mBeta1 * m + (1.0 - mBeta1) * grad;
+    v = mBeta2 * v + (1.0 - mBeta2) * grad.cwiseProduct(grad);
+    s_t stepSize = mLearningRate * sqrt(1.0 - beta2Power) / (1.0 - beta1Power);
+    x.array() -= stepSize * m.array() / (v.array().sqrt() + mEpsilon);
+    x = x.cwiseMax(lower).cwiseMin(upper);
+    shot->unflatten(world, x);
+  }
+
+  if (mRecoverBest && !converged)
+  {
+    // The last step hasn't been evaluated yet, so it's worth one more rollout
+    // to find out if it beats the best we've seen
+    s_t loss = shot->getLoss(world);
+    if (loss > bestLoss)
+    {
+      shot->unflatten(world, bestX);
+    }
+  }
+
+  record->setSuccess(converged);
+  return record;
+}
+
+//==============================================================================
+void AdamOptimizer::setIterationLimit(int iterationLimit)
+{
+  mIterationLimit = iterationLimit;
+}
+
+//==============================================================================
+void AdamOptimizer::setTolerance(s_t tolerance)
+{
+  mTolerance = tolerance;
+}
+
+//==============================================================================
+void AdamOptimizer::setLearningRate(s_t learningRate)
+{
+  mLearningRate = learningRate;
+}
+
+//==============================================================================
+void AdamOptimizer::setMomentDecay(s_t beta1, s_t beta2)
+{
+  mBeta1 = beta1;
+  mBeta2 = beta2;
+}
+
+//==============================================================================
+void AdamOptimizer::setEpsilon(s_t epsilon)
+{
+  mEpsilon = epsilon;
+}
+
+//==============================================================================
+void AdamOptimizer::setRecoverBest(bool recoverBest)
+{
+  mRecoverBest = recoverBest;
+}
+
+//==============================================================================
+void AdamOptimizer::setPrintFrequency(int frequency)
+{
+  mPrintFrequency = frequency;
+}
+
+//==============================================================================
+void AdamOptimizer::setRecordIterations(bool recordIterations)
+{
+  mRecordIterations = recordIterations;
+}
+
+} // namespace trajectory
+} // namespace dart
@@ -0,0 +1,69 @@
+#ifndef DART_TRAJECTORY_ADAM_OPTIMIZER_HPP_
+#define DART_TRAJECTORY_ADAM_OPTIMIZER_HPP_
+
+#include <memory>
+
+#include <Eigen/Dense>
+
+#include "dart/trajectory/Optimizer.hpp"
+#include "dart/trajectory/Problem.hpp"
+#include "dart/trajectory/Solution.hpp"
+
+namespace dart {
+namespace trajectory {
+
+/*
+ * This is a native Adam optimizer, for problems where the overhead of IPOPT
+ * isn't worth paying (for example, re-planning every few milliseconds during
+ * MPC). Every step is projected back into Problem::getLowerBounds() and
+ * Problem::getUpperBounds(). This only minimizes the loss, so any constraints
+ * on the Problem (like MultiShot knot points) are ignored.
+ */
+class AdamOptimizer : public Optimizer
+{
+public:
+  AdamOptimizer();
+
+  virtual ~AdamOptimizer() = default;
+
+  std::shared_ptr<Solution> optimize(
+      Problem* shot, std::shared_ptr<Solution> reuseRecord = nullptr) override;
+
+  void setIterationLimit(int iterationLimit);
+
+  /// We stop once the largest component of the projected gradient is smaller
+  /// than this
+  void setTolerance(s_t tolerance);
+
+  void setLearningRate(s_t learningRate);
+
+  /// This sets the decay rates for the first and second moment estimates
+  void setMomentDecay(s_t beta1, s_t beta2);
+
+  void setEpsilon(s_t epsilon);
+
+  /// If true, we leave the problem at the lowest loss we saw, rather than
+  /// wherever the last step happened to land
+  void setRecoverBest(bool recoverBest);
+
+  /// This prints the loss every `frequency` iterations. 0 disables printing.
+  void setPrintFrequency(int frequency);
+
+  void setRecordIterations(bool recordIterations);
+
+protected:
+  int mIterationLimit;
+  s_t mTolerance;
+  s_t mLearningRate;
+  s_t mBeta1;
+  s_t mBeta2;
+  s_t mEpsilon;
+  bool mRecoverBest;
+  int mPrintFrequency;
+  bool mRecordIterations;
+};
+
+} // namespace trajectory
+} // namespace dart
+
+#endif
@@ -0,0 +1,252 @@
+#include "dart/trajectory/LBFGSOptimizer.hpp"
+
+#include <iostream>
+
+#include "dart/simulation/World.hpp"
+
+namespace dart {
+namespace trajectory {
+
+//==============================================================================
+LBFGSOptimizer::LBFGSOptimizer()
+  : mIterationLimit(100),
+    mTolerance(1e-6),
+    mHistoryLength(10),
+    mPrintFrequency(0),
+    mRecordIterations(false)
+{
+}
+
+//==============================================================================
+std::shared_ptr<Solution> LBFGSOptimizer::optimize(
+    Problem* shot, std::shared_ptr<Solution> reuseRecord)
+{
+  std::shared_ptr<Solution> record
+      = reuseRecord ? reuseRecord : std::make_shared<Solution>();
+  std::shared_ptr<simulation::World> world = shot->mWorld;
+
+  // Allocate everything up front, so the loop below doesn't touch the heap
+  // (the line search keeps its worker threads from one call to the next)
+  int n = shot->getFlatProblemDim(world);
+  int historyLength = std::max(1, mHistoryLength);
+  Eigen::VectorXs x = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs newX = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs grad = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs newGrad = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs direction = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs upper = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs lower = Eigen::VectorXs::Zero(n);
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> isFree(n);
+  Eigen::MatrixXs S = Eigen::MatrixXs::Zero(n, historyLength);
+  Eigen::MatrixXs Y = Eigen::MatrixXs::Zero(n, historyLength);
+  Eigen::VectorXs rho = Eigen::VectorXs::Zero(historyLength);
+  Eigen::VectorXs alpha = Eigen::VectorXs::Zero(historyLength);
+  int historySize = 0;
+  int historyHead = 0;
+
+  shot->getUpperBounds(world, upper);
+  shot->getLowerBounds(world, lower);
+  shot->flatten(world, x);
+  x = x.cwiseMax(lower).cwiseMin(upper);
+  shot->unflatten(world, x);
+  mLineSearch.prepare(shot);
+
+  s_t loss = shot->getLoss(world);
+  shot->backpropGradient(world, grad);
+
+  bool converged = false;
+  bool stagnated = false;
+  for (int i = 0; i < mIterationLimit; i++)
+  {
+    if (mRecordIterations)
+    {
+      record->registerIteration(i, shot->getRolloutCache(world), loss, 0.0);
+    }
+    if (mPrintFrequency > 0 && i % mPrintFrequency == 0)
+    {
+      std::cout << "L-BFGS iter " << i << ": " << loss << std::endl;
+    }
+    bool keepGoing = true;
+    for (auto& callback : mIntermediateCallbacks)
+    {
+      if (!callback(shot, i, loss, 0.0))
+      {
+        keepGoing = false;
+      }
+    }
+    if (!keepGoing)
+    {
+      break;
+    }
+
+    // Variables pinned against a bound, that the gradient would push further
+    // out, are held fixed for this step
+    for (int j = 0; j < n; j++)
+    {
+      isFree(j) = !((x(j) <= lower(j) && grad(j) > 0)
+                    || (x(j) >= upper(j) && grad(j) < 0));
+      direction(j) = isFree(j) ? -grad(j) : 0.0;
+    }
+    if (direction.lpNorm<Eigen::Infinity>() < mTolerance)
+    {
+      converged = true;
+      break;
+    }
+
+    // Two-loop recursion, from the newest pair back to the oldest and forward
+    // again
+    for (int k = 0; k < historySize; k++)
+    {
+      int idx = (historyHead - 1 - k + historyLength) % historyLength;
+      alpha(idx) = rho(idx) * S.col(idx).dot(direction);
+      direction -= alpha(idx) * Y.col(idx);
+    }
+    if (historySize > 0)
+    {
+      int newest = (historyHead - 1 + historyLength) % historyLength;
+      direction *= S.col(newest).dot(Y.col(newest))
+                   / Y.col(newest).squaredNorm();
+    }
+    for (int k = historySize - 1; k >= 0; k--)
+    {
+      int idx = (historyHead - 1 - k + historyLength) % historyLength;
+      s_t beta = rho(idx) * Y.col(idx).dot(direction);
+      direction += (alpha(idx) - beta) * S.col(idx);
+    }
+    for (int j = 0; j < n; j++)
+    {
+      if (!isFree(j))
+        direction(j) = 0.0;
+    }
+
+    s_t initialStep = 1.0;
+    if (grad.dot(direction) >= 0)
+    {
+      // The curvature estimate has gone bad, so start over from steepest
+      // descent
+      historySize = 0;
+      for (int j = 0; j < n; j++)
+      {
+        direction(j) = isFree(j) ? -grad(j) : 0.0;
+      }
+    }
+    if (historySize == 0)
+    {
+      // Without curvature information, scale the first try so the largest
+      // coordinate moves by one unit. Capping it at the raw gradient instead
+      // crawls along directions where the loss is nearly linear, because
+      // those steps never produce a usable curvature pair.
+      initialStep = (s_t)1.0 / direction.lpNorm<Eigen::Infinity>();
+    }
+
+    s_t newLoss = loss;
+    s_t step = mLineSearch.search(
+        shot,
+        x,
+        loss,
+        grad,
+        direction,
+        lower,
+        upper,
+        initialStep,
+        newX,
+        newLoss);
+    if (step == 0 && historySize > 0)
+    {
+      // The L-BFGS direction didn't make progress, which usually means the
+      // stored curvature pairs no longer describe the loss here. Forget them
+      // and retry along steepest descent before giving up.
+      historySize = 0;
+      historyHead = 0;
+      for (int j = 0; j < n; j++)
+      {
+        direction(j) = isFree(j) ? -grad(j) : 0.0;
+      }
+      initialStep = (s_t)1.0 / direction.lpNorm<Eigen::Infinity>();
+      step = mLineSearch.search(
+          shot,
+          x,
+          loss,
+          grad,
+          direction,
+          lower,
+          upper,
+          initialStep,
+          newX,
+          newLoss);
+    }
+    if (step == 0)
+    {
+      // Not even steepest descent makes progress, but the projected gradient
+      // is still above tolerance, so we've stalled rather than converged
+      if (mPrintFrequency > 0)
+      {
+        std::cout << "L-BFGS stagnated at iter " << i << ": " << loss
+                  << std::endl;
+      }
+      shot->unflatten(world, x);
+      stagnated = true;
+      break;
+    }
+
+    shot->unflatten(world, newX);
+    shot->backpropGradient(world, newGrad);
+
+    S.col(historyHead) = newX - x;
+    Y.col(historyHead) = newGrad - grad;
+    s_t curvature = S.col(historyHead).dot(Y.col(historyHead));
+    if (curvature > 1e-10)
+    {
+      rho(historyHead) = 1.0 / curvature;
+      historyHead = (historyHead + 1) % historyLength;
+      historySize = std::min(historySize + 1, historyLength);
+    }
+
+    x = newX;
+    grad = newGrad;
+    loss = newLoss;
+  }
+
+  record->setSuccess(converged);
+  record->setStagnated(stagnated);
+  return record;
+}
+
+//==============================================================================
+void LBFGSOptimizer::setIterationLimit(int iterationLimit)
+{
+  mIterationLimit = iterationLimit;
+}
+
+//==============================================================================
+void LBFGSOptimizer::setTolerance(s_t tolerance)
+{
+  mTolerance = tolerance;
+}
+
+//==============================================================================
+void LBFGSOptimizer::setLBFGSHistoryLength(int historyLen)
+{
+  mHistoryLength = historyLen;
+}
+
+//==============================================================================
+void LBFGSOptimizer::setLineSearchCandidates(int numCandidates)
+{
+  mLineSearch.setNumCandidates(numCandidates);
+}
+
+//==============================================================================
+void LBFGSOptimizer::setPrintFrequency(int frequency)
+{
+  mPrintFrequency = frequency;
+}
+
+//==============================================================================
+void LBFGSOptimizer::setRecordIterations(bool recordIterations)
+{
+  mRecordIterations = recordIterations;
+}
+
+} // namespace trajectory
+} // namespace dart
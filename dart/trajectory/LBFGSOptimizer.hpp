@@ -0,0 +1,70 @@
+#ifndef DART_TRAJECTORY_LBFGS_OPTIMIZER_HPP_
+#define DART_TRAJECTORY_LBFGS_OPTIMIZER_HPP_
+
+#include <memory>
+
+#include <Eigen/Dense>
+
+#include "dart/trajectory/Optimizer.hpp"
+#include "dart/trajectory/ParallelLineSearch.hpp"
+#include "dart/trajectory/Problem.hpp"
+#include "dart/trajectory/Solution.hpp"
+
+namespace dart {
+namespace trajectory {
+
+/*
+ * This is a native bound-constrained L-BFGS optimizer. Variables sitting on a
+ * bound from Problem::getLowerBounds() / Problem::getUpperBounds() with the
+ * gradient pushing them outwards are held fixed for the step, the L-BFGS
+ * direction is computed over the remaining free variables, and the step is
+ * chosen by a projected line search that evaluates several step lengths in
+ * parallel on cloned worlds. This only minimizes the loss, so any constraints
+ * on the Problem (like MultiShot knot points) are ignored.
+ *
+ * The returned Solution only reports success once the projected gradient is
+ * below the tolerance. If the line search can't decrease the loss, even along
+ * steepest descent with the L-BFGS history cleared, the Solution reports
+ * getStagnated() instead.
+ */
+class LBFGSOptimizer : public Optimizer
+{
+public:
+  LBFGSOptimizer();
+
+  virtual ~LBFGSOptimizer() = default;
+
+  std::shared_ptr<Solution> optimize(
+      Problem* shot, std::shared_ptr<Solution> reuseRecord = nullptr) override;
+
+  void setIterationLimit(int iterationLimit);
+
+  /// We stop once the largest component of the projected gradient is smaller
+  /// than this
+  void setTolerance(s_t tolerance);
+
+  /// This sets how many (s, y) pairs we keep to approximate the Hessian
+  void setLBFGSHistoryLength(int historyLen);
+
+  /// This sets how many line search steps get evaluated in parallel. Setting
+  /// this to 1 evaluates them serially on the original problem.
+  void setLineSearchCandidates(int numCandidates);
+
+  /// This prints the loss every `frequency` iterations. 0 disables printing.
+  void setPrintFrequency(int frequency);
+
+  void setRecordIterations(bool recordIterations);
+
+protected:
+  int mIterationLimit;
+  s_t mTolerance;
+  int mHistoryLength;
+  int mPrintFrequency;
+  bool mRecordIterations;
+  ParallelLineSearch mLineSearch;
+};
+
+} // namespace trajectory
+} // namespace dart
+
+#endif
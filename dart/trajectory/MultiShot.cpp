@@ -53,6 +53,38 @@ MultiShot::~MultiShot()
   // std::cout << "Freeing MultiShot: " << this << std::endl;
 }
 
+//==============================================================================
+/// This returns an independent copy of this problem, which can be evaluated
+/// against a different world concurrently with this one.
+std::shared_ptr<Problem> MultiShot::clone() const
+{
+  std::shared_ptr<MultiShot> copy = std::make_shared<MultiShot>(*this);
+  copy->mRolloutCacheDirty = true;
+  copy->mRolloutCache = nullptr;
+  copy->mGradWrtRolloutCache = nullptr;
+  if (!cloneMappingsInto(*copy))
+    return nullptr;
+  for (int i = 0; i < copy->mShots.size(); i++)
+  {
+    copy->mShots[i] = std::static_pointer_cast<SingleShot>(mShots[i]->clone());
+    if (copy->mShots[i] == nullptr)
+      return nullptr;
+    // Where a shot shares one of our mappings, its copy shares our copy's
+    for (auto& pair : copy->mShots[i]->getMappings())
+    {
+      auto ours = mMappings.find(pair.first);
+      if (ours != mMappings.end()
+          && ours->second == mShots[i]->getMapping(pair.first))
+      {
+        pair.second = copy->mMappings[pair.first];
+      }
+    }
+  }
+  // Sharing our parallel worlds would race with us, so the copy gets its own
+  copy->setParallelOperationsEnabled(mParallelOperationsEnabled);
+  return copy;
+}
+
 //==============================================================================
 void MultiShot::setParallelOperationsEnabled(bool enabled)
 {
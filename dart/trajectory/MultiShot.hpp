@@ -34,6 +34,10 @@ public:
   /// Destructor
   virtual ~MultiShot() override;
 
+  /// This returns an independent copy of this problem, which can be evaluated
+  /// against a different world concurrently with this one.
+  std::shared_ptr<Problem> clone() const override;
+
   /// If TRUE, this will use multiple independent threads to compute each
   /// SingleShot's values internally. Currently defaults to FALSE. This should
   /// be considered EXPERIMENTAL! Expect bugs.
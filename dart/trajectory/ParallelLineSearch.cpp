@@ -0,0 +1,211 @@
+#include "dart/trajectory/ParallelLineSearch.hpp"
+
+
+#include "dart/simulation/World.hpp"
+#include "dart/trajectory/Problem.hpp"
+
+namespace dart {
+namespace trajectory {
+
+//==============================================================================
+ParallelLineSearch::ParallelLineSearch()
+  : mNumCandidates(4),
+    mMaxRounds(5),
+    mShrinkFactor(0.5),
+    mSufficientDecrease(1e-4),
+    mRound(0),
+    mPendingWorkers(0),
+    mStopWorkers(false)
+{
+}
+
+//==============================================================================
+ParallelLineSearch::~ParallelLineSearch()
+{
+  stopWorkers();
+}
+
+//==============================================================================
+void ParallelLineSearch::setNumCandidates(int numCandidates)
+{
+  mNumCandidates = std::max(1, numCandidates);
+}
+
+//==============================================================================
+void ParallelLineSearch::setMaxRounds(int maxRounds)
+{
+  mMaxRounds = std::max(1, maxRounds);
+}
+
+//==============================================================================
+void ParallelLineSearch::setShrinkFactor(s_t shrinkFactor)
+{
+  mShrinkFactor = shrinkFactor;
+}
+
+//==============================================================================
+void ParallelLineSearch::setSufficientDecrease(s_t sufficientDecrease)
+{
+  mSufficientDecrease = sufficientDecrease;
+}
+
+//==============================================================================
+void ParallelLineSearch::prepare(Problem* problem)
+{
+  int n = problem->getFlatProblemDim(problem->mWorld);
+
+  stopWorkers();
+  mProblems.clear();
+  mWorlds.clear();
+  if (mNumCandidates > 1)
+  {
+    // Before using Eigen in a multi-threaded environment, we need to explicitly
+    // call this (at least prior to Eigen 3.3)
+    Eigen::initParallel();
+
+    for (int i = 0; i < mNumCandidates; i++)
+    {
+      std::shared_ptr<Problem> copy = problem->clone();
+      if (copy == nullptr)
+      {
+        // This problem can't be copied, so we'll search serially
+        mProblems.clear();
+        mWorlds.clear();
+        break;
+      }
+      mProblems.push_back(copy);
+      mWorlds.push_back(problem->mWorld->clone());
+    }
+  }
+
+  mCandidates.resize(mNumCandidates);
+  for (int i = 0; i < mNumCandidates; i++)
+  {
+    mCandidates[i].resize(n);
+  }
+  mLosses.resize(mNumCandidates);
+
+  for (int i = 0; i < mProblems.size(); i++)
+  {
+    mWorkers.emplace_back(&ParallelLineSearch::workerLoop, this, i);
+  }
+}
+
+//==============================================================================
+s_t ParallelLineSearch::search(
+    Problem* problem,
+    const Eigen::VectorXs& x,
+    s_t loss,
+    const Eigen::VectorXs& grad,
+    const Eigen::VectorXs& direction,
+    const Eigen::VectorXs& lower,
+    const Eigen::VectorXs& upper,
+    s_t initialStep,
+    /* OUT */ Eigen::VectorXs& xOut,
+    /* OUT */ s_t& lossOut)
+{
+  s_t step = initialStep;
+  for (int round = 0; round < mMaxRounds; round++)
+  {
+    s_t roundStep = step;
+    for (int i = 0; i < mNumCandidates; i++)
+    {
+      mCandidates[i]
+          = (x + step * direction).cwiseMax(lower).cwiseMin(upper);
+      step *= mShrinkFactor;
+    }
+
+    if (isParallel())
+    {
+      evaluateCandidatesInParallel();
+    }
+
+    // Take the longest step that gives a sufficient decrease
+    s_t candidateStep = roundStep;
+    for (int i = 0; i < mNumCandidates; i++)
+    {
+      if (!isParallel())
+      {
+        problem->unflatten(problem->mWorld, mCandidates[i]);
+        mLosses[i] = problem->getLoss(problem->mWorld);
+      }
+      s_t expected = grad.dot(mCandidates[i] - x);
+      if (mLosses[i] <= loss + mSufficientDecrease * expected
+          && mLosses[i] < loss)
+      {
+        xOut = mCandidates[i];
+        lossOut = mLosses[i];
+        return candidateStep;
+      }
+      candidateStep *= mShrinkFactor;
+    }
+  }
+  return 0.0;
+}
+
+//==============================================================================
+bool ParallelLineSearch::isParallel() const
+{
+  return mProblems.size() > 0;
+}
+
+//==============================================================================
+void ParallelLineSearch::evaluateCandidate(int i)
+{
+  mProblems[i]->unflatten(mWorlds[i], mCandidates[i]);
+  mLosses[i] = mProblems[i]->getLoss(mWorlds[i]);
+}
+
+//==============================================================================
+void ParallelLineSearch::workerLoop(int i)
+{
+  int lastRound = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mWorkerMutex);
+      mRoundStarted.wait(
+          lock, [&]() { return mStopWorkers || mRound != lastRound; });
+      if (mStopWorkers)
+        return;
+      lastRound = mRound;
+    }
+
+    evaluateCandidate(i);
+
+    std::lock_guard<std::mutex> lock(mWorkerMutex);
+    mPendingWorkers--;
+    if (mPendingWorkers == 0)
+      mRoundFinished.notify_one();
+  }
+}
+
+//==============================================================================
+void ParallelLineSearch::evaluateCandidatesInParallel()
+{
+  std::unique_lock<std::mutex> lock(mWorkerMutex);
+  mPendingWorkers = mWorkers.size();
+  mRound++;
+  mRoundStarted.notify_all();
+  mRoundFinished.wait(lock, [&]() { return mPendingWorkers == 0; });
+}
+
+//==============================================================================
+void ParallelLineSearch::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mWorkerMutex);
+    mStopWorkers = true;
+  }
+  mRoundStarted.notify_all();
+  for (std::thread& worker : mWorkers)
+  {
+    worker.join();
+  }
+  mWorkers.clear();
+  mStopWorkers = false;
+  mRound = 0;
+}
+
+} // namespace trajectory
+} // namespace dart
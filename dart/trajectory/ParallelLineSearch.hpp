@@ -0,0 +1,115 @@
+#ifndef DART_TRAJECTORY_PARALLEL_LINE_SEARCH_HPP_
+#define DART_TRAJECTORY_PARALLEL_LINE_SEARCH_HPP_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/math/MathTypes.hpp"
+
+namespace dart {
+
+namespace simulation {
+class World;
+}
+
+namespace trajectory {
+
+class Problem;
+
+/*
+ * This is a projected backtracking line search that evaluates several step
+ * lengths at once. Each candidate is evaluated on its own clone of the Problem
+ * and the World, so a round of candidates costs about as much wall-clock time
+ * as a single rollout. If the Problem can't be cloned, this falls back to
+ * trying the candidates one at a time on the original Problem.
+ */
+class ParallelLineSearch
+{
+public:
+  ParallelLineSearch();
+
+  ~ParallelLineSearch();
+
+  /// This sets how many step lengths get evaluated concurrently in each round
+  void setNumCandidates(int numCandidates);
+
+  /// This sets how many rounds of candidates we try before giving up
+  void setMaxRounds(int maxRounds);
+
+  /// Each candidate step is this factor times the one before it
+  void setShrinkFactor(s_t shrinkFactor);
+
+  /// This is the Armijo constant for the sufficient decrease condition
+  void setSufficientDecrease(s_t sufficientDecrease);
+
+  /// This allocates the clones and buffers used during the search, and starts
+  /// one worker thread per clone. The workers wait between rounds, so search()
+  /// doesn't create any threads. This must be called before search(), and
+  /// again if the problem dimension changes.
+  void prepare(Problem* problem);
+
+  /// This searches along `direction` from `x`, projecting every candidate into
+  /// [lower, upper]. Returns the accepted step length (with the point in
+  /// `xOut` and its loss in `lossOut`), or 0 if no candidate gave a sufficient
+  /// decrease. This leaves the state of `problem` undefined.
+  s_t search(
+      Problem* problem,
+      const Eigen::VectorXs& x,
+      s_t loss,
+      const Eigen::VectorXs& grad,
+      const Eigen::VectorXs& direction,
+      const Eigen::VectorXs& lower,
+      const Eigen::VectorXs& upper,
+      s_t initialStep,
+      /* OUT */ Eigen::VectorXs& xOut,
+      /* OUT */ s_t& lossOut);
+
+  /// Returns true if candidates are evaluated on clones in parallel
+  bool isParallel() const;
+
+protected:
+  /// This evaluates the loss at candidate `i` on clone `i`
+  void evaluateCandidate(int i);
+
+  /// This is what worker `i` runs: it waits for each round to start, then
+  /// evaluates candidate `i`
+  void workerLoop(int i);
+
+  /// This wakes up the workers to evaluate every candidate, and waits for them
+  /// to finish
+  void evaluateCandidatesInParallel();
+
+  /// This shuts down and joins the worker threads, if there are any
+  void stopWorkers();
+
+  int mNumCandidates;
+  int mMaxRounds;
+  s_t mShrinkFactor;
+  s_t mSufficientDecrease;
+
+  std::vector<std::shared_ptr<Problem>> mProblems;
+  std::vector<std::shared_ptr<simulation::World>> mWorlds;
+  std::vector<Eigen::VectorXs> mCandidates;
+  std::vector<s_t> mLosses;
+
+  std::vector<std::thread> mWorkers;
+  std::mutex mWorkerMutex;
+  std::condition_variable mRoundStarted;
+  std::condition_variable mRoundFinished;
+  /// Counts the rounds started so far, so workers can tell a new round from a
+  /// spurious wakeup
+  int mRound;
+  /// The number of workers still evaluating the current round
+  int mPendingWorkers;
+  bool mStopWorkers;
+};
+
+} // namespace trajectory
+} // namespace dart
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "dart/neural/IdentityMapping.hpp"
 #include "dart/neural/Mapping.hpp"
+#include "dart/neural/ParallelFiniteDifference.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/simulation/World.hpp"
 
@@ -37,6 +38,31 @@ Problem::~Problem()
   // std::cout << "Freeing Problem: " << this << std::endl;
 }
 
+//==============================================================================
+/// This returns an independent copy of this problem, which can be evaluated
+/// against a different world (usually a clone of the original) concurrently
+/// with this one. Returns nullptr if this problem doesn't support copying.
+std::shared_ptr<Problem> Problem::clone() const
+{
+  return nullptr;
+}
+
+//==============================================================================
+/// This gives `copy` its own copy of each of our mappings, since a mapping can
+/// keep state between calls. Returns false if any mapping can't be copied.
+bool Problem::cloneMappingsInto(Problem& copy) const
+{
+  copy.mMappings.clear();
+  for (const auto& pair : mMappings)
+  {
+    std::shared_ptr<neural::Mapping> mapping = pair.second->clone();
+    if (mapping == nullptr)
+      return false;
+    copy.mMappings[pair.first] = mapping;
+  }
+  return true;
+}
+
 //==============================================================================
 /// This updates the loss function for this trajectory
 void Problem::setLoss(LossFn loss)
@@ -1123,13 +1149,47 @@ void Problem::finiteDifferenceJacobian(
   assert(jac.cols() == dim);
   assert(jac.rows() == numConstraints);
 
-  Eigen::VectorXs originalConstraints = Eigen::VectorXs::Zero(numConstraints);
-  computeConstraints(world, originalConstraints, nullptr);
   Eigen::VectorXs flat = Eigen::VectorXs::Zero(dim);
   flatten(world, flat, nullptr);
 
   const s_t EPS = 1e-7;
 
+  // unflatten() writes into the problem, so each worker in the pool needs its
+  // own copy of it
+  std::shared_ptr<neural::ParallelFiniteDifference> pool
+      = world->getFiniteDifferencePool();
+  std::vector<std::shared_ptr<Problem>> copies;
+  for (int i = 0; i < pool->getNumWorkers(); i++)
+  {
+    std::shared_ptr<Problem> copy = clone();
+    if (copy == nullptr)
+    {
+      copies.clear();
+      break;
+    }
+    copies.push_back(copy);
+  }
+
+  if (copies.size() > 0)
+  {
+    pool->setScheme(neural::ParallelFiniteDifference::CENTRAL);
+    pool->setStepSize(EPS);
+    jac = pool->jacobian(
+        flat,
+        numConstraints,
+        [&](int worker,
+            simulation::World* /* world */,
+            const Eigen::VectorXs& input,
+            Eigen::VectorXs& out) {
+          std::shared_ptr<simulation::World> clone = pool->getWorker(worker);
+          copies[worker]->unflatten(clone, input, nullptr);
+          copies[worker]->computeConstraints(clone, out, nullptr);
+          return true;
+        });
+    return;
+  }
+
+  // This problem can't be copied, so fall back to perturbing it serially
   Eigen::VectorXs positiveConstraints = Eigen::VectorXs::Zero(numConstraints);
   Eigen::VectorXs negativeConstraints = Eigen::VectorXs::Zero(numConstraints);
   for (int i = 0; i < dim; i++)
@@ -30,6 +30,9 @@ class Problem
 public:
   friend class IPOptShotWrapper;
   friend class SGDOptimizer;
+  friend class AdamOptimizer;
+  friend class LBFGSOptimizer;
+  friend class ParallelLineSearch;
 
   /// Default constructor
   Problem(std::shared_ptr<simulation::World> world, LossFn loss, int steps);
@@ -37,6 +40,11 @@ public:
   /// Abstract destructor
   virtual ~Problem();
 
+  /// This returns an independent copy of this problem, which can be evaluated
+  /// against a different world (usually a clone of the original) concurrently
+  /// with this one. Returns nullptr if this problem doesn't support copying.
+  virtual std::shared_ptr<Problem> clone() const;
+
   /// This prevents a force from changing in optimization, keeping it fixed at a
   /// specified value.
   virtual void pinForce(int time, Eigen::VectorXs value) = 0;
@@ -436,6 +444,11 @@ protected:
       = 0;
 
 protected:
+  /// This gives `copy` its own copy of each of our mappings, since a mapping
+  /// can keep state between calls. Returns false if any mapping can't be
+  /// copied.
+  bool cloneMappingsInto(Problem& copy) const;
+
   std::shared_ptr<simulation::World> mWorld;
   LossFn mLoss;
   int mSteps;
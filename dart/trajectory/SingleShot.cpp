@@ -1,11 +1,15 @@
 #include "dart/trajectory/SingleShot.hpp"
 
+#include <atomic>
+#include <future>
 #include <vector>
 
 #include "dart/dynamics/Skeleton.hpp"
 #include "dart/neural/BackpropSnapshot.hpp"
 #include "dart/neural/NeuralUtils.hpp"
+#include "dart/neural/ParallelFiniteDifference.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
+#include "dart/neural/WithRespectToMass.hpp"
 #include "dart/simulation/World.hpp"
 
 // Make production builds happy with asserts
@@ -35,6 +39,7 @@ SingleShot::SingleShot(
   assert(steps > 0);
   mForces = Eigen::MatrixXs::Zero(world->getNumDofs(), steps);
   mSnapshotsCacheDirty = true;
+  mParallelOperationsEnabled = true;
   mPinnedForces = Eigen::MatrixXs::Zero(world->getNumDofs(), steps);
   for (int i = 0; i < steps; i++)
   {
@@ -48,6 +53,30 @@ SingleShot::~SingleShot()
   // std::cout << "Freeing SingleShot: " << this << std::endl;
 }
 
+//==============================================================================
+/// This returns an independent copy of this problem, which can be evaluated
+/// against a different world concurrently with this one.
+std::shared_ptr<Problem> SingleShot::clone() const
+{
+  std::shared_ptr<SingleShot> copy = std::make_shared<SingleShot>(*this);
+  // The caches hold rollouts and snapshots from our world, so the copy needs
+  // to build its own
+  copy->mRolloutCacheDirty = true;
+  copy->mRolloutCache = nullptr;
+  copy->mGradWrtRolloutCache = nullptr;
+  copy->mSnapshotsCacheDirty = true;
+  copy->mSnapshotsCache.clear();
+  if (!cloneMappingsInto(*copy))
+    return nullptr;
+  return copy;
+}
+
+//==============================================================================
+void SingleShot::setParallelOperationsEnabled(bool enabled)
+{
+  mParallelOperationsEnabled = enabled;
+}
+
 //==============================================================================
 /// This prevents a force from changing in optimization, keeping it fixed at a
 /// specified value.
@@ -374,6 +403,7 @@ void SingleShot::backpropJacobianOfFinalState(
 
   std::vector<MappedBackpropSnapshotPtr> snapshots
       = getSnapshots(world, thisLog);
+  precomputeSnapshotJacobians(world, snapshots, thisLog);
 
   int posDim = world->getNumDofs();
   int velDim = world->getNumDofs();
@@ -396,26 +426,18 @@ void SingleShot::backpropJacobianOfFinalState(
   assert(jacDynamic.rows() == posDim + velDim);
   assert(jacStatic.rows() == posDim + velDim);
 
-  RestorableSnapshot restoreSnapshot(world);
-
+  // All the Jacobians are cached, so this sweep never needs to reset the world
   int cursorDynamic = getFlatDynamicProblemDim(world);
   for (int i = mSteps - 1; i >= 0; i--)
   {
     MappedBackpropSnapshotPtr ptr = snapshots[i];
     TimestepJacobians thisTimestep;
 
-    world->setPositions(ptr->getPreStepPosition());
-    world->setVelocities(ptr->getPreStepVelocity());
-    world->setControlForces(ptr->getPreStepTorques());
-    world->setCachedLCPSolution(ptr->getPreStepLCPCache());
-
     const Eigen::MatrixXs& forceVel = ptr->getControlForceVelJacobian(world, thisLog);
     const Eigen::MatrixXs& posPos = ptr->getPosPosJacobian(world, thisLog);
     const Eigen::MatrixXs& posVel = ptr->getPosVelJacobian(world, thisLog);
     const Eigen::MatrixXs& velPos = ptr->getVelPosJacobian(world, thisLog);
     const Eigen::MatrixXs& velVel = ptr->getVelVelJacobian(world, thisLog);
-    // This blows up our caches, because it does finite differencing, so put
-    // this last
     const Eigen::MatrixXs& massVel = ptr->getMassVelJacobian(world, thisLog);
 
     // p_end <- f_t = p_end <- v_t+1 * v_t+1 <- f_t
@@ -466,8 +488,6 @@ void SingleShot::backpropJacobianOfFinalState(
   }
   assert(cursorDynamic == 0);
 
-  restoreSnapshot.restore();
-
 #ifdef LOG_PERFORMANCE_SINGLE_SHOT
   if (thisLog != nullptr)
   {
@@ -558,6 +578,12 @@ void SingleShot::backpropGradientWrt(
   std::vector<MappedBackpropSnapshotPtr> snapshots
       = getSnapshots(world, thisLog);
   assert(snapshots.size() == mSteps);
+  // Exploring alternate strategies backprops through each constrained group
+  // on the world itself, so there's nothing to gain from caching Jacobians
+  if (!mExploreAlternateStrategies)
+  {
+    precomputeSnapshotJacobians(world, snapshots, thisLog);
+  }
 
   LossGradient nextTimestep;
   nextTimestep.lossWrtPosition = Eigen::VectorXs::Zero(world->getNumDofs());
@@ -678,6 +704,78 @@ std::vector<MappedBackpropSnapshotPtr> SingleShot::getSnapshots(
   return mSnapshotsCache;
 }
 
+//==============================================================================
+void SingleShot::precomputeSnapshotJacobians(
+    std::shared_ptr<simulation::World> world,
+    const std::vector<MappedBackpropSnapshotPtr>& snapshots,
+    PerformanceLog* log)
+{
+  PerformanceLog* thisLog = nullptr;
+#ifdef LOG_PERFORMANCE_SINGLE_SHOT
+  if (log != nullptr)
+  {
+    thisLog = log->startRun("SingleShot.precomputeSnapshotJacobians");
+  }
+#endif
+
+  // Finite differenced Jacobians already spread their columns across the pool,
+  // and debugging against finite differences needs the real world, so in those
+  // cases we stay on this thread. Fetching the pool syncs every clone to the
+  // World's current properties, so the clones see any changes made since the
+  // last pass.
+  int numWorkers = 1;
+  std::shared_ptr<ParallelFiniteDifference> pool;
+  if (mParallelOperationsEnabled && snapshots.size() > 1
+      && !world->getUseFDOverride()
+      && !world->getSlowDebugResultsAgainstFD())
+  {
+    pool = world->getFiniteDifferencePool();
+    numWorkers = std::min(pool->getNumWorkers(), (int)snapshots.size());
+  }
+
+  if (numWorkers <= 1)
+  {
+    for (const MappedBackpropSnapshotPtr& snapshot : snapshots)
+    {
+      snapshot->precomputeJacobians(world, thisLog);
+    }
+  }
+  else
+  {
+    // The clones share our WithRespectToMass, which lazily creates an entry
+    // for each Skeleton the first time it sees it. Make sure that's happened
+    // before the clones read it concurrently.
+    world->getWrtMass()->get(world.get());
+
+    // Timesteps with lots of contacts take longer, so workers pull timesteps
+    // off a shared counter rather than taking a fixed share
+    std::atomic<int> next(0);
+    const int numSnapshots = snapshots.size();
+    std::vector<std::future<void>> futures;
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+      futures.push_back(std::async(std::launch::async, [&, worker]() {
+        std::shared_ptr<simulation::World> clone = pool->getWorker(worker);
+        for (int i = next++; i < numSnapshots; i = next++)
+        {
+          snapshots[i]->precomputeJacobians(clone);
+        }
+      }));
+    }
+    for (int i = 0; i < futures.size(); i++)
+    {
+      futures[i].wait();
+    }
+  }
+
+#ifdef LOG_PERFORMANCE_SINGLE_SHOT
+  if (thisLog != nullptr)
+  {
+    thisLog->end();
+  }
+#endif
+}
+
 //==============================================================================
 /// This populates the passed in matrices with the values from this trajectory
 void SingleShot::getStates(
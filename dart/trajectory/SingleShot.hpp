@@ -35,6 +35,16 @@ public:
   /// Destructor
   virtual ~SingleShot() override;
 
+  /// This returns an independent copy of this problem, which can be evaluated
+  /// against a different world concurrently with this one.
+  std::shared_ptr<Problem> clone() const override;
+
+  /// If TRUE, backward passes first compute each timestep's Jacobians on the
+  /// clones in the World's finite difference pool, which are synced to the
+  /// World before every pass. If FALSE, everything runs on this thread against
+  /// the World itself. Defaults to TRUE.
+  void setParallelOperationsEnabled(bool enabled);
+
   /// This prevents a force from changing in optimization, keeping it fixed at a
   /// specified value.
   void pinForce(int time, Eigen::VectorXs value) override;
@@ -188,6 +198,16 @@ public:
       std::shared_ptr<simulation::World> world, s_t EPS);
 
 private:
+  /// This is the first, parallel half of a backward pass. It fills in the
+  /// Jacobians of every snapshot, spreading timesteps across the clones in the
+  /// World's finite difference pool. None of a timestep's Jacobians depend on
+  /// the loss flowing back from later timesteps, so this leaves only the cheap
+  /// sequential chaining of products for the backward sweep.
+  void precomputeSnapshotJacobians(
+      std::shared_ptr<simulation::World> world,
+      const std::vector<neural::MappedBackpropSnapshotPtr>& snapshots,
+      PerformanceLog* log = nullptr);
+
   Eigen::VectorXs mStartPos;
   Eigen::VectorXs mStartVel;
   Eigen::MatrixXs mForces;
@@ -196,6 +216,8 @@ private:
 
   bool mSnapshotsCacheDirty;
   std::vector<neural::MappedBackpropSnapshotPtr> mSnapshotsCache;
+
+  bool mParallelOperationsEnabled;
 };
 
 } // namespace trajectory
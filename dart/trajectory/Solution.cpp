@@ -1,5 +1,9 @@
 #include "dart/trajectory/Solution.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
 #include <sstream>
 #include <unordered_map>
 #include <vector>
@@ -18,9 +22,258 @@ using namespace dart;
 namespace dart {
 namespace trajectory {
 
+namespace {
+
+// The iteration stream is a 4 byte magic and a 4 byte version, followed by a
+// sequence of records. Each record is a one byte type tag, followed by a 4
+// byte registration count, followed by a type-specific payload. Everything is
+// written in host byte order, with scalars stored as doubles.
+const char ITERATION_STREAM_MAGIC[4] = {'N', 'S', 'O', 'L'};
+const int32_t ITERATION_STREAM_VERSION = 1;
+
+const char RECORD_STEP = 's';
+const char RECORD_X = 'x';
+const char RECORD_LOSS = 'l';
+const char RECORD_GRADIENT = 'g';
+const char RECORD_CONSTRAINT_VALUES = 'c';
+const char RECORD_SPARSE_JAC = 'j';
+
+template <typename T>
+void writeRaw(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readRaw(std::istream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return static_cast<bool>(in);
+}
+
+bool readVector(std::istream& in, Eigen::VectorXs& vec)
+{
+  int32_t size;
+  if (!readRaw(in, size) || size < 0)
+    return false;
+  std::vector<double> raw(size);
+  in.read(reinterpret_cast<char*>(raw.data()), size * sizeof(double));
+  if (!in)
+    return false;
+  vec.resize(size);
+  for (int i = 0; i < size; i++)
+  {
+    vec(i) = raw[i];
+  }
+  return true;
+}
+
+} // namespace
+
+//==============================================================================
+Solution::Solution()
+  : mSuccess(false),
+    mStagnated(false),
+    mRetention(IterationRetention::ALL),
+    mRetentionN(0),
+    mNumRegisteredSteps(0),
+    mNumRegisteredXs(0),
+    mNumRegisteredLosses(0),
+    mNumRegisteredGradients(0),
+    mNumRegisteredConstraintValues(0),
+    mNumRegisteredSparseJacobians(0),
+    mPerfLog(nullptr)
+{
+}
+
+//==============================================================================
+Solution::~Solution()
+{
+  closeIterationStream();
+}
+
+//==============================================================================
+void Solution::setIterationRetention(IterationRetention retention, int n)
+{
+  assert(retention == IterationRetention::ALL || n >= 0);
+  assert(retention != IterationRetention::EVERY_KTH || n > 0);
+  mRetention = retention;
+  mRetentionN = n;
+
+  // Apply the new policy to whatever we're already holding
+  if (retention == IterationRetention::BEST_N)
+  {
+    while (mSteps.size() > n)
+    {
+      mSteps.erase(std::max_element(
+          mSteps.begin(),
+          mSteps.end(),
+          [](const OptimizationStep& a, const OptimizationStep& b) {
+            return a.loss < b.loss;
+          }));
+    }
+  }
+  else if (
+      retention == IterationRetention::RING_BUFFER && mSteps.size() > n)
+  {
+    mSteps.erase(mSteps.begin(), mSteps.end() - n);
+  }
+  if (retention == IterationRetention::BEST_N
+      || retention == IterationRetention::RING_BUFFER)
+  {
+    auto trim = [n](auto& history) {
+      if (history.size() > n)
+        history.erase(history.begin(), history.end() - n);
+    };
+    trim(mXs);
+    trim(mLosses);
+    trim(mGradients);
+    trim(mConstraintValues);
+    trim(mSparseJacobians);
+  }
+}
+
+//==============================================================================
+IterationRetention Solution::getIterationRetention() const
+{
+  return mRetention;
+}
+
+//==============================================================================
+bool Solution::setIterationStream(const std::string& path)
+{
+  closeIterationStream();
+  if (path == "")
+    return true;
+  mIterationStream.open(path, std::ios::out | std::ios::binary);
+  if (!mIterationStream.is_open())
+  {
+    std::cout << "Solution::setIterationStream() failed to open \"" << path
+              << "\" for writing" << std::endl;
+    return false;
+  }
+  mIterationStream.write(ITERATION_STREAM_MAGIC, 4);
+  writeRaw(mIterationStream, ITERATION_STREAM_VERSION);
+  return true;
+}
+
 //==============================================================================
-Solution::Solution() : mSuccess(false), mPerfLog(nullptr)
+void Solution::closeIterationStream()
 {
+  if (mIterationStream.is_open())
+  {
+    mIterationStream.flush();
+    mIterationStream.close();
+  }
+}
+
+//==============================================================================
+std::shared_ptr<Solution> Solution::loadIterationStream(const std::string& path)
+{
+  std::shared_ptr<Solution> solution = std::make_shared<Solution>();
+
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  char magic[4];
+  int32_t version;
+  in.read(magic, 4);
+  if (!in || !std::equal(magic, magic + 4, ITERATION_STREAM_MAGIC)
+      || !readRaw(in, version) || version != ITERATION_STREAM_VERSION)
+  {
+    std::cout << "Solution::loadIterationStream() \"" << path
+              << "\" is not a valid iteration stream" << std::endl;
+    return solution;
+  }
+
+  char type;
+  while (readRaw(in, type))
+  {
+    int32_t count;
+    if (!readRaw(in, count))
+      break;
+    if (type == RECORD_STEP)
+    {
+      double loss;
+      double constraintViolation;
+      uint32_t protoSize;
+      if (!readRaw(in, loss) || !readRaw(in, constraintViolation)
+          || !readRaw(in, protoSize))
+        break;
+      std::string bytes(protoSize, '\0');
+      in.read(&bytes[0], protoSize);
+      proto::TrajectoryRollout proto;
+      if (!in || !proto.ParseFromString(bytes))
+        break;
+      TrajectoryRolloutReal rollout = TrajectoryRollout::deserialize(proto);
+      solution->registerIteration(
+          count, &rollout, (s_t)loss, (s_t)constraintViolation);
+    }
+    else if (type == RECORD_LOSS)
+    {
+      double loss;
+      if (!readRaw(in, loss))
+        break;
+      solution->registerLoss((s_t)loss);
+    }
+    else
+    {
+      Eigen::VectorXs vec;
+      if (!readVector(in, vec))
+        break;
+      if (type == RECORD_X)
+        solution->registerX(vec);
+      else if (type == RECORD_GRADIENT)
+        solution->registerGradient(vec);
+      else if (type == RECORD_CONSTRAINT_VALUES)
+        solution->registerConstraintValues(vec);
+      else if (type == RECORD_SPARSE_JAC)
+        solution->registerSparseJac(vec);
+      else
+        break;
+    }
+  }
+  if (in.fail() && !in.eof())
+  {
+    std::cout << "Solution::loadIterationStream() \"" << path
+              << "\" is truncated or corrupt, stopped reading early"
+              << std::endl;
+  }
+
+  return solution;
+}
+
+//==============================================================================
+template <typename T>
+bool Solution::retainDebugEntry(std::vector<T>& history, int count)
+{
+  switch (mRetention)
+  {
+    case IterationRetention::ALL:
+      return true;
+    case IterationRetention::EVERY_KTH:
+      return count % mRetentionN == 0;
+    case IterationRetention::BEST_N:
+    case IterationRetention::RING_BUFFER:
+      if (mRetentionN == 0)
+        return false;
+      if (history.size() >= mRetentionN)
+        history.erase(history.begin());
+      return true;
+  }
+  return true;
+}
+
+//==============================================================================
+void Solution::streamVector(char type, int count, const Eigen::VectorXs& vec)
+{
+  if (!mIterationStream.is_open())
+    return;
+  writeRaw(mIterationStream, type);
+  writeRaw(mIterationStream, (int32_t)count);
+  writeRaw(mIterationStream, (int32_t)vec.size());
+  for (int i = 0; i < vec.size(); i++)
+  {
+    writeRaw(mIterationStream, static_cast<double>(vec(i)));
+  }
 }
 
 //==============================================================================
@@ -122,6 +375,24 @@ void Solution::setSuccess(bool success)
   mSuccess = success;
 }
 
+//==============================================================================
+bool Solution::getSuccess() const
+{
+  return mSuccess;
+}
+
+//==============================================================================
+void Solution::setStagnated(bool stagnated)
+{
+  mStagnated = stagnated;
+}
+
+//==============================================================================
+bool Solution::getStagnated() const
+{
+  return mStagnated;
+}
+
 //==============================================================================
 void Solution::registerIteration(
     int index,
@@ -129,6 +400,56 @@ void Solution::registerIteration(
     s_t loss,
     s_t constraintViolation)
 {
+  mNumRegisteredSteps++;
+
+  if (mIterationStream.is_open())
+  {
+    proto::TrajectoryRollout proto;
+    rollout->serialize(proto);
+    std::string bytes;
+    proto.SerializeToString(&bytes);
+    writeRaw(mIterationStream, RECORD_STEP);
+    writeRaw(mIterationStream, (int32_t)index);
+    writeRaw(mIterationStream, static_cast<double>(loss));
+    writeRaw(mIterationStream, static_cast<double>(constraintViolation));
+    writeRaw(mIterationStream, (uint32_t)bytes.size());
+    mIterationStream.write(bytes.data(), bytes.size());
+  }
+
+  switch (mRetention)
+  {
+    case IterationRetention::ALL:
+      break;
+    case IterationRetention::EVERY_KTH:
+      if ((mNumRegisteredSteps - 1) % mRetentionN != 0)
+        return;
+      break;
+    case IterationRetention::RING_BUFFER:
+      if (mRetentionN == 0)
+        return;
+      if (mSteps.size() >= mRetentionN)
+        mSteps.erase(mSteps.begin());
+      break;
+    case IterationRetention::BEST_N:
+      if (mRetentionN == 0)
+        return;
+      if (mSteps.size() >= mRetentionN)
+      {
+        // Evict the worst step we're holding, but only if the new one beats
+        // it. Only now do we pay for deep-copying the rollout.
+        auto worst = std::max_element(
+            mSteps.begin(),
+            mSteps.end(),
+            [](const OptimizationStep& a, const OptimizationStep& b) {
+              return a.loss < b.loss;
+            });
+        if (loss >= worst->loss)
+          return;
+        mSteps.erase(worst);
+      }
+      break;
+  }
+
   mSteps.emplace_back(index, rollout, loss, constraintViolation);
 }
 
@@ -137,7 +458,10 @@ void Solution::registerIteration(
 /// x that we receive during optimization
 void Solution::registerX(Eigen::VectorXs x)
 {
-  mXs.push_back(x);
+  int count = mNumRegisteredXs++;
+  streamVector(RECORD_X, count, x);
+  if (retainDebugEntry(mXs, count))
+    mXs.push_back(x);
 }
 
 //==============================================================================
@@ -145,7 +469,15 @@ void Solution::registerX(Eigen::VectorXs x)
 /// loss evaluation that we produce during optimization
 void Solution::registerLoss(s_t loss)
 {
-  mLosses.push_back(loss);
+  int count = mNumRegisteredLosses++;
+  if (mIterationStream.is_open())
+  {
+    writeRaw(mIterationStream, RECORD_LOSS);
+    writeRaw(mIterationStream, (int32_t)count);
+    writeRaw(mIterationStream, static_cast<double>(loss));
+  }
+  if (retainDebugEntry(mLosses, count))
+    mLosses.push_back(loss);
 }
 
 //==============================================================================
@@ -153,7 +485,10 @@ void Solution::registerLoss(s_t loss)
 /// gradient that we produce during optimization
 void Solution::registerGradient(Eigen::VectorXs grad)
 {
-  mGradients.push_back(grad);
+  int count = mNumRegisteredGradients++;
+  streamVector(RECORD_GRADIENT, count, grad);
+  if (retainDebugEntry(mGradients, count))
+    mGradients.push_back(grad);
 }
 
 //==============================================================================
@@ -161,7 +496,10 @@ void Solution::registerGradient(Eigen::VectorXs grad)
 /// constraint value that we produce during optimization
 void Solution::registerConstraintValues(Eigen::VectorXs g)
 {
-  mConstraintValues.push_back(g);
+  int count = mNumRegisteredConstraintValues++;
+  streamVector(RECORD_CONSTRAINT_VALUES, count, g);
+  if (retainDebugEntry(mConstraintValues, count))
+    mConstraintValues.push_back(g);
 }
 
 //==============================================================================
@@ -169,16 +507,27 @@ void Solution::registerConstraintValues(Eigen::VectorXs g)
 /// jacobian that we produce during optimization
 void Solution::registerSparseJac(Eigen::VectorXs jac)
 {
-  mSparseJacobians.push_back(jac);
+  int count = mNumRegisteredSparseJacobians++;
+  streamVector(RECORD_SPARSE_JAC, count, jac);
+  if (retainDebugEntry(mSparseJacobians, count))
+    mSparseJacobians.push_back(jac);
 }
 
 //==============================================================================
-/// Returns the number of steps that were registered
+/// Returns the number of steps that are currently held in memory
 int Solution::getNumSteps()
 {
   return mSteps.size();
 }
 
+//==============================================================================
+/// Returns the total number of steps that were registered, including the
+/// ones dropped by the retention policy
+int Solution::getNumRegisteredSteps()
+{
+  return mNumRegisteredSteps;
+}
+
 //==============================================================================
 /// This returns the step record for this index
 const OptimizationStep& Solution::getStep(int index)
@@ -1,6 +1,7 @@
 #ifndef DART_TRAJECTORY_OPTIMIZATION_RECORD_HPP_
 #define DART_TRAJECTORY_OPTIMIZATION_RECORD_HPP_
 
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,14 +45,64 @@ struct OptimizationStep
   }
 };
 
+/// This controls how many of the registered iterations (and full debug info
+/// vectors) a Solution keeps alive in memory. Long optimizations on big
+/// worlds can otherwise hold hundreds of MB of rollouts.
+enum class IterationRetention
+{
+  /// Keep every registered iteration (the default)
+  ALL,
+  /// Keep only the N iterations with the lowest loss
+  BEST_N,
+  /// Keep only every k-th registered iteration
+  EVERY_KTH,
+  /// Keep only the N most recently registered iterations
+  RING_BUFFER
+};
+
 class Solution
 {
 public:
   Solution();
 
+  ~Solution();
+
+  /// This sets the policy for how many iterations we keep in memory. `n` is
+  /// the N for BEST_N and RING_BUFFER, and the k for EVERY_KTH. The full debug
+  /// info vectors (x's, gradients, etc) don't have a loss attached, so under
+  /// BEST_N they're retained as a ring buffer of the last N entries.
+  void setIterationRetention(IterationRetention retention, int n = 0);
+
+  /// This returns the current retention policy
+  IterationRetention getIterationRetention() const;
+
+  /// This opens a file that every registered iteration (and full debug info
+  /// vector) gets written to in a compact binary format, regardless of what
+  /// the retention policy keeps in memory. Pass an empty string to close the
+  /// stream. Returns false if the file couldn't be opened.
+  bool setIterationStream(const std::string& path);
+
+  /// This flushes and closes the iteration stream, if there is one open.
+  void closeIterationStream();
+
+  /// This reads back a file written with setIterationStream(), and returns a
+  /// Solution holding everything that was written to it.
+  static std::shared_ptr<Solution> loadIterationStream(const std::string& path);
+
   /// After optimization, register whether IPOPT thought it was a success
   void setSuccess(bool success);
 
+  /// Returns whether the optimizer reported success
+  bool getSuccess() const;
+
+  /// After optimization, register whether the optimizer stopped because it
+  /// couldn't make any more progress, rather than because it converged
+  void setStagnated(bool stagnated);
+
+  /// Returns true if the optimizer stopped because it couldn't make any more
+  /// progress, short of its convergence tolerance
+  bool getStagnated() const;
+
   /// During optimization, register a single iteration of gradient descent
   void registerIteration(
       int index,
@@ -79,9 +130,13 @@ public:
   /// jacobian that we produce during optimization
   void registerSparseJac(Eigen::VectorXs jac);
 
-  /// Returns the number of steps that were registered
+  /// Returns the number of steps that are currently held in memory
   int getNumSteps();
 
+  /// Returns the total number of steps that were registered, including the
+  /// ones dropped by the retention policy
+  int getNumRegisteredSteps();
+
   /// This returns the step record for this index
   const OptimizationStep& getStep(int index);
 
@@ -126,7 +181,26 @@ public:
   void reoptimize();
 
 protected:
+  /// This returns true if the `count`-th registered debug vector should be
+  /// kept in memory. It also drops the oldest entry of `history` if we're
+  /// using a bounded buffer and it's full.
+  template <typename T>
+  bool retainDebugEntry(std::vector<T>& history, int count);
+
+  /// This writes a single vector record to the iteration stream
+  void streamVector(char type, int count, const Eigen::VectorXs& vec);
+
   bool mSuccess;
+  bool mStagnated;
+  IterationRetention mRetention;
+  int mRetentionN;
+  int mNumRegisteredSteps;
+  int mNumRegisteredXs;
+  int mNumRegisteredLosses;
+  int mNumRegisteredGradients;
+  int mNumRegisteredConstraintValues;
+  int mNumRegisteredSparseJacobians;
+  std::ofstream mIterationStream;
   std::vector<OptimizationStep> mSteps;
   performance::PerformanceLog* mPerfLog;
   std::vector<Eigen::VectorXs> mXs;
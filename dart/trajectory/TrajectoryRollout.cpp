@@ -122,22 +122,25 @@ std::string TrajectoryRollout::toJson(
 
 //==============================================================================
 /// This writes us out to a protobuf
-void TrajectoryRollout::serialize(proto::TrajectoryRollout& proto) const
+void TrajectoryRollout::serialize(
+    proto::TrajectoryRollout& proto, proto::EigenEncoding encoding) const
 {
   for (const std::string& mapping : getMappings())
   {
     proto::serializeMatrix(
-        (*proto.mutable_pos())[mapping], getPosesConst(mapping));
+        (*proto.mutable_pos())[mapping], getPosesConst(mapping), encoding);
     proto::serializeMatrix(
-        (*proto.mutable_vel())[mapping], getVelsConst(mapping));
+        (*proto.mutable_vel())[mapping], getVelsConst(mapping), encoding);
     proto::serializeMatrix(
-        (*proto.mutable_force())[mapping], getControlForcesConst(mapping));
+        (*proto.mutable_force())[mapping],
+        getControlForcesConst(mapping),
+        encoding);
   }
-  proto::serializeVector(*proto.mutable_mass(), getMassesConst());
-  for (auto pair : getMetadataMap())
+  proto::serializeVector(*proto.mutable_mass(), getMassesConst(), encoding);
+  for (const auto& pair : getMetadataMap())
   {
     proto::serializeMatrix(
-        (*proto.mutable_metadata())[pair.first], pair.second);
+        (*proto.mutable_metadata())[pair.first], pair.second, encoding);
   }
 }
 
@@ -147,23 +150,23 @@ TrajectoryRolloutReal TrajectoryRollout::deserialize(
     const proto::TrajectoryRollout& proto)
 {
   std::unordered_map<std::string, Eigen::MatrixXs> pos;
-  for (auto pair : proto.pos())
+  for (const auto& pair : proto.pos())
   {
     pos[pair.first] = proto::deserializeMatrix(pair.second);
   }
   std::unordered_map<std::string, Eigen::MatrixXs> vel;
-  for (auto pair : proto.vel())
+  for (const auto& pair : proto.vel())
   {
     vel[pair.first] = proto::deserializeMatrix(pair.second);
   }
   std::unordered_map<std::string, Eigen::MatrixXs> force;
-  for (auto pair : proto.force())
+  for (const auto& pair : proto.force())
   {
     force[pair.first] = proto::deserializeMatrix(pair.second);
   }
   Eigen::VectorXs mass = proto::deserializeVector(proto.mass());
   std::unordered_map<std::string, Eigen::MatrixXs> metadata;
-  for (auto pair : proto.metadata())
+  for (const auto& pair : proto.metadata())
   {
     metadata[pair.first] = proto::deserializeMatrix(pair.second);
   }
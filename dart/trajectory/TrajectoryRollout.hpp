@@ -71,8 +71,11 @@ public:
   /// parsed and displayed.
   std::string toJson(std::shared_ptr<simulation::World> world) const;
 
-  /// This writes us out to a protobuf
-  void serialize(proto::TrajectoryRollout& proto) const;
+  /// This writes us out to a protobuf. The matrices are stored packed by
+  /// default, pass PACKED_FLOAT32 to also quantize them to float32.
+  void serialize(
+      proto::TrajectoryRollout& proto,
+      proto::EigenEncoding encoding = proto::PACKED_FLOAT64) const;
 
   /// This decodes a protobuf
   static TrajectoryRolloutReal deserialize(
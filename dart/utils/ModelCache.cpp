@@ -0,0 +1,1179 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/utils/ModelCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#ifndef WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "dart/common/Console.hpp"
+#include "dart/common/LocalResourceRetriever.hpp"
+#include "dart/collision/CollisionDetector.hpp"
+#include "dart/constraint/ConstraintSolver.hpp"
+#include "dart/dynamics/BallJoint.hpp"
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/BoxShape.hpp"
+#include "dart/dynamics/CapsuleShape.hpp"
+#include "dart/dynamics/ConeShape.hpp"
+#include "dart/dynamics/CylinderShape.hpp"
+#include "dart/dynamics/EllipsoidShape.hpp"
+#include "dart/dynamics/EulerJoint.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
+#include "dart/dynamics/Marker.hpp"
+#include "dart/dynamics/MeshShape.hpp"
+#include "dart/dynamics/PlanarJoint.hpp"
+#include "dart/dynamics/PlaneShape.hpp"
+#include "dart/dynamics/PrismaticJoint.hpp"
+#include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/ScrewJoint.hpp"
+#include "dart/dynamics/ShapeNode.hpp"
+#include "dart/dynamics/SphereShape.hpp"
+#include "dart/dynamics/TranslationalJoint.hpp"
+#include "dart/dynamics/UniversalJoint.hpp"
+#include "dart/dynamics/WeldJoint.hpp"
+#include "dart/utils/CompositeResourceRetriever.hpp"
+#include "dart/utils/DartResourceRetriever.hpp"
+#include "dart/utils/SkelParser.hpp"
+#include "dart/utils/sdf/SdfParser.hpp"
+#include "dart/utils/urdf/DartLoader.hpp"
+
+namespace dart {
+namespace utils {
+namespace ModelCache {
+
+namespace {
+
+const char MAGIC[8] = {'N', 'I', 'M', 'B', 'L', 'E', 'M', 'C'};
+
+enum BlobKind : std::uint32_t
+{
+  SKELETON_BLOB = 1,
+  WORLD_BLOB = 2
+};
+
+//==============================================================================
+/// Appends little fixed-size records to a byte string. All scalars are
+/// stored as doubles, so blobs don't depend on the s_t of the build.
+class BlobWriter
+{
+public:
+  explicit BlobWriter(std::string& data) : mData(data)
+  {
+    // Do nothing
+  }
+
+  template <typename T>
+  void writePod(const T& value)
+  {
+    mData.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeBool(bool value)
+  {
+    writePod<std::uint8_t>(value ? 1 : 0);
+  }
+
+  void writeScalar(s_t value)
+  {
+    writePod<double>(static_cast<double>(value));
+  }
+
+  void writeString(const std::string& value)
+  {
+    writePod<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+    mData.append(value);
+  }
+
+  template <typename Derived>
+  void writeMatrix(const Eigen::MatrixBase<Derived>& matrix)
+  {
+    for (Eigen::Index i = 0; i < matrix.rows(); ++i)
+      for (Eigen::Index j = 0; j < matrix.cols(); ++j)
+        writeScalar(matrix(i, j));
+  }
+
+  void writeIsometry(const Eigen::Isometry3s& transform)
+  {
+    writeMatrix(transform.matrix().topRows<3>());
+  }
+
+private:
+  std::string& mData;
+};
+
+//==============================================================================
+/// Reads back what BlobWriter wrote. Reading past the end doesn't throw, it
+/// marks the reader as failed and returns default values, so callers only
+/// have to check failed() once in a while.
+class BlobReader
+{
+public:
+  BlobReader(const char* data, std::size_t size)
+    : mCursor(data), mEnd(data + size), mFailed(false)
+  {
+    // Do nothing
+  }
+
+  template <typename T>
+  T readPod()
+  {
+    T value = T();
+    if (mFailed || static_cast<std::size_t>(mEnd - mCursor) < sizeof(T))
+    {
+      mFailed = true;
+      return value;
+    }
+    std::memcpy(&value, mCursor, sizeof(T));
+    mCursor += sizeof(T);
+    return value;
+  }
+
+  bool readBool()
+  {
+    return readPod<std::uint8_t>() != 0;
+  }
+
+  s_t readScalar()
+  {
+    return static_cast<s_t>(readPod<double>());
+  }
+
+  std::string readString()
+  {
+    const std::uint32_t size = readPod<std::uint32_t>();
+    if (mFailed || static_cast<std::size_t>(mEnd - mCursor) < size)
+    {
+      mFailed = true;
+      return std::string();
+    }
+    std::string value(mCursor, size);
+    mCursor += size;
+    return value;
+  }
+
+  template <typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    for (Eigen::Index i = 0; i < matrix.rows(); ++i)
+      for (Eigen::Index j = 0; j < matrix.cols(); ++j)
+        matrix(i, j) = readScalar();
+  }
+
+  Eigen::Vector3s readVector3()
+  {
+    Eigen::Vector3s vector;
+    readMatrix(vector);
+    return vector;
+  }
+
+  Eigen::Isometry3s readIsometry()
+  {
+    Eigen::Matrix<s_t, 3, 4> rows;
+    readMatrix(rows);
+    Eigen::Isometry3s transform = Eigen::Isometry3s::Identity();
+    transform.matrix().topRows<3>() = rows;
+    return transform;
+  }
+
+  bool failed() const
+  {
+    return mFailed;
+  }
+
+private:
+  const char* mCursor;
+  const char* mEnd;
+  bool mFailed;
+};
+
+//==============================================================================
+common::ResourceRetrieverPtr getRetriever(
+    const common::ResourceRetrieverPtr& retriever)
+{
+  if (retriever)
+    return retriever;
+
+  auto composite = std::make_shared<utils::CompositeResourceRetriever>();
+  composite->addSchemaRetriever(
+      "file", std::make_shared<common::LocalResourceRetriever>());
+  composite->addSchemaRetriever("dart", utils::DartResourceRetriever::create());
+  return composite;
+}
+
+//==============================================================================
+bool hashResource(
+    const common::Uri& uri,
+    const common::ResourceRetrieverPtr& retriever,
+    std::uint64_t& hash)
+{
+  try
+  {
+    hash = hashBytes(retriever->readAll(uri));
+    return true;
+  }
+  catch (const std::exception&)
+  {
+    return false;
+  }
+}
+
+//==============================================================================
+bool hasSuffix(const std::string& str, const std::string& suffix)
+{
+  return str.size() >= suffix.size()
+         && str.compare(str.size() - suffix.size(), suffix.size(), suffix)
+                == 0;
+}
+
+//==============================================================================
+void writeJointSpecifics(BlobWriter& out, const dynamics::Joint* joint)
+{
+  using namespace dynamics;
+
+  if (const auto* revolute = dynamic_cast<const RevoluteJoint*>(joint))
+  {
+    out.writeMatrix(revolute->getAxis());
+  }
+  else if (const auto* prismatic = dynamic_cast<const PrismaticJoint*>(joint))
+  {
+    out.writeMatrix(prismatic->getAxis());
+  }
+  else if (const auto* screw = dynamic_cast<const ScrewJoint*>(joint))
+  {
+    out.writeMatrix(screw->getAxis());
+    out.writeScalar(screw->getPitch());
+  }
+  else if (const auto* universal = dynamic_cast<const UniversalJoint*>(joint))
+  {
+    out.writeMatrix(universal->getAxis1());
+    out.writeMatrix(universal->getAxis2());
+  }
+  else if (const auto* euler = dynamic_cast<const EulerJoint*>(joint))
+  {
+    out.writePod<std::int32_t>(static_cast<std::int32_t>(euler->getAxisOrder()));
+  }
+  else if (const auto* planar = dynamic_cast<const PlanarJoint*>(joint))
+  {
+    out.writePod<std::int32_t>(static_cast<std::int32_t>(planar->getPlaneType()));
+    out.writeMatrix(planar->getTranslationalAxis1());
+    out.writeMatrix(planar->getTranslationalAxis2());
+  }
+}
+
+//==============================================================================
+/// Creates the joint (and its child BodyNode) of the given type under parent,
+/// and restores what writeJointSpecifics() wrote about it.
+dynamics::Joint* createJoint(
+    BlobReader& in,
+    const std::string& type,
+    const dynamics::SkeletonPtr& skel,
+    dynamics::BodyNode* parent)
+{
+  using namespace dynamics;
+
+  if (type == RevoluteJoint::getStaticType())
+  {
+    auto* joint = skel->createJointAndBodyNodePair<RevoluteJoint>(parent).first;
+    joint->setAxis(in.readVector3());
+    return joint;
+  }
+  if (type == PrismaticJoint::getStaticType())
+  {
+    auto* joint
+        = skel->createJointAndBodyNodePair<PrismaticJoint>(parent).first;
+    joint->setAxis(in.readVector3());
+    return joint;
+  }
+  if (type == ScrewJoint::getStaticType())
+  {
+    auto* joint = skel->createJointAndBodyNodePair<ScrewJoint>(parent).first;
+    joint->setAxis(in.readVector3());
+    joint->setPitch(in.readScalar());
+    return joint;
+  }
+  if (type == UniversalJoint::getStaticType())
+  {
+    auto* joint
+        = skel->createJointAndBodyNodePair<UniversalJoint>(parent).first;
+    joint->setAxis1(in.readVector3());
+    joint->setAxis2(in.readVector3());
+    return joint;
+  }
+  if (type == EulerJoint::getStaticType())
+  {
+    auto* joint = skel->createJointAndBodyNodePair<EulerJoint>(parent).first;
+    joint->setAxisOrder(
+        static_cast<EulerJoint::AxisOrder>(in.readPod<std::int32_t>()), false);
+    return joint;
+  }
+  if (type == PlanarJoint::getStaticType())
+  {
+    auto* joint = skel->createJointAndBodyNodePair<PlanarJoint>(parent).first;
+    const auto planeType
+        = static_cast<PlanarJoint::PlaneType>(in.readPod<std::int32_t>());
+    const Eigen::Vector3s axis1 = in.readVector3();
+    const Eigen::Vector3s axis2 = in.readVector3();
+    switch (planeType)
+    {
+      case PlanarJoint::PlaneType::XY:
+        joint->setXYPlane(false);
+        break;
+      case PlanarJoint::PlaneType::YZ:
+        joint->setYZPlane(false);
+        break;
+      case PlanarJoint::PlaneType::ZX:
+        joint->setZXPlane(false);
+        break;
+      case PlanarJoint::PlaneType::ARBITRARY:
+        joint->setArbitraryPlane(axis1, axis2, false);
+        break;
+    }
+    return joint;
+  }
+  if (type == BallJoint::getStaticType())
+    return skel->createJointAndBodyNodePair<BallJoint>(parent).first;
+  if (type == FreeJoint::getStaticType())
+    return skel->createJointAndBodyNodePair<FreeJoint>(parent).first;
+  if (type == WeldJoint::getStaticType())
+    return skel->createJointAndBodyNodePair<WeldJoint>(parent).first;
+  if (type == TranslationalJoint::getStaticType())
+    return skel->createJointAndBodyNodePair<TranslationalJoint>(parent).first;
+
+  return nullptr;
+}
+
+//==============================================================================
+bool isSupportedJoint(const dynamics::Joint* joint)
+{
+  using namespace dynamics;
+  const std::string& type = joint->getType();
+  return type == RevoluteJoint::getStaticType()
+         || type == PrismaticJoint::getStaticType()
+         || type == ScrewJoint::getStaticType()
+         || type == UniversalJoint::getStaticType()
+         || type == EulerJoint::getStaticType()
+         || type == PlanarJoint::getStaticType()
+         || type == BallJoint::getStaticType()
+         || type == FreeJoint::getStaticType()
+         || type == WeldJoint::getStaticType()
+         || type == TranslationalJoint::getStaticType();
+}
+
+//==============================================================================
+/// Writes the parameters of shape. Returns false for shape types the cache
+/// can't rebuild, and collects the URIs of meshes for the dependency list.
+bool writeShape(
+    BlobWriter& out,
+    const dynamics::ConstShapePtr& shape,
+    std::vector<std::string>& meshUris)
+{
+  using namespace dynamics;
+
+  const std::string& type = shape->getType();
+  out.writeString(type);
+
+  if (const auto* box = dynamic_cast<const BoxShape*>(shape.get()))
+  {
+    out.writeMatrix(box->getSize());
+  }
+  else if (const auto* sphere = dynamic_cast<const SphereShape*>(shape.get()))
+  {
+    out.writeScalar(sphere->getRadius());
+  }
+  else if (
+      const auto* ellipsoid = dynamic_cast<const EllipsoidShape*>(shape.get()))
+  {
+    out.writeMatrix(ellipsoid->getDiameters());
+  }
+  else if (const auto* capsule = dynamic_cast<const CapsuleShape*>(shape.get()))
+  {
+    out.writeScalar(capsule->getRadius());
+    out.writeScalar(capsule->getHeight());
+  }
+  else if (
+      const auto* cylinder = dynamic_cast<const CylinderShape*>(shape.get()))
+  {
+    out.writeScalar(cylinder->getRadius());
+    out.writeScalar(cylinder->getHeight());
+  }
+  else if (const auto* cone = dynamic_cast<const ConeShape*>(shape.get()))
+  {
+    out.writeScalar(cone->getRadius());
+    out.writeScalar(cone->getHeight());
+  }
+  else if (const auto* plane = dynamic_cast<const PlaneShape*>(shape.get()))
+  {
+    out.writeMatrix(plane->getNormal());
+    out.writeScalar(plane->getOffset());
+  }
+  else if (const auto* mesh = dynamic_cast<const MeshShape*>(shape.get()))
+  {
+    const std::string uri = mesh->getMeshUri();
+    if (uri.empty())
+      return false;
+    out.writeString(uri);
+    out.writeMatrix(mesh->getScale());
+    meshUris.push_back(uri);
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+//==============================================================================
+dynamics::ShapePtr readShape(
+    BlobReader& in, const common::ResourceRetrieverPtr& retriever)
+{
+  using namespace dynamics;
+
+  const std::string type = in.readString();
+  if (type == BoxShape::getStaticType())
+    return std::make_shared<BoxShape>(in.readVector3());
+  if (type == SphereShape::getStaticType())
+    return std::make_shared<SphereShape>(in.readScalar());
+  if (type == EllipsoidShape::getStaticType())
+    return std::make_shared<EllipsoidShape>(in.readVector3());
+  if (type == CapsuleShape::getStaticType())
+  {
+    const s_t radius = in.readScalar();
+    return std::make_shared<CapsuleShape>(radius, in.readScalar());
+  }
+  if (type == CylinderShape::getStaticType())
+  {
+    const s_t radius = in.readScalar();
+    return std::make_shared<CylinderShape>(radius, in.readScalar());
+  }
+  if (type == ConeShape::getStaticType())
+  {
+    const s_t radius = in.readScalar();
+    return std::make_shared<ConeShape>(radius, in.readScalar());
+  }
+  if (type == PlaneShape::getStaticType())
+  {
+    const Eigen::Vector3s normal = in.readVector3();
+    return std::make_shared<PlaneShape>(normal, in.readScalar());
+  }
+  if (type == MeshShape::getStaticType())
+  {
+    const std::string uri = in.readString();
+    const Eigen::Vector3s scale = in.readVector3();
+    if (in.failed())
+      return nullptr;
+    const aiScene* scene = MeshShape::loadMesh(uri, retriever);
+    if (!scene)
+      return nullptr;
+    return std::make_shared<MeshShape>(scale, scene, uri, retriever);
+  }
+  return nullptr;
+}
+
+//==============================================================================
+bool writeSkeletonBody(
+    BlobWriter& out,
+    const dynamics::SkeletonPtr& skel,
+    std::vector<std::string>& meshUris)
+{
+  out.writeString(skel->getName());
+  out.writeBool(skel->isEnabledSelfCollisionCheck());
+  out.writeBool(skel->isEnabledAdjacentBodyCheck());
+  out.writeBool(skel->isMobile());
+  out.writeMatrix(skel->getGravity());
+
+  const std::size_t numBodies = skel->getNumBodyNodes();
+  out.writePod<std::uint32_t>(static_cast<std::uint32_t>(numBodies));
+  for (std::size_t i = 0; i < numBodies; ++i)
+  {
+    const dynamics::BodyNode* body = skel->getBodyNode(i);
+    const dynamics::Joint* joint = body->getParentJoint();
+    const dynamics::BodyNode* parent = body->getParentBodyNode();
+
+    // Bodies are rebuilt in index order, so parents must come first
+    if (parent && parent->getIndexInSkeleton() >= i)
+      return false;
+    // Soft bodies would be rebuilt as rigid ones, so they aren't cached
+    if (body->asSoftBodyNode())
+      return false;
+    if (!isSupportedJoint(joint)
+        || joint->getActuatorType() == dynamics::Joint::MIMIC)
+      return false;
+
+    out.writePod<std::int32_t>(
+        parent ? static_cast<std::int32_t>(parent->getIndexInSkeleton()) : -1);
+
+    // Joint
+    out.writeString(joint->getType());
+    writeJointSpecifics(out, joint);
+    out.writeString(joint->getName());
+    out.writeIsometry(joint->getTransformFromParentBodyNode());
+    out.writeIsometry(joint->getTransformFromChildBodyNode());
+    out.writePod<std::int32_t>(
+        static_cast<std::int32_t>(joint->getActuatorType()));
+    out.writeBool(joint->isPositionLimitEnforced());
+    const std::size_t numDofs = joint->getNumDofs();
+    out.writePod<std::uint32_t>(static_cast<std::uint32_t>(numDofs));
+    for (std::size_t k = 0; k < numDofs; ++k)
+    {
+      out.writeString(joint->getDofName(k));
+      out.writeScalar(joint->getPositionLowerLimit(k));
+      out.writeScalar(joint->getPositionUpperLimit(k));
+      out.writeScalar(joint->getVelocityLowerLimit(k));
+      out.writeScalar(joint->getVelocityUpperLimit(k));
+      out.writeScalar(joint->getAccelerationLowerLimit(k));
+      out.writeScalar(joint->getAccelerationUpperLimit(k));
+      out.writeScalar(joint->getControlForceLowerLimit(k));
+      out.writeScalar(joint->getControlForceUpperLimit(k));
+      out.writeScalar(joint->getSpringStiffness(k));
+      out.writeScalar(joint->getRestPosition(k));
+      out.writeScalar(joint->getDampingCoefficient(k));
+      out.writeScalar(joint->getCoulombFriction(k));
+      out.writeScalar(joint->getInitialPosition(k));
+      out.writeScalar(joint->getInitialVelocity(k));
+      out.writeScalar(joint->getPosition(k));
+      out.writeScalar(joint->getVelocity(k));
+    }
+
+    // Body
+    out.writeString(body->getName());
+    out.writeMatrix(body->getInertia().getSpatialTensor());
+    out.writeScalar(body->getFrictionCoeff());
+    out.writeScalar(body->getRestitutionCoeff());
+    out.writeBool(body->getGravityMode());
+    out.writeBool(body->isCollidable());
+
+    // Shapes
+    const auto shapeNodes = body->getShapeNodes();
+    out.writePod<std::uint32_t>(static_cast<std::uint32_t>(shapeNodes.size()));
+    for (const dynamics::ShapeNode* shapeNode : shapeNodes)
+    {
+      out.writeString(shapeNode->getName());
+      out.writeIsometry(shapeNode->getRelativeTransform());
+      if (!writeShape(out, shapeNode->getShape(), meshUris))
+        return false;
+
+      const auto* visual = shapeNode->getVisualAspect();
+      out.writeBool(visual != nullptr);
+      if (visual)
+      {
+        out.writeMatrix(visual->getRGBA());
+        out.writeBool(visual->isHidden());
+      }
+      const auto* collision = shapeNode->getCollisionAspect();
+      out.writeBool(collision != nullptr);
+      if (collision)
+        out.writeBool(collision->isCollidable());
+      const auto* dynamicsAspect = shapeNode->getDynamicsAspect();
+      out.writeBool(dynamicsAspect != nullptr);
+      if (dynamicsAspect)
+      {
+        out.writeScalar(dynamicsAspect->getFrictionCoeff());
+        out.writeScalar(dynamicsAspect->getRestitutionCoeff());
+      }
+    }
+
+    // Markers
+    const std::size_t numMarkers = body->getNumMarkers();
+    out.writePod<std::uint32_t>(static_cast<std::uint32_t>(numMarkers));
+    for (std::size_t m = 0; m < numMarkers; ++m)
+    {
+      const dynamics::Marker* marker = body->getMarker(m);
+      out.writeString(marker->getName());
+      out.writeIsometry(marker->getRelativeTransform());
+      out.writeMatrix(marker->getColor());
+      out.writePod<std::int32_t>(
+          static_cast<std::int32_t>(marker->getConstraintType()));
+    }
+  }
+  return true;
+}
+
+//==============================================================================
+dynamics::SkeletonPtr readSkeletonBody(
+    BlobReader& in, const common::ResourceRetrieverPtr& retriever)
+{
+  dynamics::SkeletonPtr skel = dynamics::Skeleton::create(in.readString());
+  const bool selfCollision = in.readBool();
+  const bool adjacentBodyCheck = in.readBool();
+  skel->setMobile(in.readBool());
+  skel->setGravity(in.readVector3());
+
+  const std::uint32_t numBodies = in.readPod<std::uint32_t>();
+  for (std::uint32_t i = 0; i < numBodies && !in.failed(); ++i)
+  {
+    const std::int32_t parentIndex = in.readPod<std::int32_t>();
+    if (parentIndex >= static_cast<std::int32_t>(i))
+      return nullptr;
+    dynamics::BodyNode* parent
+        = parentIndex < 0 ? nullptr : skel->getBodyNode(parentIndex);
+
+    // Joint
+    const std::string type = in.readString();
+    dynamics::Joint* joint = createJoint(in, type, skel, parent);
+    if (!joint || in.failed())
+      return nullptr;
+    joint->setName(in.readString(), false);
+    joint->setTransformFromParentBodyNode(in.readIsometry());
+    joint->setTransformFromChildBodyNode(in.readIsometry());
+    joint->setActuatorType(
+        static_cast<dynamics::Joint::ActuatorType>(in.readPod<std::int32_t>()));
+    joint->setPositionLimitEnforced(in.readBool());
+    const std::uint32_t numDofs = in.readPod<std::uint32_t>();
+    if (numDofs != joint->getNumDofs())
+      return nullptr;
+    for (std::size_t k = 0; k < numDofs; ++k)
+    {
+      joint->getDof(k)->setName(in.readString());
+      joint->setPositionLowerLimit(k, in.readScalar());
+      joint->setPositionUpperLimit(k, in.readScalar());
+      joint->setVelocityLowerLimit(k, in.readScalar());
+      joint->setVelocityUpperLimit(k, in.readScalar());
+      joint->setAccelerationLowerLimit(k, in.readScalar());
+      joint->setAccelerationUpperLimit(k, in.readScalar());
+      joint->setControlForceLowerLimit(k, in.readScalar());
+      joint->setControlForceUpperLimit(k, in.readScalar());
+      joint->setSpringStiffness(k, in.readScalar());
+      joint->setRestPosition(k, in.readScalar());
+      joint->setDampingCoefficient(k, in.readScalar());
+      joint->setCoulombFriction(k, in.readScalar());
+      joint->setInitialPosition(k, in.readScalar());
+      joint->setInitialVelocity(k, in.readScalar());
+      joint->setPosition(k, in.readScalar());
+      joint->setVelocity(k, in.readScalar());
+    }
+
+    // Body
+    dynamics::BodyNode* body = joint->getChildBodyNode();
+    body->setName(in.readString());
+    Eigen::Matrix6s spatialInertia;
+    in.readMatrix(spatialInertia);
+    body->setInertia(dynamics::Inertia(spatialInertia));
+    body->setFrictionCoeff(in.readScalar());
+    body->setRestitutionCoeff(in.readScalar());
+    body->setGravityMode(in.readBool());
+    body->setCollidable(in.readBool());
+
+    // Shapes
+    const std::uint32_t numShapeNodes = in.readPod<std::uint32_t>();
+    for (std::uint32_t s = 0; s < numShapeNodes && !in.failed(); ++s)
+    {
+      const std::string name = in.readString();
+      const Eigen::Isometry3s transform = in.readIsometry();
+      dynamics::ShapePtr shape = readShape(in, retriever);
+      if (!shape || in.failed())
+        return nullptr;
+
+      dynamics::ShapeNode* shapeNode = body->createShapeNode(shape, name);
+      shapeNode->setRelativeTransform(transform);
+      if (in.readBool())
+      {
+        Eigen::Vector4s rgba;
+        in.readMatrix(rgba);
+        auto* visual = shapeNode->createVisualAspect();
+        visual->setRGBA(rgba);
+        visual->setHidden(in.readBool());
+      }
+      if (in.readBool())
+      {
+        auto* collision = shapeNode->createCollisionAspect();
+        collision->setCollidable(in.readBool());
+      }
+      if (in.readBool())
+      {
+        auto* dynamicsAspect = shapeNode->createDynamicsAspect();
+        dynamicsAspect->setFrictionCoeff(in.readScalar());
+        dynamicsAspect->setRestitutionCoeff(in.readScalar());
+      }
+    }
+
+    // Markers
+    const std::uint32_t numMarkers = in.readPod<std::uint32_t>();
+    for (std::uint32_t m = 0; m < numMarkers && !in.failed(); ++m)
+    {
+      dynamics::Marker* marker = body->createMarker(in.readString());
+      marker->setRelativeTransform(in.readIsometry());
+      Eigen::Vector4s color;
+      in.readMatrix(color);
+      marker->setColor(color);
+      marker->setConstraintType(static_cast<dynamics::Marker::ConstraintType>(
+          in.readPod<std::int32_t>()));
+    }
+  }
+
+  if (in.failed())
+    return nullptr;
+
+  skel->setSelfCollisionCheck(selfCollision);
+  skel->setAdjacentBodyCheck(adjacentBodyCheck);
+  return skel;
+}
+
+//==============================================================================
+/// Writes the blob header, followed by the payload written by writePayload.
+template <typename WritePayload>
+bool writeBlob(
+    BlobKind kind,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever,
+    std::string& blob,
+    WritePayload writePayload)
+{
+  std::string payload;
+  std::vector<std::string> meshUris;
+  BlobWriter payloadOut(payload);
+  if (!writePayload(payloadOut, meshUris))
+    return false;
+
+  blob.clear();
+  BlobWriter out(blob);
+  blob.append(MAGIC, sizeof(MAGIC));
+  out.writePod<std::uint32_t>(FORMAT_VERSION);
+  out.writePod<std::uint32_t>(kind);
+  out.writePod<std::uint64_t>(sourceHash);
+
+  // Every distinct mesh, with the hash of its current contents
+  std::sort(meshUris.begin(), meshUris.end());
+  meshUris.erase(std::unique(meshUris.begin(), meshUris.end()), meshUris.end());
+  out.writePod<std::uint32_t>(static_cast<std::uint32_t>(meshUris.size()));
+  const common::ResourceRetrieverPtr meshRetriever = getRetriever(retriever);
+  for (const std::string& uri : meshUris)
+  {
+    std::uint64_t hash;
+    if (!hashResource(uri, meshRetriever, hash))
+      return false;
+    out.writeString(uri);
+    out.writePod<std::uint64_t>(hash);
+  }
+
+  blob.append(payload);
+  return true;
+}
+
+//==============================================================================
+/// Validates the blob header and leaves in positioned at the payload.
+bool readHeader(
+    BlobReader& in,
+    BlobKind kind,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever)
+{
+  char magic[sizeof(MAGIC)];
+  for (std::size_t i = 0; i < sizeof(MAGIC); ++i)
+    magic[i] = in.readPod<char>();
+  if (in.failed() || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    return false;
+  if (in.readPod<std::uint32_t>() != FORMAT_VERSION)
+    return false;
+  if (in.readPod<std::uint32_t>() != kind)
+    return false;
+  if (in.readPod<std::uint64_t>() != sourceHash)
+    return false;
+
+  const std::uint32_t numMeshes = in.readPod<std::uint32_t>();
+  for (std::uint32_t i = 0; i < numMeshes && !in.failed(); ++i)
+  {
+    const std::string uri = in.readString();
+    const std::uint64_t expectedHash = in.readPod<std::uint64_t>();
+    std::uint64_t hash;
+    if (in.failed() || !hashResource(uri, retriever, hash)
+        || hash != expectedHash)
+      return false;
+  }
+  return !in.failed();
+}
+
+//==============================================================================
+/// Read-only view of a whole file, memory-mapped where the platform allows.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& path)
+  {
+#ifndef WINDOWS
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      void* mapped = ::mmap(
+          nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED)
+      {
+        mMapped = mapped;
+        mData = static_cast<const char*>(mapped);
+        mSize = static_cast<std::size_t>(info.st_size);
+      }
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      return;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    mBuffer = buffer.str();
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifndef WINDOWS
+    if (mMapped)
+      ::munmap(mMapped, mSize);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const
+  {
+    return mData;
+  }
+
+  std::size_t size() const
+  {
+    return mSize;
+  }
+
+private:
+  const char* mData = nullptr;
+  std::size_t mSize = 0;
+#ifndef WINDOWS
+  void* mMapped = nullptr;
+#else
+  std::string mBuffer;
+#endif
+};
+
+//==============================================================================
+/// Writes blob to path through a temporary file, so concurrent processes
+/// never see a partially written entry.
+void writeCacheFile(const std::string& path, const std::string& blob)
+{
+  std::stringstream tmpPath;
+  tmpPath << path << ".tmp" << std::hex << std::hash<std::string>()(blob)
+#ifndef WINDOWS
+          << "_" << ::getpid()
+#endif
+      ;
+  {
+    std::ofstream file(tmpPath.str(), std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      dtwarn << "[ModelCache] Unable to write the cache entry [" << path
+             << "].\n";
+      return;
+    }
+    file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+  }
+  if (std::rename(tmpPath.str().c_str(), path.c_str()) != 0)
+    std::remove(tmpPath.str().c_str());
+}
+
+//==============================================================================
+/// Tells the user that every process will parse uri again, because the model
+/// uses something the cache can't rebuild exactly.
+void warnNotCached(const common::Uri& uri)
+{
+  dtwarn << "[ModelCache] Not caching [" << uri.toString()
+         << "], because it uses features the cache can't rebuild exactly "
+         << "(e.g. soft bodies, mimic joints or unsupported shapes).\n";
+}
+
+//==============================================================================
+dynamics::SkeletonPtr parseSkeleton(
+    const common::Uri& uri, const common::ResourceRetrieverPtr& retriever)
+{
+  const std::string path = uri.getPath();
+  if (hasSuffix(path, ".skel"))
+    return SkelParser::readSkeleton(uri, retriever);
+  if (hasSuffix(path, ".urdf"))
+  {
+    DartLoader urdfLoader;
+    return urdfLoader.parseSkeleton(uri, retriever);
+  }
+  if (hasSuffix(path, ".sdf"))
+    return SdfParser::readSkeleton(uri, retriever);
+
+  dterr << "[ModelCache] Attempting to load a file [" << uri.toString()
+        << "] that does not have a supported extension. Currently, only "
+        << "\".skel\", \".urdf\" and \".sdf\" files are supported.\n";
+  return nullptr;
+}
+
+//==============================================================================
+simulation::WorldPtr parseWorld(
+    const common::Uri& uri, const common::ResourceRetrieverPtr& retriever)
+{
+  const std::string path = uri.getPath();
+  if (hasSuffix(path, ".skel"))
+    return SkelParser::readWorld(uri, retriever);
+  if (hasSuffix(path, ".urdf"))
+  {
+    DartLoader urdfLoader;
+    return urdfLoader.parseWorld(uri, retriever);
+  }
+  if (hasSuffix(path, ".sdf"))
+    return SdfParser::readWorld(uri, retriever);
+
+  dterr << "[ModelCache] Attempting to load a file [" << uri.toString()
+        << "] that does not have a supported extension. Currently, only "
+        << "\".skel\", \".urdf\" and \".sdf\" files are supported.\n";
+  return nullptr;
+}
+
+} // namespace
+
+//==============================================================================
+std::uint64_t hashBytes(const std::string& bytes, std::uint64_t seed)
+{
+  std::uint64_t hash = seed;
+  for (const char c : bytes)
+  {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//==============================================================================
+std::uint64_t hashSource(
+    const common::Uri& uri, const common::ResourceRetrieverPtr& retriever)
+{
+  std::uint64_t hash = hashBytes(uri.toString());
+  hash = hashBytes(std::to_string(FORMAT_VERSION), hash);
+  try
+  {
+    hash = hashBytes(getRetriever(retriever)->readAll(uri), hash);
+  }
+  catch (const std::exception&)
+  {
+    // An unreadable source still gets a stable key. Parsing it will fail
+    // anyway, and nothing is cached for it.
+  }
+  return hash;
+}
+
+//==============================================================================
+std::string getCachePath(
+    const std::string& cacheDirectory, std::uint64_t sourceHash)
+{
+  std::stringstream path;
+  path << cacheDirectory;
+  if (!cacheDirectory.empty() && cacheDirectory.back() != '/')
+    path << '/';
+  path << std::hex << std::setw(16) << std::setfill('0') << sourceHash
+       << ".nimblecache";
+  return path.str();
+}
+
+//==============================================================================
+bool serializeSkeleton(
+    const dynamics::SkeletonPtr& skel,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever,
+    std::string& blob)
+{
+  if (!skel)
+    return false;
+
+  return writeBlob(
+      SKELETON_BLOB,
+      sourceHash,
+      retriever,
+      blob,
+      [&](BlobWriter& out, std::vector<std::string>& meshUris) {
+        return writeSkeletonBody(out, skel, meshUris);
+      });
+}
+
+//==============================================================================
+bool serializeWorld(
+    const simulation::WorldPtr& world,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever,
+    std::string& blob)
+{
+  if (!world)
+    return false;
+
+  return writeBlob(
+      WORLD_BLOB,
+      sourceHash,
+      retriever,
+      blob,
+      [&](BlobWriter& out, std::vector<std::string>& meshUris) {
+        out.writeString(world->getName());
+        out.writeMatrix(world->getGravity());
+        out.writeScalar(world->getTimeStep());
+        const auto detector
+            = world->getConstraintSolver()->getCollisionDetector();
+        if (!detector)
+          return false;
+        out.writeString(detector->getType());
+        const std::size_t numSkeletons = world->getNumSkeletons();
+        out.writePod<std::uint32_t>(static_cast<std::uint32_t>(numSkeletons));
+        for (std::size_t i = 0; i < numSkeletons; ++i)
+        {
+          if (!writeSkeletonBody(out, world->getSkeleton(i), meshUris))
+            return false;
+        }
+        return true;
+      });
+}
+
+//==============================================================================
+dynamics::SkeletonPtr deserializeSkeleton(
+    const char* data,
+    std::size_t size,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever)
+{
+  const common::ResourceRetrieverPtr resolved = getRetriever(retriever);
+  BlobReader in(data, size);
+  if (!readHeader(in, SKELETON_BLOB, sourceHash, resolved))
+    return nullptr;
+  return readSkeletonBody(in, resolved);
+}
+
+//==============================================================================
+simulation::WorldPtr deserializeWorld(
+    const char* data,
+    std::size_t size,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever)
+{
+  const common::ResourceRetrieverPtr resolved = getRetriever(retriever);
+  BlobReader in(data, size);
+  if (!readHeader(in, WORLD_BLOB, sourceHash, resolved))
+    return nullptr;
+
+  simulation::WorldPtr world = simulation::World::create(in.readString());
+  world->setGravity(in.readVector3());
+  world->setTimeStep(in.readScalar());
+  const std::string detectorType = in.readString();
+  const auto detector
+      = collision::CollisionDetector::getFactory()->create(detectorType);
+  if (!detector)
+    return nullptr;
+  world->getConstraintSolver()->setCollisionDetector(detector);
+  const std::uint32_t numSkeletons = in.readPod<std::uint32_t>();
+  for (std::uint32_t i = 0; i < numSkeletons; ++i)
+  {
+    dynamics::SkeletonPtr skel = readSkeletonBody(in, resolved);
+    if (!skel)
+      return nullptr;
+    world->addSkeleton(skel);
+  }
+  if (in.failed())
+    return nullptr;
+  return world;
+}
+
+//==============================================================================
+dynamics::SkeletonPtr loadSkeleton(
+    const common::Uri& uri,
+    const std::string& cacheDirectory,
+    const common::ResourceRetrieverPtr& retriever)
+{
+  const std::uint64_t sourceHash = hashSource(uri, retriever);
+  const std::string cachePath = getCachePath(cacheDirectory, sourceHash);
+
+  {
+    MappedFile file(cachePath);
+    if (file.data())
+    {
+      dynamics::SkeletonPtr skel = deserializeSkeleton(
+          file.data(), file.size(), sourceHash, retriever);
+      if (skel)
+        return skel;
+    }
+  }
+
+  dynamics::SkeletonPtr skel = parseSkeleton(uri, retriever);
+  std::string blob;
+  if (skel && serializeSkeleton(skel, sourceHash, retriever, blob))
+    writeCacheFile(cachePath, blob);
+  else if (skel)
+    warnNotCached(uri);
+  return skel;
+}
+
+//==============================================================================
+simulation::WorldPtr loadWorld(
+    const common::Uri& uri,
+    const std::string& cacheDirectory,
+    const common::ResourceRetrieverPtr& retriever)
+{
+  const std::uint64_t sourceHash = hashSource(uri, retriever);
+  const std::string cachePath = getCachePath(cacheDirectory, sourceHash);
+
+  {
+    MappedFile file(cachePath);
+    if (file.data())
+    {
+      simulation::WorldPtr world = deserializeWorld(
+          file.data(), file.size(), sourceHash, retriever);
+      if (world)
+        return world;
+    }
+  }
+
+  simulation::WorldPtr world = parseWorld(uri, retriever);
+  std::string blob;
+  if (world && serializeWorld(world, sourceHash, retriever, blob))
+    writeCacheFile(cachePath, blob);
+  else if (world)
+    warnNotCached(uri);
+  return world;
+}
+
+} // namespace ModelCache
+} // namespace utils
+} // namespace dart
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_UTILS_MODELCACHE_HPP_
+#define DART_UTILS_MODELCACHE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "dart/common/ResourceRetriever.hpp"
+#include "dart/common/Uri.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/simulation/World.hpp"
+
+namespace dart {
+namespace utils {
+
+/// ModelCache stores fully built Skeletons and Worlds as compact binary blobs,
+/// so short-lived processes can skip XML parsing, URI resolution and the
+/// aspect-by-aspect construction done by SkelParser, DartLoader and SdfParser.
+///
+/// A blob records joints (type, axes, transforms, per-DOF limits and
+/// coefficients), inertias, shape nodes with their visual, collision and
+/// dynamics aspects, markers, the collision settings of each Skeleton and the
+/// collision detector type of a World. Soft bodies aren't cached. Meshes are
+/// referenced by URI and re-imported through the MeshAssetCache. Blobs are
+/// keyed by a hash of the source file, and also record a hash of every
+/// referenced mesh, so editing either invalidates the entry.
+namespace ModelCache {
+
+/// Version of the binary layout. Blobs of any other version are rejected.
+constexpr std::uint32_t FORMAT_VERSION = 2;
+
+/// Returns the 64-bit FNV-1a hash of bytes, continuing from seed.
+std::uint64_t hashBytes(
+    const std::string& bytes, std::uint64_t seed = 14695981039346656037ULL);
+
+/// Returns the hash that keys the cache entry of the model at uri. This
+/// covers the file contents, the URI itself and FORMAT_VERSION.
+std::uint64_t hashSource(
+    const common::Uri& uri, const common::ResourceRetrieverPtr& retriever);
+
+/// Returns the path of the cache entry for a source hash in cacheDirectory.
+std::string getCachePath(
+    const std::string& cacheDirectory, std::uint64_t sourceHash);
+
+/// Serializes skel into blob. Returns false if the Skeleton has soft bodies,
+/// or uses a joint or shape type that the cache can't reconstruct exactly.
+bool serializeSkeleton(
+    const dynamics::SkeletonPtr& skel,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever,
+    std::string& blob);
+
+/// Serializes every Skeleton of world, plus its gravity, time step and
+/// collision detector type.
+bool serializeWorld(
+    const simulation::WorldPtr& world,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever,
+    std::string& blob);
+
+/// Rebuilds a Skeleton from a blob. Returns nullptr if the blob is malformed,
+/// of another FORMAT_VERSION, keyed by another source hash, or if any
+/// referenced mesh changed since the blob was written.
+dynamics::SkeletonPtr deserializeSkeleton(
+    const char* data,
+    std::size_t size,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever);
+
+/// Rebuilds a World from a blob, see deserializeSkeleton().
+simulation::WorldPtr deserializeWorld(
+    const char* data,
+    std::size_t size,
+    std::uint64_t sourceHash,
+    const common::ResourceRetrieverPtr& retriever);
+
+/// Loads the Skeleton at uri (.skel, .urdf or .sdf) from cacheDirectory if
+/// there is a valid entry for it, otherwise parses the source and writes an
+/// entry for the next process. Models that can't be cached are parsed on
+/// every load, with a warning.
+dynamics::SkeletonPtr loadSkeleton(
+    const common::Uri& uri,
+    const std::string& cacheDirectory,
+    const common::ResourceRetrieverPtr& retriever = nullptr);
+
+/// Same as loadSkeleton(), for a whole World.
+simulation::WorldPtr loadWorld(
+    const common::Uri& uri,
+    const std::string& cacheDirectory,
+    const common::ResourceRetrieverPtr& retriever = nullptr);
+
+} // namespace ModelCache
+
+} // namespace utils
+} // namespace dart
+
+#endif // DART_UTILS_MODELCACHE_HPP_
@@ -0,0 +1,171 @@
+import NimbleView from "./NimbleView";
+
+/**
+ * These must match the scene file format written by dart::server::SceneRecorder.
+ */
+const SCENE_MAGIC = "NIMSCENE";
+const SCENE_FORMAT_VERSION = 1;
+const SCENE_HEADER_BYTES = 28;
+
+const SCRUBBER_KEY = "__recording_scrubber";
+const PLAY_BUTTON_KEY = "__recording_play";
+
+/**
+ * This plays back a scene file exported by dart::server::SceneRecorder,
+ * entirely locally. The shapes are created once from the JSON commands in the
+ * file, and then each frame just moves them, so scrubbing to any frame is a
+ * direct lookup into the packed frame data.
+ */
+class NimbleRecording {
+  view: NimbleView;
+  numObjects: number;
+  numFrames: number;
+  frameDuration: number;
+  frames: Float32Array;
+  // The key of the object recorded in each row of a frame
+  objectKeys: string[];
+  frame: number;
+  playing: boolean;
+  lastTickTime: number;
+
+  constructor(
+    view: NimbleView,
+    buffer: ArrayBuffer,
+    handleCommand: (command: any) => void
+  ) {
+    this.view = view;
+
+    const header = new DataView(buffer, 0, SCENE_HEADER_BYTES);
+    let magic = "";
+    for (let i = 0; i < 8; i++) {
+      magic += String.fromCharCode(header.getUint8(i));
+    }
+    if (magic !== SCENE_MAGIC) {
+      throw new Error("This file is not a Nimble scene file");
+    }
+    const version = header.getUint32(8, true);
+    if (version !== SCENE_FORMAT_VERSION) {
+      throw new Error(
+        "Unsupported Nimble scene file version " +
+          version +
+          ", expected " +
+          SCENE_FORMAT_VERSION
+      );
+    }
+    this.numObjects = header.getUint32(12, true);
+    this.numFrames = header.getUint32(16, true);
+    this.frameDuration = header.getFloat32(20, true);
+    const sceneJsonBytes = header.getUint32(24, true);
+
+    const sceneJson = new TextDecoder().decode(
+      new Uint8Array(buffer, SCENE_HEADER_BYTES, sceneJsonBytes)
+    );
+    const framesOffset =
+      SCENE_HEADER_BYTES + sceneJsonBytes + ((4 - (sceneJsonBytes % 4)) % 4);
+    this.frames = new Float32Array(
+      buffer,
+      framesOffset,
+      this.numFrames * this.numObjects * 6
+    );
+
+    this.objectKeys = [];
+    const commands: any[] = JSON.parse(sceneJson);
+    commands.forEach((command) => {
+      if (command.id != null) {
+        this.objectKeys[command.id] = command.key;
+      }
+      handleCommand(command);
+    });
+
+    this.frame = 0;
+    this.playing = false;
+    this.lastTickTime = 0;
+
+    this.view.createButton(PLAY_BUTTON_KEY, [10, 40], [80, 30], "Play", () =>
+      this.setPlaying(!this.playing)
+    );
+    this.view.createSlider(
+      SCRUBBER_KEY,
+      [100, 40],
+      [400, 30],
+      0,
+      Math.max(0, this.numFrames - 1),
+      0,
+      true,
+      true,
+      (value) => {
+        this.setPlaying(false);
+        this.setFrame(value);
+      }
+    );
+
+    this.setFrame(0);
+  }
+
+  /**
+   * This moves every recorded object to where it was on a given frame.
+   */
+  setFrame = (frame: number) => {
+    if (this.numFrames === 0) return;
+    this.frame = Math.max(0, Math.min(this.numFrames - 1, Math.floor(frame)));
+    const offset = this.frame * this.numObjects * 6;
+    for (let i = 0; i < this.numObjects; i++) {
+      const key = this.objectKeys[i];
+      if (key == null) continue;
+      const row = offset + i * 6;
+      this.view.setObjectPos(key, [
+        this.frames[row],
+        this.frames[row + 1],
+        this.frames[row + 2],
+      ]);
+      this.view.setObjectRotation(key, [
+        this.frames[row + 3],
+        this.frames[row + 4],
+        this.frames[row + 5],
+      ]);
+    }
+    this.view.setSliderValue(SCRUBBER_KEY, this.frame);
+    this.view.render();
+  };
+
+  /**
+   * This starts or pauses real-time playback from the current frame.
+   */
+  setPlaying = (playing: boolean) => {
+    if (playing === this.playing) return;
+    this.playing = playing;
+    this.view.setButtonLabel(PLAY_BUTTON_KEY, playing ? "Pause" : "Play");
+    if (playing) {
+      if (this.frame >= this.numFrames - 1) this.setFrame(0);
+      this.lastTickTime = performance.now();
+      window.requestAnimationFrame(this.tick);
+    }
+  };
+
+  /**
+   * This stops playback, and removes the playback controls from the GUI.
+   */
+  stop = () => {
+    this.setPlaying(false);
+    this.view.deleteUIElement(PLAY_BUTTON_KEY);
+    this.view.deleteUIElement(SCRUBBER_KEY);
+  };
+
+  tick = (time: number) => {
+    if (!this.playing) return;
+    const elapsedFrames = Math.floor(
+      (time - this.lastTickTime) / 1000 / Math.max(this.frameDuration, 1e-6)
+    );
+    if (elapsedFrames > 0) {
+      this.lastTickTime += elapsedFrames * this.frameDuration * 1000;
+      this.setFrame(this.frame + elapsedFrames);
+      if (this.frame >= this.numFrames - 1) {
+        this.setPlaying(false);
+        return;
+      }
+    }
+    window.requestAnimationFrame(this.tick);
+  };
+}
+
+export default NimbleRecording;
@@ -3,6 +3,7 @@ import NimbleView from "./NimbleView";
 type CreateBoxCommand = {
   type: "create_box";
   key: string;
+  id?: number;
   size: number[];
   pos: number[];
   euler: number[];
@@ -14,6 +15,7 @@ type CreateBoxCommand = {
 type CreateSphereCommand = {
   type: "create_sphere";
   key: string;
+  id?: number;
   radius: number;
   pos: number[];
   color: number[];
@@ -24,6 +26,7 @@ type CreateSphereCommand = {
 type CreateCapsuleCommand = {
   type: "create_capsule";
   key: string;
+  id?: number;
   radius: number;
   height: number;
   pos: number[];
@@ -43,6 +46,7 @@ type CreateLineCommand = {
 type CreateMeshCommand = {
   type: "create_mesh";
   key: string;
+  id?: number;
   vertices: number[][];
   vertex_normals: number[][];
   faces: number[][];
@@ -222,14 +226,23 @@ type Command =
   | SetSliderMax
   | SetPlotData;
 
+/**
+ * This must match GUIWebsocketServer::BINARY_TRANSFORM_FRAME on the server.
+ */
+const BINARY_TRANSFORM_FRAME = 1;
+
 class DARTRemote {
   url: string;
   view: NimbleView;
   socket: WebSocket | null;
+  // Maps the compact ids the server sends with binary transform frames back to
+  // object keys
+  objectKeys: Map<number, string>;
 
   constructor(url: string, view: NimbleView) {
     this.url = url;
     this.view = view;
+    this.objectKeys = new Map();
 
     this.trySocket();
 
@@ -269,6 +282,16 @@ class DARTRemote {
    * This reads and handles a command sent from the backend
    */
   handleCommand = (command: Command) => {
+    if (
+      (command.type === "create_box" ||
+        command.type === "create_sphere" ||
+        command.type === "create_capsule" ||
+        command.type === "create_mesh") &&
+      command.id != null
+    ) {
+      this.objectKeys.set(command.id, command.key);
+    }
+
     if (command.type === "create_box") {
       this.view.createBox(
         command.key,
@@ -392,6 +415,9 @@ class DARTRemote {
     } else if (command.type === "delete_ui_elem") {
       this.view.deleteUIElement(command.key);
     } else if (command.type === "delete_object") {
+      this.objectKeys.forEach((key, id) => {
+        if (key === command.key) this.objectKeys.delete(id);
+      });
       this.view.deleteObject(command.key);
     } else if (command.type === "set_text_contents") {
       this.view.setTextContents(command.key, command.contents);
@@ -416,11 +442,38 @@ class DARTRemote {
     }
   };
 
+  /**
+   * This applies a packed binary frame of object transforms. See
+   * GUIWebsocketServer::encodeTransformFrame() for the layout.
+   */
+  handleBinaryFrame = (buffer: ArrayBuffer) => {
+    const header = new Uint32Array(buffer, 0, 2);
+    if (header[0] !== BINARY_TRANSFORM_FRAME) {
+      console.error("Unknown binary frame type " + header[0]);
+      return;
+    }
+    const count = header[1];
+    const ids = new Uint32Array(buffer, 8, count);
+    const pos = new Float32Array(buffer, 8 + 4 * count, 3 * count);
+    const euler = new Float32Array(buffer, 8 + 16 * count, 3 * count);
+    for (let i = 0; i < count; i++) {
+      const key = this.objectKeys.get(ids[i]);
+      if (key == null) continue;
+      this.view.setObjectPos(key, [pos[3 * i], pos[3 * i + 1], pos[3 * i + 2]]);
+      this.view.setObjectRotation(key, [
+        euler[3 * i],
+        euler[3 * i + 1],
+        euler[3 * i + 2],
+      ]);
+    }
+  };
+
   /**
    * This attempts to connect a socket to the backend.
    */
   trySocket = () => {
     this.socket = new WebSocket(this.url);
+    this.socket.binaryType = "arraybuffer";
 
     // Connection opened
     this.socket.addEventListener("open", (event) => {
@@ -428,11 +481,17 @@ class DARTRemote {
       // Clear the view on a reconnect, the socket will broadcast us new data
       this.view.setConnected(true);
       this.view.clear();
+      this.objectKeys.clear();
     });
 
     // Listen for messages
     this.socket.addEventListener("message", (event) => {
       try {
+        if (event.data instanceof ArrayBuffer) {
+          this.handleBinaryFrame(event.data);
+          this.view.render();
+          return;
+        }
         const data: Command[] = JSON.parse(event.data);
         data.forEach(this.handleCommand);
         this.view.render();
@@ -1,5 +1,6 @@
 import NimbleView from "./NimbleView";
 import NimbleRemote from "./NimbleRemote";
+import NimbleRecording from "./NimbleRecording";
 
 const container = document.createElement("div");
 container.style.height = "100vh";
@@ -10,3 +11,30 @@ document.body.style.padding = "0px";
 document.body.appendChild(container);
 const view = new NimbleView(container);
 const remote = new NimbleRemote("ws://localhost:8070", view);
+
+// Scene files exported by dart::server::SceneRecorder can be dropped onto the
+// page to play them back locally, without a server
+let recording: NimbleRecording | null = null;
+document.body.addEventListener("dragover", (e: DragEvent) => {
+  e.preventDefault();
+});
+document.body.addEventListener("drop", (e: DragEvent) => {
+  e.preventDefault();
+  if (e.dataTransfer == null || e.dataTransfer.files.length === 0) return;
+  const reader = new FileReader();
+  reader.onload = () => {
+    if (recording != null) recording.stop();
+    view.clear();
+    try {
+      recording = new NimbleRecording(
+        view,
+        reader.result as ArrayBuffer,
+        remote.handleCommand
+      );
+    } catch (err) {
+      recording = null;
+      console.error("Failed to load scene file", err);
+    }
+  };
+  reader.readAsArrayBuffer(e.dataTransfer.files[0]);
+});
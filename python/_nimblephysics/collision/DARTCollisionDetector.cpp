@@ -31,6 +31,7 @@
  */
 
 #include <dart/collision/dart/DARTCollisionDetector.hpp>
+#include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
 
 namespace py = pybind11;
@@ -65,6 +66,26 @@ void DARTCollisionDetector(py::module& m)
               -> std::unique_ptr<dart::collision::CollisionGroup> {
             return self->createCollisionGroup();
           })
+      .def(
+          "raycastBatch",
+          +[](dart::collision::DARTCollisionDetector* self,
+              dart::collision::CollisionGroup* group,
+              const Eigen::MatrixXs& froms,
+              const Eigen::MatrixXs& tos,
+              int numThreads) -> Eigen::VectorXs {
+            // Python callers just get the fraction along each ray of its
+            // closest hit, with 1.0 for rays that didn't hit anything
+            std::vector<dart::collision::RayHit> hits;
+            self->raycastBatch(group, froms, tos, hits, numThreads);
+            Eigen::VectorXs fractions(hits.size());
+            for (std::size_t i = 0; i < hits.size(); i++)
+              fractions(i) = hits[i].mFraction;
+            return fractions;
+          },
+          ::py::arg("group"),
+          ::py::arg("froms"),
+          ::py::arg("tos"),
+          ::py::arg("numThreads") = 0)
       .def_static(
           "getStaticType",
           +[]() -> const std::string& {
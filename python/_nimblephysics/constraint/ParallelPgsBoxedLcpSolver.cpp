@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dart/constraint/ParallelPgsBoxedLcpSolver.hpp>
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace dart {
+namespace python {
+
+void ParallelPgsBoxedLcpSolver(py::module& m)
+{
+  ::py::class_<dart::constraint::ParallelPgsBoxedLcpSolver::Option>(
+      m, "ParallelPgsBoxedLcpSolverOption")
+      .def(::py::init<>())
+      .def(
+          ::py::init<int, s_t, int, s_t, int, int, bool, s_t>(),
+          ::py::arg("maxIteration") = 100,
+          ::py::arg("residualTolerance") = 1e-6,
+          ::py::arg("residualCheckInterval") = 4,
+          ::py::arg("epsilonForDivision") = 1e-9,
+          ::py::arg("numThreads") = 0,
+          ::py::arg("minRowsPerThread") = 64,
+          ::py::arg("useJacobi") = false,
+          ::py::arg("jacobiRelaxation") = 0.6)
+      .def_readwrite(
+          "mMaxIteration",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::mMaxIteration)
+      .def_readwrite(
+          "mResidualTolerance",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::
+              mResidualTolerance)
+      .def_readwrite(
+          "mResidualCheckInterval",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::
+              mResidualCheckInterval)
+      .def_readwrite(
+          "mEpsilonForDivision",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::
+              mEpsilonForDivision)
+      .def_readwrite(
+          "mNumThreads",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::mNumThreads)
+      .def_readwrite(
+          "mMinRowsPerThread",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::
+              mMinRowsPerThread)
+      .def_readwrite(
+          "mUseJacobi",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::mUseJacobi)
+      .def_readwrite(
+          "mJacobiRelaxation",
+          &dart::constraint::ParallelPgsBoxedLcpSolver::Option::
+              mJacobiRelaxation);
+
+  ::py::class_<
+      dart::constraint::ParallelPgsBoxedLcpSolver,
+      dart::constraint::BoxedLcpSolver,
+      std::shared_ptr<dart::constraint::ParallelPgsBoxedLcpSolver>>(
+      m, "ParallelPgsBoxedLcpSolver")
+      .def(::py::init<>())
+      .def(
+          "getType",
+          +[](const dart::constraint::ParallelPgsBoxedLcpSolver* self)
+              -> const std::string& { return self->getType(); },
+          ::py::return_value_policy::reference_internal)
+      .def(
+          "setOption",
+          +[](dart::constraint::ParallelPgsBoxedLcpSolver* self,
+              const dart::constraint::ParallelPgsBoxedLcpSolver::Option&
+                  option) { self->setOption(option); },
+          ::py::arg("option"))
+      .def(
+          "getOption",
+          +[](const dart::constraint::ParallelPgsBoxedLcpSolver* self)
+              -> dart::constraint::ParallelPgsBoxedLcpSolver::Option {
+            return self->getOption();
+          })
+      .def(
+          "getNumColors",
+          +[](const dart::constraint::ParallelPgsBoxedLcpSolver* self)
+              -> int { return self->getNumColors(); })
+      .def(
+          "getNumIterations",
+          +[](const dart::constraint::ParallelPgsBoxedLcpSolver* self)
+              -> int { return self->getNumIterations(); })
+      .def_static(
+          "getStaticType",
+          +[]() -> const std::string& {
+            return dart::constraint::ParallelPgsBoxedLcpSolver::getStaticType();
+          },
+          ::py::return_value_policy::reference_internal);
+}
+
+} // namespace python
+} // namespace dart
@@ -45,6 +45,7 @@ void JointCoulombFrictionConstraint(py::module& sm);
 void BoxedLcpSolver(py::module& sm);
 void DantzigBoxedLcpSolver(py::module& sm);
 void PgsBoxedLcpSolver(py::module& sm);
+void ParallelPgsBoxedLcpSolver(py::module& sm);
 
 void ConstraintSolver(py::module& sm);
 void BoxedLcpConstraintSolver(py::module& sm);
@@ -65,6 +66,7 @@ void dart_constraint(py::module& m)
   BoxedLcpSolver(sm);
   DantzigBoxedLcpSolver(sm);
   PgsBoxedLcpSolver(sm);
+  ParallelPgsBoxedLcpSolver(sm);
 
   ConstraintSolver(sm);
   BoxedLcpConstraintSolver(sm);
@@ -1116,6 +1116,27 @@ void Skeleton(py::module& m)
           +[](const dart::dynamics::Skeleton* self) -> const Eigen::MatrixXs& {
             return self->getInvMassMatrix();
           })
+      .def(
+          "getMassMatrixFactor",
+          +[](const dart::dynamics::Skeleton* self,
+              std::size_t treeIndex) -> const Eigen::MatrixXs& {
+            return self->getMassMatrixFactor(treeIndex);
+          })
+      .def(
+          "solveMassMatrix",
+          &dart::dynamics::Skeleton::solveMassMatrix,
+          ::py::arg("B"))
+      .def(
+          "solveMassMatrixTranspose",
+          &dart::dynamics::Skeleton::solveMassMatrixTranspose,
+          ::py::arg("B"))
+      .def(
+          "getInvMassMatrixBlock",
+          &dart::dynamics::Skeleton::getInvMassMatrixBlock,
+          ::py::arg("rowStart"),
+          ::py::arg("colStart"),
+          ::py::arg("rows"),
+          ::py::arg("cols"))
       .def(
           "getCoriolisForces",
           +[](dart::dynamics::Skeleton* self,
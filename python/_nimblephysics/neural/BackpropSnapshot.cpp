@@ -66,6 +66,19 @@ void BackpropSnapshot(py::module& m)
           ::py::arg("nextTimestepLoss"),
           ::py::arg("perfLog") = nullptr,
           ::py::arg("exploreAlternateStrategies") = false)
+      .def(
+          "precomputeJacobians",
+          &dart::neural::BackpropSnapshot::precomputeJacobians,
+          ::py::arg("world"),
+          ::py::arg("perfLog") = nullptr)
+      .def(
+          "hasPrecomputedJacobians",
+          &dart::neural::BackpropSnapshot::hasPrecomputedJacobians)
+      .def(
+          "backpropCached",
+          &dart::neural::BackpropSnapshot::backpropCached,
+          ::py::arg("thisTimestepLoss"),
+          ::py::arg("nextTimestepLoss"))
       .def(
           "backpropState",
           &dart::neural::BackpropSnapshot::backpropState,
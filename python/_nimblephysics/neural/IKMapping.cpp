@@ -63,7 +63,25 @@ void IKMapping(py::module& m)
           "addAngularBodyNode",
           &dart::neural::IKMapping::addAngularBodyNode,
           "This adds the angular (3D) coordinates of a body node to the "
-          "mapping, increasing the dimension of the mapped space by 3");
+          "mapping, increasing the dimension of the mapped space by 3")
+      .def(
+          "setIKWarmStart",
+          &dart::neural::IKMapping::setIKWarmStart,
+          ::py::arg("warmStart"),
+          "If true, each IK solve starts from the solution of the one before, "
+          "rather than from all zeros. This converges much faster on "
+          "consecutive frames of a motion, but makes solutions to "
+          "under-specified targets depend on the history of calls.")
+      .def("getIKWarmStart", &dart::neural::IKMapping::getIKWarmStart)
+      .def(
+          "solvePositions",
+          &dart::neural::IKMapping::solvePositions,
+          ::py::arg("world"),
+          ::py::arg("targets"),
+          ::py::arg("numWorkers") = -1,
+          "This runs an IK solve for each column of `targets` on a pool of "
+          "cloned worlds, and returns the real positions for each as the "
+          "columns of the result, without changing the state of `world`");
 }
 
 } // namespace python
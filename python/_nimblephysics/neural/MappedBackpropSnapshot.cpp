@@ -53,6 +53,11 @@ void MappedBackpropSnapshot(py::module& m)
           ::py::arg("nextTimestepLosses"),
           ::py::arg("perfLog") = nullptr,
           ::py::arg("exploreAlternateStrategies") = false)
+      .def(
+          "precomputeJacobians",
+          &dart::neural::MappedBackpropSnapshot::precomputeJacobians,
+          ::py::arg("world"),
+          ::py::arg("perfLog") = nullptr)
       .def("getMappings", &dart::neural::MappedBackpropSnapshot::getMappings)
       .def(
           "getVelVelJacobian",
@@ -95,13 +95,15 @@ void NeuralUtils(py::module& m)
       "forwardPass",
       &dart::neural::forwardPass,
       ::py::arg("world"),
-      ::py::arg("idempotent") = false);
+      ::py::arg("idempotent") = false,
+      ::py::arg("precomputeJacobians") = false);
   m.def(
       "mappedForwardPass",
       &dart::neural::mappedForwardPass,
       ::py::arg("world"),
       ::py::arg("mappings"),
-      ::py::arg("idempotent") = false);
+      ::py::arg("idempotent") = false,
+      ::py::arg("precomputeJacobians") = false);
   m.def(
       "convertJointSpaceToWorldSpace",
       &dart::neural::convertJointSpaceToWorldSpace,
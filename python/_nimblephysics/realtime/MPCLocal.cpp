@@ -124,6 +124,14 @@ void MPCLocal(py::module& m)
           "A blocking call - this starts a gRPC server that clients can "
           "connect to to get MPC computations done remotely",
           ::py::call_guard<py::gil_scoped_release>())
+      .def(
+          "serveSharedMemory",
+          &dart::realtime::MPCLocal::serveSharedMemory,
+          ::py::arg("name"),
+          "A blocking call - this serves MPC computations to an "
+          "MPCSharedMemoryRemote on the same machine, through the named "
+          "shared memory segment, until the remote disconnects",
+          ::py::call_guard<py::gil_scoped_release>())
       .def("getCurrentSolution", &dart::realtime::MPCLocal::getCurrentSolution)
       .def(
           "registerReplaningListener",
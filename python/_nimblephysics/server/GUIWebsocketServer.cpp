@@ -148,6 +148,19 @@ void GUIWebsocketServer(py::module& m)
           &dart::server::GUIWebsocketServer::setAutoflush,
           ::py::arg("autoflush"))
       .def("flush", &dart::server::GUIWebsocketServer::flush)
+      .def("getSceneJson", &dart::server::GUIWebsocketServer::getSceneJson)
+      .def(
+          "setUseBinaryTransforms",
+          &dart::server::GUIWebsocketServer::setUseBinaryTransforms,
+          ::py::arg("useBinary"))
+      .def(
+          "setTransformUpdateThreshold",
+          &dart::server::GUIWebsocketServer::setTransformUpdateThreshold,
+          ::py::arg("threshold"))
+      .def(
+          "setMaxTransformUpdatesPerSecond",
+          &dart::server::GUIWebsocketServer::setMaxTransformUpdatesPerSecond,
+          ::py::arg("updatesPerSecond"))
       .def(
           "deleteObject",
           &dart::server::GUIWebsocketServer::deleteObject,
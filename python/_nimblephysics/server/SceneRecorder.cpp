@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <dart/server/SceneRecorder.hpp>
+#include <dart/simulation/World.hpp>
+#include <dart/trajectory/TrajectoryRollout.hpp>
+#include <pybind11/eigen.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+namespace dart {
+namespace python {
+
+void SceneRecorder(py::module& m)
+{
+  ::py::class_<
+      dart::server::SceneRecorder,
+      std::shared_ptr<dart::server::SceneRecorder>>(m, "SceneRecorder")
+      .def(::py::init<s_t>(), ::py::arg("frameDuration") = 0.01)
+      .def(
+          "recordFrame",
+          &dart::server::SceneRecorder::recordFrame,
+          ::py::arg("world"))
+      .def(
+          "recordTrajectory",
+          &dart::server::SceneRecorder::recordTrajectory,
+          ::py::arg("world"),
+          ::py::arg("rollout"))
+      .def("getNumFrames", &dart::server::SceneRecorder::getNumFrames)
+      .def("getNumObjects", &dart::server::SceneRecorder::getNumObjects)
+      .def("getSceneJson", &dart::server::SceneRecorder::getSceneJson)
+      .def(
+          "writeToFile",
+          &dart::server::SceneRecorder::writeToFile,
+          ::py::arg("path"))
+      .def_static(
+          "exportTrajectory",
+          &dart::server::SceneRecorder::exportTrajectory,
+          ::py::arg("path"),
+          ::py::arg("world"),
+          ::py::arg("rollout"));
+
+  ::py::class_<
+      dart::server::SceneRecording,
+      std::shared_ptr<dart::server::SceneRecording>>(m, "SceneRecording")
+      .def_static(
+          "open", &dart::server::SceneRecording::open, ::py::arg("path"))
+      .def("getNumFrames", &dart::server::SceneRecording::getNumFrames)
+      .def("getNumObjects", &dart::server::SceneRecording::getNumObjects)
+      .def(
+          "getFrameDuration", &dart::server::SceneRecording::getFrameDuration)
+      .def("getSceneJson", &dart::server::SceneRecording::getSceneJson)
+      .def(
+          "readFrame",
+          &dart::server::SceneRecording::readFrame,
+          ::py::arg("frame"));
+}
+
+} // namespace python
+} // namespace dart
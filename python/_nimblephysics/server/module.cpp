@@ -40,6 +40,7 @@ namespace dart {
 namespace python {
 
 void GUIWebsocketServer(py::module& sm);
+void SceneRecorder(py::module& sm);
 
 void dart_server(py::module& m)
 {
@@ -48,6 +49,7 @@ void dart_server(py::module& m)
   sm.doc() = "This provides a native WebSocket server infrastructure.";
 
   GUIWebsocketServer(sm);
+  SceneRecorder(sm);
 }
 
 } // namespace python
@@ -414,6 +414,10 @@ void World(py::module& m)
           +[](dart::simulation::World* self) -> Eigen::MatrixXs {
             return self->getInvMassMatrix();
           })
+      .def(
+          "solveMassMatrix",
+          &dart::simulation::World::solveMassMatrix,
+          ::py::arg("B"))
       .def(
           "getParallelVelocityAndPositionUpdates",
           &dart::simulation::World::getParallelVelocityAndPositionUpdates)
@@ -421,6 +425,13 @@ void World(py::module& m)
           "setParallelVelocityAndPositionUpdates",
           &dart::simulation::World::setParallelVelocityAndPositionUpdates,
           ::py::arg("enabled"))
+      .def(
+          "getUseFastFeatherstone",
+          &dart::simulation::World::getUseFastFeatherstone)
+      .def(
+          "setUseFastFeatherstone",
+          &dart::simulation::World::setUseFastFeatherstone,
+          ::py::arg("enabled"))
       .def(
           "getPenetrationCorrectionEnabled",
           &dart::simulation::World::getPenetrationCorrectionEnabled)
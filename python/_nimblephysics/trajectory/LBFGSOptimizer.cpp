@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Python.h>
+#include <dart/trajectory/LBFGSOptimizer.hpp>
+#include <dart/trajectory/Problem.hpp>
+#include <pybind11/eigen.h>
+#include <pybind11/functional.h>
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace dart {
+namespace python {
+
+void LBFGSOptimizer(py::module& m)
+{
+  ::py::class_<
+      dart::trajectory::LBFGSOptimizer,
+      std::shared_ptr<dart::trajectory::LBFGSOptimizer>,
+      dart::trajectory::Optimizer>(m, "LBFGSOptimizer")
+      .def(::py::init<>())
+      .def(
+          "optimize",
+          &dart::trajectory::LBFGSOptimizer::optimize,
+          ::py::arg("shot"),
+          ::py::arg("reuseRecord") = nullptr,
+          ::py::call_guard<py::gil_scoped_release>())
+      .def(
+          "setIterationLimit",
+          &dart::trajectory::LBFGSOptimizer::setIterationLimit,
+          ::py::arg("iterationLimit") = 100)
+      .def(
+          "setTolerance",
+          &dart::trajectory::LBFGSOptimizer::setTolerance,
+          ::py::arg("tol") = 1e-6)
+      .def(
+          "setLBFGSHistoryLength",
+          &dart::trajectory::LBFGSOptimizer::setLBFGSHistoryLength,
+          ::py::arg("historyLen") = 10)
+      .def(
+          "setLineSearchCandidates",
+          &dart::trajectory::LBFGSOptimizer::setLineSearchCandidates,
+          ::py::arg("numCandidates") = 4)
+      .def(
+          "setPrintFrequency",
+          &dart::trajectory::LBFGSOptimizer::setPrintFrequency,
+          ::py::arg("frequency") = 0)
+      .def(
+          "setRecordIterations",
+          &dart::trajectory::LBFGSOptimizer::setRecordIterations,
+          ::py::arg("recordIterations") = true);
+}
+
+} // namespace python
+} // namespace dart
@@ -42,11 +42,41 @@ namespace python {
 
 void Solution(py::module& m)
 {
+  ::py::enum_<dart::trajectory::IterationRetention>(m, "IterationRetention")
+      .value("ALL", dart::trajectory::IterationRetention::ALL)
+      .value("BEST_N", dart::trajectory::IterationRetention::BEST_N)
+      .value("EVERY_KTH", dart::trajectory::IterationRetention::EVERY_KTH)
+      .value("RING_BUFFER", dart::trajectory::IterationRetention::RING_BUFFER)
+      .export_values();
+
   ::py::class_<
       dart::trajectory::Solution,
       std::shared_ptr<dart::trajectory::Solution>>(m, "Solution")
+      .def(::py::init<>())
       .def("toJson", &dart::trajectory::Solution::toJson, ::py::arg("world"))
       .def("getNumSteps", &dart::trajectory::Solution::getNumSteps)
+      .def(
+          "getNumRegisteredSteps",
+          &dart::trajectory::Solution::getNumRegisteredSteps)
+      .def(
+          "setIterationRetention",
+          &dart::trajectory::Solution::setIterationRetention,
+          ::py::arg("retention"),
+          ::py::arg("n") = 0)
+      .def(
+          "getIterationRetention",
+          &dart::trajectory::Solution::getIterationRetention)
+      .def(
+          "setIterationStream",
+          &dart::trajectory::Solution::setIterationStream,
+          ::py::arg("path"))
+      .def(
+          "closeIterationStream",
+          &dart::trajectory::Solution::closeIterationStream)
+      .def_static(
+          "loadIterationStream",
+          &dart::trajectory::Solution::loadIterationStream,
+          ::py::arg("path"))
       .def(
           "getStep",
           &dart::trajectory::Solution::getStep,
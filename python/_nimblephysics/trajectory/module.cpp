@@ -42,6 +42,8 @@ namespace python {
 void Optimizer(py::module& sm);
 void IPOptOptimizer(py::module& sm);
 void SGDOptimizer(py::module& sm);
+void AdamOptimizer(py::module& sm);
+void LBFGSOptimizer(py::module& sm);
 void LossFn(py::module& sm);
 void Problem(py::module& sm);
 void MultiShot(py::module& sm);
@@ -60,6 +62,8 @@ void dart_trajectory(py::module& m)
   Optimizer(sm);
   IPOptOptimizer(sm);
   SGDOptimizer(sm);
+  AdamOptimizer(sm);
+  LBFGSOptimizer(sm);
   LossFn(sm);
   Problem(sm);
   MultiShot(sm);
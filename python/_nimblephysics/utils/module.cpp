@@ -38,6 +38,7 @@ namespace dart {
 namespace python {
 
 void DartLoader(py::module& sm);
+void ModelCache(py::module& sm);
 void SkelParser(py::module& sm);
 void UniversalLoader(py::module& sm);
 
@@ -46,6 +47,7 @@ void dart_utils(py::module& m)
   auto sm = m.def_submodule("utils");
 
   DartLoader(sm);
+  ModelCache(sm);
   SkelParser(sm);
   UniversalLoader(sm);
 }
@@ -0,0 +1,105 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "dart/external/odelcpsolver/lcp.h"
+
+// A random contact-shaped boxed LCP: state.range(0) contacts, each with one
+// normal row (x >= 0) and two friction rows bounded by mu times the normal.
+struct RandomContactLcp
+{
+  explicit RandomContactLcp(int numContacts)
+  {
+    n = 3 * numContacts;
+    nskip = dPAD(n);
+    A.assign(n * nskip, 0.0);
+    b.resize(n);
+    lo.resize(n);
+    hi.resize(n);
+    findex.resize(n);
+
+    std::mt19937 rng(42);
+    std::normal_distribution<dReal> gaussian;
+    std::vector<dReal> J(n * n);
+    for (dReal& v : J)
+      v = gaussian(rng);
+    // A = J * J^T + eps * I, with half-rank J so the problem is degenerate
+    // like a real contact Delassus matrix
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+      {
+        dReal sum = 0.0;
+        for (int k = 0; k < n / 2; k++)
+          sum += J[i * n + k] * J[j * n + k];
+        A[i * nskip + j] = sum + (i == j ? 1e-3 : 0.0);
+      }
+    for (int c = 0; c < numContacts; c++)
+    {
+      lo[3 * c] = 0.0;
+      hi[3 * c] = dInfinity;
+      findex[3 * c] = -1;
+      for (int k = 1; k < 3; k++)
+      {
+        lo[3 * c + k] = -0.5;
+        hi[3 * c + k] = 0.5;
+        findex[3 * c + k] = 3 * c;
+      }
+    }
+    for (dReal& v : b)
+      v = gaussian(rng);
+  }
+
+  // dSolveLCP() overwrites its inputs, so every solve works on a copy
+  void solve(dLCPWorkspace* workspace)
+  {
+    A2 = A;
+    b2 = b;
+    lo2 = lo;
+    hi2 = hi;
+    x.assign(n, 0.0);
+    dSolveLCP(
+        n,
+        A2.data(),
+        x.data(),
+        b2.data(),
+        nullptr,
+        0,
+        lo2.data(),
+        hi2.data(),
+        findex.data(),
+        false,
+        workspace);
+  }
+
+  int n;
+  int nskip;
+  std::vector<dReal> A, b, lo, hi;
+  std::vector<dReal> A2, b2, lo2, hi2, x;
+  std::vector<int> findex;
+};
+
+static void BM_DantzigLcp_FreshBuffers(benchmark::State& state)
+{
+  RandomContactLcp lcp(state.range(0));
+  for (auto _ : state)
+  {
+    lcp.solve(nullptr);
+    benchmark::DoNotOptimize(lcp.x.data());
+  }
+}
+BENCHMARK(BM_DantzigLcp_FreshBuffers)->Arg(20)->Arg(30)->Arg(40);
+
+static void BM_DantzigLcp_ReusedWorkspace(benchmark::State& state)
+{
+  RandomContactLcp lcp(state.range(0));
+  dLCPWorkspace workspace;
+  for (auto _ : state)
+  {
+    lcp.solve(&workspace);
+    benchmark::DoNotOptimize(lcp.x.data());
+  }
+}
+BENCHMARK(BM_DantzigLcp_ReusedWorkspace)->Arg(20)->Arg(30)->Arg(40);
+
+BENCHMARK_MAIN();
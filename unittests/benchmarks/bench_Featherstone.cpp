@@ -7,8 +7,11 @@
 
 #include "dart/collision/CollisionObject.hpp"
 #include "dart/collision/Contact.hpp"
+#include "dart/dynamics/BallJoint.hpp"
 #include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
 #include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/SimpleFeatherstone.hpp"
 #include "dart/dynamics/Skeleton.hpp"
 #include "dart/math/Geometry.hpp"
 #include "dart/neural/BackpropSnapshot.hpp"
@@ -142,4 +145,60 @@ static void BM_20_Joint_Simple_Featherstone(benchmark::State& state)
 }
 BENCHMARK(BM_20_Joint_Simple_Featherstone);
 
+/// A floating base with four 3-link limbs on ball and revolute joints
+static SkeletonPtr createFloatingBaseRobot()
+{
+  SkeletonPtr skel = Skeleton::create("floating");
+  BodyNode* base
+      = skel->createJointAndBodyNodePair<FreeJoint>(nullptr).second;
+  for (int limb = 0; limb < 4; limb++)
+  {
+    BodyNode* parent
+        = skel->createJointAndBodyNodePair<BallJoint>(base).second;
+    for (int link = 0; link < 2; link++)
+    {
+      auto pair = skel->createJointAndBodyNodePair<RevoluteJoint>(parent);
+      Eigen::Isometry3s offset = Eigen::Isometry3s::Identity();
+      offset.translation() = Eigen::Vector3s::UnitZ() * 0.3;
+      pair.first->setTransformFromParentBodyNode(offset);
+      parent = pair.second;
+    }
+  }
+  skel->setPositions(Eigen::VectorXs::Random(skel->getNumDofs()));
+  skel->setVelocities(Eigen::VectorXs::Random(skel->getNumDofs()));
+  return skel;
+}
+
+static void BM_Floating_Base_DART_Featherstone(benchmark::State& state)
+{
+  SkeletonPtr skel = createFloatingBaseRobot();
+  for (auto _ : state)
+  {
+    // Dirty the kinematics, like a step would
+    skel->setPositions(skel->getPositions());
+    skel->computeForwardDynamics();
+    benchmark::DoNotOptimize(skel->getAccelerations());
+  }
+}
+BENCHMARK(BM_Floating_Base_DART_Featherstone);
+
+static void BM_Floating_Base_Simple_Featherstone(benchmark::State& state)
+{
+  SkeletonPtr skel = createFloatingBaseRobot();
+  SimpleFeatherstone simple;
+  Eigen::VectorXs accel = Eigen::VectorXs::Zero(skel->getNumDofs());
+  for (auto _ : state)
+  {
+    // World::step() syncs with the Skeleton on every step, so we time that
+    // too. Only the per-step state is copied once the topology is cached.
+    simple.syncFromSkeleton(skel);
+    Eigen::VectorXs pos = skel->getPositions();
+    Eigen::VectorXs vel = skel->getVelocities();
+    Eigen::VectorXs force = skel->getCommands();
+    simple.forwardDynamics(pos.data(), vel.data(), force.data(), accel.data());
+    benchmark::DoNotOptimize(accel);
+  }
+}
+BENCHMARK(BM_Floating_Base_Simple_Featherstone);
+
 BENCHMARK_MAIN();
\ No newline at end of file
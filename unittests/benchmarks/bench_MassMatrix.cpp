@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+
+#include "dart/dynamics/BallJoint.hpp"
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
+#include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/dynamics/UniversalJoint.hpp"
+
+using namespace dart;
+using namespace dynamics;
+
+template <typename JointType>
+static BodyNode* addBody(SkeletonPtr skel, BodyNode* parent)
+{
+  auto pair = skel->createJointAndBodyNodePair<JointType>(parent);
+  Eigen::Isometry3s offset = Eigen::Isometry3s::Identity();
+  offset.translation() = Eigen::Vector3s::Random();
+  pair.first->setTransformFromParentBodyNode(offset);
+  pair.second->setInertia(
+      dynamics::Inertia(1.0, Eigen::Vector3s::Random() * 0.1));
+  return pair.second;
+}
+
+/// A floating base humanoid with 37 DOFs
+static SkeletonPtr createHumanoid()
+{
+  SkeletonPtr skel = Skeleton::create("humanoid");
+  BodyNode* pelvis = addBody<FreeJoint>(skel, nullptr);
+  BodyNode* torso = addBody<BallJoint>(skel, pelvis);
+  addBody<UniversalJoint>(skel, torso);
+  for (int side = 0; side < 2; side++)
+  {
+    BodyNode* shoulder = addBody<BallJoint>(skel, torso);
+    BodyNode* elbow = addBody<RevoluteJoint>(skel, shoulder);
+    addBody<UniversalJoint>(skel, elbow);
+
+    BodyNode* hip = addBody<BallJoint>(skel, pelvis);
+    BodyNode* knee = addBody<RevoluteJoint>(skel, hip);
+    BodyNode* ankle = addBody<UniversalJoint>(skel, knee);
+    addBody<RevoluteJoint>(skel, ankle);
+  }
+  return skel;
+}
+
+static void BM_MassMatrix_CRBA(benchmark::State& state)
+{
+  SkeletonPtr skel = createHumanoid();
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(skel->getNumDofs());
+  for (auto _ : state)
+  {
+    // Setting a new position dirties the cached mass matrix
+    pos(0) += 1e-3;
+    skel->setPositions(pos);
+    benchmark::DoNotOptimize(skel->getMassMatrix());
+  }
+}
+BENCHMARK(BM_MassMatrix_CRBA);
+
+static void BM_MassMatrix_UnitAccelerations(benchmark::State& state)
+{
+  SkeletonPtr skel = createHumanoid();
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(skel->getNumDofs());
+  for (auto _ : state)
+  {
+    pos(0) += 1e-3;
+    skel->setPositions(pos);
+    benchmark::DoNotOptimize(skel->getMassMatrixByUnitAccelerations());
+  }
+}
+BENCHMARK(BM_MassMatrix_UnitAccelerations);
+
+static void BM_InvMassMatrix_Times_Matrix(benchmark::State& state)
+{
+  SkeletonPtr skel = createHumanoid();
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(skel->getNumDofs());
+  Eigen::MatrixXs B = Eigen::MatrixXs::Random(skel->getNumDofs(), 12);
+  for (auto _ : state)
+  {
+    pos(0) += 1e-3;
+    skel->setPositions(pos);
+    benchmark::DoNotOptimize(Eigen::MatrixXs(skel->getInvMassMatrix() * B));
+  }
+}
+BENCHMARK(BM_InvMassMatrix_Times_Matrix);
+
+static void BM_SolveMassMatrix(benchmark::State& state)
+{
+  SkeletonPtr skel = createHumanoid();
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(skel->getNumDofs());
+  Eigen::MatrixXs B = Eigen::MatrixXs::Random(skel->getNumDofs(), 12);
+  for (auto _ : state)
+  {
+    pos(0) += 1e-3;
+    skel->setPositions(pos);
+    benchmark::DoNotOptimize(skel->solveMassMatrix(B));
+  }
+}
+BENCHMARK(BM_SolveMassMatrix);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+#include <string>
+#include <unordered_map>
+
+#include <benchmark/benchmark.h>
+
+#include "dart/proto/SerializeEigen.hpp"
+#include "dart/trajectory/TrajectoryRollout.hpp"
+
+using namespace dart;
+
+// A rollout shaped like the ones MPCRemote streams and we archive:
+// state.range(0) DOFs over state.range(1) timesteps, with the encoding in
+// state.range(2).
+static trajectory::TrajectoryRolloutReal createRollout(int dofs, int steps)
+{
+  std::unordered_map<std::string, Eigen::MatrixXs> pos;
+  std::unordered_map<std::string, Eigen::MatrixXs> vel;
+  std::unordered_map<std::string, Eigen::MatrixXs> force;
+  std::unordered_map<std::string, Eigen::MatrixXs> metadata;
+  pos["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+  vel["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+  force["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+  return trajectory::TrajectoryRolloutReal(
+      pos, vel, force, Eigen::VectorXs::Random(dofs), metadata);
+}
+
+static void BM_SerializeRollout_Encode(benchmark::State& state)
+{
+  auto rollout = createRollout(state.range(0), state.range(1));
+  auto encoding = static_cast<proto::EigenEncoding>(state.range(2));
+  std::string bytes;
+  for (auto _ : state)
+  {
+    proto::TrajectoryRollout proto;
+    rollout.serialize(proto, encoding);
+    proto.SerializeToString(&bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+  state.counters["message_bytes"] = bytes.size();
+}
+
+static void BM_SerializeRollout_Decode(benchmark::State& state)
+{
+  auto rollout = createRollout(state.range(0), state.range(1));
+  auto encoding = static_cast<proto::EigenEncoding>(state.range(2));
+  proto::TrajectoryRollout original;
+  rollout.serialize(original, encoding);
+  std::string bytes;
+  original.SerializeToString(&bytes);
+  for (auto _ : state)
+  {
+    proto::TrajectoryRollout proto;
+    proto.ParseFromString(bytes);
+    trajectory::TrajectoryRolloutReal recovered
+        = trajectory::TrajectoryRollout::deserialize(proto);
+    benchmark::DoNotOptimize(recovered.getPosesConst().data());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+  state.counters["message_bytes"] = bytes.size();
+}
+
+static void RolloutSizes(benchmark::internal::Benchmark* b)
+{
+  for (int encoding :
+       {proto::REPEATED_DOUBLE, proto::PACKED_FLOAT64, proto::PACKED_FLOAT32})
+  {
+    b->Args({7, 100, encoding});
+    b->Args({30, 500, encoding});
+    b->Args({60, 2000, encoding});
+  }
+}
+
+BENCHMARK(BM_SerializeRollout_Encode)->Apply(RolloutSizes);
+BENCHMARK(BM_SerializeRollout_Decode)->Apply(RolloutSizes);
+
+BENCHMARK_MAIN();
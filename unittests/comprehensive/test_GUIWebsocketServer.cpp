@@ -30,7 +30,9 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -44,6 +46,10 @@
 #include "dart/realtime/Ticker.hpp"
 #include "dart/server/GUIWebsocketServer.hpp"
 
+// These have to come after the server headers, which define ASIO_STANDALONE
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+
 #include "TestHelpers.hpp"
 #include "stdio.h"
 
@@ -57,6 +63,145 @@ using namespace neural;
 using namespace server;
 using namespace realtime;
 
+namespace {
+
+/// This exposes the binary transform bookkeeping, and lets tests stand in a
+/// fake client connection for a real one
+class TransformTestServer : public GUIWebsocketServer
+{
+public:
+  using GUIWebsocketServer::encodeTransformFrame;
+
+  void addFakeClient(ClientConnection conn)
+  {
+    mClientTransforms[conn] = ClientTransformState();
+  }
+
+  std::unordered_set<uint32_t> getPendingIds(ClientConnection conn)
+  {
+    return mClientTransforms[conn].dirty;
+  }
+
+  uint32_t getObjectId(const std::string& key)
+  {
+    return mTransforms[key].id;
+  }
+};
+
+/// This reads back a frame in the layout documented on encodeTransformFrame()
+void decodeTransformFrame(
+    const std::string& frame,
+    std::vector<uint32_t>& ids,
+    std::vector<Eigen::Vector3f>& poses,
+    std::vector<Eigen::Vector3f>& eulers)
+{
+  uint32_t tag;
+  uint32_t count;
+  std::memcpy(&tag, frame.data(), sizeof(uint32_t));
+  std::memcpy(&count, frame.data() + sizeof(uint32_t), sizeof(uint32_t));
+  EXPECT_EQ(GUIWebsocketServer::BINARY_TRANSFORM_FRAME, tag);
+  EXPECT_EQ(sizeof(uint32_t) * (2 + 7 * count), frame.size());
+
+  const char* idIn = frame.data() + 2 * sizeof(uint32_t);
+  const char* posIn = idIn + count * sizeof(uint32_t);
+  const char* eulerIn = posIn + 3 * count * sizeof(float);
+  ids.resize(count);
+  poses.resize(count);
+  eulers.resize(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::memcpy(&ids[i], idIn + i * sizeof(uint32_t), sizeof(uint32_t));
+    std::memcpy(
+        poses[i].data(), posIn + 3 * i * sizeof(float), 3 * sizeof(float));
+    std::memcpy(
+        eulers[i].data(), eulerIn + 3 * i * sizeof(float), 3 * sizeof(float));
+  }
+}
+
+} // namespace
+
+TEST(GUI_SERVER, TRANSFORM_FRAME_ROUND_TRIP)
+{
+  TransformTestServer server;
+  server.createBox(
+      "box",
+      Eigen::Vector3s::Ones(),
+      Eigen::Vector3s(1.5, -2.25, 3.0),
+      Eigen::Vector3s(0.1, 0.2, 0.3));
+  server.createSphere("ball", 0.5, Eigen::Vector3s(-4.0, 0.125, 7.5));
+  server.setObjectRotation("box", Eigen::Vector3s(-0.7, 0.0, 1.25));
+
+  std::unordered_set<uint32_t> ids;
+  ids.insert(server.getObjectId("box"));
+  ids.insert(server.getObjectId("ball"));
+  std::string frame = server.encodeTransformFrame(ids);
+
+  std::vector<uint32_t> decodedIds;
+  std::vector<Eigen::Vector3f> poses;
+  std::vector<Eigen::Vector3f> eulers;
+  decodeTransformFrame(frame, decodedIds, poses, eulers);
+  ASSERT_EQ(2, decodedIds.size());
+  for (int i = 0; i < 2; i++)
+  {
+    if (decodedIds[i] == server.getObjectId("box"))
+    {
+      EXPECT_TRUE(poses[i].isApprox(Eigen::Vector3f(1.5, -2.25, 3.0)));
+      EXPECT_TRUE(eulers[i].isApprox(Eigen::Vector3f(-0.7, 0.0, 1.25)));
+    }
+    else
+    {
+      EXPECT_EQ(server.getObjectId("ball"), decodedIds[i]);
+      EXPECT_TRUE(poses[i].isApprox(Eigen::Vector3f(-4.0, 0.125, 7.5)));
+      EXPECT_TRUE(eulers[i].isZero());
+    }
+  }
+
+  // An empty frame is just the header
+  std::string empty = server.encodeTransformFrame({});
+  decodeTransformFrame(empty, decodedIds, poses, eulers);
+  EXPECT_EQ(0, decodedIds.size());
+}
+
+TEST(GUI_SERVER, TRANSFORM_UPDATE_THRESHOLD)
+{
+  TransformTestServer server;
+  std::shared_ptr<int> client = std::make_shared<int>(0);
+  server.addFakeClient(client);
+  server.setTransformUpdateThreshold(0.01);
+  server.createBox(
+      "box",
+      Eigen::Vector3s::Ones(),
+      Eigen::Vector3s::Zero(),
+      Eigen::Vector3s::Zero());
+  uint32_t id = server.getObjectId("box");
+
+  // Creating an object doesn't leave an update pending
+  EXPECT_TRUE(server.getPendingIds(client).empty());
+
+  // Moves within the threshold get dropped
+  server.setObjectPosition("box", Eigen::Vector3s(0.006, 0, 0));
+  server.setObjectRotation("box", Eigen::Vector3s(0, 0, -0.009));
+  EXPECT_TRUE(server.getPendingIds(client).empty());
+
+  // Small moves are measured from the last transform that was sent, so they
+  // add up until they cross the threshold
+  server.setObjectPosition("box", Eigen::Vector3s(0.012, 0, 0));
+  EXPECT_EQ(1, server.getPendingIds(client).count(id));
+
+  // Rotations cross the threshold on their own, too
+  server.createBox(
+      "box2",
+      Eigen::Vector3s::Ones(),
+      Eigen::Vector3s::Zero(),
+      Eigen::Vector3s::Zero());
+  server.setObjectRotation("box2", Eigen::Vector3s(0, 0.02, 0));
+  EXPECT_EQ(1, server.getPendingIds(client).count(server.getObjectId("box2")));
+
+  // Deleting an object drops its pending update
+  server.deleteObject("box");
+  EXPECT_EQ(0, server.getPendingIds(client).count(id));
+}
+
 #ifdef ALL_TESTS
 TEST(REALTIME, GUI_SERVER)
 {
@@ -220,3 +365,83 @@ TEST(REALTIME, GUI_SERVER)
   }
 }
 #endif
+
+TEST(GUI_SERVER, RATE_LIMITED_TRANSFORMS_GET_TRAILING_FLUSH)
+{
+  TransformTestServer server;
+  server.setAutoflush(false);
+  server.setMaxTransformUpdatesPerSecond(4);
+  server.createBox(
+      "box",
+      Eigen::Vector3s::Ones(),
+      Eigen::Vector3s::Zero(),
+      Eigen::Vector3s::Zero());
+  server.serve(8193);
+  while (!server.isServing())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  typedef websocketpp::client<websocketpp::config::asio_client>
+      WebsocketClient;
+  WebsocketClient client;
+  client.clear_access_channels(websocketpp::log::alevel::all);
+  client.clear_error_channels(websocketpp::log::elevel::all);
+  client.init_asio();
+  std::mutex frameMutex;
+  std::atomic<bool> sawHello(false);
+  std::atomic<int> numFrames(0);
+  std::string lastFrame;
+  client.set_message_handler(
+      [&](websocketpp::connection_hdl, WebsocketClient::message_ptr msg) {
+        if (msg->get_opcode() != websocketpp::frame::opcode::binary)
+        {
+          sawHello = true;
+          return;
+        }
+        const std::lock_guard<std::mutex> lock(frameMutex);
+        lastFrame = msg->get_payload();
+        numFrames++;
+      });
+  websocketpp::lib::error_code ec;
+  WebsocketClient::connection_ptr connection
+      = client.get_connection("ws://localhost:8193", ec);
+  ASSERT_FALSE(ec);
+  client.connect(connection);
+  std::thread clientThread([&]() { client.run(); });
+
+  auto waitFor = [](std::function<bool()> condition) {
+    auto start = std::chrono::steady_clock::now();
+    while (!condition()
+           && std::chrono::steady_clock::now() - start
+                  < std::chrono::seconds(5))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+  };
+  // The hello message is sent once the server has registered the client
+  EXPECT_TRUE(waitFor([&]() { return sawHello.load(); }));
+
+  // The first frame goes out right away, but the second one is inside the
+  // rate limit window. Nothing flushes after it, so only the trailing flush
+  // can deliver it.
+  server.setObjectPosition("box", Eigen::Vector3s(1, 0, 0)).flush();
+  EXPECT_TRUE(waitFor([&]() { return numFrames.load() >= 1; }));
+  server.setObjectPosition("box", Eigen::Vector3s(2, 0, 0)).flush();
+  EXPECT_TRUE(waitFor([&]() { return numFrames.load() >= 2; }));
+
+  {
+    const std::lock_guard<std::mutex> lock(frameMutex);
+    std::vector<uint32_t> ids;
+    std::vector<Eigen::Vector3f> poses;
+    std::vector<Eigen::Vector3f> eulers;
+    decodeTransformFrame(lastFrame, ids, poses, eulers);
+    ASSERT_EQ(1, ids.size());
+    EXPECT_EQ(server.getObjectId("box"), ids[0]);
+    EXPECT_TRUE(poses[0].isApprox(Eigen::Vector3f(2, 0, 0)));
+  }
+
+  client.close(
+      connection->get_handle(), websocketpp::close::status::normal, "", ec);
+  clientThread.join();
+  server.stopServing();
+}
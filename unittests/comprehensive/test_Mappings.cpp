@@ -42,7 +42,9 @@
 #include "dart/math/Geometry.hpp"
 #include "dart/neural/BackpropSnapshot.hpp"
 #include "dart/neural/ConstrainedGroupGradientMatrices.hpp"
+#include "dart/neural/DampedLeastSquaresIK.hpp"
 #include "dart/neural/DifferentiableContactConstraint.hpp"
+#include "dart/neural/IKMapping.hpp"
 #include "dart/neural/NeuralConstants.hpp"
 #include "dart/neural/NeuralUtils.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
@@ -357,4 +359,102 @@ TEST(GRADIENTS, WORLD_SPACE_BOXES_FREE_JOINT)
 {
   testWorldSpaceWithBoxes(2);
 }
-#endif
\ No newline at end of file
+#endif
+
+#ifdef ALL_TESTS
+TEST(IK, DAMPED_LEAST_SQUARES_LINEAR)
+{
+  srand(42);
+  // An under-determined linear problem, which Gauss-Newton solves exactly
+  Eigen::MatrixXs A = Eigen::MatrixXs::Random(3, 5);
+  Eigen::VectorXs b = Eigen::VectorXs::Random(3);
+  DampedLeastSquaresIK solver(
+      [&](const Eigen::VectorXs& positions, Eigen::VectorXs& residual) {
+        residual = b - A * positions;
+      },
+      [&](const Eigen::VectorXs& /* positions */, Eigen::MatrixXs& jac) {
+        jac = A;
+      });
+
+  s_t error;
+  int iterations;
+  Eigen::VectorXs solution
+      = solver.solve(Eigen::VectorXs::Zero(5), &error, &iterations);
+  EXPECT_TRUE(equals(Eigen::VectorXs(A * solution), b, 1e-10));
+  EXPECT_LT(error, 1e-20);
+  EXPECT_LT(iterations, 20);
+
+  // With tight limits the target is out of reach, so we should stop on the
+  // boundary rather than running out of iterations
+  Eigen::VectorXs lower = Eigen::VectorXs::Constant(5, -0.01);
+  Eigen::VectorXs upper = Eigen::VectorXs::Constant(5, 0.01);
+  solver.setPositionLimits(lower, upper);
+  solution = solver.solve(Eigen::VectorXs::Ones(5), &error, &iterations);
+  EXPECT_TRUE((solution.array() >= lower.array()).all());
+  EXPECT_TRUE((solution.array() <= upper.array()).all());
+  EXPECT_GT(error, 1e-10);
+  EXPECT_LT(iterations, solver.getIterationLimit());
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(IK, SOLVE_POSITIONS_MATCHES_SET_POSITIONS)
+{
+  srand(42);
+  WorldPtr world = World::create();
+  SkeletonPtr arm = Skeleton::create("arm");
+  BodyNode* parent = nullptr;
+  for (int i = 0; i < 5; i++)
+  {
+    std::pair<RevoluteJoint*, BodyNode*> jointPair
+        = arm->createJointAndBodyNodePair<RevoluteJoint>(parent);
+    Eigen::Isometry3s armOffset = Eigen::Isometry3s::Identity();
+    armOffset.translation() = Eigen::Vector3s(0, 1.0, 0);
+    jointPair.first->setTransformFromParentBodyNode(armOffset);
+    jointPair.first->setAxis(
+        i % 2 == 0 ? Eigen::Vector3s::UnitX() : Eigen::Vector3s::UnitZ());
+    parent = jointPair.second;
+  }
+  world->addSkeleton(arm);
+
+  std::shared_ptr<IKMapping> mapping = std::make_shared<IKMapping>(world);
+  mapping->addLinearBodyNode(arm->getBodyNode(4));
+
+  // Reachable targets along a smooth motion, like mocap frames
+  const int numTargets = 8;
+  Eigen::MatrixXs targets = Eigen::MatrixXs::Zero(3, numTargets);
+  Eigen::VectorXs start = Eigen::VectorXs::Random(5);
+  Eigen::VectorXs end = Eigen::VectorXs::Random(5);
+  for (int i = 0; i < numTargets; i++)
+  {
+    world->setPositions(start + (end - start) * i / (numTargets - 1));
+    targets.col(i) = mapping->getPositions(world);
+  }
+  world->setPositions(Eigen::VectorXs::Zero(5));
+
+  // Without warm starts every solve starts from zero, so the split between
+  // workers can't change the answer
+  Eigen::MatrixXs serial = mapping->solvePositions(world, targets, 1);
+  Eigen::MatrixXs parallel = mapping->solvePositions(world, targets, 3);
+  EXPECT_TRUE(equals(serial, parallel, 1e-12));
+  EXPECT_TRUE(world->getPositions().isZero(0));
+
+  for (int i = 0; i < numTargets; i++)
+  {
+    Eigen::VectorXs target = targets.col(i);
+    Eigen::VectorXs expected = serial.col(i);
+    mapping->setPositions(world, target);
+    EXPECT_TRUE(equals(world->getPositions(), expected, 1e-12));
+    EXPECT_TRUE(equals(mapping->getPositions(world), target, 1e-8));
+  }
+
+  mapping->setIKWarmStart(true);
+  Eigen::MatrixXs warm = mapping->solvePositions(world, targets, 2);
+  for (int i = 0; i < numTargets; i++)
+  {
+    Eigen::VectorXs target = targets.col(i);
+    world->setPositions(warm.col(i));
+    EXPECT_TRUE(equals(mapping->getPositions(world), target, 1e-8));
+  }
+}
+#endif
@@ -31,7 +31,9 @@
  */
 
 #include <chrono>
+#include <complex>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <thread>
 
@@ -51,6 +53,7 @@
 #include "dart/neural/Mapping.hpp"
 #include "dart/neural/NeuralConstants.hpp"
 #include "dart/neural/NeuralUtils.hpp"
+#include "dart/neural/ParallelFiniteDifference.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/simulation/World.hpp"
 #include "dart/trajectory/IPOptOptimizer.hpp"
@@ -820,4 +823,244 @@ TEST(TRAJECTORY, JUMP_WORM)
       std::cout << "Off on force-vel Jac at step " << i << std::endl;
     }
   }
-}
\ No newline at end of file
+}
+TEST(FINITE_DIFFERENCE, PARALLEL_MATCHES_SERIAL)
+{
+  // World
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s(0, -9.81, 0));
+
+  // A hanging chain with no contacts, so every column is smooth
+  SkeletonPtr chain = Skeleton::create("chain");
+  std::pair<RevoluteJoint*, BodyNode*> rootPair
+      = chain->createJointAndBodyNodePair<RevoluteJoint>(nullptr);
+  rootPair.first->setAxis(Eigen::Vector3s::UnitZ());
+  BodyNode* tail = rootPair.second;
+  for (int i = 0; i < 4; i++)
+  {
+    tail = createTailSegment(tail, Eigen::Vector3s::UnitX());
+  }
+  world->addSkeleton(chain);
+
+  chain->setPositions(Eigen::VectorXs::Random(chain->getNumDofs()));
+  chain->setVelocities(Eigen::VectorXs::Random(chain->getNumDofs()));
+  chain->setControlForces(Eigen::VectorXs::Random(chain->getNumDofs()));
+
+  std::shared_ptr<BackpropSnapshot> snapshot = neural::forwardPass(world);
+  world->setPositions(snapshot->getPreStepPosition());
+  world->setVelocities(snapshot->getPreStepVelocity());
+  world->setControlForces(snapshot->getPreStepTorques());
+  world->setCachedLCPSolution(snapshot->getPreStepLCPCache());
+
+  Eigen::VectorXs positions = world->getPositions();
+  EXPECT_GT(world->getFiniteDifferencePool()->getNumWorkers(), 0);
+
+  Eigen::MatrixXs velVel = snapshot->finiteDifferenceVelVelJacobian(world);
+  Eigen::MatrixXs parallelVelVel = snapshot->parallelFiniteDifferenceJacobian(
+      world, WithRespectTo::VELOCITY, false);
+  EXPECT_TRUE(equals(velVel, parallelVelVel, 1e-8));
+
+  Eigen::MatrixXs forceVel = snapshot->finiteDifferenceForceVelJacobian(world);
+  Eigen::MatrixXs parallelForceVel
+      = snapshot->parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::FORCE, false);
+  EXPECT_TRUE(equals(forceVel, parallelForceVel, 1e-8));
+
+  Eigen::MatrixXs parallelPosVelCentral
+      = snapshot->parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::POSITION, false, false);
+  Eigen::MatrixXs posVel = snapshot->getPosVelJacobian(world);
+  EXPECT_TRUE(equals(posVel, parallelPosVelCentral, 1e-6));
+
+  // The clones do all the work, so the world itself is never perturbed
+  EXPECT_TRUE(equals(world->getPositions(), positions, 0.0));
+
+  // The RL API finite differences run on the same pool
+  Eigen::MatrixXs stateJac = world->getStateJacobian();
+  Eigen::MatrixXs stateJacFd = world->finiteDifferenceStateJacobian();
+  EXPECT_TRUE(equals(stateJac, stateJacFd, 1e-6));
+}
+
+TEST(FINITE_DIFFERENCE, POOL_SEES_PROPERTY_CHANGES)
+{
+  // World
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s(0, -9.81, 0));
+
+  SkeletonPtr chain = Skeleton::create("chain");
+  std::pair<RevoluteJoint*, BodyNode*> rootPair
+      = chain->createJointAndBodyNodePair<RevoluteJoint>(nullptr);
+  rootPair.first->setAxis(Eigen::Vector3s::UnitZ());
+  BodyNode* tail = rootPair.second;
+  for (int i = 0; i < 3; i++)
+  {
+    tail = createTailSegment(tail, Eigen::Vector3s::UnitX());
+  }
+  world->addSkeleton(chain);
+
+  chain->setPositions(Eigen::VectorXs::Random(chain->getNumDofs()));
+  chain->setVelocities(Eigen::VectorXs::Random(chain->getNumDofs()));
+  chain->setControlForces(Eigen::VectorXs::Zero(chain->getNumDofs()));
+
+  std::shared_ptr<BackpropSnapshot> snapshot = neural::forwardPass(world);
+  auto resetWorld = [&]() {
+    world->setPositions(snapshot->getPreStepPosition());
+    world->setVelocities(snapshot->getPreStepVelocity());
+    world->setControlForces(snapshot->getPreStepTorques());
+    world->setCachedLCPSolution(snapshot->getPreStepLCPCache());
+  };
+  resetWorld();
+
+  // This builds the pool
+  snapshot->parallelFiniteDifferenceJacobian(
+      world, WithRespectTo::VELOCITY, false);
+
+  // None of these change the world's structure, so the pool's clones get
+  // reused, and have to pick the changes up when they're synced
+  // Setting forces clamps them to these limits, so this zeroes out the upper
+  // half of the central difference on the tail's control force
+  Joint* tailJoint = tail->getParentJoint();
+  tailJoint->setControlForceUpperLimit(0, 0.0);
+  rootPair.first->setDampingCoefficient(0, 2.0);
+  rootPair.first->setSpringStiffness(0, 5.0);
+  tail->setExtForce(Eigen::Vector3s(0, 3.0, 0));
+  tail->setFrictionCoeff(0.3);
+
+  Eigen::MatrixXs velVel = snapshot->finiteDifferenceVelVelJacobian(world);
+  resetWorld();
+  Eigen::MatrixXs parallelVelVel = snapshot->parallelFiniteDifferenceJacobian(
+      world, WithRespectTo::VELOCITY, false);
+  EXPECT_TRUE(equals(velVel, parallelVelVel, 1e-8));
+
+  resetWorld();
+  Eigen::MatrixXs forceVel = snapshot->finiteDifferenceForceVelJacobian(world);
+  resetWorld();
+  Eigen::MatrixXs parallelForceVel
+      = snapshot->parallelFiniteDifferenceJacobian(
+          world, WithRespectTo::FORCE, false);
+  EXPECT_TRUE(equals(forceVel, parallelForceVel, 1e-8));
+
+  for (int i = 0; i < world->getFiniteDifferencePool()->getNumWorkers(); i++)
+  {
+    SkeletonPtr workerChain
+        = world->getFiniteDifferencePool()->getWorker(i)->getSkeleton("chain");
+    Joint* workerTailJoint
+        = workerChain->getBodyNode(tail->getIndexInSkeleton())
+              ->getParentJoint();
+    EXPECT_EQ(workerTailJoint->getControlForceUpperLimit(0), 0.0);
+    EXPECT_EQ(
+        workerChain->getBodyNode(tail->getIndexInSkeleton())
+            ->getFrictionCoeff(),
+        0.3);
+  }
+}
+
+TEST(FINITE_DIFFERENCE, COMPLEX_STEP)
+{
+  typedef Eigen::Matrix<std::complex<s_t>, Eigen::Dynamic, 1> VectorXcs;
+
+  // f(x) = [x0 * sin(x1), exp(x0 * x2), x1^3]
+  auto f = [](const VectorXcs& x) {
+    VectorXcs out(3);
+    out(0) = x(0) * std::sin(x(1));
+    out(1) = std::exp(x(0) * x(2));
+    out(2) = x(1) * x(1) * x(1);
+    return out;
+  };
+
+  Eigen::VectorXs x = Eigen::Vector3s(0.3, -1.2, 0.7);
+  Eigen::MatrixXs expected = Eigen::MatrixXs::Zero(3, 3);
+  expected(0, 0) = sin(x(1));
+  expected(0, 1) = x(0) * cos(x(1));
+  expected(1, 0) = x(2) * exp(x(0) * x(2));
+  expected(1, 2) = x(0) * exp(x(0) * x(2));
+  expected(2, 1) = 3 * x(1) * x(1);
+
+  Eigen::MatrixXs J = ParallelFiniteDifference::complexStepJacobian(f, x, 3);
+  EXPECT_TRUE(equals(J, expected, 1e-14));
+}
+
+TEST(BACKPROP, PRECOMPUTED_JACOBIANS)
+{
+  // World
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s(0, -9.81, 0));
+
+  SkeletonPtr chain = Skeleton::create("chain");
+  std::pair<RevoluteJoint*, BodyNode*> rootPair
+      = chain->createJointAndBodyNodePair<RevoluteJoint>(nullptr);
+  rootPair.first->setAxis(Eigen::Vector3s::UnitZ());
+  BodyNode* tail = rootPair.second;
+  for (int i = 0; i < 4; i++)
+  {
+    tail = createTailSegment(tail, Eigen::Vector3s::UnitX());
+  }
+  world->addSkeleton(chain);
+
+  chain->setPositions(Eigen::VectorXs::Random(chain->getNumDofs()));
+  chain->setVelocities(Eigen::VectorXs::Random(chain->getNumDofs()));
+
+  const int STEPS = 20;
+  WorldPtr world1 = world->clone();
+  WorldPtr world2 = world->clone();
+
+  std::vector<std::shared_ptr<BackpropSnapshot>> snapshots1;
+  std::vector<std::shared_ptr<BackpropSnapshot>> snapshots2;
+  for (int i = 0; i < STEPS; i++)
+  {
+    Eigen::VectorXs forces = Eigen::VectorXs::Random(world->getNumDofs());
+    world1->setControlForces(forces);
+    world2->setControlForces(forces);
+    snapshots1.push_back(neural::forwardPass(world1));
+    snapshots2.push_back(neural::forwardPass(world2, false, true));
+    EXPECT_TRUE(snapshots2[i]->hasPrecomputedJacobians());
+  }
+  Eigen::VectorXs finalPositions = world2->getPositions();
+
+  std::vector<LossGradient> nextTimestepLosses;
+  for (int i = 0; i < STEPS; i++)
+  {
+    LossGradient loss;
+    loss.lossWrtPosition = Eigen::VectorXs::Random(world->getNumDofs());
+    loss.lossWrtVelocity = Eigen::VectorXs::Random(world->getNumDofs());
+    nextTimestepLosses.push_back(loss);
+  }
+
+  // Backprop every timestep at once, none of which should touch world2
+  std::vector<LossGradient> cachedLosses(STEPS);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < STEPS; i++)
+  {
+    futures.push_back(std::async(std::launch::async, [&, i]() {
+      snapshots2[i]->backpropCached(cachedLosses[i], nextTimestepLosses[i]);
+    }));
+  }
+  for (int i = 0; i < STEPS; i++)
+  {
+    futures[i].wait();
+  }
+  EXPECT_TRUE(equals(world2->getPositions(), finalPositions, 0.0));
+
+  for (int i = 0; i < STEPS; i++)
+  {
+    LossGradient thisTimestepLoss;
+    snapshots1[i]->backprop(world1, thisTimestepLoss, nextTimestepLosses[i]);
+    EXPECT_TRUE(equals(
+        thisTimestepLoss.lossWrtPosition,
+        cachedLosses[i].lossWrtPosition,
+        1e-12));
+    EXPECT_TRUE(equals(
+        thisTimestepLoss.lossWrtVelocity,
+        cachedLosses[i].lossWrtVelocity,
+        1e-12));
+    EXPECT_TRUE(equals(
+        thisTimestepLoss.lossWrtTorque, cachedLosses[i].lossWrtTorque, 1e-12));
+
+    // The World-based entry point takes the cached path too
+    LossGradient worldLoss;
+    snapshots2[i]->backprop(world2, worldLoss, nextTimestepLosses[i]);
+    EXPECT_TRUE(equals(
+        worldLoss.lossWrtPosition, cachedLosses[i].lossWrtPosition, 0.0));
+  }
+  EXPECT_TRUE(equals(world2->getPositions(), finalPositions, 0.0));
+}
@@ -97,6 +97,50 @@ TEST(PROTO, SERIALIZE_MATRIX)
   EXPECT_TRUE(equals(original, recovered, 0.0));
 }
 
+TEST(PROTO, SERIALIZE_MATRIX_ENCODINGS)
+{
+  Eigen::MatrixXs original = Eigen::MatrixXs::Random(10, 5);
+
+  proto::MatrixXs repeated;
+  serializeMatrix(repeated, original, proto::REPEATED_DOUBLE);
+  EXPECT_EQ(repeated.values_size(), original.size());
+  EXPECT_TRUE(equals(original, deserializeMatrix(repeated), 0.0));
+
+  proto::MatrixXs packed;
+  serializeMatrix(packed, original, proto::PACKED_FLOAT64);
+  EXPECT_EQ(packed.values_size(), 0);
+  EXPECT_EQ(packed.packed().size(), original.size() * sizeof(double));
+  EXPECT_TRUE(equals(original, deserializeMatrix(packed), 0.0));
+
+  proto::MatrixXs quantized;
+  serializeMatrix(quantized, original, proto::PACKED_FLOAT32);
+  EXPECT_EQ(quantized.packed().size(), original.size() * sizeof(float));
+  Eigen::MatrixXs recovered = deserializeMatrix(quantized);
+  EXPECT_TRUE(equals(original, recovered, 1e-6));
+  Eigen::MatrixXs rounded = original.cast<float>().cast<s_t>();
+  EXPECT_TRUE(equals(rounded, recovered, 0.0));
+
+  // Reusing a message with a different encoding replaces the old data
+  serializeMatrix(repeated, original, proto::PACKED_FLOAT64);
+  EXPECT_EQ(repeated.values_size(), 0);
+  EXPECT_TRUE(equals(original, deserializeMatrix(repeated), 0.0));
+}
+
+TEST(PROTO, DESERIALIZE_LEGACY_VECTOR)
+{
+  // Messages written before packed encodings existed only set `values`
+  proto::VectorXs legacy;
+  legacy.set_size(3);
+  legacy.add_values(1.0);
+  legacy.add_values(-2.5);
+  legacy.add_values(3.25);
+
+  Eigen::VectorXs expected = Eigen::VectorXs::Zero(3);
+  expected << 1.0, -2.5, 3.25;
+  Eigen::VectorXs recovered = deserializeVector(legacy);
+  EXPECT_TRUE(equals(expected, recovered, 0.0));
+}
+
 TEST(PROTO, SERIALIZE_ROLLOUT)
 {
   int dofs = 5;
@@ -156,4 +200,46 @@ TEST(PROTO, SERIALIZE_ROLLOUT)
       equals(rollout.getMetadata("2"), recovered.getMetadata("2"), 0.0));
   EXPECT_TRUE(
       equals(rollout.getMetadata("3"), recovered.getMetadata("3"), 0.0));
+}
+
+TEST(PROTO, SERIALIZE_ROLLOUT_FLOAT32)
+{
+  int dofs = 5;
+  int steps = 10;
+
+  std::unordered_map<std::string, Eigen::MatrixXs> pos;
+  std::unordered_map<std::string, Eigen::MatrixXs> vel;
+  std::unordered_map<std::string, Eigen::MatrixXs> force;
+  Eigen::VectorXs mass = Eigen::VectorXs::Random(dofs);
+  std::unordered_map<std::string, Eigen::MatrixXs> metadata;
+
+  pos["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+  vel["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+  force["identity"] = Eigen::MatrixXs::Random(dofs, steps);
+
+  TrajectoryRolloutReal rollout
+      = TrajectoryRolloutReal(pos, vel, force, mass, metadata);
+
+  proto::TrajectoryRollout full;
+  rollout.serialize(full);
+  proto::TrajectoryRollout quantized;
+  rollout.serialize(quantized, proto::PACKED_FLOAT32);
+  EXPECT_LT(quantized.ByteSizeLong(), full.ByteSizeLong());
+
+  TrajectoryRolloutReal recovered
+      = trajectory::TrajectoryRollout::deserialize(quantized);
+  EXPECT_TRUE(
+      equals(rollout.getMassesConst(), recovered.getMassesConst(), 1e-6));
+  EXPECT_TRUE(equals(
+      rollout.getPosesConst("identity"),
+      recovered.getPosesConst("identity"),
+      1e-6));
+  EXPECT_TRUE(equals(
+      rollout.getVelsConst("identity"),
+      recovered.getVelsConst("identity"),
+      1e-6));
+  EXPECT_TRUE(equals(
+      rollout.getControlForcesConst("identity"),
+      recovered.getControlForcesConst("identity"),
+      1e-6));
 }
\ No newline at end of file
@@ -32,6 +32,7 @@
 
 #include <gtest/gtest.h>
 
+#include "dart/collision/dart/DARTCollisionDetector.hpp"
 #include "dart/dart.hpp"
 #if HAVE_BULLET
 #include "dart/collision/bullet/bullet.hpp"
@@ -44,17 +45,16 @@ using namespace dart;
 void testBasicInterface(const std::shared_ptr<CollisionDetector>& cd)
 {
 #if HAVE_BULLET
-  if (cd->getType() != collision::BulletCollisionDetector::getStaticType())
+  if (cd->getType() != collision::BulletCollisionDetector::getStaticType()
+      && cd->getType() != collision::DARTCollisionDetector::getStaticType())
+#else
+  if (cd->getType() != collision::DARTCollisionDetector::getStaticType())
+#endif
   {
-    dtwarn << "Aborting test: distance check is not supported by "
-           << cd->getType() << ".\n";
+    dtwarn << "Aborting test: raycast is not supported by " << cd->getType()
+           << ".\n";
     return;
   }
-#else
-  dtwarn << "Aborting test: distance check is not supported by "
-         << cd->getType() << ".\n";
-  return;
-#endif
 
   auto simpleFrame1 = SimpleFrame::createShared(Frame::World());
 
@@ -131,17 +131,16 @@ TEST(Distance, testBasicInterface)
 void testOptions(const std::shared_ptr<CollisionDetector>& cd)
 {
 #if HAVE_BULLET
-  if (cd->getType() != collision::BulletCollisionDetector::getStaticType())
+  if (cd->getType() != collision::BulletCollisionDetector::getStaticType()
+      && cd->getType() != collision::DARTCollisionDetector::getStaticType())
+#else
+  if (cd->getType() != collision::DARTCollisionDetector::getStaticType())
+#endif
   {
-    dtwarn << "Aborting test: distance check is not supported by "
-           << cd->getType() << ".\n";
+    dtwarn << "Aborting test: raycast is not supported by " << cd->getType()
+           << ".\n";
     return;
   }
-#else
-  dtwarn << "Aborting test: distance check is not supported by "
-         << cd->getType() << ".\n";
-  return;
-#endif
 
   auto simpleFrame1 = SimpleFrame::createShared(Frame::World());
   auto shape1 = std::make_shared<SphereShape>(1.0);
@@ -208,3 +207,106 @@ TEST(Distance, testOptions)
   auto dart = DARTCollisionDetector::create();
   testOptions(dart);
 }
+
+//==============================================================================
+TEST(Raycast, DARTBatchMatchesSingle)
+{
+  auto cd = DARTCollisionDetector::create();
+
+  auto sphereFrame = SimpleFrame::createShared(Frame::World());
+  sphereFrame->setShape(std::make_shared<SphereShape>(0.5));
+  sphereFrame->setTranslation(Eigen::Vector3s(2, 0, 0));
+
+  auto boxFrame = SimpleFrame::createShared(Frame::World());
+  boxFrame->setShape(std::make_shared<BoxShape>(Eigen::Vector3s(1, 2, 3)));
+  boxFrame->setTranslation(Eigen::Vector3s(0, 3, 0));
+  boxFrame->setRotation(
+      Eigen::AngleAxis_s(0.3, Eigen::Vector3s::UnitZ()).toRotationMatrix());
+
+  auto capsuleFrame = SimpleFrame::createShared(Frame::World());
+  capsuleFrame->setShape(std::make_shared<CapsuleShape>(0.3, 1.0));
+  capsuleFrame->setTranslation(Eigen::Vector3s(-2, -1, 0));
+
+  auto group = cd->createCollisionGroup(
+      sphereFrame.get(), boxFrame.get(), capsuleFrame.get());
+
+  // A ring of rays, like one beam of a lidar, fired from the origin
+  const int numRays = 1000;
+  Eigen::MatrixXs froms = Eigen::MatrixXs::Zero(3, numRays);
+  Eigen::MatrixXs tos(3, numRays);
+  for (int i = 0; i < numRays; i++)
+  {
+    const s_t angle = 2 * M_PI * i / numRays;
+    tos.col(i) = 10.0 * Eigen::Vector3s(cos(angle), sin(angle), 0.0);
+  }
+
+  std::vector<RayHit> hits;
+  const std::size_t numHits
+      = cd->raycastBatch(group.get(), froms, tos, hits, 4);
+  ASSERT_EQ(hits.size(), static_cast<std::size_t>(numRays));
+  EXPECT_GT(numHits, 0u);
+
+  std::size_t numSingleHits = 0;
+  for (int i = 0; i < numRays; i++)
+  {
+    collision::RaycastResult result;
+    cd->raycast(
+        group.get(),
+        froms.col(i),
+        tos.col(i),
+        collision::RaycastOption(),
+        &result);
+    if (!result.hasHit())
+    {
+      EXPECT_EQ(hits[i].mCollisionObject, nullptr);
+      continue;
+    }
+    numSingleHits++;
+    EXPECT_EQ(hits[i].mCollisionObject, result.mRayHits[0].mCollisionObject);
+    EXPECT_NEAR(hits[i].mFraction, result.mRayHits[0].mFraction, 1e-12);
+    EXPECT_TRUE(equals(hits[i].mNormal, result.mRayHits[0].mNormal));
+  }
+  EXPECT_EQ(numHits, numSingleHits);
+
+  // The ray straight down +X should hit the near side of the sphere
+  EXPECT_EQ(hits[0].mCollisionObject->getShapeFrame(), sphereFrame.get());
+  EXPECT_TRUE(equals(hits[0].mPoint, Eigen::Vector3s(1.5, 0, 0)));
+  EXPECT_TRUE(equals(hits[0].mNormal, Eigen::Vector3s(-1, 0, 0)));
+}
+
+//==============================================================================
+TEST(Raycast, DARTRaycastSeesSkeletonChanges)
+{
+  auto cd = DARTCollisionDetector::create();
+
+  auto skel = Skeleton::create("skel");
+  auto body = skel->createJointAndBodyNodePair<FreeJoint>().second;
+  body->createShapeNodeWith<CollisionAspect>(std::make_shared<SphereShape>(0.5));
+  auto group = cd->createCollisionGroup();
+  group->subscribeTo(skel);
+
+  collision::RaycastResult result;
+  cd->raycast(
+      group.get(),
+      Eigen::Vector3s(-5, 0, 0),
+      Eigen::Vector3s(5, 0, 0),
+      collision::RaycastOption(),
+      &result);
+  ASSERT_TRUE(result.hasHit());
+  EXPECT_NEAR(result.mRayHits[0].mPoint[0], -0.5, 1e-8);
+
+  // A shape added after the group was created should be picked up, like it is
+  // for collide() and raycastBatch()
+  auto shapeNode = body->createShapeNodeWith<CollisionAspect>(
+      std::make_shared<BoxShape>(Eigen::Vector3s(1, 1, 1)));
+  shapeNode->setRelativeTranslation(Eigen::Vector3s(-2, 0, 0));
+
+  cd->raycast(
+      group.get(),
+      Eigen::Vector3s(-5, 0, 0),
+      Eigen::Vector3s(5, 0, 0),
+      collision::RaycastOption(),
+      &result);
+  ASSERT_TRUE(result.hasHit());
+  EXPECT_NEAR(result.mRayHits[0].mPoint[0], -2.5, 1e-8);
+}
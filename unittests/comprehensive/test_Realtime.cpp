@@ -30,6 +30,7 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -42,6 +43,7 @@
 #include "dart/realtime/MPC.hpp"
 #include "dart/realtime/MPCLocal.hpp"
 #include "dart/realtime/MPCRemote.hpp"
+#include "dart/realtime/MPCSharedMemory.hpp"
 #include "dart/realtime/SSID.hpp"
 #include "dart/realtime/Ticker.hpp"
 #include "dart/server/GUIWebsocketServer.hpp"
@@ -49,6 +51,7 @@
 #include "dart/trajectory/IPOptOptimizer.hpp"
 #include "dart/trajectory/LossFn.hpp"
 #include "dart/trajectory/MultiShot.hpp"
+#include "dart/trajectory/TrajectoryRollout.hpp"
 
 #include "TestHelpers.hpp"
 #include "stdio.h"
@@ -521,3 +524,171 @@ TEST(REALTIME, CARTPOLE_SSID)
             << armPair.second->getMass() << std::endl;
 }
 #endif
+
+TEST(REALTIME, SHARED_MEMORY_CHANNEL)
+{
+  std::shared_ptr<realtime::MPCSharedMemoryChannel> planner
+      = realtime::MPCSharedMemoryChannel::create(
+          "nimble_test_channel", 2, 1, 3, 10);
+  ASSERT_TRUE(planner != nullptr);
+  std::shared_ptr<realtime::MPCSharedMemoryChannel> driver
+      = realtime::MPCSharedMemoryChannel::open("nimble_test_channel");
+  ASSERT_TRUE(driver != nullptr);
+  EXPECT_EQ(driver->getNumDofs(), 2);
+  EXPECT_EQ(driver->getNumSteps(), 3);
+
+  // Observations arrive in order
+  Eigen::VectorXs pos = Eigen::VectorXs::Ones(2);
+  Eigen::VectorXs vel = Eigen::VectorXs::Ones(2) * 2;
+  Eigen::VectorXs mass = Eigen::VectorXs::Ones(1) * 3;
+  Eigen::VectorXs force = Eigen::VectorXs::Ones(2) * 4;
+  EXPECT_TRUE(driver->pushGroundTruthState(10, pos, vel, mass));
+  EXPECT_TRUE(driver->pushObservedForce(11, force));
+  realtime::MPCSharedMemoryChannel::Observation observation;
+  ASSERT_TRUE(planner->popObservation(observation));
+  EXPECT_EQ(
+      observation.type, realtime::MPCSharedMemoryChannel::GROUND_TRUTH_STATE);
+  EXPECT_EQ(observation.time, 10);
+  EXPECT_TRUE(equals(observation.vel, vel));
+  EXPECT_TRUE(equals(observation.mass, mass));
+  ASSERT_TRUE(planner->popObservation(observation));
+  EXPECT_EQ(observation.type, realtime::MPCSharedMemoryChannel::OBSERVED_FORCE);
+  EXPECT_TRUE(equals(observation.force, force));
+  EXPECT_FALSE(planner->popObservation(observation));
+
+  // A full ring drops observations rather than blocking the driver
+  const int capacity = realtime::MPCSharedMemoryChannel::OBSERVATION_CAPACITY;
+  for (int i = 0; i < capacity + 5; i++)
+  {
+    driver->pushObservedForce(i, force);
+  }
+  EXPECT_EQ(driver->getNumDroppedObservations(), 5);
+
+  // Only the newest plan is read
+  std::unordered_map<std::string, Eigen::MatrixXs> poses;
+  std::unordered_map<std::string, Eigen::MatrixXs> vels;
+  std::unordered_map<std::string, Eigen::MatrixXs> forces;
+  std::unordered_map<std::string, Eigen::MatrixXs> metadata;
+  poses["identity"] = Eigen::MatrixXs::Random(2, 3);
+  vels["identity"] = Eigen::MatrixXs::Random(2, 3);
+  forces["identity"] = Eigen::MatrixXs::Random(2, 3);
+  trajectory::TrajectoryRolloutReal rollout(
+      poses, vels, forces, Eigen::VectorXs::Ones(1), metadata);
+  long version = 0;
+  realtime::MPCSharedMemoryChannel::Plan plan;
+  EXPECT_FALSE(driver->readPlan(version, plan));
+  planner->publishPlan(100, 5, &rollout);
+  planner->publishPlan(200, 5, &rollout);
+  ASSERT_TRUE(driver->readPlan(version, plan));
+  EXPECT_EQ(plan.startTime, 200);
+  EXPECT_TRUE(equals(plan.forces, forces["identity"]));
+  EXPECT_TRUE(equals(plan.poses, poses["identity"]));
+  EXPECT_FALSE(driver->readPlan(version, plan));
+
+  // The last start/stop request wins
+  long lastRequest = 0;
+  bool running = false;
+  EXPECT_FALSE(planner->pollRunningRequest(lastRequest, running));
+  driver->requestRunning(true);
+  driver->requestRunning(false);
+  EXPECT_TRUE(planner->pollRunningRequest(lastRequest, running));
+  EXPECT_FALSE(running);
+
+  driver->close();
+  EXPECT_TRUE(planner->isClosed());
+}
+
+TEST(REALTIME, SHARED_MEMORY_CHANNEL_CONCURRENT_PRODUCERS)
+{
+  std::shared_ptr<realtime::MPCSharedMemoryChannel> planner
+      = realtime::MPCSharedMemoryChannel::create(
+          "nimble_test_producers", 3, 1, 3, 10);
+  ASSERT_TRUE(planner != nullptr);
+  std::shared_ptr<realtime::MPCSharedMemoryChannel> driver
+      = realtime::MPCSharedMemoryChannel::open("nimble_test_producers");
+  ASSERT_TRUE(driver != nullptr);
+
+  // The driver records ground truth and applied forces from different threads,
+  // like MPCSharedMemoryRemote::recordGroundTruthState() and
+  // getControlForce() do. Every value in an observation is its time, so torn
+  // writes show up as mismatches. Producers retry pushes that found the ring
+  // full, so every observation should arrive exactly once. A lost or clobbered
+  // slot would stall everyone, so give up after a generous deadline.
+  const int numEach = 20000;
+  std::atomic<long> numRejected(0);
+  std::atomic<bool> timedOut(false);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  std::thread stateThread([&]() {
+    for (int i = 0; i < numEach; i++)
+    {
+      Eigen::VectorXs value = Eigen::VectorXs::Constant(3, i);
+      while (!driver->pushGroundTruthState(
+          i, value, value, Eigen::VectorXs::Constant(1, i)))
+      {
+        if (timedOut)
+          return;
+        numRejected++;
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::thread forceThread([&]() {
+    for (int i = 0; i < numEach; i++)
+    {
+      while (!driver->pushObservedForce(i, Eigen::VectorXs::Constant(3, i)))
+      {
+        if (timedOut)
+          return;
+        numRejected++;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int numStates = 0;
+  int numForces = 0;
+  long lastStateTime = -1;
+  long lastForceTime = -1;
+  bool allIntact = true;
+  realtime::MPCSharedMemoryChannel::Observation observation;
+  while (numStates + numForces < 2 * numEach)
+  {
+    if (!planner->popObservation(observation))
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+      {
+        timedOut = true;
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    s_t time = observation.time;
+    if (observation.type
+        == realtime::MPCSharedMemoryChannel::GROUND_TRUTH_STATE)
+    {
+      numStates++;
+      allIntact &= observation.time > lastStateTime;
+      lastStateTime = observation.time;
+      allIntact &= (observation.pos.array() == time).all()
+                   && (observation.vel.array() == time).all()
+                   && (observation.mass.array() == time).all();
+    }
+    else
+    {
+      numForces++;
+      allIntact &= observation.time > lastForceTime;
+      lastForceTime = observation.time;
+      allIntact &= (observation.force.array() == time).all();
+    }
+  }
+  stateThread.join();
+  forceThread.join();
+
+  EXPECT_FALSE(timedOut);
+  EXPECT_TRUE(allIntact);
+  EXPECT_EQ(numEach, numStates);
+  EXPECT_EQ(numEach, numForces);
+  EXPECT_FALSE(planner->popObservation(observation));
+  EXPECT_EQ(numRejected.load(), driver->getNumDroppedObservations());
+}
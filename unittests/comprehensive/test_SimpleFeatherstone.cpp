@@ -4,10 +4,19 @@
 
 #include "dart/collision/CollisionObject.hpp"
 #include "dart/collision/Contact.hpp"
+#include "dart/dynamics/BallJoint.hpp"
 #include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/EulerJoint.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
+#include "dart/dynamics/PlanarJoint.hpp"
+#include "dart/dynamics/PrismaticJoint.hpp"
 #include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/ScrewJoint.hpp"
 #include "dart/dynamics/SimpleFeatherstone.hpp"
 #include "dart/dynamics/Skeleton.hpp"
+#include "dart/dynamics/TranslationalJoint.hpp"
+#include "dart/dynamics/UniversalJoint.hpp"
+#include "dart/dynamics/WeldJoint.hpp"
 #include "dart/math/Geometry.hpp"
 #include "dart/neural/BackpropSnapshot.hpp"
 #include "dart/neural/ConstrainedGroupGradientMatrices.hpp"
@@ -135,6 +144,48 @@ void verifySkeleton(SkeletonPtr skel)
   free(accel);
 }
 
+template <typename JointType>
+static std::pair<JointType*, BodyNode*> addBody(
+    SkeletonPtr skel, BodyNode* parent)
+{
+  auto pair = skel->createJointAndBodyNodePair<JointType>(parent);
+  pair.first->setTransformFromParentBodyNode(
+      math::expMap(Eigen::Vector6s::Random()));
+  pair.first->setTransformFromChildBodyNode(
+      math::expMap(Eigen::Vector6s::Random()));
+  pair.second->setInertia(dynamics::Inertia(
+      1.0 + Eigen::Vector3s::Random().cwiseAbs()(0),
+      Eigen::Vector3s::Random() * 0.1,
+      Eigen::Matrix3s::Identity() * 0.3));
+  return pair;
+}
+
+/// This has every joint type SimpleFeatherstone supports, across two trees
+SkeletonPtr createEveryJointSkeleton()
+{
+  SkeletonPtr skel = Skeleton::create("every_joint");
+  BodyNode* pelvis = addBody<FreeJoint>(skel, nullptr).second;
+  BodyNode* torso = addBody<BallJoint>(skel, pelvis).second;
+  addBody<EulerJoint>(skel, torso);
+  auto arm = addBody<EulerJoint>(skel, torso);
+  arm.first->setAxisOrder(EulerJoint::AxisOrder::ZYX);
+  BodyNode* forearm = addBody<UniversalJoint>(skel, arm.second).second;
+  auto hand = addBody<ScrewJoint>(skel, forearm);
+  hand.first->setPitch(0.3);
+
+  auto thigh = addBody<RevoluteJoint>(skel, pelvis);
+  thigh.first->setSpringStiffness(0, 5.0);
+  thigh.first->setRestPosition(0, 0.2);
+  thigh.first->setDampingCoefficient(0, 0.5);
+  BodyNode* shin = addBody<PrismaticJoint>(skel, thigh.second).second;
+  BodyNode* foot = addBody<WeldJoint>(skel, shin).second;
+  foot->addExtForce(Eigen::Vector3s::UnitX(), Eigen::Vector3s::UnitY());
+  addBody<TranslationalJoint>(skel, foot);
+
+  addBody<PlanarJoint>(skel, nullptr);
+  return skel;
+}
+
 #ifdef ALL_TESTS
 TEST(FEATHERSTONE, LINK_5)
 {
@@ -142,6 +193,191 @@ TEST(FEATHERSTONE, LINK_5)
 }
 #endif
 
+#ifdef ALL_TESTS
+TEST(FEATHERSTONE, EVERY_JOINT_TYPE)
+{
+  SkeletonPtr skel = createEveryJointSkeleton();
+  skel->setGravity(Eigen::Vector3s(0, -9.81, 0));
+  EXPECT_TRUE(SimpleFeatherstone::canRepresent(skel));
+
+  const int dofs = skel->getNumDofs();
+  SimpleFeatherstone simple;
+  simple.populateFromSkeleton(skel);
+  EXPECT_EQ(skel->getNumBodyNodes(), simple.len());
+  EXPECT_EQ(dofs, simple.getNumDofs());
+
+  for (int j = 0; j < 10; j++)
+  {
+    Eigen::VectorXs pos = Eigen::VectorXs::Random(dofs);
+    Eigen::VectorXs vel = Eigen::VectorXs::Random(dofs);
+    Eigen::VectorXs force = Eigen::VectorXs::Random(dofs);
+    skel->setPositions(pos);
+    skel->setVelocities(vel);
+    skel->setControlForces(force);
+
+    // Forward dynamics, including springs, damping and external forces
+    Eigen::VectorXs acc = Eigen::VectorXs::Zero(dofs);
+    simple.forwardDynamics(pos.data(), vel.data(), force.data(), acc.data());
+    skel->computeForwardDynamics();
+    EXPECT_TRUE(equals(acc, skel->getAccelerations(), 1e-9));
+
+    // Inverse dynamics
+    Eigen::VectorXs targetAcc = Eigen::VectorXs::Random(dofs);
+    Eigen::VectorXs idForce = Eigen::VectorXs::Zero(dofs);
+    simple.inverseDynamics(
+        pos.data(), vel.data(), targetAcc.data(), idForce.data());
+    skel->setAccelerations(targetAcc);
+    skel->computeInverseDynamics();
+    EXPECT_TRUE(equals(idForce, skel->getControlForces(), 1e-9));
+
+    // Mass matrix, and solving against it
+    Eigen::MatrixXs M = Eigen::MatrixXs::Zero(dofs, dofs);
+    simple.massMatrix(pos.data(), M.data());
+    EXPECT_TRUE(equals(M, skel->getMassMatrix(), 1e-9));
+
+    Eigen::VectorXs x = Eigen::VectorXs::Random(dofs);
+    Eigen::VectorXs Minvx = Eigen::VectorXs::Zero(dofs);
+    simple.inverseMassMatrixTimes(pos.data(), x.data(), Minvx.data());
+    EXPECT_TRUE(
+        equals(Eigen::VectorXs(skel->getMassMatrix() * Minvx), x, 1e-9));
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(FEATHERSTONE, REJECTS_KINEMATIC_ACTUATORS)
+{
+  SkeletonPtr skel = createEveryJointSkeleton();
+  EXPECT_TRUE(SimpleFeatherstone::canRepresent(skel));
+  skel->getJoint(1)->setActuatorType(Joint::VELOCITY);
+  EXPECT_FALSE(SimpleFeatherstone::canRepresent(skel));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(FEATHERSTONE, ROLLOUT_MATCHES_SKELETON)
+{
+  SkeletonPtr skel = createEveryJointSkeleton();
+  skel->setGravity(Eigen::Vector3s(0, -9.81, 0));
+  skel->setTimeStep(0.001);
+  SkeletonPtr generic = skel->cloneSkeleton();
+
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(skel->getNumDofs());
+  Eigen::VectorXs vel = Eigen::VectorXs::Random(skel->getNumDofs());
+  skel->setPositions(pos);
+  generic->setPositions(pos);
+  skel->setVelocities(vel);
+  generic->setVelocities(vel);
+
+  // Repopulate on every step, the way a simulation loop would have to
+  SimpleFeatherstone simple;
+  Eigen::VectorXs acc = Eigen::VectorXs::Zero(skel->getNumDofs());
+  for (int i = 0; i < 20; i++)
+  {
+    Eigen::VectorXs force = Eigen::VectorXs::Random(skel->getNumDofs());
+    skel->setControlForces(force);
+    generic->setControlForces(force);
+
+    simple.populateFromSkeleton(skel);
+    pos = skel->getPositions();
+    vel = skel->getVelocities();
+    simple.forwardDynamics(pos.data(), vel.data(), force.data(), acc.data());
+    skel->setAccelerations(acc);
+    skel->integrateVelocities(skel->getTimeStep());
+    skel->integratePositions(skel->getTimeStep());
+
+    generic->computeForwardDynamics();
+    generic->integrateVelocities(generic->getTimeStep());
+    generic->integratePositions(generic->getTimeStep());
+  }
+  EXPECT_TRUE(equals(skel->getPositions(), generic->getPositions(), 1e-9));
+  EXPECT_TRUE(equals(skel->getVelocities(), generic->getVelocities(), 1e-9));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(FEATHERSTONE, WORLD_STEP_MATCHES_GENERIC_PATH)
+{
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s(0, -9.81, 0));
+  world->setTimeStep(0.001);
+  world->addSkeleton(createEveryJointSkeleton());
+  EXPECT_TRUE(world->getUseFastFeatherstone());
+
+  WorldPtr generic = world->clone();
+  generic->setUseFastFeatherstone(false);
+
+  Eigen::VectorXs pos = Eigen::VectorXs::Random(world->getNumDofs());
+  Eigen::VectorXs vel = Eigen::VectorXs::Random(world->getNumDofs());
+  world->setPositions(pos);
+  generic->setPositions(pos);
+  world->setVelocities(vel);
+  generic->setVelocities(vel);
+
+  for (int i = 0; i < 20; i++)
+  {
+    // Part way through, change a joint transform, which only the per-step
+    // refresh picks up, and later the inertias, which have to repopulate
+    for (WorldPtr w : {world, generic})
+    {
+      BodyNode* body = w->getSkeleton(0)->getBodyNode(1);
+      if (i == 7)
+      {
+        body->getParentJoint()->setTransformFromChildBodyNode(
+            math::expMap(Eigen::Vector6s::Constant(0.1)));
+      }
+      if (i == 11)
+      {
+        body->setInertia(dynamics::Inertia(
+            2.0, Eigen::Vector3s::Zero(), Eigen::Matrix3s::Identity() * 0.5));
+      }
+      if (i == 15)
+      {
+        w->getSkeleton(0)->getBodyNode(3)->setMass(3.0);
+      }
+    }
+
+    Eigen::VectorXs force = Eigen::VectorXs::Random(world->getNumDofs());
+    world->setControlForces(force);
+    generic->setControlForces(force);
+    world->step();
+    generic->step();
+  }
+  EXPECT_TRUE(equals(world->getPositions(), generic->getPositions(), 1e-9));
+  EXPECT_TRUE(equals(world->getVelocities(), generic->getVelocities(), 1e-9));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(FEATHERSTONE, INV_MASS_MATRIX_WITH_MID_CHAIN_WELD)
+{
+  // The foot hangs off the shin by a WeldJoint, and has a child of its own.
+  // Skeleton::getInvMassMatrix() used to drop the bias force coming up
+  // through the weld, so the shin and thigh columns came out wrong.
+  SkeletonPtr skel = createEveryJointSkeleton();
+  const int dofs = skel->getNumDofs();
+  SimpleFeatherstone simple;
+  simple.populateFromSkeleton(skel);
+
+  for (int j = 0; j < 5; j++)
+  {
+    Eigen::VectorXs pos = Eigen::VectorXs::Random(dofs);
+    skel->setPositions(pos);
+
+    Eigen::MatrixXs Minv = skel->getInvMassMatrix();
+    EXPECT_TRUE(equals(
+        Eigen::MatrixXs(skel->getMassMatrix() * Minv),
+        Eigen::MatrixXs(Eigen::MatrixXs::Identity(dofs, dofs)),
+        1e-9));
+
+    Eigen::VectorXs x = Eigen::VectorXs::Random(dofs);
+    Eigen::VectorXs Minvx = Eigen::VectorXs::Zero(dofs);
+    simple.inverseMassMatrixTimes(pos.data(), x.data(), Minvx.data());
+    EXPECT_TRUE(equals(Minvx, Eigen::VectorXs(Minv * x), 1e-9));
+  }
+}
+#endif
+
 /*
 template <class ConfigSpaceT>
 void GenericJoint<ConfigSpaceT>::addChildArtInertiaImplicitToDynamic(
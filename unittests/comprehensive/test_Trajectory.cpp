@@ -53,7 +53,9 @@
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/neural/WithRespectToMass.hpp"
 #include "dart/simulation/World.hpp"
+#include "dart/trajectory/AdamOptimizer.hpp"
 #include "dart/trajectory/IPOptOptimizer.hpp"
+#include "dart/trajectory/LBFGSOptimizer.hpp"
 #include "dart/trajectory/MultiShot.hpp"
 #include "dart/trajectory/Problem.hpp"
 #include "dart/trajectory/SingleShot.hpp"
@@ -1426,4 +1428,337 @@ TEST(TRAJECTORY, REOPTIMIZATION)
     record->reoptimize();
   }
 }
-#endif
\ No newline at end of file
+#endif
+#ifdef ALL_TESTS
+TEST(TRAJECTORY, SOLUTION_RETENTION)
+{
+  std::unordered_map<std::string, Eigen::MatrixXs> pos;
+  std::unordered_map<std::string, Eigen::MatrixXs> vel;
+  std::unordered_map<std::string, Eigen::MatrixXs> force;
+  std::unordered_map<std::string, Eigen::MatrixXs> metadata;
+  pos["identity"] = Eigen::MatrixXs::Random(3, 5);
+  vel["identity"] = Eigen::MatrixXs::Random(3, 5);
+  force["identity"] = Eigen::MatrixXs::Random(3, 5);
+  TrajectoryRolloutReal rollout(
+      pos, vel, force, Eigen::VectorXs::Zero(0), metadata);
+
+  // Losses bounce around, so "best" isn't the same as "most recent"
+  std::vector<s_t> losses = {9, 3, 7, 1, 8, 2, 6, 0.5, 5, 4};
+
+  Solution ring;
+  ring.setIterationRetention(IterationRetention::RING_BUFFER, 3);
+  Solution best;
+  best.setIterationRetention(IterationRetention::BEST_N, 3);
+  Solution kth;
+  kth.setIterationRetention(IterationRetention::EVERY_KTH, 4);
+  Solution streamed;
+  streamed.setIterationRetention(IterationRetention::RING_BUFFER, 0);
+  std::string path = "./solution_retention_test.bin";
+  EXPECT_TRUE(streamed.setIterationStream(path));
+
+  for (int i = 0; i < losses.size(); i++)
+  {
+    Eigen::VectorXs x = Eigen::VectorXs::Constant(4, i);
+    for (Solution* solution : {&ring, &best, &kth, &streamed})
+    {
+      solution->registerX(x);
+      solution->registerLoss(losses[i]);
+      solution->registerIteration(i, &rollout, losses[i], 0.0);
+    }
+  }
+  streamed.closeIterationStream();
+
+  EXPECT_EQ(3, ring.getNumSteps());
+  EXPECT_EQ(10, ring.getNumRegisteredSteps());
+  EXPECT_EQ(7, ring.getStep(0).index);
+  EXPECT_EQ(9, ring.getStep(2).index);
+  EXPECT_EQ(3, ring.getXs().size());
+  EXPECT_EQ(9, ring.getXs()[2](0));
+
+  EXPECT_EQ(3, best.getNumSteps());
+  std::vector<int> bestIndices;
+  for (int i = 0; i < best.getNumSteps(); i++)
+    bestIndices.push_back(best.getStep(i).index);
+  std::sort(bestIndices.begin(), bestIndices.end());
+  EXPECT_EQ(std::vector<int>({3, 5, 7}), bestIndices);
+
+  EXPECT_EQ(3, kth.getNumSteps());
+  EXPECT_EQ(0, kth.getStep(0).index);
+  EXPECT_EQ(4, kth.getStep(1).index);
+  EXPECT_EQ(8, kth.getStep(2).index);
+  EXPECT_EQ(3, kth.getLosses().size());
+
+  // Nothing is held in memory, but everything made it to disk
+  EXPECT_EQ(0, streamed.getNumSteps());
+  EXPECT_EQ(0, streamed.getXs().size());
+  std::shared_ptr<Solution> loaded = Solution::loadIterationStream(path);
+  EXPECT_EQ(10, loaded->getNumSteps());
+  EXPECT_EQ(10, loaded->getXs().size());
+  EXPECT_EQ(10, loaded->getLosses().size());
+  for (int i = 0; i < losses.size(); i++)
+  {
+    EXPECT_EQ(i, loaded->getStep(i).index);
+    EXPECT_EQ(losses[i], loaded->getStep(i).loss);
+    EXPECT_EQ(losses[i], loaded->getLosses()[i]);
+    EXPECT_TRUE(equals(
+        Eigen::VectorXs(Eigen::VectorXs::Constant(4, i)),
+        loaded->getXs()[i],
+        0));
+    EXPECT_TRUE(equals(
+        rollout.getPosesConst("identity"),
+        loaded->getStep(i).rollout->getPosesConst("identity"),
+        0));
+  }
+  std::remove(path.c_str());
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(TRAJECTORY, NATIVE_BOUNDED_OPTIMIZERS)
+{
+  for (int which = 0; which < 2; which++)
+  {
+    WorldPtr world = World::create();
+    world->setGravity(Eigen::Vector3s::Zero());
+    world->setTimeStep(0.01);
+
+    SkeletonPtr ball = Skeleton::create("ball");
+    std::pair<PrismaticJoint*, BodyNode*> pair
+        = ball->createJointAndBodyNodePair<PrismaticJoint>(nullptr);
+    pair.first->setAxis(Eigen::Vector3s::UnitX());
+    pair.second->setMass(1.0);
+    world->addSkeleton(ball);
+    world->setControlForceUpperLimits(Eigen::VectorXs::Ones(1) * 5);
+    world->setControlForceLowerLimits(Eigen::VectorXs::Ones(1) * -5);
+
+    // The goal is out of reach, so the best plan pushes as hard as the bounds
+    // allow on every step that can still move the final pose
+    TrajectoryLossFn loss = [](const TrajectoryRollout* rollout) {
+      int steps = rollout->getPosesConst().cols();
+      s_t diff = rollout->getPosesConst()(0, steps - 1) - 1.0;
+      return diff * diff;
+    };
+    SingleShot shot(world, LossFn(loss), 20, false);
+    s_t startLoss = shot.getLoss(world);
+
+    if (which == 0)
+    {
+      AdamOptimizer optimizer;
+      optimizer.setLearningRate(1.0);
+      optimizer.setIterationLimit(200);
+      optimizer.optimize(&shot);
+    }
+    else
+    {
+      LBFGSOptimizer optimizer;
+      optimizer.setLineSearchCandidates(4);
+      optimizer.setIterationLimit(50);
+      optimizer.optimize(&shot);
+    }
+
+    const Eigen::MatrixXs& forces
+        = shot.getRolloutCache(world)->getControlForcesConst();
+    EXPECT_LT(shot.getLoss(world), startLoss);
+    EXPECT_LE(forces.maxCoeff(), 5.0 + 1e-9);
+    // The force on the last step is applied after the final pose is recorded,
+    // so it gets no gradient and stays where it started
+    EXPECT_GE(forces.leftCols(forces.cols() - 1).minCoeff(), 4.9);
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(TRAJECTORY, LBFGS_REPORTS_STAGNATION)
+{
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s::Zero());
+  world->setTimeStep(0.01);
+
+  SkeletonPtr ball = Skeleton::create("ball");
+  std::pair<PrismaticJoint*, BodyNode*> pair
+      = ball->createJointAndBodyNodePair<PrismaticJoint>(nullptr);
+  pair.first->setAxis(Eigen::Vector3s::UnitX());
+  pair.second->setMass(1.0);
+  world->addSkeleton(ball);
+  world->setControlForceUpperLimits(Eigen::VectorXs::Ones(1) * 5);
+  world->setControlForceLowerLimits(Eigen::VectorXs::Ones(1) * -5);
+
+  // The gradient points the wrong way, so no step along the search direction
+  // ever lowers the loss, even once the L-BFGS history has been cleared
+  TrajectoryLossFn loss = [](const TrajectoryRollout* rollout) {
+    int steps = rollout->getPosesConst().cols();
+    s_t diff = rollout->getPosesConst()(0, steps - 1) - 1.0;
+    return diff * diff;
+  };
+  TrajectoryLossFnAndGrad wrongGrad
+      = [](const TrajectoryRollout* rollout, TrajectoryRollout* gradWrtRollout) {
+          gradWrtRollout->getPoses().setZero();
+          gradWrtRollout->getVels().setZero();
+          gradWrtRollout->getControlForces().setZero();
+          int steps = rollout->getPosesConst().cols();
+          s_t diff = rollout->getPosesConst()(0, steps - 1) - 1.0;
+          gradWrtRollout->getPoses()(0, steps - 1) = -2 * diff;
+          return diff * diff;
+        };
+  SingleShot shot(world, LossFn(loss, wrongGrad), 20, false);
+  s_t startLoss = shot.getLoss(world);
+
+  LBFGSOptimizer optimizer;
+  optimizer.setLineSearchCandidates(4);
+  optimizer.setIterationLimit(50);
+  std::shared_ptr<Solution> result = optimizer.optimize(&shot);
+  EXPECT_FALSE(result->getSuccess());
+  EXPECT_TRUE(result->getStagnated());
+  EXPECT_EQ(startLoss, shot.getLoss(world));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(TRAJECTORY, CLONES_COPY_MAPPINGS)
+{
+  WorldPtr world = World::create();
+  SkeletonPtr arm = Skeleton::create("arm");
+  std::pair<RevoluteJoint*, BodyNode*> armPair
+      = arm->createJointAndBodyNodePair<RevoluteJoint>(nullptr);
+  world->addSkeleton(arm);
+
+  std::shared_ptr<IKMapping> ikMap = std::make_shared<IKMapping>(world);
+  ikMap->addLinearBodyNode(armPair.second);
+  ikMap->setIKWarmStart(true);
+
+  // IKMapping keeps its last solution for warm starts, so clones evaluated on
+  // other threads each need their own
+  SingleShot singleShot(world, LossFn(), 8, false);
+  singleShot.addMapping("ik", ikMap);
+  MultiShot multiShot(world, LossFn(), 8, 4, false);
+  multiShot.addMapping("ik", ikMap);
+  for (Problem* problem : std::vector<Problem*>{&singleShot, &multiShot})
+  {
+    std::shared_ptr<Problem> copy = problem->clone();
+    ASSERT_NE(copy, nullptr);
+    EXPECT_NE(copy->getMapping("ik"), ikMap);
+    EXPECT_NE(copy->getMapping("identity"), problem->getMapping("identity"));
+    std::shared_ptr<IKMapping> copyMap
+        = std::dynamic_pointer_cast<IKMapping>(copy->getMapping("ik"));
+    ASSERT_NE(copyMap, nullptr);
+    EXPECT_TRUE(copyMap->getIKWarmStart());
+    EXPECT_EQ(ikMap->getPosDim(), copyMap->getPosDim());
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(TRAJECTORY, PARALLEL_JACOBIANS_MATCH_SERIAL)
+{
+  WorldPtr world = World::create();
+  world->setGravity(Eigen::Vector3s(0, -9.81, 0));
+  world->setPenetrationCorrectionEnabled(false);
+
+  // A box sliding along the floor, so every timestep has frictional contacts,
+  // with a pole swinging from it
+  SkeletonPtr box = Skeleton::create("box");
+  std::pair<TranslationalJoint2D*, BodyNode*> pair
+      = box->createJointAndBodyNodePair<TranslationalJoint2D>(nullptr);
+  TranslationalJoint2D* boxJoint = pair.first;
+  BodyNode* boxBody = pair.second;
+  boxJoint->setXYPlane();
+  std::shared_ptr<BoxShape> boxShape(
+      new BoxShape(Eigen::Vector3s(1.0, 1.0, 1.0)));
+  boxBody->createShapeNodeWith<VisualAspect, CollisionAspect>(boxShape);
+  boxBody->setFrictionCoeff(0.5);
+  boxBody->setMass(2.0);
+  BodyNode* pole = createTailSegment(boxBody, Eigen::Vector3s::UnitX());
+  RevoluteJoint* poleJoint = static_cast<RevoluteJoint*>(pole->getParentJoint());
+  world->addSkeleton(box);
+
+  SkeletonPtr floor = Skeleton::create("floor");
+  std::pair<WeldJoint*, BodyNode*> floorPair
+      = floor->createJointAndBodyNodePair<WeldJoint>(nullptr);
+  Eigen::Isometry3s floorOffset = Eigen::Isometry3s::Identity();
+  floorOffset.translation() = Eigen::Vector3s(0, -0.749, 0);
+  floorPair.first->setTransformFromParentBodyNode(floorOffset);
+  std::shared_ptr<BoxShape> floorShape(
+      new BoxShape(Eigen::Vector3s(10.0, 0.5, 10.0)));
+  floorPair.second->createShapeNodeWith<VisualAspect, CollisionAspect>(
+      floorShape);
+  floorPair.second->setFrictionCoeff(0.5);
+  world->addSkeleton(floor);
+
+  box->setVelocity(0, 1.0);
+
+  // Make sure the timesteps really get spread across several clones, even on a
+  // single core machine
+  world->setNumFiniteDifferenceWorkers(3);
+
+  // The loss reads the bodies through an IK mapping
+  TrajectoryLossFn loss = [](const TrajectoryRollout* rollout) {
+    const Eigen::Ref<const Eigen::MatrixXs> poses
+        = rollout->getPosesConst("ik");
+    const Eigen::Ref<const Eigen::MatrixXs> vels
+        = rollout->getVelsConst("ik");
+    int last = poses.cols() - 1;
+    return (s_t)(poses(0, last) * poses(0, last) + vels.squaredNorm());
+  };
+  TrajectoryLossFnAndGrad lossGrad
+      = [](const TrajectoryRollout* rollout, TrajectoryRollout* gradWrtRollout) {
+          gradWrtRollout->getPoses("ik").setZero();
+          gradWrtRollout->getVels("ik").setZero();
+          gradWrtRollout->getControlForces("ik").setZero();
+          const Eigen::Ref<const Eigen::MatrixXs> poses
+              = rollout->getPosesConst("ik");
+          const Eigen::Ref<const Eigen::MatrixXs> vels
+              = rollout->getVelsConst("ik");
+          int last = poses.cols() - 1;
+          gradWrtRollout->getPoses("ik")(0, last) = 2 * poses(0, last);
+          gradWrtRollout->getVels("ik") = 2 * vels;
+          return (s_t)(poses(0, last) * poses(0, last) + vels.squaredNorm());
+        };
+  std::shared_ptr<IKMapping> ikMap = std::make_shared<IKMapping>(world);
+  ikMap->addLinearBodyNode(boxBody);
+  ikMap->addLinearBodyNode(pole);
+
+  const int steps = 12;
+  Eigen::VectorXs flatForces = Eigen::VectorXs::LinSpaced(3 * steps, -2, 2);
+  Eigen::MatrixXs forces = Eigen::Map<Eigen::MatrixXs>(
+      flatForces.data(), 3, steps);
+  Eigen::VectorXs grads[3];
+  Eigen::MatrixXs jacs[3];
+  // The first pass builds the pool. The clones then have to pick up the
+  // property changes below before the last pass is run on them.
+  for (int pass = 0; pass < 3; pass++)
+  {
+    bool parallel = pass != 1;
+    if (pass == 1)
+    {
+      boxBody->setFrictionCoeff(0.8);
+      boxJoint->setDampingCoefficient(0, 0.7);
+      poleJoint->setSpringStiffness(0, 3.0);
+      pole->setMomentOfInertia(0.1, 0.1, 0.1);
+      world->setGravity(Eigen::Vector3s(0, -5.0, 0));
+    }
+
+    SingleShot shot(world, LossFn(loss, lossGrad), steps, true);
+    shot.addMapping("ik", ikMap);
+    shot.setParallelOperationsEnabled(parallel);
+    shot.setControlForcesRaw(forces);
+
+    int dim = shot.getFlatProblemDim(world);
+    grads[pass] = Eigen::VectorXs::Zero(dim);
+    shot.backpropGradient(world, grads[pass]);
+    // This is the Jacobian MultiShot chains into its knot constraints
+    jacs[pass] = Eigen::MatrixXs::Zero(2 * world->getNumDofs(), dim);
+    shot.backpropJacobianOfFinalState(world, jacs[pass]);
+
+    // Make sure we actually exercised contact
+    std::vector<MappedBackpropSnapshotPtr> snapshots
+        = shot.getSnapshots(world);
+    EXPECT_GT(
+        snapshots[0]->getUnderlyingSnapshot()->getNumClamping()
+            + snapshots[0]->getUnderlyingSnapshot()->getNumUpperBound(),
+        0);
+  }
+
+  EXPECT_TRUE(equals(grads[1], grads[2], 1e-12));
+  EXPECT_TRUE(equals(jacs[1], jacs[2], 1e-12));
+}
+#endif
@@ -30,11 +30,15 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 #include "dart/common/common.hpp"
 #include "dart/constraint/constraint.hpp"
 #include "dart/dynamics/dynamics.hpp"
+#include "dart/neural/BackpropSnapshot.hpp"
+#include "dart/neural/NeuralUtils.hpp"
 #include "dart/simulation/World.hpp"
 
 #include "TestHelpers.hpp"
@@ -109,3 +113,169 @@ TEST(ContactConstraint, ContactWithKinematicJoint)
       std::make_shared<constraint::PgsBoxedLcpSolver>(), 1e-4);
 #endif
 }
+
+//==============================================================================
+class ExposedContactConstraintSolver
+  : public constraint::BoxedLcpConstraintSolver
+{
+public:
+  using constraint::BoxedLcpConstraintSolver::BoxedLcpConstraintSolver;
+
+  const std::vector<constraint::ContactConstraintPtr>& getContactConstraints()
+  {
+    return mContactConstraints;
+  }
+};
+
+//==============================================================================
+/// Drops a box onto a welded ground plate, sliding sideways so that friction
+/// is involved, and returns the solver so tests can peek at its constraints
+ExposedContactConstraintSolver* createSlidingBoxWorld(
+    const std::shared_ptr<simulation::World>& world)
+{
+  auto solver = std::make_unique<ExposedContactConstraintSolver>(
+      std::make_shared<constraint::DantzigBoxedLcpSolver>());
+  ExposedContactConstraintSolver* rawSolver = solver.get();
+  world->setConstraintSolver(std::move(solver));
+
+  auto ground = dynamics::Skeleton::create("ground");
+  auto groundBody
+      = ground->createJointAndBodyNodePair<dynamics::WeldJoint>().second;
+  groundBody->createShapeNodeWith<VisualAspect, CollisionAspect, DynamicsAspect>(
+      std::make_shared<dynamics::BoxShape>(Eigen::Vector3s(4.0, 4.0, 1.0)));
+
+  auto box = dynamics::Skeleton::create("box");
+  auto boxBody
+      = box->createJointAndBodyNodePair<dynamics::FreeJoint>().second;
+  boxBody->createShapeNodeWith<VisualAspect, CollisionAspect, DynamicsAspect>(
+      std::make_shared<dynamics::BoxShape>(Eigen::Vector3s(0.5, 0.5, 0.5)));
+  box->setPosition(5, 0.75);
+  box->setVelocity(3, 0.1);
+
+  world->addSkeleton(ground);
+  world->addSkeleton(box);
+  return rawSolver;
+}
+
+//==============================================================================
+/// Counts how many of the solver's current contact constraints are the same
+/// objects as were in `previous`, and checks each of them is warm started
+std::size_t countReusedConstraints(
+    ExposedContactConstraintSolver* solver,
+    const std::vector<const constraint::ContactConstraint*>& previous)
+{
+  std::size_t numReused = 0;
+  for (const auto& constraint : solver->getContactConstraints())
+  {
+    if (std::find(previous.begin(), previous.end(), constraint.get())
+        == previous.end())
+      continue;
+    numReused++;
+
+    s_t lambda[3];
+    EXPECT_TRUE(constraint->getWarmStartImpulse(lambda));
+    EXPECT_GE(lambda[0], 0.0);
+  }
+  return numReused;
+}
+
+//==============================================================================
+TEST(ContactConstraint, ReusedAcrossSteps)
+{
+  auto world = std::make_shared<simulation::World>();
+  ExposedContactConstraintSolver* solver = createSlidingBoxWorld(world);
+
+  // Let the box settle onto the ground
+  for (auto i = 0u; i < 20; ++i)
+    world->step();
+
+  std::vector<const constraint::ContactConstraint*> previous;
+  for (const auto& constraint : solver->getContactConstraints())
+    previous.push_back(constraint.get());
+  ASSERT_FALSE(previous.empty());
+
+  world->step();
+
+  // Every contact that persisted should be served by one of last step's
+  // objects, which remembers the impulse it applied pushing the box up
+  EXPECT_EQ(
+      countReusedConstraints(solver, previous),
+      std::min(previous.size(), solver->getContactConstraints().size()));
+}
+
+//==============================================================================
+TEST(ContactConstraint, ReusedAcrossStepsWithGradients)
+{
+  auto world = std::make_shared<simulation::World>();
+  ExposedContactConstraintSolver* solver = createSlidingBoxWorld(world);
+  solver->setGradientEnabled(true);
+
+  // Hold on to every snapshot, which keeps references to the constraints
+  std::vector<std::shared_ptr<neural::BackpropSnapshot>> snapshots;
+  for (auto i = 0u; i < 20; ++i)
+    snapshots.push_back(neural::forwardPass(world));
+
+  std::vector<const constraint::ContactConstraint*> previous;
+  for (const auto& constraint : solver->getContactConstraints())
+    previous.push_back(constraint.get());
+  ASSERT_FALSE(previous.empty());
+
+  snapshots.push_back(neural::forwardPass(world));
+
+  EXPECT_EQ(
+      countReusedConstraints(solver, previous),
+      std::min(previous.size(), solver->getContactConstraints().size()));
+}
+
+//==============================================================================
+TEST(ContactConstraint, PoolingDoesNotChangeGradients)
+{
+  std::vector<std::shared_ptr<simulation::World>> worlds;
+  for (bool pooling : {true, false})
+  {
+    auto world = std::make_shared<simulation::World>();
+    createSlidingBoxWorld(world)->setContactConstraintPoolingEnabled(pooling);
+    worlds.push_back(world);
+  }
+
+  // Take all the steps first, so the pooled constraints behind the early
+  // snapshots have been reset for later contacts by the time we ask for
+  // Jacobians
+  std::vector<std::vector<std::shared_ptr<neural::BackpropSnapshot>>> snapshots(
+      worlds.size());
+  for (auto i = 0u; i < 25; ++i)
+  {
+    for (std::size_t w = 0; w < worlds.size(); w++)
+      snapshots[w].push_back(neural::forwardPass(worlds[w]));
+  }
+  EXPECT_TRUE(worlds[0]->getPositions() == worlds[1]->getPositions());
+  EXPECT_TRUE(worlds[0]->getVelocities() == worlds[1]->getVelocities());
+
+  for (std::size_t i = 0; i < snapshots[0].size(); i++)
+  {
+    std::vector<Eigen::MatrixXs> jacobians[2];
+    for (std::size_t w = 0; w < worlds.size(); w++)
+    {
+      const std::shared_ptr<simulation::World>& world = worlds[w];
+      const std::shared_ptr<neural::BackpropSnapshot>& snapshot
+          = snapshots[w][i];
+      world->setPositions(snapshot->getPreStepPosition());
+      world->setVelocities(snapshot->getPreStepVelocity());
+      world->setControlForces(snapshot->getPreStepTorques());
+      world->setCachedLCPSolution(snapshot->getPreStepLCPCache());
+
+      jacobians[w].push_back(snapshot->getPosPosJacobian(world));
+      jacobians[w].push_back(snapshot->getPosVelJacobian(world));
+      jacobians[w].push_back(snapshot->getVelPosJacobian(world));
+      jacobians[w].push_back(snapshot->getVelVelJacobian(world));
+      jacobians[w].push_back(snapshot->getControlForceVelJacobian(world));
+    }
+    for (std::size_t j = 0; j < jacobians[0].size(); j++)
+    {
+      // Bit-for-bit, not within a tolerance
+      EXPECT_TRUE(jacobians[0][j] == jacobians[1][j])
+          << "Step " << i << ", Jacobian " << j << " differs with pooling:\n"
+          << jacobians[0][j] - jacobians[1][j];
+    }
+  }
+}
@@ -9,6 +9,9 @@
 
 #include "dart/collision/CollisionResult.hpp"
 #include "dart/collision/dart/DARTCollide.hpp"
+#include "dart/collision/dart/DARTCollisionDetector.hpp"
+#include "dart/dynamics/HeightmapShape.hpp"
+#include "dart/dynamics/SimpleFrame.hpp"
 #include "dart/neural/RestorableSnapshot.hpp"
 #include "dart/realtime/Ticker.hpp"
 #include "dart/server/GUIWebsocketServer.hpp"
@@ -4479,4 +4482,110 @@ TEST(DARTCollide, ATLAS_5)
   }
 }
 // #endif
-*/
\ No newline at end of file
+*/
+#ifdef ALL_TESTS
+TEST(DARTCollide, HEIGHTMAP_SPHERE_AND_BOX_COLLISION)
+{
+  auto cd = DARTCollisionDetector::create();
+
+  // A flat 4m x 4m patch of terrain, with cells 0.5m on a side
+  auto terrain = std::make_shared<dynamics::HeightmapShaped>();
+  terrain->setScale(Eigen::Vector3s(0.5, 0.5, 1.0));
+  terrain->setHeightField(dynamics::HeightmapShaped::HeightField::Zero(9, 9));
+  auto terrainFrame
+      = dynamics::SimpleFrame::createShared(dynamics::Frame::World());
+  terrainFrame->setShape(terrain);
+
+  auto sphereFrame
+      = dynamics::SimpleFrame::createShared(dynamics::Frame::World());
+  sphereFrame->setShape(std::make_shared<dynamics::SphereShape>(0.5));
+  // Sink it less than the default contact clipping depth
+  sphereFrame->setTranslation(Eigen::Vector3s(0.3, 0.2, 0.48));
+
+  auto group = cd->createCollisionGroup(terrainFrame.get(), sphereFrame.get());
+
+  CollisionOption option;
+  CollisionResult result;
+  EXPECT_TRUE(group->collide(option, &result));
+  EXPECT_GE(result.getNumContacts(), 1u);
+  for (const Contact& contact : result.getContacts())
+  {
+    // Normals point from the sphere (o2) to the terrain (o1)
+    EXPECT_TRUE(equals(
+        contact.normal, Eigen::Vector3s(-Eigen::Vector3s::UnitZ()), 1e-6));
+    EXPECT_NEAR(static_cast<double>(contact.penetrationDepth), 0.02, 1e-4);
+  }
+
+  // Hovering above the terrain
+  result.clear();
+  sphereFrame->setTranslation(Eigen::Vector3s(0.3, 0.2, 0.6));
+  EXPECT_FALSE(group->collide(option, &result));
+
+  // Off the edge of the grid
+  result.clear();
+  sphereFrame->setTranslation(Eigen::Vector3s(5.0, 0.0, 0.48));
+  EXPECT_FALSE(group->collide(option, &result));
+
+  // A box resting slightly into the terrain, straddling several cells
+  auto boxFrame = dynamics::SimpleFrame::createShared(dynamics::Frame::World());
+  boxFrame->setShape(
+      std::make_shared<dynamics::BoxShape>(Eigen::Vector3s(0.8, 0.8, 0.4)));
+  boxFrame->setTranslation(Eigen::Vector3s(-0.1, 0.1, 0.19));
+  auto boxGroup = cd->createCollisionGroup(boxFrame.get(), terrainFrame.get());
+
+  result.clear();
+  EXPECT_TRUE(boxGroup->collide(option, &result));
+  for (const Contact& contact : result.getContacts())
+  {
+    // Now the terrain is o2, so normals point up into the box
+    EXPECT_TRUE(equals(
+        contact.normal, Eigen::Vector3s(Eigen::Vector3s::UnitZ()), 1e-6));
+    EXPECT_GT(static_cast<double>(contact.penetrationDepth), 0.0);
+    EXPECT_LT(static_cast<double>(contact.penetrationDepth), 0.02);
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(DARTCollide, HEIGHTMAP_BOX_ACROSS_CELL_BOUNDARY)
+{
+  auto cd = DARTCollisionDetector::create();
+
+  auto terrain = std::make_shared<dynamics::HeightmapShaped>();
+  terrain->setScale(Eigen::Vector3s(0.5, 0.5, 1.0));
+  terrain->setHeightField(dynamics::HeightmapShaped::HeightField::Zero(9, 9));
+  auto terrainFrame
+      = dynamics::SimpleFrame::createShared(dynamics::Frame::World());
+  terrainFrame->setShape(terrain);
+
+  // The box sinks 0.01 into the terrain, and its edges poke 0.005 past the
+  // cell lines at x = 0.5 and y = -0.5. Those are shallower than the
+  // penetration, so the walls of the neighboring cells' prisms are the
+  // closest way out for the corners that poke past.
+  auto boxFrame = dynamics::SimpleFrame::createShared(dynamics::Frame::World());
+  boxFrame->setShape(
+      std::make_shared<dynamics::BoxShape>(Eigen::Vector3s(0.8, 0.8, 0.4)));
+  boxFrame->setTranslation(Eigen::Vector3s(0.105, -0.105, 0.19));
+
+  CollisionOption option;
+  for (int order = 0; order < 2; order++)
+  {
+    dynamics::SimpleFrame* first = order == 0 ? boxFrame.get()
+                                              : terrainFrame.get();
+    dynamics::SimpleFrame* second = order == 0 ? terrainFrame.get()
+                                               : boxFrame.get();
+    auto group = cd->createCollisionGroup(first, second);
+    // Normals point from o2 to o1
+    const Eigen::Vector3s up = order == 0 ? 1.0 * Eigen::Vector3s::UnitZ()
+                                          : -1.0 * Eigen::Vector3s::UnitZ();
+    CollisionResult result;
+    EXPECT_TRUE(group->collide(option, &result));
+    EXPECT_GE(result.getNumContacts(), 4u);
+    for (const Contact& contact : result.getContacts())
+    {
+      EXPECT_TRUE(equals(contact.normal, up, 1e-6));
+      EXPECT_NEAR(static_cast<double>(contact.penetrationDepth), 0.01, 1e-4);
+    }
+  }
+}
+#endif
@@ -0,0 +1,254 @@
+#include <iostream>
+#include <string>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/math/Dual.hpp"
+
+#include "TestHelpers.hpp"
+
+using namespace dart;
+using namespace dart::math;
+
+#define ALL_TESTS
+
+namespace {
+
+typedef Dual<4> Dual4;
+typedef Eigen::Matrix<Dual4, Eigen::Dynamic, 1> VectorXd4;
+typedef Eigen::Matrix<Dual4, Eigen::Dynamic, Eigen::Dynamic> MatrixXd4;
+
+/// This checks the tangent of `f` at `x` against a central difference
+template <typename F>
+void expectDerivative(F f, double x, double tol = 1e-7)
+{
+  const double eps = 1e-6;
+  double fd = (static_cast<double>(f(Dual4(x + eps)))
+               - static_cast<double>(f(Dual4(x - eps))))
+              / (2 * eps);
+  Dual4 result = f(Dual4::variable(x, 2));
+  EXPECT_NEAR(result.tangent(2), fd, tol);
+  EXPECT_EQ(result.tangent(0), 0.0);
+}
+
+} // namespace
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, ELEMENTARY_FUNCTIONS)
+{
+  expectDerivative([](const Dual4& x) { return x * x * x - 2.0 * x; }, 0.7);
+  expectDerivative([](const Dual4& x) { return 1.0 / (x + 3.0); }, 0.7);
+  expectDerivative([](const Dual4& x) { return sqrt(x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return sin(x) * cos(x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return tan(x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return asin(x) + acos(x / 2); }, 0.3);
+  expectDerivative([](const Dual4& x) { return atan(x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return atan2(x, 1.0 - x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return exp(x) * log(x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return pow(x, 2.5); }, 0.7);
+  expectDerivative([](const Dual4& x) { return pow(x, x); }, 0.7);
+  expectDerivative([](const Dual4& x) { return abs(x - 1.0); }, 0.7);
+  expectDerivative([](const Dual4& x) { return tanh(x); }, 0.7);
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, SINGULAR_POINTS_KEEP_TANGENTS_FINITE)
+{
+  // Taking the norm of a zero vector is sqrt(0), whose derivative is infinite
+  Eigen::Matrix<Dual4, 3, 1> zero = Eigen::Matrix<Dual4, 3, 1>::Zero();
+  Dual4 norm = zero.norm();
+  EXPECT_EQ(norm.value(), 0.0);
+  EXPECT_TRUE(norm.tangent().isZero(0));
+
+  // Same with a variable along another lane, which has a zero tangent here
+  Eigen::Matrix<Dual4, 3, 1> moving = Eigen::Matrix<Dual4, 3, 1>::Zero();
+  moving(0) = Dual4::variable(0.0, 1);
+  EXPECT_TRUE(moving.norm().tangent().allFinite());
+
+  EXPECT_TRUE(cbrt(Dual4(0.0)).tangent().isZero(0));
+  EXPECT_TRUE(asin(Dual4(1.0)).tangent().isZero(0));
+  EXPECT_TRUE(acos(Dual4(-1.0)).tangent().isZero(0));
+  EXPECT_TRUE(sqrt(Dual4::variable(0.0, 2)).tangent().allFinite());
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, COMPARISONS_USE_VALUES)
+{
+  Dual4 a = Dual4::variable(1.0, 0);
+  Dual4 b(2.0);
+  EXPECT_TRUE(a < b);
+  EXPECT_TRUE(a < 1.5);
+  EXPECT_TRUE(0.5 < a);
+  EXPECT_TRUE(a == 1.0);
+  EXPECT_EQ(max(a, b).value(), 2.0);
+  EXPECT_EQ(min(a, b).tangent(0), 1.0);
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, EIGEN_JACOBIAN_VECTOR_PRODUCTS)
+{
+  // f(x) = A^{-1} * (x .* x), so J = A^{-1} * diag(2x)
+  const int n = 6;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(n, n);
+  A += n * Eigen::MatrixXd::Identity(n, n);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(n);
+  Eigen::Matrix<double, Eigen::Dynamic, 4> directions
+      = Eigen::Matrix<double, Eigen::Dynamic, 4>::Random(n, 4);
+
+  VectorXd4 dualX = seedDuals<4>(x, directions);
+  MatrixXd4 dualA = A.cast<Dual4>();
+  VectorXd4 dualResult
+      = dualA.partialPivLu().solve(VectorXd4(dualX.cwiseProduct(dualX)));
+
+  Eigen::MatrixXd J = A.inverse() * (2 * x).asDiagonal();
+  Eigen::MatrixXd expectedTangents = J * directions;
+  Eigen::VectorXd expectedValues = A.inverse() * x.cwiseProduct(x);
+
+  Eigen::MatrixXd tangents = dualTangents<4>(dualResult);
+  Eigen::VectorXd values = dualValues<4>(dualResult);
+  EXPECT_TRUE(equals(tangents, expectedTangents, 1e-10));
+  EXPECT_TRUE(equals(values, expectedValues, 1e-10));
+
+  // Mixing doubles into dual expressions shouldn't need any casts
+  VectorXd4 scaled = dualX * 2.0;
+  EXPECT_EQ(scaled(0).value(), 2.0 * x(0));
+  EXPECT_EQ(scaled(0).tangent(1), 2.0 * directions(0, 1));
+}
+#endif
+
+#ifdef DART_USE_DUAL_NUMBERS
+namespace {
+
+/// This builds a planar three link pendulum, with links that aren't aligned
+/// with their joints so the mass matrix has off-diagonal terms
+dynamics::SkeletonPtr createDualPendulum()
+{
+  dynamics::SkeletonPtr skel = dynamics::Skeleton::create("pendulum");
+  dynamics::BodyNode* parent = nullptr;
+  for (int i = 0; i < 3; i++)
+  {
+    dynamics::RevoluteJoint::Properties jointProps;
+    jointProps.mName = "joint_" + std::to_string(i);
+    jointProps.mAxis = Eigen::Vector3s::UnitZ();
+    if (parent != nullptr)
+      jointProps.mT_ParentBodyToJoint.translation()
+          = Eigen::Vector3s(0, -1.0, 0);
+    dynamics::BodyNode::Properties bodyProps;
+    bodyProps.mName = "link_" + std::to_string(i);
+    bodyProps.mInertia.setMass(1.0 + 0.5 * i);
+    bodyProps.mInertia.setLocalCOM(Eigen::Vector3s(0.2, -0.5, 0));
+    parent = skel->createJointAndBodyNodePair<dynamics::RevoluteJoint>(
+                     parent, jointProps, bodyProps)
+                 .second;
+  }
+  return skel;
+}
+
+/// This runs forward dynamics at the given (plain double) state
+Eigen::VectorXd forwardDynamics(
+    const dynamics::SkeletonPtr& skel,
+    const Eigen::VectorXd& q,
+    const Eigen::VectorXd& dq,
+    const Eigen::VectorXd& tau)
+{
+  skel->setPositions(q.cast<s_t>());
+  skel->setVelocities(dq.cast<s_t>());
+  skel->setControlForces(tau.cast<s_t>());
+  skel->computeForwardDynamics();
+  return dualValues<DART_DUAL_NUMBER_LANES>(skel->getAccelerations());
+}
+
+} // namespace
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, SKELETON_MASS_MATRIX_TANGENTS)
+{
+  const int lanes = DART_DUAL_NUMBER_LANES;
+  dynamics::SkeletonPtr skel = createDualPendulum();
+  Eigen::VectorXd q(3);
+  q << 0.3, -0.7, 1.1;
+  Eigen::Matrix<double, Eigen::Dynamic, lanes> directions
+      = Eigen::Matrix<double, Eigen::Dynamic, lanes>::Random(3, lanes);
+
+  skel->setPositions(seedDuals<lanes>(q, directions));
+  Eigen::MatrixXs M = skel->getMassMatrix();
+
+  const double eps = 1e-6;
+  for (int lane = 0; lane < lanes; lane++)
+  {
+    Eigen::VectorXd dq = eps * directions.col(lane);
+    skel->setPositions((q + dq).cast<s_t>());
+    Eigen::MatrixXs plus = skel->getMassMatrix();
+    skel->setPositions((q - dq).cast<s_t>());
+    Eigen::MatrixXs minus = skel->getMassMatrix();
+
+    Eigen::MatrixXd tangent(3, 3);
+    Eigen::MatrixXd fd(3, 3);
+    for (int row = 0; row < 3; row++)
+    {
+      for (int col = 0; col < 3; col++)
+      {
+        tangent(row, col) = M(row, col).tangent(lane);
+        fd(row, col) = (plus(row, col).value() - minus(row, col).value())
+                       / (2 * eps);
+      }
+    }
+    EXPECT_TRUE(equals(tangent, fd, 1e-7));
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(DUAL_NUMBERS, SKELETON_FORWARD_DYNAMICS_JVP)
+{
+  // A single forward dynamics pass on dual positions and velocities gives the
+  // Jacobian-vector products of the accelerations along every seeded lane
+  const int lanes = DART_DUAL_NUMBER_LANES;
+  dynamics::SkeletonPtr skel = createDualPendulum();
+  Eigen::VectorXd q(3);
+  q << 0.3, -0.7, 1.1;
+  Eigen::VectorXd dq(3);
+  dq << -0.4, 0.9, 0.2;
+  Eigen::VectorXd tau(3);
+  tau << 0.5, -1.0, 0.25;
+  Eigen::Matrix<double, Eigen::Dynamic, lanes> posDirections
+      = Eigen::Matrix<double, Eigen::Dynamic, lanes>::Random(3, lanes);
+  Eigen::Matrix<double, Eigen::Dynamic, lanes> velDirections
+      = Eigen::Matrix<double, Eigen::Dynamic, lanes>::Random(3, lanes);
+
+  skel->setPositions(seedDuals<lanes>(q, posDirections));
+  skel->setVelocities(seedDuals<lanes>(dq, velDirections));
+  skel->setControlForces(tau.cast<s_t>());
+  skel->computeForwardDynamics();
+  Eigen::VectorXs ddq = skel->getAccelerations();
+  Eigen::Matrix<double, Eigen::Dynamic, lanes> tangents
+      = dualTangents<lanes>(ddq);
+
+  const double eps = 1e-6;
+  for (int lane = 0; lane < lanes; lane++)
+  {
+    Eigen::VectorXd fd
+        = (forwardDynamics(
+               skel,
+               q + eps * posDirections.col(lane),
+               dq + eps * velDirections.col(lane),
+               tau)
+           - forwardDynamics(
+               skel,
+               q - eps * posDirections.col(lane),
+               dq - eps * velDirections.col(lane),
+               tau))
+          / (2 * eps);
+    Eigen::VectorXd tangent = tangents.col(lane);
+    EXPECT_TRUE(equals(tangent, fd, 1e-6));
+  }
+}
+#endif
+#endif
@@ -757,4 +757,134 @@ TEST(LCP_UTILS, BLOCK_SYMMETRIC_CASE)
   std::cout << "filtered x:" << std::endl << fx << std::endl;
   std::cout << "A * fx:" << std::endl << A * fx << std::endl;
 }
-#endif
\ No newline at end of file
+#endif
+#ifdef ALL_TESTS
+TEST(LCP_UTILS, GROUP_NEAR_DUPLICATES_MATCHES_BRUTE_FORCE)
+{
+  srand(42);
+  const s_t threshold = 1e-4;
+  const int dim = 4;
+
+  // Scatter some clusters of points, each within threshold of its center, so
+  // that plenty of near-duplicates straddle the boundaries between hash cells
+  Eigen::MatrixXs signatures = Eigen::MatrixXs::Zero(dim, 200);
+  Eigen::MatrixXs centers = Eigen::MatrixXs::Random(dim, 20) * 0.05;
+  for (int i = 0; i < signatures.cols(); i++)
+  {
+    Eigen::VectorXs offset = Eigen::VectorXs::Random(dim);
+    offset *= 0.004;
+    signatures.col(i) = centers.col(rand() % centers.cols()) + offset;
+  }
+  Eigen::VectorXi classes = Eigen::VectorXi::Zero(signatures.cols());
+  for (int i = 0; i < classes.size(); i++)
+  {
+    classes(i) = i % 3 == 0 ? 1 : 0;
+  }
+
+  Eigen::VectorXi groups
+      = LCPUtils::groupNearDuplicates(signatures, threshold, classes);
+
+  // Compare against checking every earlier representative
+  Eigen::VectorXi expected = Eigen::VectorXi::Constant(classes.size(), -1);
+  std::vector<int> representatives;
+  for (int i = 0; i < signatures.cols(); i++)
+  {
+    for (int r = 0; r < (int)representatives.size(); r++)
+    {
+      int j = representatives[r];
+      if (classes(i) == classes(j)
+          && (signatures.col(i) - signatures.col(j)).squaredNorm() < threshold)
+      {
+        expected(i) = r;
+        break;
+      }
+    }
+    if (expected(i) == -1)
+    {
+      expected(i) = representatives.size();
+      representatives.push_back(i);
+    }
+  }
+
+  EXPECT_TRUE(expected.maxCoeff() + 1 < signatures.cols());
+  EXPECT_TRUE(equals(expected, groups));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(LCP_UTILS, REDUCE_MANY_DUPLICATE_CONTACTS)
+{
+  srand(42);
+  // A mesh resting on the ground produces lots of nearly identical contacts.
+  // Here we've got 30 copies of one contact, and one other contact, each with
+  // a normal and two friction directions.
+  const int numCopies = 30;
+  const int n = (numCopies + 1) * 3;
+  Eigen::MatrixXs contactJac = Eigen::MatrixXs::Random(3, 6);
+  Eigen::MatrixXs otherJac = Eigen::MatrixXs::Random(3, 6);
+  Eigen::MatrixXs J = Eigen::MatrixXs::Zero(n, 6);
+  Eigen::VectorXs b = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs hi = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXs lo = Eigen::VectorXs::Zero(n);
+  Eigen::VectorXi fIndex = Eigen::VectorXi::Zero(n);
+  for (int c = 0; c <= numCopies; c++)
+  {
+    if (c < numCopies)
+    {
+      J.block(c * 3, 0, 3, 6) = contactJac;
+      b.segment(c * 3, 3) << 1.0, 0.1, -0.1;
+    }
+    else
+    {
+      J.block(c * 3, 0, 3, 6) = otherJac;
+      b.segment(c * 3, 3) << 0.5, 0.0, 0.2;
+    }
+    hi.segment(c * 3, 3) << std::numeric_limits<s_t>::infinity(), 1.0, 1.0;
+    lo.segment(c * 3, 3) << 0.0, -1.0, -1.0;
+    fIndex.segment(c * 3, 3) << -1, c * 3, c * 3;
+  }
+  Eigen::MatrixXs A = J * J.transpose();
+  Eigen::VectorXs x = Eigen::VectorXs::Zero(n);
+
+  Eigen::MatrixXs reducedA = A;
+  Eigen::VectorXs reducedX = x;
+  Eigen::VectorXs reducedB = b;
+  Eigen::VectorXs reducedHi = hi;
+  Eigen::VectorXs reducedLo = lo;
+  Eigen::VectorXi reducedFIndex = fIndex;
+  Eigen::MatrixXs mapOut = LCPUtils::reduce(
+      reducedA, reducedX, reducedB, reducedHi, reducedLo, reducedFIndex);
+
+  EXPECT_EQ(6, reducedX.size());
+  Eigen::VectorXi expectedFIndex = Eigen::VectorXi::Zero(6);
+  expectedFIndex << -1, 0, 0, -1, 3, 3;
+  EXPECT_TRUE(equals(expectedFIndex, reducedFIndex));
+
+  // Every copy of the contact should map to the same reduced column, and the
+  // merged columns of A should account for all the copies
+  for (int i = 0; i < n; i++)
+  {
+    int group = i < numCopies * 3 ? i % 3 : 3 + i % 3;
+    Eigen::VectorXs expectedRow = Eigen::VectorXs::Zero(6);
+    expectedRow(group) = 1.0;
+    Eigen::VectorXs row = mapOut.row(i).transpose();
+    EXPECT_TRUE(equals(expectedRow, row));
+  }
+  Eigen::MatrixXs expectedA = A * mapOut;
+  Eigen::MatrixXs expectedReducedA = Eigen::MatrixXs::Zero(6, 6);
+  for (int i = 0; i < 6; i++)
+  {
+    int original = i < 3 ? i : numCopies * 3 + i - 3;
+    expectedReducedA.row(i) = expectedA.row(original);
+  }
+  EXPECT_TRUE(equals(expectedReducedA, reducedA, 1e-8));
+
+  // Solving the reduced problem solves the original one
+  Eigen::VectorXs reducedSolution = Eigen::VectorXs::Zero(6);
+  reducedSolution << 1.0, 0.2, -0.3, 0.5, 0.0, 0.1;
+  Eigen::VectorXs v = A * (mapOut * reducedSolution) - b;
+  Eigen::VectorXs reducedV = reducedA * reducedSolution - reducedB;
+  Eigen::VectorXs expectedV = mapOut * reducedV;
+  EXPECT_TRUE(equals(expectedV, v, 1e-8));
+}
+#endif
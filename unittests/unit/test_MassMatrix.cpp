@@ -0,0 +1,304 @@
+#include <iostream>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+#include "dart/dynamics/BallJoint.hpp"
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/FreeJoint.hpp"
+#include "dart/dynamics/RevoluteJoint.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/dynamics/UniversalJoint.hpp"
+#include "dart/dynamics/WeldJoint.hpp"
+#include "dart/math/Random.hpp"
+
+#include "TestHelpers.hpp"
+
+using namespace dart;
+using namespace dart::dynamics;
+
+#define ALL_TESTS
+
+namespace {
+
+Eigen::Isometry3s randomOffset()
+{
+  Eigen::Isometry3s T = Eigen::Isometry3s::Identity();
+  T.linear() = math::expMapRot(Eigen::Vector3s::Random());
+  T.translation() = Eigen::Vector3s::Random();
+  return T;
+}
+
+template <typename JointType>
+BodyNode* addRandomBody(SkeletonPtr skel, BodyNode* parent)
+{
+  auto pair = skel->createJointAndBodyNodePair<JointType>(parent);
+  pair.first->setTransformFromParentBodyNode(randomOffset());
+  pair.first->setTransformFromChildBodyNode(randomOffset());
+
+  // Random, but physically valid, spatial inertia with an offset COM
+  s_t mass = 0.5 + math::Random::uniform(0.0, 2.0);
+  Eigen::Vector3s moments = Eigen::Vector3s::Random().cwiseAbs()
+                            + Eigen::Vector3s::Constant(0.1);
+  Eigen::Matrix3s moment = moments.asDiagonal();
+  moment(0, 1) = moment(1, 0) = 0.01;
+  moment(0, 2) = moment(2, 0) = 0.02;
+  moment(1, 2) = moment(2, 1) = 0.03;
+  dynamics::Inertia inertia(mass, Eigen::Vector3s::Random() * 0.2, moment);
+  pair.second->setInertia(inertia);
+  return pair.second;
+}
+
+/// This builds a branching, floating base tree with a mix of multi-DOF,
+/// single DOF, and zero DOF joints, roughly shaped like a humanoid
+SkeletonPtr createRandomHumanoid()
+{
+  SkeletonPtr skel = Skeleton::create("humanoid");
+  BodyNode* pelvis = addRandomBody<FreeJoint>(skel, nullptr);
+  BodyNode* torso = addRandomBody<BallJoint>(skel, pelvis);
+  BodyNode* head = addRandomBody<WeldJoint>(skel, torso);
+  addRandomBody<RevoluteJoint>(skel, head);
+  for (int side = 0; side < 2; side++)
+  {
+    BodyNode* shoulder = addRandomBody<BallJoint>(skel, torso);
+    BodyNode* elbow = addRandomBody<RevoluteJoint>(skel, shoulder);
+    addRandomBody<UniversalJoint>(skel, elbow);
+
+    BodyNode* hip = addRandomBody<BallJoint>(skel, pelvis);
+    BodyNode* knee = addRandomBody<RevoluteJoint>(skel, hip);
+    BodyNode* ankle = addRandomBody<UniversalJoint>(skel, knee);
+    addRandomBody<WeldJoint>(skel, ankle);
+  }
+  return skel;
+}
+
+/// This runs inverse dynamics with zero accelerations, which leaves exactly
+/// the Coriolis and gravity forces in the joints
+Eigen::VectorXs coriolisAndGravityFromInverseDynamics(SkeletonPtr skel)
+{
+  Eigen::VectorXs accelerations = skel->getAccelerations();
+  skel->setAccelerations(Eigen::VectorXs::Zero(skel->getNumDofs()));
+  skel->computeInverseDynamics();
+  Eigen::VectorXs forces = skel->getControlForces();
+  skel->setAccelerations(accelerations);
+  return forces;
+}
+
+/// This sums J^T * I * J over every body, which is the definition of the mass
+/// matrix
+Eigen::MatrixXs massMatrixFromJacobians(SkeletonPtr skel)
+{
+  int dofs = skel->getNumDofs();
+  Eigen::MatrixXs M = Eigen::MatrixXs::Zero(dofs, dofs);
+  for (std::size_t i = 0; i < skel->getNumBodyNodes(); i++)
+  {
+    BodyNode* body = skel->getBodyNode(i);
+    math::Jacobian J = body->getJacobian();
+    Eigen::MatrixXs bodyM = J.transpose() * body->getSpatialInertia() * J;
+    for (std::size_t j = 0; j < body->getNumDependentGenCoords(); j++)
+    {
+      for (std::size_t k = 0; k < body->getNumDependentGenCoords(); k++)
+      {
+        M(body->getDependentGenCoordIndex(j),
+          body->getDependentGenCoordIndex(k))
+            += bodyM(j, k);
+      }
+    }
+  }
+  return M;
+}
+
+} // namespace
+
+#ifdef ALL_TESTS
+TEST(MASS_MATRIX, CRBA_MATCHES_UNIT_ACCELERATIONS)
+{
+  SkeletonPtr skel = createRandomHumanoid();
+  for (int trial = 0; trial < 10; trial++)
+  {
+    skel->setPositions(Eigen::VectorXs::Random(skel->getNumDofs()));
+    skel->setAccelerations(Eigen::VectorXs::Random(skel->getNumDofs()));
+    Eigen::VectorXs accelerations = skel->getAccelerations();
+
+    Eigen::MatrixXs crba = skel->getMassMatrix();
+    Eigen::MatrixXs reference = skel->getMassMatrixByUnitAccelerations();
+    Eigen::MatrixXs fromJacobians = massMatrixFromJacobians(skel);
+
+    EXPECT_TRUE(equals(crba, reference, 1e-10));
+    EXPECT_TRUE(equals(crba, fromJacobians, 1e-10));
+    Eigen::MatrixXs crbaTranspose = crba.transpose();
+    EXPECT_TRUE(equals(crba, crbaTranspose, 0));
+    // The reference implementation works by overwriting the accelerations, so
+    // make sure they come back
+    EXPECT_TRUE(equals(skel->getAccelerations(), accelerations, 0));
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(MASS_MATRIX, CRBA_MULTIPLE_TREES)
+{
+  SkeletonPtr skel = createRandomHumanoid();
+  // A second, fixed base tree in the same skeleton
+  BodyNode* base = addRandomBody<RevoluteJoint>(skel, nullptr);
+  addRandomBody<BallJoint>(skel, addRandomBody<RevoluteJoint>(skel, base));
+  ASSERT_EQ(skel->getNumTrees(), 2u);
+
+  skel->setPositions(Eigen::VectorXs::Random(skel->getNumDofs()));
+  Eigen::MatrixXs crba = skel->getMassMatrix();
+  EXPECT_TRUE(equals(crba, skel->getMassMatrixByUnitAccelerations(), 1e-10));
+  EXPECT_TRUE(equals(crba, massMatrixFromJacobians(skel), 1e-10));
+  for (std::size_t tree = 0; tree < skel->getNumTrees(); tree++)
+  {
+    Eigen::MatrixXs treeM = skel->getMassMatrix(tree);
+    Eigen::MatrixXs treeMTranspose = treeM.transpose();
+    EXPECT_TRUE(equals(treeM, treeMTranspose, 0));
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(MASS_MATRIX, FACTORED_SOLVE_MATCHES_INVERSE)
+{
+  SkeletonPtr skel = createRandomHumanoid();
+  // A second, fixed base tree, so the solve has to scatter between trees
+  BodyNode* base = addRandomBody<RevoluteJoint>(skel, nullptr);
+  addRandomBody<UniversalJoint>(skel, base);
+  addRandomBody<BallJoint>(skel, base);
+  const int dofs = skel->getNumDofs();
+
+  for (int trial = 0; trial < 5; trial++)
+  {
+    skel->setPositions(Eigen::VectorXs::Random(dofs));
+    Eigen::MatrixXs Minv = skel->getMassMatrix().inverse();
+
+    Eigen::MatrixXs B = Eigen::MatrixXs::Random(dofs, 7);
+    Eigen::MatrixXs expected = Minv * B;
+    EXPECT_TRUE(equals(skel->solveMassMatrix(B), expected, 1e-9));
+
+    Eigen::MatrixXs Bt = B.transpose();
+    Eigen::MatrixXs expectedTranspose = Bt * Minv;
+    EXPECT_TRUE(
+        equals(skel->solveMassMatrixTranspose(Bt), expectedTranspose, 1e-9));
+
+    Eigen::MatrixXs block = Minv.block(3, 5, 10, 8);
+    EXPECT_TRUE(equals(skel->getInvMassMatrixBlock(3, 5, 10, 8), block, 1e-9));
+
+    // The factor should rebuild M as L^T * D * L
+    for (std::size_t tree = 0; tree < skel->getNumTrees(); tree++)
+    {
+      const Eigen::MatrixXs& factor = skel->getMassMatrixFactor(tree);
+      Eigen::MatrixXs L = factor.triangularView<Eigen::UnitLower>();
+      Eigen::MatrixXs D = factor.diagonal().asDiagonal();
+      Eigen::MatrixXs rebuilt = L.transpose() * D * L;
+      Eigen::MatrixXs treeM = skel->getMassMatrix(tree);
+      EXPECT_TRUE(equals(rebuilt, treeM, 1e-9));
+    }
+  }
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(MASS_MATRIX, DYNAMICS_KERNEL_TRACKS_SKELETON)
+{
+  SkeletonPtr skel = createRandomHumanoid();
+  skel->setPositions(Eigen::VectorXs::Random(skel->getNumDofs()));
+
+  const DynamicsKernel& kernel = skel->getDynamicsKernel(0);
+  ASSERT_EQ(kernel.getNumBodies(), skel->getNumBodyNodes());
+  ASSERT_EQ(kernel.getNumDofs(), skel->getNumDofs());
+
+  // Changing the positions, velocities and inertias should refresh the copied
+  // state
+  skel->setPositions(Eigen::VectorXs::Random(skel->getNumDofs()));
+  skel->setVelocities(Eigen::VectorXs::Random(skel->getNumDofs()));
+  BodyNode* elbow = skel->getBodyNode(5);
+  elbow->setMass(3.0);
+  skel->getDynamicsKernel(0);
+  for (std::size_t i = 0; i < skel->getNumBodyNodes(); i++)
+  {
+    BodyNode* body = skel->getBodyNode(i);
+    Joint* joint = body->getParentJoint();
+    BodyNode* parent = body->getParentBodyNode();
+    EXPECT_EQ(
+        kernel.mParents[i],
+        parent == nullptr ? -1 : (int)parent->getIndexInTree());
+    EXPECT_EQ(kernel.mNumJointDofs[i], (int)joint->getNumDofs());
+    EXPECT_TRUE(equals(
+        kernel.mRelativeTransforms[i].matrix(),
+        joint->getRelativeTransform().matrix(),
+        0));
+    EXPECT_TRUE(equals(
+        kernel.mSpatialInertias[i], body->getInertia().getSpatialTensor(), 0));
+    EXPECT_TRUE(equals(
+        kernel.mWorldRotations[i],
+        Eigen::Matrix3s(body->getWorldTransform().linear()),
+        1e-12));
+    EXPECT_TRUE(equals(
+        kernel.mSpatialVelocities[i], body->getSpatialVelocity(), 1e-12));
+    EXPECT_TRUE(equals(
+        kernel.mPartialAccelerations[i], body->getPartialAcceleration(), 1e-12));
+    if (joint->getNumDofs() > 0)
+    {
+      EXPECT_TRUE(equals(
+          math::Jacobian(kernel.mRelativeJacobians.middleCols(
+              kernel.mDofStarts[i], joint->getNumDofs())),
+          joint->getRelativeJacobian(),
+          0));
+    }
+  }
+
+  // Growing the tree should rebuild the topology
+  addRandomBody<RevoluteJoint>(skel, elbow);
+  EXPECT_EQ(skel->getDynamicsKernel(0).getNumBodies(), skel->getNumBodyNodes());
+  EXPECT_EQ(skel->getDynamicsKernel(0).getNumDofs(), skel->getNumDofs());
+  Eigen::MatrixXs reference = skel->getMassMatrixByUnitAccelerations();
+  EXPECT_TRUE(equals(skel->getMassMatrix(), reference, 1e-10));
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(MASS_MATRIX, CORIOLIS_AND_GRAVITY_MATCH_INVERSE_DYNAMICS)
+{
+  SkeletonPtr skel = createRandomHumanoid();
+  BodyNode* base = addRandomBody<RevoluteJoint>(skel, nullptr);
+  addRandomBody<BallJoint>(skel, base);
+  skel->setGravity(Eigen::Vector3s(0.3, -9.81, 0.5));
+  const int dofs = skel->getNumDofs();
+
+  for (int trial = 0; trial < 5; trial++)
+  {
+    skel->setPositions(Eigen::VectorXs::Random(dofs));
+    // Read the forces in between, so the next changes have to invalidate them
+    skel->getCoriolisAndGravityForces();
+    skel->getCoriolisForces();
+    skel->getGravityForces();
+    skel->setVelocities(Eigen::VectorXs::Random(dofs));
+    if (trial == 2)
+      skel->getBodyNode(2)->setMass(4.0);
+    if (trial == 3)
+      skel->getBodyNode(6)->setGravityMode(false);
+
+    Eigen::VectorXs Cg = coriolisAndGravityFromInverseDynamics(skel);
+    Eigen::VectorXs velocities = skel->getVelocities();
+    skel->setVelocities(Eigen::VectorXs::Zero(dofs));
+    Eigen::VectorXs g = coriolisAndGravityFromInverseDynamics(skel);
+    EXPECT_TRUE(equals(skel->getGravityForces(), g, 1e-10));
+    skel->setVelocities(velocities);
+
+    EXPECT_TRUE(equals(skel->getCoriolisAndGravityForces(), Cg, 1e-10));
+    Eigen::VectorXs C = Cg - g;
+    EXPECT_TRUE(equals(skel->getCoriolisForces(), C, 1e-10));
+    EXPECT_TRUE(equals(skel->getGravityForces(), g, 1e-10));
+  }
+
+  // When only the kernel reads the velocities, the BodyNodes never clear
+  // their own velocity flags, so the next change has to reach the kernel some
+  // other way
+  skel->setVelocities(Eigen::VectorXs::Random(dofs));
+  skel->getCoriolisAndGravityForces();
+  skel->setVelocities(Eigen::VectorXs::Random(dofs));
+  Eigen::VectorXs Cg = skel->getCoriolisAndGravityForces();
+  EXPECT_TRUE(equals(Cg, coriolisAndGravityFromInverseDynamics(skel), 1e-10));
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "dart/common/LocalResourceRetriever.hpp"
+#include "dart/dynamics/MeshAssetCache.hpp"
+#include "dart/dynamics/MeshShape.hpp"
+
+#include "TestHelpers.hpp"
+
+using namespace dart;
+using namespace dynamics;
+
+//==============================================================================
+TEST(MeshAssetCache, RepeatedLoadsShareOneImport)
+{
+  MeshAssetCache& cache = MeshAssetCache::getInstance();
+  auto retriever = std::make_shared<common::LocalResourceRetriever>();
+  const std::string uri = DART_DATA_PATH "obj/BoxSmall.obj";
+
+  const std::size_t importsBefore = cache.getNumImports();
+  const aiScene* first = MeshShape::loadMesh(uri, retriever);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(importsBefore + 1, cache.getNumImports());
+
+  std::vector<std::shared_ptr<MeshShape>> shapes;
+  shapes.push_back(std::make_shared<MeshShape>(
+      Eigen::Vector3s::Ones(), first, uri, retriever));
+  for (int i = 0; i < 10; i++)
+  {
+    const aiScene* scene = MeshShape::loadMesh(uri, retriever);
+    EXPECT_EQ(first, scene);
+    shapes.push_back(std::make_shared<MeshShape>(
+        Eigen::Vector3s::Constant(i + 1), scene, uri, retriever));
+  }
+  EXPECT_EQ(importsBefore + 1, cache.getNumImports());
+  EXPECT_EQ(11, cache.getRefCount(first));
+
+  // Scaled bounds still come out per-shape, even though the vertices are
+  // shared
+  const auto& bb = shapes[3]->getBoundingBox();
+  EXPECT_NEAR(-0.02 * 3, bb.getMin()[0], 1e-5);
+  EXPECT_NEAR(0.02 * 3, bb.getMax()[0], 1e-5);
+
+  shapes.resize(1);
+  EXPECT_EQ(1, cache.getRefCount(first));
+  EXPECT_TRUE(cache.contains(first));
+  shapes.clear();
+  EXPECT_FALSE(cache.contains(first));
+}
+
+//==============================================================================
+TEST(MeshAssetCache, DisabledCacheImportsFreshCopies)
+{
+  MeshAssetCache& cache = MeshAssetCache::getInstance();
+  auto retriever = std::make_shared<common::LocalResourceRetriever>();
+  const std::string uri = DART_DATA_PATH "obj/BoxSmall.obj";
+
+  cache.setEnabled(false);
+  const aiScene* a = MeshShape::loadMesh(uri, retriever);
+  const aiScene* b = MeshShape::loadMesh(uri, retriever);
+  cache.setEnabled(true);
+
+  ASSERT_NE(nullptr, a);
+  ASSERT_NE(nullptr, b);
+  EXPECT_NE(a, b);
+  EXPECT_FALSE(cache.contains(a));
+  MeshShape::releaseMesh(a);
+  MeshShape::releaseMesh(b);
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "dart/collision/dart/DARTCollisionDetector.hpp"
+#include "dart/constraint/ConstraintSolver.hpp"
+#include "dart/dynamics/BodyNode.hpp"
+#include "dart/dynamics/Joint.hpp"
+#include "dart/dynamics/Marker.hpp"
+#include "dart/dynamics/Skeleton.hpp"
+#include "dart/dynamics/SoftBodyNode.hpp"
+#include "dart/simulation/World.hpp"
+#include "dart/utils/ModelCache.hpp"
+#include "dart/utils/SkelParser.hpp"
+
+#include "TestHelpers.hpp"
+
+using namespace dart;
+using namespace dart::utils;
+
+//==============================================================================
+void expectSameSkeleton(
+    const dynamics::SkeletonPtr& expected, const dynamics::SkeletonPtr& actual)
+{
+  ASSERT_NE(actual, nullptr);
+  EXPECT_EQ(expected->getName(), actual->getName());
+  ASSERT_EQ(expected->getNumBodyNodes(), actual->getNumBodyNodes());
+  ASSERT_EQ(expected->getNumDofs(), actual->getNumDofs());
+  for (std::size_t i = 0; i < expected->getNumBodyNodes(); i++)
+  {
+    const dynamics::BodyNode* a = expected->getBodyNode(i);
+    const dynamics::BodyNode* b = actual->getBodyNode(i);
+    EXPECT_EQ(a->getName(), b->getName());
+    EXPECT_EQ(a->getParentJoint()->getType(), b->getParentJoint()->getType());
+    EXPECT_EQ(a->getParentJoint()->getName(), b->getParentJoint()->getName());
+    EXPECT_EQ(a->getNumShapeNodes(), b->getNumShapeNodes());
+    EXPECT_EQ(
+        a->asSoftBodyNode() != nullptr, b->asSoftBodyNode() != nullptr);
+    ASSERT_EQ(a->getNumMarkers(), b->getNumMarkers());
+    for (std::size_t m = 0; m < a->getNumMarkers(); m++)
+    {
+      EXPECT_EQ(a->getMarker(m)->getName(), b->getMarker(m)->getName());
+      EXPECT_TRUE(equals(
+          a->getMarker(m)->getRelativeTransform().matrix(),
+          b->getMarker(m)->getRelativeTransform().matrix()));
+      EXPECT_TRUE(
+          equals(a->getMarker(m)->getColor(), b->getMarker(m)->getColor()));
+      EXPECT_EQ(
+          a->getMarker(m)->getConstraintType(),
+          b->getMarker(m)->getConstraintType());
+    }
+    EXPECT_TRUE(equals(
+        a->getInertia().getSpatialTensor(), b->getInertia().getSpatialTensor()));
+  }
+  EXPECT_TRUE(
+      equals(expected->getPositionLowerLimits(), actual->getPositionLowerLimits()));
+  EXPECT_TRUE(
+      equals(expected->getPositionUpperLimits(), actual->getPositionUpperLimits()));
+  EXPECT_TRUE(equals(expected->getPositions(), actual->getPositions()));
+
+  // Same kinematics and dynamics at a random configuration
+  const Eigen::VectorXs q = Eigen::VectorXs::Random(expected->getNumDofs());
+  expected->setPositions(q);
+  actual->setPositions(q);
+  EXPECT_TRUE(equals(expected->getMassMatrix(), actual->getMassMatrix()));
+  for (std::size_t i = 0; i < expected->getNumBodyNodes(); i++)
+  {
+    EXPECT_TRUE(equals(
+        expected->getBodyNode(i)->getWorldTransform().matrix(),
+        actual->getBodyNode(i)->getWorldTransform().matrix()));
+  }
+}
+
+//==============================================================================
+TEST(ModelCache, WorldRoundTrip)
+{
+  const common::Uri uri = "dart://sample/skel/fullbody1.skel";
+  simulation::WorldPtr world = SkelParser::readWorld(uri);
+  ASSERT_NE(world, nullptr);
+
+  const std::uint64_t hash = ModelCache::hashSource(uri, nullptr);
+  std::string blob;
+  ASSERT_TRUE(ModelCache::serializeWorld(world, hash, nullptr, blob));
+
+  simulation::WorldPtr restored = ModelCache::deserializeWorld(
+      blob.data(), blob.size(), hash, nullptr);
+  ASSERT_NE(restored, nullptr);
+  EXPECT_TRUE(equals(world->getGravity(), restored->getGravity()));
+  EXPECT_EQ(world->getTimeStep(), restored->getTimeStep());
+  ASSERT_EQ(world->getNumSkeletons(), restored->getNumSkeletons());
+  for (std::size_t i = 0; i < world->getNumSkeletons(); i++)
+    expectSameSkeleton(world->getSkeleton(i), restored->getSkeleton(i));
+
+  // Blobs keyed by another source, or of another version, are rejected
+  EXPECT_EQ(
+      ModelCache::deserializeWorld(blob.data(), blob.size(), hash + 1, nullptr),
+      nullptr);
+  std::string otherVersion = blob;
+  otherVersion[8]++;
+  EXPECT_EQ(
+      ModelCache::deserializeWorld(
+          otherVersion.data(), otherVersion.size(), hash, nullptr),
+      nullptr);
+  EXPECT_EQ(
+      ModelCache::deserializeWorld(blob.data(), blob.size() / 2, hash, nullptr),
+      nullptr);
+}
+
+//==============================================================================
+TEST(ModelCache, LoadSkeletonThroughCache)
+{
+  const std::string cacheDirectory = "/tmp";
+  const common::Uri uri = "dart://sample/skel/test/double_pendulum.skel";
+  const std::string cachePath = ModelCache::getCachePath(
+      cacheDirectory, ModelCache::hashSource(uri, nullptr));
+  std::remove(cachePath.c_str());
+
+  // The first load parses the source and writes the cache entry
+  dynamics::SkeletonPtr parsed = ModelCache::loadSkeleton(uri, cacheDirectory);
+  ASSERT_NE(parsed, nullptr);
+  EXPECT_TRUE(std::ifstream(cachePath).good());
+
+  // The second load is served from the cache entry
+  dynamics::SkeletonPtr cached = ModelCache::loadSkeleton(uri, cacheDirectory);
+  expectSameSkeleton(SkelParser::readSkeleton(uri), cached);
+
+  // A corrupt entry falls back to parsing, and is replaced
+  {
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    file << "not a cache entry";
+  }
+  dynamics::SkeletonPtr reparsed
+      = ModelCache::loadSkeleton(uri, cacheDirectory);
+  expectSameSkeleton(SkelParser::readSkeleton(uri), reparsed);
+
+  std::remove(cachePath.c_str());
+}
+
+//==============================================================================
+/// A DART collision detector under another type name, so we can tell whether
+/// a cached World kept the detector its source asked for.
+class TaggedCollisionDetector : public collision::DARTCollisionDetector
+{
+public:
+  static const std::string& getStaticType()
+  {
+    static const std::string type = "model_cache_test";
+    return type;
+  }
+
+  const std::string& getType() const override
+  {
+    return getStaticType();
+  }
+};
+
+//==============================================================================
+TEST(ModelCache, MarkersAndCollisionDetectorRoundTrip)
+{
+  collision::CollisionDetector::getFactory()->registerCreator(
+      TaggedCollisionDetector::getStaticType(),
+      []() -> std::shared_ptr<collision::CollisionDetector> {
+        return std::make_shared<TaggedCollisionDetector>();
+      });
+
+  const std::string skelPath = "/tmp/model_cache_markers.skel";
+  {
+    std::ofstream file(skelPath, std::ios::trunc);
+    file << R"(<?xml version="1.0" ?>
+<skel version="1.0">
+  <world name="markers">
+    <physics>
+      <time_step>0.002</time_step>
+      <gravity>0 0 -9.81</gravity>
+      <collision_detector>model_cache_test</collision_detector>
+    </physics>
+    <skeleton name="arm">
+      <body name="link">
+        <inertia><mass>1.0</mass></inertia>
+        <marker name="tip"><offset>0 0 0.5</offset></marker>
+        <marker name="base"><offset>0.1 0 0</offset></marker>
+      </body>
+      <joint type="revolute" name="hinge">
+        <parent>world</parent>
+        <child>link</child>
+        <axis><xyz>0 1 0</xyz></axis>
+      </joint>
+    </skeleton>
+  </world>
+</skel>
+)";
+  }
+  const common::Uri uri = common::Uri::createFromPath(skelPath);
+
+  simulation::WorldPtr world = SkelParser::readWorld(uri);
+  ASSERT_NE(world, nullptr);
+  ASSERT_EQ(world->getSkeleton(0)->getBodyNode(0)->getNumMarkers(), 2u);
+  dynamics::Marker* tip = world->getSkeleton(0)->getBodyNode(0)->getMarker(0);
+  tip->setColor(Eigen::Vector4s(1, 0, 0, 1));
+  tip->setConstraintType(dynamics::Marker::HARD);
+
+  const std::uint64_t hash = ModelCache::hashSource(uri, nullptr);
+  std::string blob;
+  ASSERT_TRUE(ModelCache::serializeWorld(world, hash, nullptr, blob));
+  simulation::WorldPtr restored = ModelCache::deserializeWorld(
+      blob.data(), blob.size(), hash, nullptr);
+  ASSERT_NE(restored, nullptr);
+  EXPECT_EQ(
+      restored->getConstraintSolver()->getCollisionDetector()->getType(),
+      TaggedCollisionDetector::getStaticType());
+  expectSameSkeleton(world->getSkeleton(0), restored->getSkeleton(0));
+
+  // A blob naming a detector this process doesn't know is rejected, instead
+  // of silently falling back to the default one
+  collision::CollisionDetector::getFactory()->unregisterCreator(
+      TaggedCollisionDetector::getStaticType());
+  EXPECT_EQ(
+      ModelCache::deserializeWorld(blob.data(), blob.size(), hash, nullptr),
+      nullptr);
+
+  std::remove(skelPath.c_str());
+}
+
+//==============================================================================
+TEST(ModelCache, SoftBodiesAreNotCached)
+{
+  const std::string cacheDirectory = "/tmp";
+  const common::Uri uri = "dart://sample/skel/test/test_single_body.skel";
+  const std::string cachePath = ModelCache::getCachePath(
+      cacheDirectory, ModelCache::hashSource(uri, nullptr));
+  std::remove(cachePath.c_str());
+
+  simulation::WorldPtr parsed = SkelParser::readWorld(uri);
+  ASSERT_NE(parsed, nullptr);
+  ASSERT_NE(parsed->getSkeleton(0)->getBodyNode(0)->asSoftBodyNode(), nullptr);
+  std::string blob;
+  EXPECT_FALSE(ModelCache::serializeWorld(
+      parsed, ModelCache::hashSource(uri, nullptr), nullptr, blob));
+
+  // Every load parses the source, so the soft body survives
+  for (int i = 0; i < 2; i++)
+  {
+    simulation::WorldPtr loaded = ModelCache::loadWorld(uri, cacheDirectory);
+    ASSERT_NE(loaded, nullptr);
+    expectSameSkeleton(parsed->getSkeleton(0), loaded->getSkeleton(0));
+    EXPECT_FALSE(std::ifstream(cachePath).good());
+  }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+#include "dart/constraint/ParallelPgsBoxedLcpSolver.hpp"
+#include "dart/external/odelcpsolver/matrix.h"
+
+using namespace dart;
+using namespace dart::constraint;
+
+//==============================================================================
+// A chain of bodies touching their neighbors, so A = J * J^T is sparse and
+// contact-shaped: one normal row and two friction rows per contact.
+struct ChainContactLcp
+{
+  explicit ChainContactLcp(int numContacts)
+  {
+    n = 3 * numContacts;
+    const int numBodies = numContacts + 1;
+    Eigen::MatrixXs J = Eigen::MatrixXs::Zero(n, 6 * numBodies);
+    srand(7);
+    for (int c = 0; c < numContacts; c++)
+    {
+      J.block<3, 6>(3 * c, 6 * c) = Eigen::MatrixXs::Random(3, 6);
+      J.block<3, 6>(3 * c, 6 * (c + 1)) = Eigen::MatrixXs::Random(3, 6);
+    }
+    A = J * J.transpose() + 1e-3 * Eigen::MatrixXs::Identity(n, n);
+    b = Eigen::VectorXs::Random(n);
+    lo = Eigen::VectorXs::Zero(n);
+    hi = Eigen::VectorXs::Zero(n);
+    findex = Eigen::VectorXi::Constant(n, -1);
+    for (int c = 0; c < numContacts; c++)
+    {
+      hi(3 * c) = std::numeric_limits<s_t>::infinity();
+      for (int k = 1; k < 3; k++)
+      {
+        lo(3 * c + k) = -0.5;
+        hi(3 * c + k) = 0.5;
+        findex(3 * c + k) = 3 * c;
+      }
+    }
+  }
+
+  bool solve(ParallelPgsBoxedLcpSolver& solver, Eigen::VectorXs& x) const
+  {
+    Eigen::Matrix<s_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        APadded = Eigen::MatrixXs::Zero(n, dPAD(n));
+    APadded.block(0, 0, n, n) = A;
+    Eigen::VectorXs bCopy = b;
+    Eigen::VectorXs loCopy = lo;
+    Eigen::VectorXs hiCopy = hi;
+    Eigen::VectorXi findexCopy = findex;
+    return solver.solve(
+        n,
+        APadded.data(),
+        x.data(),
+        bCopy.data(),
+        0,
+        loCopy.data(),
+        hiCopy.data(),
+        findexCopy.data(),
+        false);
+  }
+
+  int n;
+  Eigen::MatrixXs A;
+  Eigen::VectorXs b;
+  Eigen::VectorXs lo;
+  Eigen::VectorXs hi;
+  Eigen::VectorXi findex;
+};
+
+//==============================================================================
+TEST(ParallelPgsBoxedLcpSolver, ColoredSweepIsThreadCountInvariant)
+{
+  ChainContactLcp lcp(200);
+
+  ParallelPgsBoxedLcpSolver serial;
+  serial.setOption(
+      ParallelPgsBoxedLcpSolver::Option(2000, 1e-8, 4, 1e-9, 1, 1));
+  Eigen::VectorXs xSerial = Eigen::VectorXs::Zero(lcp.n);
+  EXPECT_TRUE(lcp.solve(serial, xSerial));
+
+  // Neighboring contacts share a body, so a handful of colors separate them
+  EXPECT_GT(serial.getNumColors(), 1);
+  EXPECT_LT(serial.getNumColors(), 20);
+
+  ParallelPgsBoxedLcpSolver parallel;
+  parallel.setOption(
+      ParallelPgsBoxedLcpSolver::Option(2000, 1e-8, 4, 1e-9, 4, 1));
+  Eigen::VectorXs xParallel = Eigen::VectorXs::Zero(lcp.n);
+  EXPECT_TRUE(lcp.solve(parallel, xParallel));
+
+  EXPECT_EQ(serial.getNumIterations(), parallel.getNumIterations());
+  EXPECT_TRUE(xSerial == xParallel);
+
+  // The solution satisfies the boxed LCP conditions
+  const Eigen::VectorXs w = lcp.A * xSerial - lcp.b;
+  for (int i = 0; i < lcp.n; i++)
+  {
+    s_t lo = lcp.lo(i);
+    s_t hi = lcp.hi(i);
+    if (lcp.findex(i) >= 0)
+    {
+      hi = lcp.hi(i) * xSerial(lcp.findex(i));
+      lo = -hi;
+    }
+    EXPECT_GE(xSerial(i), lo - 1e-9);
+    EXPECT_LE(xSerial(i), hi + 1e-9);
+    if (xSerial(i) > lo + 1e-6 && xSerial(i) < hi - 1e-6)
+    {
+      EXPECT_NEAR(w(i), 0.0, 1e-6);
+    }
+  }
+
+  // Warm starting from the solution converges on the first residual check
+  EXPECT_TRUE(lcp.solve(parallel, xParallel));
+  EXPECT_LE(parallel.getNumIterations(), 4);
+}
+
+//==============================================================================
+TEST(ParallelPgsBoxedLcpSolver, JacobiSweepConverges)
+{
+  ChainContactLcp lcp(100);
+
+  ParallelPgsBoxedLcpSolver gaussSeidel;
+  gaussSeidel.setOption(
+      ParallelPgsBoxedLcpSolver::Option(2000, 1e-8, 4, 1e-9, 2, 1));
+  Eigen::VectorXs xGaussSeidel = Eigen::VectorXs::Zero(lcp.n);
+  EXPECT_TRUE(lcp.solve(gaussSeidel, xGaussSeidel));
+
+  ParallelPgsBoxedLcpSolver jacobi;
+  jacobi.setOption(ParallelPgsBoxedLcpSolver::Option(
+      20000, 1e-8, 4, 1e-9, 2, 1, true, 0.3));
+  Eigen::VectorXs xJacobi = Eigen::VectorXs::Zero(lcp.n);
+  EXPECT_TRUE(lcp.solve(jacobi, xJacobi));
+
+  EXPECT_TRUE(xGaussSeidel.isApprox(xJacobi, 1e-4));
+}
@@ -30,6 +30,7 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -439,6 +440,111 @@ TEST(REALTIME, CONTROL_BUFFER_PLAN)
 }
 #endif
 
+#ifdef ALL_TESTS
+TEST(REALTIME, CONTROL_BUFFER_FIRST_ORDER_HOLD)
+{
+  int forceDim = 3;
+  int steps = 10;
+  int dt = 10;
+  RealTimeControlBuffer buffer = RealTimeControlBuffer(forceDim, steps, dt);
+  buffer.setInterpolation(FIRST_ORDER_HOLD);
+
+  Eigen::MatrixXs plan = Eigen::MatrixXs::Ones(forceDim, steps);
+  for (int i = 0; i < steps; i++)
+  {
+    plan.col(i) *= i;
+  }
+  buffer.setControlForcePlan(0L, 0L, plan);
+  EXPECT_EQ(buffer.getPlanVersion(), 1);
+
+  // Reading at 1ms resolution should ramp smoothly between steps
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer.getPlannedForce(0L)(0)), 0.0);
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer.getPlannedForce(3L)(0)), 0.3);
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer.getPlannedForce(15L)(0)), 1.5);
+  // The last step has nothing to blend towards, so it holds
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer.getPlannedForce(95L)(0)), 9.0);
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer.getPlannedForce(100L)(0)), 0.0);
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(REALTIME, CONTROL_BUFFER_CONCURRENT_SWAP)
+{
+  int forceDim = 20;
+  int steps = 50;
+  int dt = 1;
+  RealTimeControlBuffer buffer = RealTimeControlBuffer(forceDim, steps, dt);
+  buffer.setControlForcePlan(0L, 0L, Eigen::MatrixXs::Zero(forceDim, steps));
+
+  // Every plan is constant, so a torn read would show up as a force vector
+  // with mismatched entries
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    for (int i = 1; i <= 2000; i++)
+    {
+      buffer.setControlForcePlan(
+          0L, 0L, Eigen::MatrixXs::Constant(forceDim, steps, i));
+    }
+    done = true;
+  });
+
+  Eigen::VectorXs force = Eigen::VectorXs::Zero(forceDim);
+  int torn = 0;
+  long lastSeen = 0;
+  bool monotonic = true;
+  while (!done)
+  {
+    buffer.getPlannedForce(10L, force, true);
+    if (force.maxCoeff() != force.minCoeff())
+      torn++;
+    long seen = static_cast<long>(force(0));
+    if (seen < lastSeen)
+      monotonic = false;
+    lastSeen = seen;
+  }
+  writer.join();
+
+  EXPECT_EQ(torn, 0);
+  EXPECT_TRUE(monotonic);
+  EXPECT_EQ(buffer.getPlanVersion(), 2001);
+}
+#endif
+
+#ifdef ALL_TESTS
+TEST(REALTIME, CONTROL_BUFFER_MAX_PLAN_STEPS)
+{
+  int forceDim = 3;
+  int steps = 10;
+  int dt = 5;
+  RealTimeControlBuffer buffer = RealTimeControlBuffer(forceDim, steps, dt);
+  EXPECT_EQ(buffer.getMaxPlanSteps(), steps);
+
+  // Plans longer than the preallocated storage get truncated, rather than
+  // reallocating storage a reader could be copying from
+  buffer.setControlForcePlan(
+      0L, 0L, Eigen::MatrixXs::Ones(forceDim, steps * 2));
+  EXPECT_EQ(buffer.getPlanBufferMillisAfter(0L), steps * dt);
+  EXPECT_DOUBLE_EQ(
+      static_cast<double>(buffer.getPlannedForce(45L, true)(0)), 1.0);
+  EXPECT_DOUBLE_EQ(
+      static_cast<double>(buffer.getPlannedForce(50L, true)(0)), 0.0);
+
+  // Growing the storage keeps the current plan
+  buffer.setMaxPlanSteps(steps * 2);
+  EXPECT_EQ(buffer.getMaxPlanSteps(), steps * 2);
+  EXPECT_EQ(buffer.getPlanBufferMillisAfter(0L), steps * dt);
+  EXPECT_DOUBLE_EQ(
+      static_cast<double>(buffer.getPlannedForce(45L, true)(0)), 1.0);
+  buffer.setControlForcePlan(
+      0L, 0L, Eigen::MatrixXs::Ones(forceDim, steps * 2));
+  EXPECT_EQ(buffer.getPlanBufferMillisAfter(0L), steps * 2 * dt);
+
+  // Asking for more steps than we can hold grows the storage too
+  buffer.setNumSteps(steps * 3);
+  EXPECT_EQ(buffer.getMaxPlanSteps(), steps * 3);
+}
+#endif
+
 #ifdef ALL_TESTS
 TEST(REALTIME, CONTROL_BUFFER_ESTIMATE)
 {
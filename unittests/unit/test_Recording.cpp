@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "dart/simulation/Recording.hpp"
+
+#include "TestHelpers.hpp"
+
+using namespace dart;
+using namespace simulation;
+
+//==============================================================================
+void fillRecording(Recording& recording, int numFrames)
+{
+  for (int frame = 0; frame < numFrames; frame++)
+  {
+    Eigen::VectorXs positions(5);
+    for (int i = 0; i < 5; i++)
+      positions(i) = std::sin(0.01 * frame + i);
+    Eigen::VectorXs contacts = Eigen::VectorXs::Constant(6 * (frame % 3), frame);
+    recording.addFrame(positions, contacts);
+  }
+}
+
+//==============================================================================
+void expectSameFrames(const Recording& a, const Recording& b)
+{
+  ASSERT_EQ(a.getNumFrames(), b.getNumFrames());
+  ASSERT_EQ(a.getNumSkeletons(), b.getNumSkeletons());
+  // Jump around, so the file-backed recording has to seek
+  for (int frame = a.getNumFrames() - 1; frame >= 0; frame -= 7)
+  {
+    for (int skel = 0; skel < a.getNumSkeletons(); skel++)
+    {
+      EXPECT_TRUE(equals(a.getConfig(frame, skel), b.getConfig(frame, skel)));
+    }
+    ASSERT_EQ(a.getNumContacts(frame), b.getNumContacts(frame));
+    for (int c = 0; c < a.getNumContacts(frame); c++)
+    {
+      EXPECT_TRUE(
+          equals(a.getContactPoint(frame, c), b.getContactPoint(frame, c)));
+      EXPECT_TRUE(
+          equals(a.getContactForce(frame, c), b.getContactForce(frame, c)));
+    }
+  }
+}
+
+//==============================================================================
+TEST(Recording, InMemoryMatchesAddState)
+{
+  Recording recording(std::vector<int>{2, 3});
+  recording.setChunkSize(16);
+  fillRecording(recording, 50);
+
+  EXPECT_EQ(recording.getNumFrames(), 50);
+  EXPECT_EQ(recording.getNumContacts(4), 1);
+  EXPECT_EQ(recording.getGenCoord(20, 1, 2), std::sin(0.01 * 20 + 4));
+  EXPECT_EQ(recording.getContactForce(4, 0)(2), 4);
+
+  Recording legacy(std::vector<int>{2, 3});
+  for (int frame = 0; frame < recording.getNumFrames(); frame++)
+  {
+    Eigen::VectorXs state(5 + 6 * recording.getNumContacts(frame));
+    state.head(2) = recording.getConfig(frame, 0);
+    state.segment(2, 3) = recording.getConfig(frame, 1);
+    for (int c = 0; c < recording.getNumContacts(frame); c++)
+    {
+      state.segment(5 + 6 * c, 3) = recording.getContactPoint(frame, c);
+      state.segment(5 + 6 * c + 3, 3) = recording.getContactForce(frame, c);
+    }
+    legacy.addState(state);
+  }
+  expectSameFrames(recording, legacy);
+}
+
+//==============================================================================
+TEST(Recording, StreamRoundTrip)
+{
+  for (bool compress : {false, true})
+  {
+    const std::string path = "testRecording.bin";
+    Recording reference(std::vector<int>{2, 3});
+    fillRecording(reference, 100);
+
+    {
+      Recording recording(std::vector<int>{2, 3});
+      recording.setChunkSize(16);
+      ASSERT_TRUE(recording.streamToFile(path, compress));
+      fillRecording(recording, 100);
+
+      // Only the chunk still being filled should be held in memory
+      EXPECT_EQ(recording.getNumChunksInMemory(), 1);
+      expectSameFrames(reference, recording);
+      recording.closeStream();
+    }
+
+    std::shared_ptr<Recording> loaded = Recording::openFile(path);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getChunkSize(), 16);
+    expectSameFrames(reference, *loaded);
+    std::remove(path.c_str());
+  }
+}
+
+//==============================================================================
+TEST(Recording, CorruptChunkReadsAsZeros)
+{
+  const std::string path = "testCorruptRecording.bin";
+  Recording reference(std::vector<int>{2, 3});
+  fillRecording(reference, 100);
+  {
+    Recording recording(std::vector<int>{2, 3});
+    recording.setChunkSize(16);
+    ASSERT_TRUE(recording.streamToFile(path, false));
+    fillRecording(recording, 100);
+    recording.closeStream();
+  }
+
+  // The first chunk starts right after the 28 byte header. Claim it holds far
+  // more contacts than its payload has room for.
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(28 + 2 * sizeof(int32_t));
+    int32_t numContacts = 1000000;
+    file.write(reinterpret_cast<const char*>(&numContacts), sizeof(int32_t));
+  }
+
+  std::shared_ptr<Recording> loaded = Recording::openFile(path);
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->getNumFrames(), 100);
+  Eigen::VectorXs zeros = Eigen::VectorXs::Zero(3);
+  for (int frame = 0; frame < 16; frame++)
+  {
+    EXPECT_FALSE(loaded->isFrameReadable(frame));
+    EXPECT_TRUE(equals(loaded->getConfig(frame, 1), zeros));
+    EXPECT_EQ(loaded->getNumContacts(frame), 0);
+  }
+  // The other chunks are still fine
+  for (int frame = 16; frame < 100; frame++)
+  {
+    EXPECT_TRUE(loaded->isFrameReadable(frame));
+    EXPECT_TRUE(
+        equals(loaded->getConfig(frame, 1), reference.getConfig(frame, 1)));
+    EXPECT_EQ(loaded->getNumContacts(frame), reference.getNumContacts(frame));
+  }
+  std::remove(path.c_str());
+}
+
+//==============================================================================
+TEST(Recording, ConcurrentReadsFromFile)
+{
+  const std::string path = "testConcurrentRecording.bin";
+  Recording reference(std::vector<int>{2, 3});
+  fillRecording(reference, 200);
+  {
+    Recording recording(std::vector<int>{2, 3});
+    recording.setChunkSize(8);
+    ASSERT_TRUE(recording.streamToFile(path, true));
+    fillRecording(recording, 200);
+    recording.closeStream();
+  }
+  std::shared_ptr<Recording> loaded = Recording::openFile(path);
+  ASSERT_NE(loaded, nullptr);
+
+  // Each thread strides through the frames differently, so they keep
+  // evicting each other's cached chunk
+  std::atomic<int> mismatches(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++)
+  {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 2000; i++)
+      {
+        int frame = (i * (7 + 2 * t) + 13 * t) % 200;
+        if (!equals(
+                loaded->getConfig(frame, 0), reference.getConfig(frame, 0))
+            || loaded->getNumContacts(frame)
+                   != reference.getNumContacts(frame))
+        {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  EXPECT_EQ(mismatches.load(), 0);
+  std::remove(path.c_str());
+}
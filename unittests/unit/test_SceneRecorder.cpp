@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2011-2019, The DART development contributors
+ * All rights reserved.
+ *
+ * The list of contributors can be found at:
+ *   https://github.com/dartsim/dart/blob/master/LICENSE
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "dart/dynamics/dynamics.hpp"
+#include "dart/server/SceneRecorder.hpp"
+#include "dart/simulation/World.hpp"
+#include "dart/trajectory/TrajectoryRollout.hpp"
+
+using namespace dart;
+
+//==============================================================================
+std::shared_ptr<simulation::World> createBoxWorld()
+{
+  auto world = std::make_shared<simulation::World>();
+  world->setTimeStep(0.02);
+
+  auto box = dynamics::Skeleton::create("box");
+  auto boxBody
+      = box->createJointAndBodyNodePair<dynamics::FreeJoint>().second;
+  boxBody->setName("body");
+  boxBody->createShapeNodeWith<dynamics::VisualAspect>(
+      std::make_shared<dynamics::BoxShape>(Eigen::Vector3s(0.5, 0.5, 0.5)));
+  world->addSkeleton(box);
+  return world;
+}
+
+//==============================================================================
+TEST(SceneRecorder, RoundTripTrajectory)
+{
+  auto world = createBoxWorld();
+  const int steps = 5;
+
+  Eigen::MatrixXs poses = Eigen::MatrixXs::Zero(world->getNumDofs(), steps);
+  for (int t = 0; t < steps; t++)
+  {
+    poses(2, t) = 0.1 * t;
+    poses(3, t) = 0.5 * t;
+    poses(5, t) = -0.25 * t;
+  }
+  std::unordered_map<std::string, Eigen::MatrixXs> pos;
+  pos["identity"] = poses;
+  std::unordered_map<std::string, Eigen::MatrixXs> vel;
+  vel["identity"] = Eigen::MatrixXs::Zero(world->getNumDofs(), steps);
+  std::unordered_map<std::string, Eigen::MatrixXs> force;
+  force["identity"] = Eigen::MatrixXs::Zero(world->getNumDofs(), steps);
+  trajectory::TrajectoryRolloutReal rollout(
+      pos, vel, force, Eigen::VectorXs::Zero(0), {});
+
+  Eigen::VectorXs originalPositions = world->getPositions();
+
+  server::SceneRecorder recorder(world->getTimeStep());
+  recorder.recordTrajectory(world, &rollout);
+  EXPECT_EQ(recorder.getNumFrames(), steps);
+  EXPECT_EQ(recorder.getNumObjects(), 1);
+  EXPECT_NE(recorder.getSceneJson().find("create_box"), std::string::npos);
+  EXPECT_EQ(world->getPositions(), originalPositions);
+
+  std::string path = "/tmp/test_SceneRecorder.nimscene";
+  ASSERT_TRUE(recorder.writeToFile(path));
+
+  auto recording = server::SceneRecording::open(path);
+  ASSERT_NE(recording, nullptr);
+  EXPECT_EQ(recording->getNumFrames(), steps);
+  EXPECT_EQ(recording->getNumObjects(), 1);
+  EXPECT_NEAR(recording->getFrameDuration(), 0.02, 1e-7);
+  EXPECT_EQ(recording->getSceneJson(), recorder.getSceneJson());
+
+  // Read the frames out of order, to exercise seeking
+  for (int t = steps - 1; t >= 0; t--)
+  {
+    world->setPositions(poses.col(t));
+    const Eigen::Isometry3s& T
+        = world->getSkeleton("box")->getBodyNode("body")->getWorldTransform();
+
+    Eigen::MatrixXs frame = recording->readFrame(t);
+    ASSERT_EQ(frame.rows(), 6);
+    ASSERT_EQ(frame.cols(), 1);
+    Eigen::Vector3s recordedPos = frame.col(0).head<3>();
+    Eigen::Vector3s recordedEuler = frame.col(0).tail<3>();
+    EXPECT_LT((recordedPos - T.translation()).norm(), 1e-5);
+    EXPECT_LT(
+        (recordedEuler - math::matrixToEulerXYZ(T.linear())).norm(), 1e-5);
+  }
+
+  std::remove(path.c_str());
+}
+
+//==============================================================================
+TEST(SceneRecorder, RejectsOtherFiles)
+{
+  std::string path = "/tmp/test_SceneRecorder_invalid.nimscene";
+  {
+    std::ofstream file(path);
+    file << "this is not a scene file";
+  }
+  EXPECT_EQ(server::SceneRecording::open(path), nullptr);
+  std::remove(path.c_str());
+}